@@ -0,0 +1,321 @@
+#pragma once
+
+// Portable stand-in for the parts of the Microsoft C++ unit test framework that the tests of portable code use,
+// so that the same TEST_CLASS / TEST_METHOD / Assert tests also build and run with the CMake targets off Windows.
+
+#include <cmath>
+#include <cstdio>
+#include <cwctype>
+#include <exception>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace PortableTests
+{
+    // Thrown by a failed assertion, caught by the test runner
+    struct AssertFailure
+    {
+        std::wstring message;
+    };
+
+    struct TestMethod
+    {
+        const char* className;
+        const char* methodName;
+        void (*run)();
+    };
+
+    inline std::vector<TestMethod>& RegisteredTests()
+    {
+        static std::vector<TestMethod> tests;
+        return tests;
+    }
+
+    struct TestRegistrar
+    {
+        TestRegistrar(const char* className, const char* methodName, void (*run)())
+        {
+            RegisteredTests().push_back({ className, methodName, run });
+        }
+    };
+
+    template<typename T>
+    class TestClass
+    {
+    public:
+        using ThisClass = T;
+
+        virtual ~TestClass() = default;
+
+        virtual void PortableMethodInitialize() {}
+        virtual void PortableMethodCleanup() {}
+
+        // Every test method runs on its own instance, between the initialize and cleanup methods
+        template<void (T::*Method)()>
+        static void Run()
+        {
+            T instance;
+            instance.PortableMethodInitialize();
+            try
+            {
+                (instance.*Method)();
+            }
+            catch (...)
+            {
+                instance.PortableMethodCleanup();
+                throw;
+            }
+            instance.PortableMethodCleanup();
+        }
+    };
+
+    inline std::string ToUtf8(std::wstring_view text)
+    {
+        std::string result;
+        for (wchar_t ch : text)
+        {
+            const auto codePoint = static_cast<uint32_t>(ch);
+            if (codePoint < 0x80)
+            {
+                result += static_cast<char>(codePoint);
+            }
+            else if (codePoint < 0x800)
+            {
+                result += static_cast<char>(0xC0 | (codePoint >> 6));
+                result += static_cast<char>(0x80 | (codePoint & 0x3F));
+            }
+            else
+            {
+                result += static_cast<char>(0xE0 | ((codePoint >> 12) & 0x0F));
+                result += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+                result += static_cast<char>(0x80 | (codePoint & 0x3F));
+            }
+        }
+
+        return result;
+    }
+
+    template<typename Q, typename = void>
+    struct IsWideStreamable : std::false_type
+    {
+    };
+
+    template<typename Q>
+    struct IsWideStreamable<Q, std::void_t<decltype(std::declval<std::wostream&>() << std::declval<const Q&>())>> : std::true_type
+    {
+    };
+}
+
+// Registers the class name for the methods of the class, found through argument dependent lookup
+#define TEST_CLASS(className)                                                 \
+    class className;                                                          \
+    [[maybe_unused]] constexpr const char* PortableTestClassName(className*) \
+    {                                                                         \
+        return #className;                                                    \
+    }                                                                         \
+    class className : public ::PortableTests::TestClass<className>
+
+#define TEST_METHOD(methodName)                                                                                                             \
+public:                                                                                                                                     \
+    static void methodName##_PortableRun()                                                                                                  \
+    {                                                                                                                                       \
+        ThisClass::Run<&ThisClass::methodName>();                                                                                           \
+    }                                                                                                                                       \
+    inline static const ::PortableTests::TestRegistrar methodName##_PortableRegistrar{                                                      \
+        PortableTestClassName(static_cast<ThisClass*>(nullptr)), #methodName, &methodName##_PortableRun                                     \
+    };                                                                                                                                      \
+    void methodName()
+
+#define TEST_METHOD_INITIALIZE(methodName) \
+public:                                    \
+    void PortableMethodInitialize() override \
+    {                                      \
+        methodName();                      \
+    }                                      \
+    void methodName()
+
+#define TEST_METHOD_CLEANUP(methodName) \
+public:                                 \
+    void PortableMethodCleanup() override \
+    {                                   \
+        methodName();                   \
+    }                                   \
+    void methodName()
+
+namespace Microsoft::VisualStudio::CppUnitTestFramework
+{
+    template<typename Q>
+    std::wstring ToString(const Q& value)
+    {
+        if constexpr (std::is_same_v<Q, std::wstring> || std::is_same_v<Q, std::wstring_view>)
+        {
+            return std::wstring{ value };
+        }
+        else if constexpr (std::is_same_v<Q, std::string> || std::is_same_v<Q, std::string_view>)
+        {
+            return std::wstring(value.begin(), value.end());
+        }
+        else if constexpr (std::is_same_v<Q, bool>)
+        {
+            return value ? L"true" : L"false";
+        }
+        else if constexpr (std::is_same_v<Q, char> || std::is_same_v<Q, signed char> || std::is_same_v<Q, unsigned char>)
+        {
+            return std::to_wstring(static_cast<int>(value));
+        }
+        else if constexpr (PortableTests::IsWideStreamable<Q>::value)
+        {
+            std::wostringstream stream;
+            stream << value;
+            return stream.str();
+        }
+        else
+        {
+            return L"<value>";
+        }
+    }
+
+    class Assert
+    {
+    public:
+        template<typename T>
+        static void AreEqual(const T& expected, const T& actual, const wchar_t* message = nullptr)
+        {
+            if (!(expected == actual))
+            {
+                Fail(L"Assert failed. Expected:<" + ToString(expected) + L"> Actual:<" + ToString(actual) + L">", message);
+            }
+        }
+
+        static void AreEqual(const wchar_t* expected, const wchar_t* actual, bool ignoreCase = false, const wchar_t* message = nullptr)
+        {
+            if (!Equal(std::wstring_view{ expected }, std::wstring_view{ actual }, ignoreCase))
+            {
+                Fail(std::wstring(L"Assert failed. Expected:<") + expected + L"> Actual:<" + actual + L">", message);
+            }
+        }
+
+        static void AreEqual(const char* expected, const char* actual, bool ignoreCase = false, const wchar_t* message = nullptr)
+        {
+            const std::wstring wideExpected(expected, expected + std::char_traits<char>::length(expected));
+            const std::wstring wideActual(actual, actual + std::char_traits<char>::length(actual));
+            AreEqual(wideExpected.c_str(), wideActual.c_str(), ignoreCase, message);
+        }
+
+        static void AreEqual(double expected, double actual, double tolerance, const wchar_t* message = nullptr)
+        {
+            if (std::abs(expected - actual) > tolerance)
+            {
+                Fail(L"Assert failed. Expected:<" + ToString(expected) + L"> Actual:<" + ToString(actual) + L">", message);
+            }
+        }
+
+        static void AreEqual(float expected, float actual, float tolerance, const wchar_t* message = nullptr)
+        {
+            AreEqual(static_cast<double>(expected), static_cast<double>(actual), static_cast<double>(tolerance), message);
+        }
+
+        template<typename T>
+        static void AreNotEqual(const T& notExpected, const T& actual, const wchar_t* message = nullptr)
+        {
+            if (notExpected == actual)
+            {
+                Fail(L"Assert failed. Not expected:<" + ToString(notExpected) + L"> Actual:<" + ToString(actual) + L">", message);
+            }
+        }
+
+        static void IsTrue(bool condition, const wchar_t* message = nullptr)
+        {
+            if (!condition)
+            {
+                Fail(L"Assert failed", message);
+            }
+        }
+
+        static void IsFalse(bool condition, const wchar_t* message = nullptr)
+        {
+            if (condition)
+            {
+                Fail(L"Assert failed", message);
+            }
+        }
+
+        template<typename T>
+        static void IsNull(const T* pointer, const wchar_t* message = nullptr)
+        {
+            IsTrue(pointer == nullptr, message);
+        }
+
+        template<typename T>
+        static void IsNotNull(const T* pointer, const wchar_t* message = nullptr)
+        {
+            IsTrue(pointer != nullptr, message);
+        }
+
+        static void Fail(const wchar_t* message = nullptr)
+        {
+            Fail(L"Assert failed", message);
+        }
+
+        template<typename ExpectedException, typename Functor>
+        static void ExpectException(Functor functor, const wchar_t* message = nullptr)
+        {
+            try
+            {
+                functor();
+            }
+            catch (const ExpectedException&)
+            {
+                return;
+            }
+            catch (...)
+            {
+                Fail(L"Assert failed. Unexpected exception type", message);
+            }
+
+            Fail(L"Assert failed. No exception was thrown", message);
+        }
+
+    private:
+        static bool Equal(std::wstring_view left, std::wstring_view right, bool ignoreCase)
+        {
+            if (left.size() != right.size())
+            {
+                return false;
+            }
+
+            for (size_t i = 0; i < left.size(); ++i)
+            {
+                if (ignoreCase ? std::towlower(left[i]) != std::towlower(right[i]) : left[i] != right[i])
+                {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
+        [[noreturn]] static void Fail(const std::wstring& what, const wchar_t* message)
+        {
+            throw PortableTests::AssertFailure{ message ? what + L" - " + message : what };
+        }
+    };
+
+    class Logger
+    {
+    public:
+        static void WriteMessage(const wchar_t* message)
+        {
+            std::fputs(PortableTests::ToUtf8(message).c_str(), stdout);
+        }
+
+        static void WriteMessage(const char* message)
+        {
+            std::fputs(message, stdout);
+        }
+    };
+}
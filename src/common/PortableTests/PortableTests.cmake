@@ -0,0 +1,36 @@
+# Builds tests written for the Microsoft C++ unit test framework against the portable stand-in in this folder.
+#
+#   add_portable_test(<name>
+#       SOURCES <code under test>...
+#       TESTS <test files>...
+#       [INCLUDE_DIRECTORIES <dirs>...]
+#       [DEFINITIONS <definitions>...])
+#
+# The test files are copied next to the build, so that their #include "pch.h" picks the portable pch.h
+# instead of the precompiled header of the Windows test project they live in.
+
+set(POWERTOYS_PORTABLE_TESTS_DIR ${CMAKE_CURRENT_LIST_DIR})
+
+function(add_portable_test name)
+    cmake_parse_arguments(PARSE_ARGV 1 ARG "" "" "SOURCES;TESTS;INCLUDE_DIRECTORIES;DEFINITIONS")
+
+    set(copied_tests)
+    foreach(test_file IN LISTS ARG_TESTS)
+        get_filename_component(test_path ${test_file} ABSOLUTE)
+        get_filename_component(test_name ${test_file} NAME)
+        set(copied_test ${CMAKE_CURRENT_BINARY_DIR}/${name}.tests/${test_name})
+        configure_file(${test_path} ${copied_test} COPYONLY)
+        list(APPEND copied_tests ${copied_test})
+    endforeach()
+
+    add_executable(${name} ${ARG_SOURCES} ${copied_tests} ${POWERTOYS_PORTABLE_TESTS_DIR}/TestRunner.cpp)
+    target_include_directories(${name} PRIVATE
+        ${POWERTOYS_PORTABLE_TESTS_DIR}
+        ${CMAKE_CURRENT_SOURCE_DIR}
+        ${ARG_INCLUDE_DIRECTORIES}
+        ${POWERTOYS_ROOT}/src)
+    target_compile_definitions(${name} PRIVATE ${ARG_DEFINITIONS})
+    target_compile_options(${name} PRIVATE -Wall -Wextra)
+
+    add_test(NAME ${name} COMMAND ${name})
+endfunction()
@@ -0,0 +1,45 @@
+#include "CppUnitTest.h"
+
+#include <cstring>
+
+// Runs the registered test methods whose "Class::Method" name contains the optional filter argument
+int main(int argc, char* argv[])
+{
+    const char* filter = argc > 1 ? argv[1] : "";
+
+    int passed = 0;
+    int failed = 0;
+    for (const auto& test : PortableTests::RegisteredTests())
+    {
+        const std::string name = std::string{ test.className } + "::" + test.methodName;
+        if (name.find(filter) == std::string::npos)
+        {
+            continue;
+        }
+
+        try
+        {
+            test.run();
+            std::printf("Passed %s\n", name.c_str());
+            ++passed;
+        }
+        catch (const PortableTests::AssertFailure& failure)
+        {
+            std::printf("FAILED %s: %s\n", name.c_str(), PortableTests::ToUtf8(failure.message).c_str());
+            ++failed;
+        }
+        catch (const std::exception& exception)
+        {
+            std::printf("FAILED %s: unexpected exception: %s\n", name.c_str(), exception.what());
+            ++failed;
+        }
+        catch (...)
+        {
+            std::printf("FAILED %s: unexpected exception\n", name.c_str());
+            ++failed;
+        }
+    }
+
+    std::printf("%d passed, %d failed\n", passed, failed);
+    return failed == 0 && passed > 0 ? 0 : 1;
+}
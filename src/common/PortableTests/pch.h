@@ -0,0 +1,12 @@
+#pragma once
+
+// Stands in for the precompiled header of the Windows test projects when their tests are built with CMake
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "CppUnitTest.h"
@@ -0,0 +1,143 @@
+#include "pch.h"
+#include "settings_cache.h"
+
+#include "../utils/json.h"
+
+namespace PowerToysSettings
+{
+    SettingsCache::SettingsCache(Reader general_reader)
+    {
+        m_general.reader = std::move(general_reader);
+        m_general.json_key = L"\"general\"";
+    }
+
+    bool SettingsCache::has_module(const std::wstring& module_key) const
+    {
+        return m_modules.contains(module_key);
+    }
+
+    void SettingsCache::add_module(const std::wstring& module_key, Reader reader)
+    {
+        Entry entry;
+        entry.reader = std::move(reader);
+        entry.json_key = json::value(module_key).Stringify().c_str();
+        m_modules.insert_or_assign(module_key, std::move(entry));
+    }
+
+    void SettingsCache::invalidate_general()
+    {
+        m_general.stale = true;
+    }
+
+    void SettingsCache::invalidate_module(const std::wstring& module_key)
+    {
+        auto it = m_modules.find(module_key);
+        if (it != m_modules.end())
+        {
+            it->second.stale = true;
+        }
+    }
+
+    void SettingsCache::invalidate_all()
+    {
+        m_general.stale = true;
+        for (auto& [key, entry] : m_modules)
+        {
+            entry.stale = true;
+        }
+    }
+
+    uint64_t SettingsCache::version()
+    {
+        refresh_all();
+        return m_version;
+    }
+
+    std::wstring SettingsCache::full_message()
+    {
+        return build_message(0, false);
+    }
+
+    std::wstring SettingsCache::diff_message(uint64_t base_version)
+    {
+        return build_message(base_version, true);
+    }
+
+    void SettingsCache::refresh(Entry& entry)
+    {
+        if (!entry.stale)
+        {
+            return;
+        }
+
+        // A failed read keeps the previous settings, and is tried again next time
+        auto serialized = entry.reader();
+        if (!serialized)
+        {
+            return;
+        }
+
+        entry.stale = false;
+        if (*serialized == entry.serialized)
+        {
+            return;
+        }
+
+        json::JsonObject parsed;
+        if (!json::JsonObject::TryParse(*serialized, parsed))
+        {
+            return;
+        }
+
+        entry.serialized = std::move(*serialized);
+        entry.version = ++m_version;
+    }
+
+    void SettingsCache::refresh_all()
+    {
+        refresh(m_general);
+        for (auto& [key, entry] : m_modules)
+        {
+            refresh(entry);
+        }
+    }
+
+    std::wstring SettingsCache::build_message(uint64_t base_version, bool diff)
+    {
+        refresh_all();
+
+        auto included = [&](const Entry& entry) {
+            return !entry.serialized.empty() && (!diff || entry.version > base_version);
+        };
+
+        std::wstring message = L"{";
+        if (included(m_general))
+        {
+            message += m_general.json_key + L":" + m_general.serialized + L",";
+        }
+
+        message += L"\"powertoys\":{";
+        bool first = true;
+        for (const auto& [key, entry] : m_modules)
+        {
+            if (included(entry))
+            {
+                if (!first)
+                {
+                    message += L",";
+                }
+                message += entry.json_key + L":" + entry.serialized;
+                first = false;
+            }
+        }
+
+        message += L"},\"version\":" + std::to_wstring(m_version);
+        if (diff)
+        {
+            message += L",\"base_version\":" + std::to_wstring(base_version);
+        }
+
+        message += L"}";
+        return message;
+    }
+}
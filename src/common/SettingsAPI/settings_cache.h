@@ -0,0 +1,54 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <optional>
+#include <string>
+
+namespace PowerToysSettings
+{
+    // Keeps the serialized general and module settings sent to the Settings process, so that each of them
+    // is only read again after it was invalidated, and only sent again when its content changed
+    class SettingsCache
+    {
+    public:
+        // Returns the settings as a json string, or nothing if they can't be read
+        using Reader = std::function<std::optional<std::wstring>()>;
+
+        explicit SettingsCache(Reader general_reader);
+
+        bool has_module(const std::wstring& module_key) const;
+        void add_module(const std::wstring& module_key, Reader reader);
+
+        void invalidate_general();
+        void invalidate_module(const std::wstring& module_key);
+        void invalidate_all();
+
+        // Version of the most recent change, read again entries which were invalidated first
+        uint64_t version();
+
+        // {"general":{...},"powertoys":{...},"version":N} with every entry
+        std::wstring full_message();
+
+        // Same as full_message, but only with the entries which changed after base_version
+        std::wstring diff_message(uint64_t base_version);
+
+    private:
+        struct Entry
+        {
+            Reader reader;
+            std::wstring json_key;
+            std::wstring serialized;
+            uint64_t version = 0;
+            bool stale = true;
+        };
+
+        void refresh(Entry& entry);
+        void refresh_all();
+        std::wstring build_message(uint64_t base_version, bool diff);
+
+        Entry m_general;
+        std::map<std::wstring, Entry> m_modules;
+        uint64_t m_version = 0;
+    };
+}
@@ -0,0 +1,313 @@
+#include "pch.h"
+
+#include <fstream>
+#include <map>
+#include <random>
+#include <vector>
+
+#include <common/updating/delta_update.h>
+#include <common/updating/sha256.h>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace updating;
+
+namespace UnitTestsCommonLib
+{
+    namespace
+    {
+        std::vector<uint8_t> RandomData(size_t size, unsigned int seed)
+        {
+            std::vector<uint8_t> data(size);
+            std::mt19937 generator{ seed };
+            std::generate(data.begin(), data.end(), [&] { return static_cast<uint8_t>(generator()); });
+            return data;
+        }
+
+        std::vector<uint8_t> ToBytes(const std::string& text)
+        {
+            return { text.begin(), text.end() };
+        }
+
+        std::string ToHex(const sha256_digest& digest)
+        {
+            std::string hex;
+            for (uint8_t byte : digest)
+            {
+                hex += "0123456789abcdef"[byte >> 4];
+                hex += "0123456789abcdef"[byte & 0xf];
+            }
+
+            return hex;
+        }
+
+        std::vector<uint8_t> ReadAll(const std::filesystem::path& path)
+        {
+            std::ifstream file{ path, std::ios::binary };
+            return std::vector<uint8_t>{ std::istreambuf_iterator<char>{ file }, std::istreambuf_iterator<char>{} };
+        }
+
+        void WriteAll(const std::filesystem::path& path, const std::vector<uint8_t>& data)
+        {
+            std::filesystem::create_directories(path.parent_path());
+            std::ofstream file{ path, std::ios::binary | std::ios::trunc };
+            file.write(reinterpret_cast<const char*>(data.data()), data.size());
+        }
+
+        // Content of the files in the directory by their relative path
+        std::map<std::wstring, std::vector<uint8_t>> ReadTree(const std::filesystem::path& directory)
+        {
+            std::map<std::wstring, std::vector<uint8_t>> files;
+            for (const auto& entry : std::filesystem::recursive_directory_iterator(directory))
+            {
+                if (entry.is_regular_file())
+                {
+                    files.emplace(entry.path().lexically_relative(directory).generic_wstring(), ReadAll(entry.path()));
+                }
+            }
+
+            return files;
+        }
+
+        // Replaces the first occurrence of the bytes, which must have the same size as the replacement
+        void ReplaceBytes(std::vector<uint8_t>& data, const std::string& bytes, const std::string& replacement)
+        {
+            auto it = std::search(data.begin(), data.end(), bytes.begin(), bytes.end());
+            Assert::IsTrue(it != data.end());
+            std::copy(replacement.begin(), replacement.end(), it);
+        }
+    }
+
+    TEST_CLASS (DeltaUpdateUnitTests)
+    {
+    private:
+        const std::filesystem::path m_directory = std::filesystem::temp_directory_path() / L"PowerToysDeltaUpdateTests";
+        const std::filesystem::path m_oldVersion = m_directory / L"old";
+        const std::filesystem::path m_newVersion = m_directory / L"new";
+        const std::filesystem::path m_installation = m_directory / L"PowerToys";
+        const std::filesystem::path m_patch = m_directory / L"update.ptdelta";
+
+        // Turns old data into new data the way a rebuild changes a binary: modified bytes, and inserted, removed and appended ranges
+        static std::vector<uint8_t> EditData(std::vector<uint8_t> data, unsigned int seed)
+        {
+            std::mt19937 generator{ seed };
+            for (size_t offset = 0; offset < data.size(); offset += 1000 + generator() % 4000)
+            {
+                data[offset] = static_cast<uint8_t>(generator());
+            }
+
+            const auto inserted = RandomData(3000, seed + 1);
+            data.insert(data.begin() + data.size() / 3, inserted.begin(), inserted.end());
+            data.erase(data.begin() + data.size() / 2, data.begin() + data.size() / 2 + 5000);
+            data.insert(data.end(), inserted.begin(), inserted.begin() + 100);
+            return data;
+        }
+
+        // The old version has a file which is patched, one which stays the same and one which is removed. The new version adds a file
+        void CreateVersions()
+        {
+            const auto module = RandomData(300 * 1024, 1);
+            WriteAll(m_oldVersion / L"PowerToys.Module.dll", module);
+            WriteAll(m_oldVersion / L"modules/Same.dll", RandomData(50 * 1024, 2));
+            WriteAll(m_oldVersion / L"modules/Removed.dll", RandomData(10 * 1024, 3));
+            WriteAll(m_oldVersion / L"empty.txt", {});
+
+            std::filesystem::copy(m_oldVersion, m_newVersion, std::filesystem::copy_options::recursive);
+            std::filesystem::remove(m_newVersion / L"modules/Removed.dll");
+            WriteAll(m_newVersion / L"PowerToys.Module.dll", EditData(module, 4));
+            WriteAll(m_newVersion / L"modules/Added.dll", RandomData(20 * 1024, 5));
+
+            std::filesystem::copy(m_oldVersion, m_installation, std::filesystem::copy_options::recursive);
+        }
+
+        bool HasLeftovers()
+        {
+            auto staging = m_installation;
+            staging += L".delta-staging";
+            auto backup = m_installation;
+            backup += L".delta-backup";
+            return std::filesystem::exists(staging) || std::filesystem::exists(backup);
+        }
+
+    public:
+        TEST_METHOD_INITIALIZE(Initialize)
+        {
+            std::error_code ec;
+            std::filesystem::remove_all(m_directory, ec);
+            std::filesystem::create_directories(m_directory);
+        }
+
+        TEST_METHOD_CLEANUP(Cleanup)
+        {
+            std::error_code ec;
+            std::filesystem::remove_all(m_directory, ec);
+        }
+
+        TEST_METHOD (Sha256_MatchesKnownDigests)
+        {
+            const auto empty = ToBytes("");
+            Assert::AreEqual(std::string{ "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855" }, ToHex(compute_sha256(empty.data(), empty.size())));
+
+            const auto abc = ToBytes("abc");
+            Assert::AreEqual(std::string{ "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad" }, ToHex(compute_sha256(abc.data(), abc.size())));
+
+            // The padding doesn't fit in the last block of this one
+            const auto twoBlocks = ToBytes("abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq");
+            Assert::AreEqual(std::string{ "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1" }, ToHex(compute_sha256(twoBlocks.data(), twoBlocks.size())));
+        }
+
+        TEST_METHOD (Sha256_HashesDataInPieces)
+        {
+            // A million 'a' in pieces of uneven sizes
+            const std::vector<uint8_t> data(1000000, 'a');
+            sha256 hash;
+            for (size_t offset = 0, size = 1; offset < data.size(); offset += size, size = size % 200 + 7)
+            {
+                hash.update(data.data() + offset, std::min(size, data.size() - offset));
+            }
+
+            Assert::AreEqual(std::string{ "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0" }, ToHex(hash.finish()));
+        }
+
+        TEST_METHOD (BinaryDelta_RebuildsEditedData)
+        {
+            const auto oldData = RandomData(256 * 1024, 6);
+            const auto newData = EditData(oldData, 7);
+
+            const auto delta = create_binary_delta(oldData, newData);
+            Assert::IsTrue(apply_binary_delta(oldData, delta) == newData);
+
+            // The edits are a few percent of the data
+            Assert::IsTrue(delta.size() < newData.size() / 10);
+        }
+
+        TEST_METHOD (BinaryDelta_RebuildsSmallAndEmptyData)
+        {
+            const std::vector<std::vector<uint8_t>> samples = { {}, ToBytes("a"), RandomData(31, 8), RandomData(32, 9), RandomData(100, 10) };
+            for (const auto& oldData : samples)
+            {
+                for (const auto& newData : samples)
+                {
+                    Assert::IsTrue(apply_binary_delta(oldData, create_binary_delta(oldData, newData)) == newData);
+                }
+            }
+        }
+
+        TEST_METHOD (BinaryDelta_RejectsInvalidDelta)
+        {
+            const auto oldData = RandomData(64 * 1024, 11);
+            const auto newData = EditData(oldData, 12);
+            const auto delta = create_binary_delta(oldData, newData);
+
+            // Truncated, and applied to data too short for its copies
+            Assert::IsFalse(apply_binary_delta(oldData, std::vector<uint8_t>(delta.begin(), delta.end() - 1)).has_value());
+            Assert::IsFalse(apply_binary_delta(std::vector<uint8_t>(oldData.begin(), oldData.begin() + 1024), delta).has_value());
+            Assert::IsFalse(apply_binary_delta(oldData, {}).has_value());
+        }
+
+        TEST_METHOD (DeltaPatch_UpdatesInstallation)
+        {
+            CreateVersions();
+
+            const auto stats = create_delta_patch(m_oldVersion, m_newVersion, m_patch);
+            Assert::IsTrue(stats.has_value());
+            Assert::AreEqual(static_cast<size_t>(2), stats->unchanged_files);
+            Assert::AreEqual(static_cast<size_t>(1), stats->patched_files);
+            Assert::AreEqual(static_cast<size_t>(1), stats->added_files);
+            Assert::AreEqual(static_cast<size_t>(1), stats->removed_files);
+
+            // The patch carries the added file and the edits of the patched one
+            Assert::IsTrue(stats->patch_size < 20 * 1024 + 30 * 1024);
+            Assert::IsTrue(stats->patch_size < stats->new_size / 5);
+
+            Assert::IsTrue(delta_apply_result::success == apply_delta_patch(m_installation, m_patch));
+            Assert::IsTrue(ReadTree(m_newVersion) == ReadTree(m_installation));
+            Assert::IsFalse(HasLeftovers());
+        }
+
+        TEST_METHOD (DeltaPatch_LeavesInstallationUntouched_WhenBaseDiffers)
+        {
+            CreateVersions();
+            Assert::IsTrue(create_delta_patch(m_oldVersion, m_newVersion, m_patch).has_value());
+
+            // The patched file and an unchanged file are both checked
+            for (const auto* file : { L"PowerToys.Module.dll", L"modules/Same.dll" })
+            {
+                std::filesystem::remove_all(m_installation);
+                std::filesystem::copy(m_oldVersion, m_installation, std::filesystem::copy_options::recursive);
+                auto data = ReadAll(m_installation / file);
+                data[data.size() / 2] ^= 1;
+                WriteAll(m_installation / file, data);
+                const auto before = ReadTree(m_installation);
+
+                Assert::IsTrue(delta_apply_result::base_mismatch == apply_delta_patch(m_installation, m_patch));
+                Assert::IsTrue(before == ReadTree(m_installation));
+                Assert::IsFalse(HasLeftovers());
+            }
+        }
+
+        TEST_METHOD (DeltaPatch_LeavesInstallationUntouched_WhenPatchIsCorrupted)
+        {
+            CreateVersions();
+            Assert::IsTrue(create_delta_patch(m_oldVersion, m_newVersion, m_patch).has_value());
+            const auto patch = ReadAll(m_patch);
+            const auto before = ReadTree(m_installation);
+
+            // Corrupt bytes all over the patch, from the header to the data of the files
+            for (size_t offset = 0; offset < patch.size(); offset += patch.size() / 50 + 1)
+            {
+                auto corrupted = patch;
+                corrupted[offset] ^= 0x5a;
+                WriteAll(m_patch, corrupted);
+
+                Assert::IsTrue(delta_apply_result::success != apply_delta_patch(m_installation, m_patch));
+                Assert::IsTrue(before == ReadTree(m_installation));
+                Assert::IsFalse(HasLeftovers());
+            }
+
+            WriteAll(m_patch, std::vector<uint8_t>(patch.begin(), patch.end() - 1));
+            Assert::IsTrue(delta_apply_result::invalid_patch == apply_delta_patch(m_installation, m_patch));
+        }
+
+        TEST_METHOD (DeltaPatch_RejectsPathsOutsideInstallation)
+        {
+            CreateVersions();
+            WriteAll(m_newVersion / L"zzzz", RandomData(100, 13));
+            Assert::IsTrue(create_delta_patch(m_oldVersion, m_newVersion, m_patch).has_value());
+
+            // Sign the patch again, after the signature and the digest of the rest
+            auto patch = ReadAll(m_patch);
+            ReplaceBytes(patch, "zzzz", "../z");
+            const auto digest = compute_sha256(patch.data() + 40, patch.size() - 40);
+            std::copy(digest.begin(), digest.end(), patch.begin() + 8);
+            WriteAll(m_patch, patch);
+
+            Assert::IsTrue(delta_apply_result::invalid_patch == apply_delta_patch(m_installation, m_patch));
+            Assert::IsFalse(std::filesystem::exists(m_directory / L"z"));
+            Assert::IsFalse(HasLeftovers());
+        }
+
+        TEST_METHOD (DeltaPatch_RejectsDuplicatePaths)
+        {
+            // Same old content, so the patched entry also matches the base once it's renamed to the unchanged file
+            const auto shared = RandomData(50 * 1024, 14);
+            WriteAll(m_oldVersion / L"a/Shared.dll", shared);
+            WriteAll(m_oldVersion / L"b/Shared.dll", shared);
+            WriteAll(m_newVersion / L"a/Shared.dll", shared);
+            WriteAll(m_newVersion / L"b/Shared.dll", EditData(shared, 15));
+            std::filesystem::copy(m_oldVersion, m_installation, std::filesystem::copy_options::recursive);
+            Assert::IsTrue(create_delta_patch(m_oldVersion, m_newVersion, m_patch).has_value());
+
+            // The unchanged entry is linked into the staging directory first, the patched one would then write through the link
+            auto patch = ReadAll(m_patch);
+            ReplaceBytes(patch, "b/Shared.dll", "a/Shared.dll");
+            const auto digest = compute_sha256(patch.data() + 40, patch.size() - 40);
+            std::copy(digest.begin(), digest.end(), patch.begin() + 8);
+            WriteAll(m_patch, patch);
+            const auto before = ReadTree(m_installation);
+
+            Assert::IsTrue(delta_apply_result::invalid_patch == apply_delta_patch(m_installation, m_patch));
+            Assert::IsTrue(before == ReadTree(m_installation));
+            Assert::IsFalse(HasLeftovers());
+        }
+    };
+}
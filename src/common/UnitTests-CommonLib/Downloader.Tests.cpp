@@ -0,0 +1,368 @@
+#include "pch.h"
+
+#include <atomic>
+#include <fstream>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include <common/updating/downloader.h>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace updating;
+
+namespace UnitTestsCommonLib
+{
+    namespace
+    {
+        constexpr size_t MiB = 1024 * 1024;
+
+        // Decrements the count if it is positive, returns whether it did
+        bool TakeOne(std::atomic<int>& count)
+        {
+            int value = count.load();
+            while (value > 0 && !count.compare_exchange_weak(value, value - 1))
+            {
+            }
+
+            return value > 0;
+        }
+
+        // Serves a file over HTTP on the loopback interface, standing in for the release download server. Failures are injected in the next responses
+        class LocalHttpServer
+        {
+        public:
+            explicit LocalHttpServer(std::vector<uint8_t> content) :
+                m_content(std::move(content))
+            {
+                WSADATA wsaData;
+                Assert::AreEqual(0, WSAStartup(MAKEWORD(2, 2), &wsaData));
+
+                m_listener = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+                sockaddr_in address{};
+                address.sin_family = AF_INET;
+                address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+                int addressSize = sizeof(address);
+                Assert::AreEqual(0, bind(m_listener, reinterpret_cast<sockaddr*>(&address), addressSize));
+                Assert::AreEqual(0, listen(m_listener, SOMAXCONN));
+                Assert::AreEqual(0, getsockname(m_listener, reinterpret_cast<sockaddr*>(&address), &addressSize));
+                m_port = ntohs(address.sin_port);
+
+                m_acceptThread = std::thread([this] { AcceptConnections(); });
+            }
+
+            ~LocalHttpServer()
+            {
+                closesocket(m_listener);
+                m_acceptThread.join();
+                for (auto& connectionThread : m_connectionThreads)
+                {
+                    connectionThread.join();
+                }
+
+                WSACleanup();
+            }
+
+            winrt::Windows::Foundation::Uri Url() const
+            {
+                return winrt::Windows::Foundation::Uri{ L"http://127.0.0.1:" + std::to_wstring(m_port) + L"/powertoyssetup-x64.exe" };
+            }
+
+            // Send the whole file for range requests, like a server without range support
+            std::atomic<bool> ignoreRanges = false;
+            // Number of the next requests answered with 503
+            std::atomic<int> failedResponses = 0;
+            // Number of the next responses closed after cutAfterBytes bytes of the body. Only responses with a larger body are cut
+            std::atomic<int> cutResponses = 0;
+            std::atomic<size_t> cutAfterBytes = 0;
+
+            std::atomic<size_t> requestCount = 0;
+            std::atomic<size_t> bodyBytesSent = 0;
+
+        private:
+            void AcceptConnections()
+            {
+                for (;;)
+                {
+                    SOCKET connection = accept(m_listener, nullptr, nullptr);
+                    if (connection == INVALID_SOCKET)
+                    {
+                        return;
+                    }
+
+                    m_connectionThreads.emplace_back([this, connection] {
+                        HandleConnection(connection);
+                        shutdown(connection, SD_SEND);
+                        closesocket(connection);
+                    });
+                }
+            }
+
+            void HandleConnection(SOCKET connection)
+            {
+                std::string request;
+                char buffer[4096];
+                while (request.find("\r\n\r\n") == std::string::npos)
+                {
+                    const int received = recv(connection, buffer, sizeof(buffer), 0);
+                    if (received <= 0)
+                    {
+                        return;
+                    }
+
+                    request.append(buffer, received);
+                }
+
+                requestCount++;
+                if (TakeOne(failedResponses))
+                {
+                    SendAll(connection, "HTTP/1.1 503 Service Unavailable\r\nContent-Length: 0\r\nConnection: close\r\n\r\n");
+                    return;
+                }
+
+                std::transform(request.begin(), request.end(), request.begin(), [](char c) { return static_cast<char>(tolower(static_cast<unsigned char>(c))); });
+                const size_t rangeHeader = request.find("\r\nrange: bytes=");
+                unsigned long long first = 0;
+                unsigned long long last = m_content.size() - 1;
+                const bool isRange = !ignoreRanges && rangeHeader != std::string::npos && sscanf_s(request.c_str() + rangeHeader, "\r\nrange: bytes=%llu-%llu", &first, &last) == 2;
+                last = std::min<unsigned long long>(last, m_content.size() - 1);
+
+                const size_t bodySize = static_cast<size_t>(last - first + 1);
+                std::string header = isRange ? "HTTP/1.1 206 Partial Content\r\nContent-Range: bytes " + std::to_string(first) + "-" + std::to_string(last) + "/" + std::to_string(m_content.size()) + "\r\n" : "HTTP/1.1 200 OK\r\n";
+                header += "Content-Type: application/octet-stream\r\nContent-Length: " + std::to_string(bodySize) + "\r\nConnection: close\r\n\r\n";
+                if (!SendAll(connection, header))
+                {
+                    return;
+                }
+
+                const size_t sentSize = bodySize > cutAfterBytes && TakeOne(cutResponses) ? cutAfterBytes.load() : bodySize;
+                const char* body = reinterpret_cast<const char*>(m_content.data()) + first;
+                for (size_t sent = 0; sent < sentSize;)
+                {
+                    const int count = send(connection, body + sent, static_cast<int>(std::min<size_t>(sentSize - sent, 64 * 1024)), 0);
+                    if (count <= 0)
+                    {
+                        return;
+                    }
+
+                    sent += count;
+                    bodyBytesSent += static_cast<size_t>(count);
+                }
+            }
+
+            bool SendAll(SOCKET connection, const std::string& data)
+            {
+                for (size_t sent = 0; sent < data.size();)
+                {
+                    const int count = send(connection, data.c_str() + sent, static_cast<int>(data.size() - sent), 0);
+                    if (count <= 0)
+                    {
+                        return false;
+                    }
+
+                    sent += count;
+                }
+
+                return true;
+            }
+
+            std::vector<uint8_t> m_content;
+            SOCKET m_listener = INVALID_SOCKET;
+            uint16_t m_port = 0;
+            std::thread m_acceptThread;
+            std::vector<std::thread> m_connectionThreads;
+        };
+    }
+
+    TEST_CLASS (DownloaderUnitTests)
+    {
+    private:
+        const std::filesystem::path m_directory = std::filesystem::temp_directory_path() / L"PowerToysDownloaderTests";
+        const std::filesystem::path m_destination = m_directory / L"powertoyssetup-x64.exe";
+        std::vector<uint8_t> m_content;
+
+        static std::vector<uint8_t> ReadAll(const std::filesystem::path& path)
+        {
+            std::ifstream file{ path, std::ios::binary };
+            return std::vector<uint8_t>{ std::istreambuf_iterator<char>{ file }, std::istreambuf_iterator<char>{} };
+        }
+
+        void WriteAll(const std::filesystem::path& path, const std::string& data)
+        {
+            std::ofstream file{ path, std::ios::binary };
+            file << data;
+        }
+
+        sha256_digest ContentDigest()
+        {
+            const auto source = m_directory / L"source.bin";
+            WriteAll(source, std::string{ m_content.begin(), m_content.end() });
+            return *compute_file_sha256(source);
+        }
+
+        // The file is split in three ranges of 2 MiB and a last one of 512 KiB
+        download_options ParallelOptions()
+        {
+            download_options options;
+            options.max_parallel_ranges = 4;
+            options.min_range_size = MiB;
+            options.expected_sha256 = ContentDigest();
+            return options;
+        }
+
+        bool HasPartialFiles()
+        {
+            auto partial = m_destination;
+            partial += L".partial";
+            auto ranges = partial;
+            ranges += L".ranges";
+            return std::filesystem::exists(partial) || std::filesystem::exists(ranges);
+        }
+
+    public:
+        TEST_METHOD_INITIALIZE(Initialize)
+        {
+            std::error_code ec;
+            std::filesystem::remove_all(m_directory, ec);
+            std::filesystem::create_directories(m_directory);
+
+            m_content.resize(6 * MiB + MiB / 2);
+            std::mt19937 generator{ 47 };
+            std::generate(m_content.begin(), m_content.end(), [&] { return static_cast<uint8_t>(generator()); });
+        }
+
+        TEST_METHOD_CLEANUP(Cleanup)
+        {
+            std::error_code ec;
+            std::filesystem::remove_all(m_directory, ec);
+        }
+
+        TEST_METHOD (ParseSha256Digest)
+        {
+            const auto digest = parse_sha256_digest(L"sha256:BA7816BF8F01CFEA414140DE5DAE2223B00361A396177A9CB410FF61F20015AD");
+            Assert::IsTrue(digest.has_value());
+            Assert::AreEqual(static_cast<int>(0xba), static_cast<int>((*digest)[0]));
+            Assert::AreEqual(static_cast<int>(0xad), static_cast<int>((*digest)[31]));
+            Assert::IsTrue(digest == parse_sha256_digest(L"ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad"));
+
+            Assert::IsFalse(parse_sha256_digest(L"").has_value());
+            Assert::IsFalse(parse_sha256_digest(L"sha256:ba7816bf").has_value());
+            Assert::IsFalse(parse_sha256_digest(L"ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ag").has_value());
+        }
+
+        TEST_METHOD (ComputeFileSha256)
+        {
+            const auto empty = m_directory / L"empty.bin";
+            WriteAll(empty, "");
+            Assert::IsTrue(compute_file_sha256(empty) == parse_sha256_digest(L"e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855"));
+
+            const auto abc = m_directory / L"abc.bin";
+            WriteAll(abc, "abc");
+            Assert::IsTrue(compute_file_sha256(abc) == parse_sha256_digest(L"ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad"));
+
+            Assert::IsFalse(compute_file_sha256(m_directory / L"missing.bin").has_value());
+        }
+
+        TEST_METHOD (DownloadFile_DownloadsRangesInParallel)
+        {
+            LocalHttpServer server{ m_content };
+
+            Assert::IsTrue(download_result::success == download_file(server.Url(), m_destination, ParallelOptions()));
+            Assert::IsTrue(m_content == ReadAll(m_destination));
+            Assert::IsFalse(HasPartialFiles());
+
+            // The first byte and the four ranges
+            Assert::AreEqual(static_cast<size_t>(5), server.requestCount.load());
+            Assert::AreEqual(m_content.size() + 1, server.bodyBytesSent.load());
+        }
+
+        TEST_METHOD (DownloadFile_ReportsProgress)
+        {
+            LocalHttpServer server{ m_content };
+            auto options = ParallelOptions();
+            std::vector<float> progress;
+            options.progress_callback = [&](float value) { progress.push_back(value); };
+
+            Assert::IsTrue(download_result::success == download_file(server.Url(), m_destination, options));
+            Assert::IsFalse(progress.empty());
+            Assert::IsTrue(std::is_sorted(progress.begin(), progress.end()));
+            Assert::AreEqual(1.0f, progress.back());
+        }
+
+        TEST_METHOD (DownloadFile_ResumesRanges_WhenConnectionsDrop)
+        {
+            LocalHttpServer server{ m_content };
+            server.cutResponses = 3;
+            server.cutAfterBytes = MiB + MiB / 2;
+
+            Assert::IsTrue(download_result::success == download_file(server.Url(), m_destination, ParallelOptions()));
+            Assert::IsTrue(m_content == ReadAll(m_destination));
+            Assert::IsFalse(HasPartialFiles());
+
+            // At least the first MiB of each cut range was kept, so at most the half MiB after it is sent again
+            Assert::IsTrue(server.bodyBytesSent <= m_content.size() + 3 * (MiB / 2) + 2);
+        }
+
+        TEST_METHOD (DownloadFile_ResumesPreviousDownload)
+        {
+            LocalHttpServer server{ m_content };
+            server.cutResponses = 3;
+            server.cutAfterBytes = MiB + MiB / 2;
+            auto options = ParallelOptions();
+            options.max_attempts = 1;
+
+            Assert::IsTrue(download_result::network_error == download_file(server.Url(), m_destination, options));
+            Assert::IsFalse(std::filesystem::exists(m_destination));
+            Assert::IsTrue(HasPartialFiles());
+
+            // Only the parts after the first MiB of the three cut ranges are left
+            server.bodyBytesSent = 0;
+            Assert::IsTrue(download_result::success == download_file(server.Url(), m_destination, options));
+            Assert::IsTrue(m_content == ReadAll(m_destination));
+            Assert::IsFalse(HasPartialFiles());
+            Assert::IsTrue(server.bodyBytesSent <= 3 * MiB + 1);
+        }
+
+        TEST_METHOD (DownloadFile_DownloadsWholeFile_WhenRangesAreNotSupported)
+        {
+            LocalHttpServer server{ m_content };
+            server.ignoreRanges = true;
+
+            Assert::IsTrue(download_result::success == download_file(server.Url(), m_destination, ParallelOptions()));
+            Assert::IsTrue(m_content == ReadAll(m_destination));
+            Assert::IsFalse(HasPartialFiles());
+            Assert::AreEqual(static_cast<size_t>(1), server.requestCount.load());
+        }
+
+        TEST_METHOD (DownloadFile_RetriesFailedRequests)
+        {
+            LocalHttpServer server{ m_content };
+            server.failedResponses = 2;
+
+            Assert::IsTrue(download_result::success == download_file(server.Url(), m_destination, ParallelOptions()));
+            Assert::IsTrue(m_content == ReadAll(m_destination));
+        }
+
+        TEST_METHOD (DownloadFile_Fails_WhenAllAttemptsFail)
+        {
+            LocalHttpServer server{ m_content };
+            server.failedResponses = 3;
+
+            Assert::IsTrue(download_result::network_error == download_file(server.Url(), m_destination, ParallelOptions()));
+            Assert::IsFalse(std::filesystem::exists(m_destination));
+            Assert::AreEqual(static_cast<size_t>(3), server.requestCount.load());
+        }
+
+        TEST_METHOD (DownloadFile_DiscardsFile_WhenHashDoesNotMatch)
+        {
+            LocalHttpServer server{ m_content };
+            auto options = ParallelOptions();
+            options.max_attempts = 1;
+            (*options.expected_sha256)[0] ^= 1;
+
+            Assert::IsTrue(download_result::hash_mismatch == download_file(server.Url(), m_destination, options));
+            Assert::IsFalse(std::filesystem::exists(m_destination));
+            Assert::IsFalse(HasPartialFiles());
+        }
+    };
+}
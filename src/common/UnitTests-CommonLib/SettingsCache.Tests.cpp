@@ -0,0 +1,252 @@
+#include "pch.h"
+
+#include <chrono>
+#include <map>
+
+#include <common/SettingsAPI/settings_cache.h>
+#include <common/utils/json.h>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace PowerToysSettings;
+
+namespace UnitTestsCommonLib
+{
+    namespace
+    {
+        // Settings which can be changed by the tests, with the number of times they were read
+        struct FakeSettings
+        {
+            std::wstring json;
+            int reads = 0;
+            bool fail = false;
+
+            SettingsCache::Reader reader()
+            {
+                return [this]() -> std::optional<std::wstring> {
+                    ++reads;
+                    if (fail)
+                    {
+                        return std::nullopt;
+                    }
+
+                    return json;
+                };
+            }
+        };
+
+        // Config of about the size of the ones of the bigger modules
+        std::wstring ModuleConfig(const std::wstring& name, int value)
+        {
+            std::wstring properties;
+            for (int i = 0; i < 40; i++)
+            {
+                properties += L"\"property_" + std::to_wstring(i) + L"\":{\"value\":" + std::to_wstring(value + i) + L",\"description\":\"Description of the property of " + name + L"\"},";
+            }
+
+            return L"{\"name\":\"" + name + L"\",\"version\":\"1.0\",\"properties\":{" + properties + L"\"last\":{\"value\":true}}}";
+        }
+
+        json::JsonObject ParseMessage(const std::wstring& message)
+        {
+            json::JsonObject parsed;
+            Assert::IsTrue(json::JsonObject::TryParse(message, parsed));
+            return parsed;
+        }
+    }
+
+    TEST_CLASS (SettingsCacheUnitTests)
+    {
+    private:
+        FakeSettings m_general;
+        std::map<std::wstring, FakeSettings> m_modules;
+
+        SettingsCache CreateCache(int module_count)
+        {
+            m_general.json = L"{\"startup\":true}";
+            SettingsCache cache{ m_general.reader() };
+            for (int i = 0; i < module_count; i++)
+            {
+                const std::wstring name = L"Module" + std::to_wstring(i);
+                m_modules[name].json = ModuleConfig(name, i);
+                cache.add_module(name, m_modules[name].reader());
+            }
+
+            return cache;
+        }
+
+    public:
+        TEST_METHOD_CLEANUP(Cleanup)
+        {
+            m_general = {};
+            m_modules.clear();
+        }
+
+        TEST_METHOD (FullMessageContainsEverySetting)
+        {
+            auto cache = CreateCache(3);
+            const auto message = ParseMessage(cache.full_message());
+
+            Assert::IsTrue(message.GetNamedObject(L"general").GetNamedBoolean(L"startup"));
+            const auto powertoys = message.GetNamedObject(L"powertoys");
+            Assert::AreEqual(3u, powertoys.Size());
+            Assert::AreEqual(std::wstring{ L"Module1" }, std::wstring{ powertoys.GetNamedObject(L"Module1").GetNamedString(L"name").c_str() });
+            Assert::AreEqual(cache.version(), static_cast<uint64_t>(message.GetNamedNumber(L"version")));
+        }
+
+        TEST_METHOD (SettingsAreReadOnceUntilInvalidated)
+        {
+            auto cache = CreateCache(3);
+            cache.full_message();
+            cache.full_message();
+            cache.diff_message(0);
+
+            Assert::AreEqual(1, m_general.reads);
+            Assert::AreEqual(1, m_modules[L"Module0"].reads);
+
+            cache.invalidate_module(L"Module0");
+            cache.full_message();
+            Assert::AreEqual(2, m_modules[L"Module0"].reads);
+            Assert::AreEqual(1, m_modules[L"Module1"].reads);
+            Assert::AreEqual(1, m_general.reads);
+
+            cache.invalidate_all();
+            cache.full_message();
+            Assert::AreEqual(2, m_general.reads);
+            Assert::AreEqual(2, m_modules[L"Module1"].reads);
+        }
+
+        TEST_METHOD (DiffContainsOnlyChangedSettings)
+        {
+            auto cache = CreateCache(3);
+            const auto base_version = cache.version();
+
+            m_modules[L"Module1"].json = ModuleConfig(L"Module1", 100);
+            cache.invalidate_module(L"Module1");
+            cache.invalidate_module(L"Module2");
+
+            const auto message = ParseMessage(cache.diff_message(base_version));
+            Assert::IsFalse(message.HasKey(L"general"));
+            const auto powertoys = message.GetNamedObject(L"powertoys");
+            Assert::AreEqual(1u, powertoys.Size());
+            Assert::IsTrue(powertoys.HasKey(L"Module1"));
+            Assert::AreEqual(base_version, static_cast<uint64_t>(message.GetNamedNumber(L"base_version")));
+            Assert::AreEqual(base_version + 1, static_cast<uint64_t>(message.GetNamedNumber(L"version")));
+        }
+
+        TEST_METHOD (UnchangedSettingsKeepTheVersion)
+        {
+            auto cache = CreateCache(3);
+            const auto version = cache.version();
+
+            cache.invalidate_all();
+            Assert::AreEqual(version, cache.version());
+
+            const auto message = ParseMessage(cache.diff_message(version));
+            Assert::IsFalse(message.HasKey(L"general"));
+            Assert::AreEqual(0u, message.GetNamedObject(L"powertoys").Size());
+        }
+
+        TEST_METHOD (GeneralChangeIsInDiff)
+        {
+            auto cache = CreateCache(2);
+            const auto base_version = cache.version();
+
+            m_general.json = L"{\"startup\":false}";
+            cache.invalidate_general();
+
+            const auto message = ParseMessage(cache.diff_message(base_version));
+            Assert::IsFalse(message.GetNamedObject(L"general").GetNamedBoolean(L"startup"));
+            Assert::AreEqual(0u, message.GetNamedObject(L"powertoys").Size());
+        }
+
+        TEST_METHOD (FailedReadKeepsPreviousSettings)
+        {
+            auto cache = CreateCache(2);
+            const auto version = cache.version();
+
+            m_modules[L"Module0"].fail = true;
+            cache.invalidate_module(L"Module0");
+            const auto message = ParseMessage(cache.full_message());
+            Assert::IsTrue(message.GetNamedObject(L"powertoys").HasKey(L"Module0"));
+            Assert::AreEqual(version, cache.version());
+
+            // The failed read is retried without another invalidation
+            m_modules[L"Module0"].fail = false;
+            m_modules[L"Module0"].json = ModuleConfig(L"Module0", 100);
+            Assert::AreEqual(version + 1, cache.version());
+        }
+
+        TEST_METHOD (MalformedSettingsAreNotSent)
+        {
+            m_general.json = L"{}";
+            SettingsCache cache{ m_general.reader() };
+            FakeSettings malformed{ L"{\"name\":" };
+            cache.add_module(L"Malformed", malformed.reader());
+
+            const auto message = ParseMessage(cache.full_message());
+            Assert::IsFalse(message.GetNamedObject(L"powertoys").HasKey(L"Malformed"));
+        }
+
+        TEST_METHOD (ModuleKeysAreEscaped)
+        {
+            m_general.json = L"{}";
+            SettingsCache cache{ m_general.reader() };
+            FakeSettings module{ L"{}" };
+            cache.add_module(L"Quoted \"Module\"", module.reader());
+
+            const auto message = ParseMessage(cache.full_message());
+            Assert::IsTrue(message.GetNamedObject(L"powertoys").HasKey(L"Quoted \"Module\""));
+        }
+
+        TEST_METHOD (SettingsRoundTripBenchmark)
+        {
+            constexpr int module_count = 25;
+            constexpr int rounds = 200;
+            auto cache = CreateCache(module_count);
+            auto version = cache.version();
+
+            // What every settings change used to cost: parse the config of every module, then stringify all of them
+            const auto uncached_start = std::chrono::steady_clock::now();
+            size_t uncached_size = 0;
+            for (int round = 0; round < rounds; round++)
+            {
+                json::JsonObject powertoys;
+                for (const auto& [name, module] : m_modules)
+                {
+                    powertoys.SetNamedValue(name, json::JsonObject::Parse(module.json));
+                }
+
+                json::JsonObject all;
+                all.SetNamedValue(L"general", json::JsonObject::Parse(m_general.json));
+                all.SetNamedValue(L"powertoys", powertoys);
+                uncached_size += all.Stringify().size();
+            }
+            const auto uncached_duration = std::chrono::steady_clock::now() - uncached_start;
+
+            // A change to a single module, as sent by the Settings window
+            const auto cached_start = std::chrono::steady_clock::now();
+            size_t cached_size = 0;
+            for (int round = 0; round < rounds; round++)
+            {
+                auto& module = m_modules[L"Module" + std::to_wstring(round % module_count)];
+                module.json = ModuleConfig(L"Changed", round);
+                cache.invalidate_module(L"Module" + std::to_wstring(round % module_count));
+                cached_size += cache.diff_message(version).size();
+                version = cache.version();
+            }
+            const auto cached_duration = std::chrono::steady_clock::now() - cached_start;
+
+            Assert::AreEqual(static_cast<uint64_t>(module_count + 1 + rounds), version);
+
+            using ns = std::chrono::duration<double, std::nano>;
+            const double uncached = ns(uncached_duration).count() / rounds;
+            const double cached = ns(cached_duration).count() / rounds;
+            const auto message = std::to_wstring(module_count) + L" modules: " + std::to_wstring(uncached) + L" ns and " + std::to_wstring(uncached_size / rounds) + L" characters per full round trip, " +
+                                 std::to_wstring(cached) + L" ns and " + std::to_wstring(cached_size / rounds) + L" characters per cached round trip\n";
+            Logger::WriteMessage(message.c_str());
+
+            // Only the changed module is parsed and sent. The times are only logged, they are too noisy on shared build machines
+            Assert::IsTrue(cached_size * 10 < uncached_size);
+        }
+    };
+}
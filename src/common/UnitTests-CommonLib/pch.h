@@ -8,6 +8,7 @@
 #define PCH_H
 
 // add headers that you want to pre-compile here
+#include <WinSock2.h>
 #include <Windows.h>
 #include <winrt/base.h>
 #include <winrt/Windows.Foundation.h>
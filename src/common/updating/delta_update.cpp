@@ -0,0 +1,644 @@
+#include "delta_update.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <set>
+#include <string>
+#include <unordered_map>
+
+#include "sha256.h"
+
+namespace // Strings in this namespace should not be localized
+{
+    namespace fs = std::filesystem;
+    using updating::delta_apply_result;
+    using updating::sha256_digest;
+
+    const uint8_t PATCH_SIGNATURE[] = { 'P', 'T', 'D', 'E', 'L', 'T', 'A', '1' };
+    const wchar_t STAGING_EXTENSION[] = L".delta-staging";
+    const wchar_t BACKUP_EXTENSION[] = L".delta-backup";
+
+    // The old data is indexed by the hash of its blocks of this size, so matches are at least this long
+    const size_t MATCH_BLOCK_SIZE = 32;
+    const uint64_t ROLLING_HASH_BASE = 0x100000001b3;
+
+    enum class delta_operation : uint8_t
+    {
+        copy = 0,
+        insert = 1,
+    };
+
+    enum class patch_entry_kind : uint8_t
+    {
+        unchanged = 0,
+        added = 1,
+        patched = 2,
+    };
+
+    class byte_writer
+    {
+    public:
+        void write_byte(uint8_t value)
+        {
+            m_data.push_back(value);
+        }
+
+        // Little endian base 128, small values take a single byte
+        void write_varint(uint64_t value)
+        {
+            while (value >= 0x80)
+            {
+                m_data.push_back(static_cast<uint8_t>(value | 0x80));
+                value >>= 7;
+            }
+
+            m_data.push_back(static_cast<uint8_t>(value));
+        }
+
+        void write_bytes(const uint8_t* data, size_t size)
+        {
+            // Not insert(), which GCC 12 wrongly reports as overflowing when optimizing
+            const size_t offset = m_data.size();
+            m_data.resize(offset + size);
+            std::copy_n(data, size, m_data.begin() + offset);
+        }
+
+        std::vector<uint8_t>& data()
+        {
+            return m_data;
+        }
+
+    private:
+        std::vector<uint8_t> m_data;
+    };
+
+    // Reads from a buffer, every read fails once past its end
+    class byte_reader
+    {
+    public:
+        byte_reader(const uint8_t* data, size_t size) :
+            m_data(data), m_size(size)
+        {
+        }
+
+        bool read_byte(uint8_t& value)
+        {
+            if (m_offset == m_size)
+            {
+                return false;
+            }
+
+            value = m_data[m_offset++];
+            return true;
+        }
+
+        bool read_varint(uint64_t& value)
+        {
+            uint64_t result = 0;
+            for (int shift = 0; shift < 64; shift += 7)
+            {
+                uint8_t byte = 0;
+                if (!read_byte(byte))
+                {
+                    return false;
+                }
+
+                result |= static_cast<uint64_t>(byte & 0x7f) << shift;
+                if ((byte & 0x80) == 0)
+                {
+                    value = result;
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+        // Points data to the next bytes of the buffer instead of copying them
+        bool read_bytes(uint64_t size, const uint8_t*& data)
+        {
+            if (size > m_size - m_offset)
+            {
+                return false;
+            }
+
+            data = m_data + m_offset;
+            m_offset += static_cast<size_t>(size);
+            return true;
+        }
+
+        bool at_end() const
+        {
+            return m_offset == m_size;
+        }
+
+    private:
+        const uint8_t* m_data;
+        size_t m_size;
+        size_t m_offset = 0;
+    };
+
+    uint64_t hash_block(const uint8_t* data)
+    {
+        uint64_t hash = 0;
+        for (size_t i = 0; i < MATCH_BLOCK_SIZE; ++i)
+        {
+            hash = hash * ROLLING_HASH_BASE + data[i];
+        }
+
+        return hash;
+    }
+
+    std::optional<std::vector<uint8_t>> apply_delta(const std::vector<uint8_t>& old_data, const uint8_t* delta, size_t delta_size)
+    {
+        byte_reader reader{ delta, delta_size };
+        uint64_t new_size = 0;
+        if (!reader.read_varint(new_size))
+        {
+            return std::nullopt;
+        }
+
+        // The size comes from the delta, so it is only trusted as far as the delta could produce it
+        std::vector<uint8_t> new_data;
+        new_data.reserve(static_cast<size_t>(std::min<uint64_t>(new_size, old_data.size() + delta_size)));
+        while (!reader.at_end())
+        {
+            uint8_t operation = 0;
+            uint64_t offset = 0;
+            uint64_t size = 0;
+            const uint8_t* bytes = nullptr;
+            if (!reader.read_byte(operation))
+            {
+                return std::nullopt;
+            }
+
+            if (operation == static_cast<uint8_t>(delta_operation::copy))
+            {
+                if (!reader.read_varint(offset) || !reader.read_varint(size) || offset > old_data.size() || size > old_data.size() - offset)
+                {
+                    return std::nullopt;
+                }
+
+                bytes = old_data.data() + offset;
+            }
+            else if (operation != static_cast<uint8_t>(delta_operation::insert) || !reader.read_varint(size) || !reader.read_bytes(size, bytes))
+            {
+                return std::nullopt;
+            }
+
+            if (size > new_size - new_data.size())
+            {
+                return std::nullopt;
+            }
+
+            new_data.insert(new_data.end(), bytes, bytes + size);
+        }
+
+        if (new_data.size() != new_size)
+        {
+            return std::nullopt;
+        }
+
+        return new_data;
+    }
+
+    std::optional<std::vector<uint8_t>> read_file(const fs::path& path)
+    {
+        std::ifstream file{ path, std::ios::binary | std::ios::ate };
+        if (!file)
+        {
+            return std::nullopt;
+        }
+
+        const std::streamoff size = file.tellg();
+        if (size < 0)
+        {
+            return std::nullopt;
+        }
+
+        std::vector<uint8_t> data(static_cast<size_t>(size));
+        file.seekg(0);
+        if (!file.read(reinterpret_cast<char*>(data.data()), size))
+        {
+            return std::nullopt;
+        }
+
+        return data;
+    }
+
+    bool write_file(const fs::path& path, const uint8_t* data, size_t size)
+    {
+        std::ofstream file{ path, std::ios::binary | std::ios::trunc };
+        file.write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(size));
+        file.close();
+        return static_cast<bool>(file);
+    }
+
+    // The staging directory links unchanged files of the installation, so a staged file is replaced instead of being
+    // written through such a link
+    bool replace_file(const fs::path& path, const uint8_t* data, size_t size)
+    {
+        std::error_code ec;
+        fs::remove(path, ec);
+        return !ec && write_file(path, data, size);
+    }
+
+    bool matches_digest(const uint8_t* data, size_t size, const uint8_t* digest)
+    {
+        const sha256_digest actual = updating::compute_sha256(data, size);
+        return std::equal(actual.begin(), actual.end(), digest);
+    }
+
+    // Paths are stored as UTF-8 with forward slashes
+    std::string to_patch_path(const fs::path& path)
+    {
+        const auto utf8 = path.generic_u8string();
+        return { reinterpret_cast<const char*>(utf8.data()), utf8.size() };
+    }
+
+    // Returns nothing for paths which could point outside of the directory
+    std::optional<fs::path> from_patch_path(const uint8_t* data, size_t size)
+    {
+        fs::path path{ std::u8string{ reinterpret_cast<const char8_t*>(data), size } };
+        if (path.empty() || path.has_root_path())
+        {
+            return std::nullopt;
+        }
+
+        for (const auto& part : path)
+        {
+            if (part == L".." || part == L".")
+            {
+                return std::nullopt;
+            }
+        }
+
+        return path;
+    }
+
+    // Regular files in the directory and its subdirectories by their patch path
+    std::optional<std::map<std::string, fs::path>> list_files(const fs::path& directory)
+    {
+        std::map<std::string, fs::path> files;
+        std::error_code ec;
+        for (fs::recursive_directory_iterator it{ directory, ec }, end; !ec && it != end; it.increment(ec))
+        {
+            if (it->is_regular_file(ec))
+            {
+                files.emplace(to_patch_path(it->path().lexically_relative(directory)), it->path());
+            }
+        }
+
+        return !ec ? std::optional{ std::move(files) } : std::nullopt;
+    }
+
+    // Rebuilds the files of the new version listed in the patch in the staging directory
+    delta_apply_result build_staging_directory(const fs::path& installation, const fs::path& staging, const std::vector<uint8_t>& patch)
+    {
+        // The digest covers the paths and the order of the entries, which the digests of the files don't
+        byte_reader reader{ patch.data(), patch.size() };
+        const uint8_t* signature = nullptr;
+        const uint8_t* patch_digest = nullptr;
+        if (!reader.read_bytes(sizeof(PATCH_SIGNATURE), signature) || std::memcmp(signature, PATCH_SIGNATURE, sizeof(PATCH_SIGNATURE)) != 0 || !reader.read_bytes(std::tuple_size_v<sha256_digest>, patch_digest))
+        {
+            return delta_apply_result::invalid_patch;
+        }
+
+        const size_t content_offset = sizeof(PATCH_SIGNATURE) + std::tuple_size_v<sha256_digest>;
+        uint64_t entry_count = 0;
+        if (!matches_digest(patch.data() + content_offset, patch.size() - content_offset, patch_digest) || !reader.read_varint(entry_count))
+        {
+            return delta_apply_result::invalid_patch;
+        }
+
+        std::set<fs::path> entry_paths;
+        for (uint64_t i = 0; i < entry_count; ++i)
+        {
+            uint8_t kind = 0;
+            uint64_t path_size = 0;
+            const uint8_t* path_data = nullptr;
+            uint64_t new_size = 0;
+            const uint8_t* new_digest = nullptr;
+            if (!reader.read_byte(kind) || !reader.read_varint(path_size) || !reader.read_bytes(path_size, path_data) || !reader.read_varint(new_size) || !reader.read_bytes(std::tuple_size_v<sha256_digest>, new_digest))
+            {
+                return delta_apply_result::invalid_patch;
+            }
+
+            const auto relative_path = from_patch_path(path_data, static_cast<size_t>(path_size));
+            if (!relative_path || !entry_paths.insert(relative_path->lexically_normal()).second)
+            {
+                return delta_apply_result::invalid_patch;
+            }
+
+            const fs::path source = installation / *relative_path;
+            const fs::path target = staging / *relative_path;
+            std::error_code ec;
+            fs::create_directories(target.parent_path(), ec);
+            if (ec)
+            {
+                return delta_apply_result::file_error;
+            }
+
+            if (kind == static_cast<uint8_t>(patch_entry_kind::unchanged))
+            {
+                const auto data = read_file(source);
+                if (!data || data->size() != new_size || !matches_digest(data->data(), data->size(), new_digest))
+                {
+                    return delta_apply_result::base_mismatch;
+                }
+
+                // Unchanged files are linked into the new version instead of being copied
+                fs::create_hard_link(source, target, ec);
+                if (ec && !replace_file(target, data->data(), data->size()))
+                {
+                    return delta_apply_result::file_error;
+                }
+            }
+            else if (kind == static_cast<uint8_t>(patch_entry_kind::added))
+            {
+                const uint8_t* data = nullptr;
+                if (!reader.read_bytes(new_size, data))
+                {
+                    return delta_apply_result::invalid_patch;
+                }
+
+                if (!matches_digest(data, static_cast<size_t>(new_size), new_digest))
+                {
+                    return delta_apply_result::verification_failed;
+                }
+
+                if (!replace_file(target, data, static_cast<size_t>(new_size)))
+                {
+                    return delta_apply_result::file_error;
+                }
+            }
+            else if (kind == static_cast<uint8_t>(patch_entry_kind::patched))
+            {
+                uint64_t old_size = 0;
+                const uint8_t* old_digest = nullptr;
+                uint64_t delta_size = 0;
+                const uint8_t* delta = nullptr;
+                if (!reader.read_varint(old_size) || !reader.read_bytes(std::tuple_size_v<sha256_digest>, old_digest) || !reader.read_varint(delta_size) || !reader.read_bytes(delta_size, delta))
+                {
+                    return delta_apply_result::invalid_patch;
+                }
+
+                const auto old_data = read_file(source);
+                if (!old_data || old_data->size() != old_size || !matches_digest(old_data->data(), old_data->size(), old_digest))
+                {
+                    return delta_apply_result::base_mismatch;
+                }
+
+                const auto new_data = apply_delta(*old_data, delta, static_cast<size_t>(delta_size));
+                if (!new_data)
+                {
+                    return delta_apply_result::invalid_patch;
+                }
+
+                if (new_data->size() != new_size || !matches_digest(new_data->data(), new_data->size(), new_digest))
+                {
+                    return delta_apply_result::verification_failed;
+                }
+
+                if (!replace_file(target, new_data->data(), new_data->size()))
+                {
+                    return delta_apply_result::file_error;
+                }
+            }
+            else
+            {
+                return delta_apply_result::invalid_patch;
+            }
+        }
+
+        return reader.at_end() ? delta_apply_result::success : delta_apply_result::invalid_patch;
+    }
+}
+
+namespace updating
+{
+    std::vector<uint8_t> create_binary_delta(const std::vector<uint8_t>& old_data, const std::vector<uint8_t>& new_data)
+    {
+        byte_writer writer;
+        writer.write_varint(new_data.size());
+
+        // New bytes from literal_begin up to the next match are inserted as they are
+        size_t literal_begin = 0;
+        auto write_literal = [&](size_t literal_end) {
+            if (literal_end > literal_begin)
+            {
+                writer.write_byte(static_cast<uint8_t>(delta_operation::insert));
+                writer.write_varint(literal_end - literal_begin);
+                writer.write_bytes(new_data.data() + literal_begin, literal_end - literal_begin);
+            }
+        };
+
+        if (old_data.size() >= MATCH_BLOCK_SIZE && new_data.size() >= MATCH_BLOCK_SIZE)
+        {
+            // Only the first of the old blocks with the same hash is kept
+            std::unordered_map<uint64_t, size_t> old_blocks;
+            old_blocks.reserve(old_data.size() / MATCH_BLOCK_SIZE);
+            for (size_t offset = 0; offset + MATCH_BLOCK_SIZE <= old_data.size(); offset += MATCH_BLOCK_SIZE)
+            {
+                old_blocks.try_emplace(hash_block(old_data.data() + offset), offset);
+            }
+
+            // Weight of the first byte of the window in the rolling hash
+            uint64_t first_byte_weight = 1;
+            for (size_t i = 1; i < MATCH_BLOCK_SIZE; ++i)
+            {
+                first_byte_weight *= ROLLING_HASH_BASE;
+            }
+
+            // Slide a window over the new data until it matches an old block, then extend the match in both directions
+            size_t position = 0;
+            uint64_t hash = hash_block(new_data.data());
+            while (position + MATCH_BLOCK_SIZE <= new_data.size())
+            {
+                const auto block = old_blocks.find(hash);
+                if (block != old_blocks.end() && std::memcmp(old_data.data() + block->second, new_data.data() + position, MATCH_BLOCK_SIZE) == 0)
+                {
+                    size_t old_begin = block->second;
+                    size_t new_begin = position;
+                    while (new_begin > literal_begin && old_begin > 0 && old_data[old_begin - 1] == new_data[new_begin - 1])
+                    {
+                        --old_begin;
+                        --new_begin;
+                    }
+
+                    size_t size = position + MATCH_BLOCK_SIZE - new_begin;
+                    while (new_begin + size < new_data.size() && old_begin + size < old_data.size() && old_data[old_begin + size] == new_data[new_begin + size])
+                    {
+                        ++size;
+                    }
+
+                    write_literal(new_begin);
+                    writer.write_byte(static_cast<uint8_t>(delta_operation::copy));
+                    writer.write_varint(old_begin);
+                    writer.write_varint(size);
+
+                    position = new_begin + size;
+                    literal_begin = position;
+                    if (position + MATCH_BLOCK_SIZE <= new_data.size())
+                    {
+                        hash = hash_block(new_data.data() + position);
+                    }
+
+                    continue;
+                }
+
+                if (position + MATCH_BLOCK_SIZE < new_data.size())
+                {
+                    hash = (hash - new_data[position] * first_byte_weight) * ROLLING_HASH_BASE + new_data[position + MATCH_BLOCK_SIZE];
+                }
+
+                ++position;
+            }
+        }
+
+        write_literal(new_data.size());
+        return std::move(writer.data());
+    }
+
+    std::optional<std::vector<uint8_t>> apply_binary_delta(const std::vector<uint8_t>& old_data, const std::vector<uint8_t>& delta)
+    {
+        return apply_delta(old_data, delta.data(), delta.size());
+    }
+
+    std::optional<delta_patch_stats> create_delta_patch(const std::filesystem::path& old_directory, const std::filesystem::path& new_directory, const std::filesystem::path& patch_path)
+    {
+        const auto old_files = list_files(old_directory);
+        const auto new_files = list_files(new_directory);
+        if (!old_files || !new_files)
+        {
+            return std::nullopt;
+        }
+
+        delta_patch_stats stats;
+        byte_writer writer;
+        writer.write_bytes(PATCH_SIGNATURE, sizeof(PATCH_SIGNATURE));
+        const sha256_digest placeholder_digest{};
+        writer.write_bytes(placeholder_digest.data(), placeholder_digest.size());
+        const size_t content_offset = writer.data().size();
+        writer.write_varint(new_files->size());
+        for (const auto& [relative_path, new_path] : *new_files)
+        {
+            const auto new_data = read_file(new_path);
+            if (!new_data)
+            {
+                return std::nullopt;
+            }
+
+            const sha256_digest new_digest = compute_sha256(new_data->data(), new_data->size());
+            auto write_entry_header = [&](patch_entry_kind kind) {
+                writer.write_byte(static_cast<uint8_t>(kind));
+                writer.write_varint(relative_path.size());
+                writer.write_bytes(reinterpret_cast<const uint8_t*>(relative_path.data()), relative_path.size());
+                writer.write_varint(new_data->size());
+                writer.write_bytes(new_digest.data(), new_digest.size());
+            };
+
+            stats.new_size += new_data->size();
+            std::optional<std::vector<uint8_t>> old_data;
+            if (const auto old_path = old_files->find(relative_path); old_path != old_files->end())
+            {
+                old_data = read_file(old_path->second);
+                if (!old_data)
+                {
+                    return std::nullopt;
+                }
+            }
+
+            if (old_data && *old_data == *new_data)
+            {
+                write_entry_header(patch_entry_kind::unchanged);
+                stats.unchanged_files++;
+                continue;
+            }
+
+            // A delta which isn't smaller than the file would only slow down applying the patch
+            const auto delta = old_data ? create_binary_delta(*old_data, *new_data) : std::vector<uint8_t>{};
+            if (!old_data || delta.size() >= new_data->size())
+            {
+                write_entry_header(patch_entry_kind::added);
+                writer.write_bytes(new_data->data(), new_data->size());
+                stats.added_files++;
+                continue;
+            }
+
+            const sha256_digest old_digest = compute_sha256(old_data->data(), old_data->size());
+            write_entry_header(patch_entry_kind::patched);
+            writer.write_varint(old_data->size());
+            writer.write_bytes(old_digest.data(), old_digest.size());
+            writer.write_varint(delta.size());
+            writer.write_bytes(delta.data(), delta.size());
+            stats.patched_files++;
+        }
+
+        // Files which aren't in the patch aren't part of the new version
+        stats.removed_files = static_cast<size_t>(std::count_if(old_files->begin(), old_files->end(), [&](const auto& file) { return !new_files->contains(file.first); }));
+        auto& patch = writer.data();
+        const sha256_digest patch_digest = compute_sha256(patch.data() + content_offset, patch.size() - content_offset);
+        std::copy(patch_digest.begin(), patch_digest.end(), patch.begin() + sizeof(PATCH_SIGNATURE));
+        stats.patch_size = patch.size();
+        if (!write_file(patch_path, patch.data(), patch.size()))
+        {
+            return std::nullopt;
+        }
+
+        return stats;
+    }
+
+    delta_apply_result apply_delta_patch(const std::filesystem::path& installation_directory, const std::filesystem::path& patch_path)
+    {
+        auto installation = installation_directory.lexically_normal();
+        if (!installation.has_filename())
+        {
+            installation = installation.parent_path();
+        }
+
+        auto staging = installation;
+        staging += STAGING_EXTENSION;
+        auto backup = installation;
+        backup += BACKUP_EXTENSION;
+
+        const auto patch = read_file(patch_path);
+        if (!patch)
+        {
+            return delta_apply_result::file_error;
+        }
+
+        // Leftovers of an interrupted update are discarded
+        std::error_code ec;
+        fs::remove_all(staging, ec);
+        fs::create_directories(staging, ec);
+        const auto result = !ec ? build_staging_directory(installation, staging, *patch) : delta_apply_result::file_error;
+        if (result != delta_apply_result::success)
+        {
+            fs::remove_all(staging, ec);
+            return result;
+        }
+
+        // Swap the directories, the installation is only missing between the two renames
+        fs::remove_all(backup, ec);
+        fs::rename(installation, backup, ec);
+        if (ec)
+        {
+            fs::remove_all(staging, ec);
+            return delta_apply_result::file_error;
+        }
+
+        fs::rename(staging, installation, ec);
+        if (ec)
+        {
+            fs::rename(backup, installation, ec);
+            fs::remove_all(staging, ec);
+            return delta_apply_result::file_error;
+        }
+
+        fs::remove_all(backup, ec);
+        return delta_apply_result::success;
+    }
+}
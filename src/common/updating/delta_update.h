@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <vector>
+
+namespace updating
+{
+    // Encodes new_data as copies of ranges of old_data and inserted bytes
+    std::vector<uint8_t> create_binary_delta(const std::vector<uint8_t>& old_data, const std::vector<uint8_t>& new_data);
+
+    // Rebuilds the new data from the old data and the delta, returns nothing if the delta is invalid for the old data
+    std::optional<std::vector<uint8_t>> apply_binary_delta(const std::vector<uint8_t>& old_data, const std::vector<uint8_t>& delta);
+
+    struct delta_patch_stats
+    {
+        size_t unchanged_files = 0;
+        size_t added_files = 0;
+        size_t patched_files = 0;
+        size_t removed_files = 0;
+        uint64_t new_size = 0;
+        uint64_t patch_size = 0;
+    };
+
+    // Creates a patch which turns the files of old_directory into the ones of new_directory.
+    // Changed files are stored as binary deltas of their old version, along with the SHA-256 of both versions
+    std::optional<delta_patch_stats> create_delta_patch(const std::filesystem::path& old_directory, const std::filesystem::path& new_directory, const std::filesystem::path& patch_path);
+
+    enum class delta_apply_result
+    {
+        success,
+        invalid_patch,
+        // The installation isn't the version the patch was created from, so the full installer is needed
+        base_mismatch,
+        verification_failed,
+        file_error,
+    };
+
+    // Builds the new version of the installation in a staging directory next to it, from its current files and the patch.
+    // Every rebuilt file is verified before the staging directory takes the place of the installation, which is left untouched on failure
+    delta_apply_result apply_delta_patch(const std::filesystem::path& installation_directory, const std::filesystem::path& patch_path);
+}
@@ -0,0 +1,523 @@
+#include "pch.h"
+
+#include "downloader.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <winrt/Windows.Storage.Streams.h>
+#include <winrt/Windows.Web.Http.h>
+#include <winrt/Windows.Web.Http.Filters.h>
+#include <winrt/Windows.Web.Http.Headers.h>
+
+#include <common/utils/HttpClient.h>
+
+namespace // Strings in this namespace should not be localized
+{
+    namespace web = winrt::Windows::Web::Http;
+    namespace streams = winrt::Windows::Storage::Streams;
+    using winrt::Windows::Foundation::Uri;
+    using updating::download_options;
+    using updating::download_result;
+
+    const wchar_t PARTIAL_FILE_EXTENSION[] = L".partial";
+    const wchar_t RANGES_FILE_EXTENSION[] = L".ranges";
+    const wchar_t SHA256_DIGEST_PREFIX[] = L"sha256:";
+
+    // Data is written to the file in blocks of this size. Ranges start at a multiple of it, so the writes stay aligned
+    const uint32_t WRITE_BUFFER_SIZE = 1024 * 1024;
+    const uint32_t READ_BUFFER_SIZE = 64 * 1024;
+
+    // Part of the file from begin to end, end excluded. The first downloaded bytes of it are in the partial file
+    struct download_range
+    {
+        uint64_t begin = 0;
+        uint64_t end = 0;
+        uint64_t downloaded = 0;
+
+        uint64_t remaining() const
+        {
+            return end - begin - downloaded;
+        }
+    };
+
+    web::HttpClient create_http_client()
+    {
+        // The ranges must be the bytes of the file as the server has it now
+        web::Filters::HttpBaseProtocolFilter filter;
+        filter.CacheControl().ReadBehavior(web::Filters::HttpCacheReadBehavior::MostRecent);
+        filter.CacheControl().WriteBehavior(web::Filters::HttpCacheWriteBehavior::NoCache);
+        filter.AutomaticDecompression(false);
+
+        web::HttpClient client{ filter };
+        client.DefaultRequestHeaders().UserAgent().TryParseAdd(http::USER_AGENT);
+        return client;
+    }
+
+    web::HttpResponseMessage send_range_request(const web::HttpClient& client, const Uri& url, uint64_t first_byte, uint64_t last_byte)
+    {
+        web::HttpRequestMessage request{ web::HttpMethod::Get(), url };
+        request.Headers().TryAppendWithoutValidation(L"Range", L"bytes=" + std::to_wstring(first_byte) + L"-" + std::to_wstring(last_byte));
+        return client.SendRequestAsync(request, web::HttpCompletionOption::ResponseHeadersRead).get();
+    }
+
+    bool write_at(HANDLE file, uint64_t offset, const uint8_t* data, size_t size)
+    {
+        while (size > 0)
+        {
+            OVERLAPPED overlapped{};
+            overlapped.Offset = static_cast<DWORD>(offset);
+            overlapped.OffsetHigh = static_cast<DWORD>(offset >> 32);
+            DWORD written = 0;
+            if (!WriteFile(file, data, static_cast<DWORD>(size), &written, &overlapped) || written == 0)
+            {
+                return false;
+            }
+
+            offset += written;
+            data += written;
+            size -= written;
+        }
+
+        return true;
+    }
+
+    // Writes the body of the response to the file at the offset in blocks of WRITE_BUFFER_SIZE. on_written gets the size of each block once it is written,
+    // the bytes read after the last block are lost if the connection drops. Network errors are thrown
+    template<typename Callback>
+    download_result stream_body(const web::HttpResponseMessage& response, HANDLE file, uint64_t offset, uint64_t max_size, Callback&& on_written)
+    {
+        auto body = response.Content().ReadAsInputStreamAsync().get();
+        streams::Buffer read_buffer{ READ_BUFFER_SIZE };
+        std::vector<uint8_t> write_buffer;
+        write_buffer.reserve(WRITE_BUFFER_SIZE);
+        uint64_t written = 0;
+
+        auto flush = [&] {
+            if (!write_at(file, offset + written, write_buffer.data(), write_buffer.size()) || !on_written(write_buffer.size()))
+            {
+                return false;
+            }
+
+            written += write_buffer.size();
+            write_buffer.clear();
+            return true;
+        };
+
+        for (;;)
+        {
+            auto chunk = body.ReadAsync(read_buffer, READ_BUFFER_SIZE, streams::InputStreamOptions::Partial).get();
+            const uint32_t chunk_size = chunk.Length();
+            if (chunk_size == 0)
+            {
+                break;
+            }
+
+            if (written + write_buffer.size() + chunk_size > max_size)
+            {
+                return download_result::network_error;
+            }
+
+            const uint8_t* data = chunk.data();
+            for (uint32_t copied = 0; copied < chunk_size;)
+            {
+                const uint32_t count = std::min(chunk_size - copied, static_cast<uint32_t>(WRITE_BUFFER_SIZE - write_buffer.size()));
+                write_buffer.insert(write_buffer.end(), data + copied, data + copied + count);
+                copied += count;
+                if (write_buffer.size() == WRITE_BUFFER_SIZE && !flush())
+                {
+                    return download_result::file_error;
+                }
+            }
+        }
+
+        return write_buffer.empty() || flush() ? download_result::success : download_result::file_error;
+    }
+
+    void report_progress(const download_options& options, uint64_t downloaded, uint64_t file_size)
+    {
+        if (options.progress_callback && file_size > 0)
+        {
+            options.progress_callback(static_cast<float>(downloaded) / file_size);
+        }
+    }
+
+    // Splits the file in ranges of a multiple of WRITE_BUFFER_SIZE, with at least min_range_size bytes each
+    std::vector<download_range> plan_ranges(uint64_t file_size, const download_options& options)
+    {
+        const uint64_t max_count = std::max<uint64_t>(options.max_parallel_ranges, 1);
+        const uint64_t count = std::clamp<uint64_t>(file_size / std::max<uint64_t>(options.min_range_size, 1), 1, max_count);
+        uint64_t range_size = (file_size + count - 1) / count;
+        range_size = (range_size + WRITE_BUFFER_SIZE - 1) / WRITE_BUFFER_SIZE * WRITE_BUFFER_SIZE;
+
+        std::vector<download_range> ranges;
+        for (uint64_t begin = 0; begin < file_size; begin += range_size)
+        {
+            ranges.push_back({ begin, std::min(begin + range_size, file_size), 0 });
+        }
+
+        return ranges;
+    }
+
+    // The ranges file holds the url and the size of the file, then the begin, end and downloaded bytes of each range.
+    // Returns no ranges if the file doesn't describe a download of the same url and size
+    std::vector<download_range> load_ranges(const std::filesystem::path& path, const std::string& url, uint64_t file_size)
+    {
+        std::ifstream file{ path };
+        std::string saved_url;
+        uint64_t saved_file_size = 0;
+        if (!std::getline(file, saved_url) || !(file >> saved_file_size) || saved_url != url || saved_file_size != file_size)
+        {
+            return {};
+        }
+
+        std::vector<download_range> ranges;
+        download_range range;
+        while (file >> range.begin >> range.end >> range.downloaded)
+        {
+            const uint64_t expected_begin = ranges.empty() ? 0 : ranges.back().end;
+            if (range.begin != expected_begin || range.end <= range.begin || range.downloaded > range.end - range.begin)
+            {
+                return {};
+            }
+
+            ranges.push_back(range);
+        }
+
+        if (ranges.empty() || ranges.back().end != file_size)
+        {
+            return {};
+        }
+
+        return ranges;
+    }
+
+    bool save_ranges(const std::filesystem::path& path, const std::string& url, uint64_t file_size, const std::vector<download_range>& ranges)
+    {
+        std::ofstream file{ path, std::ios::trunc };
+        file << url << '\n'
+             << file_size << '\n';
+        for (const auto& range : ranges)
+        {
+            file << range.begin << ' ' << range.end << ' ' << range.downloaded << '\n';
+        }
+
+        file.flush();
+        return static_cast<bool>(file);
+    }
+
+    template<typename Callback>
+    download_result download_range_to_file(const web::HttpClient& client, const Uri& url, HANDLE file, const download_range& range, Callback&& on_written)
+    {
+        try
+        {
+            const uint64_t offset = range.begin + range.downloaded;
+            auto response = send_range_request(client, url, offset, range.end - 1);
+
+            // A server which doesn't honor the range would send the file from the start
+            auto content_range = response.Content().Headers().ContentRange();
+            if (response.StatusCode() != web::HttpStatusCode::PartialContent || !content_range || !content_range.FirstBytePosition() || content_range.FirstBytePosition().Value() != offset)
+            {
+                return download_result::network_error;
+            }
+
+            uint64_t written = 0;
+            auto result = stream_body(response, file, offset, range.remaining(), [&](size_t size) {
+                written += size;
+                return on_written(size);
+            });
+
+            // The connection can be closed before the whole range is sent
+            if (result == download_result::success && written != range.remaining())
+            {
+                return download_result::network_error;
+            }
+
+            return result;
+        }
+        catch (...)
+        {
+            return download_result::network_error;
+        }
+    }
+
+    // Downloads the missing parts of the ranges in parallel, resuming from the saved ranges if they belong to the partial file
+    download_result download_ranges(const web::HttpClient& client, const Uri& url, uint64_t file_size, const std::filesystem::path& partial_path, const std::filesystem::path& ranges_path, const download_options& options)
+    {
+        const std::string url_string = winrt::to_string(url.AbsoluteUri());
+        auto ranges = load_ranges(ranges_path, url_string, file_size);
+        std::error_code ec;
+        if (ranges.empty() || std::filesystem::file_size(partial_path, ec) != file_size)
+        {
+            ranges = plan_ranges(file_size, options);
+        }
+
+        wil::unique_hfile file{ CreateFileW(partial_path.c_str(), GENERIC_WRITE, 0, nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr) };
+        if (!file)
+        {
+            return download_result::file_error;
+        }
+
+        // Allocate the whole file upfront, each range is written at its offset
+        LARGE_INTEGER size;
+        size.QuadPart = static_cast<LONGLONG>(file_size);
+        if (!SetFilePointerEx(file.get(), size, nullptr, FILE_BEGIN) || !SetEndOfFile(file.get()) || !save_ranges(ranges_path, url_string, file_size, ranges))
+        {
+            return download_result::file_error;
+        }
+
+        std::mutex ranges_mutex;
+        uint64_t downloaded = 0;
+        for (const auto& range : ranges)
+        {
+            downloaded += range.downloaded;
+        }
+
+        std::vector<download_result> results(ranges.size(), download_result::success);
+        std::vector<std::thread> workers;
+        for (size_t i = 0; i < ranges.size(); ++i)
+        {
+            if (ranges[i].remaining() == 0)
+            {
+                continue;
+            }
+
+            workers.emplace_back([&, i, range = ranges[i]] {
+                results[i] = download_range_to_file(client, url, file.get(), range, [&](size_t size) {
+                    std::scoped_lock lock{ ranges_mutex };
+                    ranges[i].downloaded += size;
+                    downloaded += size;
+                    report_progress(options, downloaded, file_size);
+                    return save_ranges(ranges_path, url_string, file_size, ranges);
+                });
+            });
+        }
+
+        for (auto& worker : workers)
+        {
+            worker.join();
+        }
+
+        if (std::find(results.begin(), results.end(), download_result::file_error) != results.end())
+        {
+            return download_result::file_error;
+        }
+
+        if (std::find(results.begin(), results.end(), download_result::network_error) != results.end())
+        {
+            return download_result::network_error;
+        }
+
+        return download_result::success;
+    }
+
+    // Downloads the whole file with the response, without saving ranges since it can't be resumed
+    download_result download_single_stream(const web::HttpResponseMessage& response, const std::filesystem::path& partial_path, const std::filesystem::path& ranges_path, const download_options& options)
+    {
+        std::error_code ec;
+        std::filesystem::remove(ranges_path, ec);
+
+        wil::unique_hfile file{ CreateFileW(partial_path.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr) };
+        if (!file)
+        {
+            return download_result::file_error;
+        }
+
+        auto content_length = response.Content().Headers().ContentLength();
+        const uint64_t file_size = content_length ? content_length.Value() : 0;
+        uint64_t written = 0;
+        auto result = stream_body(response, file.get(), 0, content_length ? file_size : UINT64_MAX, [&](size_t size) {
+            written += size;
+            report_progress(options, written, file_size);
+            return true;
+        });
+
+        if (result == download_result::success && content_length && written != file_size)
+        {
+            return download_result::network_error;
+        }
+
+        return result;
+    }
+
+    download_result download_once(const web::HttpClient& client, const Uri& url, const std::filesystem::path& destination, const std::filesystem::path& partial_path, const std::filesystem::path& ranges_path, const download_options& options)
+    {
+        download_result result = download_result::network_error;
+        try
+        {
+            // Asking for the first byte tells whether the server supports ranges and the size of the file
+            auto response = send_range_request(client, url, 0, 0);
+            if (response.StatusCode() == web::HttpStatusCode::PartialContent)
+            {
+                auto content_range = response.Content().Headers().ContentRange();
+                const bool is_size_known = content_range && content_range.Length();
+                const uint64_t file_size = is_size_known ? content_range.Length().Value() : 0;
+                response.Close();
+                response = nullptr;
+
+                if (is_size_known)
+                {
+                    result = download_ranges(client, url, file_size, partial_path, ranges_path, options);
+                }
+                else
+                {
+                    // The file can't be split without its size, so it is requested as a whole
+                    response = client.GetAsync(url, web::HttpCompletionOption::ResponseHeadersRead).get();
+                }
+            }
+
+            // The server ignored the range and sent the whole file
+            if (response && response.StatusCode() == web::HttpStatusCode::Ok)
+            {
+                result = download_single_stream(response, partial_path, ranges_path, options);
+            }
+        }
+        catch (...)
+        {
+            result = download_result::network_error;
+        }
+
+        if (result != download_result::success)
+        {
+            return result;
+        }
+
+        std::error_code ec;
+        if (options.expected_sha256)
+        {
+            const auto digest = updating::compute_file_sha256(partial_path);
+            if (!digest)
+            {
+                return download_result::file_error;
+            }
+
+            if (*digest != *options.expected_sha256)
+            {
+                // Start over in the next attempt, the saved data can't be trusted
+                std::filesystem::remove(partial_path, ec);
+                std::filesystem::remove(ranges_path, ec);
+                return download_result::hash_mismatch;
+            }
+        }
+
+        std::filesystem::rename(partial_path, destination, ec);
+        if (ec)
+        {
+            return download_result::file_error;
+        }
+
+        std::filesystem::remove(ranges_path, ec);
+        return download_result::success;
+    }
+}
+
+namespace updating
+{
+    std::optional<sha256_digest> parse_sha256_digest(std::wstring_view text)
+    {
+        if (text.starts_with(SHA256_DIGEST_PREFIX))
+        {
+            text.remove_prefix(std::size(SHA256_DIGEST_PREFIX) - 1);
+        }
+
+        sha256_digest digest{};
+        if (text.size() != digest.size() * 2)
+        {
+            return std::nullopt;
+        }
+
+        auto hex_value = [](wchar_t c) {
+            if (c >= L'0' && c <= L'9')
+            {
+                return c - L'0';
+            }
+            else if (c >= L'a' && c <= L'f')
+            {
+                return c - L'a' + 10;
+            }
+            else if (c >= L'A' && c <= L'F')
+            {
+                return c - L'A' + 10;
+            }
+
+            return -1;
+        };
+
+        for (size_t i = 0; i < digest.size(); ++i)
+        {
+            const int high = hex_value(text[2 * i]);
+            const int low = hex_value(text[2 * i + 1]);
+            if (high < 0 || low < 0)
+            {
+                return std::nullopt;
+            }
+
+            digest[i] = static_cast<uint8_t>(high << 4 | low);
+        }
+
+        return digest;
+    }
+
+    std::optional<sha256_digest> compute_file_sha256(const std::filesystem::path& path)
+    {
+        wil::unique_hfile file{ CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr) };
+        if (!file)
+        {
+            return std::nullopt;
+        }
+
+        sha256 hasher;
+        std::vector<uint8_t> buffer(WRITE_BUFFER_SIZE);
+        for (;;)
+        {
+            DWORD read = 0;
+            if (!ReadFile(file.get(), buffer.data(), static_cast<DWORD>(buffer.size()), &read, nullptr))
+            {
+                return std::nullopt;
+            }
+
+            if (read == 0)
+            {
+                break;
+            }
+
+            hasher.update(buffer.data(), read);
+        }
+
+        return hasher.finish();
+    }
+
+    download_result download_file(const Uri& url, const std::filesystem::path& destination, const download_options& options)
+    {
+        auto partial_path = destination;
+        partial_path += PARTIAL_FILE_EXTENSION;
+        auto ranges_path = partial_path;
+        ranges_path += RANGES_FILE_EXTENSION;
+
+        web::HttpClient client{ nullptr };
+        try
+        {
+            client = create_http_client();
+        }
+        catch (...)
+        {
+            return download_result::network_error;
+        }
+
+        download_result result = download_result::network_error;
+        for (size_t attempt = 0; attempt < options.max_attempts; ++attempt)
+        {
+            result = download_once(client, url, destination, partial_path, ranges_path, options);
+            if (result == download_result::success || result == download_result::file_error)
+            {
+                break;
+            }
+        }
+
+        return result;
+    }
+}
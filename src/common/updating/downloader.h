@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <optional>
+#include <string_view>
+#include <winrt/Windows.Foundation.h>
+
+#include "sha256.h"
+
+namespace updating
+{
+    // Parses a hex encoded SHA-256 digest, optionally prefixed with "sha256:" as in the digest of a GitHub release asset
+    std::optional<sha256_digest> parse_sha256_digest(std::wstring_view text);
+
+    // Hashes the file by streaming it through SHA-256
+    std::optional<sha256_digest> compute_file_sha256(const std::filesystem::path& path);
+
+    struct download_options
+    {
+        // Number of ranges of the file downloaded at the same time, when the server supports range requests
+        size_t max_parallel_ranges = 4;
+        // Files aren't split in ranges smaller than this
+        uint64_t min_range_size = 4 * 1024 * 1024;
+        // Each attempt resumes the ranges from where the previous one stopped
+        size_t max_attempts = 3;
+        // The downloaded file is discarded if it doesn't match
+        std::optional<sha256_digest> expected_sha256;
+        // Called from the download threads, one call at a time
+        std::function<void(float)> progress_callback;
+    };
+
+    enum class download_result
+    {
+        success,
+        network_error,
+        file_error,
+        hash_mismatch,
+    };
+
+    // Downloads the url to the destination path. The data goes to destination + ".partial", which is verified and renamed once complete.
+    // The progress of each range is saved to destination + ".partial.ranges" so that an interrupted download resumes in a later call.
+    // Blocks until the download is done, so it shouldn't be called on a STA thread
+    download_result download_file(const winrt::Windows::Foundation::Uri& url, const std::filesystem::path& destination, const download_options& options = {});
+}
@@ -0,0 +1,135 @@
+#include "sha256.h"
+
+#include <algorithm>
+
+namespace
+{
+    const uint32_t ROUND_CONSTANTS[64] = {
+        0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+        0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+        0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+        0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+        0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+        0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+        0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+        0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+    };
+
+    uint32_t rotate_right(uint32_t value, int count)
+    {
+        return (value >> count) | (value << (32 - count));
+    }
+}
+
+namespace updating
+{
+    void sha256::update(const uint8_t* data, size_t size)
+    {
+        m_total_size += size;
+
+        // Complete the pending block first, then process whole blocks straight from the data
+        if (m_block_size > 0)
+        {
+            const size_t count = std::min(size, m_block.size() - m_block_size);
+            std::copy(data, data + count, m_block.begin() + m_block_size);
+            m_block_size += count;
+            data += count;
+            size -= count;
+            if (m_block_size < m_block.size())
+            {
+                return;
+            }
+
+            process_block(m_block.data());
+            m_block_size = 0;
+        }
+
+        for (; size >= m_block.size(); data += m_block.size(), size -= m_block.size())
+        {
+            process_block(data);
+        }
+
+        std::copy(data, data + size, m_block.begin());
+        m_block_size = size;
+    }
+
+    sha256_digest sha256::finish()
+    {
+        // The message is padded with a one bit, zeros and its size in bits so that it ends on a block boundary
+        const uint64_t total_bits = m_total_size * 8;
+        const uint8_t padding[64] = { 0x80 };
+        update(padding, 1 + (m_block_size < 56 ? 55 - m_block_size : 119 - m_block_size));
+
+        uint8_t size_bytes[8];
+        for (int i = 0; i < 8; ++i)
+        {
+            size_bytes[i] = static_cast<uint8_t>(total_bits >> (56 - 8 * i));
+        }
+
+        update(size_bytes, sizeof(size_bytes));
+
+        sha256_digest digest{};
+        for (size_t i = 0; i < m_state.size(); ++i)
+        {
+            for (size_t j = 0; j < 4; ++j)
+            {
+                digest[i * 4 + j] = static_cast<uint8_t>(m_state[i] >> (24 - 8 * j));
+            }
+        }
+
+        return digest;
+    }
+
+    void sha256::process_block(const uint8_t* block)
+    {
+        uint32_t w[64];
+        for (int i = 0; i < 16; ++i)
+        {
+            w[i] = (static_cast<uint32_t>(block[i * 4]) << 24) | (static_cast<uint32_t>(block[i * 4 + 1]) << 16) | (static_cast<uint32_t>(block[i * 4 + 2]) << 8) | block[i * 4 + 3];
+        }
+
+        for (int i = 16; i < 64; ++i)
+        {
+            const uint32_t s0 = rotate_right(w[i - 15], 7) ^ rotate_right(w[i - 15], 18) ^ (w[i - 15] >> 3);
+            const uint32_t s1 = rotate_right(w[i - 2], 17) ^ rotate_right(w[i - 2], 19) ^ (w[i - 2] >> 10);
+            w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+        }
+
+        uint32_t a = m_state[0], b = m_state[1], c = m_state[2], d = m_state[3];
+        uint32_t e = m_state[4], f = m_state[5], g = m_state[6], h = m_state[7];
+        for (int i = 0; i < 64; ++i)
+        {
+            const uint32_t s1 = rotate_right(e, 6) ^ rotate_right(e, 11) ^ rotate_right(e, 25);
+            const uint32_t choice = (e & f) ^ (~e & g);
+            const uint32_t temp1 = h + s1 + choice + ROUND_CONSTANTS[i] + w[i];
+            const uint32_t s0 = rotate_right(a, 2) ^ rotate_right(a, 13) ^ rotate_right(a, 22);
+            const uint32_t majority = (a & b) ^ (a & c) ^ (b & c);
+            const uint32_t temp2 = s0 + majority;
+
+            h = g;
+            g = f;
+            f = e;
+            e = d + temp1;
+            d = c;
+            c = b;
+            b = a;
+            a = temp1 + temp2;
+        }
+
+        m_state[0] += a;
+        m_state[1] += b;
+        m_state[2] += c;
+        m_state[3] += d;
+        m_state[4] += e;
+        m_state[5] += f;
+        m_state[6] += g;
+        m_state[7] += h;
+    }
+
+    sha256_digest compute_sha256(const uint8_t* data, size_t size)
+    {
+        sha256 hash;
+        hash.update(data, size);
+        return hash.finish();
+    }
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace updating
+{
+    using sha256_digest = std::array<uint8_t, 32>;
+
+    // Portable SHA-256, for the code which also runs outside of Windows
+    class sha256
+    {
+    public:
+        void update(const uint8_t* data, size_t size);
+        sha256_digest finish();
+
+    private:
+        void process_block(const uint8_t* block);
+
+        std::array<uint32_t, 8> m_state = { 0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19 };
+        std::array<uint8_t, 64> m_block{};
+        size_t m_block_size = 0;
+        uint64_t m_total_size = 0;
+    };
+
+    sha256_digest compute_sha256(const uint8_t* data, size_t size);
+}
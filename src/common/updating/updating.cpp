@@ -46,7 +46,7 @@ namespace updating
         return std::nullopt;
     }
 
-    std::pair<Uri, std::wstring> extract_installer_asset_download_info(const json::JsonObject& release_object)
+    std::tuple<Uri, std::wstring, std::optional<sha256_digest>> extract_installer_asset_download_info(const json::JsonObject& release_object)
     {
         const std::wstring_view required_architecture = get_architecture_string(get_current_architecture());
         constexpr const std::wstring_view required_filename_pattern = updating::INSTALLER_FILENAME_PATTERN;
@@ -66,7 +66,17 @@ namespace updating
                 const bool asset_matched = extension_matched && architecture_matched && filename_matched;
                 if (extension_matched && architecture_matched && filename_matched)
                 {
-                    return std::make_pair(Uri{ asset.GetNamedString(L"browser_download_url") }, std::move(filename_lower));
+                    // Older releases have no digest or a null one, so the installer isn't verified for them
+                    std::optional<sha256_digest> installer_sha256;
+                    if (asset.HasKey(L"digest"))
+                    {
+                        const auto digest = asset.GetNamedValue(L"digest");
+                        if (digest.ValueType() == json::JsonValueType::String)
+                        {
+                            installer_sha256 = parse_sha256_digest(digest.GetString());
+                        }
+                    }
+                    return std::make_tuple(Uri{ asset.GetNamedString(L"browser_download_url") }, std::move(filename_lower), std::move(installer_sha256));
                 }
             }
         }
@@ -122,11 +132,12 @@ namespace updating
                 co_return version_up_to_date{};
             }
 
-            auto [installer_download_url, installer_filename] = extract_installer_asset_download_info(release_object);
+            auto [installer_download_url, installer_filename, installer_sha256] = extract_installer_asset_download_info(release_object);
             co_return new_version_download_info{ extract_release_page_url(release_object),
                                                  std::move(github_version),
                                                  std::move(installer_download_url),
-                                                 std::move(installer_filename) };
+                                                 std::move(installer_filename),
+                                                 std::move(installer_sha256) };
         }
         catch (...)
         {
@@ -159,21 +170,13 @@ namespace updating
 
         *installer_download_path /= new_version.installer_filename;
 
-        bool download_success = false;
-        for (size_t i = 0; i < MAX_DOWNLOAD_ATTEMPTS; ++i)
-        {
-            try
-            {
-                http::HttpClient client;
-                co_await client.download(new_version.installer_download_url, *installer_download_path);
-                download_success = true;
-                break;
-            }
-            catch (...)
-            {
-                // reattempt to download or do nothing
-            }
-        }
+        // The download blocks until it is done, so keep it off the calling thread
+        co_await winrt::resume_background();
+
+        download_options options;
+        options.max_attempts = MAX_DOWNLOAD_ATTEMPTS;
+        options.expected_sha256 = new_version.installer_sha256;
+        const bool download_success = download_file(new_version.installer_download_url, *installer_download_path, options) == download_result::success;
         co_return download_success ? installer_download_path : std::nullopt;
     }
 
@@ -10,6 +10,8 @@
 
 #include <common/version/helper.h>
 
+#include "downloader.h"
+
 namespace updating
 {
     using winrt::Windows::Foundation::Uri;
@@ -22,6 +24,7 @@ namespace updating
         VersionHelper version{ 0, 0, 0 };
         Uri installer_download_url = nullptr;
         std::wstring installer_filename;
+        std::optional<sha256_digest> installer_sha256;
     };
     using github_version_info = std::variant<new_version_download_info, version_up_to_date>;
 
@@ -0,0 +1,122 @@
+#include "pch.h"
+#include "ExcludedAppsMatcher.h"
+
+#include <algorithm>
+#include <atomic>
+#include <queue>
+
+uint64_t ExcludedAppsMatcher::NextGeneration() noexcept
+{
+    static std::atomic<uint64_t> generation = 0;
+    return ++generation;
+}
+
+ExcludedAppsMatcher::ExcludedAppsMatcher(const std::vector<std::wstring>& patterns)
+{
+    for (const auto& pattern : patterns)
+    {
+        if (pattern.empty())
+        {
+            m_hasEmptyPattern = true;
+            continue;
+        }
+
+        int node = 0;
+        for (wchar_t ch : pattern)
+        {
+            int next = Child(node, ch);
+            node = next >= 0 ? next : AddChild(node, ch);
+        }
+        m_nodes[node].terminal = true;
+    }
+
+    // Breadth first, so the fail link of a node is always computed before its children need it
+    std::queue<int> queue;
+    for (const auto& [ch, child] : m_nodes[0].children)
+    {
+        m_nodes[child].fail = 0;
+        m_nodes[child].output = m_nodes[child].terminal ? child : -1;
+        queue.push(child);
+    }
+
+    while (!queue.empty())
+    {
+        int node = queue.front();
+        queue.pop();
+        for (const auto& [ch, child] : m_nodes[node].children)
+        {
+            int fail = m_nodes[node].fail;
+            int next = Child(fail, ch);
+            while (next < 0 && fail != 0)
+            {
+                fail = m_nodes[fail].fail;
+                next = Child(fail, ch);
+            }
+            m_nodes[child].fail = next >= 0 && next != child ? next : 0;
+            m_nodes[child].output = m_nodes[child].terminal ? child : m_nodes[m_nodes[child].fail].output;
+            queue.push(child);
+        }
+    }
+}
+
+int ExcludedAppsMatcher::Child(int node, wchar_t ch) const noexcept
+{
+    const auto& children = m_nodes[node].children;
+    auto it = std::lower_bound(children.begin(), children.end(), ch, [](const auto& child, wchar_t value) { return child.first < value; });
+    return it != children.end() && it->first == ch ? it->second : -1;
+}
+
+int ExcludedAppsMatcher::AddChild(int node, wchar_t ch)
+{
+    int child = static_cast<int>(m_nodes.size());
+    Node created;
+    created.depth = m_nodes[node].depth + 1;
+    m_nodes.push_back(std::move(created));
+
+    auto& children = m_nodes[node].children;
+    auto it = std::lower_bound(children.begin(), children.end(), ch, [](const auto& c, wchar_t value) { return c.first < value; });
+    children.insert(it, { ch, child });
+    return child;
+}
+
+bool ExcludedAppsMatcher::Matches(std::wstring_view path) const noexcept
+{
+    const size_t lastSlash = path.rfind(L'\\');
+    if (lastSlash == std::wstring_view::npos)
+    {
+        return false;
+    }
+
+    if (m_hasEmptyPattern && lastSlash + 1 == path.size())
+    {
+        return true;
+    }
+
+    // Only the last occurrence of a pattern decides. Occurrences of a pattern come in increasing order of their
+    // start, so one touching the file name is only overridden by a later one that starts inside the file name.
+    // That is looked up in the path itself, the pattern being the characters the occurrence spans, so nothing
+    // has to be allocated here.
+    const size_t insideFileName = lastSlash + 2;
+    int state = 0;
+    for (size_t i = 0; i < path.size(); ++i)
+    {
+        int next = Child(state, path[i]);
+        while (next < 0 && state != 0)
+        {
+            state = m_nodes[state].fail;
+            next = Child(state, path[i]);
+        }
+        state = next >= 0 ? next : 0;
+
+        for (int match = m_nodes[state].output; match >= 0; match = m_nodes[m_nodes[match].fail].output)
+        {
+            const size_t start = i + 1 - m_nodes[match].depth;
+            if (start <= lastSlash + 1 && i >= lastSlash && path.find(path.substr(start, m_nodes[match].depth), insideFileName) == std::wstring_view::npos)
+            {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Matches a process path against all excluded apps at once. The patterns are compiled into an
+// Aho-Corasick automaton, so a lookup scans the path a single time regardless of the number of patterns.
+// A pattern matches when its last occurrence in the path touches the file name, i.e. it starts at or before
+// the first character after the last backslash and ends at or after that backslash.
+// Both the patterns and the path are expected to be upper case.
+class ExcludedAppsMatcher
+{
+public:
+    ExcludedAppsMatcher() = default;
+    explicit ExcludedAppsMatcher(const std::vector<std::wstring>& patterns);
+
+    bool Matches(std::wstring_view path) const noexcept;
+
+    // Unique per compiled set of patterns, lets callers cache match results until the exclusions change
+    uint64_t Generation() const noexcept { return m_generation; }
+
+private:
+    struct Node
+    {
+        // Sorted by character
+        std::vector<std::pair<wchar_t, int>> children;
+        int fail = 0;
+        // Closest node on the fail chain (including this one) that ends a pattern, -1 if none
+        int output = -1;
+        // Length of the pattern ending here, which is also the depth of the node
+        int depth = 0;
+        bool terminal = false;
+    };
+
+    int Child(int node, wchar_t ch) const noexcept;
+    int AddChild(int node, wchar_t ch);
+
+    std::vector<Node> m_nodes{ Node{} };
+    bool m_hasEmptyPattern = false;
+    uint64_t m_generation = NextGeneration();
+
+    static uint64_t NextGeneration() noexcept;
+};
@@ -13,10 +13,12 @@
 #include <FancyZonesLib/FancyZonesData.h>
 #include <FancyZonesLib/FancyZonesWinHookEventIDs.h>
 #include <FancyZonesLib/MonitorUtils.h>
+#include <FancyZonesLib/ProcessCache.h>
 #include <FancyZonesLib/Settings.h>
 #include <FancyZonesLib/ZoneSet.h>
 #include <FancyZonesLib/WorkArea.h>
 #include <FancyZonesLib/WindowMoveHandler.h>
+#include <FancyZonesLib/WindowZoneRegistry.h>
 #include <FancyZonesLib/util.h>
 
 #include "on_thread_executor.h"
@@ -28,6 +30,8 @@
 
 #include <FancyZonesLib/SecondaryMouseButtonsHook.h>
 
+#include <chrono>
+
 enum class DisplayChangeType
 {
     WorkArea,
@@ -151,6 +155,8 @@ private:
     bool OnSnapHotkeyBasedOnPosition(HWND window, DWORD vkCode) noexcept;
     bool OnSnapHotkey(DWORD vkCode) noexcept;
     bool ProcessDirectedSnapHotkey(HWND window, DWORD vkCode, bool cycle, winrt::com_ptr<IWorkArea> zoneWindow) noexcept;
+    std::optional<bool> MoveWindowAlongZoneGraph(HWND window, DWORD vkCode, HMONITOR current) noexcept;
+    void UpdateZoneGraph(const std::vector<std::pair<HMONITOR, RECT>>& allMonitors) noexcept;
 
     void RegisterVirtualDesktopUpdates() noexcept;
 
@@ -190,6 +196,18 @@ private:
 
     EventWaiter m_toggleEditorEventWaiter;
 
+    // Zones of all the monitors of the current desktop, for moving windows across monitors.
+    // The graph is rebuilt when the monitors or the active zone sets change.
+    struct ZoneGraphArea
+    {
+        HMONITOR monitor;
+        RECT rect;
+        winrt::com_ptr<IWorkArea> workArea;
+        winrt::com_ptr<IZoneSet> zoneSet;
+    };
+    std::vector<ZoneGraphArea> m_zoneGraphAreas;
+    LayoutEngine::ZoneGraph m_zoneGraph;
+
     // If non-recoverable error occurs, trigger disabling of entire FancyZones.
     static std::function<void()> disableModuleCallback;
 
@@ -246,6 +264,8 @@ IFACEMETHODIMP_(void)
 FancyZones::Destroy() noexcept
 {
     m_workAreaHandler.Clear();
+    m_zoneGraphAreas.clear();
+    m_zoneGraph = {};
     BufferedPaintUnInit();
     if (m_window)
     {
@@ -254,6 +274,8 @@ FancyZones::Destroy() noexcept
     }
 
     m_virtualDesktop.UnInit();
+    ProcessCacheInstance().Clear();
+    WindowZoneRegistryInstance().Clear();
 }
 
 // IFancyZonesCallback
@@ -328,8 +350,8 @@ void FancyZones::WindowCreated(HWND window) noexcept
     // Avoid processing splash screens, already stamped (zoned) windows, or those windows
     // that belong to excluded applications list.
     const bool isSplashScreen = FancyZonesUtils::IsSplashScreen(window);
-    const bool isZoned = reinterpret_cast<size_t>(::GetProp(window, ZonedWindowProperties::PropertyMultipleZoneID)) != 0;
-    const bool isCandidateForLastKnownZone = FancyZonesUtils::IsCandidateForLastKnownZone(window, m_settings->GetSettings()->excludedAppsArray);
+    const bool isZoned = WindowZoneRegistryInstance().IsZoned(window);
+    const bool isCandidateForLastKnownZone = FancyZonesUtils::IsCandidateForLastKnownZone(window, m_settings->GetSettings()->excludedAppsMatcher);
     const bool shouldProcessNewWindow = !isSplashScreen && !isZoned && isCandidateForLastKnownZone;
 
     if ((moveToAppLastZone || openOnActiveMonitor) && shouldProcessNewWindow)
@@ -413,7 +435,7 @@ FancyZones::OnKeyDown(PKBDLLHOOKSTRUCT info) noexcept
         if (changeLayoutWhileNotDragging || changeLayoutWhileDragging)
         {
             auto quickKeysMap = FancyZonesDataInstance().GetLayoutQuickKeys();
-            if (std::any_of(quickKeysMap.begin(), quickKeysMap.end(), [=](auto item) { return item.second == digitPressed; }))
+            if (std::any_of(quickKeysMap->begin(), quickKeysMap->end(), [=](auto item) { return item.second == digitPressed; }))
             {
                 PostMessageW(m_window, WM_PRIV_QUICK_LAYOUT_KEY, 0, static_cast<LPARAM>(digitPressed));
                 Trace::FancyZones::QuickLayoutSwitched(changeLayoutWhileNotDragging);
@@ -730,6 +752,7 @@ void FancyZones::OnDisplayChange(DisplayChangeType changeType) noexcept
     }
 
     UpdateZoneWindows();
+    UpdateZoneGraph(FancyZonesUtils::GetAllMonitorRects<&MONITORINFOEX::rcWork>());
 
     if ((changeType == DisplayChangeType::WorkArea) || (changeType == DisplayChangeType::DisplayChange))
     {
@@ -827,35 +850,50 @@ void FancyZones::UpdateZoneWindows() noexcept
 
 void FancyZones::UpdateWindowsPositions() noexcept
 {
+    _TRACER_;
+    const auto start = std::chrono::steady_clock::now();
+
+    // Target rects are computed for all the windows before any of them is moved,
+    // the windows are then moved together instead of being repainted one by one
+    struct capture
+    {
+        FancyZones* fancyZones;
+        std::vector<std::pair<HWND, RECT>>* windowRects;
+    };
+
     auto callback = [](HWND window, LPARAM data) -> BOOL {
-        size_t bitmask = reinterpret_cast<size_t>(::GetProp(window, ZonedWindowProperties::PropertyMultipleZoneID));
+        const auto zones = WindowZoneRegistryInstance().GetZones(window);
 
-        if (bitmask != 0)
+        if (!zones.Empty())
         {
-            std::vector<size_t> indexSet;
-            for (int i = 0; i < std::numeric_limits<size_t>::digits; i++)
-            {
-                if ((1ull << i) & bitmask)
-                {
-                    indexSet.push_back(i);
-                }
-            }
-
-            auto strongThis = reinterpret_cast<FancyZones*>(data);
+            const auto indexSet = zones.ToIndexSet();
+            auto params = reinterpret_cast<capture*>(data);
+            auto strongThis = params->fancyZones;
             auto desktopId = strongThis->m_virtualDesktop.GetWindowDesktopId(window);
             if (desktopId.has_value())
             {
                 auto zoneWindow = strongThis->m_workAreaHandler.GetWorkArea(window, *desktopId);
                 if (zoneWindow)
                 {
-                    strongThis->m_windowMoveHandler.MoveWindowIntoZoneByIndexSet(window, indexSet, zoneWindow);
+                    if (auto rect = strongThis->m_windowMoveHandler.AssignWindowToZoneByIndexSet(window, indexSet, zoneWindow))
+                    {
+                        params->windowRects->emplace_back(window, *rect);
+                    }
                 }
             }
-            
         }
         return TRUE;
     };
-    EnumWindows(callback, reinterpret_cast<LPARAM>(this));
+
+    std::vector<std::pair<HWND, RECT>> windowRects;
+    capture capture{ this, &windowRects };
+    EnumWindows(callback, reinterpret_cast<LPARAM>(&capture));
+
+    const auto transactions = FancyZonesUtils::SizeWindowsToRects(windowRects);
+
+    const auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+    Logger::info(L"Moved {} windows in {} transactions, {} ms", windowRects.size(), transactions, duration);
+    Trace::FancyZones::WindowsRelayout(windowRects.size(), transactions, duration);
 }
 
 bool FancyZones::OnSnapHotkeyBasedOnZoneNumber(HWND window, DWORD vkCode) noexcept
@@ -924,6 +962,13 @@ bool FancyZones::OnSnapHotkeyBasedOnPosition(HWND window, DWORD vkCode) noexcept
     if (current && allMonitors.size() > 1 && m_settings->GetSettings()->moveWindowAcrossMonitors)
     {
         // Multi monitor environment.
+        // A window snapped to a single zone moves to the neighbor precomputed for that zone
+        UpdateZoneGraph(allMonitors);
+        if (auto moved = MoveWindowAlongZoneGraph(window, vkCode, current))
+        {
+            return *moved;
+        }
+
         // First, try to stay on the same monitor
         bool success = ProcessDirectedSnapHotkey(window, vkCode, false, m_workAreaHandler.GetWorkArea(m_currentDesktopId, current));
         if (success)
@@ -1056,6 +1101,92 @@ bool FancyZones::OnSnapHotkey(DWORD vkCode) noexcept
     return false;
 }
 
+std::optional<bool> FancyZones::MoveWindowAlongZoneGraph(HWND window, DWORD vkCode, HMONITOR current) noexcept
+{
+    // Extending a window depends on the zones it's been extended over, that's kept by its zone set
+    const auto direction = FancyZonesUtils::DirectionFromVkCode(vkCode);
+    if (!direction || (GetAsyncKeyState(VK_MENU) & 0x8000))
+    {
+        return std::nullopt;
+    }
+
+    auto area = std::find_if(m_zoneGraphAreas.begin(), m_zoneGraphAreas.end(), [current](const ZoneGraphArea& candidate) { return candidate.monitor == current; });
+    if (area == m_zoneGraphAreas.end() || !area->zoneSet)
+    {
+        return std::nullopt;
+    }
+
+    const auto zoneIndexSet = area->zoneSet->GetZoneIndexSetFromWindow(window);
+    const size_t node = zoneIndexSet.size() == 1 ? m_zoneGraph.Find(area - m_zoneGraphAreas.begin(), zoneIndexSet[0]) : LayoutEngine::ZoneGraph::None;
+    if (node == LayoutEngine::ZoneGraph::None)
+    {
+        return std::nullopt;
+    }
+
+    if (size_t next = m_zoneGraph.Neighbor(node, *direction); next != LayoutEngine::ZoneGraph::None)
+    {
+        area->workArea->MoveWindowIntoZoneByIndexSet(window, { m_zoneGraph.At(next).zoneId });
+        area->workArea->SaveWindowProcessToZoneIndex(window);
+        return true;
+    }
+
+    if (size_t next = m_zoneGraph.NextAcrossAreas(node, *direction); next != LayoutEngine::ZoneGraph::None)
+    {
+        const auto& target = m_zoneGraph.At(next);
+        m_windowMoveHandler.MoveWindowIntoZoneByIndexSet(window, { target.zoneId }, m_zoneGraphAreas[target.area].workArea);
+        return true;
+    }
+
+    return false;
+}
+
+void FancyZones::UpdateZoneGraph(const std::vector<std::pair<HMONITOR, RECT>>& allMonitors) noexcept
+{
+    std::vector<ZoneGraphArea> areas;
+    areas.reserve(allMonitors.size());
+    for (const auto& [monitor, monitorRect] : allMonitors)
+    {
+        auto workArea = m_workAreaHandler.GetWorkArea(m_currentDesktopId, monitor);
+        winrt::com_ptr<IZoneSet> zoneSet;
+        if (workArea)
+        {
+            zoneSet.copy_from(workArea->ActiveZoneSet());
+        }
+        areas.push_back({ monitor, monitorRect, workArea, zoneSet });
+    }
+
+    // Layout changes come with new zone sets
+    auto sameArea = [](const ZoneGraphArea& lhs, const ZoneGraphArea& rhs) {
+        return lhs.monitor == rhs.monitor && EqualRect(&lhs.rect, &rhs.rect) && lhs.zoneSet == rhs.zoneSet;
+    };
+    if (std::equal(areas.begin(), areas.end(), m_zoneGraphAreas.begin(), m_zoneGraphAreas.end(), sameArea))
+    {
+        return;
+    }
+
+    std::vector<LayoutEngine::ZoneGraph::Node> nodes;
+    std::vector<LayoutEngine::Rect> areaRects;
+    for (size_t i = 0; i < areas.size(); i++)
+    {
+        const RECT& monitorRect = areas[i].rect;
+        areaRects.push_back({ monitorRect.left, monitorRect.top, monitorRect.right, monitorRect.bottom });
+
+        if (areas[i].zoneSet)
+        {
+            for (const auto& [zoneId, zone] : areas[i].zoneSet->GetZones())
+            {
+                const RECT zoneRect = zone->GetZoneRect();
+                nodes.push_back({ .area = i,
+                                  .zoneId = zoneId,
+                                  .rect = { zoneRect.left + monitorRect.left, zoneRect.top + monitorRect.top, zoneRect.right + monitorRect.left, zoneRect.bottom + monitorRect.top } });
+            }
+        }
+    }
+
+    m_zoneGraph = LayoutEngine::ZoneGraph(std::move(nodes), areaRects);
+    m_zoneGraphAreas = std::move(areas);
+}
+
 bool FancyZones::ProcessDirectedSnapHotkey(HWND window, DWORD vkCode, bool cycle, winrt::com_ptr<IWorkArea> zoneWindow) noexcept
 {
     // Check whether Alt is used in the shortcut key combination
@@ -1138,6 +1269,8 @@ void FancyZones::UpdateZoneSets() noexcept
     {
         workArea->UpdateActiveZoneSet();
     }
+    UpdateZoneGraph(FancyZonesUtils::GetAllMonitorRects<&MONITORINFOEX::rcWork>());
+
     if (m_settings->GetSettings()->zoneSetChange_moveWindows)
     {
         UpdateWindowsPositions();
@@ -1147,7 +1280,7 @@ void FancyZones::UpdateZoneSets() noexcept
 bool FancyZones::ShouldProcessSnapHotkey(DWORD vkCode) noexcept
 {
     auto window = GetForegroundWindow();
-    if (m_settings->GetSettings()->overrideSnapHotkeys && FancyZonesUtils::IsCandidateForZoning(window, m_settings->GetSettings()->excludedAppsArray))
+    if (m_settings->GetSettings()->overrideSnapHotkeys && FancyZonesUtils::IsCandidateForZoning(window, m_settings->GetSettings()->excludedAppsMatcher))
     {
         HMONITOR monitor = WorkAreaKeyFromWindow(window);
 
@@ -1170,7 +1303,8 @@ bool FancyZones::ShouldProcessSnapHotkey(DWORD vkCode) noexcept
 void FancyZones::ApplyQuickLayout(int key) noexcept
 {
     std::wstring uuid;
-    for (auto [zoneUuid, hotkey] : FancyZonesDataInstance().GetLayoutQuickKeys())
+    const auto quickKeys = FancyZonesDataInstance().GetLayoutQuickKeys();
+    for (auto [zoneUuid, hotkey] : *quickKeys)
     {
         if (hotkey == key)
         {
@@ -1183,7 +1317,7 @@ void FancyZones::ApplyQuickLayout(int key) noexcept
     // Find a custom zone set with this uuid and apply it
     auto customZoneSets = FancyZonesDataInstance().GetCustomZoneSetsMap();
 
-    if (!customZoneSets.contains(uuid))
+    if (!customZoneSets->contains(uuid))
     {
         return;
     }
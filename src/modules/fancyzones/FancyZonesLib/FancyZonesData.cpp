@@ -5,19 +5,22 @@
 #include "ZoneSet.h"
 #include "Settings.h"
 #include "CallTracer.h"
+#include "ProcessCache.h"
+#include "WindowZoneRegistry.h"
 
 #include <common/Display/dpi_aware.h>
 #include <common/utils/json.h>
 #include <FancyZonesLib/util.h>
 
 #include <shlwapi.h>
+#include <algorithm>
+#include <iterator>
 #include <filesystem>
 #include <fstream>
 #include <optional>
 #include <regex>
 #include <sstream>
 #include <unordered_set>
-#include <common/utils/process_path.h>
 #include <common/logger/logger.h>
 
 // Non-localizable strings
@@ -156,36 +159,69 @@ FancyZonesData::FancyZonesData()
     editorParametersFileName = saveFolderPath + L"\\" + std::wstring(NonLocalizable::FancyZonesEditorParametersFile);
 }
 
-const JSONHelpers::TDeviceInfoMap& FancyZonesData::GetDeviceInfoMap() const
+std::shared_ptr<const JSONHelpers::TDeviceInfoMap> FancyZonesData::GetDeviceInfoMap() const
 {
-    std::scoped_lock lock{ dataLock };
-    return deviceInfoMap;
+    auto settings = GetZoneSettings();
+    return { settings, &settings->deviceInfoMap };
 }
 
-const JSONHelpers::TCustomZoneSetsMap& FancyZonesData::GetCustomZoneSetsMap() const
+std::shared_ptr<const JSONHelpers::TCustomZoneSetsMap> FancyZonesData::GetCustomZoneSetsMap() const
 {
-    std::scoped_lock lock{ dataLock };
-    return customZoneSetsMap;
+    auto settings = GetZoneSettings();
+    return { settings, &settings->customZoneSetsMap };
+}
+
+std::shared_ptr<const JSONHelpers::TLayoutQuickKeysMap> FancyZonesData::GetLayoutQuickKeys() const
+{
+    auto settings = GetZoneSettings();
+    return { settings, &settings->quickKeysMap };
 }
 
-const std::unordered_map<std::wstring, std::vector<FancyZonesDataTypes::AppZoneHistoryData>>& FancyZonesData::GetAppZoneHistoryMap() const
+std::shared_ptr<const JSONHelpers::TAppZoneHistoryMap> FancyZonesData::GetAppZoneHistoryMap() const
 {
     std::scoped_lock lock{ dataLock };
+    if (!appZoneHistoryMapValid || !appZoneHistoryMap)
+    {
+        std::vector<std::pair<IdInterner::Handle, const AppZoneHistoryEntry*>> entries;
+        entries.reserve(appZoneHistory.size());
+        for (const auto& [key, workAreaEntries] : appZoneHistory)
+        {
+            for (const auto& entry : workAreaEntries)
+            {
+                entries.emplace_back(key.app, &entry);
+            }
+        }
+
+        std::sort(std::begin(entries), std::end(entries), [](const auto& lhs, const auto& rhs) {
+            return lhs.second->order < rhs.second->order;
+        });
+
+        // The previous map may still be in use by a reader or a save, build a new one
+        auto map = std::make_shared<JSONHelpers::TAppZoneHistoryMap>();
+        for (const auto& [app, entry] : entries)
+        {
+            (*map)[appPathIds.Resolve(app)].push_back(entry->data);
+        }
+
+        appZoneHistoryMap = std::move(map);
+        appZoneHistoryMapValid = true;
+    }
+
     return appZoneHistoryMap;
 }
 
 std::optional<FancyZonesDataTypes::DeviceInfoData> FancyZonesData::FindDeviceInfo(const std::wstring& zoneWindowId) const
 {
-    std::scoped_lock lock{ dataLock };
-    auto it = deviceInfoMap.find(zoneWindowId);
-    return it != end(deviceInfoMap) ? std::optional{ it->second } : std::nullopt;
+    const auto settings = GetZoneSettings();
+    auto it = settings->deviceInfoMap.find(zoneWindowId);
+    return it != end(settings->deviceInfoMap) ? std::optional{ it->second } : std::nullopt;
 }
 
 std::optional<FancyZonesDataTypes::CustomZoneSetData> FancyZonesData::FindCustomZoneSet(const std::wstring& guid) const
 {
-    std::scoped_lock lock{ dataLock };
-    auto it = customZoneSetsMap.find(guid);
-    return it != end(customZoneSetsMap) ? std::optional{ it->second } : std::nullopt;
+    const auto settings = GetZoneSettings();
+    auto it = settings->customZoneSetsMap.find(guid);
+    return it != end(settings->customZoneSetsMap) ? std::optional{ it->second } : std::nullopt;
 }
 
 bool FancyZonesData::AddDevice(const std::wstring& deviceId)
@@ -193,8 +229,14 @@ bool FancyZonesData::AddDevice(const std::wstring& deviceId)
     _TRACER_;
     using namespace FancyZonesDataTypes;
 
+    if (GetZoneSettings()->deviceInfoMap.contains(deviceId))
+    {
+        return false;
+    }
+
     std::scoped_lock lock{ dataLock };
-    if (!deviceInfoMap.contains(deviceId))
+    auto settings = CopyZoneSettings();
+    if (!settings->deviceInfoMap.contains(deviceId))
     {
         // Creates default entry in map when WorkArea is created
         GUID guid;
@@ -204,13 +246,14 @@ bool FancyZonesData::AddDevice(const std::wstring& deviceId)
         {
             const ZoneSetData zoneSetData{ guidString.get(), ZoneSetLayoutType::PriorityGrid };
             DeviceInfoData defaultDeviceInfoData{ zoneSetData, DefaultValues::ShowSpacing, DefaultValues::Spacing, DefaultValues::ZoneCount, DefaultValues::SensitivityRadius };
-            deviceInfoMap[deviceId] = std::move(defaultDeviceInfoData);
+            settings->deviceInfoMap[deviceId] = std::move(defaultDeviceInfoData);
         }
         else
         {
-            deviceInfoMap[deviceId] = DeviceInfoData{ ZoneSetData{ NonLocalizable::NullStr, ZoneSetLayoutType::Blank } };
+            settings->deviceInfoMap[deviceId] = DeviceInfoData{ ZoneSetData{ NonLocalizable::NullStr, ZoneSetLayoutType::Blank } };
         }
 
+        PublishZoneSettings(std::move(settings));
         return true;
     }
 
@@ -226,12 +269,14 @@ void FancyZonesData::CloneDeviceInfo(const std::wstring& source, const std::wstr
     std::scoped_lock lock{ dataLock };
 
     // The source virtual desktop is deleted, simply ignore it.
-    if (!deviceInfoMap.contains(source))
+    if (!GetZoneSettings()->deviceInfoMap.contains(source))
     {
         return;
     }
 
-    deviceInfoMap[destination] = deviceInfoMap[source];
+    auto settings = CopyZoneSettings();
+    settings->deviceInfoMap[destination] = settings->deviceInfoMap[source];
+    PublishZoneSettings(std::move(settings));
 }
 
 void FancyZonesData::UpdatePrimaryDesktopData(const std::wstring& desktopId)
@@ -247,39 +292,70 @@ void FancyZonesData::UpdatePrimaryDesktopData(const std::wstring& desktopId)
         return deviceId.substr(0, deviceId.rfind('_') + 1) + desktopId;
     };
 
-    std::scoped_lock lock{ dataLock };
     bool dirtyFlag = false;
-
-    for (auto& [path, perDesktopData] : appZoneHistoryMap)
     {
-        for (auto& data : perDesktopData)
+        std::scoped_lock lock{ dataLock };
+
+        if (const auto defaultDesktop = desktopIds.Find(NonLocalizable::DefaultGuid); defaultDesktop != IdInterner::InvalidHandle)
         {
-            if (ExtractVirtualDesktopId(data.deviceId) == NonLocalizable::DefaultGuid)
+            std::vector<AppZoneHistoryKey> historyToReplace{};
+            for (const auto& [key, entries] : appZoneHistory)
+            {
+                if (entries.front().desktop == defaultDesktop)
+                {
+                    historyToReplace.push_back(key);
+                }
+            }
+
+            for (const auto& key : historyToReplace)
             {
-                data.deviceId = replaceDesktopId(data.deviceId);
+                auto history = appZoneHistory.extract(key);
+                for (auto& entry : history.mapped())
+                {
+                    entry.data.deviceId = replaceDesktopId(entry.data.deviceId);
+                    entry.desktop = desktopIds.Intern(ExtractVirtualDesktopId(entry.data.deviceId));
+                }
+                history.key().device = deviceIds.Intern(history.mapped().front().data.deviceId);
+
+                // The app may already have history on the work area with the new id, keep all entries in the order they were added
+                auto inserted = appZoneHistory.insert(std::move(history));
+                if (!inserted.inserted)
+                {
+                    auto& entries = inserted.position->second;
+                    std::move(std::begin(inserted.node.mapped()), std::end(inserted.node.mapped()), std::back_inserter(entries));
+                    std::sort(std::begin(entries), std::end(entries), [](const auto& lhs, const auto& rhs) {
+                        return lhs.order < rhs.order;
+                    });
+                }
+                appZoneHistoryMapValid = false;
                 dirtyFlag = true;
             }
         }
-    }
-    
-    std::vector<std::wstring> toReplace{};
-    
-    for (const auto& [id, data] : deviceInfoMap)
-    {
-        if (ExtractVirtualDesktopId(id) == NonLocalizable::DefaultGuid)
+
+        std::vector<std::wstring> toReplace{};
+
+        for (const auto& [id, data] : GetZoneSettings()->deviceInfoMap)
         {
-            toReplace.push_back(id);
-            dirtyFlag = true;
+            if (ExtractVirtualDesktopId(id) == NonLocalizable::DefaultGuid)
+            {
+                toReplace.push_back(id);
+                dirtyFlag = true;
+            }
+        }
+
+        if (!toReplace.empty())
+        {
+            auto settings = CopyZoneSettings();
+            for (const auto& id : toReplace)
+            {
+                auto mapEntry = settings->deviceInfoMap.extract(id);
+                mapEntry.key() = replaceDesktopId(id);
+                settings->deviceInfoMap.insert(std::move(mapEntry));
+            }
+            PublishZoneSettings(std::move(settings));
         }
     }
-    
-    for (const auto& id : toReplace)
-    {
-        auto mapEntry = deviceInfoMap.extract(id);
-        mapEntry.key() = replaceDesktopId(id);
-        deviceInfoMap.insert(std::move(mapEntry));
-    }
-    
+
     // TODO: when updating the primary desktop GUID, the app zone history also needs to be updated 
     if (dirtyFlag)
     {
@@ -290,24 +366,32 @@ void FancyZonesData::UpdatePrimaryDesktopData(const std::wstring& desktopId)
 void FancyZonesData::RemoveDeletedDesktops(const std::vector<std::wstring>& activeDesktops)
 {
     std::unordered_set<std::wstring> active(std::begin(activeDesktops), std::end(activeDesktops));
-    std::scoped_lock lock{ dataLock };
     bool dirtyFlag = false;
-
-    for (auto it = std::begin(deviceInfoMap); it != std::end(deviceInfoMap);)
     {
-        std::wstring desktopId = ExtractVirtualDesktopId(it->first);
-        if (desktopId != NonLocalizable::DefaultGuid)
+        std::scoped_lock lock{ dataLock };
+        auto settings = CopyZoneSettings();
+
+        for (auto it = std::begin(settings->deviceInfoMap); it != std::end(settings->deviceInfoMap);)
         {
-            auto foundId = active.find(desktopId);
-            if (foundId == std::end(active))
+            std::wstring desktopId = ExtractVirtualDesktopId(it->first);
+            if (desktopId != NonLocalizable::DefaultGuid)
             {
-                RemoveDesktopAppZoneHistory(desktopId);
-                it = deviceInfoMap.erase(it);
-                dirtyFlag = true;
-                continue;
+                auto foundId = active.find(desktopId);
+                if (foundId == std::end(active))
+                {
+                    RemoveDesktopAppZoneHistory(desktopId);
+                    it = settings->deviceInfoMap.erase(it);
+                    dirtyFlag = true;
+                    continue;
+                }
             }
+            ++it;
+        }
+
+        if (dirtyFlag)
+        {
+            PublishZoneSettings(std::move(settings));
         }
-        ++it;
     }
 
     if (dirtyFlag)
@@ -318,31 +402,32 @@ void FancyZonesData::RemoveDeletedDesktops(const std::vector<std::wstring>& acti
 
 bool FancyZonesData::IsAnotherWindowOfApplicationInstanceZoned(HWND window, const std::wstring_view& deviceId) const
 {
+    auto processPath = ProcessCacheInstance().GetProcessPath(window);
     std::scoped_lock lock{ dataLock };
-    auto processPath = get_process_path(window);
+    return IsAnotherWindowOfApplicationInstanceZoned(window, processPath, deviceId);
+}
+
+bool FancyZonesData::IsAnotherWindowOfApplicationInstanceZoned(HWND window, const std::wstring& processPath, const std::wstring_view& deviceId) const
+{
     if (!processPath.empty())
     {
-        auto history = appZoneHistoryMap.find(processPath);
-        if (history != std::end(appZoneHistoryMap))
+        auto history = FindAppZoneHistoryEntries(processPath, deviceId);
+        if (history != std::end(appZoneHistory))
         {
-            auto& perDesktopData = history->second;
-            for (auto& data : perDesktopData)
+            DWORD processId = 0;
+            GetWindowThreadProcessId(window, &processId);
+
+            for (const auto& entry : history->second)
             {
-                if (data.deviceId == deviceId)
+                auto processIdIt = entry.data.processIdToHandleMap.find(processId);
+
+                if (processIdIt == std::end(entry.data.processIdToHandleMap))
                 {
-                    DWORD processId = 0;
-                    GetWindowThreadProcessId(window, &processId);
-
-                    auto processIdIt = data.processIdToHandleMap.find(processId);
-
-                    if (processIdIt == std::end(data.processIdToHandleMap))
-                    {
-                        return false;
-                    }
-                    else if (processIdIt->second != window && IsWindow(processIdIt->second))
-                    {
-                        return true;
-                    }
+                    return false;
+                }
+                else if (processIdIt->second != window && IsWindow(processIdIt->second))
+                {
+                    return true;
                 }
             }
         }
@@ -353,43 +438,36 @@ bool FancyZonesData::IsAnotherWindowOfApplicationInstanceZoned(HWND window, cons
 
 void FancyZonesData::UpdateProcessIdToHandleMap(HWND window, const std::wstring_view& deviceId)
 {
+    auto processPath = ProcessCacheInstance().GetProcessPath(window);
     std::scoped_lock lock{ dataLock };
-    auto processPath = get_process_path(window);
     if (!processPath.empty())
     {
-        auto history = appZoneHistoryMap.find(processPath);
-        if (history != std::end(appZoneHistoryMap))
+        auto history = FindAppZoneHistoryEntries(processPath, deviceId);
+        if (history != std::end(appZoneHistory))
         {
-            auto& perDesktopData = history->second;
-            for (auto& data : perDesktopData)
-            {
-                if (data.deviceId == deviceId)
-                {
-                    DWORD processId = 0;
-                    GetWindowThreadProcessId(window, &processId);
-                    data.processIdToHandleMap[processId] = window;
-                    break;
-                }
-            }
+            DWORD processId = 0;
+            GetWindowThreadProcessId(window, &processId);
+            history->second.front().data.processIdToHandleMap[processId] = window;
+            appZoneHistoryMapValid = false;
         }
     }
 }
 
 std::vector<size_t> FancyZonesData::GetAppLastZoneIndexSet(HWND window, const std::wstring_view& deviceId, const std::wstring_view& zoneSetId) const
 {
+    auto processPath = ProcessCacheInstance().GetProcessPath(window);
     std::scoped_lock lock{ dataLock };
-    auto processPath = get_process_path(window);
     if (!processPath.empty())
     {
-        auto history = appZoneHistoryMap.find(processPath);
-        if (history != std::end(appZoneHistoryMap))
+        auto history = FindAppZoneHistoryEntries(processPath, deviceId);
+        if (history != std::end(appZoneHistory))
         {
-            const auto& perDesktopData = history->second;
-            for (const auto& data : perDesktopData)
+            const auto zoneSet = zoneSetIds.Find(zoneSetId);
+            for (const auto& entry : history->second)
             {
-                if (data.zoneSetUuid == zoneSetId && data.deviceId == deviceId)
+                if (entry.zoneSet == zoneSet)
                 {
-                    return data.zoneIndexSet;
+                    return entry.data.zoneIndexSet;
                 }
             }
         }
@@ -401,109 +479,104 @@ std::vector<size_t> FancyZonesData::GetAppLastZoneIndexSet(HWND window, const st
 bool FancyZonesData::RemoveAppLastZone(HWND window, const std::wstring_view& deviceId, const std::wstring_view& zoneSetId)
 {
     _TRACER_;
-    std::scoped_lock lock{ dataLock };
-    auto processPath = get_process_path(window);
-    if (!processPath.empty())
+    auto processPath = ProcessCacheInstance().GetProcessPath(window);
+    if (processPath.empty())
     {
-        auto history = appZoneHistoryMap.find(processPath);
-        if (history != std::end(appZoneHistoryMap))
+        return false;
+    }
+
+    {
+        std::scoped_lock lock{ dataLock };
+        auto history = FindAppZoneHistoryEntries(processPath, deviceId);
+        if (history == std::end(appZoneHistory))
+        {
+            return false;
+        }
+
+        auto& entries = history->second;
+        const auto zoneSet = zoneSetIds.Find(zoneSetId);
+        auto entry = std::find_if(std::begin(entries), std::end(entries), [zoneSet](const auto& item) { return item.zoneSet == zoneSet; });
+        if (entry == std::end(entries))
         {
-            auto& perDesktopData = history->second;
-            for (auto data = std::begin(perDesktopData); data != std::end(perDesktopData);)
+            return false;
+        }
+
+        auto& data = entry->data;
+        if (!IsAnotherWindowOfApplicationInstanceZoned(window, processPath, deviceId))
+        {
+            DWORD processId = 0;
+            GetWindowThreadProcessId(window, &processId);
+
+            data.processIdToHandleMap.erase(processId);
+            appZoneHistoryMapValid = false;
+        }
+
+        // if there is another instance of same application placed in the same zone don't erase history
+        auto& zoneRegistry = WindowZoneRegistryInstance();
+        const auto windowZones = zoneRegistry.GetZones(window);
+        for (auto placedWindow : data.processIdToHandleMap)
+        {
+            if (IsWindow(placedWindow.second) && (windowZones == zoneRegistry.GetZones(placedWindow.second)))
             {
-                if (data->deviceId == deviceId && data->zoneSetUuid == zoneSetId)
-                {
-                    if (!IsAnotherWindowOfApplicationInstanceZoned(window, deviceId))
-                    {
-                        DWORD processId = 0;
-                        GetWindowThreadProcessId(window, &processId);
-
-                        data->processIdToHandleMap.erase(processId);
-                    }
-
-                    // if there is another instance of same application placed in the same zone don't erase history
-                    size_t windowZoneStamp = reinterpret_cast<size_t>(::GetProp(window, ZonedWindowProperties::PropertyMultipleZoneID));
-                    for (auto placedWindow : data->processIdToHandleMap)
-                    {
-                        size_t placedWindowZoneStamp = reinterpret_cast<size_t>(::GetProp(placedWindow.second, ZonedWindowProperties::PropertyMultipleZoneID));
-                        if (IsWindow(placedWindow.second) && (windowZoneStamp == placedWindowZoneStamp))
-                        {
-                            return false;
-                        }
-                    }
-
-                    data = perDesktopData.erase(data);
-                    if (perDesktopData.empty())
-                    {
-                        appZoneHistoryMap.erase(processPath);
-                    }
-                    SaveAppZoneHistory();
-                    return true;
-                }
-                else
-                {
-                    ++data;
-                }
+                return false;
             }
         }
+
+        entries.erase(entry);
+        if (entries.empty())
+        {
+            appZoneHistory.erase(history);
+        }
+        appZoneHistoryMapValid = false;
     }
 
-    return false;
+    SaveAppZoneHistory();
+    return true;
 }
 
 bool FancyZonesData::SetAppLastZones(HWND window, const std::wstring& deviceId, const std::wstring& zoneSetId, const std::vector<size_t>& zoneIndexSet)
 {
     _TRACER_;
-    std::scoped_lock lock{ dataLock };
-
-    if (IsAnotherWindowOfApplicationInstanceZoned(window, deviceId))
-    {
-        return false;
-    }
-
-    auto processPath = get_process_path(window);
+    auto processPath = ProcessCacheInstance().GetProcessPath(window);
     if (processPath.empty())
     {
         return false;
     }
 
-    DWORD processId = 0;
-    GetWindowThreadProcessId(window, &processId);
-
-    auto history = appZoneHistoryMap.find(processPath);
-    if (history != std::end(appZoneHistoryMap))
     {
-        auto& perDesktopData = history->second;
-        for (auto& data : perDesktopData)
+        std::scoped_lock lock{ dataLock };
+
+        if (IsAnotherWindowOfApplicationInstanceZoned(window, processPath, deviceId))
         {
-            if (data.deviceId == deviceId)
-            {
-                // application already has history on this work area, update it with new window position
-                data.processIdToHandleMap[processId] = window;
-                data.zoneSetUuid = zoneSetId;
-                data.zoneIndexSet = zoneIndexSet;
-                SaveAppZoneHistory();
-                return true;
-            }
+            return false;
         }
-    }
 
-    std::unordered_map<DWORD, HWND> processIdToHandleMap{};
-    processIdToHandleMap[processId] = window;
-    FancyZonesDataTypes::AppZoneHistoryData data{ .processIdToHandleMap = processIdToHandleMap,
-                                                  .zoneSetUuid = zoneSetId,
-                                                  .deviceId = deviceId,
-                                                  .zoneIndexSet = zoneIndexSet };
+        DWORD processId = 0;
+        GetWindowThreadProcessId(window, &processId);
 
-    if (appZoneHistoryMap.contains(processPath))
-    {
-        // application already has history but on other desktop, add with new desktop info
-        appZoneHistoryMap[processPath].push_back(data);
-    }
-    else
-    {
-        // new application, create entry in app zone history map
-        appZoneHistoryMap[processPath] = std::vector<FancyZonesDataTypes::AppZoneHistoryData>{ data };
+        auto history = FindAppZoneHistoryEntries(processPath, deviceId);
+        if (history != std::end(appZoneHistory))
+        {
+            // application already has history on this work area, update it with new window position
+            auto& entry = history->second.front();
+            entry.data.processIdToHandleMap[processId] = window;
+            entry.data.zoneSetUuid = zoneSetId;
+            entry.data.zoneIndexSet = zoneIndexSet;
+            entry.zoneSet = zoneSetIds.Intern(zoneSetId);
+            appZoneHistoryMapValid = false;
+        }
+        else
+        {
+            // new application or history on another work area, add with new work area info
+            std::unordered_map<DWORD, HWND> processIdToHandleMap{};
+            processIdToHandleMap[processId] = window;
+            FancyZonesDataTypes::AppZoneHistoryData data{ .processIdToHandleMap = processIdToHandleMap,
+                                                          .zoneSetUuid = zoneSetId,
+                                                          .deviceId = deviceId,
+                                                          .zoneIndexSet = zoneIndexSet };
+
+            AddAppZoneHistoryEntry(appPathIds.Intern(processPath), std::move(data));
+        }
     }
 
     SaveAppZoneHistory();
@@ -513,18 +586,18 @@ bool FancyZonesData::SetAppLastZones(HWND window, const std::wstring& deviceId,
 void FancyZonesData::SetActiveZoneSet(const std::wstring& deviceId, const FancyZonesDataTypes::ZoneSetData& data)
 {
     std::scoped_lock lock{ dataLock };
-
-    auto deviceIt = deviceInfoMap.find(deviceId);
-    if (deviceIt == deviceInfoMap.end())
+    if (!GetZoneSettings()->deviceInfoMap.contains(deviceId))
     {
         return;
     }
 
+    auto settings = CopyZoneSettings();
+    auto deviceIt = settings->deviceInfoMap.find(deviceId);
     deviceIt->second.activeZoneSet = data;
 
     // If the zone set is custom, we need to copy its properties to the device
-    auto zonesetIt = customZoneSetsMap.find(data.uuid);
-    if (zonesetIt != customZoneSetsMap.end())
+    auto zonesetIt = settings->customZoneSetsMap.find(data.uuid);
+    if (zonesetIt != settings->customZoneSetsMap.end())
     {
         if (zonesetIt->second.type == FancyZonesDataTypes::CustomLayoutType::Grid)
         {
@@ -541,6 +614,8 @@ void FancyZonesData::SetActiveZoneSet(const std::wstring& deviceId, const FancyZ
             deviceIt->second.zoneCount = (int)layoutInfo.zones.size();
         }
     }
+
+    PublishZoneSettings(std::move(settings));
 }
 
 json::JsonObject FancyZonesData::GetPersistFancyZonesJSON()
@@ -556,12 +631,16 @@ void FancyZonesData::LoadFancyZonesData()
     }
     else
     {
-        json::JsonObject fancyZonesDataJSON = GetPersistFancyZonesJSON();
+        auto data = JSONHelpers::ReadPersistedData(zonesSettingsFileName, appZoneHistoryFileName);
+
+        auto settings = std::make_shared<ZoneSettings>();
+        settings->deviceInfoMap = std::move(data.deviceInfoMap);
+        settings->customZoneSetsMap = std::move(data.customZoneSetsMap);
+        settings->quickKeysMap = std::move(data.quickKeysMap);
 
-        appZoneHistoryMap = JSONHelpers::ParseAppZoneHistory(fancyZonesDataJSON);
-        deviceInfoMap = JSONHelpers::ParseDeviceInfos(fancyZonesDataJSON);
-        customZoneSetsMap = JSONHelpers::ParseCustomZoneSets(fancyZonesDataJSON);
-        quickKeysMap = JSONHelpers::ParseQuickKeys(fancyZonesDataJSON);
+        std::scoped_lock lock{ dataLock };
+        SetAppZoneHistory(data.appZoneHistoryMap);
+        PublishZoneSettings(std::move(settings));
     }
 }
 
@@ -574,15 +653,18 @@ void FancyZonesData::SaveAppZoneHistoryAndZoneSettings() const
 void FancyZonesData::SaveZoneSettings() const
 {
     _TRACER_;
-    std::scoped_lock lock{ dataLock };
-    JSONHelpers::SaveZoneSettings(zonesSettingsFileName, deviceInfoMap, customZoneSetsMap, quickKeysMap);
+    std::scoped_lock lock{ saveLock };
+    const auto settings = GetZoneSettings();
+    JSONHelpers::SaveZoneSettings(zonesSettingsFileName, settings->deviceInfoMap, settings->customZoneSetsMap, settings->quickKeysMap);
 }
 
 void FancyZonesData::SaveAppZoneHistory() const
 {
     _TRACER_;
-    std::scoped_lock lock{ dataLock };
-    JSONHelpers::SaveAppZoneHistory(appZoneHistoryFileName, appZoneHistoryMap);
+    std::scoped_lock lock{ saveLock };
+    // Only taking dataLock to get the map, it isn't held while writing the file
+    const auto history = GetAppZoneHistoryMap();
+    JSONHelpers::SaveAppZoneHistory(appZoneHistoryFileName, *history);
 }
 
 void FancyZonesData::SaveFancyZonesEditorParameters(bool spanZonesAcrossMonitors, const std::wstring& virtualDesktopId, const HMONITOR& targetMonitor, const std::vector<std::pair<HMONITOR, MONITORINFOEX>>& allMonitors) const
@@ -649,30 +731,88 @@ void FancyZonesData::SaveFancyZonesEditorParameters(bool spanZonesAcrossMonitors
     json::to_file(editorParametersFileName, JSONHelpers::EditorArgs::ToJson(argsJson));
 }
 
-void FancyZonesData::RemoveDesktopAppZoneHistory(const std::wstring& desktopId)
+void FancyZonesData::SetAppZoneHistory(const JSONHelpers::TAppZoneHistoryMap& history)
 {
-    for (auto it = std::begin(appZoneHistoryMap); it != std::end(appZoneHistoryMap);)
+    appZoneHistory.clear();
+    appZoneHistoryOrder = 0;
+    appPathIds.Clear();
+    deviceIds.Clear();
+    desktopIds.Clear();
+    zoneSetIds.Clear();
+
+    for (const auto& [path, perDesktopData] : history)
     {
-        auto& perDesktopData = it->second;
-        for (auto desktopIt = std::begin(perDesktopData); desktopIt != std::end(perDesktopData);)
+        const auto app = appPathIds.Intern(path);
+        for (const auto& data : perDesktopData)
         {
-            if (ExtractVirtualDesktopId(desktopIt->deviceId) == desktopId)
-            {
-                desktopIt = perDesktopData.erase(desktopIt);
-            }
-            else
-            {
-                ++desktopIt;
-            }
+            AddAppZoneHistoryEntry(app, data);
         }
+    }
 
-        if (perDesktopData.empty())
-        {
-            it = appZoneHistoryMap.erase(it);
-        }
-        else
-        {
-            ++it;
-        }
+    appZoneHistoryMapValid = false;
+}
+
+void FancyZonesData::AddAppZoneHistoryEntry(IdInterner::Handle app, FancyZonesDataTypes::AppZoneHistoryData data)
+{
+    AppZoneHistoryKey key{ .app = app, .device = deviceIds.Intern(data.deviceId) };
+    AppZoneHistoryEntry entry{ .zoneSet = zoneSetIds.Intern(data.zoneSetUuid),
+                               .desktop = desktopIds.Intern(ExtractVirtualDesktopId(data.deviceId)),
+                               .order = appZoneHistoryOrder++,
+                               .data = std::move(data) };
+
+    appZoneHistory[key].push_back(std::move(entry));
+    appZoneHistoryMapValid = false;
+}
+
+std::shared_ptr<const FancyZonesData::ZoneSettings> FancyZonesData::GetZoneSettings() const noexcept
+{
+    return zoneSettings.load(std::memory_order_acquire);
+}
+
+std::shared_ptr<FancyZonesData::ZoneSettings> FancyZonesData::CopyZoneSettings() const
+{
+    return std::make_shared<ZoneSettings>(*GetZoneSettings());
+}
+
+void FancyZonesData::PublishZoneSettings(std::shared_ptr<const ZoneSettings> settings) noexcept
+{
+    zoneSettings.store(std::move(settings), std::memory_order_release);
+}
+
+FancyZonesData::TAppZoneHistory::iterator FancyZonesData::FindAppZoneHistoryEntries(const std::wstring& processPath, const std::wstring_view& deviceId)
+{
+    const auto app = appPathIds.Find(processPath);
+    const auto device = deviceIds.Find(deviceId);
+    if (app == IdInterner::InvalidHandle || device == IdInterner::InvalidHandle)
+    {
+        return std::end(appZoneHistory);
+    }
+
+    return appZoneHistory.find(AppZoneHistoryKey{ .app = app, .device = device });
+}
+
+FancyZonesData::TAppZoneHistory::const_iterator FancyZonesData::FindAppZoneHistoryEntries(const std::wstring& processPath, const std::wstring_view& deviceId) const
+{
+    const auto app = appPathIds.Find(processPath);
+    const auto device = deviceIds.Find(deviceId);
+    if (app == IdInterner::InvalidHandle || device == IdInterner::InvalidHandle)
+    {
+        return std::end(appZoneHistory);
+    }
+
+    return appZoneHistory.find(AppZoneHistoryKey{ .app = app, .device = device });
+}
+
+void FancyZonesData::RemoveDesktopAppZoneHistory(const std::wstring& desktopId)
+{
+    const auto desktop = desktopIds.Find(desktopId);
+    if (desktop == IdInterner::InvalidHandle)
+    {
+        return;
+    }
+
+    if (std::erase_if(appZoneHistory, [desktop](const auto& item) { return item.second.front().desktop == desktop; }) > 0)
+    {
+        appZoneHistoryMapValid = false;
     }
 }
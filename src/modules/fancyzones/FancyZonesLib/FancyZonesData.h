@@ -1,9 +1,12 @@
 #pragma once
 
 #include "JsonHelpers.h"
+#include "IdInterner.h"
 
 #include <common/SettingsAPI/settings_helpers.h>
 #include <common/utils/json.h>
+#include <atomic>
+#include <memory>
 #include <mutex>
 
 #include <string>
@@ -39,6 +42,11 @@ namespace FancyZonesUnitTests
 }
 #endif
 
+// Devices, custom layouts and quick keys are read from immutable snapshots: readers don't take dataLock,
+// writers copy the current snapshot, change the copy and publish it. The maps returned by the getters
+// are frozen versions that stay valid as long as they are held.
+// App zone history changes with every snapped window, it's kept under dataLock.
+// Files are written outside of dataLock, readers don't wait for a save.
 class FancyZonesData
 {
 public:
@@ -48,17 +56,13 @@ public:
 
     std::optional<FancyZonesDataTypes::CustomZoneSetData> FindCustomZoneSet(const std::wstring& guid) const;
 
-    const JSONHelpers::TDeviceInfoMap& GetDeviceInfoMap() const;
+    std::shared_ptr<const JSONHelpers::TDeviceInfoMap> GetDeviceInfoMap() const;
 
-    const JSONHelpers::TCustomZoneSetsMap& GetCustomZoneSetsMap() const;
+    std::shared_ptr<const JSONHelpers::TCustomZoneSetsMap> GetCustomZoneSetsMap() const;
 
-    const std::unordered_map<std::wstring, std::vector<FancyZonesDataTypes::AppZoneHistoryData>>& GetAppZoneHistoryMap() const;
+    std::shared_ptr<const JSONHelpers::TAppZoneHistoryMap> GetAppZoneHistoryMap() const;
 
-    inline const JSONHelpers::TLayoutQuickKeysMap& GetLayoutQuickKeys() const
-    {
-        std::scoped_lock lock{ dataLock };
-        return quickKeysMap;
-    }
+    std::shared_ptr<const JSONHelpers::TLayoutQuickKeysMap> GetLayoutQuickKeys() const;
 
     inline const std::wstring& GetZonesSettingsFileName() const 
     {
@@ -102,25 +106,38 @@ private:
 
     inline void SetDeviceInfo(const std::wstring& deviceId, FancyZonesDataTypes::DeviceInfoData data)
     {
-        deviceInfoMap[deviceId] = data;
+        std::scoped_lock lock{ dataLock };
+        auto settings = CopyZoneSettings();
+        settings->deviceInfoMap[deviceId] = data;
+        PublishZoneSettings(std::move(settings));
     }
 
     inline void SetCustomZonesets(const std::wstring& uuid, FancyZonesDataTypes::CustomZoneSetData data)
     {
-        customZoneSetsMap[uuid] = data;
+        std::scoped_lock lock{ dataLock };
+        auto settings = CopyZoneSettings();
+        settings->customZoneSetsMap[uuid] = data;
+        PublishZoneSettings(std::move(settings));
     }
 
     inline bool ParseDeviceInfos(const json::JsonObject& fancyZonesDataJSON)
     {
-        deviceInfoMap = JSONHelpers::ParseDeviceInfos(fancyZonesDataJSON);
-        return !deviceInfoMap.empty();
+        std::scoped_lock lock{ dataLock };
+        auto settings = CopyZoneSettings();
+        settings->deviceInfoMap = JSONHelpers::ParseDeviceInfos(fancyZonesDataJSON);
+        const bool parsed = !settings->deviceInfoMap.empty();
+        PublishZoneSettings(std::move(settings));
+        return parsed;
     }
 
     inline void clear_data()
     {
-        appZoneHistoryMap.clear();
-        deviceInfoMap.clear();
-        customZoneSetsMap.clear();
+        std::scoped_lock lock{ dataLock };
+        SetAppZoneHistory({});
+        auto settings = CopyZoneSettings();
+        settings->deviceInfoMap.clear();
+        settings->customZoneSetsMap.clear();
+        PublishZoneSettings(std::move(settings));
     }
 
     inline void SetSettingsModulePath(std::wstring_view moduleName)
@@ -130,23 +147,82 @@ private:
         appZoneHistoryFileName = result + L"\\" + std::wstring(L"app-zone-history.json");
     }
 #endif
+    // App zone history is keyed on interned ids. Each app has at most one entry per work area,
+    // the layout the entry was recorded for is stored with it.
+    struct AppZoneHistoryKey
+    {
+        IdInterner::Handle app;
+        IdInterner::Handle device;
+
+        bool operator==(const AppZoneHistoryKey&) const = default;
+    };
+
+    struct AppZoneHistoryKeyHash
+    {
+        size_t operator()(const AppZoneHistoryKey& key) const noexcept
+        {
+            return std::hash<uint64_t>{}((static_cast<uint64_t>(key.app) << 32) | key.device);
+        }
+    };
+
+    struct AppZoneHistoryEntry
+    {
+        IdInterner::Handle zoneSet;
+        IdInterner::Handle desktop;
+        // Keeps the order in which entries were added to the app's history, used when serializing
+        uint64_t order;
+        FancyZonesDataTypes::AppZoneHistoryData data;
+    };
+
+    // Entries of an app on a work area, in the order they were added. There is usually a single one, more come from
+    // duplicates in the history file or from moving history onto a work area that already has some. All of them are
+    // saved back and looked up in order, as when the history was a list per app.
+    using TAppZoneHistory = std::unordered_map<AppZoneHistoryKey, std::vector<AppZoneHistoryEntry>, AppZoneHistoryKeyHash>;
+
+    struct ZoneSettings
+    {
+        // Maps device unique ID to device data
+        JSONHelpers::TDeviceInfoMap deviceInfoMap;
+        // Maps custom zoneset UUID to it's data
+        JSONHelpers::TCustomZoneSetsMap customZoneSetsMap;
+        // Maps zoneset UUID with quick access keys
+        JSONHelpers::TLayoutQuickKeysMap quickKeysMap;
+    };
+
+    std::shared_ptr<const ZoneSettings> GetZoneSettings() const noexcept;
+    // Copy of the current snapshot to change and publish, called with dataLock held
+    std::shared_ptr<ZoneSettings> CopyZoneSettings() const;
+    void PublishZoneSettings(std::shared_ptr<const ZoneSettings> settings) noexcept;
+
+    void SetAppZoneHistory(const JSONHelpers::TAppZoneHistoryMap& history);
+    void AddAppZoneHistoryEntry(IdInterner::Handle app, FancyZonesDataTypes::AppZoneHistoryData data);
+    TAppZoneHistory::iterator FindAppZoneHistoryEntries(const std::wstring& processPath, const std::wstring_view& deviceId);
+    TAppZoneHistory::const_iterator FindAppZoneHistoryEntries(const std::wstring& processPath, const std::wstring_view& deviceId) const;
     void RemoveDesktopAppZoneHistory(const std::wstring& desktopId);
+    bool IsAnotherWindowOfApplicationInstanceZoned(HWND window, const std::wstring& processPath, const std::wstring_view& deviceId) const;
+
+    TAppZoneHistory appZoneHistory{};
+    uint64_t appZoneHistoryOrder = 0;
+    IdInterner appPathIds;
+    IdInterner deviceIds;
+    IdInterner desktopIds;
+    IdInterner zoneSetIds;
+    // Maps app path to app's zone history data, built from appZoneHistory when it's read or saved.
+    // A new map is built after a change, the ones handed out aren't modified.
+    mutable std::shared_ptr<const JSONHelpers::TAppZoneHistoryMap> appZoneHistoryMap;
+    mutable bool appZoneHistoryMapValid = false;
 
-    // Maps app path to app's zone history data
-    std::unordered_map<std::wstring, std::vector<FancyZonesDataTypes::AppZoneHistoryData>> appZoneHistoryMap{};
-    // Maps device unique ID to device data
-    JSONHelpers::TDeviceInfoMap deviceInfoMap{};
-    // Maps custom zoneset UUID to it's data
-    JSONHelpers::TCustomZoneSetsMap customZoneSetsMap{};
-    // Maps zoneset UUID with quick access keys
-    JSONHelpers::TLayoutQuickKeysMap quickKeysMap{};
+    std::atomic<std::shared_ptr<const ZoneSettings>> zoneSettings{ std::make_shared<const ZoneSettings>() };
 
     std::wstring settingsFileName;
     std::wstring zonesSettingsFileName;
     std::wstring appZoneHistoryFileName;
     std::wstring editorParametersFileName;
 
+    // Serializes writers, and reads and writes of the app zone history
     mutable std::recursive_mutex dataLock;
+    // Serializes file writes, never taken while holding dataLock
+    mutable std::mutex saveLock;
 };
 
 FancyZonesData& FancyZonesDataInstance();
@@ -0,0 +1,33 @@
+#include "pch.h"
+#include "IdInterner.h"
+
+IdInterner::Handle IdInterner::Intern(std::wstring_view id)
+{
+    if (auto it = m_handles.find(id); it != m_handles.end())
+    {
+        return it->second;
+    }
+
+    m_ids.emplace_back(id);
+    Handle handle = static_cast<Handle>(m_ids.size());
+    m_handles.emplace(m_ids.back(), handle);
+    return handle;
+}
+
+IdInterner::Handle IdInterner::Find(std::wstring_view id) const noexcept
+{
+    auto it = m_handles.find(id);
+    return it != m_handles.end() ? it->second : InvalidHandle;
+}
+
+const std::wstring& IdInterner::Resolve(Handle handle) const noexcept
+{
+    static const std::wstring empty;
+    return handle != InvalidHandle && handle <= m_ids.size() ? m_ids[handle - 1] : empty;
+}
+
+void IdInterner::Clear() noexcept
+{
+    m_handles.clear();
+    m_ids.clear();
+}
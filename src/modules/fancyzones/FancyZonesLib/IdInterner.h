@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Maps identifiers (device ids, virtual desktop GUIDs, layout UUIDs, app paths) to compact integer handles,
+// so that lookups keyed on them hash and compare integers instead of long strings.
+// Handles are never reused, an interned id keeps its handle until the table is cleared.
+class IdInterner
+{
+public:
+    using Handle = uint32_t;
+
+    // Never returned for an interned id
+    static constexpr Handle InvalidHandle = 0;
+
+    Handle Intern(std::wstring_view id);
+
+    // Handle of an already interned id, InvalidHandle otherwise. Doesn't grow the table.
+    Handle Find(std::wstring_view id) const noexcept;
+
+    const std::wstring& Resolve(Handle handle) const noexcept;
+
+    size_t Size() const noexcept { return m_ids.size(); }
+    void Clear() noexcept;
+
+private:
+    struct Hash
+    {
+        using is_transparent = void;
+        size_t operator()(std::wstring_view id) const noexcept { return std::hash<std::wstring_view>{}(id); }
+    };
+
+    std::unordered_map<std::wstring, Handle, Hash, std::equal_to<>> m_handles;
+    // Indexed by handle - 1
+    std::vector<std::wstring> m_ids;
+};
@@ -0,0 +1,983 @@
+#pragma once
+
+#include <charconv>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <system_error>
+
+// Streaming JSON reader and writer for the FancyZones files. Doesn't depend on Windows or WinRT types:
+// values are read straight into the caller's data and written straight from it, no document is built.
+//
+// The writer produces the text json::to_file writes for a json::JsonObject: no whitespace, members in the
+// order they are written, only '"', '\' and control characters escaped, numbers formatted like JavaScript
+// does, UTF-8 output. Files written by either one are byte for byte the same.
+namespace JsonCodec
+{
+    enum class ValueType
+    {
+        None,
+        Null,
+        Bool,
+        Number,
+        String,
+        Array,
+        Object
+    };
+
+    namespace Details
+    {
+        constexpr char HexDigits[] = "0123456789abcdef";
+
+        inline void AppendUtf8(std::string& out, char32_t codePoint)
+        {
+            if (codePoint < 0x80)
+            {
+                out.push_back(static_cast<char>(codePoint));
+            }
+            else if (codePoint < 0x800)
+            {
+                out.push_back(static_cast<char>(0xC0 | (codePoint >> 6)));
+                out.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+            }
+            else if (codePoint < 0x10000)
+            {
+                out.push_back(static_cast<char>(0xE0 | (codePoint >> 12)));
+                out.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+                out.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+            }
+            else
+            {
+                out.push_back(static_cast<char>(0xF0 | (codePoint >> 18)));
+                out.push_back(static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F)));
+                out.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+                out.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+            }
+        }
+
+        inline void AppendWide(std::wstring& out, char32_t codePoint)
+        {
+            if constexpr (sizeof(wchar_t) == 2)
+            {
+                if (codePoint >= 0x10000)
+                {
+                    codePoint -= 0x10000;
+                    out.push_back(static_cast<wchar_t>(0xD800 + (codePoint >> 10)));
+                    out.push_back(static_cast<wchar_t>(0xDC00 + (codePoint & 0x3FF)));
+                    return;
+                }
+            }
+            out.push_back(static_cast<wchar_t>(codePoint));
+        }
+
+        constexpr bool IsHighSurrogate(char32_t c) noexcept { return c >= 0xD800 && c <= 0xDBFF; }
+        constexpr bool IsLowSurrogate(char32_t c) noexcept { return c >= 0xDC00 && c <= 0xDFFF; }
+        constexpr char32_t ReplacementCharacter = 0xFFFD;
+    }
+
+    class Writer
+    {
+    public:
+        void Reserve(size_t size) { m_text.reserve(size); }
+
+        void BeginObject()
+        {
+            Separate();
+            m_text.push_back('{');
+            m_needComma = false;
+        }
+
+        void EndObject()
+        {
+            m_text.push_back('}');
+            m_needComma = true;
+        }
+
+        void BeginArray()
+        {
+            Separate();
+            m_text.push_back('[');
+            m_needComma = false;
+        }
+
+        void EndArray()
+        {
+            m_text.push_back(']');
+            m_needComma = true;
+        }
+
+        // Valid UTF-8
+        void Key(std::string_view key)
+        {
+            Separate();
+            AppendQuoted(key);
+            m_text.push_back(':');
+            m_needComma = false;
+        }
+
+        void String(std::wstring_view value)
+        {
+            Separate();
+            m_text.push_back('"');
+            for (size_t i = 0; i < value.size(); i++)
+            {
+                char32_t c = static_cast<char32_t>(value[i]);
+                if (c < 0x80)
+                {
+                    AppendAscii(static_cast<char>(c));
+                    continue;
+                }
+
+                if constexpr (sizeof(wchar_t) == 2)
+                {
+                    if (Details::IsHighSurrogate(c) && i + 1 < value.size() && Details::IsLowSurrogate(value[i + 1]))
+                    {
+                        c = 0x10000 + ((c - 0xD800) << 10) + (value[++i] - 0xDC00);
+                    }
+                }
+
+                // A lone surrogate can't be converted to UTF-8
+                Details::AppendUtf8(m_text, Details::IsHighSurrogate(c) || Details::IsLowSurrogate(c) ? Details::ReplacementCharacter : c);
+            }
+            m_text.push_back('"');
+        }
+
+        // Valid UTF-8
+        void Utf8String(std::string_view value)
+        {
+            Separate();
+            AppendQuoted(value);
+        }
+
+        void Integer(int64_t value)
+        {
+            Separate();
+            char buffer[24];
+            const auto result = std::to_chars(std::begin(buffer), std::end(buffer), value);
+            m_text.append(buffer, result.ptr);
+        }
+
+        // Formatted like JavaScript's Number.prototype.toString: shortest digits that read back as the same
+        // value, in positional notation from 1e-7 to 1e21 and in exponential notation outside
+        void Number(double value)
+        {
+            Separate();
+            if (value == 0 || value != value || value - value != 0)
+            {
+                // Zero, and values JSON can't represent
+                m_text.append(value == 0 ? "0" : "null");
+                return;
+            }
+
+            char buffer[32];
+            const auto result = std::to_chars(std::begin(buffer), std::end(buffer), value, std::chars_format::scientific);
+            std::string_view scientific(buffer, result.ptr - buffer);
+
+            if (scientific.front() == '-')
+            {
+                m_text.push_back('-');
+                scientific.remove_prefix(1);
+            }
+
+            const size_t exponentPos = scientific.find('e');
+            std::string digits;
+            for (char c : scientific.substr(0, exponentPos))
+            {
+                if (c != '.')
+                {
+                    digits.push_back(c);
+                }
+            }
+
+            int exponent = 0;
+            const auto exponentText = scientific.substr(exponentPos + 1);
+            std::from_chars(exponentText.data() + (exponentText.front() == '+' ? 1 : 0), exponentText.data() + exponentText.size(), exponent);
+
+            // Value is 0.digits * 10^n
+            const int k = static_cast<int>(digits.size());
+            const int n = exponent + 1;
+            if (k <= n && n <= 21)
+            {
+                m_text.append(digits);
+                m_text.append(n - k, '0');
+            }
+            else if (0 < n && n <= 21)
+            {
+                m_text.append(digits, 0, n);
+                m_text.push_back('.');
+                m_text.append(digits, n);
+            }
+            else if (-6 < n && n <= 0)
+            {
+                m_text.append("0.");
+                m_text.append(-n, '0');
+                m_text.append(digits);
+            }
+            else
+            {
+                m_text.push_back(digits[0]);
+                if (k > 1)
+                {
+                    m_text.push_back('.');
+                    m_text.append(digits, 1);
+                }
+                m_text.push_back('e');
+                m_text.push_back(n - 1 < 0 ? '-' : '+');
+                m_text.append(std::to_string(n - 1 < 0 ? 1 - n : n - 1));
+            }
+        }
+
+        void Bool(bool value)
+        {
+            Separate();
+            m_text.append(value ? "true" : "false");
+        }
+
+        void Null()
+        {
+            Separate();
+            m_text.append("null");
+        }
+
+        // A value that is already serialized the way the writer would
+        void Raw(std::string_view json)
+        {
+            Separate();
+            m_text.append(json);
+        }
+
+        const std::string& Text() const noexcept { return m_text; }
+        std::string Take() noexcept { return std::move(m_text); }
+
+    private:
+        void Separate()
+        {
+            if (m_needComma)
+            {
+                m_text.push_back(',');
+            }
+            m_needComma = true;
+        }
+
+        void AppendQuoted(std::string_view utf8)
+        {
+            m_text.push_back('"');
+            for (char c : utf8)
+            {
+                if (static_cast<unsigned char>(c) < 0x80)
+                {
+                    AppendAscii(c);
+                }
+                else
+                {
+                    m_text.push_back(c);
+                }
+            }
+            m_text.push_back('"');
+        }
+
+        void AppendAscii(char c)
+        {
+            switch (c)
+            {
+            case '"':
+                m_text.append("\\\"");
+                break;
+            case '\\':
+                m_text.append("\\\\");
+                break;
+            case '\b':
+                m_text.append("\\b");
+                break;
+            case '\f':
+                m_text.append("\\f");
+                break;
+            case '\n':
+                m_text.append("\\n");
+                break;
+            case '\r':
+                m_text.append("\\r");
+                break;
+            case '\t':
+                m_text.append("\\t");
+                break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20)
+                {
+                    m_text.append("\\u00");
+                    m_text.push_back(Details::HexDigits[c >> 4]);
+                    m_text.push_back(Details::HexDigits[c & 0xF]);
+                }
+                else
+                {
+                    m_text.push_back(c);
+                }
+            }
+        }
+
+        std::string m_text;
+        bool m_needComma = false;
+    };
+
+    // Pull reader over UTF-8 text. A syntax error is sticky: Ok() turns false and every following call fails,
+    // callers check Ok() (or End()) once they are done to know whether what they read can be used.
+    // Reading a value as the wrong type isn't an error, the value is skipped and false is returned.
+    // Skipping decodes the strings it goes over, so everything that can skip may throw std::bad_alloc.
+    class Reader
+    {
+    public:
+        explicit Reader(std::string_view text) noexcept :
+            m_text(text)
+        {
+            if (m_text.starts_with("\xEF\xBB\xBF"))
+            {
+                m_pos = 3;
+            }
+        }
+
+        bool Ok() const noexcept { return !m_failed; }
+
+        // True if the whole text is a single value that was read without errors
+        bool End() noexcept
+        {
+            SkipWhitespace();
+            return !m_failed && m_depth == 0 && m_pos == m_text.size();
+        }
+
+        // Type of the next value, None at the end of an object or array, at the end of the text or after an error
+        ValueType Peek() noexcept
+        {
+            SkipWhitespace();
+            if (m_failed || m_pos == m_text.size())
+            {
+                return ValueType::None;
+            }
+
+            switch (m_text[m_pos])
+            {
+            case '{':
+                return ValueType::Object;
+            case '[':
+                return ValueType::Array;
+            case '"':
+                return ValueType::String;
+            case 't':
+            case 'f':
+                return ValueType::Bool;
+            case 'n':
+                return ValueType::Null;
+            case '-':
+                return ValueType::Number;
+            default:
+                return m_text[m_pos] >= '0' && m_text[m_pos] <= '9' ? ValueType::Number : ValueType::None;
+            }
+        }
+
+        // Enters the next value if it's an object, otherwise it's skipped and false is returned
+        bool BeginObject()
+        {
+            return Enter(ValueType::Object);
+        }
+
+        // Moves to the next member of the object entered last, false after its end.
+        // The member's value has to be read or skipped before the next call, the key is valid until then.
+        bool NextKey(std::string_view& key)
+        {
+            if (!NextItem('}'))
+            {
+                return false;
+            }
+
+            if (m_pos == m_text.size() || m_text[m_pos] != '"')
+            {
+                return Fail();
+            }
+
+            // Keys are compared as they are in the text unless they have escapes
+            const size_t start = m_pos + 1;
+            size_t end = start;
+            while (end < m_text.size() && m_text[end] != '"' && m_text[end] != '\\' && static_cast<unsigned char>(m_text[end]) >= 0x20)
+            {
+                end++;
+            }
+
+            if (end < m_text.size() && m_text[end] == '"')
+            {
+                key = m_text.substr(start, end - start);
+                m_pos = end + 1;
+            }
+            else
+            {
+                m_key.clear();
+                if (!ParseString(m_key))
+                {
+                    return false;
+                }
+                key = m_key;
+            }
+
+            SkipWhitespace();
+            if (m_pos == m_text.size() || m_text[m_pos] != ':')
+            {
+                return Fail();
+            }
+            m_pos++;
+            return true;
+        }
+
+        // Enters the next value if it's an array, otherwise it's skipped and false is returned
+        bool BeginArray()
+        {
+            return Enter(ValueType::Array);
+        }
+
+        // Moves to the next element of the array entered last, false after its end.
+        // The element has to be read or skipped before the next call.
+        bool NextElement() noexcept
+        {
+            return NextItem(']');
+        }
+
+        bool Read(std::wstring& value)
+        {
+            if (Peek() != ValueType::String)
+            {
+                return SkipMismatch();
+            }
+
+            value.clear();
+            m_pos++;
+            while (m_pos < m_text.size())
+            {
+                const unsigned char c = m_text[m_pos];
+                if (c == '"')
+                {
+                    m_pos++;
+                    return true;
+                }
+                else if (c == '\\')
+                {
+                    char32_t codePoint;
+                    if (!ParseEscape(codePoint))
+                    {
+                        return false;
+                    }
+                    Details::AppendWide(value, codePoint);
+                }
+                else if (c < 0x20)
+                {
+                    return Fail();
+                }
+                else if (c < 0x80)
+                {
+                    value.push_back(static_cast<wchar_t>(c));
+                    m_pos++;
+                }
+                else
+                {
+                    Details::AppendWide(value, DecodeUtf8());
+                }
+            }
+
+            return Fail();
+        }
+
+        bool Read(double& value)
+        {
+            if (Peek() != ValueType::Number)
+            {
+                return SkipMismatch();
+            }
+
+            return ParseNumber(value);
+        }
+
+        bool Read(bool& value)
+        {
+            if (Peek() != ValueType::Bool)
+            {
+                return SkipMismatch();
+            }
+
+            value = m_text[m_pos] == 't';
+            return ParseLiteral(value ? "true" : "false");
+        }
+
+        bool Skip()
+        {
+            return Copy(nullptr);
+        }
+
+        // Skips the next value and returns its text, it can be read later with another Reader
+        std::optional<std::string_view> Capture()
+        {
+            SkipWhitespace();
+            const size_t start = m_pos;
+            if (!Skip())
+            {
+                return std::nullopt;
+            }
+            return m_text.substr(start, m_pos - start);
+        }
+
+        // Writes the next value without whitespace, strings and numbers are written the way the writer writes them
+        bool Copy(Writer& writer)
+        {
+            return Copy(&writer);
+        }
+
+    private:
+        static constexpr size_t MaxDepth = 512;
+
+        bool Fail() noexcept
+        {
+            m_failed = true;
+            m_pos = m_text.size();
+            return false;
+        }
+
+        void SkipWhitespace() noexcept
+        {
+            while (m_pos < m_text.size())
+            {
+                const char c = m_text[m_pos];
+                if (c != ' ' && c != '\t' && c != '\n' && c != '\r')
+                {
+                    break;
+                }
+                m_pos++;
+            }
+        }
+
+        bool SkipMismatch()
+        {
+            Skip();
+            return false;
+        }
+
+        bool Enter(ValueType type)
+        {
+            if (Peek() != type)
+            {
+                SkipMismatch();
+                return false;
+            }
+
+            if (++m_depth > MaxDepth)
+            {
+                return Fail();
+            }
+
+            m_pos++;
+            m_first = true;
+            return true;
+        }
+
+        bool NextItem(char close) noexcept
+        {
+            SkipWhitespace();
+            if (m_failed || m_pos == m_text.size())
+            {
+                return Fail();
+            }
+
+            if (m_text[m_pos] == close)
+            {
+                m_pos++;
+                m_depth--;
+                // The closed value was an item of the enclosing object or array
+                m_first = false;
+                return false;
+            }
+
+            if (!m_first)
+            {
+                if (m_text[m_pos] != ',')
+                {
+                    return Fail();
+                }
+                m_pos++;
+                SkipWhitespace();
+            }
+
+            m_first = false;
+            return true;
+        }
+
+        bool ParseLiteral(std::string_view literal) noexcept
+        {
+            if (m_text.substr(m_pos, literal.size()) != literal)
+            {
+                return Fail();
+            }
+            m_pos += literal.size();
+            return true;
+        }
+
+        bool ParseNumber(double& value) noexcept
+        {
+            const size_t start = m_pos;
+            auto digits = [this] {
+                const size_t from = m_pos;
+                while (m_pos < m_text.size() && m_text[m_pos] >= '0' && m_text[m_pos] <= '9')
+                {
+                    m_pos++;
+                }
+                return m_pos - from;
+            };
+
+            if (m_text[m_pos] == '-')
+            {
+                m_pos++;
+            }
+
+            if (m_pos < m_text.size() && m_text[m_pos] == '0')
+            {
+                m_pos++;
+            }
+            else if (digits() == 0)
+            {
+                return Fail();
+            }
+
+            if (m_pos < m_text.size() && m_text[m_pos] == '.')
+            {
+                m_pos++;
+                if (digits() == 0)
+                {
+                    return Fail();
+                }
+            }
+
+            if (m_pos < m_text.size() && (m_text[m_pos] == 'e' || m_text[m_pos] == 'E'))
+            {
+                m_pos++;
+                if (m_pos < m_text.size() && (m_text[m_pos] == '+' || m_text[m_pos] == '-'))
+                {
+                    m_pos++;
+                }
+                if (digits() == 0)
+                {
+                    return Fail();
+                }
+            }
+
+            const auto result = std::from_chars(m_text.data() + start, m_text.data() + m_pos, value);
+            if (result.ec != std::errc{})
+            {
+                return Fail();
+            }
+            return true;
+        }
+
+        char32_t DecodeUtf8() noexcept
+        {
+            const unsigned char lead = m_text[m_pos++];
+            size_t length;
+            char32_t codePoint;
+            if (lead >= 0xC2 && lead <= 0xDF)
+            {
+                length = 1;
+                codePoint = lead & 0x1F;
+            }
+            else if (lead >= 0xE0 && lead <= 0xEF)
+            {
+                length = 2;
+                codePoint = lead & 0x0F;
+            }
+            else if (lead >= 0xF0 && lead <= 0xF4)
+            {
+                length = 3;
+                codePoint = lead & 0x07;
+            }
+            else
+            {
+                return Details::ReplacementCharacter;
+            }
+
+            for (size_t i = 0; i < length; i++)
+            {
+                if (m_pos == m_text.size() || (static_cast<unsigned char>(m_text[m_pos]) & 0xC0) != 0x80)
+                {
+                    return Details::ReplacementCharacter;
+                }
+                codePoint = (codePoint << 6) | (m_text[m_pos++] & 0x3F);
+            }
+
+            // Overlong forms, surrogates and values above U+10FFFF
+            constexpr char32_t minimum[] = { 0, 0x80, 0x800, 0x10000 };
+            if (codePoint < minimum[length] || codePoint > 0x10FFFF || Details::IsHighSurrogate(codePoint) || Details::IsLowSurrogate(codePoint))
+            {
+                return Details::ReplacementCharacter;
+            }
+            return codePoint;
+        }
+
+        bool ParseHex4(char32_t& value) noexcept
+        {
+            if (m_text.size() - m_pos < 4)
+            {
+                return Fail();
+            }
+
+            value = 0;
+            for (size_t i = 0; i < 4; i++)
+            {
+                const char c = m_text[m_pos++];
+                value <<= 4;
+                if (c >= '0' && c <= '9')
+                {
+                    value |= c - '0';
+                }
+                else if (c >= 'a' && c <= 'f')
+                {
+                    value |= c - 'a' + 10;
+                }
+                else if (c >= 'A' && c <= 'F')
+                {
+                    value |= c - 'A' + 10;
+                }
+                else
+                {
+                    return Fail();
+                }
+            }
+            return true;
+        }
+
+        // At a backslash in a string. Lone surrogates are kept as they are, like the strings WinRT parses.
+        bool ParseEscape(char32_t& codePoint) noexcept
+        {
+            m_pos++;
+            if (m_pos == m_text.size())
+            {
+                return Fail();
+            }
+
+            switch (m_text[m_pos++])
+            {
+            case '"':
+                codePoint = '"';
+                return true;
+            case '\\':
+                codePoint = '\\';
+                return true;
+            case '/':
+                codePoint = '/';
+                return true;
+            case 'b':
+                codePoint = '\b';
+                return true;
+            case 'f':
+                codePoint = '\f';
+                return true;
+            case 'n':
+                codePoint = '\n';
+                return true;
+            case 'r':
+                codePoint = '\r';
+                return true;
+            case 't':
+                codePoint = '\t';
+                return true;
+            case 'u':
+                if (!ParseHex4(codePoint))
+                {
+                    return false;
+                }
+
+                if (Details::IsHighSurrogate(codePoint) && m_text.substr(m_pos, 2) == "\\u")
+                {
+                    const size_t pos = m_pos;
+                    m_pos += 2;
+                    char32_t low;
+                    if (!ParseHex4(low))
+                    {
+                        return false;
+                    }
+
+                    if (Details::IsLowSurrogate(low))
+                    {
+                        codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+                    }
+                    else
+                    {
+                        m_pos = pos;
+                    }
+                }
+                return true;
+            default:
+                return Fail();
+            }
+        }
+
+        // String as UTF-8, lone surrogates are replaced
+        bool ParseString(std::string& value)
+        {
+            m_pos++;
+            while (m_pos < m_text.size())
+            {
+                const unsigned char c = m_text[m_pos];
+                if (c == '"')
+                {
+                    m_pos++;
+                    return true;
+                }
+                else if (c == '\\')
+                {
+                    char32_t codePoint;
+                    if (!ParseEscape(codePoint))
+                    {
+                        return false;
+                    }
+                    Details::AppendUtf8(value, Details::IsHighSurrogate(codePoint) || Details::IsLowSurrogate(codePoint) ? Details::ReplacementCharacter : codePoint);
+                }
+                else if (c < 0x20)
+                {
+                    return Fail();
+                }
+                else if (c < 0x80)
+                {
+                    value.push_back(static_cast<char>(c));
+                    m_pos++;
+                }
+                else
+                {
+                    Details::AppendUtf8(value, DecodeUtf8());
+                }
+            }
+
+            return Fail();
+        }
+
+        // Skips the next value, or copies it to the writer
+        bool Copy(Writer* writer)
+        {
+            switch (Peek())
+            {
+            case ValueType::Object:
+            {
+                BeginObject();
+                if (writer)
+                {
+                    writer->BeginObject();
+                }
+
+                std::string_view key;
+                while (NextKey(key))
+                {
+                    if (writer)
+                    {
+                        writer->Key(key);
+                    }
+
+                    if (!Copy(writer))
+                    {
+                        return false;
+                    }
+                }
+
+                if (writer)
+                {
+                    writer->EndObject();
+                }
+                return Ok();
+            }
+            case ValueType::Array:
+                BeginArray();
+                if (writer)
+                {
+                    writer->BeginArray();
+                }
+
+                while (NextElement())
+                {
+                    if (!Copy(writer))
+                    {
+                        return false;
+                    }
+                }
+
+                if (writer)
+                {
+                    writer->EndArray();
+                }
+                return Ok();
+            case ValueType::String:
+            {
+                m_string.clear();
+                if (!ParseString(m_string))
+                {
+                    return false;
+                }
+                if (writer)
+                {
+                    writer->Utf8String(m_string);
+                }
+                return true;
+            }
+            case ValueType::Number:
+            {
+                double value;
+                if (!ParseNumber(value))
+                {
+                    return false;
+                }
+                if (writer)
+                {
+                    writer->Number(value);
+                }
+                return true;
+            }
+            case ValueType::Bool:
+            {
+                const bool value = m_text[m_pos] == 't';
+                if (!ParseLiteral(value ? "true" : "false"))
+                {
+                    return false;
+                }
+                if (writer)
+                {
+                    writer->Bool(value);
+                }
+                return true;
+            }
+            case ValueType::Null:
+                if (!ParseLiteral("null"))
+                {
+                    return false;
+                }
+                if (writer)
+                {
+                    writer->Null();
+                }
+                return true;
+            default:
+                return Fail();
+            }
+        }
+
+        std::string_view m_text;
+        size_t m_pos = 0;
+        size_t m_depth = 0;
+        bool m_first = false;
+        bool m_failed = false;
+        // Keys with escapes and copied strings are decoded here
+        std::string m_key;
+        std::string m_string;
+    };
+
+    // Same value without whitespace, written the way the writer writes it. Empty if the text isn't valid JSON.
+    inline std::optional<std::string> Minify(std::string_view text)
+    {
+        Reader reader(text);
+        Writer writer;
+        writer.Reserve(text.size());
+        if (!reader.Copy(writer) || !reader.End())
+        {
+            return std::nullopt;
+        }
+        return writer.Take();
+    }
+}
@@ -3,12 +3,14 @@
 #include "JsonHelpers.h"
 #include "FancyZonesData.h"
 #include "FancyZonesDataTypes.h"
+#include "JsonCodec.h"
 #include "trace.h"
 #include "util.h"
 
 #include <common/logger/logger.h>
 
 #include <filesystem>
+#include <fstream>
 #include <optional>
 #include <utility>
 #include <vector>
@@ -67,445 +69,1135 @@ namespace NonLocalizable
     const wchar_t ProcessId[] = L"process-id";
     const wchar_t SpanZonesAcrossMonitors[] = L"span-zones-across-monitors";
     const wchar_t Monitors[] = L"monitors";
+
+    // Keys as the streaming codec reads and writes them
+    namespace Utf8
+    {
+        const char ActiveZoneSetStr[] = "active-zoneset";
+        const char AppPathStr[] = "app-path";
+        const char AppZoneHistoryStr[] = "app-zone-history";
+        const char CanvasStr[] = "canvas";
+        const char CellChildMapStr[] = "cell-child-map";
+        const char ColumnsPercentageStr[] = "columns-percentage";
+        const char ColumnsStr[] = "columns";
+        const char CustomZoneSetsStr[] = "custom-zone-sets";
+        const char DeviceIdStr[] = "device-id";
+        const char DevicesStr[] = "devices";
+        const char EditorShowSpacingStr[] = "editor-show-spacing";
+        const char EditorSpacingStr[] = "editor-spacing";
+        const char EditorZoneCountStr[] = "editor-zone-count";
+        const char EditorSensitivityRadiusStr[] = "editor-sensitivity-radius";
+        const char GridStr[] = "grid";
+        const char HeightStr[] = "height";
+        const char HistoryStr[] = "history";
+        const char InfoStr[] = "info";
+        const char NameStr[] = "name";
+        const char QuickAccessKey[] = "key";
+        const char QuickAccessUuid[] = "uuid";
+        const char QuickLayoutKeys[] = "quick-layout-keys";
+        const char RefHeightStr[] = "ref-height";
+        const char RefWidthStr[] = "ref-width";
+        const char RowsPercentageStr[] = "rows-percentage";
+        const char RowsStr[] = "rows";
+        const char SensitivityRadius[] = "sensitivity-radius";
+        const char ShowSpacing[] = "show-spacing";
+        const char Spacing[] = "spacing";
+        const char Templates[] = "templates";
+        const char TypeStr[] = "type";
+        const char UuidStr[] = "uuid";
+        const char WidthStr[] = "width";
+        const char XStr[] = "X";
+        const char YStr[] = "Y";
+        const char ZoneIndexSetStr[] = "zone-index-set";
+        const char ZoneIndexStr[] = "zone-index";
+        const char ZoneSetUuidStr[] = "zoneset-uuid";
+        const char ZonesStr[] = "zones";
+        const char EmptyArray[] = "[]";
+    }
 }
 
 namespace
 {
-    json::JsonArray NumVecToJsonArray(const std::vector<int>& vec)
+    inline bool DeleteTmpFile(std::wstring_view tmpFilePath)
     {
-        json::JsonArray arr;
-        for (const auto& val : vec)
+        return DeleteFileW(tmpFilePath.data());
+    }
+
+    std::optional<std::string> ReadFileText(const std::wstring& fileName)
+    {
+        std::ifstream file(std::filesystem::path{ fileName }, std::ios::binary | std::ios::ate);
+        if (!file.is_open())
         {
-            arr.Append(json::JsonValue::CreateNumberValue(val));
+            return std::nullopt;
         }
 
-        return arr;
+        const auto size = file.tellg();
+        if (size < 0)
+        {
+            return std::nullopt;
+        }
+
+        std::string text(static_cast<size_t>(size), '\0');
+        file.seekg(0);
+        if (!file.read(text.data(), text.size()))
+        {
+            return std::nullopt;
+        }
+        return text;
     }
 
-    std::vector<int> JsonArrayToNumVec(const json::JsonArray& arr)
+    void WriteFileText(const std::wstring& fileName, const std::string& text)
+    {
+        std::ofstream{ std::filesystem::path{ fileName }, std::ios::binary }.write(text.data(), text.size());
+    }
+}
+
+// Streaming codec bindings, the json::JsonObject based ToJson and FromJson functions go through them as well:
+// a required member that is missing or has the wrong type drops the item.
+namespace
+{
+    using namespace FancyZonesDataTypes;
+    namespace Keys = NonLocalizable::Utf8;
+
+    bool ReadInt(JsonCodec::Reader& reader, int& value)
     {
-        std::vector<int> vec;
-        for (const auto& val : arr)
+        double number;
+        if (!reader.Read(number))
         {
-            vec.emplace_back(static_cast<int>(val.GetNumber()));
+            return false;
         }
 
-        return vec;
+        value = static_cast<int>(number);
+        return true;
     }
 
-    std::optional<FancyZonesDataTypes::AppZoneHistoryData> ParseSingleAppZoneHistoryItem(const json::JsonObject& json)
+    bool ReadIntArray(JsonCodec::Reader& reader, std::vector<int>& values)
     {
-        FancyZonesDataTypes::AppZoneHistoryData data;
-        if (json.HasKey(NonLocalizable::ZoneIndexSetStr))
+        values.clear();
+        if (!reader.BeginArray())
+        {
+            return false;
+        }
+
+        bool valid = true;
+        while (reader.NextElement())
         {
-            data.zoneIndexSet = {};
-            for (const auto& value : json.GetNamedArray(NonLocalizable::ZoneIndexSetStr))
+            int value;
+            if (ReadInt(reader, value))
             {
-                data.zoneIndexSet.push_back(static_cast<size_t>(value.GetNumber()));
+                values.push_back(value);
+            }
+            else
+            {
+                valid = false;
             }
         }
-        else if (json.HasKey(NonLocalizable::ZoneIndexStr))
+        return valid;
+    }
+
+    void WriteIntArray(JsonCodec::Writer& writer, const std::vector<int>& values)
+    {
+        writer.BeginArray();
+        for (int value : values)
         {
-            data.zoneIndexSet = { static_cast<size_t>(json.GetNamedNumber(NonLocalizable::ZoneIndexStr)) };
+            writer.Integer(value);
         }
+        writer.EndArray();
+    }
 
-        data.deviceId = json.GetNamedString(NonLocalizable::DeviceIdStr);
-        data.zoneSetUuid = json.GetNamedString(NonLocalizable::ZoneSetUuidStr);
-
-        if (!FancyZonesUtils::IsValidGuid(data.zoneSetUuid) || !FancyZonesUtils::IsValidDeviceId(data.deviceId))
+    std::optional<CanvasLayoutInfo> ReadCanvasLayoutInfo(JsonCodec::Reader& reader)
+    {
+        if (!reader.BeginObject())
         {
             return std::nullopt;
         }
 
-        return data;
-    }
+        CanvasLayoutInfo info{};
+        info.sensitivityRadius = DefaultValues::SensitivityRadius;
+        bool hasWidth = false, hasHeight = false, hasZones = false, valid = true;
 
-    inline bool DeleteTmpFile(std::wstring_view tmpFilePath)
-    {
-        return DeleteFileW(tmpFilePath.data());
-    }
-}
+        std::string_view key;
+        while (reader.NextKey(key))
+        {
+            if (key == Keys::RefWidthStr)
+            {
+                hasWidth = ReadInt(reader, info.lastWorkAreaWidth);
+            }
+            else if (key == Keys::RefHeightStr)
+            {
+                hasHeight = ReadInt(reader, info.lastWorkAreaHeight);
+            }
+            else if (key == Keys::SensitivityRadius)
+            {
+                valid = ReadInt(reader, info.sensitivityRadius) && valid;
+            }
+            else if (key == Keys::ZonesStr)
+            {
+                info.zones.clear();
+                hasZones = reader.BeginArray();
+                while (hasZones && reader.NextElement())
+                {
+                    CanvasLayoutInfo::Rect zone{};
+                    bool hasX = false, hasY = false, hasZoneWidth = false, hasZoneHeight = false;
+                    if (!reader.BeginObject())
+                    {
+                        valid = false;
+                        continue;
+                    }
 
-namespace JSONHelpers
-{
-    json::JsonObject CanvasLayoutInfoJSON::ToJson(const FancyZonesDataTypes::CanvasLayoutInfo& canvasInfo)
-    {
-        json::JsonObject infoJson{};
-        infoJson.SetNamedValue(NonLocalizable::RefWidthStr, json::value(canvasInfo.lastWorkAreaWidth));
-        infoJson.SetNamedValue(NonLocalizable::RefHeightStr, json::value(canvasInfo.lastWorkAreaHeight));
+                    std::string_view zoneKey;
+                    while (reader.NextKey(zoneKey))
+                    {
+                        if (zoneKey == Keys::XStr)
+                        {
+                            hasX = ReadInt(reader, zone.x);
+                        }
+                        else if (zoneKey == Keys::YStr)
+                        {
+                            hasY = ReadInt(reader, zone.y);
+                        }
+                        else if (zoneKey == Keys::WidthStr)
+                        {
+                            hasZoneWidth = ReadInt(reader, zone.width);
+                        }
+                        else if (zoneKey == Keys::HeightStr)
+                        {
+                            hasZoneHeight = ReadInt(reader, zone.height);
+                        }
+                        else
+                        {
+                            reader.Skip();
+                        }
+                    }
+
+                    valid = hasX && hasY && hasZoneWidth && hasZoneHeight && valid;
+                    info.zones.push_back(zone);
+                }
+            }
+            else
+            {
+                reader.Skip();
+            }
+        }
 
-        json::JsonArray zonesJson;
+        if (!valid || !hasWidth || !hasHeight || !hasZones)
+        {
+            return std::nullopt;
+        }
+        return info;
+    }
 
-        for (const auto& [x, y, width, height] : canvasInfo.zones)
+    void WriteCanvasLayoutInfo(JsonCodec::Writer& writer, const CanvasLayoutInfo& info)
+    {
+        writer.BeginObject();
+        writer.Key(Keys::RefWidthStr);
+        writer.Integer(info.lastWorkAreaWidth);
+        writer.Key(Keys::RefHeightStr);
+        writer.Integer(info.lastWorkAreaHeight);
+        writer.Key(Keys::ZonesStr);
+        writer.BeginArray();
+        for (const auto& [x, y, width, height] : info.zones)
         {
-            json::JsonObject zoneJson;
-            zoneJson.SetNamedValue(NonLocalizable::XStr, json::value(x));
-            zoneJson.SetNamedValue(NonLocalizable::YStr, json::value(y));
-            zoneJson.SetNamedValue(NonLocalizable::WidthStr, json::value(width));
-            zoneJson.SetNamedValue(NonLocalizable::HeightStr, json::value(height));
-            zonesJson.Append(zoneJson);
+            writer.BeginObject();
+            writer.Key(Keys::XStr);
+            writer.Integer(x);
+            writer.Key(Keys::YStr);
+            writer.Integer(y);
+            writer.Key(Keys::WidthStr);
+            writer.Integer(width);
+            writer.Key(Keys::HeightStr);
+            writer.Integer(height);
+            writer.EndObject();
         }
-        infoJson.SetNamedValue(NonLocalizable::ZonesStr, zonesJson);
-        infoJson.SetNamedValue(NonLocalizable::SensitivityRadius, json::value(canvasInfo.sensitivityRadius));
-        return infoJson;
+        writer.EndArray();
+        writer.Key(Keys::SensitivityRadius);
+        writer.Integer(info.sensitivityRadius);
+        writer.EndObject();
     }
 
-    std::optional<FancyZonesDataTypes::CanvasLayoutInfo> CanvasLayoutInfoJSON::FromJson(const json::JsonObject& infoJson)
+    std::optional<GridLayoutInfo> ReadGridLayoutInfo(JsonCodec::Reader& reader)
     {
-        try
+        if (!reader.BeginObject())
         {
-            FancyZonesDataTypes::CanvasLayoutInfo info;
-            info.lastWorkAreaWidth = static_cast<int>(infoJson.GetNamedNumber(NonLocalizable::RefWidthStr));
-            info.lastWorkAreaHeight = static_cast<int>(infoJson.GetNamedNumber(NonLocalizable::RefHeightStr));
+            return std::nullopt;
+        }
+
+        GridLayoutInfo info(GridLayoutInfo::Minimal{});
+        info.m_showSpacing = DefaultValues::ShowSpacing;
+        info.m_spacing = DefaultValues::Spacing;
+        info.m_sensitivityRadius = DefaultValues::SensitivityRadius;
+        bool hasRows = false, hasColumns = false, hasRowsPercents = false, hasColumnsPercents = false, hasCellChildMap = false, valid = true;
 
-            json::JsonArray zonesJson = infoJson.GetNamedArray(NonLocalizable::ZonesStr);
-            uint32_t size = zonesJson.Size();
-            info.zones.reserve(size);
-            for (uint32_t i = 0; i < size; ++i)
+        std::string_view key;
+        while (reader.NextKey(key))
+        {
+            if (key == Keys::RowsStr)
             {
-                json::JsonObject zoneJson = zonesJson.GetObjectAt(i);
-                const int x = static_cast<int>(zoneJson.GetNamedNumber(NonLocalizable::XStr));
-                const int y = static_cast<int>(zoneJson.GetNamedNumber(NonLocalizable::YStr));
-                const int width = static_cast<int>(zoneJson.GetNamedNumber(NonLocalizable::WidthStr));
-                const int height = static_cast<int>(zoneJson.GetNamedNumber(NonLocalizable::HeightStr));
-                FancyZonesDataTypes::CanvasLayoutInfo::Rect zone{ x, y, width, height };
-                info.zones.push_back(zone);
+                hasRows = ReadInt(reader, info.m_rows);
+            }
+            else if (key == Keys::ColumnsStr)
+            {
+                hasColumns = ReadInt(reader, info.m_columns);
+            }
+            else if (key == Keys::RowsPercentageStr)
+            {
+                hasRowsPercents = ReadIntArray(reader, info.m_rowsPercents);
+            }
+            else if (key == Keys::ColumnsPercentageStr)
+            {
+                hasColumnsPercents = ReadIntArray(reader, info.m_columnsPercents);
+            }
+            else if (key == Keys::CellChildMapStr)
+            {
+                info.m_cellChildMap.clear();
+                hasCellChildMap = reader.BeginArray();
+                while (hasCellChildMap && reader.NextElement())
+                {
+                    valid = ReadIntArray(reader, info.m_cellChildMap.emplace_back()) && valid;
+                }
+            }
+            else if (key == Keys::ShowSpacing)
+            {
+                valid = reader.Read(info.m_showSpacing) && valid;
+            }
+            else if (key == Keys::Spacing)
+            {
+                valid = ReadInt(reader, info.m_spacing) && valid;
+            }
+            else if (key == Keys::SensitivityRadius)
+            {
+                valid = ReadInt(reader, info.m_sensitivityRadius) && valid;
+            }
+            else
+            {
+                reader.Skip();
             }
-
-            info.sensitivityRadius = static_cast<int>(infoJson.GetNamedNumber(NonLocalizable::SensitivityRadius, DefaultValues::SensitivityRadius));
-            return info;
         }
-        catch (const winrt::hresult_error&)
+
+        if (!valid || !hasRows || !hasColumns || !hasRowsPercents || !hasColumnsPercents || !hasCellChildMap)
         {
             return std::nullopt;
         }
-    }
 
-    json::JsonObject GridLayoutInfoJSON::ToJson(const FancyZonesDataTypes::GridLayoutInfo& gridInfo)
-    {
-        json::JsonObject infoJson;
-        infoJson.SetNamedValue(NonLocalizable::RowsStr, json::value(gridInfo.m_rows));
-        infoJson.SetNamedValue(NonLocalizable::ColumnsStr, json::value(gridInfo.m_columns));
-        infoJson.SetNamedValue(NonLocalizable::RowsPercentageStr, NumVecToJsonArray(gridInfo.m_rowsPercents));
-        infoJson.SetNamedValue(NonLocalizable::ColumnsPercentageStr, NumVecToJsonArray(gridInfo.m_columnsPercents));
+        if (info.m_rowsPercents.size() != info.m_rows || info.m_columnsPercents.size() != info.m_columns || info.m_cellChildMap.size() != info.m_rows)
+        {
+            return std::nullopt;
+        }
 
-        json::JsonArray cellChildMapJson;
-        for (int i = 0; i < gridInfo.m_cellChildMap.size(); ++i)
+        for (const auto& cellsRow : info.m_cellChildMap)
         {
-            cellChildMapJson.Append(NumVecToJsonArray(gridInfo.m_cellChildMap[i]));
+            if (cellsRow.size() != info.m_columns)
+            {
+                return std::nullopt;
+            }
         }
-        infoJson.SetNamedValue(NonLocalizable::CellChildMapStr, cellChildMapJson);
-        
-        infoJson.SetNamedValue(NonLocalizable::SensitivityRadius, json::value(gridInfo.m_sensitivityRadius));
-        infoJson.SetNamedValue(NonLocalizable::ShowSpacing, json::value(gridInfo.m_showSpacing));
-        infoJson.SetNamedValue(NonLocalizable::Spacing, json::value(gridInfo.m_spacing));
 
-        return infoJson;
+        return info;
     }
 
-    std::optional<FancyZonesDataTypes::GridLayoutInfo> GridLayoutInfoJSON::FromJson(const json::JsonObject& infoJson)
+    void WriteGridLayoutInfo(JsonCodec::Writer& writer, const GridLayoutInfo& info)
     {
-        try
+        writer.BeginObject();
+        writer.Key(Keys::RowsStr);
+        writer.Integer(info.m_rows);
+        writer.Key(Keys::ColumnsStr);
+        writer.Integer(info.m_columns);
+        writer.Key(Keys::RowsPercentageStr);
+        WriteIntArray(writer, info.m_rowsPercents);
+        writer.Key(Keys::ColumnsPercentageStr);
+        WriteIntArray(writer, info.m_columnsPercents);
+        writer.Key(Keys::CellChildMapStr);
+        writer.BeginArray();
+        for (const auto& cellsRow : info.m_cellChildMap)
         {
-            FancyZonesDataTypes::GridLayoutInfo info(FancyZonesDataTypes::GridLayoutInfo::Minimal{});
+            WriteIntArray(writer, cellsRow);
+        }
+        writer.EndArray();
+        writer.Key(Keys::SensitivityRadius);
+        writer.Integer(info.m_sensitivityRadius);
+        writer.Key(Keys::ShowSpacing);
+        writer.Bool(info.m_showSpacing);
+        writer.Key(Keys::Spacing);
+        writer.Integer(info.m_spacing);
+        writer.EndObject();
+    }
 
-            info.m_rows = static_cast<int>(infoJson.GetNamedNumber(NonLocalizable::RowsStr));
-            info.m_columns = static_cast<int>(infoJson.GetNamedNumber(NonLocalizable::ColumnsStr));
+    std::optional<JSONHelpers::CustomZoneSetJSON> ReadCustomZoneSet(JsonCodec::Reader& reader)
+    {
+        if (!reader.BeginObject())
+        {
+            return std::nullopt;
+        }
 
-            json::JsonArray rowsPercentage = infoJson.GetNamedArray(NonLocalizable::RowsPercentageStr);
-            json::JsonArray columnsPercentage = infoJson.GetNamedArray(NonLocalizable::ColumnsPercentageStr);
-            json::JsonArray cellChildMap = infoJson.GetNamedArray(NonLocalizable::CellChildMapStr);
+        JSONHelpers::CustomZoneSetJSON result;
+        std::optional<std::wstring> type;
+        // Info is read once the type is known, it's kept aside if it comes first
+        std::optional<std::string_view> infoText;
+        bool hasUuid = false, hasName = false, hasInfo = false, validInfo = false;
 
-            if (rowsPercentage.Size() != info.m_rows || columnsPercentage.Size() != info.m_columns || cellChildMap.Size() != info.m_rows)
+        auto readInfo = [&result, &type](JsonCodec::Reader& infoReader) {
+            if (*type == NonLocalizable::CanvasStr)
             {
-                return std::nullopt;
+                if (auto info = ReadCanvasLayoutInfo(infoReader); info.has_value())
+                {
+                    result.data.type = CustomLayoutType::Canvas;
+                    result.data.info = std::move(info.value());
+                    return true;
+                }
+            }
+            else if (*type == NonLocalizable::GridStr)
+            {
+                if (auto info = ReadGridLayoutInfo(infoReader); info.has_value())
+                {
+                    result.data.type = CustomLayoutType::Grid;
+                    result.data.info = std::move(info.value());
+                    return true;
+                }
             }
+            else
+            {
+                infoReader.Skip();
+            }
+            return false;
+        };
 
-            info.m_rowsPercents = JsonArrayToNumVec(rowsPercentage);
-            info.m_columnsPercents = JsonArrayToNumVec(columnsPercentage);
-            for (const auto& cellsRow : cellChildMap)
+        std::string_view key;
+        while (reader.NextKey(key))
+        {
+            if (key == Keys::UuidStr)
+            {
+                hasUuid = reader.Read(result.uuid);
+            }
+            else if (key == Keys::NameStr)
             {
-                const auto cellsArray = cellsRow.GetArray();
-                if (cellsArray.Size() != info.m_columns)
+                hasName = reader.Read(result.data.name);
+            }
+            else if (key == Keys::TypeStr)
+            {
+                std::wstring value;
+                type = reader.Read(value) ? std::optional{ std::move(value) } : std::nullopt;
+            }
+            else if (key == Keys::InfoStr)
+            {
+                hasInfo = reader.Peek() == JsonCodec::ValueType::Object;
+                if (hasInfo && type.has_value())
                 {
-                    return std::nullopt;
+                    validInfo = readInfo(reader);
+                    infoText.reset();
                 }
-                info.cellChildMap().push_back(JsonArrayToNumVec(cellsArray));
+                else
+                {
+                    infoText = reader.Capture();
+                }
+            }
+            else
+            {
+                reader.Skip();
             }
+        }
 
-            info.m_showSpacing = infoJson.GetNamedBoolean(NonLocalizable::ShowSpacing, DefaultValues::ShowSpacing);
-            info.m_spacing = static_cast<int>(infoJson.GetNamedNumber(NonLocalizable::Spacing, DefaultValues::Spacing));
-            info.m_sensitivityRadius = static_cast<int>(infoJson.GetNamedNumber(NonLocalizable::SensitivityRadius, DefaultValues::SensitivityRadius));
+        if (!reader.Ok() || !hasUuid || !hasName || !hasInfo || !type.has_value() || !FancyZonesUtils::IsValidGuid(result.uuid))
+        {
+            return std::nullopt;
+        }
 
-            return info;
+        if (infoText.has_value())
+        {
+            JsonCodec::Reader infoReader(*infoText);
+            validInfo = readInfo(infoReader);
         }
-        catch (const winrt::hresult_error&)
+
+        if (!validInfo)
         {
             return std::nullopt;
         }
+        return result;
     }
 
-    json::JsonObject CustomZoneSetJSON::ToJson(const CustomZoneSetJSON& customZoneSet)
+    void WriteCustomZoneSet(JsonCodec::Writer& writer, const std::wstring& uuid, const CustomZoneSetData& data)
     {
-        json::JsonObject result{};
-
-        result.SetNamedValue(NonLocalizable::UuidStr, json::value(customZoneSet.uuid));
-        result.SetNamedValue(NonLocalizable::NameStr, json::value(customZoneSet.data.name));
-        switch (customZoneSet.data.type)
+        writer.BeginObject();
+        writer.Key(Keys::UuidStr);
+        writer.String(uuid);
+        writer.Key(Keys::NameStr);
+        writer.String(data.name);
+        switch (data.type)
         {
-        case FancyZonesDataTypes::CustomLayoutType::Canvas:
+        case CustomLayoutType::Canvas:
+            writer.Key(Keys::TypeStr);
+            writer.String(NonLocalizable::CanvasStr);
+            writer.Key(Keys::InfoStr);
+            WriteCanvasLayoutInfo(writer, std::get<CanvasLayoutInfo>(data.info));
+            break;
+        case CustomLayoutType::Grid:
+            writer.Key(Keys::TypeStr);
+            writer.String(NonLocalizable::GridStr);
+            writer.Key(Keys::InfoStr);
+            WriteGridLayoutInfo(writer, std::get<GridLayoutInfo>(data.info));
+            break;
+        }
+        writer.EndObject();
+    }
+
+    std::optional<ZoneSetData> ReadZoneSetData(JsonCodec::Reader& reader)
+    {
+        if (!reader.BeginObject())
         {
-            result.SetNamedValue(NonLocalizable::TypeStr, json::value(NonLocalizable::CanvasStr));
+            return std::nullopt;
+        }
 
-            FancyZonesDataTypes::CanvasLayoutInfo info = std::get<FancyZonesDataTypes::CanvasLayoutInfo>(customZoneSet.data.info);
-            result.SetNamedValue(NonLocalizable::InfoStr, CanvasLayoutInfoJSON::ToJson(info));
+        ZoneSetData zoneSetData;
+        std::wstring type;
+        bool hasUuid = false, hasType = false;
 
-            break;
+        std::string_view key;
+        while (reader.NextKey(key))
+        {
+            if (key == Keys::UuidStr)
+            {
+                hasUuid = reader.Read(zoneSetData.uuid);
+            }
+            else if (key == Keys::TypeStr)
+            {
+                hasType = reader.Read(type);
+            }
+            else
+            {
+                reader.Skip();
+            }
         }
-        case FancyZonesDataTypes::CustomLayoutType::Grid:
+
+        if (!hasUuid || !hasType || !FancyZonesUtils::IsValidGuid(zoneSetData.uuid))
         {
-            result.SetNamedValue(NonLocalizable::TypeStr, json::value(NonLocalizable::GridStr));
+            return std::nullopt;
+        }
 
-            FancyZonesDataTypes::GridLayoutInfo gridInfo = std::get<FancyZonesDataTypes::GridLayoutInfo>(customZoneSet.data.info);
-            result.SetNamedValue(NonLocalizable::InfoStr, GridLayoutInfoJSON::ToJson(gridInfo));
+        zoneSetData.type = TypeFromString(type);
+        return zoneSetData;
+    }
 
-            break;
+    void WriteZoneSetData(JsonCodec::Writer& writer, const ZoneSetData& zoneSet)
+    {
+        writer.BeginObject();
+        writer.Key(Keys::UuidStr);
+        writer.String(zoneSet.uuid);
+        writer.Key(Keys::TypeStr);
+        writer.String(TypeToString(zoneSet.type));
+        writer.EndObject();
+    }
+
+    std::optional<JSONHelpers::DeviceInfoJSON> ReadDeviceInfo(JsonCodec::Reader& reader)
+    {
+        if (!reader.BeginObject())
+        {
+            return std::nullopt;
         }
+
+        JSONHelpers::DeviceInfoJSON result;
+        result.data.sensitivityRadius = DefaultValues::SensitivityRadius;
+        bool hasDeviceId = false, hasZoneSet = false, hasShowSpacing = false, hasSpacing = false, hasZoneCount = false, valid = true;
+
+        std::string_view key;
+        while (reader.NextKey(key))
+        {
+            if (key == Keys::DeviceIdStr)
+            {
+                hasDeviceId = reader.Read(result.deviceId);
+            }
+            else if (key == Keys::ActiveZoneSetStr)
+            {
+                auto zoneSet = ReadZoneSetData(reader);
+                hasZoneSet = zoneSet.has_value();
+                if (hasZoneSet)
+                {
+                    result.data.activeZoneSet = std::move(zoneSet.value());
+                }
+            }
+            else if (key == Keys::EditorShowSpacingStr)
+            {
+                hasShowSpacing = reader.Read(result.data.showSpacing);
+            }
+            else if (key == Keys::EditorSpacingStr)
+            {
+                hasSpacing = ReadInt(reader, result.data.spacing);
+            }
+            else if (key == Keys::EditorZoneCountStr)
+            {
+                hasZoneCount = ReadInt(reader, result.data.zoneCount);
+            }
+            else if (key == Keys::EditorSensitivityRadiusStr)
+            {
+                valid = ReadInt(reader, result.data.sensitivityRadius) && valid;
+            }
+            else
+            {
+                reader.Skip();
+            }
         }
 
+        if (!valid || !hasDeviceId || !hasZoneSet || !hasShowSpacing || !hasSpacing || !hasZoneCount || !FancyZonesUtils::IsValidDeviceId(result.deviceId))
+        {
+            return std::nullopt;
+        }
         return result;
     }
 
-    std::optional<CustomZoneSetJSON> CustomZoneSetJSON::FromJson(const json::JsonObject& customZoneSet)
+    void WriteDeviceInfo(JsonCodec::Writer& writer, const std::wstring& deviceId, const DeviceInfoData& data)
     {
-        try
+        writer.BeginObject();
+        writer.Key(Keys::DeviceIdStr);
+        writer.String(deviceId);
+        writer.Key(Keys::ActiveZoneSetStr);
+        WriteZoneSetData(writer, data.activeZoneSet);
+        writer.Key(Keys::EditorShowSpacingStr);
+        writer.Bool(data.showSpacing);
+        writer.Key(Keys::EditorSpacingStr);
+        writer.Integer(data.spacing);
+        writer.Key(Keys::EditorZoneCountStr);
+        writer.Integer(data.zoneCount);
+        writer.Key(Keys::EditorSensitivityRadiusStr);
+        writer.Integer(data.sensitivityRadius);
+        writer.EndObject();
+    }
+
+    std::optional<JSONHelpers::LayoutQuickKeyJSON> ReadLayoutQuickKey(JsonCodec::Reader& reader)
+    {
+        if (!reader.BeginObject())
         {
-            CustomZoneSetJSON result;
+            return std::nullopt;
+        }
+
+        JSONHelpers::LayoutQuickKeyJSON result;
+        bool hasUuid = false, hasKey = false;
 
-            result.uuid = customZoneSet.GetNamedString(NonLocalizable::UuidStr);
-            if (!FancyZonesUtils::IsValidGuid(result.uuid))
+        std::string_view key;
+        while (reader.NextKey(key))
+        {
+            if (key == Keys::QuickAccessUuid)
             {
-                return std::nullopt;
+                hasUuid = reader.Read(result.layoutUuid);
+            }
+            else if (key == Keys::QuickAccessKey)
+            {
+                hasKey = ReadInt(reader, result.key);
             }
+            else
+            {
+                reader.Skip();
+            }
+        }
 
-            result.data.name = customZoneSet.GetNamedString(NonLocalizable::NameStr);
+        if (!hasUuid || !hasKey || !FancyZonesUtils::IsValidGuid(result.layoutUuid))
+        {
+            return std::nullopt;
+        }
+        return result;
+    }
+
+    void WriteLayoutQuickKey(JsonCodec::Writer& writer, const std::wstring& layoutUuid, int key)
+    {
+        writer.BeginObject();
+        writer.Key(Keys::QuickAccessUuid);
+        writer.String(layoutUuid);
+        writer.Key(Keys::QuickAccessKey);
+        writer.Integer(key);
+        writer.EndObject();
+    }
 
-            json::JsonObject infoJson = customZoneSet.GetNamedObject(NonLocalizable::InfoStr);
-            std::wstring zoneSetType = std::wstring{ customZoneSet.GetNamedString(NonLocalizable::TypeStr) };
-            if (zoneSetType.compare(NonLocalizable::CanvasStr) == 0)
+    // Members of a history item, as they are found in the item or, in the previous file format, in the application entry
+    struct AppZoneHistoryItemMembers
+    {
+        bool hasZoneIndexSet = false;
+        bool hasZoneIndex = false;
+        bool validZoneIndexSet = true;
+        std::vector<size_t> zoneIndexSet;
+        std::optional<size_t> zoneIndex;
+        std::optional<std::wstring> deviceId;
+        std::optional<std::wstring> zoneSetUuid;
+    };
+
+    enum class AppZoneHistoryItemStatus
+    {
+        Valid,
+        // Invalid ids, the item is left out
+        Skipped,
+        // Members with the wrong type, the whole application entry is left out
+        Invalid
+    };
+
+    bool ReadAppZoneHistoryItemMember(std::string_view key, JsonCodec::Reader& reader, AppZoneHistoryItemMembers& members)
+    {
+        if (key == Keys::ZoneIndexSetStr)
+        {
+            members.hasZoneIndexSet = true;
+            members.zoneIndexSet.clear();
+            members.validZoneIndexSet = reader.BeginArray();
+            if (members.validZoneIndexSet)
             {
-                if (auto info = CanvasLayoutInfoJSON::FromJson(infoJson); info.has_value())
-                {
-                    result.data.type = FancyZonesDataTypes::CustomLayoutType::Canvas;
-                    result.data.info = std::move(info.value());
-                }
-                else
+                while (reader.NextElement())
                 {
-                    return std::nullopt;
+                    double index;
+                    if (reader.Read(index))
+                    {
+                        members.zoneIndexSet.push_back(static_cast<size_t>(index));
+                    }
+                    else
+                    {
+                        members.validZoneIndexSet = false;
+                    }
                 }
             }
-            else if (zoneSetType.compare(NonLocalizable::GridStr) == 0)
+        }
+        else if (key == Keys::ZoneIndexStr)
+        {
+            double index;
+            members.hasZoneIndex = true;
+            members.zoneIndex = reader.Read(index) ? std::optional{ static_cast<size_t>(index) } : std::nullopt;
+        }
+        else if (key == Keys::DeviceIdStr)
+        {
+            std::wstring value;
+            members.deviceId = reader.Read(value) ? std::optional{ std::move(value) } : std::nullopt;
+        }
+        else if (key == Keys::ZoneSetUuidStr)
+        {
+            std::wstring value;
+            members.zoneSetUuid = reader.Read(value) ? std::optional{ std::move(value) } : std::nullopt;
+        }
+        else
+        {
+            return false;
+        }
+        return true;
+    }
+
+    AppZoneHistoryItemStatus MakeAppZoneHistoryItem(AppZoneHistoryItemMembers&& members, AppZoneHistoryData& data)
+    {
+        if (members.hasZoneIndexSet)
+        {
+            if (!members.validZoneIndexSet)
+            {
+                return AppZoneHistoryItemStatus::Invalid;
+            }
+            data.zoneIndexSet = std::move(members.zoneIndexSet);
+        }
+        else if (members.hasZoneIndex)
+        {
+            if (!members.zoneIndex.has_value())
+            {
+                return AppZoneHistoryItemStatus::Invalid;
+            }
+            data.zoneIndexSet = { *members.zoneIndex };
+        }
+
+        if (!members.deviceId.has_value() || !members.zoneSetUuid.has_value())
+        {
+            return AppZoneHistoryItemStatus::Invalid;
+        }
+
+        data.deviceId = std::move(*members.deviceId);
+        data.zoneSetUuid = std::move(*members.zoneSetUuid);
+        if (!FancyZonesUtils::IsValidGuid(data.zoneSetUuid) || !FancyZonesUtils::IsValidDeviceId(data.deviceId))
+        {
+            return AppZoneHistoryItemStatus::Skipped;
+        }
+        return AppZoneHistoryItemStatus::Valid;
+    }
+
+    std::optional<JSONHelpers::AppZoneHistoryJSON> ReadAppZoneHistory(JsonCodec::Reader& reader)
+    {
+        if (!reader.BeginObject())
+        {
+            return std::nullopt;
+        }
+
+        JSONHelpers::AppZoneHistoryJSON result;
+        AppZoneHistoryItemMembers previousFormat;
+        bool hasAppPath = false, hasHistory = false, valid = true;
+
+        auto addItem = [&result, &valid](AppZoneHistoryItemMembers&& members) {
+            AppZoneHistoryData data;
+            switch (MakeAppZoneHistoryItem(std::move(members), data))
             {
-                if (auto info = GridLayoutInfoJSON::FromJson(infoJson); info.has_value())
+            case AppZoneHistoryItemStatus::Valid:
+                result.data.push_back(std::move(data));
+                break;
+            case AppZoneHistoryItemStatus::Skipped:
+                break;
+            case AppZoneHistoryItemStatus::Invalid:
+                valid = false;
+                break;
+            }
+        };
+
+        std::string_view key;
+        while (reader.NextKey(key))
+        {
+            if (key == Keys::AppPathStr)
+            {
+                hasAppPath = reader.Read(result.appPath);
+            }
+            else if (key == Keys::HistoryStr)
+            {
+                hasHistory = true;
+                result.data.clear();
+                if (!reader.BeginArray())
                 {
-                    result.data.type = FancyZonesDataTypes::CustomLayoutType::Grid;
-                    result.data.info = std::move(info.value());
+                    valid = false;
+                    continue;
                 }
-                else
+
+                while (reader.NextElement())
                 {
-                    return std::nullopt;
+                    if (!reader.BeginObject())
+                    {
+                        valid = false;
+                        continue;
+                    }
+
+                    AppZoneHistoryItemMembers members;
+                    std::string_view itemKey;
+                    while (reader.NextKey(itemKey))
+                    {
+                        if (!ReadAppZoneHistoryItemMember(itemKey, reader, members))
+                        {
+                            reader.Skip();
+                        }
+                    }
+                    addItem(std::move(members));
                 }
             }
-            else
+            else if (!ReadAppZoneHistoryItemMember(key, reader, previousFormat))
+            {
+                reader.Skip();
+            }
+        }
+
+        if (!hasHistory)
+        {
+            // Previous file format, with single desktop layout information per application
+            addItem(std::move(previousFormat));
+        }
+
+        if (!valid || !hasAppPath || result.data.empty())
+        {
+            return std::nullopt;
+        }
+        return result;
+    }
+
+    void WriteAppZoneHistory(JsonCodec::Writer& writer, const std::wstring& appPath, const std::vector<AppZoneHistoryData>& history)
+    {
+        writer.BeginObject();
+        writer.Key(Keys::AppPathStr);
+        writer.String(appPath);
+        writer.Key(Keys::HistoryStr);
+        writer.BeginArray();
+        for (const auto& data : history)
+        {
+            writer.BeginObject();
+            writer.Key(Keys::ZoneIndexSetStr);
+            writer.BeginArray();
+            for (size_t index : data.zoneIndexSet)
+            {
+                writer.Integer(static_cast<int>(index));
+            }
+            writer.EndArray();
+            writer.Key(Keys::DeviceIdStr);
+            writer.String(data.deviceId);
+            writer.Key(Keys::ZoneSetUuidStr);
+            writer.String(data.zoneSetUuid);
+            writer.EndObject();
+        }
+        writer.EndArray();
+        writer.EndObject();
+    }
+
+    // Array of items, an element that isn't an object empties the whole map like GetObjectAt throwing did
+    template<typename Map, typename ReadItem>
+    void ReadArray(JsonCodec::Reader& reader, Map& map, ReadItem&& readItem)
+    {
+        map.clear();
+        if (!reader.BeginArray())
+        {
+            return;
+        }
+
+        bool valid = true;
+        while (reader.NextElement())
+        {
+            if (reader.Peek() != JsonCodec::ValueType::Object)
+            {
+                valid = false;
+                reader.Skip();
+                continue;
+            }
+            readItem(reader);
+        }
+
+        if (!valid)
+        {
+            map.clear();
+        }
+    }
+
+    void ReadAppZoneHistoryArray(JsonCodec::Reader& reader, JSONHelpers::TAppZoneHistoryMap& appZoneHistoryMap)
+    {
+        ReadArray(reader, appZoneHistoryMap, [&appZoneHistoryMap](JsonCodec::Reader& reader) {
+            if (auto appZoneHistory = ReadAppZoneHistory(reader); appZoneHistory.has_value())
+            {
+                appZoneHistoryMap[appZoneHistory->appPath] = std::move(appZoneHistory->data);
+            }
+        });
+    }
+
+    void ReadDeviceInfoArray(JsonCodec::Reader& reader, JSONHelpers::TDeviceInfoMap& deviceInfoMap)
+    {
+        ReadArray(reader, deviceInfoMap, [&deviceInfoMap](JsonCodec::Reader& reader) {
+            if (auto device = ReadDeviceInfo(reader); device.has_value())
+            {
+                deviceInfoMap[device->deviceId] = std::move(device->data);
+            }
+        });
+    }
+
+    void ReadCustomZoneSetArray(JsonCodec::Reader& reader, JSONHelpers::TCustomZoneSetsMap& customZoneSetsMap)
+    {
+        ReadArray(reader, customZoneSetsMap, [&customZoneSetsMap](JsonCodec::Reader& reader) {
+            if (auto zoneSet = ReadCustomZoneSet(reader); zoneSet.has_value())
+            {
+                customZoneSetsMap[zoneSet->uuid] = std::move(zoneSet->data);
+            }
+        });
+    }
+
+    void ReadLayoutQuickKeyArray(JsonCodec::Reader& reader, JSONHelpers::TLayoutQuickKeysMap& quickKeysMap)
+    {
+        ReadArray(reader, quickKeysMap, [&quickKeysMap](JsonCodec::Reader& reader) {
+            if (auto quickKey = ReadLayoutQuickKey(reader); quickKey.has_value())
             {
-                return std::nullopt;
+                quickKeysMap[quickKey->layoutUuid] = quickKey->key;
             }
+        });
+    }
 
-            return result;
-        }
-        catch (const winrt::hresult_error&)
+    void WriteAppZoneHistoryArray(JsonCodec::Writer& writer, const JSONHelpers::TAppZoneHistoryMap& appZoneHistoryMap)
+    {
+        writer.BeginArray();
+        for (const auto& [appPath, appZoneHistoryData] : appZoneHistoryMap)
         {
-            return std::nullopt;
+            WriteAppZoneHistory(writer, appPath, appZoneHistoryData);
         }
+        writer.EndArray();
     }
 
-    json::JsonObject ZoneSetDataJSON::ToJson(const FancyZonesDataTypes::ZoneSetData& zoneSet)
+    void WriteDeviceInfoArray(JsonCodec::Writer& writer, const JSONHelpers::TDeviceInfoMap& deviceInfoMap)
     {
-        json::JsonObject result{};
-
-        result.SetNamedValue(NonLocalizable::UuidStr, json::value(zoneSet.uuid));
-        result.SetNamedValue(NonLocalizable::TypeStr, json::value(TypeToString(zoneSet.type)));
-
-        return result;
+        writer.BeginArray();
+        for (const auto& [deviceId, deviceData] : deviceInfoMap)
+        {
+            WriteDeviceInfo(writer, deviceId, deviceData);
+        }
+        writer.EndArray();
     }
 
-    std::optional<FancyZonesDataTypes::ZoneSetData> ZoneSetDataJSON::FromJson(const json::JsonObject& zoneSet)
+    void WriteCustomZoneSetArray(JsonCodec::Writer& writer, const JSONHelpers::TCustomZoneSetsMap& customZoneSetsMap)
     {
-        try
+        writer.BeginArray();
+        for (const auto& [zoneSetId, zoneSetData] : customZoneSetsMap)
         {
-            FancyZonesDataTypes::ZoneSetData zoneSetData;
-            zoneSetData.uuid = zoneSet.GetNamedString(NonLocalizable::UuidStr);
-            zoneSetData.type = FancyZonesDataTypes::TypeFromString(std::wstring{ zoneSet.GetNamedString(NonLocalizable::TypeStr) });
-
-            if (!FancyZonesUtils::IsValidGuid(zoneSetData.uuid))
-            {
-                return std::nullopt;
-            }
-
-            return zoneSetData;
+            WriteCustomZoneSet(writer, zoneSetId, zoneSetData);
         }
-        catch (const winrt::hresult_error&)
+        writer.EndArray();
+    }
+
+    void WriteLayoutQuickKeyArray(JsonCodec::Writer& writer, const JSONHelpers::TLayoutQuickKeysMap& quickKeysMap)
+    {
+        writer.BeginArray();
+        for (const auto& [uuid, key] : quickKeysMap)
         {
-            return std::nullopt;
+            WriteLayoutQuickKey(writer, uuid, key);
         }
+        writer.EndArray();
     }
 
-    json::JsonObject AppZoneHistoryJSON::ToJson(const AppZoneHistoryJSON& appZoneHistory)
+    // Devices, custom zone sets, quick keys and, in files from versions that kept it there, the app zone history
+    bool ReadZoneSettings(std::string_view json, JSONHelpers::PersistedData& data, bool& hasAppZoneHistory)
     {
-        json::JsonObject result{};
-
-        result.SetNamedValue(NonLocalizable::AppPathStr, json::value(appZoneHistory.appPath));
+        JsonCodec::Reader reader(json);
+        if (!reader.BeginObject())
+        {
+            return false;
+        }
 
-        json::JsonArray appHistoryArray;
-        for (const auto& data : appZoneHistory.data)
+        std::string_view key;
+        while (reader.NextKey(key))
         {
-            json::JsonObject desktopData;
-            json::JsonArray jsonIndexSet;
-            for (size_t index : data.zoneIndexSet)
+            if (key == Keys::DevicesStr)
             {
-                jsonIndexSet.Append(json::value(static_cast<int>(index)));
+                ReadDeviceInfoArray(reader, data.deviceInfoMap);
+            }
+            else if (key == Keys::CustomZoneSetsStr)
+            {
+                ReadCustomZoneSetArray(reader, data.customZoneSetsMap);
+            }
+            else if (key == Keys::QuickLayoutKeys)
+            {
+                ReadLayoutQuickKeyArray(reader, data.quickKeysMap);
+            }
+            else if (key == Keys::AppZoneHistoryStr)
+            {
+                hasAppZoneHistory = true;
+                ReadAppZoneHistoryArray(reader, data.appZoneHistoryMap);
+            }
+            else
+            {
+                reader.Skip();
             }
-
-            desktopData.SetNamedValue(NonLocalizable::ZoneIndexSetStr, jsonIndexSet);
-            desktopData.SetNamedValue(NonLocalizable::DeviceIdStr, json::value(data.deviceId));
-            desktopData.SetNamedValue(NonLocalizable::ZoneSetUuidStr, json::value(data.zoneSetUuid));
-
-            appHistoryArray.Append(desktopData);
         }
 
-        result.SetNamedValue(NonLocalizable::HistoryStr, appHistoryArray);
-
-        return result;
+        return reader.End();
     }
 
-    std::optional<AppZoneHistoryJSON> AppZoneHistoryJSON::FromJson(const json::JsonObject& zoneSet)
+    // Templates array of the zones settings file, compacted the way the codec writes it
+    std::string ReadTemplates(std::string_view json)
     {
-        try
+        JsonCodec::Reader reader(json);
+        std::string templates = Keys::EmptyArray;
+        if (reader.BeginObject())
         {
-            AppZoneHistoryJSON result;
-
-            result.appPath = zoneSet.GetNamedString(NonLocalizable::AppPathStr);
-            if (zoneSet.HasKey(NonLocalizable::HistoryStr))
+            std::string_view key;
+            while (reader.NextKey(key))
             {
-                auto appHistoryArray = zoneSet.GetNamedArray(NonLocalizable::HistoryStr);
-                for (uint32_t i = 0; i < appHistoryArray.Size(); ++i)
+                if (key == Keys::Templates && reader.Peek() == JsonCodec::ValueType::Array)
                 {
-                    json::JsonObject json = appHistoryArray.GetObjectAt(i);
-                    if (auto data = ParseSingleAppZoneHistoryItem(json); data.has_value())
-                    {
-                        result.data.push_back(std::move(data.value()));
-                    }
+                    JsonCodec::Writer writer;
+                    reader.Copy(writer);
+                    templates = writer.Take();
                 }
-            }
-            else
-            {
-                // handle previous file format, with single desktop layout information per application
-                if (auto data = ParseSingleAppZoneHistoryItem(zoneSet); data.has_value())
+                else
                 {
-                    result.data.push_back(std::move(data.value()));
+                    reader.Skip();
                 }
             }
-            if (result.data.empty())
-            {
-                return std::nullopt;
-            }
-
-            return result;
-        }
-        catch (const winrt::hresult_error&)
-        {
-            return std::nullopt;
         }
+
+        return reader.End() ? templates : Keys::EmptyArray;
     }
 
-    json::JsonObject DeviceInfoJSON::ToJson(const DeviceInfoJSON& device)
+    // The files are rewritten only if their content changes, whitespace put in by other writers doesn't count
+    bool SameJson(const std::optional<std::string>& before, const std::string& after)
     {
-        json::JsonObject result{};
+        return before.has_value() && (*before == after || JsonCodec::Minify(*before) == after);
+    }
 
-        result.SetNamedValue(NonLocalizable::DeviceIdStr, json::value(device.deviceId));
-        result.SetNamedValue(NonLocalizable::ActiveZoneSetStr, JSONHelpers::ZoneSetDataJSON::ToJson(device.data.activeZoneSet));
-        result.SetNamedValue(NonLocalizable::EditorShowSpacingStr, json::value(device.data.showSpacing));
-        result.SetNamedValue(NonLocalizable::EditorSpacingStr, json::value(device.data.spacing));
-        result.SetNamedValue(NonLocalizable::EditorZoneCountStr, json::value(device.data.zoneCount));
-        result.SetNamedValue(NonLocalizable::EditorSensitivityRadiusStr, json::value(device.data.sensitivityRadius));
+    // The json::JsonObject based functions read and write their object through the codec
+    template<typename ReadItem>
+    auto FromJsonObject(const json::JsonObject& object, ReadItem&& readItem)
+    {
+        const auto text = winrt::to_string(object.Stringify());
+        JsonCodec::Reader reader(text);
+        return readItem(reader);
+    }
 
-        return result;
+    template<typename WriteItem>
+    json::JsonObject ToJsonObject(WriteItem&& writeItem)
+    {
+        JsonCodec::Writer writer;
+        writeItem(writer);
+        return json::JsonObject::Parse(winrt::to_hstring(writer.Text()));
     }
 
-    std::optional<DeviceInfoJSON> DeviceInfoJSON::FromJson(const json::JsonObject& device)
+    // Whole arrays go through the codec at once rather than item by item
+    template<typename Map, typename ReadItems>
+    Map FromJsonArray(const json::JsonArray& array, ReadItems&& readItems)
     {
-        try
-        {
-            DeviceInfoJSON result;
+        const auto text = winrt::to_string(array.Stringify());
+        JsonCodec::Reader reader(text);
+        Map map{};
+        readItems(reader, map);
+        return map;
+    }
 
-            result.deviceId = device.GetNamedString(NonLocalizable::DeviceIdStr);
-            if (!FancyZonesUtils::IsValidDeviceId(result.deviceId))
-            {
-                return std::nullopt;
-            }
+    template<typename Map, typename WriteItems>
+    json::JsonArray ToJsonArray(const Map& map, WriteItems&& writeItems)
+    {
+        JsonCodec::Writer writer;
+        writeItems(writer, map);
+        return json::JsonArray::Parse(winrt::to_hstring(writer.Text()));
+    }
+}
 
-            if (auto zoneSet = JSONHelpers::ZoneSetDataJSON::FromJson(device.GetNamedObject(NonLocalizable::ActiveZoneSetStr)); zoneSet.has_value())
-            {
-                result.data.activeZoneSet = std::move(zoneSet.value());
-            }
-            else
-            {
-                return std::nullopt;
-            }
+namespace JSONHelpers
+{
+    json::JsonObject CanvasLayoutInfoJSON::ToJson(const FancyZonesDataTypes::CanvasLayoutInfo& canvasInfo)
+    {
+        return ToJsonObject([&](JsonCodec::Writer& writer) { WriteCanvasLayoutInfo(writer, canvasInfo); });
+    }
 
-            result.data.showSpacing = device.GetNamedBoolean(NonLocalizable::EditorShowSpacingStr);
-            result.data.spacing = static_cast<int>(device.GetNamedNumber(NonLocalizable::EditorSpacingStr));
-            result.data.zoneCount = static_cast<int>(device.GetNamedNumber(NonLocalizable::EditorZoneCountStr));
-            result.data.sensitivityRadius = static_cast<int>(device.GetNamedNumber(NonLocalizable::EditorSensitivityRadiusStr, DefaultValues::SensitivityRadius));
+    std::optional<FancyZonesDataTypes::CanvasLayoutInfo> CanvasLayoutInfoJSON::FromJson(const json::JsonObject& infoJson)
+    {
+        return FromJsonObject(infoJson, ReadCanvasLayoutInfo);
+    }
 
-            return result;
-        }
-        catch (const winrt::hresult_error&)
-        {
-            return std::nullopt;
-        }
+    json::JsonObject GridLayoutInfoJSON::ToJson(const FancyZonesDataTypes::GridLayoutInfo& gridInfo)
+    {
+        return ToJsonObject([&](JsonCodec::Writer& writer) { WriteGridLayoutInfo(writer, gridInfo); });
     }
 
-    json::JsonObject LayoutQuickKeyJSON::ToJson(const LayoutQuickKeyJSON& layoutQuickKey)
+    std::optional<FancyZonesDataTypes::GridLayoutInfo> GridLayoutInfoJSON::FromJson(const json::JsonObject& infoJson)
     {
-        json::JsonObject result{};
+        return FromJsonObject(infoJson, ReadGridLayoutInfo);
+    }
 
-        result.SetNamedValue(NonLocalizable::QuickAccessUuid, json::value(layoutQuickKey.layoutUuid));
-        result.SetNamedValue(NonLocalizable::QuickAccessKey, json::value(layoutQuickKey.key));
+    json::JsonObject CustomZoneSetJSON::ToJson(const CustomZoneSetJSON& customZoneSet)
+    {
+        return ToJsonObject([&](JsonCodec::Writer& writer) { WriteCustomZoneSet(writer, customZoneSet.uuid, customZoneSet.data); });
+    }
 
-        return result;
+    std::optional<CustomZoneSetJSON> CustomZoneSetJSON::FromJson(const json::JsonObject& customZoneSet)
+    {
+        return FromJsonObject(customZoneSet, ReadCustomZoneSet);
     }
-    
-    std::optional<LayoutQuickKeyJSON> LayoutQuickKeyJSON::FromJson(const json::JsonObject& layoutQuickKey)
+
+    json::JsonObject ZoneSetDataJSON::ToJson(const FancyZonesDataTypes::ZoneSetData& zoneSet)
     {
-        try
-        {
-            LayoutQuickKeyJSON result;
+        return ToJsonObject([&](JsonCodec::Writer& writer) { WriteZoneSetData(writer, zoneSet); });
+    }
 
-            result.layoutUuid = layoutQuickKey.GetNamedString(NonLocalizable::QuickAccessUuid);
-            if (!FancyZonesUtils::IsValidGuid(result.layoutUuid))
-            {
-                return std::nullopt;
-            }
+    std::optional<FancyZonesDataTypes::ZoneSetData> ZoneSetDataJSON::FromJson(const json::JsonObject& zoneSet)
+    {
+        return FromJsonObject(zoneSet, ReadZoneSetData);
+    }
 
-            result.key = static_cast<int>(layoutQuickKey.GetNamedNumber(NonLocalizable::QuickAccessKey));
-            
-            return result;
-        }
-        catch (const winrt::hresult_error&)
-        {
-            return std::nullopt;
-        }
+    json::JsonObject AppZoneHistoryJSON::ToJson(const AppZoneHistoryJSON& appZoneHistory)
+    {
+        return ToJsonObject([&](JsonCodec::Writer& writer) { WriteAppZoneHistory(writer, appZoneHistory.appPath, appZoneHistory.data); });
+    }
+
+    std::optional<AppZoneHistoryJSON> AppZoneHistoryJSON::FromJson(const json::JsonObject& zoneSet)
+    {
+        return FromJsonObject(zoneSet, ReadAppZoneHistory);
+    }
+
+    json::JsonObject DeviceInfoJSON::ToJson(const DeviceInfoJSON& device)
+    {
+        return ToJsonObject([&](JsonCodec::Writer& writer) { WriteDeviceInfo(writer, device.deviceId, device.data); });
+    }
+
+    std::optional<DeviceInfoJSON> DeviceInfoJSON::FromJson(const json::JsonObject& device)
+    {
+        return FromJsonObject(device, ReadDeviceInfo);
+    }
+
+    json::JsonObject LayoutQuickKeyJSON::ToJson(const LayoutQuickKeyJSON& layoutQuickKey)
+    {
+        return ToJsonObject([&](JsonCodec::Writer& writer) { WriteLayoutQuickKey(writer, layoutQuickKey.layoutUuid, layoutQuickKey.key); });
+    }
+
+    std::optional<LayoutQuickKeyJSON> LayoutQuickKeyJSON::FromJson(const json::JsonObject& layoutQuickKey)
+    {
+        return FromJsonObject(layoutQuickKey, ReadLayoutQuickKey);
     }
 
     json::JsonObject MonitorInfo::ToJson(const MonitorInfo& monitor)
@@ -568,100 +1260,130 @@ namespace JSONHelpers
 
     void SaveZoneSettings(const std::wstring& zonesSettingsFileName, const TDeviceInfoMap& deviceInfoMap, const TCustomZoneSetsMap& customZoneSetsMap, const TLayoutQuickKeysMap& quickKeysMap)
     {
-        auto before = json::from_file(zonesSettingsFileName);
-
-        json::JsonObject root{};
-        json::JsonArray templates{};
+        const auto before = ReadFileText(zonesSettingsFileName);
+        const auto templates = before.has_value() ? ReadTemplates(*before) : NonLocalizable::Utf8::EmptyArray;
+        const auto after = WriteZoneSettingsJson(deviceInfoMap, customZoneSetsMap, quickKeysMap, templates);
 
-        try
-        {
-            if (before.has_value() && before->HasKey(NonLocalizable::Templates))
-            {
-                templates = before->GetNamedArray(NonLocalizable::Templates);
-            }
-        }
-        catch (const winrt::hresult_error&)
-        {
-        
-        }
-               
-        root.SetNamedValue(NonLocalizable::DevicesStr, JSONHelpers::SerializeDeviceInfos(deviceInfoMap));
-        root.SetNamedValue(NonLocalizable::CustomZoneSetsStr, JSONHelpers::SerializeCustomZoneSets(customZoneSetsMap));
-        root.SetNamedValue(NonLocalizable::Templates, templates);
-        root.SetNamedValue(NonLocalizable::QuickLayoutKeys, JSONHelpers::SerializeQuickKeys(quickKeysMap));
-        
-        if (!before.has_value() || before.value().Stringify() != root.Stringify())
+        if (!SameJson(before, after))
         {
             Trace::FancyZones::DataChanged();
-            json::to_file(zonesSettingsFileName, root);
+            WriteFileText(zonesSettingsFileName, after);
         }
     }
 
     void SaveAppZoneHistory(const std::wstring& appZoneHistoryFileName, const TAppZoneHistoryMap& appZoneHistoryMap)
     {
-        json::JsonObject root{};
+        const auto before = ReadFileText(appZoneHistoryFileName);
+        const auto after = WriteAppZoneHistoryJson(appZoneHistoryMap);
 
-        root.SetNamedValue(NonLocalizable::AppZoneHistoryStr, JSONHelpers::SerializeAppZoneHistory(appZoneHistoryMap));
-
-        auto before = json::from_file(appZoneHistoryFileName);
-        if (!before.has_value() || before.value().Stringify() != root.Stringify())
+        if (!SameJson(before, after))
         {
-            json::to_file(appZoneHistoryFileName, root);
+            WriteFileText(appZoneHistoryFileName, after);
         }
     }
 
-    TAppZoneHistoryMap ParseAppZoneHistory(const json::JsonObject& fancyZonesDataJSON)
+    PersistedData ReadPersistedData(const std::wstring& zonesSettingsFileName, const std::wstring& appZoneHistoryFileName)
     {
-        try
+        const auto zonesSettings = ReadFileText(zonesSettingsFileName);
+        if (!zonesSettings.has_value())
+        {
+            return {};
+        }
+
+        PersistedData data;
+        bool hasAppZoneHistory = false;
+        if (!ReadZoneSettings(*zonesSettings, data, hasAppZoneHistory))
         {
-            TAppZoneHistoryMap appZoneHistoryMap{};
-            auto appLastZones = fancyZonesDataJSON.GetNamedArray(NonLocalizable::AppZoneHistoryStr);
+            return {};
+        }
 
-            for (uint32_t i = 0; i < appLastZones.Size(); ++i)
+        if (!hasAppZoneHistory)
+        {
+            if (const auto appZoneHistory = ReadFileText(appZoneHistoryFileName); appZoneHistory.has_value())
             {
-                json::JsonObject appLastZone = appLastZones.GetObjectAt(i);
-                if (auto appZoneHistory = AppZoneHistoryJSON::FromJson(appLastZone); appZoneHistory.has_value())
-                {
-                    appZoneHistoryMap[appZoneHistory->appPath] = std::move(appZoneHistory->data);
-                }
+                data.appZoneHistoryMap = ReadAppZoneHistoryJson(*appZoneHistory).value_or(TAppZoneHistoryMap{});
             }
-
-            return std::move(appZoneHistoryMap);
         }
-        catch (const winrt::hresult_error&)
+
+        return data;
+    }
+
+    std::optional<PersistedData> ReadZoneSettingsJson(std::string_view json)
+    {
+        PersistedData data;
+        bool hasAppZoneHistory = false;
+        if (!ReadZoneSettings(json, data, hasAppZoneHistory))
         {
-            return {};
+            return std::nullopt;
         }
+        return data;
     }
 
-    json::JsonArray SerializeAppZoneHistory(const TAppZoneHistoryMap& appZoneHistoryMap)
+    std::string WriteZoneSettingsJson(const TDeviceInfoMap& deviceInfoMap, const TCustomZoneSetsMap& customZoneSetsMap, const TLayoutQuickKeysMap& quickKeysMap, std::string_view templatesJson)
     {
-        json::JsonArray appHistoryArray;
+        JsonCodec::Writer writer;
+        writer.BeginObject();
 
-        for (const auto& [appPath, appZoneHistoryData] : appZoneHistoryMap)
-        {
-            appHistoryArray.Append(AppZoneHistoryJSON::ToJson(AppZoneHistoryJSON{ appPath, appZoneHistoryData }));
-        }
+        writer.Key(NonLocalizable::Utf8::DevicesStr);
+        WriteDeviceInfoArray(writer, deviceInfoMap);
+
+        writer.Key(NonLocalizable::Utf8::CustomZoneSetsStr);
+        WriteCustomZoneSetArray(writer, customZoneSetsMap);
+
+        writer.Key(NonLocalizable::Utf8::Templates);
+        writer.Raw(templatesJson);
 
-        return appHistoryArray;
+        writer.Key(NonLocalizable::Utf8::QuickLayoutKeys);
+        WriteLayoutQuickKeyArray(writer, quickKeysMap);
+
+        writer.EndObject();
+        return writer.Take();
     }
 
-    TDeviceInfoMap ParseDeviceInfos(const json::JsonObject& fancyZonesDataJSON)
+    std::optional<TAppZoneHistoryMap> ReadAppZoneHistoryJson(std::string_view json)
     {
-        try
+        JsonCodec::Reader reader(json);
+        if (!reader.BeginObject())
         {
-            TDeviceInfoMap deviceInfoMap{};
-            auto devices = fancyZonesDataJSON.GetNamedArray(NonLocalizable::DevicesStr);
+            return std::nullopt;
+        }
 
-            for (uint32_t i = 0; i < devices.Size(); ++i)
+        TAppZoneHistoryMap appZoneHistoryMap{};
+        std::string_view key;
+        while (reader.NextKey(key))
+        {
+            if (key == NonLocalizable::Utf8::AppZoneHistoryStr)
             {
-                if (auto device = DeviceInfoJSON::DeviceInfoJSON::FromJson(devices.GetObjectAt(i)); device.has_value())
-                {
-                    deviceInfoMap[device->deviceId] = std::move(device->data);
-                }
+                ReadAppZoneHistoryArray(reader, appZoneHistoryMap);
             }
+            else
+            {
+                reader.Skip();
+            }
+        }
 
-            return std::move(deviceInfoMap);
+        if (!reader.End())
+        {
+            return std::nullopt;
+        }
+        return appZoneHistoryMap;
+    }
+
+    std::string WriteAppZoneHistoryJson(const TAppZoneHistoryMap& appZoneHistoryMap)
+    {
+        JsonCodec::Writer writer;
+        writer.BeginObject();
+        writer.Key(NonLocalizable::Utf8::AppZoneHistoryStr);
+        WriteAppZoneHistoryArray(writer, appZoneHistoryMap);
+        writer.EndObject();
+        return writer.Take();
+    }
+
+    TAppZoneHistoryMap ParseAppZoneHistory(const json::JsonObject& fancyZonesDataJSON)
+    {
+        try
+        {
+            return FromJsonArray<TAppZoneHistoryMap>(fancyZonesDataJSON.GetNamedArray(NonLocalizable::AppZoneHistoryStr), ReadAppZoneHistoryArray);
         }
         catch (const winrt::hresult_error&)
         {
@@ -669,34 +1391,33 @@ namespace JSONHelpers
         }
     }
 
-    json::JsonArray SerializeDeviceInfos(const TDeviceInfoMap& deviceInfoMap)
+    json::JsonArray SerializeAppZoneHistory(const TAppZoneHistoryMap& appZoneHistoryMap)
     {
-        json::JsonArray DeviceInfosJSON{};
+        return ToJsonArray(appZoneHistoryMap, WriteAppZoneHistoryArray);
+    }
 
-        for (const auto& [deviceID, deviceData] : deviceInfoMap)
+    TDeviceInfoMap ParseDeviceInfos(const json::JsonObject& fancyZonesDataJSON)
+    {
+        try
+        {
+            return FromJsonArray<TDeviceInfoMap>(fancyZonesDataJSON.GetNamedArray(NonLocalizable::DevicesStr), ReadDeviceInfoArray);
+        }
+        catch (const winrt::hresult_error&)
         {
-            DeviceInfosJSON.Append(DeviceInfoJSON::DeviceInfoJSON::ToJson(DeviceInfoJSON{ deviceID, deviceData }));
+            return {};
         }
+    }
 
-        return DeviceInfosJSON;
+    json::JsonArray SerializeDeviceInfos(const TDeviceInfoMap& deviceInfoMap)
+    {
+        return ToJsonArray(deviceInfoMap, WriteDeviceInfoArray);
     }
 
     TCustomZoneSetsMap ParseCustomZoneSets(const json::JsonObject& fancyZonesDataJSON)
     {
         try
         {
-            TCustomZoneSetsMap customZoneSetsMap{};
-            auto customZoneSets = fancyZonesDataJSON.GetNamedArray(NonLocalizable::CustomZoneSetsStr);
-
-            for (uint32_t i = 0; i < customZoneSets.Size(); ++i)
-            {
-                if (auto zoneSet = CustomZoneSetJSON::FromJson(customZoneSets.GetObjectAt(i)); zoneSet.has_value())
-                {
-                    customZoneSetsMap[zoneSet->uuid] = std::move(zoneSet->data);
-                }
-            }
-
-            return std::move(customZoneSetsMap);
+            return FromJsonArray<TCustomZoneSetsMap>(fancyZonesDataJSON.GetNamedArray(NonLocalizable::CustomZoneSetsStr), ReadCustomZoneSetArray);
         }
         catch (const winrt::hresult_error&)
         {
@@ -706,32 +1427,14 @@ namespace JSONHelpers
 
     json::JsonArray SerializeCustomZoneSets(const TCustomZoneSetsMap& customZoneSetsMap)
     {
-        json::JsonArray customZoneSetsJSON{};
-
-        for (const auto& [zoneSetId, zoneSetData] : customZoneSetsMap)
-        {
-            customZoneSetsJSON.Append(CustomZoneSetJSON::ToJson(CustomZoneSetJSON{ zoneSetId, zoneSetData }));
-        }
-
-        return customZoneSetsJSON;
+        return ToJsonArray(customZoneSetsMap, WriteCustomZoneSetArray);
     }
     
     TLayoutQuickKeysMap ParseQuickKeys(const json::JsonObject& fancyZonesDataJSON)
     {
         try
         {
-            TLayoutQuickKeysMap quickKeysMap{};
-            auto quickKeys = fancyZonesDataJSON.GetNamedArray(NonLocalizable::QuickLayoutKeys);
-
-            for (uint32_t i = 0; i < quickKeys.Size(); ++i)
-            {
-                if (auto quickKey = LayoutQuickKeyJSON::FromJson(quickKeys.GetObjectAt(i)); quickKey.has_value())
-                {
-                    quickKeysMap[quickKey->layoutUuid] = std::move(quickKey->key);
-                }
-            }
-
-            return std::move(quickKeysMap);
+            return FromJsonArray<TLayoutQuickKeysMap>(fancyZonesDataJSON.GetNamedArray(NonLocalizable::QuickLayoutKeys), ReadLayoutQuickKeyArray);
         }
         catch (const winrt::hresult_error& e)
         {
@@ -742,13 +1445,6 @@ namespace JSONHelpers
 
     json::JsonArray SerializeQuickKeys(const TLayoutQuickKeysMap& quickKeysMap)
     {
-        json::JsonArray quickKeysJSON{};
-
-        for (const auto& [uuid, key] : quickKeysMap)
-        {
-            quickKeysJSON.Append(LayoutQuickKeyJSON::ToJson(LayoutQuickKeyJSON{ uuid, key }));
-        }
-
-        return quickKeysJSON;
+        return ToJsonArray(quickKeysMap, WriteLayoutQuickKeyArray);
     }
-}
\ No newline at end of file
+}
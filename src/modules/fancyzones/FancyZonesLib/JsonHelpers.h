@@ -4,7 +4,9 @@
 
 #include <common/utils/json.h>
 
+#include <optional>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <unordered_map>
 
@@ -96,6 +98,21 @@ namespace JSONHelpers
     void SaveZoneSettings(const std::wstring& zonesSettingsFileName, const TDeviceInfoMap& deviceInfoMap, const TCustomZoneSetsMap& customZoneSetsMap, const TLayoutQuickKeysMap& quickKeysMap);
     void SaveAppZoneHistory(const std::wstring& appZoneHistoryFileName, const TAppZoneHistoryMap& appZoneHistoryMap);
 
+    struct PersistedData
+    {
+        TDeviceInfoMap deviceInfoMap;
+        TCustomZoneSetsMap customZoneSetsMap;
+        TLayoutQuickKeysMap quickKeysMap;
+        TAppZoneHistoryMap appZoneHistoryMap;
+    };
+
+    // Streaming counterparts of GetPersistFancyZonesJSON and the Parse/Serialize functions below, they produce the same data and the same file content
+    PersistedData ReadPersistedData(const std::wstring& zonesSettingsFileName, const std::wstring& appZoneHistoryFileName);
+    std::optional<PersistedData> ReadZoneSettingsJson(std::string_view json);
+    std::optional<TAppZoneHistoryMap> ReadAppZoneHistoryJson(std::string_view json);
+    std::string WriteZoneSettingsJson(const TDeviceInfoMap& deviceInfoMap, const TCustomZoneSetsMap& customZoneSetsMap, const TLayoutQuickKeysMap& quickKeysMap, std::string_view templatesJson = "[]");
+    std::string WriteAppZoneHistoryJson(const TAppZoneHistoryMap& appZoneHistoryMap);
+
     TAppZoneHistoryMap ParseAppZoneHistory(const json::JsonObject& fancyZonesDataJSON);
     json::JsonArray SerializeAppZoneHistory(const TAppZoneHistoryMap& appZoneHistoryMap);
 
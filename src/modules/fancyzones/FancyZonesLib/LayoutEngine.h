@@ -0,0 +1,603 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Zone layout geometry. Doesn't depend on Windows or COM types, so the same code is used by ZoneSet
+// and can be built, tested and benchmarked on its own.
+// Zone rectangles are relative to the work area they are calculated for.
+namespace LayoutEngine
+{
+    struct Rect
+    {
+        long left = 0;
+        long top = 0;
+        long right = 0;
+        long bottom = 0;
+
+        constexpr long width() const noexcept { return right - left; }
+        constexpr long height() const noexcept { return bottom - top; }
+
+        bool operator==(const Rect&) const = default;
+    };
+
+    struct Zone
+    {
+        size_t id;
+        Rect rect;
+    };
+
+    using Zones = std::vector<Zone>;
+
+    enum class Direction
+    {
+        Left,
+        Up,
+        Right,
+        Down
+    };
+
+    struct GridLayout
+    {
+        int rows;
+        int columns;
+        std::vector<int> rowsPercents;
+        std::vector<int> columnsPercents;
+        std::vector<std::vector<int>> cellChildMap;
+    };
+
+    struct CanvasZone
+    {
+        int x;
+        int y;
+        int width;
+        int height;
+    };
+
+    // Row and column percents of a grid layout add up to this value
+    constexpr int C_MULTIPLIER = 10000;
+    constexpr int DEFAULT_DPI = 96;
+
+    // PriorityGrid layout is unique for zoneCount <= 11. For zoneCount > 11 PriorityGrid is same as Grid
+    inline const std::vector<GridLayout>& PredefinedPriorityGridLayouts()
+    {
+        static const std::vector<GridLayout> layouts{
+            /* 1 */
+            GridLayout{ .rows = 1, .columns = 1, .rowsPercents = { 10000 }, .columnsPercents = { 10000 }, .cellChildMap = { { 0 } } },
+            /* 2 */
+            GridLayout{ .rows = 1, .columns = 2, .rowsPercents = { 10000 }, .columnsPercents = { 6667, 3333 }, .cellChildMap = { { 0, 1 } } },
+            /* 3 */
+            GridLayout{ .rows = 1, .columns = 3, .rowsPercents = { 10000 }, .columnsPercents = { 2500, 5000, 2500 }, .cellChildMap = { { 0, 1, 2 } } },
+            /* 4 */
+            GridLayout{ .rows = 2, .columns = 3, .rowsPercents = { 5000, 5000 }, .columnsPercents = { 2500, 5000, 2500 }, .cellChildMap = { { 0, 1, 2 }, { 0, 1, 3 } } },
+            /* 5 */
+            GridLayout{ .rows = 2, .columns = 3, .rowsPercents = { 5000, 5000 }, .columnsPercents = { 2500, 5000, 2500 }, .cellChildMap = { { 0, 1, 2 }, { 3, 1, 4 } } },
+            /* 6 */
+            GridLayout{ .rows = 3, .columns = 3, .rowsPercents = { 3333, 3334, 3333 }, .columnsPercents = { 2500, 5000, 2500 }, .cellChildMap = { { 0, 1, 2 }, { 0, 1, 3 }, { 4, 1, 5 } } },
+            /* 7 */
+            GridLayout{ .rows = 3, .columns = 3, .rowsPercents = { 3333, 3334, 3333 }, .columnsPercents = { 2500, 5000, 2500 }, .cellChildMap = { { 0, 1, 2 }, { 3, 1, 4 }, { 5, 1, 6 } } },
+            /* 8 */
+            GridLayout{ .rows = 3, .columns = 4, .rowsPercents = { 3333, 3334, 3333 }, .columnsPercents = { 2500, 2500, 2500, 2500 }, .cellChildMap = { { 0, 1, 2, 3 }, { 4, 1, 2, 5 }, { 6, 1, 2, 7 } } },
+            /* 9 */
+            GridLayout{ .rows = 3, .columns = 4, .rowsPercents = { 3333, 3334, 3333 }, .columnsPercents = { 2500, 2500, 2500, 2500 }, .cellChildMap = { { 0, 1, 2, 3 }, { 4, 1, 2, 5 }, { 6, 1, 7, 8 } } },
+            /* 10 */
+            GridLayout{ .rows = 3, .columns = 4, .rowsPercents = { 3333, 3334, 3333 }, .columnsPercents = { 2500, 2500, 2500, 2500 }, .cellChildMap = { { 0, 1, 2, 3 }, { 4, 1, 5, 6 }, { 7, 1, 8, 9 } } },
+            /* 11 */
+            GridLayout{ .rows = 3, .columns = 4, .rowsPercents = { 3333, 3334, 3333 }, .columnsPercents = { 2500, 2500, 2500, 2500 }, .cellChildMap = { { 0, 1, 2, 3 }, { 4, 1, 5, 6 }, { 7, 8, 9, 10 } } },
+        };
+
+        return layouts;
+    }
+
+    inline Zones CalculateFocusLayout(const Rect& workArea, int zoneCount)
+    {
+        Zones zones;
+        if (zoneCount <= 0)
+        {
+            return zones;
+        }
+
+        long left{ 100 };
+        long top{ 100 };
+        long right{ left + long(workArea.width() * 0.4) };
+        long bottom{ top + long(workArea.height() * 0.4) };
+
+        Rect focusZoneRect{ left, top, right, bottom };
+
+        long focusRectXIncrement = (zoneCount <= 1) ? 0 : 50;
+        long focusRectYIncrement = (zoneCount <= 1) ? 0 : 50;
+
+        zones.reserve(zoneCount);
+        for (int i = 0; i < zoneCount; i++)
+        {
+            zones.push_back(Zone{ zones.size(), focusZoneRect });
+
+            focusZoneRect.left += focusRectXIncrement;
+            focusZoneRect.right += focusRectXIncrement;
+            focusZoneRect.bottom += focusRectYIncrement;
+            focusZoneRect.top += focusRectYIncrement;
+        }
+
+        return zones;
+    }
+
+    inline Zones CalculateColumnsAndRowsLayout(const Rect& workArea, bool columns, int zoneCount, int spacing)
+    {
+        Zones zones;
+        if (zoneCount <= 0)
+        {
+            return zones;
+        }
+
+        long totalWidth;
+        long totalHeight;
+
+        if (columns)
+        {
+            totalWidth = workArea.width() - (spacing * (zoneCount + 1));
+            totalHeight = workArea.height() - (spacing * 2);
+        }
+        else
+        {
+            totalWidth = workArea.width() - (spacing * 2);
+            totalHeight = workArea.height() - (spacing * (zoneCount + 1));
+        }
+
+        long top = spacing;
+        long left = spacing;
+        long bottom;
+        long right;
+
+        // Note: The expressions below are NOT equal to total{Width|Height} / zoneCount and are done
+        // like this to make the sum of all zones' sizes exactly total{Width|Height}.
+        zones.reserve(zoneCount);
+        for (int zoneIndex = 0; zoneIndex < zoneCount; ++zoneIndex)
+        {
+            if (columns)
+            {
+                right = left + (zoneIndex + 1) * totalWidth / zoneCount - zoneIndex * totalWidth / zoneCount;
+                bottom = totalHeight + spacing;
+            }
+            else
+            {
+                right = totalWidth + spacing;
+                bottom = top + (zoneIndex + 1) * totalHeight / zoneCount - zoneIndex * totalHeight / zoneCount;
+            }
+
+            zones.push_back(Zone{ zones.size(), Rect{ left, top, right, bottom } });
+
+            if (columns)
+            {
+                left = right + spacing;
+            }
+            else
+            {
+                top = bottom + spacing;
+            }
+        }
+
+        return zones;
+    }
+
+    inline Zones CalculateGridZones(const Rect& workArea, const GridLayout& layout, int spacing)
+    {
+        long totalWidth = workArea.width();
+        long totalHeight = workArea.height();
+        struct Info
+        {
+            long Extent;
+            long Start;
+            long End;
+        };
+        std::vector<Info> rowInfo(layout.rows);
+        std::vector<Info> columnInfo(layout.columns);
+
+        // Note: The expressions below are carefully written to
+        // make the sum of all zones' sizes exactly total{Width|Height}
+        int totalPercents = 0;
+        for (int row = 0; row < layout.rows; row++)
+        {
+            rowInfo[row].Start = totalPercents * totalHeight / C_MULTIPLIER;
+            totalPercents += layout.rowsPercents[row];
+            rowInfo[row].End = totalPercents * totalHeight / C_MULTIPLIER;
+            rowInfo[row].Extent = rowInfo[row].End - rowInfo[row].Start;
+        }
+
+        totalPercents = 0;
+        for (int col = 0; col < layout.columns; col++)
+        {
+            columnInfo[col].Start = totalPercents * totalWidth / C_MULTIPLIER;
+            totalPercents += layout.columnsPercents[col];
+            columnInfo[col].End = totalPercents * totalWidth / C_MULTIPLIER;
+            columnInfo[col].Extent = columnInfo[col].End - columnInfo[col].Start;
+        }
+
+        const auto& cellChildMap = layout.cellChildMap;
+
+        Zones zones;
+        for (int row = 0; row < layout.rows; row++)
+        {
+            for (int col = 0; col < layout.columns; col++)
+            {
+                int i = cellChildMap[row][col];
+                if (((row == 0) || (cellChildMap[row - 1][col] != i)) &&
+                    ((col == 0) || (cellChildMap[row][col - 1] != i)))
+                {
+                    long left = columnInfo[col].Start;
+                    long top = rowInfo[row].Start;
+
+                    int maxRow = row;
+                    while (((maxRow + 1) < layout.rows) && (cellChildMap[maxRow + 1][col] == i))
+                    {
+                        maxRow++;
+                    }
+                    int maxCol = col;
+                    while (((maxCol + 1) < layout.columns) && (cellChildMap[row][maxCol + 1] == i))
+                    {
+                        maxCol++;
+                    }
+
+                    long right = columnInfo[maxCol].End;
+                    long bottom = rowInfo[maxRow].End;
+
+                    top += row == 0 ? spacing : spacing / 2;
+                    bottom -= maxRow == layout.rows - 1 ? spacing : spacing / 2;
+                    left += col == 0 ? spacing : spacing / 2;
+                    right -= maxCol == layout.columns - 1 ? spacing : spacing / 2;
+
+                    zones.push_back(Zone{ static_cast<size_t>(i), Rect{ left, top, right, bottom } });
+                }
+            }
+        }
+
+        return zones;
+    }
+
+    // Grid with zoneCount cells, rows and columns split evenly. The last zone spans the remaining cells of the last row.
+    inline GridLayout MakeGridLayout(int zoneCount)
+    {
+        int rows = 1, columns = 1;
+        while (zoneCount / rows >= rows)
+        {
+            rows++;
+        }
+        rows--;
+        columns = zoneCount / rows;
+        if (zoneCount % rows != 0)
+        {
+            columns++;
+        }
+
+        GridLayout layout{ .rows = rows, .columns = columns, .rowsPercents = std::vector<int>(rows), .columnsPercents = std::vector<int>(columns), .cellChildMap = std::vector<std::vector<int>>(rows, std::vector<int>(columns)) };
+
+        // Note: The expressions below are NOT equal to C_MULTIPLIER / {rows|columns} and are done
+        // like this to make the sum of all percents exactly C_MULTIPLIER
+        for (int row = 0; row < rows; row++)
+        {
+            layout.rowsPercents[row] = C_MULTIPLIER * (row + 1) / rows - C_MULTIPLIER * row / rows;
+        }
+        for (int col = 0; col < columns; col++)
+        {
+            layout.columnsPercents[col] = C_MULTIPLIER * (col + 1) / columns - C_MULTIPLIER * col / columns;
+        }
+
+        int index = 0;
+        for (int row = 0; row < rows; row++)
+        {
+            for (int col = 0; col < columns; col++)
+            {
+                layout.cellChildMap[row][col] = index++;
+                if (index == zoneCount)
+                {
+                    index--;
+                }
+            }
+        }
+
+        return layout;
+    }
+
+    inline Zones CalculateGridLayout(const Rect& workArea, bool priorityGrid, int zoneCount, int spacing)
+    {
+        if (zoneCount <= 0)
+        {
+            return {};
+        }
+
+        const auto& predefined = PredefinedPriorityGridLayouts();
+        if (priorityGrid && static_cast<size_t>(zoneCount) < predefined.size())
+        {
+            return CalculateGridZones(workArea, predefined[zoneCount - 1], spacing);
+        }
+
+        return CalculateGridZones(workArea, MakeGridLayout(zoneCount), spacing);
+    }
+
+    // Canvas zones are stored for the default DPI and scaled to the DPI of the monitor
+    inline Zones CalculateCanvasZones(const std::vector<CanvasZone>& canvasZones, int dpi)
+    {
+        Zones zones;
+        zones.reserve(canvasZones.size());
+        for (const auto& zone : canvasZones)
+        {
+            long x = zone.x * dpi / DEFAULT_DPI;
+            long y = zone.y * dpi / DEFAULT_DPI;
+            long width = zone.width * dpi / DEFAULT_DPI;
+            long height = zone.height * dpi / DEFAULT_DPI;
+
+            zones.push_back(Zone{ zones.size(), Rect{ x, y, x + width, y + height } });
+        }
+
+        return zones;
+    }
+
+    // Index of the zone to move the window to in the given direction, zoneRects.size() if there is none
+    inline size_t ChooseNextZoneByPosition(Direction direction, const Rect& windowRect, const std::vector<Rect>& zoneRects) noexcept
+    {
+        using complex = std::complex<double>;
+        const size_t invalidResult = zoneRects.size();
+        const double inf = 1e100;
+        const double eccentricity = 2.0;
+
+        auto rectCenter = [](const Rect& rect) {
+            return complex{
+                0.5 * rect.left + 0.5 * rect.right,
+                0.5 * rect.top + 0.5 * rect.bottom
+            };
+        };
+
+        auto distance = [&](complex arrowDirection, complex zoneDirection) {
+            double scalarProduct = (arrowDirection * conj(zoneDirection)).real();
+            if (scalarProduct <= 0.0)
+            {
+                return inf;
+            }
+
+            // no need to divide by abs(arrowDirection) because it's = 1
+            double cosAngle = scalarProduct / abs(zoneDirection);
+            double tanAngle = std::abs(std::tan(std::acos(cosAngle)));
+
+            if (tanAngle > 10)
+            {
+                // The angle is too wide
+                return inf;
+            }
+
+            // find the intersection with the ellipse with given eccentricity and major axis along arrowDirection
+            double intersectY = 2 * eccentricity / (1.0 + eccentricity * eccentricity * tanAngle * tanAngle);
+            double distanceEstimate = scalarProduct / intersectY;
+
+            return std::isfinite(distanceEstimate) ? distanceEstimate : inf;
+        };
+
+        complex directionVector;
+        switch (direction)
+        {
+        case Direction::Up:
+            directionVector = { 0.0, -1.0 };
+            break;
+        case Direction::Down:
+            directionVector = { 0.0, 1.0 };
+            break;
+        case Direction::Left:
+            directionVector = { -1.0, 0.0 };
+            break;
+        case Direction::Right:
+            directionVector = { 1.0, 0.0 };
+            break;
+        default:
+            return invalidResult;
+        }
+
+        const complex windowCenter = rectCenter(windowRect);
+
+        size_t closestIdx = invalidResult;
+        double smallestDistance = inf;
+
+        for (size_t i = 0; i < zoneRects.size(); i++)
+        {
+            // Offset the zone slightly, to differentiate in case there are overlapping zones
+            const complex zoneCenter = rectCenter(zoneRects[i]) + 0.001 * (i + 1);
+
+            double dist = distance(directionVector, zoneCenter - windowCenter);
+            if (dist < smallestDistance)
+            {
+                smallestDistance = dist;
+                closestIdx = i;
+            }
+        }
+
+        return closestIdx;
+    }
+
+    // Window rect moved to the opposite side of the area, to pick the first zone when cycling in the given direction
+    inline Rect PrepareRectForCycling(Rect windowRect, const Rect& area, Direction direction) noexcept
+    {
+        long deltaX = 0, deltaY = 0;
+        switch (direction)
+        {
+        case Direction::Up:
+            deltaY = area.height();
+            break;
+        case Direction::Down:
+            deltaY = -area.height();
+            break;
+        case Direction::Left:
+            deltaX = area.width();
+            break;
+        case Direction::Right:
+            deltaX = -area.width();
+            break;
+        }
+
+        windowRect.left += deltaX;
+        windowRect.right += deltaX;
+        windowRect.top += deltaY;
+        windowRect.bottom += deltaY;
+        return windowRect;
+    }
+
+    // Directional neighbors of every zone of a desktop, across all its work areas. Computed when the layouts
+    // or the monitors change, so that moving a window from the zone it's snapped to is a lookup.
+    // The results are those of ChooseNextZoneByPosition for a window covering the zone, with the candidates
+    // in the order they are enumerated when searching: work area by work area, zone by zone.
+    class ZoneGraph
+    {
+    public:
+        static constexpr size_t None = std::numeric_limits<size_t>::max();
+
+        struct Node
+        {
+            // Index of the work area the zone belongs to
+            size_t area;
+            size_t zoneId;
+            // In the coordinates of the work areas
+            Rect rect;
+        };
+
+        ZoneGraph() = default;
+
+        // Zones of a work area are in the order of their ids. Areas are the rects of all the work areas,
+        // including those without zones, their union is the desktop the windows cycle around.
+        // With less than two areas there is nothing across them, only the neighbors are computed.
+        ZoneGraph(std::vector<Node> nodes, const std::vector<Rect>& areas) :
+            m_nodes(std::move(nodes))
+        {
+            std::stable_sort(m_nodes.begin(), m_nodes.end(), [](const Node& lhs, const Node& rhs) { return lhs.area < rhs.area; });
+
+            Rect desktop{};
+            for (size_t i = 0; i < areas.size(); i++)
+            {
+                desktop = i == 0 ? areas[i] : Rect{ (std::min)(desktop.left, areas[i].left), (std::min)(desktop.top, areas[i].top), (std::max)(desktop.right, areas[i].right), (std::max)(desktop.bottom, areas[i].bottom) };
+            }
+
+            // Nodes of each area are contiguous, [first, last)
+            std::vector<std::pair<size_t, size_t>> areaNodes;
+            for (size_t i = 0; i < m_nodes.size(); i++)
+            {
+                m_index.emplace(Key(m_nodes[i].area, m_nodes[i].zoneId), i);
+                if (areaNodes.empty() || m_nodes[areaNodes.back().first].area != m_nodes[i].area)
+                {
+                    areaNodes.emplace_back(i, i);
+                }
+                areaNodes.back().second = i + 1;
+            }
+
+            constexpr Direction directions[] = { Direction::Left, Direction::Up, Direction::Right, Direction::Down };
+            m_links.resize(m_nodes.size());
+
+            std::vector<Rect> candidates;
+            std::vector<size_t> candidateNodes;
+            for (const auto& [first, last] : areaNodes)
+            {
+                // Same area: all the zones of the area but the one the window is in
+                for (size_t node = first; node < last; node++)
+                {
+                    candidates.clear();
+                    candidateNodes.clear();
+                    for (size_t other = first; other < last; other++)
+                    {
+                        if (other != node)
+                        {
+                            candidates.push_back(m_nodes[other].rect);
+                            candidateNodes.push_back(other);
+                        }
+                    }
+
+                    for (auto direction : directions)
+                    {
+                        const size_t result = ChooseNextZoneByPosition(direction, m_nodes[node].rect, candidates);
+                        m_links[node].neighbor[Index(direction)] = result < candidates.size() ? candidateNodes[result] : None;
+                    }
+                }
+
+                if (areas.size() < 2)
+                {
+                    continue;
+                }
+
+                // Across areas: the zones of the other areas first, then the zones of all areas from the opposite side of the desktop
+                candidates.clear();
+                candidateNodes.clear();
+                for (size_t other = 0; other < m_nodes.size(); other++)
+                {
+                    if (other < first || other >= last)
+                    {
+                        candidates.push_back(m_nodes[other].rect);
+                        candidateNodes.push_back(other);
+                    }
+                }
+
+                const size_t otherAreasCount = candidates.size();
+                std::vector<Rect> cycleCandidates = candidates;
+                std::vector<size_t> cycleCandidateNodes = candidateNodes;
+                for (size_t node = first; node < last; node++)
+                {
+                    cycleCandidates.push_back(m_nodes[node].rect);
+                    cycleCandidateNodes.push_back(node);
+                }
+
+                for (size_t node = first; node < last; node++)
+                {
+                    for (auto direction : directions)
+                    {
+                        size_t& link = m_links[node].acrossAreas[Index(direction)];
+                        size_t result = ChooseNextZoneByPosition(direction, m_nodes[node].rect, candidates);
+                        if (result < otherAreasCount)
+                        {
+                            link = candidateNodes[result];
+                            continue;
+                        }
+
+                        result = ChooseNextZoneByPosition(direction, PrepareRectForCycling(m_nodes[node].rect, desktop, direction), cycleCandidates);
+                        link = result < cycleCandidates.size() ? cycleCandidateNodes[result] : None;
+                    }
+                }
+            }
+        }
+
+        size_t Size() const noexcept { return m_nodes.size(); }
+        const Node& At(size_t node) const noexcept { return m_nodes[node]; }
+
+        size_t Find(size_t area, size_t zoneId) const noexcept
+        {
+            auto it = m_index.find(Key(area, zoneId));
+            return it != m_index.end() ? it->second : None;
+        }
+
+        // Nearest zone of the same work area, None if there is none in that direction
+        size_t Neighbor(size_t node, Direction direction) const noexcept
+        {
+            return m_links[node].neighbor[Index(direction)];
+        }
+
+        // Nearest zone of the other work areas or, when there is none in that direction,
+        // the first zone from the opposite side of the desktop
+        size_t NextAcrossAreas(size_t node, Direction direction) const noexcept
+        {
+            return m_links[node].acrossAreas[Index(direction)];
+        }
+
+    private:
+        struct Links
+        {
+            std::array<size_t, 4> neighbor{ None, None, None, None };
+            std::array<size_t, 4> acrossAreas{ None, None, None, None };
+        };
+
+        static constexpr size_t Index(Direction direction) noexcept { return static_cast<size_t>(direction); }
+        static constexpr uint64_t Key(size_t area, size_t zoneId) noexcept { return (static_cast<uint64_t>(area) << 32) | static_cast<uint32_t>(zoneId); }
+
+        std::vector<Node> m_nodes;
+        std::vector<Links> m_links;
+        std::unordered_map<uint64_t, size_t> m_index;
+    };
+}
@@ -0,0 +1,163 @@
+#include "pch.h"
+#include "ProcessCache.h"
+
+#include "ExcludedAppsMatcher.h"
+
+#include <common/utils/process_path.h>
+
+// Non-Localizable strings
+namespace NonLocalizable
+{
+    const wchar_t ApplicationFrameHost[] = L"ApplicationFrameHost.exe";
+    const wchar_t PowerToysAppPowerLauncher[] = L"POWERLAUNCHER.EXE";
+    const wchar_t PowerToysAppFZEditor[] = L"FANCYZONESEDITOR.EXE";
+}
+
+namespace
+{
+    std::wstring ToUpper(std::wstring str)
+    {
+        CharUpperBuffW(str.data(), static_cast<DWORD>(str.length()));
+        return str;
+    }
+
+    bool IsExcludedPath(const std::wstring& upperPath, const ExcludedAppsMatcher& excludedApps)
+    {
+        static const ExcludedAppsMatcher powerToysApps({ NonLocalizable::PowerToysAppPowerLauncher, NonLocalizable::PowerToysAppFZEditor });
+        return excludedApps.Matches(upperPath) || powerToysApps.Matches(upperPath);
+    }
+}
+
+ProcessCache& ProcessCacheInstance()
+{
+    static ProcessCache instance;
+    return instance;
+}
+
+std::wstring ProcessCache::GetProcessPath(HWND window)
+{
+    DWORD processId = 0;
+    GetWindowThreadProcessId(window, &processId);
+
+    std::unique_lock lock{ m_lock };
+    if (auto entry = Find(processId, lock); entry && !entry->frameHost)
+    {
+        return entry->path;
+    }
+
+    lock.unlock();
+    return get_process_path(window);
+}
+
+bool ProcessCache::IsExcluded(HWND window, const ExcludedAppsMatcher& excludedApps)
+{
+    DWORD processId = 0;
+    GetWindowThreadProcessId(window, &processId);
+
+    std::unique_lock lock{ m_lock };
+    if (auto entry = Find(processId, lock); entry && !entry->frameHost)
+    {
+        if (entry->verdictGeneration != excludedApps.Generation())
+        {
+            entry->excluded = IsExcludedPath(entry->upperPath, excludedApps);
+            entry->verdictGeneration = excludedApps.Generation();
+        }
+        return entry->excluded;
+    }
+
+    lock.unlock();
+    return IsExcludedPath(ToUpper(get_process_path(window)), excludedApps);
+}
+
+void ProcessCache::Clear()
+{
+    std::unordered_map<DWORD, Entry> entries;
+    {
+        std::scoped_lock lock{ m_lock };
+        entries.swap(m_entries);
+    }
+
+    for (auto& [processId, entry] : entries)
+    {
+        // Waits for a running exit callback, which won't find the entry anymore and leaves the handle to us
+        UnregisterWaitEx(entry.wait, INVALID_HANDLE_VALUE);
+        CloseHandle(entry.process);
+    }
+}
+
+// Returns the entry for the process, querying it if it's not cached yet. The lock is released while the
+// process is queried. Returns nullptr if the process can't be opened, such processes are not cached.
+ProcessCache::Entry* ProcessCache::Find(DWORD processId, std::unique_lock<std::mutex>& lock)
+{
+    if (auto it = m_entries.find(processId); it != m_entries.end())
+    {
+        return &it->second;
+    }
+
+    lock.unlock();
+    Entry queried = Query(processId);
+    lock.lock();
+
+    if (!queried.process)
+    {
+        return nullptr;
+    }
+
+    auto [it, inserted] = m_entries.try_emplace(processId, std::move(queried));
+    if (!inserted)
+    {
+        // Another thread queried the same process in the meantime
+        CloseHandle(queried.process);
+        return &it->second;
+    }
+
+    auto& entry = it->second;
+    if (!RegisterWaitForSingleObject(&entry.wait, entry.process, OnProcessExit, entry.process, INFINITE, WT_EXECUTEONLYONCE))
+    {
+        CloseHandle(entry.process);
+        m_entries.erase(it);
+        return nullptr;
+    }
+
+    return &entry;
+}
+
+ProcessCache::Entry ProcessCache::Query(DWORD processId)
+{
+    Entry entry;
+    entry.process = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION | SYNCHRONIZE, FALSE, processId);
+    if (!entry.process)
+    {
+        return entry;
+    }
+
+    std::wstring path(MAX_PATH, L'\0');
+    DWORD length = static_cast<DWORD>(path.length());
+    if (QueryFullProcessImageNameW(entry.process, 0, path.data(), &length) == 0)
+    {
+        length = 0;
+    }
+    path.resize(length);
+
+    entry.frameHost = path.ends_with(NonLocalizable::ApplicationFrameHost);
+    entry.upperPath = ToUpper(path);
+    entry.path = std::move(path);
+    return entry;
+}
+
+void CALLBACK ProcessCache::OnProcessExit(PVOID context, BOOLEAN)
+{
+    auto& cache = ProcessCacheInstance();
+    HANDLE process = context;
+    DWORD processId = GetProcessId(process);
+
+    std::scoped_lock lock{ cache.m_lock };
+    auto it = cache.m_entries.find(processId);
+    if (it != cache.m_entries.end() && it->second.process == process)
+    {
+        // Non-blocking unregister, the wait can't be waited for from its own callback
+        UnregisterWait(it->second.wait);
+        CloseHandle(process);
+        cache.m_entries.erase(it);
+    }
+}
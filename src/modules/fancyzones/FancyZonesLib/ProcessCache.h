@@ -0,0 +1,47 @@
+#pragma once
+
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+class ExcludedAppsMatcher;
+
+// Process information used by the window event handlers, keyed by process id. A process is queried once
+// and its entry is dropped when it exits. Resolve the process before taking FancyZonesData::dataLock,
+// lookups made while holding it are then served from the cache.
+class ProcessCache
+{
+public:
+    // Executable path of the process that owns the window, resolved to the app for UWP frame windows.
+    // Empty if the process can't be queried.
+    std::wstring GetProcessPath(HWND window);
+
+    // Whether the window's process is excluded from zoning by the user or is a PowerToys app that must not be zoned.
+    // The verdict is cached until the excluded apps change.
+    bool IsExcluded(HWND window, const ExcludedAppsMatcher& excludedApps);
+
+    // Stops watching for process exits. Must be called before the module is unloaded.
+    void Clear();
+
+private:
+    struct Entry
+    {
+        std::wstring path;
+        std::wstring upperPath;
+        // UWP frame windows are hosted by ApplicationFrameHost, the app process has to be resolved per window
+        bool frameHost = false;
+        uint64_t verdictGeneration = 0;
+        bool excluded = false;
+        HANDLE process = nullptr;
+        HANDLE wait = nullptr;
+    };
+
+    Entry* Find(DWORD processId, std::unique_lock<std::mutex>& lock);
+    static Entry Query(DWORD processId);
+    static void CALLBACK OnProcessExit(PVOID context, BOOLEAN timedOut);
+
+    std::mutex m_lock;
+    std::unordered_map<DWORD, Entry> m_entries;
+};
+
+ProcessCache& ProcessCacheInstance();
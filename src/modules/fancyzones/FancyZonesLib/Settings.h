@@ -2,10 +2,13 @@
 
 #include <common/SettingsAPI/settings_objects.h>
 
+#include "ExcludedAppsMatcher.h"
+
 // Zoned window properties are not localized.
 namespace ZonedWindowProperties
 {
     const wchar_t PropertyMultipleZoneID[]  = L"FancyZones_zones";
+    const wchar_t PropertyZoneRegistryToken[] = L"FancyZones_ZoneRegistryToken";
     const wchar_t PropertyRestoreSizeID[]   = L"FancyZones_RestoreSize";
     const wchar_t PropertyRestoreOriginID[] = L"FancyZones_RestoreOrigin";
 
@@ -50,6 +53,7 @@ struct Settings
     PowerToysSettings::HotkeyObject editorHotkey = PowerToysSettings::HotkeyObject::from_settings(true, false, false, true, VK_OEM_3);
     std::wstring excludedApps = L"";
     std::vector<std::wstring> excludedAppsArray;
+    ExcludedAppsMatcher excludedAppsMatcher;
 };
 
 interface __declspec(uuid("{BA4E77C4-6F44-4C5D-93D3-CBDE880495C2}")) IFancyZonesSettings : public IUnknown
@@ -0,0 +1,116 @@
+#include "pch.h"
+#include "WindowZoneRegistry.h"
+
+#include "Settings.h"
+
+WindowZoneRegistry& WindowZoneRegistryInstance()
+{
+    static WindowZoneRegistry instance;
+    return instance;
+}
+
+void WindowZoneRegistry::Stamp(HWND window, const std::vector<size_t>& indexSet)
+{
+    ZoneIndexBitset zones(indexSet);
+    if (zones.Empty())
+    {
+        Unstamp(window);
+        return;
+    }
+
+    // Zones 64 and above are only known to the registry
+    uint64_t bitmask = 0;
+    for (size_t index : indexSet)
+    {
+        if (index < 64)
+        {
+            bitmask |= 1ull << index;
+        }
+    }
+
+    std::scoped_lock lock{ m_lock };
+    const size_t token = m_nextToken++;
+    m_entries[window] = Entry{ token, zones.ToRuns() };
+
+    SetProp(window, ZonedWindowProperties::PropertyMultipleZoneID, reinterpret_cast<HANDLE>(static_cast<size_t>(bitmask)));
+    SetProp(window, ZonedWindowProperties::PropertyZoneRegistryToken, reinterpret_cast<HANDLE>(token));
+    PruneIfGrown();
+}
+
+void WindowZoneRegistry::Unstamp(HWND window)
+{
+    {
+        std::scoped_lock lock{ m_lock };
+        m_entries.erase(window);
+    }
+
+    ::RemoveProp(window, ZonedWindowProperties::PropertyMultipleZoneID);
+    ::RemoveProp(window, ZonedWindowProperties::PropertyZoneRegistryToken);
+}
+
+ZoneIndexBitset WindowZoneRegistry::GetZones(HWND window)
+{
+    {
+        std::scoped_lock lock{ m_lock };
+        if (auto it = Find(window); it != m_entries.end())
+        {
+            return ZoneIndexBitset::FromRuns(it->second.runs);
+        }
+    }
+
+    return ZoneIndexBitset::FromBitmask(reinterpret_cast<size_t>(::GetProp(window, ZonedWindowProperties::PropertyMultipleZoneID)));
+}
+
+bool WindowZoneRegistry::IsZoned(HWND window)
+{
+    {
+        std::scoped_lock lock{ m_lock };
+        if (Find(window) != m_entries.end())
+        {
+            return true;
+        }
+    }
+
+    return ::GetProp(window, ZonedWindowProperties::PropertyMultipleZoneID) != nullptr;
+}
+
+void WindowZoneRegistry::Clear()
+{
+    std::scoped_lock lock{ m_lock };
+    m_entries.clear();
+    m_pruneAt = MinPruneSize;
+}
+
+size_t WindowZoneRegistry::EntryCount()
+{
+    std::scoped_lock lock{ m_lock };
+    return m_entries.size();
+}
+
+bool WindowZoneRegistry::IsStale(HWND window, const Entry& entry)
+{
+    // Destroyed windows have no properties left
+    return reinterpret_cast<size_t>(::GetProp(window, ZonedWindowProperties::PropertyZoneRegistryToken)) != entry.token;
+}
+
+std::unordered_map<HWND, WindowZoneRegistry::Entry>::iterator WindowZoneRegistry::Find(HWND window)
+{
+    auto it = m_entries.find(window);
+    if (it != m_entries.end() && IsStale(window, it->second))
+    {
+        m_entries.erase(it);
+        return m_entries.end();
+    }
+    return it;
+}
+
+void WindowZoneRegistry::PruneIfGrown()
+{
+    if (m_entries.size() < m_pruneAt)
+    {
+        return;
+    }
+
+    std::erase_if(m_entries, [](const auto& entry) { return IsStale(entry.first, entry.second); });
+    m_pruneAt = std::max(MinPruneSize, 2 * m_entries.size());
+}
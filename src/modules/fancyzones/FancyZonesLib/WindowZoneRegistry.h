@@ -0,0 +1,55 @@
+#pragma once
+
+#include "ZoneIndexBitset.h"
+
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+// Zones each window has been snapped to, without a limit on the zone index.
+//
+// Windows are still stamped with the PropertyMultipleZoneID bitmask of their zones below 64, it's what
+// a restarted FancyZones finds on the windows it zoned before and it's used when the registry has no entry.
+// A second property holds the token of the window's entry: the properties go away with the window,
+// so an entry whose token doesn't match is left over from a destroyed window whose handle got reused.
+// Such entries are dropped when they're looked up, and all at once whenever the registry doubled in size,
+// so it stays proportional to the number of windows that are still zoned.
+class WindowZoneRegistry
+{
+public:
+    void Stamp(HWND window, const std::vector<size_t>& indexSet);
+    void Unstamp(HWND window);
+
+    // Empty if the window isn't zoned
+    ZoneIndexBitset GetZones(HWND window);
+    bool IsZoned(HWND window);
+
+    void Clear();
+
+    // Includes the entries of destroyed windows that haven't been dropped yet
+    size_t EntryCount();
+
+private:
+    struct Entry
+    {
+        size_t token;
+        std::vector<ZoneIndexBitset::Run> runs;
+    };
+
+    static bool IsStale(HWND window, const Entry& entry);
+
+    // Entry of the window, or end() after dropping a stale one. Called with m_lock held.
+    std::unordered_map<HWND, Entry>::iterator Find(HWND window);
+
+    // Drops the stale entries once the registry doubled in size since the last time. Called with m_lock held.
+    void PruneIfGrown();
+
+    std::mutex m_lock;
+    std::unordered_map<HWND, Entry> m_entries;
+    size_t m_nextToken = 1;
+    size_t m_pruneAt = MinPruneSize;
+
+    static constexpr size_t MinPruneSize = 64;
+};
+
+WindowZoneRegistry& WindowZoneRegistryInstance();
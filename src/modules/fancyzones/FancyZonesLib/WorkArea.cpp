@@ -118,6 +118,8 @@ public:
     MoveWindowIntoZoneByIndex(HWND window, size_t index) noexcept;
     IFACEMETHODIMP_(void)
     MoveWindowIntoZoneByIndexSet(HWND window, const std::vector<size_t>& indexSet) noexcept;
+    IFACEMETHODIMP_(std::optional<RECT>)
+    AssignWindowToZoneByIndexSet(HWND window, const std::vector<size_t>& indexSet) noexcept;
     IFACEMETHODIMP_(bool)
     MoveWindowIntoZoneByDirectionAndIndex(HWND window, DWORD vkCode, bool cycle) noexcept;
     IFACEMETHODIMP_(bool)
@@ -319,6 +321,17 @@ WorkArea::MoveWindowIntoZoneByIndexSet(HWND window, const std::vector<size_t>& i
     }
 }
 
+IFACEMETHODIMP_(std::optional<RECT>)
+WorkArea::AssignWindowToZoneByIndexSet(HWND window, const std::vector<size_t>& indexSet) noexcept
+{
+    if (m_activeZoneSet)
+    {
+        return m_activeZoneSet->AssignWindowToZoneByIndexSet(window, m_window, indexSet);
+    }
+
+    return std::nullopt;
+}
+
 IFACEMETHODIMP_(bool)
 WorkArea::MoveWindowIntoZoneByDirectionAndIndex(HWND window, DWORD vkCode, bool cycle) noexcept
 {
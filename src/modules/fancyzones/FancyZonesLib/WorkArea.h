@@ -52,6 +52,15 @@ interface __declspec(uuid("{7F017528-8110-4FB3-BE41-F472969C2560}")) IWorkArea :
      * @param   indexSet The set of zone indices within zone layout.
      */
     IFACEMETHOD_(void, MoveWindowIntoZoneByIndexSet)(HWND window, const std::vector<size_t>& indexSet) = 0;
+    /**
+     * Assign window to the zones based on the set of zone indices inside zone layout, without moving it.
+     *
+     * @param   window   Handle of the window which should be assigned to zone.
+     * @param   indexSet The set of zone indices within zone layout.
+     *
+     * @returns Rectangle in screen coordinates the window should be moved to, empty if none of the zones exist.
+     */
+    IFACEMETHOD_(std::optional<RECT>, AssignWindowToZoneByIndexSet)(HWND window, const std::vector<size_t>& indexSet) = 0;
     /**
      * Assign window to the zone based on direction (using WIN + LEFT/RIGHT arrow), based on zone index numbers,
      * not their on-screen position.
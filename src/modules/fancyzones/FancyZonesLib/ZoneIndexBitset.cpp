@@ -0,0 +1,137 @@
+#include "pch.h"
+#include "ZoneIndexBitset.h"
+
+#include <bit>
+
+namespace
+{
+    constexpr size_t WordBits = 64;
+}
+
+ZoneIndexBitset::ZoneIndexBitset(const std::vector<size_t>& indexSet)
+{
+    for (size_t index : indexSet)
+    {
+        Set(index);
+    }
+}
+
+ZoneIndexBitset ZoneIndexBitset::FromBitmask(uint64_t bitmask)
+{
+    ZoneIndexBitset bitset;
+    if (bitmask != 0)
+    {
+        bitset.m_words.push_back(bitmask);
+    }
+    return bitset;
+}
+
+ZoneIndexBitset ZoneIndexBitset::FromRuns(const std::vector<Run>& runs)
+{
+    ZoneIndexBitset bitset;
+    for (const auto& [first, length] : runs)
+    {
+        bitset.SetRange(first, length);
+    }
+    return bitset;
+}
+
+void ZoneIndexBitset::Set(size_t index)
+{
+    SetRange(index, 1);
+}
+
+void ZoneIndexBitset::SetRange(size_t first, size_t count)
+{
+    if (count == 0)
+    {
+        return;
+    }
+
+    const size_t last = first + count - 1;
+    if (m_words.size() <= last / WordBits)
+    {
+        m_words.resize(last / WordBits + 1);
+    }
+
+    for (size_t word = first / WordBits; word <= last / WordBits; word++)
+    {
+        const size_t from = word == first / WordBits ? first % WordBits : 0;
+        const size_t to = word == last / WordBits ? last % WordBits : WordBits - 1;
+        const uint64_t upper = to == WordBits - 1 ? ~0ull : (1ull << (to + 1)) - 1;
+        m_words[word] |= upper & ~((1ull << from) - 1);
+    }
+}
+
+bool ZoneIndexBitset::Test(size_t index) const noexcept
+{
+    const size_t word = index / WordBits;
+    return word < m_words.size() && (m_words[word] >> (index % WordBits)) & 1;
+}
+
+size_t ZoneIndexBitset::Count() const noexcept
+{
+    size_t count = 0;
+    for (uint64_t word : m_words)
+    {
+        count += std::popcount(word);
+    }
+    return count;
+}
+
+std::vector<size_t> ZoneIndexBitset::ToIndexSet() const
+{
+    std::vector<size_t> indexSet;
+    indexSet.reserve(Count());
+    for (size_t word = 0; word < m_words.size(); word++)
+    {
+        for (uint64_t bits = m_words[word]; bits != 0; bits &= bits - 1)
+        {
+            indexSet.push_back(word * WordBits + std::countr_zero(bits));
+        }
+    }
+    return indexSet;
+}
+
+std::vector<ZoneIndexBitset::Run> ZoneIndexBitset::ToRuns() const
+{
+    std::vector<Run> runs;
+    size_t index = 0;
+    const size_t end = m_words.size() * WordBits;
+    while (index < end)
+    {
+        // Skip to the next set bit, then to the next clear one, a word at a time
+        const size_t word = index / WordBits;
+        const uint64_t set = m_words[word] >> (index % WordBits);
+        if (set == 0)
+        {
+            index = (word + 1) * WordBits;
+            continue;
+        }
+
+        index += std::countr_zero(set);
+        const size_t first = index;
+        while (index < end)
+        {
+            const uint64_t clear = ~m_words[index / WordBits] >> (index % WordBits);
+            const size_t ones = clear == 0 ? WordBits - index % WordBits : std::countr_zero(clear);
+            index += ones;
+            if (clear != 0)
+            {
+                break;
+            }
+        }
+
+        runs.emplace_back(static_cast<uint32_t>(first), static_cast<uint32_t>(index - first));
+    }
+    return runs;
+}
+
+std::optional<uint64_t> ZoneIndexBitset::ToBitmask() const noexcept
+{
+    if (m_words.size() > 1)
+    {
+        return std::nullopt;
+    }
+    return m_words.empty() ? 0 : m_words[0];
+}
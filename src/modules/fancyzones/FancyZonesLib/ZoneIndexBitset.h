@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <vector>
+
+// Set of zone indices without an upper bound, unlike the 64-bit bitmask windows used to be stamped with.
+// Stored as a dynamic bitset, and encoded as runs of consecutive indices when kept per window:
+// a window spanning zones 10 to 200 of a 256 zone layout is a single run.
+class ZoneIndexBitset
+{
+public:
+    // First index and length of a run of consecutive indices
+    using Run = std::pair<uint32_t, uint32_t>;
+
+    ZoneIndexBitset() = default;
+    explicit ZoneIndexBitset(const std::vector<size_t>& indexSet);
+
+    static ZoneIndexBitset FromBitmask(uint64_t bitmask);
+    static ZoneIndexBitset FromRuns(const std::vector<Run>& runs);
+
+    void Set(size_t index);
+    bool Test(size_t index) const noexcept;
+    bool Empty() const noexcept { return m_words.empty(); }
+    size_t Count() const noexcept;
+
+    // Indices in ascending order
+    std::vector<size_t> ToIndexSet() const;
+    std::vector<Run> ToRuns() const;
+
+    // Indices below 64 as a bitmask, nullopt if the set holds any other index
+    std::optional<uint64_t> ToBitmask() const noexcept;
+
+    bool operator==(const ZoneIndexBitset& other) const noexcept = default;
+
+private:
+    void SetRange(size_t first, size_t count);
+
+    // No trailing zero words, so equal sets compare equal
+    std::vector<uint64_t> m_words;
+};
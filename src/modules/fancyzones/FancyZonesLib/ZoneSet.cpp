@@ -5,13 +5,14 @@
 #include "FancyZonesData.h"
 #include "FancyZonesDataTypes.h"
 #include "Settings.h"
+#include "LayoutEngine.h"
 #include "Zone.h"
 #include "util.h"
+#include "WindowZoneRegistry.h"
 
 #include <common/logger/logger.h>
 #include <common/display/dpi_aware.h>
 
-#include <limits>
 #include <map>
 #include <utility>
 
@@ -19,94 +20,7 @@ using namespace FancyZonesUtils;
 
 namespace
 {
-    constexpr int C_MULTIPLIER = 10000;
     constexpr int OVERLAPPING_CENTERS_SENSITIVITY = 75;
-
-    // PriorityGrid layout is unique for zoneCount <= 11. For zoneCount > 11 PriorityGrid is same as Grid
-    FancyZonesDataTypes::GridLayoutInfo predefinedPriorityGridLayouts[11] = {
-        /* 1 */
-        FancyZonesDataTypes::GridLayoutInfo(FancyZonesDataTypes::GridLayoutInfo::Full{
-            .rows = 1,
-            .columns = 1,
-            .rowsPercents = { 10000 },
-            .columnsPercents = { 10000 },
-            .cellChildMap = { { 0 } } }),
-        /* 2 */
-        FancyZonesDataTypes::GridLayoutInfo(FancyZonesDataTypes::GridLayoutInfo::Full{
-            .rows = 1,
-            .columns = 2,
-            .rowsPercents = { 10000 },
-            .columnsPercents = { 6667, 3333 },
-            .cellChildMap = { { 0, 1 } } }),
-        /* 3 */
-        FancyZonesDataTypes::GridLayoutInfo(FancyZonesDataTypes::GridLayoutInfo::Full{
-            .rows = 1,
-            .columns = 3,
-            .rowsPercents = { 10000 },
-            .columnsPercents = { 2500, 5000, 2500 },
-            .cellChildMap = { { 0, 1, 2 } } }),
-        /* 4 */
-        FancyZonesDataTypes::GridLayoutInfo(FancyZonesDataTypes::GridLayoutInfo::Full{
-            .rows = 2,
-            .columns = 3,
-            .rowsPercents = { 5000, 5000 },
-            .columnsPercents = { 2500, 5000, 2500 },
-            .cellChildMap = { { 0, 1, 2 }, { 0, 1, 3 } } }),
-        /* 5 */
-        FancyZonesDataTypes::GridLayoutInfo(FancyZonesDataTypes::GridLayoutInfo::Full{
-            .rows = 2,
-            .columns = 3,
-            .rowsPercents = { 5000, 5000 },
-            .columnsPercents = { 2500, 5000, 2500 },
-            .cellChildMap = { { 0, 1, 2 }, { 3, 1, 4 } } }),
-        /* 6 */
-        FancyZonesDataTypes::GridLayoutInfo(FancyZonesDataTypes::GridLayoutInfo::Full{
-            .rows = 3,
-            .columns = 3,
-            .rowsPercents = { 3333, 3334, 3333 },
-            .columnsPercents = { 2500, 5000, 2500 },
-            .cellChildMap = { { 0, 1, 2 }, { 0, 1, 3 }, { 4, 1, 5 } } }),
-        /* 7 */
-        FancyZonesDataTypes::GridLayoutInfo(FancyZonesDataTypes::GridLayoutInfo::Full{
-            .rows = 3,
-            .columns = 3,
-            .rowsPercents = { 3333, 3334, 3333 },
-            .columnsPercents = { 2500, 5000, 2500 },
-            .cellChildMap = { { 0, 1, 2 }, { 3, 1, 4 }, { 5, 1, 6 } } }),
-        /* 8 */
-        FancyZonesDataTypes::GridLayoutInfo(FancyZonesDataTypes::GridLayoutInfo::Full{
-            .rows = 3,
-            .columns = 4,
-            .rowsPercents = { 3333, 3334, 3333 },
-            .columnsPercents = { 2500, 2500, 2500, 2500 },
-            .cellChildMap = { { 0, 1, 2, 3 }, { 4, 1, 2, 5 }, { 6, 1, 2, 7 } } }),
-        /* 9 */
-        FancyZonesDataTypes::GridLayoutInfo(FancyZonesDataTypes::GridLayoutInfo::Full{
-            .rows = 3,
-            .columns = 4,
-            .rowsPercents = { 3333, 3334, 3333 },
-            .columnsPercents = { 2500, 2500, 2500, 2500 },
-            .cellChildMap = { { 0, 1, 2, 3 }, { 4, 1, 2, 5 }, { 6, 1, 7, 8 } } }),
-        /* 10 */
-        FancyZonesDataTypes::GridLayoutInfo(FancyZonesDataTypes::GridLayoutInfo::Full{
-            .rows = 3,
-            .columns = 4,
-            .rowsPercents = { 3333, 3334, 3333 },
-            .columnsPercents = { 2500, 2500, 2500, 2500 },
-            .cellChildMap = { { 0, 1, 2, 3 }, { 4, 1, 5, 6 }, { 7, 1, 8, 9 } } }),
-        /* 11 */
-        FancyZonesDataTypes::GridLayoutInfo(FancyZonesDataTypes::GridLayoutInfo::Full{
-            .rows = 3,
-            .columns = 4,
-            .rowsPercents = { 3333, 3334, 3333 },
-            .columnsPercents = { 2500, 2500, 2500, 2500 },
-            .cellChildMap = { { 0, 1, 2, 3 }, { 4, 1, 5, 6 }, { 7, 8, 9, 10 } } }),
-    };
-
-    inline void StampWindow(HWND window, size_t bitmask) noexcept
-    {
-        SetProp(window, ZonedWindowProperties::PropertyMultipleZoneID, reinterpret_cast<HANDLE>(bitmask));
-    }
 }
 
 struct ZoneSet : winrt::implements<ZoneSet, IZoneSet>
@@ -138,6 +52,8 @@ public:
     MoveWindowIntoZoneByIndex(HWND window, HWND workAreaWindow, size_t index) noexcept;
     IFACEMETHODIMP_(void)
     MoveWindowIntoZoneByIndexSet(HWND window, HWND workAreaWindow, const std::vector<size_t>& indexSet) noexcept;
+    IFACEMETHODIMP_(std::optional<RECT>)
+    AssignWindowToZoneByIndexSet(HWND window, HWND workAreaWindow, const std::vector<size_t>& indexSet) noexcept;
     IFACEMETHODIMP_(bool)
     MoveWindowIntoZoneByDirectionAndIndex(HWND window, HWND workAreaWindow, DWORD vkCode, bool cycle) noexcept;
     IFACEMETHODIMP_(bool)
@@ -154,12 +70,9 @@ public:
     GetCombinedZoneRange(const std::vector<size_t>& initialZones, const std::vector<size_t>& finalZones) const noexcept;
 
 private:
-    bool CalculateFocusLayout(Rect workArea, int zoneCount) noexcept;
-    bool CalculateColumnsAndRowsLayout(Rect workArea, FancyZonesDataTypes::ZoneSetLayoutType type, int zoneCount, int spacing) noexcept;
-    bool CalculateGridLayout(Rect workArea, FancyZonesDataTypes::ZoneSetLayoutType type, int zoneCount, int spacing) noexcept;
-    bool CalculateUniquePriorityGridLayout(Rect workArea, int zoneCount, int spacing) noexcept;
-    bool CalculateCustomLayout(Rect workArea, int spacing) noexcept;
-    bool CalculateGridZones(Rect workArea, FancyZonesDataTypes::GridLayoutInfo gridLayoutInfo, int spacing);
+    bool CalculateCustomLayout(const LayoutEngine::Rect& workArea, int spacing) noexcept;
+    bool AddZones(const LayoutEngine::Zones& zones) noexcept;
+    const LayoutEngine::ZoneGraph& Graph() noexcept;
     std::vector<size_t> ZoneSelectSubregion(const std::vector<size_t>& capturedZones, POINT pt) const;
     std::vector<size_t> ZoneSelectClosestCenter(const std::vector<size_t>& capturedZones, POINT pt) const;
 
@@ -170,6 +83,9 @@ private:
     ZonesMap m_zones;
     std::map<HWND, std::vector<size_t>> m_windowIndexSet;
 
+    // Directional neighbors of the zones, built on first use
+    std::optional<LayoutEngine::ZoneGraph> m_graph;
+
     // Needed for ExtendWindowByDirectionAndPosition
     std::map<HWND, std::vector<size_t>> m_windowInitialIndexSet;
     std::map<HWND, size_t> m_windowFinalIndex;
@@ -186,6 +102,7 @@ IFACEMETHODIMP ZoneSet::AddZone(winrt::com_ptr<IZone> zone) noexcept
         return S_FALSE;
     }
     m_zones[zoneId] = zone;
+    m_graph.reset();
 
     return S_OK;
 }
@@ -299,10 +216,19 @@ ZoneSet::MoveWindowIntoZoneByIndex(HWND window, HWND workAreaWindow, size_t inde
 
 IFACEMETHODIMP_(void)
 ZoneSet::MoveWindowIntoZoneByIndexSet(HWND window, HWND workAreaWindow, const std::vector<size_t>& zoneIds) noexcept
+{
+    if (auto size = AssignWindowToZoneByIndexSet(window, workAreaWindow, zoneIds))
+    {
+        SizeWindowToRect(window, *size);
+    }
+}
+
+IFACEMETHODIMP_(std::optional<RECT>)
+ZoneSet::AssignWindowToZoneByIndexSet(HWND window, HWND workAreaWindow, const std::vector<size_t>& zoneIds) noexcept
 {
     if (m_zones.empty())
     {
-        return;
+        return std::nullopt;
     }
 
     // Always clear the info related to SelectManyZones if it's not being used
@@ -314,7 +240,6 @@ ZoneSet::MoveWindowIntoZoneByIndexSet(HWND window, HWND workAreaWindow, const st
 
     RECT size;
     bool sizeEmpty = true;
-    size_t bitmask = 0;
 
     m_windowIndexSet[window] = {};
 
@@ -339,19 +264,16 @@ ZoneSet::MoveWindowIntoZoneByIndexSet(HWND window, HWND workAreaWindow, const st
 
             m_windowIndexSet[window].push_back(id);
         }
-
-        if (id < std::numeric_limits<size_t>::digits)
-        {
-            bitmask |= 1ull << id;
-        }
     }
 
-    if (!sizeEmpty)
+    if (sizeEmpty)
     {
-        SaveWindowSizeAndOrigin(window);
-        SizeWindowToRect(window, size);
-        StampWindow(window, bitmask);
+        return std::nullopt;
     }
+
+    SaveWindowSizeAndOrigin(window);
+    WindowZoneRegistryInstance().Stamp(window, m_windowIndexSet[window]);
+    return size;
 }
 
 IFACEMETHODIMP_(bool)
@@ -474,20 +396,28 @@ ZoneSet::ExtendWindowByDirectionAndPosition(HWND window, HWND workAreaWindow, DW
     if (GetWindowRect(window, &windowRect) && GetWindowRect(workAreaWindow, &windowZoneRect))
     {
         auto oldZones = GetZoneIndexSetFromWindow(window);
-        std::vector<bool> usedZoneIndices(m_zones.size(), false);
-        std::vector<RECT> zoneRects;
-        std::vector<size_t> freeZoneIndices;
+        std::optional<size_t> nextZone;
 
         // If selectManyZones = true for the second time, use the last zone into which we moved
         // instead of the window rect and enable moving to all zones except the old one
         auto finalIndexIt = m_windowFinalIndex.find(window);
         if (finalIndexIt != m_windowFinalIndex.end())
         {
-            usedZoneIndices[finalIndexIt->second] = true;
-            windowRect = m_zones[finalIndexIt->second]->GetZoneRect();
+            const auto direction = DirectionFromVkCode(vkCode);
+            const auto& graph = Graph();
+            const size_t node = graph.Find(0, finalIndexIt->second);
+            const size_t next = direction && node != LayoutEngine::ZoneGraph::None ? graph.Neighbor(node, *direction) : LayoutEngine::ZoneGraph::None;
+            if (next != LayoutEngine::ZoneGraph::None)
+            {
+                nextZone = graph.At(next).zoneId;
+            }
         }
         else
         {
+            std::vector<bool> usedZoneIndices(m_zones.size(), false);
+            std::vector<RECT> zoneRects;
+            std::vector<size_t> freeZoneIndices;
+
             for (size_t idx : oldZones)
             {
                 usedZoneIndices[idx] = true;
@@ -497,21 +427,26 @@ ZoneSet::ExtendWindowByDirectionAndPosition(HWND window, HWND workAreaWindow, DW
             windowRect.bottom -= windowZoneRect.top;
             windowRect.left -= windowZoneRect.left;
             windowRect.right -= windowZoneRect.left;
-        }
 
-        for (size_t i = 0; i < m_zones.size(); i++)
-        {
-            if (!usedZoneIndices[i])
+            for (size_t i = 0; i < m_zones.size(); i++)
             {
-                zoneRects.emplace_back(m_zones[i]->GetZoneRect());
-                freeZoneIndices.emplace_back(i);
+                if (!usedZoneIndices[i])
+                {
+                    zoneRects.emplace_back(m_zones[i]->GetZoneRect());
+                    freeZoneIndices.emplace_back(i);
+                }
+            }
+
+            size_t result = FancyZonesUtils::ChooseNextZoneByPosition(vkCode, windowRect, zoneRects);
+            if (result < zoneRects.size())
+            {
+                nextZone = freeZoneIndices[result];
             }
         }
 
-        size_t result = FancyZonesUtils::ChooseNextZoneByPosition(vkCode, windowRect, zoneRects);
-        if (result < zoneRects.size())
+        if (nextZone)
         {
-            size_t targetZone = freeZoneIndices[result];
+            size_t targetZone = *nextZone;
             std::vector<size_t> resultIndexSet;
 
             // First time with selectManyZones = true for this window?
@@ -558,7 +493,7 @@ ZoneSet::MoveWindowIntoZoneByPoint(HWND window, HWND workAreaWindow, POINT ptCli
 IFACEMETHODIMP_(bool)
 ZoneSet::CalculateZones(RECT workAreaRect, int zoneCount, int spacing) noexcept
 {
-    Rect workArea(workAreaRect);
+    const LayoutEngine::Rect workArea{ workAreaRect.left, workAreaRect.top, workAreaRect.right, workAreaRect.bottom };
     //invalid work area
     if (workArea.width() == 0 || workArea.height() == 0)
     {
@@ -571,26 +506,21 @@ ZoneSet::CalculateZones(RECT workAreaRect, int zoneCount, int spacing) noexcept
         return false;
     }
 
-    bool success = true;
     switch (m_config.LayoutType)
     {
     case FancyZonesDataTypes::ZoneSetLayoutType::Focus:
-        success = CalculateFocusLayout(workArea, zoneCount);
-        break;
+        return AddZones(LayoutEngine::CalculateFocusLayout(workArea, zoneCount));
     case FancyZonesDataTypes::ZoneSetLayoutType::Columns:
     case FancyZonesDataTypes::ZoneSetLayoutType::Rows:
-        success = CalculateColumnsAndRowsLayout(workArea, m_config.LayoutType, zoneCount, spacing);
-        break;
+        return AddZones(LayoutEngine::CalculateColumnsAndRowsLayout(workArea, m_config.LayoutType == FancyZonesDataTypes::ZoneSetLayoutType::Columns, zoneCount, spacing));
     case FancyZonesDataTypes::ZoneSetLayoutType::Grid:
     case FancyZonesDataTypes::ZoneSetLayoutType::PriorityGrid:
-        success = CalculateGridLayout(workArea, m_config.LayoutType, zoneCount, spacing);
-        break;
+        return AddZones(LayoutEngine::CalculateGridLayout(workArea, m_config.LayoutType == FancyZonesDataTypes::ZoneSetLayoutType::PriorityGrid, zoneCount, spacing));
     case FancyZonesDataTypes::ZoneSetLayoutType::Custom:
-        success = CalculateCustomLayout(workArea, spacing);
-        break;
+        return CalculateCustomLayout(workArea, spacing);
     }
 
-    return success;
+    return true;
 }
 
 bool ZoneSet::IsZoneEmpty(int zoneIndex) const noexcept
@@ -606,78 +536,29 @@ bool ZoneSet::IsZoneEmpty(int zoneIndex) const noexcept
     return true;
 }
 
-bool ZoneSet::CalculateFocusLayout(Rect workArea, int zoneCount) noexcept
+const LayoutEngine::ZoneGraph& ZoneSet::Graph() noexcept
 {
-    long left{ 100 };
-    long top{ 100 };
-    long right{ left + long(workArea.width() * 0.4) };
-    long bottom{ top + long(workArea.height() * 0.4) };
-
-    RECT focusZoneRect{ left, top, right, bottom };
-
-    long focusRectXIncrement = (zoneCount <= 1) ? 0 : 50;
-    long focusRectYIncrement = (zoneCount <= 1) ? 0 : 50;
-
-    for (int i = 0; i < zoneCount; i++)
+    if (!m_graph)
     {
-        auto zone = MakeZone(focusZoneRect, m_zones.size());
-        if (zone)
-        {
-            AddZone(zone);
-        }
-        else
+        std::vector<LayoutEngine::ZoneGraph::Node> nodes;
+        nodes.reserve(m_zones.size());
+        for (const auto& [zoneId, zone] : m_zones)
         {
-            // All zones within zone set should be valid in order to use its functionality.
-            m_zones.clear();
-            return false;
+            const RECT rect = zone->GetZoneRect();
+            nodes.push_back({ .area = 0, .zoneId = zoneId, .rect = { rect.left, rect.top, rect.right, rect.bottom } });
         }
-        focusZoneRect.left += focusRectXIncrement;
-        focusZoneRect.right += focusRectXIncrement;
-        focusZoneRect.bottom += focusRectYIncrement;
-        focusZoneRect.top += focusRectYIncrement;
+
+        m_graph.emplace(std::move(nodes), std::vector<LayoutEngine::Rect>{});
     }
 
-    return true;
+    return *m_graph;
 }
 
-bool ZoneSet::CalculateColumnsAndRowsLayout(Rect workArea, FancyZonesDataTypes::ZoneSetLayoutType type, int zoneCount, int spacing) noexcept
+bool ZoneSet::AddZones(const LayoutEngine::Zones& zones) noexcept
 {
-    long totalWidth;
-    long totalHeight;
-
-    if (type == FancyZonesDataTypes::ZoneSetLayoutType::Columns)
+    for (const auto& [id, rect] : zones)
     {
-        totalWidth = workArea.width() - (spacing * (zoneCount + 1));
-        totalHeight = workArea.height() - (spacing * 2);
-    }
-    else
-    { //Rows
-        totalWidth = workArea.width() - (spacing * 2);
-        totalHeight = workArea.height() - (spacing * (zoneCount + 1));
-    }
-
-    long top = spacing;
-    long left = spacing;
-    long bottom;
-    long right;
-
-    // Note: The expressions below are NOT equal to total{Width|Height} / zoneCount and are done
-    // like this to make the sum of all zones' sizes exactly total{Width|Height}.
-    for (int zoneIndex = 0; zoneIndex < zoneCount; ++zoneIndex)
-    {
-        if (type == FancyZonesDataTypes::ZoneSetLayoutType::Columns)
-        {
-            right = left + (zoneIndex + 1) * totalWidth / zoneCount - zoneIndex * totalWidth / zoneCount;
-            bottom = totalHeight + spacing;
-        }
-        else
-        { //Rows
-            right = totalWidth + spacing;
-            bottom = top + (zoneIndex + 1) * totalHeight / zoneCount - zoneIndex * totalHeight / zoneCount;
-        }
-
-
-        auto zone = MakeZone(RECT{ left, top, right, bottom }, m_zones.size());
+        auto zone = MakeZone(RECT{ rect.left, rect.top, rect.right, rect.bottom }, id);
         if (zone)
         {
             AddZone(zone);
@@ -686,90 +567,15 @@ bool ZoneSet::CalculateColumnsAndRowsLayout(Rect workArea, FancyZonesDataTypes::
         {
             // All zones within zone set should be valid in order to use its functionality.
             m_zones.clear();
+            m_graph.reset();
             return false;
         }
-
-        if (type == FancyZonesDataTypes::ZoneSetLayoutType::Columns)
-        {
-            left = right + spacing;
-        }
-        else
-        { //Rows
-            top = bottom + spacing;
-        }
     }
 
     return true;
 }
 
-bool ZoneSet::CalculateGridLayout(Rect workArea, FancyZonesDataTypes::ZoneSetLayoutType type, int zoneCount, int spacing) noexcept
-{
-    const auto count = sizeof(predefinedPriorityGridLayouts) / sizeof(FancyZonesDataTypes::GridLayoutInfo);
-    if (type == FancyZonesDataTypes::ZoneSetLayoutType::PriorityGrid && zoneCount < count)
-    {
-        return CalculateUniquePriorityGridLayout(workArea, zoneCount, spacing);
-    }
-
-    int rows = 1, columns = 1;
-    while (zoneCount / rows >= rows)
-    {
-        rows++;
-    }
-    rows--;
-    columns = zoneCount / rows;
-    if (zoneCount % rows == 0)
-    {
-        // even grid
-    }
-    else
-    {
-        columns++;
-    }
-
-    FancyZonesDataTypes::GridLayoutInfo gridLayoutInfo(FancyZonesDataTypes::GridLayoutInfo::Minimal{ .rows = rows, .columns = columns });
-
-    // Note: The expressions below are NOT equal to C_MULTIPLIER / {rows|columns} and are done
-    // like this to make the sum of all percents exactly C_MULTIPLIER
-    for (int row = 0; row < rows; row++)
-    {
-        gridLayoutInfo.rowsPercents()[row] = C_MULTIPLIER * (row + 1) / rows - C_MULTIPLIER * row / rows;
-    }
-    for (int col = 0; col < columns; col++)
-    {
-        gridLayoutInfo.columnsPercents()[col] = C_MULTIPLIER * (col + 1) / columns - C_MULTIPLIER * col / columns;
-    }
-
-    for (int i = 0; i < rows; ++i)
-    {
-        gridLayoutInfo.cellChildMap()[i] = std::vector<int>(columns);
-    }
-
-    int index = 0;
-    for (int row = 0; row < rows; row++)
-    {
-        for (int col = 0; col < columns; col++)
-        {
-            gridLayoutInfo.cellChildMap()[row][col] = index++;
-            if (index == zoneCount)
-            {
-                index--;
-            }
-        }
-    }
-    return CalculateGridZones(workArea, gridLayoutInfo, spacing);
-}
-
-bool ZoneSet::CalculateUniquePriorityGridLayout(Rect workArea, int zoneCount, int spacing) noexcept
-{
-    if (zoneCount <= 0 || zoneCount >= sizeof(predefinedPriorityGridLayouts))
-    {
-        return false;
-    }
-
-    return CalculateGridZones(workArea, predefinedPriorityGridLayouts[zoneCount - 1], spacing);
-}
-
-bool ZoneSet::CalculateCustomLayout(Rect workArea, int spacing) noexcept
+bool ZoneSet::CalculateCustomLayout(const LayoutEngine::Rect& workArea, int spacing) noexcept
 {
     wil::unique_cotaskmem_string guidStr;
     if (SUCCEEDED(StringFromCLSID(m_config.Id, &guidStr)))
@@ -787,122 +593,38 @@ bool ZoneSet::CalculateCustomLayout(Rect workArea, int spacing) noexcept
         if (zoneSet.type == FancyZonesDataTypes::CustomLayoutType::Canvas && std::holds_alternative<FancyZonesDataTypes::CanvasLayoutInfo>(zoneSet.info))
         {
             const auto& zoneSetInfo = std::get<FancyZonesDataTypes::CanvasLayoutInfo>(zoneSet.info);
+
+            std::vector<LayoutEngine::CanvasZone> canvasZones;
+            canvasZones.reserve(zoneSetInfo.zones.size());
             for (const auto& zone : zoneSetInfo.zones)
             {
-                int x = zone.x;
-                int y = zone.y;
-                int width = zone.width;
-                int height = zone.height;
-
-                DPIAware::Convert(m_config.Monitor, x, y);
-                DPIAware::Convert(m_config.Monitor, width, height);
+                canvasZones.push_back(LayoutEngine::CanvasZone{ zone.x, zone.y, zone.width, zone.height });
+            }
 
-                auto zone = MakeZone(RECT{ x, y, x + width, y + height }, m_zones.size());
-                if (zone)
-                {
-                    AddZone(zone);
-                }
-                else
-                {
-                    // All zones within zone set should be valid in order to use its functionality.
-                    m_zones.clear();
-                    return false;
-                }
+            HMONITOR monitor = m_config.Monitor ? m_config.Monitor : MonitorFromPoint(POINT{ 0, 0 }, MONITOR_DEFAULTTOPRIMARY);
+            UINT dpi = DPIAware::DEFAULT_DPI;
+            if (FAILED(DPIAware::GetScreenDPIForMonitor(monitor, dpi)))
+            {
+                dpi = DPIAware::DEFAULT_DPI;
             }
 
-            return true;
+            return AddZones(LayoutEngine::CalculateCanvasZones(canvasZones, static_cast<int>(dpi)));
         }
         else if (zoneSet.type == FancyZonesDataTypes::CustomLayoutType::Grid && std::holds_alternative<FancyZonesDataTypes::GridLayoutInfo>(zoneSet.info))
         {
             const auto& info = std::get<FancyZonesDataTypes::GridLayoutInfo>(zoneSet.info);
-            return CalculateGridZones(workArea, info, spacing);
+            const LayoutEngine::GridLayout layout{ .rows = info.rows(),
+                                                   .columns = info.columns(),
+                                                   .rowsPercents = info.rowsPercents(),
+                                                   .columnsPercents = info.columnsPercents(),
+                                                   .cellChildMap = info.cellChildMap() };
+            return AddZones(LayoutEngine::CalculateGridZones(workArea, layout, spacing));
         }
     }
 
     return false;
 }
 
-bool ZoneSet::CalculateGridZones(Rect workArea, FancyZonesDataTypes::GridLayoutInfo gridLayoutInfo, int spacing)
-{
-    long totalWidth = workArea.width();
-    long totalHeight = workArea.height();
-    struct Info
-    {
-        long Extent;
-        long Start;
-        long End;
-    };
-    std::vector<Info> rowInfo(gridLayoutInfo.rows());
-    std::vector<Info> columnInfo(gridLayoutInfo.columns());
-
-    // Note: The expressions below are carefully written to 
-    // make the sum of all zones' sizes exactly total{Width|Height}
-    int totalPercents = 0;
-    for (int row = 0; row < gridLayoutInfo.rows(); row++)
-    {
-        rowInfo[row].Start = totalPercents * totalHeight / C_MULTIPLIER;
-        totalPercents += gridLayoutInfo.rowsPercents()[row];
-        rowInfo[row].End = totalPercents * totalHeight / C_MULTIPLIER;
-        rowInfo[row].Extent = rowInfo[row].End - rowInfo[row].Start;
-    }
-
-    totalPercents = 0;
-    for (int col = 0; col < gridLayoutInfo.columns(); col++)
-    {
-        columnInfo[col].Start = totalPercents * totalWidth / C_MULTIPLIER;
-        totalPercents += gridLayoutInfo.columnsPercents()[col];
-        columnInfo[col].End = totalPercents * totalWidth / C_MULTIPLIER;
-        columnInfo[col].Extent = columnInfo[col].End - columnInfo[col].Start;
-    }
-
-    for (int row = 0; row < gridLayoutInfo.rows(); row++)
-    {
-        for (int col = 0; col < gridLayoutInfo.columns(); col++)
-        {
-            int i = gridLayoutInfo.cellChildMap()[row][col];
-            if (((row == 0) || (gridLayoutInfo.cellChildMap()[row - 1][col] != i)) &&
-                ((col == 0) || (gridLayoutInfo.cellChildMap()[row][col - 1] != i)))
-            {
-                long left = columnInfo[col].Start;
-                long top = rowInfo[row].Start;
-
-                int maxRow = row;
-                while (((maxRow + 1) < gridLayoutInfo.rows()) && (gridLayoutInfo.cellChildMap()[maxRow + 1][col] == i))
-                {
-                    maxRow++;
-                }
-                int maxCol = col;
-                while (((maxCol + 1) < gridLayoutInfo.columns()) && (gridLayoutInfo.cellChildMap()[row][maxCol + 1] == i))
-                {
-                    maxCol++;
-                }
-
-                long right = columnInfo[maxCol].End;
-                long bottom = rowInfo[maxRow].End;
-
-                top += row == 0 ? spacing : spacing / 2;
-                bottom -= maxRow == gridLayoutInfo.rows() - 1 ? spacing : spacing / 2;
-                left += col == 0 ? spacing : spacing / 2;
-                right -= maxCol == gridLayoutInfo.columns() - 1 ? spacing : spacing / 2;
-
-                auto zone = MakeZone(RECT{ left, top, right, bottom }, i);
-                if (zone)
-                {
-                    AddZone(zone);
-                }
-                else
-                {
-                    // All zones within zone set should be valid in order to use its functionality.
-                    m_zones.clear();
-                    return false;
-                }
-            }
-        }
-    }
-
-    return true;
-}
-
 std::vector<size_t> ZoneSet::GetCombinedZoneRange(const std::vector<size_t>& initialZones, const std::vector<size_t>& finalZones) const noexcept
 {
     std::vector<size_t> combinedZones, result;
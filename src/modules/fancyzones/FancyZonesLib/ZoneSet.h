@@ -69,6 +69,19 @@ interface __declspec(uuid("{E4839EB7-669D-49CF-84A9-71A2DFD851A3}")) IZoneSet :
      */
     IFACEMETHOD_(void, MoveWindowIntoZoneByIndexSet)
     (HWND window, HWND workAreaWindow, const std::vector<size_t>& indexSet) = 0;
+    /**
+     * Assign window to the zones based on the set of zone indices inside zone layout, without moving it.
+     * Used to move several windows at once.
+     *
+     * @param   window         Handle of window which should be assigned to zone.
+     * @param   workAreaWindow The m_window of a WorkArea, it's a hidden window representing the
+     *                         current monitor desktop work area.
+     * @param   indexSet       The set of zone indices within zone layout.
+     *
+     * @returns Rectangle in screen coordinates the window should be moved to, empty if none of the zones exist.
+     */
+    IFACEMETHOD_(std::optional<RECT>, AssignWindowToZoneByIndexSet)
+    (HWND window, HWND workAreaWindow, const std::vector<size_t>& indexSet) = 0;
     /**
      * Assign window to the zone based on direction (using WIN + LEFT/RIGHT arrow), based on zone index numbers,
      * not their on-screen position.
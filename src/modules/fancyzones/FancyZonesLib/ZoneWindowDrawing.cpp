@@ -110,8 +110,103 @@ ZoneWindowDrawing::ZoneWindowDrawing(HWND window)
     m_renderThread = std::thread([this]() { RenderLoop(); });
 }
 
+size_t ZoneWindowDrawing::PrepareScene()
+{
+    // Lock is held by the caller
+
+    size_t allocations = 0;
+
+    auto writeFactory = GetWriteFactory();
+    if (!m_textFormat && writeFactory)
+    {
+        if (SUCCEEDED(writeFactory->CreateTextFormat(NonLocalizable::SegoeUiFont, nullptr, DWRITE_FONT_WEIGHT_NORMAL, DWRITE_FONT_STYLE_NORMAL, DWRITE_FONT_STRETCH_NORMAL, 80.f, L"en-US", m_textFormat.put())))
+        {
+            m_textFormat->SetTextAlignment(DWRITE_TEXT_ALIGNMENT_CENTER);
+            m_textFormat->SetParagraphAlignment(DWRITE_PARAGRAPH_ALIGNMENT_CENTER);
+            allocations++;
+        }
+    }
+
+    if (!m_textBrush)
+    {
+        if (SUCCEEDED(m_renderTarget->CreateSolidColorBrush(D2D1::ColorF(D2D1::ColorF::Black), m_textBrush.put())))
+        {
+            allocations++;
+        }
+    }
+
+    // Zones share a few colors, and most scene changes only move the highlight from a zone to another:
+    // brushes and text layouts are kept as long as the scene uses them
+    std::vector<CachedBrush> brushes;
+    std::map<size_t, CachedTextLayout> textLayouts;
+
+    auto getBrush = [&](const D2D1_COLOR_F& color) -> ID2D1SolidColorBrush* {
+        auto sameColor = [&color](const CachedBrush& cached) {
+            return cached.color.r == color.r && cached.color.g == color.g && cached.color.b == color.b && cached.color.a == color.a;
+        };
+
+        if (auto it = std::find_if(brushes.begin(), brushes.end(), sameColor); it != brushes.end())
+        {
+            return it->brush.get();
+        }
+
+        CachedBrush cached{ .color = color };
+        if (auto it = std::find_if(m_brushes.begin(), m_brushes.end(), sameColor); it != m_brushes.end())
+        {
+            cached.brush = std::move(it->brush);
+            m_brushes.erase(it);
+        }
+        else if (SUCCEEDED(m_renderTarget->CreateSolidColorBrush(color, cached.brush.put())))
+        {
+            allocations++;
+        }
+        else
+        {
+            return nullptr;
+        }
+
+        return brushes.emplace_back(std::move(cached)).brush.get();
+    };
+
+    for (auto& drawableRect : m_sceneRects)
+    {
+        drawableRect.borderBrush = getBrush(drawableRect.borderColor);
+        drawableRect.fillBrush = getBrush(drawableRect.fillColor);
+        drawableRect.textLayout = nullptr;
+
+        const float width = drawableRect.rect.right - drawableRect.rect.left;
+        const float height = drawableRect.rect.bottom - drawableRect.rect.top;
+
+        auto node = m_textLayouts.extract(drawableRect.id);
+        if (node && (node.mapped().width != width || node.mapped().height != height))
+        {
+            node = {};
+        }
+
+        if (!node && m_textFormat && writeFactory)
+        {
+            CachedTextLayout cached{ .width = width, .height = height };
+            std::wstring idStr = std::to_wstring(drawableRect.id + 1);
+            if (SUCCEEDED(writeFactory->CreateTextLayout(idStr.c_str(), (UINT32)idStr.size(), m_textFormat.get(), width, height, cached.layout.put())))
+            {
+                allocations++;
+                drawableRect.textLayout = textLayouts.emplace(drawableRect.id, std::move(cached)).first->second.layout.get();
+            }
+        }
+        else if (node)
+        {
+            drawableRect.textLayout = textLayouts.insert(std::move(node)).position->second.layout.get();
+        }
+    }
+
+    m_brushes = std::move(brushes);
+    m_textLayouts = std::move(textLayouts);
+    return allocations;
+}
+
 ZoneWindowDrawing::RenderResult ZoneWindowDrawing::Render()
 {
+    const auto frameStart = std::chrono::steady_clock::now();
     std::unique_lock lock(m_mutex);
 
     if (!m_renderTarget)
@@ -126,70 +221,70 @@ ZoneWindowDrawing::RenderResult ZoneWindowDrawing::Render()
         return RenderResult::AnimationEnded;
     }
 
-    m_renderTarget->BeginDraw();
-
-    // Draw backdrop
-    m_renderTarget->Clear(D2D1::ColorF(0.f, 0.f, 0.f, 0.f));
+    // Once faded in, the frame on screen stays valid until the scene changes
+    if (!m_sceneChanged && animationAlpha >= 1.f && m_renderedAlpha >= 1.f)
+    {
+        m_frameStats.skippedFrames++;
+        return RenderResult::Unchanged;
+    }
 
-    ID2D1SolidColorBrush* textBrush = nullptr;
-    IDWriteTextFormat* textFormat = nullptr;
+    size_t allocations = 0;
+    if (m_sceneChanged)
+    {
+        allocations = PrepareScene();
+        m_sceneChanged = false;
+    }
 
-    m_renderTarget->CreateSolidColorBrush(D2D1::ColorF(D2D1::ColorF::Black, animationAlpha), &textBrush);
-    auto writeFactory = GetWriteFactory();
+    m_renderedAlpha = animationAlpha;
 
-    if (writeFactory)
+    // Only the opacity is animated
+    for (auto& cached : m_brushes)
     {
-        writeFactory->CreateTextFormat(NonLocalizable::SegoeUiFont, nullptr, DWRITE_FONT_WEIGHT_NORMAL, DWRITE_FONT_STYLE_NORMAL, DWRITE_FONT_STRETCH_NORMAL, 80.f, L"en-US", &textFormat);
+        cached.brush->SetOpacity(animationAlpha);
     }
 
-    for (auto drawableRect : m_sceneRects)
+    if (m_textBrush)
     {
-        ID2D1SolidColorBrush* borderBrush = nullptr;
-        ID2D1SolidColorBrush* fillBrush = nullptr;
+        m_textBrush->SetOpacity(animationAlpha);
+    }
 
-        // Need to copy the rect from m_sceneRects
-        drawableRect.borderColor.a *= animationAlpha;
-        drawableRect.fillColor.a *= animationAlpha;
+    m_renderTarget->BeginDraw();
 
-        m_renderTarget->CreateSolidColorBrush(drawableRect.borderColor, &borderBrush);
-        m_renderTarget->CreateSolidColorBrush(drawableRect.fillColor, &fillBrush);
+    // Draw backdrop
+    m_renderTarget->Clear(D2D1::ColorF(0.f, 0.f, 0.f, 0.f));
 
-        if (fillBrush)
+    for (const auto& drawableRect : m_sceneRects)
+    {
+        if (drawableRect.fillBrush)
         {
-            m_renderTarget->FillRectangle(drawableRect.rect, fillBrush);
-            fillBrush->Release();
+            m_renderTarget->FillRectangle(drawableRect.rect, drawableRect.fillBrush);
         }
 
-        if (borderBrush)
+        if (drawableRect.borderBrush)
         {
-            m_renderTarget->DrawRectangle(drawableRect.rect, borderBrush);
-            borderBrush->Release();
+            m_renderTarget->DrawRectangle(drawableRect.rect, drawableRect.borderBrush);
         }
 
-        std::wstring idStr = std::to_wstring(drawableRect.id + 1);
-
-        if (textFormat && textBrush)
+        if (drawableRect.textLayout && m_textBrush)
         {
-            textFormat->SetTextAlignment(DWRITE_TEXT_ALIGNMENT_CENTER);
-            textFormat->SetParagraphAlignment(DWRITE_PARAGRAPH_ALIGNMENT_CENTER);
-            m_renderTarget->DrawTextW(idStr.c_str(), (UINT32)idStr.size(), textFormat, drawableRect.rect, textBrush);
+            m_renderTarget->DrawTextLayout(D2D1::Point2F(drawableRect.rect.left, drawableRect.rect.top), drawableRect.textLayout, m_textBrush.get());
         }
     }
 
-    if (textFormat)
-    {
-        textFormat->Release();
-    }
-
-    if (textBrush)
-    {
-        textBrush->Release();
-    }
-
     // The lock must be released here, as EndDraw() will wait for vertical sync
     lock.unlock();
 
     m_renderTarget->EndDraw();
+
+    const auto frameTime = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - frameStart);
+
+    lock.lock();
+    m_frameStats.renderedFrames++;
+    m_frameStats.lastFrameTime = frameTime;
+    m_frameStats.maxFrameTime = std::max(m_frameStats.maxFrameTime, frameTime);
+    m_frameStats.totalFrameTime += frameTime;
+    m_frameStats.allocations += allocations;
+    m_frameStats.lastFrameAllocations = allocations;
     return RenderResult::Ok;
 }
 
@@ -209,6 +304,20 @@ void ZoneWindowDrawing::RenderLoop()
         {
             Hide();
         }
+        else if (result == RenderResult::Unchanged)
+        {
+            // Nothing to draw until the scene changes, the zones flash, the overlay is hidden or the flash ends
+            std::unique_lock lock(m_mutex);
+            auto wake = [this]() { return m_sceneChanged || m_renderedAlpha < 1.f || m_abortThread || !m_shouldRender; };
+            if (m_animation && m_animation->autoHide)
+            {
+                m_cv.wait_until(lock, m_animation->tStart + std::chrono::milliseconds(FlashZonesDurationMillis + 1), wake);
+            }
+            else
+            {
+                m_cv.wait(lock, wake);
+            }
+        }
     }
 }
 
@@ -219,6 +328,7 @@ void ZoneWindowDrawing::Hide()
     {
         std::unique_lock lock(m_mutex);
         m_animation.reset();
+        m_renderedAlpha = 0.f;
         shouldHideWindow = m_shouldRender;
         m_shouldRender = false;
     }
@@ -226,7 +336,17 @@ void ZoneWindowDrawing::Hide()
     if (shouldHideWindow)
     {
         ShowWindow(m_window, SW_HIDE);
+
+        const auto stats = GetFrameStats();
+        Logger::trace(L"Zone overlay: {} frames rendered, {} skipped, {} us last frame, {} us max frame, {} allocations",
+                      stats.renderedFrames,
+                      stats.skippedFrames,
+                      stats.lastFrameTime.count(),
+                      stats.maxFrameTime.count(),
+                      stats.allocations);
     }
+
+    m_cv.notify_all();
 }
 
 void ZoneWindowDrawing::Show()
@@ -267,6 +387,7 @@ void ZoneWindowDrawing::Flash()
         m_shouldRender = true;
 
         m_animation.emplace(AnimationInfo{ .tStart = std::chrono::steady_clock().now(), .autoHide = true });
+        m_renderedAlpha = 0.f;
     }
 
     if (shouldShowWindow)
@@ -284,7 +405,8 @@ void ZoneWindowDrawing::DrawActiveZoneSet(const IZoneSet::ZonesMap& zones,
     _TRACER_;
     std::unique_lock lock(m_mutex);
 
-    m_sceneRects = {};
+    m_sceneRects.clear();
+    m_sceneChanged = true;
 
     auto borderColor = ConvertColor(colors.borderColor);
     auto inactiveColor = ConvertColor(colors.primaryColor);
@@ -340,6 +462,15 @@ void ZoneWindowDrawing::DrawActiveZoneSet(const IZoneSet::ZonesMap& zones,
             m_sceneRects.push_back(drawableRect);
         }
     }
+
+    lock.unlock();
+    m_cv.notify_all();
+}
+
+ZoneWindowDrawing::FrameStats ZoneWindowDrawing::GetFrameStats()
+{
+    std::unique_lock lock(m_mutex);
+    return m_frameStats;
 }
 
 ZoneWindowDrawing::~ZoneWindowDrawing()
@@ -15,12 +15,44 @@
 
 class ZoneWindowDrawing
 {
+public:
+    struct FrameStats
+    {
+        uint64_t renderedFrames = 0;
+        uint64_t skippedFrames = 0;
+        std::chrono::microseconds lastFrameTime{};
+        std::chrono::microseconds maxFrameTime{};
+        std::chrono::microseconds totalFrameTime{};
+        // Brushes, text formats and text layouts created by the render thread
+        uint64_t allocations = 0;
+        uint64_t lastFrameAllocations = 0;
+    };
+
+private:
     struct DrawableRect
     {
         D2D1_RECT_F rect;
         D2D1_COLOR_F borderColor;
         D2D1_COLOR_F fillColor;
         size_t id;
+
+        // Resolved by the render thread from the resources cache, owned by it
+        ID2D1SolidColorBrush* borderBrush = nullptr;
+        ID2D1SolidColorBrush* fillBrush = nullptr;
+        IDWriteTextLayout* textLayout = nullptr;
+    };
+
+    struct CachedBrush
+    {
+        D2D1_COLOR_F color;
+        winrt::com_ptr<ID2D1SolidColorBrush> brush;
+    };
+
+    struct CachedTextLayout
+    {
+        float width;
+        float height;
+        winrt::com_ptr<IDWriteTextLayout> layout;
     };
 
     struct AnimationInfo
@@ -33,6 +65,8 @@ class ZoneWindowDrawing
     {
         Ok,
         AnimationEnded,
+        // Same scene at the same opacity as the frame on screen, nothing was drawn
+        Unchanged,
         Failed,
     };
 
@@ -43,8 +77,19 @@ class ZoneWindowDrawing
 
     std::mutex m_mutex;
     std::vector<DrawableRect> m_sceneRects;
+    bool m_sceneChanged = false;
+    float m_renderedAlpha = 0.f;
+
+    // Retained between frames and scenes, only the opacity of the brushes changes from one frame to the next
+    std::vector<CachedBrush> m_brushes;
+    std::map<size_t, CachedTextLayout> m_textLayouts;
+    winrt::com_ptr<ID2D1SolidColorBrush> m_textBrush;
+    winrt::com_ptr<IDWriteTextFormat> m_textFormat;
+
+    FrameStats m_frameStats;
 
     float GetAnimationAlpha();
+    size_t PrepareScene();
     static ID2D1Factory* GetD2DFactory();
     static IDWriteFactory* GetWriteFactory();
     static D2D1_COLOR_F ConvertColor(COLORREF color);
@@ -67,4 +112,7 @@ public:
     void DrawActiveZoneSet(const IZoneSet::ZonesMap& zones,
                            const std::vector<size_t>& highlightZones,
                            const ZoneColors& colors);
+
+    // Frame time and allocations of the overlay render thread
+    FrameStats GetFrameStats();
 };
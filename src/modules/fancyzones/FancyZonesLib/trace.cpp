@@ -18,6 +18,7 @@
 #define EventMoveSizeEndKey "FancyZones_MoveSizeEnd"
 #define EventCycleActiveZoneSetKey "FancyZones_CycleActiveZoneSet"
 #define EventQuickLayoutSwitchKey "FancyZones_QuickLayoutSwitch"
+#define EventWindowsRelayoutKey "FancyZones_WindowsRelayout"
 
 #define EventEnabledKey "Enabled"
 #define PressedKeyCodeKey "Hotkey"
@@ -61,6 +62,9 @@
 #define InputModeKey "InputMode"
 #define OverlappingZonesAlgorithmKey "OverlappingZonesAlgorithm"
 #define QuickLayoutSwitchedWithShortcutUsed "ShortcutUsed"
+#define RelayoutWindowCountKey "WindowCount"
+#define RelayoutTransactionCountKey "TransactionCount"
+#define RelayoutDurationKey "DurationMs"
 
 TRACELOGGING_DEFINE_PROVIDER(
     g_hProvider,
@@ -130,10 +134,13 @@ void Trace::FancyZones::OnKeyDown(DWORD vkCode, bool win, bool control, bool inM
 void Trace::FancyZones::DataChanged() noexcept
 {
     const FancyZonesData& data = FancyZonesDataInstance();
-    int appsHistorySize = static_cast<int>(data.GetAppZoneHistoryMap().size());
-    const auto& customZones = data.GetCustomZoneSetsMap();
-    const auto& devices = data.GetDeviceInfoMap();
-    const auto& quickKeys = data.GetLayoutQuickKeys();
+    int appsHistorySize = static_cast<int>(data.GetAppZoneHistoryMap()->size());
+    const auto customZonesSnapshot = data.GetCustomZoneSetsMap();
+    const auto devicesSnapshot = data.GetDeviceInfoMap();
+    const auto quickKeysSnapshot = data.GetLayoutQuickKeys();
+    const auto& customZones = *customZonesSnapshot;
+    const auto& devices = *devicesSnapshot;
+    const auto& quickKeys = *quickKeysSnapshot;
 
     std::unique_ptr<INT32[]> customZonesArray(new (std::nothrow) INT32[customZones.size()]);
     if (!customZonesArray)
@@ -244,6 +251,18 @@ void Trace::FancyZones::QuickLayoutSwitched(bool shortcutUsed) noexcept
         TraceLoggingBoolean(shortcutUsed, QuickLayoutSwitchedWithShortcutUsed));
 }
 
+void Trace::FancyZones::WindowsRelayout(size_t windowCount, size_t transactionCount, long long durationMs) noexcept
+{
+    TraceLoggingWrite(
+        g_hProvider,
+        EventWindowsRelayoutKey,
+        ProjectTelemetryPrivacyDataTag(ProjectTelemetryTag_ProductAndServicePerformance),
+        TraceLoggingKeyword(PROJECT_KEYWORD_MEASURE),
+        TraceLoggingValue(static_cast<int>(windowCount), RelayoutWindowCountKey),
+        TraceLoggingValue(static_cast<int>(transactionCount), RelayoutTransactionCountKey),
+        TraceLoggingValue(durationMs, RelayoutDurationKey));
+}
+
 void Trace::SettingsTelemetry(const Settings& settings) noexcept
 {
     const auto& editorHotkey = settings.editorHotkey;
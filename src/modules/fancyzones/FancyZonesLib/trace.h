@@ -18,6 +18,7 @@ public:
         static void EditorLaunched(int value) noexcept;
         static void Error(const DWORD errorCode, std::wstring errorMessage, std::wstring methodName) noexcept;
         static void QuickLayoutSwitched(bool shortcutUsed) noexcept;
+        static void WindowsRelayout(size_t windowCount, size_t transactionCount, long long durationMs) noexcept;
     };
 
     static void SettingsTelemetry(const Settings& settings) noexcept;
@@ -1,14 +1,15 @@
 #include "pch.h"
 #include "util.h"
 #include "Settings.h"
+#include "ProcessCache.h"
+#include "LayoutEngine.h"
 
 #include <common/display/dpi_aware.h>
-#include <common/utils/process_path.h>
 #include <common/utils/window.h>
 
+#include <algorithm>
 #include <array>
 #include <sstream>
-#include <complex>
 #include <wil/Resource.h>
 
 #include <fancyzones/FancyZonesLib/FancyZonesDataTypes.h>
@@ -16,47 +17,9 @@
 // Non-Localizable strings
 namespace NonLocalizable
 {
-    const wchar_t PowerToysAppPowerLauncher[] = L"POWERLAUNCHER.EXE";
-    const wchar_t PowerToysAppFZEditor[] = L"FANCYZONESEDITOR.EXE";
     const wchar_t SplashClassName[] = L"MsoSplash";
 }
 
-bool find_app_name_in_path(const std::wstring& where, const std::vector<std::wstring>& what)
-{
-    for (const auto& row : what)
-    {
-        const auto pos = where.rfind(row);
-        const auto last_slash = where.rfind('\\');
-        //Check that row occurs in where, and its last occurrence contains in itself the first character after the last backslash.
-        if (pos != std::wstring::npos && pos <= last_slash + 1 && pos + row.length() > last_slash)
-        {
-            return true;
-        }
-    }
-    return false;
-}
-namespace
-{
-    bool IsZonableByProcessPath(const std::wstring& processPath, const std::vector<std::wstring>& excludedApps)
-    {
-        // Filter out user specified apps
-        CharUpperBuffW(const_cast<std::wstring&>(processPath).data(), (DWORD)processPath.length());
-        if (find_app_name_in_path(processPath, excludedApps))
-        {
-            return false;
-        }
-        if (find_app_name_in_path(processPath, { NonLocalizable::PowerToysAppPowerLauncher }))
-        {
-            return false;
-        }
-        if (find_app_name_in_path(processPath, { NonLocalizable::PowerToysAppFZEditor }))
-        {
-            return false;
-        }
-        return true;
-    }
-}
-
 namespace FancyZonesUtils
 {
     std::wstring TrimDeviceId(const std::wstring& deviceId)
@@ -425,6 +388,70 @@ namespace FancyZonesUtils
         ::SetWindowPlacement(window, &placement);
     }
 
+    bool DeferWindowPositions(const std::vector<std::pair<HWND, RECT>>& windows) noexcept
+    {
+        HDWP positions = BeginDeferWindowPos(static_cast<int>(windows.size()));
+        for (const auto& [window, rect] : windows)
+        {
+            if (!positions)
+            {
+                return false;
+            }
+
+            positions = DeferWindowPos(positions, window, nullptr, rect.left, rect.top, rect.right - rect.left, rect.bottom - rect.top, SWP_NOZORDER | SWP_NOOWNERZORDER | SWP_NOACTIVATE);
+        }
+
+        return positions && EndDeferWindowPos(positions);
+    }
+
+    size_t SizeWindowsToRects(const std::vector<std::pair<HWND, RECT>>& windows) noexcept
+    {
+        const bool sameDpiScaling = allMonitorsHaveSameDpiScaling();
+
+        std::unordered_map<HMONITOR, std::vector<std::pair<HWND, RECT>>> transactions;
+        for (const auto& [window, rect] : windows)
+        {
+            // Deferred positioning works on the current window rect only: minimized and maximized windows need their
+            // placement changed, hidden windows are shown by SizeWindowToRect, and a hung window would block the whole
+            // transaction while SizeWindowToRect moves it asynchronously.
+            const auto level = DPIAware::GetAwarenessLevel(GetWindowDpiAwarenessContext(window));
+            if (IsIconic(window) || IsZoomed(window) || !IsWindowVisible(window) || IsHungAppWindow(window) ||
+                (level < DPIAware::PER_MONITOR_AWARE && !sameDpiScaling))
+            {
+                SizeWindowToRect(window, rect);
+                continue;
+            }
+
+            transactions[MonitorFromRect(&rect, MONITOR_DEFAULTTONEAREST)].emplace_back(window, rect);
+        }
+
+        for (auto& [monitor, transaction] : transactions)
+        {
+            if (!DeferWindowPositions(transaction))
+            {
+                for (const auto& [window, rect] : transaction)
+                {
+                    SizeWindowToRect(window, rect);
+                }
+                continue;
+            }
+
+            // Windows moved to a monitor with a different DPI rescale themselves, move the ones
+            // that didn't end up at their rect again (same as in SizeWindowToRect, Issue #365)
+            std::erase_if(transaction, [](const auto& item) {
+                RECT actual{};
+                return !GetWindowRect(item.first, &actual) || EqualRect(&actual, &item.second);
+            });
+
+            if (!transaction.empty())
+            {
+                DeferWindowPositions(transaction);
+            }
+        }
+
+        return transactions.size();
+    }
+
     bool HasNoVisibleOwner(HWND window) noexcept
     {
         auto owner = GetWindow(window, GW_OWNER);
@@ -475,7 +502,7 @@ namespace FancyZonesUtils
         {
             return false;
         }
-        auto process_path = get_process_path(window);
+        auto process_path = ProcessCacheInstance().GetProcessPath(window);
         // Check for Cortana:
         if (strcmp(class_name.data(), "Windows.UI.Core.CoreWindow") == 0 &&
             process_path.ends_with(L"SearchUI.exe"))
@@ -486,7 +513,7 @@ namespace FancyZonesUtils
         return true;
     }
 
-    bool IsCandidateForLastKnownZone(HWND window, const std::vector<std::wstring>& excludedApps) noexcept
+    bool IsCandidateForLastKnownZone(HWND window, const ExcludedAppsMatcher& excludedApps) noexcept
     {
         auto zonable = IsStandardWindow(window) && HasNoVisibleOwner(window);
         if (!zonable)
@@ -494,17 +521,17 @@ namespace FancyZonesUtils
             return false;
         }
 
-        return IsZonableByProcessPath(get_process_path(window), excludedApps);
+        return !ProcessCacheInstance().IsExcluded(window, excludedApps);
     }
 
-    bool IsCandidateForZoning(HWND window, const std::vector<std::wstring>& excludedApps) noexcept
+    bool IsCandidateForZoning(HWND window, const ExcludedAppsMatcher& excludedApps) noexcept
     {
         if (!IsStandardWindow(window))
         {
             return false;
         }
 
-        return IsZonableByProcessPath(get_process_path(window), excludedApps);
+        return !ProcessCacheInstance().IsExcluded(window, excludedApps);
     }
 
     bool IsWindowMaximized(HWND window) noexcept
@@ -723,101 +750,40 @@ namespace FancyZonesUtils
         return result;
     }
 
-    size_t ChooseNextZoneByPosition(DWORD vkCode, RECT windowRect, const std::vector<RECT>& zoneRects) noexcept
+    std::optional<LayoutEngine::Direction> DirectionFromVkCode(DWORD vkCode) noexcept
     {
-        using complex = std::complex<double>;
-        const size_t invalidResult = zoneRects.size();
-        const double inf = 1e100;
-        const double eccentricity = 2.0;
-
-        auto rectCenter = [](RECT rect) {
-            return complex{
-                0.5 * rect.left + 0.5 * rect.right,
-                0.5 * rect.top + 0.5 * rect.bottom
-            };
-        };
-
-        auto distance = [&](complex arrowDirection, complex zoneDirection) {
-            double result = inf;
-
-            try
-            {
-                double scalarProduct = (arrowDirection * conj(zoneDirection)).real();
-                if (scalarProduct <= 0.0)
-                {
-                    return inf;
-                }
-
-                // no need to divide by abs(arrowDirection) because it's = 1
-                double cosAngle = scalarProduct / abs(zoneDirection);
-                double tanAngle = abs(tan(acos(cosAngle)));
-
-                if (tanAngle > 10)
-                {
-                    // The angle is too wide
-                    return inf;
-                }
-
-                // find the intersection with the ellipse with given eccentricity and major axis along arrowDirection
-                double intersectY = 2 * eccentricity / (1.0 + eccentricity * eccentricity * tanAngle * tanAngle);
-                double distanceEstimate = scalarProduct / intersectY;
-
-                if (std::isfinite(distanceEstimate))
-                {
-                    result = distanceEstimate;
-                }
-            }
-            catch (...)
-            {
-            }
-
-            return result;
-        };
-        std::vector<std::pair<size_t, complex>> candidateCenters;
-        for (size_t i = 0; i < zoneRects.size(); i++)
-        {
-            auto center = rectCenter(zoneRects[i]);
-
-            // Offset the zone slightly, to differentiate in case there are overlapping zones
-            center += 0.001 * (i + 1);
-
-            candidateCenters.emplace_back(i, center);
-        }
-
-        complex directionVector, windowCenter = rectCenter(windowRect);
-
         switch (vkCode)
         {
         case VK_UP:
-            directionVector = { 0.0, -1.0 };
-            break;
+            return LayoutEngine::Direction::Up;
         case VK_DOWN:
-            directionVector = { 0.0, 1.0 };
-            break;
+            return LayoutEngine::Direction::Down;
         case VK_LEFT:
-            directionVector = { -1.0, 0.0 };
-            break;
+            return LayoutEngine::Direction::Left;
         case VK_RIGHT:
-            directionVector = { 1.0, 0.0 };
-            break;
+            return LayoutEngine::Direction::Right;
         default:
-            return invalidResult;
+            return std::nullopt;
         }
+    }
 
-        size_t closestIdx = invalidResult;
-        double smallestDistance = inf;
-
-        for (auto [zoneIdx, zoneCenter] : candidateCenters)
+    size_t ChooseNextZoneByPosition(DWORD vkCode, RECT windowRect, const std::vector<RECT>& zoneRects) noexcept
+    {
+        const auto direction = DirectionFromVkCode(vkCode);
+        if (!direction)
         {
-            double dist = distance(directionVector, zoneCenter - windowCenter);
-            if (dist < smallestDistance)
-            {
-                smallestDistance = dist;
-                closestIdx = zoneIdx;
-            }
+            return zoneRects.size();
         }
 
-        return closestIdx;
+        auto toRect = [](const RECT& rect) {
+            return LayoutEngine::Rect{ rect.left, rect.top, rect.right, rect.bottom };
+        };
+
+        std::vector<LayoutEngine::Rect> rects;
+        rects.reserve(zoneRects.size());
+        std::transform(std::begin(zoneRects), std::end(zoneRects), std::back_inserter(rects), toRect);
+
+        return LayoutEngine::ChooseNextZoneByPosition(*direction, toRect(windowRect), rects);
     }
 
     RECT PrepareRectForCycling(RECT windowRect, RECT zoneWindowRect, DWORD vkCode) noexcept
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "gdiplus.h"
+#include "LayoutEngine.h"
 #include <common/utils/string_utils.h>
 
 namespace FancyZonesDataTypes
@@ -8,6 +9,8 @@ namespace FancyZonesDataTypes
     struct DeviceIdData;
 }
 
+class ExcludedAppsMatcher;
+
 namespace FancyZonesUtils
 {
     struct Rect
@@ -192,10 +195,16 @@ namespace FancyZonesUtils
     // Parameter rect must be in screen coordinates (e.g. obtained from GetWindowRect)
     void SizeWindowToRect(HWND window, RECT rect) noexcept;
 
+    // Moves the windows to their rects (in screen coordinates) in one deferred window position transaction
+    // per monitor, so they are repainted together. Windows that can't be moved that way (minimized, maximized,
+    // hidden, hung or DPI unaware on mixed DPI setups) are moved with SizeWindowToRect.
+    // Returns the number of transactions.
+    size_t SizeWindowsToRects(const std::vector<std::pair<HWND, RECT>>& windows) noexcept;
+
     bool HasNoVisibleOwner(HWND window) noexcept;
     bool IsStandardWindow(HWND window);
-    bool IsCandidateForLastKnownZone(HWND window, const std::vector<std::wstring>& excludedApps) noexcept;
-    bool IsCandidateForZoning(HWND window, const std::vector<std::wstring>& excludedApps) noexcept;
+    bool IsCandidateForLastKnownZone(HWND window, const ExcludedAppsMatcher& excludedApps) noexcept;
+    bool IsCandidateForZoning(HWND window, const ExcludedAppsMatcher& excludedApps) noexcept;
 
     bool IsWindowMaximized(HWND window) noexcept;
     void SaveWindowSizeAndOrigin(HWND window) noexcept;
@@ -213,6 +222,8 @@ namespace FancyZonesUtils
     bool IsValidDeviceId(const std::wstring& str);
 
     RECT PrepareRectForCycling(RECT windowRect, RECT zoneWindowRect, DWORD vkCode) noexcept;
+    // Direction of an arrow key, nullopt for other keys
+    std::optional<LayoutEngine::Direction> DirectionFromVkCode(DWORD vkCode) noexcept;
     size_t ChooseNextZoneByPosition(DWORD vkCode, RECT windowRect, const std::vector<RECT>& zoneRects) noexcept;
 
     // If HWND is already dead, we assume it wasn't elevated
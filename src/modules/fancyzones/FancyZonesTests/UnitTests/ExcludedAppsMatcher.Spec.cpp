@@ -0,0 +1,178 @@
+#include "pch.h"
+#include "FancyZonesLib\ExcludedAppsMatcher.h"
+
+#include <chrono>
+#include <random>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace FancyZonesUnitTests
+{
+    namespace
+    {
+        // The per-pattern rfind check the matcher replaced, kept as the reference for the expected behavior
+        bool FindAppNameInPath(const std::wstring& where, const std::vector<std::wstring>& what)
+        {
+            for (const auto& row : what)
+            {
+                const auto pos = where.rfind(row);
+                const auto last_slash = where.rfind('\\');
+                if (pos != std::wstring::npos && pos <= last_slash + 1 && pos + row.length() > last_slash)
+                {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        std::vector<std::wstring> GeneratePatterns(size_t count, std::mt19937& rng)
+        {
+            std::vector<std::wstring> patterns;
+            for (size_t i = 0; i < count; ++i)
+            {
+                std::wstring name;
+                const size_t length = 4 + rng() % 12;
+                for (size_t j = 0; j < length; ++j)
+                {
+                    name += static_cast<wchar_t>(L'A' + rng() % 26);
+                }
+                patterns.push_back(name + L".EXE");
+            }
+            return patterns;
+        }
+    }
+
+    TEST_CLASS (ExcludedAppsMatcherUnitTests)
+    {
+        TEST_METHOD (EmptyMatcher)
+        {
+            ExcludedAppsMatcher matcher;
+            Assert::IsFalse(matcher.Matches(L"C:\\WINDOWS\\NOTEPAD.EXE"));
+        }
+
+        TEST_METHOD (MatchesFileName)
+        {
+            ExcludedAppsMatcher matcher({ L"NOTEPAD.EXE", L"CALC" });
+            Assert::IsTrue(matcher.Matches(L"C:\\WINDOWS\\NOTEPAD.EXE"));
+            Assert::IsTrue(matcher.Matches(L"C:\\WINDOWS\\CALC.EXE"));
+            Assert::IsFalse(matcher.Matches(L"C:\\WINDOWS\\MSPAINT.EXE"));
+        }
+
+        TEST_METHOD (MustStartAtFileName)
+        {
+            ExcludedAppsMatcher matcher({ L"PAD.EXE" });
+            Assert::IsFalse(matcher.Matches(L"C:\\WINDOWS\\NOTEPAD.EXE"));
+        }
+
+        TEST_METHOD (MatchesAcrossLastBackslash)
+        {
+            ExcludedAppsMatcher matcher({ L"WINDOWS\\NOTEPAD" });
+            Assert::IsTrue(matcher.Matches(L"C:\\WINDOWS\\NOTEPAD.EXE"));
+        }
+
+        TEST_METHOD (IgnoresFolderNames)
+        {
+            ExcludedAppsMatcher matcher({ L"WINDOWS" });
+            Assert::IsFalse(matcher.Matches(L"C:\\WINDOWS\\NOTEPAD.EXE"));
+        }
+
+        TEST_METHOD (LastOccurrenceDecides)
+        {
+            // The last occurrence of "APP" is inside the file name, not at its start
+            ExcludedAppsMatcher matcher({ L"APP" });
+            Assert::IsTrue(matcher.Matches(L"C:\\APPS\\APP.EXE"));
+            Assert::IsFalse(matcher.Matches(L"C:\\APPS\\APP_MYAPP.EXE"));
+        }
+
+        TEST_METHOD (OverlappingPatterns)
+        {
+            ExcludedAppsMatcher matcher({ L"CODE", L"VSCODE.EXE", L"DE.EXE" });
+            Assert::IsTrue(matcher.Matches(L"C:\\PROGRAMS\\VSCODE.EXE"));
+            Assert::IsTrue(matcher.Matches(L"C:\\PROGRAMS\\CODE.EXE"));
+            Assert::IsFalse(matcher.Matches(L"C:\\PROGRAMS\\XCODE.EXE"));
+        }
+
+        TEST_METHOD (PathWithoutBackslash)
+        {
+            ExcludedAppsMatcher matcher({ L"NOTEPAD.EXE" });
+            Assert::IsFalse(matcher.Matches(L"NOTEPAD.EXE"));
+        }
+
+        TEST_METHOD (SameResultAsPerPatternSearch)
+        {
+            // Small alphabet to get plenty of overlapping and repeated occurrences
+            std::mt19937 rng(42);
+            auto randomString = [&](size_t maxLength) {
+                std::wstring result;
+                const size_t length = rng() % maxLength;
+                for (size_t i = 0; i < length; ++i)
+                {
+                    const auto ch = rng() % 5;
+                    result += ch == 0 ? L'\\' : static_cast<wchar_t>(L'A' + ch - 1);
+                }
+                return result;
+            };
+
+            for (int i = 0; i < 20000; ++i)
+            {
+                std::vector<std::wstring> patterns;
+                const size_t count = rng() % 5;
+                for (size_t j = 0; j < count; ++j)
+                {
+                    patterns.push_back(randomString(6));
+                }
+                const auto path = randomString(14);
+
+                ExcludedAppsMatcher matcher(patterns);
+                Assert::AreEqual(FindAppNameInPath(path, patterns), matcher.Matches(path), path.c_str());
+            }
+        }
+
+        TEST_METHOD (Benchmark)
+        {
+            std::mt19937 rng(7);
+            std::vector<std::wstring> paths;
+            for (const auto& name : GeneratePatterns(1000, rng))
+            {
+                paths.push_back(L"C:\\PROGRAM FILES\\SOME VENDOR\\SOME PRODUCT\\BIN\\" + name);
+            }
+
+            constexpr int rounds = 20;
+            for (size_t count : { 10, 100, 1000 })
+            {
+                const auto patterns = GeneratePatterns(count, rng);
+                ExcludedAppsMatcher matcher(patterns);
+
+                size_t expected = 0;
+                const auto searchStart = std::chrono::steady_clock::now();
+                for (int round = 0; round < rounds; ++round)
+                {
+                    for (const auto& path : paths)
+                    {
+                        expected += FindAppNameInPath(path, patterns);
+                    }
+                }
+                const auto searchTime = std::chrono::steady_clock::now() - searchStart;
+
+                size_t actual = 0;
+                const auto matcherStart = std::chrono::steady_clock::now();
+                for (int round = 0; round < rounds; ++round)
+                {
+                    for (const auto& path : paths)
+                    {
+                        actual += matcher.Matches(path);
+                    }
+                }
+                const auto matcherTime = std::chrono::steady_clock::now() - matcherStart;
+
+                Assert::AreEqual(expected, actual);
+
+                using us = std::chrono::duration<double, std::micro>;
+                const double lookups = static_cast<double>(rounds * paths.size());
+                const auto message = std::to_wstring(count) + L" exclusions: rfind " + std::to_wstring(us(searchTime).count() / lookups) +
+                                     L" us/lookup, matcher " + std::to_wstring(us(matcherTime).count() / lookups) + L" us/lookup\n";
+                Logger::WriteMessage(message.c_str());
+            }
+        }
+    };
+}
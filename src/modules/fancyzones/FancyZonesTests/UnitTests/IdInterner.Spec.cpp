@@ -0,0 +1,78 @@
+#include "pch.h"
+#include "FancyZonesLib\IdInterner.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace FancyZonesUnitTests
+{
+    TEST_CLASS (IdInternerUnitTests)
+    {
+        TEST_METHOD (InternSameIdTwice)
+        {
+            IdInterner ids;
+            const auto handle = ids.Intern(L"AOC0001#5&37ac4db&0&UID160002_1536_960_{E0972B79-1A9D-4F10-B1C9-0A2F3BDAE2B8}");
+
+            Assert::AreNotEqual(IdInterner::InvalidHandle, handle);
+            Assert::AreEqual(handle, ids.Intern(L"AOC0001#5&37ac4db&0&UID160002_1536_960_{E0972B79-1A9D-4F10-B1C9-0A2F3BDAE2B8}"));
+            Assert::AreEqual((size_t)1, ids.Size());
+        }
+
+        TEST_METHOD (InternDifferentIds)
+        {
+            IdInterner ids;
+            const auto first = ids.Intern(L"{33A2B101-06E0-437B-A61E-CDBECF502906}");
+            const auto second = ids.Intern(L"{33A2B101-06E0-437B-A61E-CDBECF502907}");
+
+            Assert::AreNotEqual(first, second);
+            Assert::AreEqual(std::wstring(L"{33A2B101-06E0-437B-A61E-CDBECF502906}"), ids.Resolve(first));
+            Assert::AreEqual(std::wstring(L"{33A2B101-06E0-437B-A61E-CDBECF502907}"), ids.Resolve(second));
+        }
+
+        TEST_METHOD (FindDoesntIntern)
+        {
+            IdInterner ids;
+
+            Assert::AreEqual(IdInterner::InvalidHandle, ids.Find(L"{33A2B101-06E0-437B-A61E-CDBECF502906}"));
+            Assert::AreEqual((size_t)0, ids.Size());
+
+            const auto handle = ids.Intern(L"{33A2B101-06E0-437B-A61E-CDBECF502906}");
+            Assert::AreEqual(handle, ids.Find(L"{33A2B101-06E0-437B-A61E-CDBECF502906}"));
+        }
+
+        TEST_METHOD (HandlesStableWhileGrowing)
+        {
+            IdInterner ids;
+            std::vector<IdInterner::Handle> handles;
+            for (int i = 0; i < 1000; i++)
+            {
+                handles.push_back(ids.Intern(L"C:\\Program Files\\App" + std::to_wstring(i) + L"\\app.exe"));
+            }
+
+            for (int i = 0; i < 1000; i++)
+            {
+                const auto path = L"C:\\Program Files\\App" + std::to_wstring(i) + L"\\app.exe";
+                Assert::AreEqual(handles[i], ids.Find(path));
+                Assert::AreEqual(path, ids.Resolve(handles[i]));
+            }
+        }
+
+        TEST_METHOD (ResolveInvalidHandle)
+        {
+            IdInterner ids;
+            ids.Intern(L"{33A2B101-06E0-437B-A61E-CDBECF502906}");
+
+            Assert::IsTrue(ids.Resolve(IdInterner::InvalidHandle).empty());
+            Assert::IsTrue(ids.Resolve(42).empty());
+        }
+
+        TEST_METHOD (Clear)
+        {
+            IdInterner ids;
+            ids.Intern(L"{33A2B101-06E0-437B-A61E-CDBECF502906}");
+            ids.Clear();
+
+            Assert::AreEqual((size_t)0, ids.Size());
+            Assert::AreEqual(IdInterner::InvalidHandle, ids.Find(L"{33A2B101-06E0-437B-A61E-CDBECF502906}"));
+        }
+    };
+}
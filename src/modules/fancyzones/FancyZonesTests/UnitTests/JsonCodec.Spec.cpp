@@ -0,0 +1,256 @@
+#include "pch.h"
+#include <FancyZonesLib/JsonCodec.h>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace FancyZonesUnitTests
+{
+    TEST_CLASS (JsonCodecUnitTests)
+    {
+        TEST_METHOD (WriteCompact)
+        {
+            JsonCodec::Writer writer;
+            writer.BeginObject();
+            writer.Key("devices");
+            writer.BeginArray();
+            writer.BeginObject();
+            writer.Key("device-id");
+            writer.String(L"DELA026#5&10a58c63&0&UID16777488_1920_1200_{39B25DD2-130D-4B5D-8851-4791D66B1539}");
+            writer.Key("editor-show-spacing");
+            writer.Bool(true);
+            writer.Key("editor-spacing");
+            writer.Integer(-16);
+            writer.EndObject();
+            writer.BeginArray();
+            writer.EndArray();
+            writer.Null();
+            writer.EndArray();
+            writer.Key("templates");
+            writer.BeginArray();
+            writer.EndArray();
+            writer.EndObject();
+
+            Assert::AreEqual(std::string("{\"devices\":[{\"device-id\":\"DELA026#5&10a58c63&0&UID16777488_1920_1200_{39B25DD2-130D-4B5D-8851-4791D66B1539}\",\"editor-show-spacing\":true,\"editor-spacing\":-16},[],null],\"templates\":[]}"), writer.Text());
+        }
+
+        TEST_METHOD (WriteEscapes)
+        {
+            JsonCodec::Writer writer;
+            writer.String(L"C:\\Program Files\\\"app\"\t\n\x1f/\u00e9\u4e2d\U0001F600");
+
+            Assert::AreEqual(std::string("\"C:\\\\Program Files\\\\\\\"app\\\"\\t\\n\\u001f/\xC3\xA9\xE4\xB8\xAD\xF0\x9F\x98\x80\""), writer.Text());
+        }
+
+        TEST_METHOD (WriteNumbers)
+        {
+            const std::pair<double, std::string> expected[] = {
+                { 0, "0" },
+                { -0.0, "0" },
+                { 16, "16" },
+                { -1, "-1" },
+                { 0.5, "0.5" },
+                { 1.25, "1.25" },
+                { 0.1, "0.1" },
+                { 123456789012, "123456789012" },
+                { 1e21, "1e+21" },
+                { 1.5e22, "1.5e+22" },
+                { 1e20, "100000000000000000000" },
+                { 0.000001, "0.000001" },
+                { 1e-7, "1e-7" },
+                { -2.5e-8, "-2.5e-8" },
+            };
+
+            for (const auto& [value, text] : expected)
+            {
+                JsonCodec::Writer writer;
+                writer.Number(value);
+                Assert::AreEqual(text, writer.Text());
+            }
+        }
+
+        TEST_METHOD (ReadMembers)
+        {
+            JsonCodec::Reader reader(" { \"name\" : \"\\u0041b\\\"\" ,\"n\":-1.5e2, \"flag\":false, \"list\":[1, 2 ,3], \"skip\":{\"a\":[null,{}]} } ");
+
+            std::wstring name;
+            double number = 0;
+            bool flag = true;
+            std::vector<int> list;
+
+            Assert::IsTrue(reader.BeginObject());
+            std::string_view key;
+            while (reader.NextKey(key))
+            {
+                if (key == "name")
+                {
+                    Assert::IsTrue(reader.Read(name));
+                }
+                else if (key == "n")
+                {
+                    Assert::IsTrue(reader.Read(number));
+                }
+                else if (key == "flag")
+                {
+                    Assert::IsTrue(reader.Read(flag));
+                }
+                else if (key == "list" && reader.BeginArray())
+                {
+                    while (reader.NextElement())
+                    {
+                        double value;
+                        Assert::IsTrue(reader.Read(value));
+                        list.push_back(static_cast<int>(value));
+                    }
+                }
+                else
+                {
+                    Assert::IsTrue(reader.Skip());
+                }
+            }
+
+            Assert::IsTrue(reader.End());
+            Assert::AreEqual(std::wstring(L"Ab\""), name);
+            Assert::AreEqual(-150.0, number);
+            Assert::IsFalse(flag);
+            Assert::IsTrue(std::vector<int>{ 1, 2, 3 } == list);
+        }
+
+        TEST_METHOD (ReadTypeMismatch)
+        {
+            JsonCodec::Reader reader("[\"text\", {\"a\":1}, 5]");
+
+            Assert::IsTrue(reader.BeginArray());
+            double number;
+            Assert::IsTrue(reader.NextElement());
+            Assert::IsFalse(reader.Read(number));
+            Assert::IsTrue(reader.NextElement());
+            Assert::IsFalse(reader.BeginArray());
+            Assert::IsTrue(reader.NextElement());
+            Assert::IsTrue(reader.Read(number));
+            Assert::IsFalse(reader.NextElement());
+
+            // Mismatches aren't errors
+            Assert::IsTrue(reader.End());
+            Assert::AreEqual(5.0, number);
+        }
+
+        TEST_METHOD (ReadUnicode)
+        {
+            JsonCodec::Reader reader("[\"\xEF\xBB\xBF\xD0\xBA\xD0\xB8\", \"\\ud83d\\ude00\", \"\xF0\x9F\x98\x80\", \"\xFF\"]");
+            std::wstring value;
+
+            Assert::IsTrue(reader.BeginArray());
+            Assert::IsTrue(reader.NextElement());
+            Assert::IsTrue(reader.Read(value));
+            Assert::AreEqual(std::wstring(L"\ufeff\u043a\u0438"), value);
+
+            Assert::IsTrue(reader.NextElement());
+            Assert::IsTrue(reader.Read(value));
+            Assert::AreEqual(std::wstring(L"\U0001F600"), value);
+
+            Assert::IsTrue(reader.NextElement());
+            Assert::IsTrue(reader.Read(value));
+            Assert::AreEqual(std::wstring(L"\U0001F600"), value);
+
+            // Invalid UTF-8 is replaced, the way MultiByteToWideChar does
+            Assert::IsTrue(reader.NextElement());
+            Assert::IsTrue(reader.Read(value));
+            Assert::AreEqual(std::wstring(L"\ufffd"), value);
+
+            Assert::IsFalse(reader.NextElement());
+            Assert::IsTrue(reader.End());
+        }
+
+        TEST_METHOD (ByteOrderMark)
+        {
+            JsonCodec::Reader reader("\xEF\xBB\xBF{}");
+            std::string_view key;
+            Assert::IsTrue(reader.BeginObject());
+            Assert::IsFalse(reader.NextKey(key));
+            Assert::IsTrue(reader.End());
+        }
+
+        TEST_METHOD (SyntaxErrors)
+        {
+            const std::string_view invalid[] = {
+                "",
+                "{",
+                "{\"a\":}",
+                "{\"a\" 1}",
+                "{\"a\":1,}",
+                "{,}",
+                "[1,]",
+                "[1 2]",
+                "[01]",
+                "[1.]",
+                "[-]",
+                "[+1]",
+                "[.5]",
+                "[1e]",
+                "[tru]",
+                "[nul]",
+                "[\"unterminated]",
+                "[\"bad \\x escape\"]",
+                "[\"bad \\u12 escape\"]",
+                "[\"control \x01 character\"]",
+                "{} {}",
+                "{\"app-zone-history\": [], \"devices\": [{\"device-id\": \"",
+            };
+
+            for (const auto text : invalid)
+            {
+                Assert::IsFalse(JsonCodec::Minify(text).has_value(), std::wstring(text.begin(), text.end()).c_str());
+            }
+        }
+
+        TEST_METHOD (NestingLimit)
+        {
+            const std::string deep = std::string(10000, '[') + std::string(10000, ']');
+            Assert::IsFalse(JsonCodec::Minify(deep).has_value());
+
+            const std::string nested = std::string(100, '[') + std::string(100, ']');
+            Assert::IsTrue(nested == JsonCodec::Minify(nested));
+        }
+
+        TEST_METHOD (Minify)
+        {
+            const auto minified = JsonCodec::Minify("\r\n{ \"templates\" : [ { \"type\": \"focus\", \"show-spacing\": false, \"spacing\": 15.0, \"zone-count\": 7e0, \"name\": \"\\u00e9\\/\" } ],\n\t\"x\": null }\n");
+
+            Assert::IsTrue(minified.has_value());
+            Assert::AreEqual(std::string("{\"templates\":[{\"type\":\"focus\",\"show-spacing\":false,\"spacing\":15,\"zone-count\":7,\"name\":\"\xC3\xA9/\"}],\"x\":null}"), *minified);
+        }
+
+        TEST_METHOD (Capture)
+        {
+            JsonCodec::Reader reader("{\"info\": {\"rows\": 2}, \"type\": \"grid\"}");
+            std::optional<std::string_view> info;
+            std::wstring type;
+
+            Assert::IsTrue(reader.BeginObject());
+            std::string_view key;
+            while (reader.NextKey(key))
+            {
+                if (key == "info")
+                {
+                    info = reader.Capture();
+                }
+                else
+                {
+                    Assert::IsTrue(reader.Read(type));
+                }
+            }
+            Assert::IsTrue(reader.End());
+            Assert::AreEqual(std::wstring(L"grid"), type);
+            Assert::IsTrue(info.has_value());
+
+            JsonCodec::Reader infoReader(*info);
+            double rows = 0;
+            Assert::IsTrue(infoReader.BeginObject());
+            Assert::IsTrue(infoReader.NextKey(key));
+            Assert::IsTrue(infoReader.Read(rows));
+            Assert::IsFalse(infoReader.NextKey(key));
+            Assert::IsTrue(infoReader.End());
+            Assert::AreEqual(2.0, rows);
+        }
+    };
+}
@@ -1,4 +1,5 @@
 #include "pch.h"
+#include <chrono>
 #include <filesystem>
 #include <fstream>
 #include <utility>
@@ -9,6 +10,7 @@
 #include <FancyZonesLib/util.h>
 
 #include "util.h"
+#include "JsonObjectReference.h"
 
 #include <CppUnitTestLogger.h>
 
@@ -1625,7 +1627,7 @@ namespace FancyZonesUnitTests
 
                 data.SetActiveZoneSet(uniqueId, expectedZoneSetData);
 
-                auto actual = data.GetDeviceInfoMap().find(uniqueId)->second;
+                auto actual = data.GetDeviceInfoMap()->find(uniqueId)->second;
                 Assert::AreEqual(expectedZoneSetData.uuid.c_str(), actual.activeZoneSet.uuid.c_str());
                 Assert::IsTrue(expectedZoneSetData.type == actual.activeZoneSet.type);
             }
@@ -1650,7 +1652,7 @@ namespace FancyZonesUnitTests
 
                 data.SetActiveZoneSet(uniqueId, expectedZoneSetData);
 
-                auto actual = data.GetDeviceInfoMap().find(uniqueId)->second;
+                auto actual = data.GetDeviceInfoMap()->find(uniqueId)->second;
                 Assert::AreEqual(expectedZoneSetData.uuid.c_str(), actual.activeZoneSet.uuid.c_str());
                 Assert::IsTrue(expectedZoneSetData.type == actual.activeZoneSet.type);
             }
@@ -1677,10 +1679,37 @@ namespace FancyZonesUnitTests
 
                 data.SetActiveZoneSet(uniqueId, zoneSetData);
 
-                const auto& deviceInfoMap = data.GetDeviceInfoMap();
-                auto actual = deviceInfoMap.find(m_defaultDeviceId)->second;
+                const auto deviceInfoMap = data.GetDeviceInfoMap();
+                auto actual = deviceInfoMap->find(m_defaultDeviceId)->second;
                 Assert::AreEqual(expected.c_str(), actual.activeZoneSet.uuid.c_str());
-                Assert::IsTrue(deviceInfoMap.end() == deviceInfoMap.find(uniqueId), L"new device info should not be added");
+                Assert::IsTrue(deviceInfoMap->end() == deviceInfoMap->find(uniqueId), L"new device info should not be added");
+            }
+
+            TEST_METHOD (DeviceInfoSnapshotUnchangedByWrites)
+            {
+                FancyZonesData data;
+                data.SetSettingsModulePath(m_moduleName);
+                const std::wstring uniqueId = m_defaultDeviceId;
+
+                json::JsonArray devices;
+                devices.Append(m_defaultCustomDeviceValue);
+                json::JsonObject json;
+                json.SetNamedValue(L"devices", devices);
+                data.ParseDeviceInfos(json);
+
+                const auto snapshot = data.GetDeviceInfoMap();
+                const auto expected = snapshot->at(uniqueId).activeZoneSet.uuid;
+
+                data.SetActiveZoneSet(uniqueId, FancyZonesDataTypes::ZoneSetData{ .uuid = L"{D13ABB6D-7721-4176-9647-C8C0836D99CC}", .type = ZoneSetLayoutType::Focus });
+                data.AddDevice(L"AnotherDevice_2_2_{00000000-0000-0000-0000-000000000000}");
+
+                // The snapshot taken before the writes still holds the previous version
+                Assert::AreEqual(expected.c_str(), snapshot->at(uniqueId).activeZoneSet.uuid.c_str());
+                Assert::AreEqual((size_t)1, snapshot->size());
+
+                const auto current = data.GetDeviceInfoMap();
+                Assert::AreEqual(L"{D13ABB6D-7721-4176-9647-C8C0836D99CC}", current->at(uniqueId).activeZoneSet.uuid.c_str());
+                Assert::AreEqual((size_t)2, current->size());
             }
 
             TEST_METHOD (LoadFancyZonesDataFromJson)
@@ -1731,10 +1760,10 @@ namespace FancyZonesUnitTests
                     std::filesystem::remove(jsonPath);
                 }
 
-                Assert::IsFalse(fancyZonesData.GetCustomZoneSetsMap().empty());
-                Assert::IsFalse(fancyZonesData.GetCustomZoneSetsMap().empty());
-                Assert::IsFalse(fancyZonesData.GetCustomZoneSetsMap().empty());
-                Assert::IsFalse(fancyZonesData.GetLayoutQuickKeys().empty());
+                Assert::IsFalse(fancyZonesData.GetCustomZoneSetsMap()->empty());
+                Assert::IsFalse(fancyZonesData.GetCustomZoneSetsMap()->empty());
+                Assert::IsFalse(fancyZonesData.GetCustomZoneSetsMap()->empty());
+                Assert::IsFalse(fancyZonesData.GetLayoutQuickKeys()->empty());
             }
 
             TEST_METHOD (LoadFancyZonesDataFromCroppedJson)
@@ -1747,9 +1776,9 @@ namespace FancyZonesUnitTests
 
                 data.LoadFancyZonesData();
 
-                Assert::IsTrue(data.GetCustomZoneSetsMap().empty());
-                Assert::IsTrue(data.GetAppZoneHistoryMap().empty());
-                Assert::IsTrue(data.GetDeviceInfoMap().empty());
+                Assert::IsTrue(data.GetCustomZoneSetsMap()->empty());
+                Assert::IsTrue(data.GetAppZoneHistoryMap()->empty());
+                Assert::IsTrue(data.GetDeviceInfoMap()->empty());
             }
 
             TEST_METHOD (LoadFancyZonesDataFromJsonWithCyrillicSymbols)
@@ -1761,9 +1790,9 @@ namespace FancyZonesUnitTests
                 std::wofstream{ jsonPath.data(), std::ios::binary } << L"{ \"app-zone-history\": [], \"devices\": [{\"device-id\": \"кириллица\"}], \"custom-zone-sets\": []}";
                 data.LoadFancyZonesData();
 
-                Assert::IsTrue(data.GetCustomZoneSetsMap().empty());
-                Assert::IsTrue(data.GetAppZoneHistoryMap().empty());
-                Assert::IsTrue(data.GetDeviceInfoMap().empty());
+                Assert::IsTrue(data.GetCustomZoneSetsMap()->empty());
+                Assert::IsTrue(data.GetAppZoneHistoryMap()->empty());
+                Assert::IsTrue(data.GetDeviceInfoMap()->empty());
             }
 
             TEST_METHOD (LoadFancyZonesDataFromJsonWithInvalidTypes)
@@ -1775,9 +1804,9 @@ namespace FancyZonesUnitTests
                 std::wofstream{ jsonPath.data(), std::ios::binary } << L"{ \"app-zone-history\": null, \"devices\": [{\"device-id\":\"AOC2460#4&fe3a015&0&UID65793_1920_1200_{39B25DD2-130D-4B5D-8851-4791D66B1539}\",\"active-zoneset\":{\"uuid\":\"{568EBC3A-C09C-483E-A64D-6F1F2AF4E48D}\",\"type\":\"columns\"},\"editor-show-spacing\":true,\"editor-spacing\":16,\"editor-zone-count\":3}], \"custom-zone-sets\": []}";
                 data.LoadFancyZonesData();
 
-                Assert::IsTrue(data.GetCustomZoneSetsMap().empty());
-                Assert::IsTrue(data.GetAppZoneHistoryMap().empty());
-                Assert::IsFalse(data.GetDeviceInfoMap().empty());
+                Assert::IsTrue(data.GetCustomZoneSetsMap()->empty());
+                Assert::IsTrue(data.GetAppZoneHistoryMap()->empty());
+                Assert::IsFalse(data.GetDeviceInfoMap()->empty());
             }
 
             TEST_METHOD (LoadFancyZonesDataFromRegistry)
@@ -2021,6 +2050,210 @@ namespace FancyZonesUnitTests
 
                 Assert::IsFalse(data.RemoveAppLastZone(nullptr, deviceId, zoneSetId));
             }
+
+            TEST_METHOD (AppZoneHistoryMovedOntoExistingDesktop)
+            {
+                const std::wstring zoneSetId1 = L"zoneset-uuid-1";
+                const std::wstring zoneSetId2 = L"zoneset-uuid-2";
+                const std::wstring defaultDeviceId = L"AOC2460#4&fe3a015&0&UID65793_1920_1200_{00000000-0000-0000-0000-000000000000}";
+                const auto window = Mocks::WindowCreate(m_hInst);
+                FancyZonesData data;
+                data.SetSettingsModulePath(m_moduleName);
+
+                Assert::IsTrue(data.SetAppLastZones(window, m_defaultDeviceId, zoneSetId1, { 1 }));
+                Assert::IsTrue(data.SetAppLastZones(window, defaultDeviceId, zoneSetId2, { 2 }));
+
+                data.UpdatePrimaryDesktopData(L"{39B25DD2-130D-4B5D-8851-4791D66B1539}");
+
+                // Both entries are kept on the desktop, the one which was already there comes first
+                const auto history = data.GetAppZoneHistoryMap();
+                Assert::AreEqual((size_t)1, history->size());
+                const auto& entries = std::begin(*history)->second;
+                Assert::AreEqual((size_t)2, entries.size());
+                Assert::AreEqual(m_defaultDeviceId, entries[0].deviceId);
+                Assert::IsTrue(std::vector<size_t>{ 1 } == entries[0].zoneIndexSet);
+                Assert::AreEqual(m_defaultDeviceId, entries[1].deviceId);
+                Assert::IsTrue(std::vector<size_t>{ 2 } == entries[1].zoneIndexSet);
+
+                Assert::IsTrue(std::vector<size_t>{ 1 } == data.GetAppLastZoneIndexSet(window, m_defaultDeviceId, zoneSetId1));
+                Assert::IsTrue(std::vector<size_t>{ 2 } == data.GetAppLastZoneIndexSet(window, m_defaultDeviceId, zoneSetId2));
+                Assert::IsTrue(std::vector<size_t>{} == data.GetAppLastZoneIndexSet(window, defaultDeviceId, zoneSetId2));
+            }
+
+            TEST_METHOD (AppZoneHistoryDuplicatesSaved)
+            {
+                const AppZoneHistoryData first{ .zoneSetUuid = L"{33A2B101-06E0-437B-A61E-CDBECF502906}", .deviceId = m_defaultDeviceId, .zoneIndexSet = { 1 } };
+                const AppZoneHistoryData duplicate{ .zoneSetUuid = L"{33A2B101-06E0-437B-A61E-CDBECF502906}", .deviceId = m_defaultDeviceId, .zoneIndexSet = { 2 } };
+
+                FancyZonesData data;
+                data.SetSettingsModulePath(m_moduleName);
+                data.SetAppZoneHistory({ { L"app-path", { first, duplicate } } });
+                Assert::AreEqual((size_t)2, data.GetAppZoneHistoryMap()->at(L"app-path").size());
+                data.SaveAppZoneHistoryAndZoneSettings();
+
+                FancyZonesData loaded;
+                loaded.SetSettingsModulePath(m_moduleName);
+                loaded.LoadFancyZonesData();
+
+                const auto history = loaded.GetAppZoneHistoryMap();
+                Assert::AreEqual((size_t)1, history->size());
+                const auto& entries = history->at(L"app-path");
+                Assert::AreEqual((size_t)2, entries.size());
+                Assert::IsTrue(std::vector<size_t>{ 1 } == entries[0].zoneIndexSet);
+                Assert::IsTrue(std::vector<size_t>{ 2 } == entries[1].zoneIndexSet);
+            }
+    };
+
+    TEST_CLASS (PersistedJsonUnitTests)
+    {
+        const std::wstring m_deviceId = L"AOC2460#4&fe3a015&0&UID65793_1920_1200_{39B25DD2-130D-4B5D-8851-4791D66B1539}";
+        const std::wstring m_uuid = L"{33A2B101-06E0-437B-A61E-CDBECF502906}";
+        const std::wstring m_defaultDeviceStr = L"{\"device-id\": \"" + m_deviceId + L"\", \"active-zoneset\": {\"type\": \"custom\", \"uuid\": \"" + m_uuid + L"\"}, \"editor-show-spacing\": true, \"editor-spacing\": 16, \"editor-zone-count\": 3}";
+
+        TAppZoneHistoryMap MakeAppZoneHistory(size_t appCount) const
+        {
+            TAppZoneHistoryMap appZoneHistoryMap;
+            for (size_t i = 0; i < appCount; i++)
+            {
+                AppZoneHistoryData data{ .zoneSetUuid = m_uuid, .deviceId = m_deviceId, .zoneIndexSet = { i % 4, i % 4 + 1, 70 } };
+                appZoneHistoryMap[L"C:\\Program Files\\App " + std::to_wstring(i) + L"\\app.exe"] = { data, data };
+            }
+            return appZoneHistoryMap;
+        }
+
+        TEST_METHOD (ZoneSettingsSameAsStringify)
+        {
+            const GridLayoutInfo grid(GridLayoutInfo::Full{
+                .rows = 1,
+                .columns = 3,
+                .rowsPercents = { 10000 },
+                .columnsPercents = { 2500, 5000, 2500 },
+                .cellChildMap = { { 0, 1, 2 } },
+                .showSpacing = true,
+                .spacing = -5,
+                .sensitivityRadius = 25 });
+            const CanvasLayoutInfo canvas{ 1920, 1080, { { 0, 0, 960, 1080 }, { 960, 0, 960, 1080 } }, 20 };
+
+            const TDeviceInfoMap devices{ { m_deviceId, DeviceInfoData{ ZoneSetData{ m_uuid, ZoneSetLayoutType::Custom }, true, 16, 3, 20 } } };
+            const TCustomZoneSetsMap customZoneSets{
+                { m_uuid, CustomZoneSetData{ L"\"quoted\" \\ \u043a\u0438\u0440\u0438\u043b\u043b\u0438\u0446\u0430\t\U0001F600", CustomLayoutType::Grid, grid } },
+                { L"{33A2B101-06E0-437B-A61E-CDBECF502907}", CustomZoneSetData{ L"canvas", CustomLayoutType::Canvas, canvas } },
+            };
+            const TLayoutQuickKeysMap quickKeys{ { m_uuid, 9 } };
+            const auto templates = json::JsonArray::Parse(L"[{\"type\": \"focus\", \"show-spacing\": false, \"spacing\": 15.0, \"zone-count\": 7, \"sensitivity-radius\": 25}]");
+
+            json::JsonObject root{};
+            root.SetNamedValue(L"devices", JsonObjectReference::SerializeDeviceInfos(devices));
+            root.SetNamedValue(L"custom-zone-sets", JsonObjectReference::SerializeCustomZoneSets(customZoneSets));
+            root.SetNamedValue(L"templates", templates);
+            root.SetNamedValue(L"quick-layout-keys", JsonObjectReference::SerializeQuickKeys(quickKeys));
+
+            const auto actual = WriteZoneSettingsJson(devices, customZoneSets, quickKeys, winrt::to_string(templates.Stringify()));
+            Assert::AreEqual(winrt::to_string(root.Stringify()), actual);
+
+            Assert::AreEqual(JsonObjectReference::SerializeDeviceInfos(devices).Stringify().c_str(), SerializeDeviceInfos(devices).Stringify().c_str());
+            Assert::AreEqual(JsonObjectReference::SerializeCustomZoneSets(customZoneSets).Stringify().c_str(), SerializeCustomZoneSets(customZoneSets).Stringify().c_str());
+            Assert::AreEqual(JsonObjectReference::SerializeQuickKeys(quickKeys).Stringify().c_str(), SerializeQuickKeys(quickKeys).Stringify().c_str());
+        }
+
+        TEST_METHOD (AppZoneHistorySameAsStringify)
+        {
+            AppZoneHistoryData data{ .zoneSetUuid = m_uuid, .deviceId = m_deviceId, .zoneIndexSet = { 0, 63, 64, 255 } };
+            const TAppZoneHistoryMap appZoneHistoryMap{
+                { L"C:\\Program Files\\\u043a\u0438\u0440\u0438\u043b\u043b\u0438\u0446\u0430\\app.exe", { data } },
+                { L"D:\\\"quoted\"\\\x1f\\\U0001F600.exe", { data, data } },
+            };
+
+            json::JsonObject root{};
+            root.SetNamedValue(L"app-zone-history", JsonObjectReference::SerializeAppZoneHistory(appZoneHistoryMap));
+
+            Assert::AreEqual(winrt::to_string(root.Stringify()), WriteAppZoneHistoryJson(appZoneHistoryMap));
+            Assert::AreEqual(JsonObjectReference::SerializeAppZoneHistory(appZoneHistoryMap).Stringify().c_str(), SerializeAppZoneHistory(appZoneHistoryMap).Stringify().c_str());
+        }
+
+        TEST_METHOD (ReadSameAsParse)
+        {
+            const std::wstring json = L"{\"devices\": [" + m_defaultDeviceStr + L", {\"device-id\": \"invalid\"}, {\"device-id\": \"" + m_deviceId + L"\", \"active-zoneset\": \"custom\"}],"
+                L" \"custom-zone-sets\": [{\"info\": {\"ref-width\": 1920, \"ref-height\": 1080, \"zones\": [{\"X\": 0, \"Y\": 0, \"width\": 960, \"height\": 1080}]}, \"uuid\": \"" + m_uuid + L"\", \"name\": \"canvas\", \"type\": \"canvas\"},"
+                L" {\"uuid\": \"{33A2B101-06E0-437B-A61E-CDBECF502907}\", \"name\": \"grid\", \"type\": \"grid\", \"info\": {\"rows\": 2, \"columns\": 1, \"rows-percentage\": [5000], \"columns-percentage\": [10000], \"cell-child-map\": [[0]]}}],"
+                L" \"quick-layout-keys\": [{\"uuid\": \"" + m_uuid + L"\", \"key\": 1.5}, {\"uuid\": \"bad\", \"key\": 2}],"
+                L" \"app-zone-history\": [{\"app-path\": \"legacy\", \"zone-index\": 3, \"device-id\": \"" + m_deviceId + L"\", \"zoneset-uuid\": \"" + m_uuid + L"\"},"
+                L" {\"app-path\": \"mistyped\", \"history\": [{\"zone-index-set\": 1, \"device-id\": \"" + m_deviceId + L"\", \"zoneset-uuid\": \"" + m_uuid + L"\"}]},"
+                L" {\"app-path\": \"skipped\", \"history\": [{\"zone-index-set\": [1], \"device-id\": \"invalid\", \"zoneset-uuid\": \"" + m_uuid + L"\"}, {\"zone-index-set\": [2], \"device-id\": \"" + m_deviceId + L"\", \"zoneset-uuid\": \"" + m_uuid + L"\"}]}]}";
+
+            const auto expected = json::JsonObject::Parse(json);
+            const auto actual = ReadZoneSettingsJson(winrt::to_string(json));
+            Assert::IsTrue(actual.has_value());
+
+            // Same maps as the reference json::JsonObject implementation, compared through its serialization
+            const auto devices = JsonObjectReference::SerializeDeviceInfos(JsonObjectReference::ParseDeviceInfos(expected)).Stringify();
+            Assert::AreEqual(devices.c_str(), JsonObjectReference::SerializeDeviceInfos(actual->deviceInfoMap).Stringify().c_str());
+            Assert::AreEqual(devices.c_str(), JsonObjectReference::SerializeDeviceInfos(ParseDeviceInfos(expected)).Stringify().c_str());
+
+            const auto customZoneSets = JsonObjectReference::SerializeCustomZoneSets(JsonObjectReference::ParseCustomZoneSets(expected)).Stringify();
+            Assert::AreEqual(customZoneSets.c_str(), JsonObjectReference::SerializeCustomZoneSets(actual->customZoneSetsMap).Stringify().c_str());
+            Assert::AreEqual(customZoneSets.c_str(), JsonObjectReference::SerializeCustomZoneSets(ParseCustomZoneSets(expected)).Stringify().c_str());
+
+            const auto quickKeys = JsonObjectReference::SerializeQuickKeys(JsonObjectReference::ParseQuickKeys(expected)).Stringify();
+            Assert::AreEqual(quickKeys.c_str(), JsonObjectReference::SerializeQuickKeys(actual->quickKeysMap).Stringify().c_str());
+            Assert::AreEqual(quickKeys.c_str(), JsonObjectReference::SerializeQuickKeys(ParseQuickKeys(expected)).Stringify().c_str());
+
+            const auto appZoneHistory = JsonObjectReference::SerializeAppZoneHistory(JsonObjectReference::ParseAppZoneHistory(expected)).Stringify();
+            Assert::AreEqual(appZoneHistory.c_str(), JsonObjectReference::SerializeAppZoneHistory(actual->appZoneHistoryMap).Stringify().c_str());
+            Assert::AreEqual(appZoneHistory.c_str(), JsonObjectReference::SerializeAppZoneHistory(ParseAppZoneHistory(expected)).Stringify().c_str());
+
+            Assert::AreEqual((size_t)1, actual->deviceInfoMap.size());
+            Assert::AreEqual((size_t)1, actual->customZoneSetsMap.size());
+            Assert::AreEqual((size_t)2, actual->appZoneHistoryMap.size());
+        }
+
+        TEST_METHOD (ReadInvalidJson)
+        {
+            Assert::IsFalse(ReadZoneSettingsJson("{ \"app-zone-history\": [], \"devices\": [{\"device-id\": \"").has_value());
+            Assert::IsFalse(ReadZoneSettingsJson("[]").has_value());
+            Assert::IsFalse(ReadAppZoneHistoryJson("{\"app-zone-history\": []} []").has_value());
+
+            // A section of the wrong type is left empty, the others are still read
+            const auto data = ReadZoneSettingsJson("{\"devices\": {}, \"custom-zone-sets\": [1], \"quick-layout-keys\": [{\"uuid\": \"{33A2B101-06E0-437B-A61E-CDBECF502906}\", \"key\": 2}]}");
+            Assert::IsTrue(data.has_value());
+            Assert::IsTrue(data->deviceInfoMap.empty());
+            Assert::IsTrue(data->customZoneSetsMap.empty());
+            Assert::AreEqual(2, data->quickKeysMap.at(m_uuid));
+        }
+
+        TEST_METHOD (AppZoneHistoryPerformance)
+        {
+            // About 5 MB of app zone history
+            const auto appZoneHistoryMap = MakeAppZoneHistory(16'000);
+
+            using ms = std::chrono::duration<double, std::milli>;
+            auto start = std::chrono::steady_clock::now();
+            const auto text = WriteAppZoneHistoryJson(appZoneHistoryMap);
+            const auto codecSave = ms(std::chrono::steady_clock::now() - start).count();
+
+            start = std::chrono::steady_clock::now();
+            const auto parsed = ReadAppZoneHistoryJson(text);
+            const auto codecLoad = ms(std::chrono::steady_clock::now() - start).count();
+
+            start = std::chrono::steady_clock::now();
+            json::JsonObject root{};
+            root.SetNamedValue(L"app-zone-history", JsonObjectReference::SerializeAppZoneHistory(appZoneHistoryMap));
+            const auto stringified = winrt::to_string(root.Stringify());
+            const auto winrtSave = ms(std::chrono::steady_clock::now() - start).count();
+
+            start = std::chrono::steady_clock::now();
+            const auto winrtParsed = JsonObjectReference::ParseAppZoneHistory(json::JsonValue::Parse(winrt::to_hstring(stringified)).GetObjectW());
+            const auto winrtLoad = ms(std::chrono::steady_clock::now() - start).count();
+
+            Assert::IsTrue(text == stringified);
+            Assert::IsTrue(parsed.has_value());
+            Assert::AreEqual(appZoneHistoryMap.size(), parsed->size());
+            Assert::AreEqual(winrtParsed.size(), parsed->size());
+
+            const auto message = std::to_wstring(text.size() / 1024) + L" KB app zone history, codec save " + std::to_wstring(codecSave) + L" ms, load " + std::to_wstring(codecLoad) +
+                                 L" ms; json::JsonObject save " + std::to_wstring(winrtSave) + L" ms, load " + std::to_wstring(winrtLoad) + L" ms\n";
+            Logger::WriteMessage(message.c_str());
+        }
     };
 
     TEST_CLASS(EditorArgsUnitTests)
@@ -0,0 +1,485 @@
+#include "pch.h"
+#include "JsonObjectReference.h"
+
+#include <FancyZonesLib/FancyZonesData.h>
+#include <FancyZonesLib/FancyZonesDataTypes.h>
+#include <FancyZonesLib/util.h>
+
+using namespace FancyZonesDataTypes;
+using namespace JSONHelpers;
+
+namespace NonLocalizable
+{
+    const wchar_t ActiveZoneSetStr[] = L"active-zoneset";
+    const wchar_t AppPathStr[] = L"app-path";
+    const wchar_t AppZoneHistoryStr[] = L"app-zone-history";
+    const wchar_t CanvasStr[] = L"canvas";
+    const wchar_t CellChildMapStr[] = L"cell-child-map";
+    const wchar_t ColumnsPercentageStr[] = L"columns-percentage";
+    const wchar_t ColumnsStr[] = L"columns";
+    const wchar_t CustomZoneSetsStr[] = L"custom-zone-sets";
+    const wchar_t DeviceIdStr[] = L"device-id";
+    const wchar_t DevicesStr[] = L"devices";
+    const wchar_t EditorShowSpacingStr[] = L"editor-show-spacing";
+    const wchar_t EditorSpacingStr[] = L"editor-spacing";
+    const wchar_t EditorZoneCountStr[] = L"editor-zone-count";
+    const wchar_t EditorSensitivityRadiusStr[] = L"editor-sensitivity-radius";
+    const wchar_t GridStr[] = L"grid";
+    const wchar_t HeightStr[] = L"height";
+    const wchar_t HistoryStr[] = L"history";
+    const wchar_t InfoStr[] = L"info";
+    const wchar_t NameStr[] = L"name";
+    const wchar_t QuickAccessKey[] = L"key";
+    const wchar_t QuickAccessUuid[] = L"uuid";
+    const wchar_t QuickLayoutKeys[] = L"quick-layout-keys";
+    const wchar_t RefHeightStr[] = L"ref-height";
+    const wchar_t RefWidthStr[] = L"ref-width";
+    const wchar_t RowsPercentageStr[] = L"rows-percentage";
+    const wchar_t RowsStr[] = L"rows";
+    const wchar_t SensitivityRadius[] = L"sensitivity-radius";
+    const wchar_t ShowSpacing[] = L"show-spacing";
+    const wchar_t Spacing[] = L"spacing";
+    const wchar_t TypeStr[] = L"type";
+    const wchar_t UuidStr[] = L"uuid";
+    const wchar_t WidthStr[] = L"width";
+    const wchar_t XStr[] = L"X";
+    const wchar_t YStr[] = L"Y";
+    const wchar_t ZoneIndexSetStr[] = L"zone-index-set";
+    const wchar_t ZoneIndexStr[] = L"zone-index";
+    const wchar_t ZoneSetUuidStr[] = L"zoneset-uuid";
+    const wchar_t ZonesStr[] = L"zones";
+}
+
+namespace
+{
+    json::JsonArray NumVecToJsonArray(const std::vector<int>& vec)
+    {
+        json::JsonArray arr;
+        for (const auto& val : vec)
+        {
+            arr.Append(json::JsonValue::CreateNumberValue(val));
+        }
+
+        return arr;
+    }
+
+    std::vector<int> JsonArrayToNumVec(const json::JsonArray& arr)
+    {
+        std::vector<int> vec;
+        for (const auto& val : arr)
+        {
+            vec.emplace_back(static_cast<int>(val.GetNumber()));
+        }
+
+        return vec;
+    }
+
+    json::JsonObject CanvasLayoutInfoToJson(const CanvasLayoutInfo& canvasInfo)
+    {
+        json::JsonObject infoJson{};
+        infoJson.SetNamedValue(NonLocalizable::RefWidthStr, json::value(canvasInfo.lastWorkAreaWidth));
+        infoJson.SetNamedValue(NonLocalizable::RefHeightStr, json::value(canvasInfo.lastWorkAreaHeight));
+
+        json::JsonArray zonesJson;
+        for (const auto& [x, y, width, height] : canvasInfo.zones)
+        {
+            json::JsonObject zoneJson;
+            zoneJson.SetNamedValue(NonLocalizable::XStr, json::value(x));
+            zoneJson.SetNamedValue(NonLocalizable::YStr, json::value(y));
+            zoneJson.SetNamedValue(NonLocalizable::WidthStr, json::value(width));
+            zoneJson.SetNamedValue(NonLocalizable::HeightStr, json::value(height));
+            zonesJson.Append(zoneJson);
+        }
+        infoJson.SetNamedValue(NonLocalizable::ZonesStr, zonesJson);
+        infoJson.SetNamedValue(NonLocalizable::SensitivityRadius, json::value(canvasInfo.sensitivityRadius));
+        return infoJson;
+    }
+
+    std::optional<CanvasLayoutInfo> CanvasLayoutInfoFromJson(const json::JsonObject& infoJson)
+    {
+        CanvasLayoutInfo info;
+        info.lastWorkAreaWidth = static_cast<int>(infoJson.GetNamedNumber(NonLocalizable::RefWidthStr));
+        info.lastWorkAreaHeight = static_cast<int>(infoJson.GetNamedNumber(NonLocalizable::RefHeightStr));
+
+        json::JsonArray zonesJson = infoJson.GetNamedArray(NonLocalizable::ZonesStr);
+        for (uint32_t i = 0; i < zonesJson.Size(); ++i)
+        {
+            json::JsonObject zoneJson = zonesJson.GetObjectAt(i);
+            const int x = static_cast<int>(zoneJson.GetNamedNumber(NonLocalizable::XStr));
+            const int y = static_cast<int>(zoneJson.GetNamedNumber(NonLocalizable::YStr));
+            const int width = static_cast<int>(zoneJson.GetNamedNumber(NonLocalizable::WidthStr));
+            const int height = static_cast<int>(zoneJson.GetNamedNumber(NonLocalizable::HeightStr));
+            info.zones.push_back(CanvasLayoutInfo::Rect{ x, y, width, height });
+        }
+
+        info.sensitivityRadius = static_cast<int>(infoJson.GetNamedNumber(NonLocalizable::SensitivityRadius, DefaultValues::SensitivityRadius));
+        return info;
+    }
+
+    json::JsonObject GridLayoutInfoToJson(const GridLayoutInfo& gridInfo)
+    {
+        json::JsonObject infoJson;
+        infoJson.SetNamedValue(NonLocalizable::RowsStr, json::value(gridInfo.m_rows));
+        infoJson.SetNamedValue(NonLocalizable::ColumnsStr, json::value(gridInfo.m_columns));
+        infoJson.SetNamedValue(NonLocalizable::RowsPercentageStr, NumVecToJsonArray(gridInfo.m_rowsPercents));
+        infoJson.SetNamedValue(NonLocalizable::ColumnsPercentageStr, NumVecToJsonArray(gridInfo.m_columnsPercents));
+
+        json::JsonArray cellChildMapJson;
+        for (const auto& cellsRow : gridInfo.m_cellChildMap)
+        {
+            cellChildMapJson.Append(NumVecToJsonArray(cellsRow));
+        }
+        infoJson.SetNamedValue(NonLocalizable::CellChildMapStr, cellChildMapJson);
+
+        infoJson.SetNamedValue(NonLocalizable::SensitivityRadius, json::value(gridInfo.m_sensitivityRadius));
+        infoJson.SetNamedValue(NonLocalizable::ShowSpacing, json::value(gridInfo.m_showSpacing));
+        infoJson.SetNamedValue(NonLocalizable::Spacing, json::value(gridInfo.m_spacing));
+        return infoJson;
+    }
+
+    std::optional<GridLayoutInfo> GridLayoutInfoFromJson(const json::JsonObject& infoJson)
+    {
+        GridLayoutInfo info(GridLayoutInfo::Minimal{});
+        info.m_rows = static_cast<int>(infoJson.GetNamedNumber(NonLocalizable::RowsStr));
+        info.m_columns = static_cast<int>(infoJson.GetNamedNumber(NonLocalizable::ColumnsStr));
+
+        json::JsonArray rowsPercentage = infoJson.GetNamedArray(NonLocalizable::RowsPercentageStr);
+        json::JsonArray columnsPercentage = infoJson.GetNamedArray(NonLocalizable::ColumnsPercentageStr);
+        json::JsonArray cellChildMap = infoJson.GetNamedArray(NonLocalizable::CellChildMapStr);
+
+        if (rowsPercentage.Size() != static_cast<uint32_t>(info.m_rows) || columnsPercentage.Size() != static_cast<uint32_t>(info.m_columns) || cellChildMap.Size() != static_cast<uint32_t>(info.m_rows))
+        {
+            return std::nullopt;
+        }
+
+        info.m_rowsPercents = JsonArrayToNumVec(rowsPercentage);
+        info.m_columnsPercents = JsonArrayToNumVec(columnsPercentage);
+        for (const auto& cellsRow : cellChildMap)
+        {
+            const auto cellsArray = cellsRow.GetArray();
+            if (cellsArray.Size() != static_cast<uint32_t>(info.m_columns))
+            {
+                return std::nullopt;
+            }
+            info.m_cellChildMap.push_back(JsonArrayToNumVec(cellsArray));
+        }
+
+        info.m_showSpacing = infoJson.GetNamedBoolean(NonLocalizable::ShowSpacing, DefaultValues::ShowSpacing);
+        info.m_spacing = static_cast<int>(infoJson.GetNamedNumber(NonLocalizable::Spacing, DefaultValues::Spacing));
+        info.m_sensitivityRadius = static_cast<int>(infoJson.GetNamedNumber(NonLocalizable::SensitivityRadius, DefaultValues::SensitivityRadius));
+        return info;
+    }
+
+    json::JsonObject CustomZoneSetToJson(const std::wstring& uuid, const CustomZoneSetData& data)
+    {
+        json::JsonObject result{};
+        result.SetNamedValue(NonLocalizable::UuidStr, json::value(uuid));
+        result.SetNamedValue(NonLocalizable::NameStr, json::value(data.name));
+        if (data.type == CustomLayoutType::Canvas)
+        {
+            result.SetNamedValue(NonLocalizable::TypeStr, json::value(NonLocalizable::CanvasStr));
+            result.SetNamedValue(NonLocalizable::InfoStr, CanvasLayoutInfoToJson(std::get<CanvasLayoutInfo>(data.info)));
+        }
+        else
+        {
+            result.SetNamedValue(NonLocalizable::TypeStr, json::value(NonLocalizable::GridStr));
+            result.SetNamedValue(NonLocalizable::InfoStr, GridLayoutInfoToJson(std::get<GridLayoutInfo>(data.info)));
+        }
+        return result;
+    }
+
+    std::optional<CustomZoneSetJSON> CustomZoneSetFromJson(const json::JsonObject& customZoneSet)
+    {
+        try
+        {
+            CustomZoneSetJSON result;
+            result.uuid = customZoneSet.GetNamedString(NonLocalizable::UuidStr);
+            if (!FancyZonesUtils::IsValidGuid(result.uuid))
+            {
+                return std::nullopt;
+            }
+
+            result.data.name = customZoneSet.GetNamedString(NonLocalizable::NameStr);
+
+            json::JsonObject infoJson = customZoneSet.GetNamedObject(NonLocalizable::InfoStr);
+            const std::wstring zoneSetType{ customZoneSet.GetNamedString(NonLocalizable::TypeStr) };
+            if (zoneSetType == NonLocalizable::CanvasStr)
+            {
+                auto info = CanvasLayoutInfoFromJson(infoJson);
+                if (!info.has_value())
+                {
+                    return std::nullopt;
+                }
+                result.data.type = CustomLayoutType::Canvas;
+                result.data.info = std::move(*info);
+            }
+            else if (zoneSetType == NonLocalizable::GridStr)
+            {
+                auto info = GridLayoutInfoFromJson(infoJson);
+                if (!info.has_value())
+                {
+                    return std::nullopt;
+                }
+                result.data.type = CustomLayoutType::Grid;
+                result.data.info = std::move(*info);
+            }
+            else
+            {
+                return std::nullopt;
+            }
+
+            return result;
+        }
+        catch (const winrt::hresult_error&)
+        {
+            return std::nullopt;
+        }
+    }
+
+    std::optional<AppZoneHistoryData> AppZoneHistoryItemFromJson(const json::JsonObject& json)
+    {
+        AppZoneHistoryData data;
+        if (json.HasKey(NonLocalizable::ZoneIndexSetStr))
+        {
+            for (const auto& value : json.GetNamedArray(NonLocalizable::ZoneIndexSetStr))
+            {
+                data.zoneIndexSet.push_back(static_cast<size_t>(value.GetNumber()));
+            }
+        }
+        else if (json.HasKey(NonLocalizable::ZoneIndexStr))
+        {
+            data.zoneIndexSet = { static_cast<size_t>(json.GetNamedNumber(NonLocalizable::ZoneIndexStr)) };
+        }
+
+        data.deviceId = json.GetNamedString(NonLocalizable::DeviceIdStr);
+        data.zoneSetUuid = json.GetNamedString(NonLocalizable::ZoneSetUuidStr);
+
+        if (!FancyZonesUtils::IsValidGuid(data.zoneSetUuid) || !FancyZonesUtils::IsValidDeviceId(data.deviceId))
+        {
+            return std::nullopt;
+        }
+
+        return data;
+    }
+
+    json::JsonObject AppZoneHistoryToJson(const std::wstring& appPath, const std::vector<AppZoneHistoryData>& history)
+    {
+        json::JsonObject result{};
+        result.SetNamedValue(NonLocalizable::AppPathStr, json::value(appPath));
+
+        json::JsonArray appHistoryArray;
+        for (const auto& data : history)
+        {
+            json::JsonArray jsonIndexSet;
+            for (size_t index : data.zoneIndexSet)
+            {
+                jsonIndexSet.Append(json::value(static_cast<int>(index)));
+            }
+
+            json::JsonObject desktopData;
+            desktopData.SetNamedValue(NonLocalizable::ZoneIndexSetStr, jsonIndexSet);
+            desktopData.SetNamedValue(NonLocalizable::DeviceIdStr, json::value(data.deviceId));
+            desktopData.SetNamedValue(NonLocalizable::ZoneSetUuidStr, json::value(data.zoneSetUuid));
+            appHistoryArray.Append(desktopData);
+        }
+        result.SetNamedValue(NonLocalizable::HistoryStr, appHistoryArray);
+
+        return result;
+    }
+
+    std::optional<AppZoneHistoryJSON> AppZoneHistoryFromJson(const json::JsonObject& zoneSet)
+    {
+        try
+        {
+            AppZoneHistoryJSON result;
+            result.appPath = zoneSet.GetNamedString(NonLocalizable::AppPathStr);
+            if (zoneSet.HasKey(NonLocalizable::HistoryStr))
+            {
+                auto appHistoryArray = zoneSet.GetNamedArray(NonLocalizable::HistoryStr);
+                for (uint32_t i = 0; i < appHistoryArray.Size(); ++i)
+                {
+                    if (auto data = AppZoneHistoryItemFromJson(appHistoryArray.GetObjectAt(i)); data.has_value())
+                    {
+                        result.data.push_back(std::move(*data));
+                    }
+                }
+            }
+            else if (auto data = AppZoneHistoryItemFromJson(zoneSet); data.has_value())
+            {
+                // previous file format, with single desktop layout information per application
+                result.data.push_back(std::move(*data));
+            }
+
+            if (result.data.empty())
+            {
+                return std::nullopt;
+            }
+
+            return result;
+        }
+        catch (const winrt::hresult_error&)
+        {
+            return std::nullopt;
+        }
+    }
+
+    json::JsonObject DeviceInfoToJson(const std::wstring& deviceId, const DeviceInfoData& data)
+    {
+        json::JsonObject activeZoneSet{};
+        activeZoneSet.SetNamedValue(NonLocalizable::UuidStr, json::value(data.activeZoneSet.uuid));
+        activeZoneSet.SetNamedValue(NonLocalizable::TypeStr, json::value(TypeToString(data.activeZoneSet.type)));
+
+        json::JsonObject result{};
+        result.SetNamedValue(NonLocalizable::DeviceIdStr, json::value(deviceId));
+        result.SetNamedValue(NonLocalizable::ActiveZoneSetStr, activeZoneSet);
+        result.SetNamedValue(NonLocalizable::EditorShowSpacingStr, json::value(data.showSpacing));
+        result.SetNamedValue(NonLocalizable::EditorSpacingStr, json::value(data.spacing));
+        result.SetNamedValue(NonLocalizable::EditorZoneCountStr, json::value(data.zoneCount));
+        result.SetNamedValue(NonLocalizable::EditorSensitivityRadiusStr, json::value(data.sensitivityRadius));
+        return result;
+    }
+
+    std::optional<DeviceInfoJSON> DeviceInfoFromJson(const json::JsonObject& device)
+    {
+        try
+        {
+            DeviceInfoJSON result;
+            result.deviceId = device.GetNamedString(NonLocalizable::DeviceIdStr);
+            if (!FancyZonesUtils::IsValidDeviceId(result.deviceId))
+            {
+                return std::nullopt;
+            }
+
+            const auto activeZoneSet = device.GetNamedObject(NonLocalizable::ActiveZoneSetStr);
+            result.data.activeZoneSet.uuid = activeZoneSet.GetNamedString(NonLocalizable::UuidStr);
+            result.data.activeZoneSet.type = TypeFromString(std::wstring{ activeZoneSet.GetNamedString(NonLocalizable::TypeStr) });
+            if (!FancyZonesUtils::IsValidGuid(result.data.activeZoneSet.uuid))
+            {
+                return std::nullopt;
+            }
+
+            result.data.showSpacing = device.GetNamedBoolean(NonLocalizable::EditorShowSpacingStr);
+            result.data.spacing = static_cast<int>(device.GetNamedNumber(NonLocalizable::EditorSpacingStr));
+            result.data.zoneCount = static_cast<int>(device.GetNamedNumber(NonLocalizable::EditorZoneCountStr));
+            result.data.sensitivityRadius = static_cast<int>(device.GetNamedNumber(NonLocalizable::EditorSensitivityRadiusStr, DefaultValues::SensitivityRadius));
+            return result;
+        }
+        catch (const winrt::hresult_error&)
+        {
+            return std::nullopt;
+        }
+    }
+
+    json::JsonObject LayoutQuickKeyToJson(const std::wstring& layoutUuid, int key)
+    {
+        json::JsonObject result{};
+        result.SetNamedValue(NonLocalizable::QuickAccessUuid, json::value(layoutUuid));
+        result.SetNamedValue(NonLocalizable::QuickAccessKey, json::value(key));
+        return result;
+    }
+
+    std::optional<LayoutQuickKeyJSON> LayoutQuickKeyFromJson(const json::JsonObject& layoutQuickKey)
+    {
+        try
+        {
+            LayoutQuickKeyJSON result;
+            result.layoutUuid = layoutQuickKey.GetNamedString(NonLocalizable::QuickAccessUuid);
+            if (!FancyZonesUtils::IsValidGuid(result.layoutUuid))
+            {
+                return std::nullopt;
+            }
+
+            result.key = static_cast<int>(layoutQuickKey.GetNamedNumber(NonLocalizable::QuickAccessKey));
+            return result;
+        }
+        catch (const winrt::hresult_error&)
+        {
+            return std::nullopt;
+        }
+    }
+
+    // An element that isn't an object, or a missing array, leaves the whole map empty
+    template<typename Map, typename FromJson, typename Insert>
+    Map ParseArray(const json::JsonObject& fancyZonesDataJSON, const wchar_t* key, FromJson&& fromJson, Insert&& insert)
+    {
+        try
+        {
+            Map map{};
+            const auto array = fancyZonesDataJSON.GetNamedArray(key);
+            for (uint32_t i = 0; i < array.Size(); ++i)
+            {
+                if (auto item = fromJson(array.GetObjectAt(i)); item.has_value())
+                {
+                    insert(map, std::move(*item));
+                }
+            }
+            return map;
+        }
+        catch (const winrt::hresult_error&)
+        {
+            return {};
+        }
+    }
+
+    template<typename Map, typename ToJson>
+    json::JsonArray SerializeArray(const Map& map, ToJson&& toJson)
+    {
+        json::JsonArray array;
+        for (const auto& [key, value] : map)
+        {
+            array.Append(toJson(key, value));
+        }
+        return array;
+    }
+}
+
+namespace JsonObjectReference
+{
+    TAppZoneHistoryMap ParseAppZoneHistory(const json::JsonObject& fancyZonesDataJSON)
+    {
+        return ParseArray<TAppZoneHistoryMap>(fancyZonesDataJSON, NonLocalizable::AppZoneHistoryStr, AppZoneHistoryFromJson, [](TAppZoneHistoryMap& map, AppZoneHistoryJSON&& item) {
+            map[item.appPath] = std::move(item.data);
+        });
+    }
+
+    json::JsonArray SerializeAppZoneHistory(const TAppZoneHistoryMap& appZoneHistoryMap)
+    {
+        return SerializeArray(appZoneHistoryMap, AppZoneHistoryToJson);
+    }
+
+    TDeviceInfoMap ParseDeviceInfos(const json::JsonObject& fancyZonesDataJSON)
+    {
+        return ParseArray<TDeviceInfoMap>(fancyZonesDataJSON, NonLocalizable::DevicesStr, DeviceInfoFromJson, [](TDeviceInfoMap& map, DeviceInfoJSON&& item) {
+            map[item.deviceId] = std::move(item.data);
+        });
+    }
+
+    json::JsonArray SerializeDeviceInfos(const TDeviceInfoMap& deviceInfoMap)
+    {
+        return SerializeArray(deviceInfoMap, DeviceInfoToJson);
+    }
+
+    TCustomZoneSetsMap ParseCustomZoneSets(const json::JsonObject& fancyZonesDataJSON)
+    {
+        return ParseArray<TCustomZoneSetsMap>(fancyZonesDataJSON, NonLocalizable::CustomZoneSetsStr, CustomZoneSetFromJson, [](TCustomZoneSetsMap& map, CustomZoneSetJSON&& item) {
+            map[item.uuid] = std::move(item.data);
+        });
+    }
+
+    json::JsonArray SerializeCustomZoneSets(const TCustomZoneSetsMap& customZoneSetsMap)
+    {
+        return SerializeArray(customZoneSetsMap, CustomZoneSetToJson);
+    }
+
+    TLayoutQuickKeysMap ParseQuickKeys(const json::JsonObject& fancyZonesDataJSON)
+    {
+        return ParseArray<TLayoutQuickKeysMap>(fancyZonesDataJSON, NonLocalizable::QuickLayoutKeys, LayoutQuickKeyFromJson, [](TLayoutQuickKeysMap& map, LayoutQuickKeyJSON&& item) {
+            map[item.layoutUuid] = item.key;
+        });
+    }
+
+    json::JsonArray SerializeQuickKeys(const TLayoutQuickKeysMap& quickKeysMap)
+    {
+        return SerializeArray(quickKeysMap, LayoutQuickKeyToJson);
+    }
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <FancyZonesLib/JsonHelpers.h>
+
+// json::JsonObject implementation of the settings file format the way JSONHelpers had it before the codec,
+// the codec based functions are checked against it
+namespace JsonObjectReference
+{
+    JSONHelpers::TAppZoneHistoryMap ParseAppZoneHistory(const json::JsonObject& fancyZonesDataJSON);
+    json::JsonArray SerializeAppZoneHistory(const JSONHelpers::TAppZoneHistoryMap& appZoneHistoryMap);
+
+    JSONHelpers::TDeviceInfoMap ParseDeviceInfos(const json::JsonObject& fancyZonesDataJSON);
+    json::JsonArray SerializeDeviceInfos(const JSONHelpers::TDeviceInfoMap& deviceInfoMap);
+
+    JSONHelpers::TCustomZoneSetsMap ParseCustomZoneSets(const json::JsonObject& fancyZonesDataJSON);
+    json::JsonArray SerializeCustomZoneSets(const JSONHelpers::TCustomZoneSetsMap& customZoneSetsMap);
+
+    JSONHelpers::TLayoutQuickKeysMap ParseQuickKeys(const json::JsonObject& fancyZonesDataJSON);
+    json::JsonArray SerializeQuickKeys(const JSONHelpers::TLayoutQuickKeysMap& quickKeysMap);
+}
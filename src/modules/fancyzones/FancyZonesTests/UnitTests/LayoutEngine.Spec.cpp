@@ -0,0 +1,436 @@
+#include "pch.h"
+#include <FancyZonesLib/LayoutEngine.h>
+
+#include <chrono>
+#include <random>
+#include <set>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace FancyZonesUnitTests
+{
+    namespace
+    {
+        using namespace LayoutEngine;
+
+        struct Monitor
+        {
+            long width;
+            long height;
+            int dpi;
+        };
+
+        // Common resolutions at their usual scaling, the work areas are the scaled down sizes
+        const Monitor monitors[] = {
+            { 1920, 1040, 96 },
+            { 2560, 1400, 144 },
+            { 3840, 2100, 192 },
+            { 1366, 728, 96 },
+            { 2880, 1760, 240 },
+            { 1280, 984, 120 },
+            { 3440, 1400, 120 },
+            { 1080, 1880, 96 },
+        };
+
+        long Area(const Rect& rect)
+        {
+            return rect.width() * rect.height();
+        }
+
+        bool Contains(const Rect& outer, const Rect& inner)
+        {
+            return inner.left >= outer.left && inner.top >= outer.top && inner.right <= outer.right && inner.bottom <= outer.bottom;
+        }
+
+        bool Intersect(const Rect& lhs, const Rect& rhs)
+        {
+            return lhs.left < rhs.right && rhs.left < lhs.right && lhs.top < rhs.bottom && rhs.top < lhs.bottom;
+        }
+
+        std::vector<Rect> Rects(const Zones& zones)
+        {
+            std::vector<Rect> rects;
+            for (const auto& zone : zones)
+            {
+                rects.push_back(zone.rect);
+            }
+            return rects;
+        }
+
+        void AssertZoneIds(const Zones& zones, int zoneCount)
+        {
+            std::set<size_t> ids;
+            for (const auto& zone : zones)
+            {
+                Assert::IsTrue(ids.insert(zone.id).second, L"Duplicate zone id");
+            }
+
+            Assert::AreEqual(static_cast<size_t>(zoneCount), ids.size());
+            Assert::AreEqual(static_cast<size_t>(zoneCount - 1), *ids.rbegin());
+        }
+
+        // Without spacing the zones of a grid tile the work area: they don't overlap and cover all of it
+        void AssertTiling(const Rect& workArea, const Zones& zones)
+        {
+            long area = 0;
+            for (size_t i = 0; i < zones.size(); i++)
+            {
+                Assert::IsTrue(Contains(workArea, zones[i].rect));
+                area += Area(zones[i].rect);
+                for (size_t j = i + 1; j < zones.size(); j++)
+                {
+                    Assert::IsFalse(Intersect(zones[i].rect, zones[j].rect));
+                }
+            }
+
+            Assert::AreEqual(Area(workArea), area);
+        }
+
+        // Monitors side by side, some of them below the others, with a random layout each
+        std::vector<ZoneGraph::Node> RandomDesktop(std::mt19937& rng, std::vector<Rect>& areas)
+        {
+            std::vector<ZoneGraph::Node> nodes;
+            const size_t monitorCount = 1 + rng() % 4;
+            long x = 0;
+            for (size_t area = 0; area < monitorCount; area++)
+            {
+                const auto& monitor = monitors[rng() % std::size(monitors)];
+                const long y = rng() % 2 ? 0 : monitor.height;
+                const Rect workArea{ x, y, x + monitor.width, y + monitor.height };
+                areas.push_back(workArea);
+                x += monitor.width;
+
+                const int zoneCount = rng() % 12;
+                const auto zones = rng() % 2 ? CalculateGridLayout({ 0, 0, monitor.width, monitor.height }, rng() % 2, zoneCount, rng() % 20) :
+                                               CalculateColumnsAndRowsLayout({ 0, 0, monitor.width, monitor.height }, rng() % 2, zoneCount, rng() % 20);
+                for (const auto& zone : zones)
+                {
+                    const Rect rect{ zone.rect.left + workArea.left, zone.rect.top + workArea.top, zone.rect.right + workArea.left, zone.rect.bottom + workArea.top };
+                    nodes.push_back({ .area = area, .zoneId = zone.id, .rect = rect });
+                }
+            }
+            return nodes;
+        }
+
+        // The search made on every snap hotkey for a window covering a zone: the other zones of its monitor,
+        // then the zones of the other monitors, then all zones from the opposite side of the desktop
+        std::pair<size_t, bool> SearchNext(const std::vector<ZoneGraph::Node>& nodes, const std::vector<Rect>& areas, size_t node, Direction direction)
+        {
+            std::vector<Rect> rects;
+            std::vector<size_t> indices;
+            auto search = [&](const Rect& window) {
+                const size_t result = ChooseNextZoneByPosition(direction, window, rects);
+                return result < rects.size() ? indices[result] : ZoneGraph::None;
+            };
+
+            for (size_t i = 0; i < nodes.size(); i++)
+            {
+                if (i != node && nodes[i].area == nodes[node].area)
+                {
+                    rects.push_back(nodes[i].rect);
+                    indices.push_back(i);
+                }
+            }
+
+            if (size_t result = search(nodes[node].rect); result != ZoneGraph::None)
+            {
+                return { result, true };
+            }
+
+            if (areas.size() < 2)
+            {
+                return { ZoneGraph::None, false };
+            }
+
+            rects.clear();
+            indices.clear();
+            for (size_t i = 0; i < nodes.size(); i++)
+            {
+                if (nodes[i].area != nodes[node].area)
+                {
+                    rects.push_back(nodes[i].rect);
+                    indices.push_back(i);
+                }
+            }
+
+            if (size_t result = search(nodes[node].rect); result != ZoneGraph::None)
+            {
+                return { result, false };
+            }
+
+            for (size_t i = 0; i < nodes.size(); i++)
+            {
+                if (nodes[i].area == nodes[node].area)
+                {
+                    rects.push_back(nodes[i].rect);
+                    indices.push_back(i);
+                }
+            }
+
+            Rect desktop = areas[0];
+            for (const auto& area : areas)
+            {
+                desktop = { (std::min)(desktop.left, area.left), (std::min)(desktop.top, area.top), (std::max)(desktop.right, area.right), (std::max)(desktop.bottom, area.bottom) };
+            }
+
+            return { search(PrepareRectForCycling(nodes[node].rect, desktop, direction)), false };
+        }
+    }
+
+    TEST_CLASS (LayoutEngineUnitTests)
+    {
+        TEST_METHOD (GridLayoutsTileWorkArea)
+        {
+            for (const auto& monitor : monitors)
+            {
+                const Rect workArea{ 0, 0, monitor.width, monitor.height };
+                for (int zoneCount = 1; zoneCount <= 40; zoneCount++)
+                {
+                    for (bool priorityGrid : { false, true })
+                    {
+                        const auto zones = CalculateGridLayout(workArea, priorityGrid, zoneCount, 0);
+                        AssertZoneIds(zones, zoneCount);
+                        AssertTiling(workArea, zones);
+                    }
+                }
+            }
+        }
+
+        TEST_METHOD (GridLayoutsKeepSpacing)
+        {
+            std::mt19937 rng(42);
+            for (int i = 0; i < 1000; i++)
+            {
+                const auto& monitor = monitors[rng() % std::size(monitors)];
+                const Rect workArea{ 0, 0, monitor.width, monitor.height };
+                const int zoneCount = 1 + rng() % 30;
+                const int spacing = rng() % 40;
+
+                const auto zones = CalculateGridLayout(workArea, rng() % 2, zoneCount, spacing);
+                AssertZoneIds(zones, zoneCount);
+
+                const Rect inner{ spacing, spacing, workArea.right - spacing, workArea.bottom - spacing };
+                for (size_t a = 0; a < zones.size(); a++)
+                {
+                    Assert::IsTrue(Contains(inner, zones[a].rect));
+                    Assert::IsTrue(zones[a].rect.width() >= 0 && zones[a].rect.height() >= 0);
+                    for (size_t b = a + 1; b < zones.size(); b++)
+                    {
+                        Assert::IsFalse(Intersect(zones[a].rect, zones[b].rect));
+                    }
+                }
+            }
+        }
+
+        TEST_METHOD (ColumnsAndRowsLayouts)
+        {
+            std::mt19937 rng(7);
+            for (int i = 0; i < 1000; i++)
+            {
+                const auto& monitor = monitors[rng() % std::size(monitors)];
+                const Rect workArea{ 0, 0, monitor.width, monitor.height };
+                const int zoneCount = 1 + rng() % 20;
+                const int spacing = rng() % 40;
+                const bool columns = rng() % 2;
+
+                const auto zones = CalculateColumnsAndRowsLayout(workArea, columns, zoneCount, spacing);
+                AssertZoneIds(zones, zoneCount);
+
+                // Zones follow each other separated by the spacing and fill the work area up to the spacing
+                long extent = 0;
+                for (size_t z = 0; z < zones.size(); z++)
+                {
+                    const auto& rect = zones[z].rect;
+                    Assert::AreEqual(static_cast<long>(spacing), columns ? rect.top : rect.left);
+                    Assert::AreEqual(columns ? workArea.height() - spacing : workArea.width() - spacing, columns ? rect.bottom : rect.right);
+                    if (z > 0)
+                    {
+                        const auto& previous = zones[z - 1].rect;
+                        Assert::AreEqual(static_cast<long>(spacing), columns ? rect.left - previous.right : rect.top - previous.bottom);
+                    }
+                    extent += columns ? rect.width() : rect.height();
+                }
+
+                const long total = (columns ? workArea.width() : workArea.height()) - spacing * (zoneCount + 1);
+                Assert::AreEqual(total, extent);
+            }
+        }
+
+        TEST_METHOD (FocusLayout)
+        {
+            const Rect workArea{ 0, 0, 1920, 1040 };
+            const auto zones = CalculateFocusLayout(workArea, 5);
+            AssertZoneIds(zones, 5);
+
+            for (size_t z = 1; z < zones.size(); z++)
+            {
+                const auto& rect = zones[z].rect;
+                const auto& previous = zones[z - 1].rect;
+                Assert::AreEqual(previous.left + 50, rect.left);
+                Assert::AreEqual(previous.top + 50, rect.top);
+                Assert::AreEqual(previous.width(), rect.width());
+                Assert::AreEqual(previous.height(), rect.height());
+            }
+        }
+
+        TEST_METHOD (InvalidZoneCount)
+        {
+            const Rect workArea{ 0, 0, 1920, 1040 };
+            Assert::IsTrue(CalculateFocusLayout(workArea, 0).empty());
+            Assert::IsTrue(CalculateColumnsAndRowsLayout(workArea, true, 0, 16).empty());
+            Assert::IsTrue(CalculateGridLayout(workArea, true, -1, 16).empty());
+        }
+
+        TEST_METHOD (CanvasZonesScaleWithDpi)
+        {
+            const std::vector<CanvasZone> canvas{ { 0, 0, 960, 1040 }, { 960, 0, 960, 520 }, { 960, 520, 960, 520 } };
+            for (const auto& monitor : monitors)
+            {
+                const auto zones = CalculateCanvasZones(canvas, monitor.dpi);
+                AssertZoneIds(zones, static_cast<int>(canvas.size()));
+                for (size_t z = 0; z < zones.size(); z++)
+                {
+                    Assert::AreEqual(static_cast<long>(canvas[z].x * monitor.dpi / DEFAULT_DPI), zones[z].rect.left);
+                    Assert::AreEqual(static_cast<long>(canvas[z].width * monitor.dpi / DEFAULT_DPI), zones[z].rect.width());
+                }
+            }
+        }
+
+        TEST_METHOD (NextZoneIsInDirection)
+        {
+            std::mt19937 rng(3);
+            for (int i = 0; i < 1000; i++)
+            {
+                const auto& monitor = monitors[rng() % std::size(monitors)];
+                const Rect workArea{ 0, 0, monitor.width, monitor.height };
+                auto zones = Rects(CalculateGridLayout(workArea, true, 2 + rng() % 15, 0));
+                const auto window = zones[rng() % zones.size()];
+                // The zones the window is in aren't candidates
+                std::erase(zones, window);
+
+                for (auto direction : { Direction::Left, Direction::Up, Direction::Right, Direction::Down })
+                {
+                    const auto next = ChooseNextZoneByPosition(direction, window, zones);
+                    if (next == zones.size())
+                    {
+                        continue;
+                    }
+
+                    const double dx = (zones[next].left + zones[next].right) / 2.0 - (window.left + window.right) / 2.0;
+                    const double dy = (zones[next].top + zones[next].bottom) / 2.0 - (window.top + window.bottom) / 2.0;
+                    switch (direction)
+                    {
+                    case Direction::Left:
+                        Assert::IsTrue(dx < 0.01);
+                        break;
+                    case Direction::Right:
+                        Assert::IsTrue(dx > -0.01);
+                        break;
+                    case Direction::Up:
+                        Assert::IsTrue(dy < 0);
+                        break;
+                    case Direction::Down:
+                        Assert::IsTrue(dy > 0);
+                        break;
+                    }
+                }
+            }
+        }
+
+        TEST_METHOD (NextZoneNoCandidates)
+        {
+            const Rect window{ 0, 0, 960, 1040 };
+            const std::vector<Rect> zones{ { 960, 0, 1920, 520 }, { 960, 520, 1920, 1040 } };
+            Assert::AreEqual(zones.size(), ChooseNextZoneByPosition(Direction::Left, window, zones));
+            Assert::AreEqual(static_cast<size_t>(0), ChooseNextZoneByPosition(Direction::Right, window, zones));
+            Assert::AreEqual(static_cast<size_t>(1), ChooseNextZoneByPosition(Direction::Down, zones[0], zones));
+            Assert::AreEqual(static_cast<size_t>(1), ChooseNextZoneByPosition(Direction::Right, zones[0], { zones[1] }));
+        }
+
+        TEST_METHOD (ZoneGraphMatchesSearch)
+        {
+            std::mt19937 rng(38);
+            for (int i = 0; i < 300; i++)
+            {
+                std::vector<Rect> areas;
+                const auto nodes = RandomDesktop(rng, areas);
+                const ZoneGraph graph(nodes, areas);
+                Assert::AreEqual(nodes.size(), graph.Size());
+
+                for (size_t node = 0; node < nodes.size(); node++)
+                {
+                    Assert::AreEqual(node, graph.Find(nodes[node].area, nodes[node].zoneId));
+                    for (auto direction : { Direction::Left, Direction::Up, Direction::Right, Direction::Down })
+                    {
+                        const auto [expected, sameArea] = SearchNext(nodes, areas, node, direction);
+                        const size_t neighbor = graph.Neighbor(node, direction);
+                        Assert::AreEqual(sameArea ? expected : ZoneGraph::None, neighbor);
+                        if (!sameArea)
+                        {
+                            Assert::AreEqual(expected, graph.NextAcrossAreas(node, direction));
+                        }
+                    }
+                }
+            }
+        }
+
+        TEST_METHOD (ZoneGraphSingleArea)
+        {
+            const Rect workArea{ 0, 0, 1920, 1040 };
+            const auto zones = CalculateGridLayout(workArea, false, 6, 0);
+
+            std::vector<ZoneGraph::Node> nodes;
+            for (const auto& zone : zones)
+            {
+                nodes.push_back({ .area = 0, .zoneId = zone.id, .rect = zone.rect });
+            }
+
+            const ZoneGraph graph(nodes, {});
+            for (size_t node = 0; node < nodes.size(); node++)
+            {
+                for (auto direction : { Direction::Left, Direction::Up, Direction::Right, Direction::Down })
+                {
+                    Assert::AreEqual(SearchNext(nodes, {}, node, direction).first, graph.Neighbor(node, direction));
+                    Assert::AreEqual(ZoneGraph::None, graph.NextAcrossAreas(node, direction));
+                }
+            }
+
+            Assert::AreEqual(ZoneGraph::None, graph.Find(1, 0));
+            Assert::AreEqual(ZoneGraph::None, graph.Find(0, zones.size()));
+        }
+
+        TEST_METHOD (Benchmark)
+        {
+            const std::vector<CanvasZone> canvas{ { 0, 0, 960, 1040 }, { 960, 0, 960, 520 }, { 960, 520, 960, 520 } };
+
+            constexpr int rounds = 20;
+            for (size_t monitorCount = 1; monitorCount <= std::size(monitors); monitorCount++)
+            {
+                size_t zoneTotal = 0;
+                const auto start = std::chrono::steady_clock::now();
+                for (int round = 0; round < rounds; ++round)
+                {
+                    for (size_t m = 0; m < monitorCount; m++)
+                    {
+                        const Rect workArea{ 0, 0, monitors[m].width, monitors[m].height };
+                        for (int zoneCount = 1; zoneCount <= 16; zoneCount++)
+                        {
+                            zoneTotal += CalculateFocusLayout(workArea, zoneCount).size();
+                            zoneTotal += CalculateColumnsAndRowsLayout(workArea, true, zoneCount, 16).size();
+                            zoneTotal += CalculateColumnsAndRowsLayout(workArea, false, zoneCount, 16).size();
+                            zoneTotal += CalculateGridLayout(workArea, false, zoneCount, 16).size();
+                            zoneTotal += CalculateGridLayout(workArea, true, zoneCount, 16).size();
+                        }
+                        zoneTotal += CalculateCanvasZones(canvas, monitors[m].dpi).size();
+                    }
+                }
+                const auto duration = std::chrono::steady_clock::now() - start;
+
+                using us = std::chrono::duration<double, std::micro>;
+                const auto message = std::to_wstring(monitorCount) + L" monitors: " + std::to_wstring(us(duration).count() / rounds) +
+                                     L" us for all layouts, " + std::to_wstring(zoneTotal / rounds) + L" zones\n";
+                Logger::WriteMessage(message.c_str());
+            }
+        }
+    };
+}
@@ -0,0 +1,64 @@
+#include "pch.h"
+#include "FancyZonesLib\ExcludedAppsMatcher.h"
+#include "FancyZonesLib\ProcessCache.h"
+
+#include <common/utils/process_path.h>
+
+#include <filesystem>
+
+#include "Util.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace FancyZonesUnitTests
+{
+    TEST_CLASS (ProcessCacheUnitTests)
+    {
+        HINSTANCE m_hInst{};
+
+        TEST_METHOD_INITIALIZE(Init)
+        {
+            m_hInst = (HINSTANCE)GetModuleHandleW(nullptr);
+        }
+
+        TEST_METHOD_CLEANUP(Cleanup)
+        {
+            ProcessCacheInstance().Clear();
+        }
+
+        TEST_METHOD (ProcessPathSameAsQuery)
+        {
+            const auto window = Mocks::WindowCreate(m_hInst);
+            const auto expected = get_process_path(window);
+
+            Assert::IsFalse(expected.empty());
+            Assert::AreEqual(expected, ProcessCacheInstance().GetProcessPath(window));
+            // Second lookup is served from the cache
+            Assert::AreEqual(expected, ProcessCacheInstance().GetProcessPath(window));
+        }
+
+        TEST_METHOD (ProcessPathInvalidWindow)
+        {
+            Assert::IsTrue(ProcessCacheInstance().GetProcessPath(nullptr).empty());
+        }
+
+        TEST_METHOD (ExclusionFollowsSettings)
+        {
+            const auto window = Mocks::WindowCreate(m_hInst);
+            auto fileName = std::filesystem::path(get_process_path(window)).filename().wstring();
+            CharUpperBuffW(fileName.data(), (DWORD)fileName.length());
+
+            Assert::IsFalse(ProcessCacheInstance().IsExcluded(window, ExcludedAppsMatcher({ L"NOTEPAD.EXE" })));
+            // A new set of exclusions replaces the cached verdict
+            Assert::IsTrue(ProcessCacheInstance().IsExcluded(window, ExcludedAppsMatcher({ L"NOTEPAD.EXE", fileName })));
+            Assert::IsFalse(ProcessCacheInstance().IsExcluded(window, ExcludedAppsMatcher(std::vector<std::wstring>{})));
+        }
+
+        TEST_METHOD (ExclusionPowerToysApps)
+        {
+            // Always excluded, but this window belongs to the test host
+            const auto window = Mocks::WindowCreate(m_hInst);
+            Assert::IsFalse(ProcessCacheInstance().IsExcluded(window, ExcludedAppsMatcher()));
+        }
+    };
+}
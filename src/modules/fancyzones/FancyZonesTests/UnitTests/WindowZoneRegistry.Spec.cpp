@@ -0,0 +1,134 @@
+#include "pch.h"
+#include "FancyZonesLib\Settings.h"
+#include "FancyZonesLib\WindowZoneRegistry.h"
+
+#include "Util.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace FancyZonesUnitTests
+{
+    TEST_CLASS (WindowZoneRegistryUnitTests)
+    {
+        WindowZoneRegistry m_registry;
+        HWND m_window;
+
+        // The properties only stick to real windows
+        static HWND CreateTestWindow()
+        {
+            return Mocks::WindowCreate(GetModuleHandleW(nullptr));
+        }
+
+        // Windows can only be destroyed by their own thread
+        static void DestroyTestWindow(HWND window)
+        {
+            ::SendMessage(window, WM_CLOSE, 0, 0);
+        }
+
+        TEST_METHOD_INITIALIZE(Init)
+        {
+            m_window = CreateTestWindow();
+        }
+
+        TEST_METHOD_CLEANUP(Cleanup)
+        {
+            m_registry.Unstamp(m_window);
+            DestroyTestWindow(m_window);
+        }
+
+        TEST_METHOD (NotZoned)
+        {
+            Assert::IsFalse(m_registry.IsZoned(m_window));
+            Assert::IsTrue(m_registry.GetZones(m_window).Empty());
+        }
+
+        TEST_METHOD (StampUnstamp)
+        {
+            m_registry.Stamp(m_window, { 1, 2 });
+            Assert::IsTrue(m_registry.IsZoned(m_window));
+            Assert::IsTrue(std::vector<size_t>{ 1, 2 } == m_registry.GetZones(m_window).ToIndexSet());
+
+            m_registry.Unstamp(m_window);
+            Assert::IsFalse(m_registry.IsZoned(m_window));
+            Assert::IsNull(::GetProp(m_window, ZonedWindowProperties::PropertyMultipleZoneID));
+        }
+
+        TEST_METHOD (StampEmpty)
+        {
+            m_registry.Stamp(m_window, { 4 });
+            m_registry.Stamp(m_window, {});
+            Assert::IsFalse(m_registry.IsZoned(m_window));
+        }
+
+        TEST_METHOD (ZonesAboveSixtyFour)
+        {
+            const std::vector<size_t> indexSet{ 10, 64, 200, 201, 202, 255 };
+            m_registry.Stamp(m_window, indexSet);
+            Assert::IsTrue(indexSet == m_registry.GetZones(m_window).ToIndexSet());
+
+            // The legacy stamp keeps the zones it can represent
+            const auto bitmask = reinterpret_cast<size_t>(::GetProp(m_window, ZonedWindowProperties::PropertyMultipleZoneID));
+            Assert::AreEqual(static_cast<size_t>(1ull << 10), bitmask);
+        }
+
+        TEST_METHOD (OnlyZonesAboveSixtyFour)
+        {
+            m_registry.Stamp(m_window, { 100 });
+            Assert::IsTrue(m_registry.IsZoned(m_window));
+            Assert::IsTrue(std::vector<size_t>{ 100 } == m_registry.GetZones(m_window).ToIndexSet());
+        }
+
+        TEST_METHOD (LegacyStamp)
+        {
+            // Stamped by a previous FancyZones instance
+            ::SetProp(m_window, ZonedWindowProperties::PropertyMultipleZoneID, reinterpret_cast<HANDLE>(0b1010));
+            Assert::IsTrue(m_registry.IsZoned(m_window));
+            Assert::IsTrue(std::vector<size_t>{ 1, 3 } == m_registry.GetZones(m_window).ToIndexSet());
+        }
+
+        TEST_METHOD (StaleEntry)
+        {
+            m_registry.Stamp(m_window, { 100 });
+
+            // The window went away and its handle was reused, the new window has none of the properties
+            ::RemoveProp(m_window, ZonedWindowProperties::PropertyMultipleZoneID);
+            ::RemoveProp(m_window, ZonedWindowProperties::PropertyZoneRegistryToken);
+            Assert::IsFalse(m_registry.IsZoned(m_window));
+            Assert::IsTrue(m_registry.GetZones(m_window).Empty());
+        }
+
+        TEST_METHOD (DestroyedWindows)
+        {
+            const auto destroyed = CreateTestWindow();
+            m_registry.Stamp(destroyed, { 100 });
+            DestroyTestWindow(destroyed);
+            Assert::IsFalse(m_registry.IsZoned(destroyed));
+            Assert::AreEqual(size_t{ 0 }, m_registry.EntryCount());
+
+            // Windows destroyed while zoned and never looked up again
+            m_registry.Stamp(m_window, { 100 });
+            for (int i = 0; i < 200; ++i)
+            {
+                const auto window = CreateTestWindow();
+                m_registry.Stamp(window, { 100 });
+                DestroyTestWindow(window);
+            }
+
+            Assert::IsTrue(m_registry.EntryCount() <= 64);
+            Assert::IsTrue(std::vector<size_t>{ 100 } == m_registry.GetZones(m_window).ToIndexSet());
+        }
+
+        TEST_METHOD (SameZones)
+        {
+            const auto other = CreateTestWindow();
+            m_registry.Stamp(m_window, { 70, 71 });
+            m_registry.Stamp(other, { 71, 70 });
+            Assert::IsTrue(m_registry.GetZones(m_window) == m_registry.GetZones(other));
+
+            m_registry.Stamp(other, { 70, 72 });
+            Assert::IsFalse(m_registry.GetZones(m_window) == m_registry.GetZones(other));
+            m_registry.Unstamp(other);
+            DestroyTestWindow(other);
+        }
+    };
+}
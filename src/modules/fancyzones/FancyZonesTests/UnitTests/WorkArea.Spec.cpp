@@ -161,8 +161,8 @@ namespace FancyZonesUnitTests
 
                 Assert::IsNotNull(actualWorkArea->ActiveZoneSet());
 
-                Assert::IsTrue(m_fancyZonesData.GetDeviceInfoMap().contains(m_uniqueId.str()));
-                auto currentDeviceInfo = m_fancyZonesData.GetDeviceInfoMap().at(m_uniqueId.str());
+                Assert::IsTrue(m_fancyZonesData.GetDeviceInfoMap()->contains(m_uniqueId.str()));
+                auto currentDeviceInfo = m_fancyZonesData.GetDeviceInfoMap()->at(m_uniqueId.str());
                 // default values
                 Assert::AreEqual(true, currentDeviceInfo.showSpacing);
                 Assert::AreEqual(3, currentDeviceInfo.zoneCount);
@@ -348,9 +348,9 @@ namespace FancyZonesUnitTests
                 const auto window = Mocks::WindowCreate(m_hInst);
                 workArea->MoveWindowIntoZoneByDirectionAndIndex(window, VK_RIGHT, true);
 
-                const auto& actualAppZoneHistory = m_fancyZonesData.GetAppZoneHistoryMap();
-                Assert::AreEqual((size_t)1, actualAppZoneHistory.size());
-                const auto& appHistoryArray = actualAppZoneHistory.begin()->second;
+                const auto actualAppZoneHistory = m_fancyZonesData.GetAppZoneHistoryMap();
+                Assert::AreEqual((size_t)1, actualAppZoneHistory->size());
+                const auto& appHistoryArray = actualAppZoneHistory->begin()->second;
                 Assert::AreEqual((size_t)1, appHistoryArray.size());
                 Assert::IsTrue(std::vector<size_t>{ 0 } == appHistoryArray[0].zoneIndexSet);
             }
@@ -365,9 +365,9 @@ namespace FancyZonesUnitTests
                 workArea->MoveWindowIntoZoneByDirectionAndIndex(window, VK_RIGHT, true);
                 workArea->MoveWindowIntoZoneByDirectionAndIndex(window, VK_RIGHT, true);
 
-                const auto& actualAppZoneHistory = m_fancyZonesData.GetAppZoneHistoryMap();
-                Assert::AreEqual((size_t)1, actualAppZoneHistory.size());
-                const auto& appHistoryArray = actualAppZoneHistory.begin()->second;
+                const auto actualAppZoneHistory = m_fancyZonesData.GetAppZoneHistoryMap();
+                Assert::AreEqual((size_t)1, actualAppZoneHistory->size());
+                const auto& appHistoryArray = actualAppZoneHistory->begin()->second;
                 Assert::AreEqual((size_t)1, appHistoryArray.size());
                 Assert::IsTrue(std::vector<size_t>{ 2 } == appHistoryArray[0].zoneIndexSet);
             }
@@ -380,7 +380,7 @@ namespace FancyZonesUnitTests
                 workArea->SaveWindowProcessToZoneIndex(nullptr);
 
                 const auto actualAppZoneHistory = m_fancyZonesData.GetAppZoneHistoryMap();
-                Assert::IsTrue(actualAppZoneHistory.empty());
+                Assert::IsTrue(actualAppZoneHistory->empty());
             }
 
             TEST_METHOD (SaveWindowProcessToZoneIndexNoWindowAdded)
@@ -395,7 +395,7 @@ namespace FancyZonesUnitTests
                 workArea->SaveWindowProcessToZoneIndex(window);
 
                 const auto actualAppZoneHistory = m_fancyZonesData.GetAppZoneHistoryMap();
-                Assert::IsTrue(actualAppZoneHistory.empty());
+                Assert::IsTrue(actualAppZoneHistory->empty());
             }
 
             TEST_METHOD (SaveWindowProcessToZoneIndexNoWindowAddedWithFilledAppZoneHistory)
@@ -410,8 +410,8 @@ namespace FancyZonesUnitTests
 
                 // fill app zone history map
                 Assert::IsTrue(m_fancyZonesData.SetAppLastZones(window, deviceId, Helpers::GuidToString(zoneSetId), { 0 }));
-                Assert::AreEqual((size_t)1, m_fancyZonesData.GetAppZoneHistoryMap().size());
-                const auto& appHistoryArray1 = m_fancyZonesData.GetAppZoneHistoryMap().at(processPath);
+                Assert::AreEqual((size_t)1, m_fancyZonesData.GetAppZoneHistoryMap()->size());
+                const auto appHistoryArray1 = m_fancyZonesData.GetAppZoneHistoryMap()->at(processPath);
                 Assert::AreEqual((size_t)1, appHistoryArray1.size());
                 Assert::IsTrue(std::vector<size_t>{ 0 } == appHistoryArray1[0].zoneIndexSet);
 
@@ -420,8 +420,8 @@ namespace FancyZonesUnitTests
                 workArea->ActiveZoneSet()->AddZone(zone);
 
                 workArea->SaveWindowProcessToZoneIndex(window);
-                Assert::AreEqual((size_t)1, m_fancyZonesData.GetAppZoneHistoryMap().size());
-                const auto& appHistoryArray2 = m_fancyZonesData.GetAppZoneHistoryMap().at(processPath);
+                Assert::AreEqual((size_t)1, m_fancyZonesData.GetAppZoneHistoryMap()->size());
+                const auto appHistoryArray2 = m_fancyZonesData.GetAppZoneHistoryMap()->at(processPath);
                 Assert::AreEqual((size_t)1, appHistoryArray2.size());
                 Assert::IsTrue(std::vector<size_t>{ 0 } == appHistoryArray2[0].zoneIndexSet);
             }
@@ -442,17 +442,20 @@ namespace FancyZonesUnitTests
 
                 //fill app zone history map
                 Assert::IsTrue(m_fancyZonesData.SetAppLastZones(window, deviceId, Helpers::GuidToString(zoneSetId), { 2 }));
-                Assert::AreEqual((size_t)1, m_fancyZonesData.GetAppZoneHistoryMap().size());
-                const auto& appHistoryArray = m_fancyZonesData.GetAppZoneHistoryMap().at(processPath);
+                Assert::AreEqual((size_t)1, m_fancyZonesData.GetAppZoneHistoryMap()->size());
+                const auto appHistoryArray = m_fancyZonesData.GetAppZoneHistoryMap()->at(processPath);
                 Assert::AreEqual((size_t)1, appHistoryArray.size());
                 Assert::IsTrue(std::vector<size_t>{ 2 } == appHistoryArray[0].zoneIndexSet);
 
                 workArea->SaveWindowProcessToZoneIndex(window);
 
-                const auto& actualAppZoneHistory = m_fancyZonesData.GetAppZoneHistoryMap();
-                Assert::AreEqual((size_t)1, actualAppZoneHistory.size());
+                // The snapshot read before is left as it was, the saved zones are in a new one
+                const auto actualAppZoneHistory = m_fancyZonesData.GetAppZoneHistoryMap();
+                Assert::AreEqual((size_t)1, actualAppZoneHistory->size());
+                const auto& actualAppHistoryArray = actualAppZoneHistory->at(processPath);
+                Assert::AreEqual((size_t)1, actualAppHistoryArray.size());
                 const auto& expected = workArea->ActiveZoneSet()->GetZoneIndexSetFromWindow(window);
-                const auto& actual = appHistoryArray[0].zoneIndexSet;
+                const auto& actual = actualAppHistoryArray[0].zoneIndexSet;
                 Assert::IsTrue(expected == actual);
             }
 
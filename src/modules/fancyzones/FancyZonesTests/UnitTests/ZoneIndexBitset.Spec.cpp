@@ -0,0 +1,162 @@
+#include "pch.h"
+#include "FancyZonesLib\ZoneIndexBitset.h"
+
+#include <chrono>
+#include <random>
+#include <set>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace FancyZonesUnitTests
+{
+    namespace
+    {
+        std::vector<size_t> RandomIndexSet(std::mt19937& rng, size_t zoneCount)
+        {
+            std::set<size_t> indices;
+            const size_t size = rng() % 12;
+            for (size_t i = 0; i < size; i++)
+            {
+                // Mostly spans of neighbouring zones, as extended windows are
+                const size_t first = rng() % zoneCount;
+                const size_t length = 1 + rng() % 8;
+                for (size_t index = first; index < first + length && index < zoneCount; index++)
+                {
+                    indices.insert(index);
+                }
+            }
+            return { indices.begin(), indices.end() };
+        }
+    }
+
+    TEST_CLASS (ZoneIndexBitsetUnitTests)
+    {
+        TEST_METHOD (Empty)
+        {
+            ZoneIndexBitset bitset;
+            Assert::IsTrue(bitset.Empty());
+            Assert::AreEqual(static_cast<size_t>(0), bitset.Count());
+            Assert::IsTrue(bitset.ToIndexSet().empty());
+            Assert::IsTrue(bitset.ToRuns().empty());
+            Assert::AreEqual(static_cast<uint64_t>(0), *bitset.ToBitmask());
+            Assert::IsTrue(bitset == ZoneIndexBitset::FromBitmask(0));
+            Assert::IsTrue(bitset == ZoneIndexBitset(std::vector<size_t>{}));
+        }
+
+        TEST_METHOD (IndicesAboveSixtyFour)
+        {
+            const std::vector<size_t> indexSet{ 3, 63, 64, 65, 130, 255 };
+            ZoneIndexBitset bitset(indexSet);
+
+            Assert::AreEqual(indexSet.size(), bitset.Count());
+            Assert::IsTrue(indexSet == bitset.ToIndexSet());
+            Assert::IsTrue(bitset.Test(64));
+            Assert::IsFalse(bitset.Test(66));
+            Assert::IsFalse(bitset.Test(1000));
+            Assert::IsFalse(bitset.ToBitmask().has_value());
+        }
+
+        TEST_METHOD (Bitmask)
+        {
+            const uint64_t bitmask = (1ull << 0) | (1ull << 5) | (1ull << 63);
+            const auto bitset = ZoneIndexBitset::FromBitmask(bitmask);
+
+            Assert::IsTrue(std::vector<size_t>{ 0, 5, 63 } == bitset.ToIndexSet());
+            Assert::AreEqual(bitmask, *bitset.ToBitmask());
+        }
+
+        TEST_METHOD (UnorderedIndexSet)
+        {
+            Assert::IsTrue(ZoneIndexBitset({ 70, 2, 1 }) == ZoneIndexBitset({ 1, 2, 70, 2 }));
+            Assert::IsFalse(ZoneIndexBitset({ 1, 2 }) == ZoneIndexBitset({ 1, 2, 70 }));
+        }
+
+        TEST_METHOD (Runs)
+        {
+            using Runs = std::vector<ZoneIndexBitset::Run>;
+
+            Assert::IsTrue(Runs{ { 0, 1 } } == ZoneIndexBitset({ 0 }).ToRuns());
+            Assert::IsTrue(Runs{ { 2, 3 }, { 6, 1 } } == ZoneIndexBitset({ 2, 3, 4, 6 }).ToRuns());
+
+            // Runs across and ending on word boundaries
+            Assert::IsTrue(Runs{ { 60, 10 } } == ZoneIndexBitset({ 60, 61, 62, 63, 64, 65, 66, 67, 68, 69 }).ToRuns());
+            Assert::IsTrue(Runs{ { 63, 1 }, { 127, 2 } } == ZoneIndexBitset({ 63, 127, 128 }).ToRuns());
+
+            std::vector<size_t> all(256);
+            for (size_t i = 0; i < all.size(); i++)
+            {
+                all[i] = i;
+            }
+            Assert::IsTrue(Runs{ { 0, 256 } } == ZoneIndexBitset(all).ToRuns());
+        }
+
+        TEST_METHOD (RandomRoundTrip)
+        {
+            std::mt19937 rng(36);
+            for (int i = 0; i < 2000; i++)
+            {
+                const auto indexSet = RandomIndexSet(rng, 1 + rng() % 300);
+                const ZoneIndexBitset bitset(indexSet);
+
+                Assert::AreEqual(indexSet.size(), bitset.Count());
+                Assert::IsTrue(indexSet == bitset.ToIndexSet());
+
+                const auto runs = bitset.ToRuns();
+                Assert::IsTrue(bitset == ZoneIndexBitset::FromRuns(runs));
+
+                size_t covered = 0;
+                for (size_t r = 0; r < runs.size(); r++)
+                {
+                    Assert::IsTrue(runs[r].second > 0);
+                    if (r > 0)
+                    {
+                        // Maximal runs: there's a gap between two runs
+                        Assert::IsTrue(runs[r - 1].first + runs[r - 1].second < runs[r].first);
+                    }
+                    covered += runs[r].second;
+                }
+                Assert::AreEqual(indexSet.size(), covered);
+
+                const bool fitsBitmask = indexSet.empty() || indexSet.back() < 64;
+                Assert::AreEqual(fitsBitmask, bitset.ToBitmask().has_value());
+            }
+        }
+
+        TEST_METHOD (Performance256Zones)
+        {
+            constexpr size_t zoneCount = 256;
+            std::mt19937 rng(256);
+            std::vector<std::vector<size_t>> indexSets;
+            for (int i = 0; i < 1000; i++)
+            {
+                indexSets.push_back(RandomIndexSet(rng, zoneCount));
+            }
+
+            constexpr int rounds = 20;
+            size_t checksum = 0;
+            const auto start = std::chrono::steady_clock::now();
+            for (int round = 0; round < rounds; round++)
+            {
+                for (const auto& indexSet : indexSets)
+                {
+                    // Stamp, then read back the zones of a window
+                    const auto runs = ZoneIndexBitset(indexSet).ToRuns();
+                    checksum += ZoneIndexBitset::FromRuns(runs).ToIndexSet().size();
+                }
+            }
+            const auto duration = std::chrono::steady_clock::now() - start;
+
+            size_t expected = 0;
+            for (const auto& indexSet : indexSets)
+            {
+                expected += indexSet.size();
+            }
+            Assert::AreEqual(expected * rounds, checksum);
+
+            using ns = std::chrono::duration<double, std::nano>;
+            const double perWindow = ns(duration).count() / (rounds * indexSets.size());
+            const auto message = std::to_wstring(zoneCount) + L" zones: " + std::to_wstring(perWindow) + L" ns per window round trip\n";
+            Logger::WriteMessage(message.c_str());
+        }
+    };
+}
@@ -3,6 +3,7 @@
 #include "FancyZonesLib\FancyZonesDataTypes.h"
 #include "FancyZonesLib\JsonHelpers.h"
 #include "FancyZonesLib\VirtualDesktop.h"
+#include "FancyZonesLib\WindowZoneRegistry.h"
 #include "FancyZonesLib\ZoneSet.h"
 
 #include <filesystem>
@@ -351,6 +352,19 @@ namespace FancyZonesUnitTests
                 Assert::IsTrue(std::vector<size_t>{} == m_set->GetZoneIndexSetFromWindow(window));
             }
 
+            TEST_METHOD (MoveWindowIntoZoneByIndexSetStampsValidZonesOnly)
+            {
+                m_set->AddZone(MakeZone({ 0, 0, 100, 100 }, 0));
+                m_set->AddZone(MakeZone({ 100, 0, 200, 100 }, 1));
+
+                HWND window = Mocks::WindowCreate(GetModuleHandleW(nullptr));
+                m_set->MoveWindowIntoZoneByIndexSet(window, Mocks::Window(), { 1, 100 });
+
+                Assert::IsTrue(std::vector<size_t>{ 1 } == m_set->GetZoneIndexSetFromWindow(window));
+                Assert::IsTrue(ZoneIndexBitset(std::vector<size_t>{ 1 }) == WindowZoneRegistryInstance().GetZones(window));
+                WindowZoneRegistryInstance().Unstamp(window);
+            }
+
             TEST_METHOD (MoveWindowIntoZoneByIndexSeveralTimesSameWindow)
             {
                 // Add a couple of zones.
@@ -389,6 +403,35 @@ namespace FancyZonesUnitTests
                 Assert::IsTrue(std::vector<size_t>{ 0 } == m_set->GetZoneIndexSetFromWindow(window));
             }
 
+            TEST_METHOD (AssignWindowToZoneByIndexSet)
+            {
+                winrt::com_ptr<IZone> zone1 = MakeZone({ 0, 0, 100, 100 }, 0);
+                winrt::com_ptr<IZone> zone2 = MakeZone({ 100, 0, 200, 100 }, 1);
+                m_set->AddZone(zone1);
+                m_set->AddZone(zone2);
+
+                HWND window = Mocks::Window();
+                auto actual = m_set->AssignWindowToZoneByIndexSet(window, Mocks::Window(), { 0, 1 });
+                Assert::IsTrue(actual.has_value());
+                Assert::IsTrue(std::vector<size_t>{ 0, 1 } == m_set->GetZoneIndexSetFromWindow(window));
+            }
+
+            TEST_METHOD (AssignWindowToZoneByIndexSetWithNoZones)
+            {
+                HWND window = Mocks::Window();
+                Assert::IsFalse(m_set->AssignWindowToZoneByIndexSet(window, Mocks::Window(), { 0 }).has_value());
+            }
+
+            TEST_METHOD (AssignWindowToZoneByIndexSetWithInvalidIndex)
+            {
+                winrt::com_ptr<IZone> zone1 = MakeZone({ 0, 0, 100, 100 }, 0);
+                m_set->AddZone(zone1);
+
+                HWND window = Mocks::Window();
+                Assert::IsFalse(m_set->AssignWindowToZoneByIndexSet(window, Mocks::Window(), { 100 }).has_value());
+                Assert::IsTrue(std::vector<size_t>{} == m_set->GetZoneIndexSetFromWindow(window));
+            }
+
             TEST_METHOD (MoveWindowIntoZoneByPointEmpty)
             {
                 m_set->MoveWindowIntoZoneByPoint(Mocks::Window(), Mocks::Window(), POINT{ 0, 0 });
@@ -3,6 +3,7 @@
 #include "pch.h"
 #include "ContextMenuHandler.h"
 #include "HDropIterator.h"
+#include "PathStreamWriter.h"
 #include "Settings.h"
 #include <common/themes/icon_helpers.h>
 #include <common/utils/process_path.h>
@@ -76,13 +77,12 @@ HRESULT CContextMenuHandler::QueryContextMenu(_In_ HMENU hmenu, UINT indexMenu,
 #pragma warning(suppress : 26812)
     PERCEIVED type;
     PERCEIVEDFLAG flag;
-    LPTSTR pszPath = i.CurrentItem();
-    LPTSTR pszExt = PathFindExtension(pszPath);
+    const CString path = i.CurrentItem();
+    LPCTSTR pszExt = PathFindExtension(path);
 
     // TODO: Instead, detect whether there's a WIC codec installed that can handle this file
     AssocGetPerceivedType(pszExt, &type, &flag, NULL);
 
-    free(pszPath);
     bool dragDropFlag = false;
     // If selected file is an image...
     if (type == PERCEIVED_TYPE_IMAGE)
@@ -207,6 +207,74 @@ HRESULT CContextMenuHandler::InvokeCommand(_In_ CMINVOKECOMMANDINFO* pici)
     return hr;
 }
 
+namespace
+{
+    // Makes a private copy of the CF_HDROP data so the paths can be streamed after Explorer's call returns
+    HGLOBAL CopyHDrop(IDataObject* pdtobj)
+    {
+        FORMATETC formatetc = { CF_HDROP, NULL, DVASPECT_CONTENT, -1, TYMED_HGLOBAL };
+        STGMEDIUM medium = {};
+        if (!pdtobj || FAILED(pdtobj->GetData(&formatetc, &medium)))
+        {
+            return nullptr;
+        }
+
+        HGLOBAL copy = nullptr;
+        const SIZE_T size = GlobalSize(medium.hGlobal);
+        const void* source = GlobalLock(medium.hGlobal);
+        if (source)
+        {
+            copy = GlobalAlloc(GMEM_MOVEABLE, size);
+            void* destination = copy ? GlobalLock(copy) : nullptr;
+            if (destination)
+            {
+                memcpy(destination, source, size);
+                GlobalUnlock(copy);
+            }
+            else if (copy)
+            {
+                GlobalFree(copy);
+                copy = nullptr;
+            }
+            GlobalUnlock(medium.hGlobal);
+        }
+        ReleaseStgMedium(&medium);
+        return copy;
+    }
+
+    void StreamHDrop(HGLOBAL hDrop, HANDLE writePipe)
+    {
+        PathStreamWriter writer(writePipe);
+        HDropIterator i(hDrop);
+        for (i.First(); !i.IsDone() && !writer.Failed(); i.Next())
+        {
+            // DragQueryFile writes straight into the stream buffer, no allocation per file
+            const UINT cch = i.CurrentItemLength();
+            wchar_t* path = writer.ReservePath(cch);
+            if (path)
+            {
+                writer.CommitPath(i.CopyCurrentItem(path, cch + 1));
+            }
+        }
+        writer.Flush();
+    }
+
+    struct PathStreamThreadData
+    {
+        HGLOBAL hDrop;
+        HANDLE writePipe;
+    };
+
+    DWORD WINAPI PathStreamThreadProc(void* pv)
+    {
+        auto data = static_cast<PathStreamThreadData*>(pv);
+        StreamHDrop(data->hDrop, data->writePipe);
+        CloseHandle(data->writePipe);
+        delete data;
+        return 0;
+    }
+}
+
 // This function is used for both MSI and MSIX. If pici is null and psiItemArray is not null then this is called by Invoke(MSIX). If pici is not null and psiItemArray is null then this is called by InvokeCommand(MSI).
 HRESULT CContextMenuHandler::ResizePictures(CMINVOKECOMMANDINFO* pici, IShellItemArray* psiItemArray)
 {
@@ -214,7 +282,7 @@ HRESULT CContextMenuHandler::ResizePictures(CMINVOKECOMMANDINFO* pici, IShellIte
     std::wstring path = get_module_folderpath(g_hInst_imageResizer);
     path = path + L"\\ImageResizer.exe";
     LPTSTR lpApplicationName = (LPTSTR)path.c_str();
-    // Create an anonymous pipe to stream filenames
+    // Create an anonymous pipe to stream filenames. Size it for a full batch so the writer rarely waits on the reader.
     SECURITY_ATTRIBUTES sa;
     HANDLE hReadPipe;
     HANDLE hWritePipe;
@@ -222,7 +290,7 @@ HRESULT CContextMenuHandler::ResizePictures(CMINVOKECOMMANDINFO* pici, IShellIte
     sa.lpSecurityDescriptor = NULL;
     sa.bInheritHandle = TRUE;
     HRESULT hr = E_FAIL;
-    if (!CreatePipe(&hReadPipe, &hWritePipe, &sa, 0))
+    if (!CreatePipe(&hReadPipe, &hWritePipe, &sa, static_cast<DWORD>(PathStreamWriter::BufferSize)))
     {
         hr = HRESULT_FROM_WIN32(GetLastError());
         return hr;
@@ -230,9 +298,10 @@ HRESULT CContextMenuHandler::ResizePictures(CMINVOKECOMMANDINFO* pici, IShellIte
     if (!SetHandleInformation(hWritePipe, HANDLE_FLAG_INHERIT, 0))
     {
         hr = HRESULT_FROM_WIN32(GetLastError());
+        CloseHandle(hReadPipe);
+        CloseHandle(hWritePipe);
         return hr;
     }
-    CAtlFile writePipe(hWritePipe);
 
     CString commandLine;
     commandLine.Format(_T("\"%s\""), lpApplicationName);
@@ -266,8 +335,8 @@ HRESULT CContextMenuHandler::ResizePictures(CMINVOKECOMMANDINFO* pici, IShellIte
 
     PROCESS_INFORMATION processInformation;
 
-    // Start the resizer
-    CreateProcess(
+    // Start the resizer before enumerating anything so it can consume paths as they are produced
+    BOOL started = CreateProcess(
         NULL,
         lpszCommandLine,
         NULL,
@@ -279,52 +348,74 @@ HRESULT CContextMenuHandler::ResizePictures(CMINVOKECOMMANDINFO* pici, IShellIte
         &startupInfo,
         &processInformation);
     delete[] lpszCommandLine;
+    // The resizer owns the read end now
+    CloseHandle(hReadPipe);
+    if (!started)
+    {
+        hr = HRESULT_FROM_WIN32(GetLastError());
+        CloseHandle(hWritePipe);
+        return hr;
+    }
     if (!CloseHandle(processInformation.hProcess))
     {
         hr = HRESULT_FROM_WIN32(GetLastError());
+        CloseHandle(hWritePipe);
         return hr;
     }
     if (!CloseHandle(processInformation.hThread))
     {
         hr = HRESULT_FROM_WIN32(GetLastError());
+        CloseHandle(hWritePipe);
         return hr;
     }
 
     // psiItemArray is NULL if called from InvokeCommand. This part is used for the MSI installer. It is not NULL if it is called from Invoke (MSIX).
-    if (!psiItemArray)
+    // m_pdtobj will be NULL when invoked from the MSIX build as Initialize is never called (IShellExtInit functions aren't called in case of MSIX),
+    // so ask the item array for the equivalent data object.
+    CComPtr<IDataObject> dataObject = m_pdtobj;
+    if (psiItemArray)
     {
-        // Stream the input files
-        HDropIterator i(m_pdtobj);
-        for (i.First(); !i.IsDone(); i.Next())
-        {
-            CString fileName(i.CurrentItem());
-            fileName.Append(_T("\r\n"));
+        dataObject.Release();
+        psiItemArray->BindToHandler(nullptr, BHID_DataObject, IID_PPV_ARGS(&dataObject));
+    }
 
-            writePipe.Write(fileName, fileName.GetLength() * sizeof(TCHAR));
+    HGLOBAL hDrop = CopyHDrop(dataObject);
+    if (hDrop)
+    {
+        // Hand the paths off to a background thread so Explorer isn't blocked while a large selection is written.
+        // CTF_FREELIBANDEXIT keeps this dll loaded until the thread is done.
+        auto data = new PathStreamThreadData{ hDrop, hWritePipe };
+        if (!SHCreateThread(PathStreamThreadProc, data, CTF_FREELIBANDEXIT, nullptr))
+        {
+            PathStreamThreadProc(data);
         }
     }
-    else
+    else if (psiItemArray)
     {
-        //m_pdtobj will be NULL when invoked from the MSIX build as Initialize is never called (IShellExtInit functions aren't called in case of MSIX).
+        PathStreamWriter writer(hWritePipe);
         DWORD fileCount = 0;
         // Gets the list of files currently selected using the IShellItemArray
         psiItemArray->GetCount(&fileCount);
         // Iterate over the list of files
-        for (DWORD i = 0; i < fileCount; i++)
+        for (DWORD i = 0; i < fileCount && !writer.Failed(); i++)
         {
-            IShellItem* shellItem;
-            psiItemArray->GetItemAt(i, &shellItem);
-            LPWSTR itemName;
+            CComPtr<IShellItem> shellItem;
+            LPWSTR itemName = nullptr;
             // Retrieves the entire file system path of the file from its shell item
-            shellItem->GetDisplayName(SIGDN_FILESYSPATH, &itemName);
-            CString fileName(itemName);
-            fileName.Append(_T("\r\n"));
-            // Write the file path into the input stream for image resizer
-            writePipe.Write(fileName, fileName.GetLength() * sizeof(TCHAR));
+            if (SUCCEEDED(psiItemArray->GetItemAt(i, &shellItem)) && SUCCEEDED(shellItem->GetDisplayName(SIGDN_FILESYSPATH, &itemName)))
+            {
+                writer.WritePath(itemName, wcslen(itemName));
+                CoTaskMemFree(itemName);
+            }
         }
+        writer.Flush();
+        CloseHandle(hWritePipe);
+    }
+    else
+    {
+        CloseHandle(hWritePipe);
     }
 
-    writePipe.Close();
     hr = S_OK;
     return hr;
 }
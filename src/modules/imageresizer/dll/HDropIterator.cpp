@@ -18,6 +18,17 @@ HDropIterator::HDropIterator(IDataObject* pdtobj)
     _listCount = DragQueryFile((HDROP)m_medium.hGlobal, 0xFFFFFFFF, NULL, 0);
 }
 
+HDropIterator::HDropIterator(HGLOBAL hDrop)
+{
+    _current = 0;
+
+    m_medium = {};
+    m_medium.tymed = TYMED_HGLOBAL;
+    m_medium.hGlobal = hDrop;
+
+    _listCount = DragQueryFile((HDROP)m_medium.hGlobal, 0xFFFFFFFF, NULL, 0);
+}
+
 HDropIterator::~HDropIterator()
 {
     ReleaseStgMedium(&m_medium);
@@ -38,12 +49,22 @@ bool HDropIterator::IsDone() const
     return _current >= _listCount;
 }
 
-LPTSTR HDropIterator::CurrentItem() const
+CString HDropIterator::CurrentItem() const
 {
-    UINT cch = DragQueryFile((HDROP)m_medium.hGlobal, _current, NULL, 0) + 1;
-    LPTSTR pszPath = (LPTSTR)malloc(sizeof(TCHAR) * cch);
+    const UINT cch = CurrentItemLength();
+    CString path;
+    CopyCurrentItem(path.GetBuffer(cch + 1), cch + 1);
+    path.ReleaseBuffer();
+
+    return path;
+}
 
-    DragQueryFile((HDROP)m_medium.hGlobal, _current, pszPath, cch);
+UINT HDropIterator::CurrentItemLength() const
+{
+    return DragQueryFile((HDROP)m_medium.hGlobal, _current, NULL, 0);
+}
 
-    return pszPath;
+UINT HDropIterator::CopyCurrentItem(LPTSTR buffer, UINT cch) const
+{
+    return DragQueryFile((HDROP)m_medium.hGlobal, _current, buffer, cch);
 }
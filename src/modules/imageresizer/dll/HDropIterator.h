@@ -4,11 +4,17 @@ class HDropIterator
 {
 public:
 	HDropIterator(IDataObject *pDataObject);
+	// Takes ownership of an HGLOBAL holding a DROPFILES structure
+	HDropIterator(HGLOBAL hDrop);
 	~HDropIterator();
 	void First();
 	void Next();
 	bool IsDone() const;
-	LPTSTR CurrentItem() const;
+	CString CurrentItem() const;
+	// Length of the current path in characters, not counting the terminator
+	UINT CurrentItemLength() const;
+	// Copies the current path into a caller provided buffer of cch characters
+	UINT CopyCurrentItem(LPTSTR buffer, UINT cch) const;
 
 private:
 	UINT _listCount;
@@ -0,0 +1,113 @@
+#include "pch.h"
+#include "PathStreamWriter.h"
+
+namespace
+{
+    constexpr size_t RecordHeaderSize = sizeof(UINT32);
+}
+
+PathStreamWriter::PathStreamWriter(HANDLE output) :
+    m_output(output),
+    m_buffer(std::make_unique<BYTE[]>(BufferSize))
+{
+    const DWORD magic = PathStreamMagic;
+    memcpy(m_buffer.get(), &magic, sizeof(magic));
+    m_used = sizeof(magic);
+}
+
+PathStreamWriter::~PathStreamWriter()
+{
+    Flush();
+}
+
+wchar_t* PathStreamWriter::ReservePath(size_t cch)
+{
+    const size_t bytes = RecordHeaderSize + (cch + 1) * sizeof(wchar_t);
+    if (bytes > BufferSize)
+    {
+        m_oversized = std::make_unique<wchar_t[]>(cch + 1);
+        return m_oversized.get();
+    }
+
+    if (!EnsureSpace(bytes))
+    {
+        return nullptr;
+    }
+
+    return reinterpret_cast<wchar_t*>(m_buffer.get() + m_used + RecordHeaderSize);
+}
+
+void PathStreamWriter::CommitPath(size_t cch)
+{
+    if (m_oversized)
+    {
+        // Flush what is queued, then send the oversized record as is
+        const UINT32 length = static_cast<UINT32>(cch);
+        if (Flush())
+        {
+            WriteBytes(&length, sizeof(length));
+            WriteBytes(m_oversized.get(), cch * sizeof(wchar_t));
+        }
+        m_oversized.reset();
+        return;
+    }
+
+    const UINT32 length = static_cast<UINT32>(cch);
+    memcpy(m_buffer.get() + m_used, &length, sizeof(length));
+    m_used += RecordHeaderSize + cch * sizeof(wchar_t);
+}
+
+bool PathStreamWriter::WritePath(const wchar_t* path, size_t cch)
+{
+    wchar_t* destination = ReservePath(cch);
+    if (!destination)
+    {
+        return false;
+    }
+
+    memcpy(destination, path, cch * sizeof(wchar_t));
+    CommitPath(cch);
+    return !m_failed;
+}
+
+bool PathStreamWriter::Flush()
+{
+    if (m_used > 0)
+    {
+        WriteBytes(m_buffer.get(), m_used);
+        m_used = 0;
+    }
+    return !m_failed;
+}
+
+bool PathStreamWriter::EnsureSpace(size_t bytes)
+{
+    if (m_used + bytes > BufferSize)
+    {
+        return Flush();
+    }
+    return !m_failed;
+}
+
+bool PathStreamWriter::WriteBytes(const void* data, size_t bytes)
+{
+    // Once the reader is gone (e.g. the resizer was closed) there is no point in trying again
+    if (m_failed)
+    {
+        return false;
+    }
+
+    const BYTE* current = static_cast<const BYTE*>(data);
+    while (bytes > 0)
+    {
+        DWORD written = 0;
+        if (!WriteFile(m_output, current, static_cast<DWORD>(bytes), &written, nullptr))
+        {
+            m_failed = true;
+            return false;
+        }
+        current += written;
+        bytes -= written;
+    }
+    return true;
+}
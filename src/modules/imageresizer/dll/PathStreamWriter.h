@@ -0,0 +1,43 @@
+#pragma once
+
+// Streams file paths to ImageResizer.exe over its standard input.
+//
+// The stream starts with PathStreamMagic followed by one record per path: the path length in
+// UTF-16 code units as a little-endian uint32, then the path itself without a terminator.
+// Records are packed into a single reusable buffer which is written to the pipe whenever it
+// fills up, so a large selection costs a handful of WriteFile calls and no allocation per path.
+// The reader side lives in ImageResizer.Models.ResizeBatch.
+class PathStreamWriter
+{
+public:
+    // "IRPS" (Image Resizer Path Stream)
+    static constexpr DWORD PathStreamMagic = 0x53505249;
+    static constexpr size_t BufferSize = 64 * 1024;
+
+    explicit PathStreamWriter(HANDLE output);
+    ~PathStreamWriter();
+
+    PathStreamWriter(const PathStreamWriter&) = delete;
+    PathStreamWriter& operator=(const PathStreamWriter&) = delete;
+
+    // Returns space for a path of cch characters (plus a terminator, which is not sent) inside
+    // the write buffer. Fill it, then call CommitPath with the actual length.
+    wchar_t* ReservePath(size_t cch);
+    void CommitPath(size_t cch);
+
+    bool WritePath(const wchar_t* path, size_t cch);
+    bool Flush();
+
+    bool Failed() const { return m_failed; }
+
+private:
+    bool EnsureSpace(size_t bytes);
+    bool WriteBytes(const void* data, size_t bytes);
+
+    HANDLE m_output;
+    std::unique_ptr<BYTE[]> m_buffer;
+    size_t m_used = 0;
+    // Paths that don't fit in the buffer at all get their own temporary allocation
+    std::unique_ptr<wchar_t[]> m_oversized;
+    bool m_failed = false;
+};
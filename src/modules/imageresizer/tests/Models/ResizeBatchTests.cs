@@ -6,8 +6,11 @@ using System;
 using System.Collections.Concurrent;
 using System.Collections.Generic;
 using System.IO;
+using System.IO.Pipes;
 using System.Linq;
+using System.Text;
 using System.Threading;
+using System.Threading.Tasks;
 using Moq;
 using Moq.Protected;
 using Xunit;
@@ -39,6 +42,82 @@ namespace ImageResizer.Models
             Assert.Equal("OutputDir", result.DestinationDirectory);
         }
 
+        [Fact]
+        public void FromCommandLineReadsPathStream()
+        {
+            var standardInput = CreatePathStream("Image1.jpg", "C:\\Photos\\Image 2.jpg");
+            var args = new[]
+            {
+                "/d", "OutputDir",
+                "Image3.jpg",
+            };
+
+            var result = ResizeBatch.FromCommandLine(standardInput, args);
+
+            Assert.Equal(new List<string> { "Image1.jpg", "C:\\Photos\\Image 2.jpg", "Image3.jpg" }, result.Files);
+            Assert.Equal("OutputDir", result.DestinationDirectory);
+        }
+
+        [Fact]
+        public void FromCommandLineReadsUnicodeTextStream()
+        {
+            var standardInput = new MemoryStream(Encoding.Unicode.GetBytes("Image1.jpg" + EOL + "Image2.jpg"));
+
+            var result = ResizeBatch.FromCommandLine(standardInput, Array.Empty<string>());
+
+            Assert.Equal(new List<string> { "Image1.jpg", "Image2.jpg" }, result.Files);
+        }
+
+        [Fact]
+        public void FromCommandLineIgnoresTruncatedPathStreamRecord()
+        {
+            var bytes = CreatePathStream("Image1.jpg", "Image2.jpg").ToArray();
+            var standardInput = new MemoryStream(bytes, 0, bytes.Length - 2);
+
+            var result = ResizeBatch.FromCommandLine(standardInput, Array.Empty<string>());
+
+            Assert.Equal(new List<string> { "Image1.jpg" }, result.Files);
+        }
+
+        [Fact]
+        public void FromCommandLineStreamsLargeSelectionThroughPipe()
+        {
+            const int fileCount = 20000;
+
+            using (var server = new AnonymousPipeServerStream(PipeDirection.In))
+            {
+                var client = new AnonymousPipeClientStream(PipeDirection.Out, server.ClientSafePipeHandle);
+                // Stand-in for the shell extension: batch records into 64 KB writes like PathStreamWriter does
+                var writer = Task.Run(() =>
+                {
+                    using (var batch = new MemoryStream())
+                    {
+                        batch.Write(BitConverter.GetBytes(0x53505249u), 0, sizeof(uint));
+                        for (var i = 0; i < fileCount; i++)
+                        {
+                            WritePathRecord(batch, $"C:\\Users\\Someone\\Pictures\\Vacation\\IMG_{i:D6}.jpg");
+                            if (batch.Length >= 64 * 1024)
+                            {
+                                client.Write(batch.GetBuffer(), 0, (int)batch.Length);
+                                batch.SetLength(0);
+                            }
+                        }
+
+                        client.Write(batch.GetBuffer(), 0, (int)batch.Length);
+                    }
+
+                    // Closing the write end is what signals the end of the stream to the reader
+                    client.Dispose();
+                });
+
+                var result = ResizeBatch.FromCommandLine(server, Array.Empty<string>());
+                writer.Wait();
+
+                Assert.Equal(fileCount, result.Files.Count);
+                Assert.Equal("C:\\Users\\Someone\\Pictures\\Vacation\\IMG_019999.jpg", result.Files.Last());
+            }
+        }
+
         /*[Fact]
         public void Process_executes_in_parallel()
         {
@@ -96,6 +175,26 @@ namespace ImageResizer.Models
             Assert.Contains(calls, c => c.i == 2 && c.count == 2);
         }
 
+        private static MemoryStream CreatePathStream(params string[] paths)
+        {
+            var stream = new MemoryStream();
+            stream.Write(BitConverter.GetBytes(0x53505249u), 0, sizeof(uint));
+            foreach (var path in paths)
+            {
+                WritePathRecord(stream, path);
+            }
+
+            stream.Position = 0;
+            return stream;
+        }
+
+        private static void WritePathRecord(Stream stream, string path)
+        {
+            stream.Write(BitConverter.GetBytes((uint)path.Length), 0, sizeof(uint));
+            var bytes = Encoding.Unicode.GetBytes(path);
+            stream.Write(bytes, 0, bytes.Length);
+        }
+
         private static ResizeBatch CreateBatch(Action<string> executeAction)
         {
             var mock = new Mock<ResizeBatch> { CallBase = true };
@@ -26,7 +26,7 @@ namespace ImageResizer
 
         protected override void OnStartup(StartupEventArgs e)
         {
-            var batch = ResizeBatch.FromCommandLine(Console.In, e?.Args);
+            var batch = ResizeBatch.FromCommandLine(Console.OpenStandardInput(), e?.Args);
 
             // TODO: Add command-line parameters that can be used in lieu of the input page (issue #14)
             var mainWindow = new MainWindow(new MainViewModel(batch, Settings.Default));
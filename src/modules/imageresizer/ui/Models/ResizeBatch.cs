@@ -7,6 +7,7 @@ using System.Collections.Concurrent;
 using System.Collections.Generic;
 using System.IO;
 using System.IO.Abstractions;
+using System.Text;
 using System.Threading;
 using System.Threading.Tasks;
 using ImageResizer.Properties;
@@ -21,6 +22,11 @@ namespace ImageResizer.Models
 
         public ICollection<string> Files { get; } = new List<string>();
 
+        // Must match PathStreamWriter::PathStreamMagic in the shell extension
+        private const uint PathStreamMagic = 0x53505249;
+
+        private const int PathStreamBufferSize = 64 * 1024;
+
         public static ResizeBatch FromCommandLine(TextReader standardInput, string[] args)
         {
             var batch = new ResizeBatch();
@@ -35,18 +41,91 @@ namespace ImageResizer.Models
                 }
             }
 
+            batch.AddArgs(args);
+
+            return batch;
+        }
+
+        // The shell extension sends a length-prefixed path stream (see PathStreamWriter.h). Anything else
+        // is treated as UTF-16 text with one path per line.
+        public static ResizeBatch FromCommandLine(Stream standardInput, string[] args)
+        {
+            if (standardInput == null)
+            {
+                return FromCommandLine((TextReader)null, args);
+            }
+
+            var header = new byte[sizeof(uint)];
+            var headerLength = ReadBlock(standardInput, header, header.Length);
+            if (headerLength != header.Length || BitConverter.ToUInt32(header, 0) != PathStreamMagic)
+            {
+                var buffered = new MemoryStream();
+                buffered.Write(header, 0, headerLength);
+                standardInput.CopyTo(buffered);
+                buffered.Position = 0;
+
+                using (var reader = new StreamReader(buffered, Encoding.Unicode))
+                {
+                    return FromCommandLine(reader, args);
+                }
+            }
+
+            var batch = new ResizeBatch();
+            ReadPathStream(standardInput, batch.Files);
+            batch.AddArgs(args);
+
+            return batch;
+        }
+
+        private static void ReadPathStream(Stream input, ICollection<string> files)
+        {
+            using (var bufferedInput = new BufferedStream(input, PathStreamBufferSize))
+            {
+                var lengthBuffer = new byte[sizeof(uint)];
+                var pathBuffer = new byte[1024];
+                while (ReadBlock(bufferedInput, lengthBuffer, lengthBuffer.Length) == lengthBuffer.Length)
+                {
+                    var byteCount = checked((int)BitConverter.ToUInt32(lengthBuffer, 0) * sizeof(char));
+                    if (byteCount > pathBuffer.Length)
+                    {
+                        pathBuffer = new byte[byteCount];
+                    }
+
+                    if (ReadBlock(bufferedInput, pathBuffer, byteCount) != byteCount)
+                    {
+                        // Truncated record, the writer went away
+                        break;
+                    }
+
+                    files.Add(Encoding.Unicode.GetString(pathBuffer, 0, byteCount));
+                }
+            }
+        }
+
+        private static int ReadBlock(Stream input, byte[] buffer, int count)
+        {
+            var total = 0;
+            int read;
+            while (total < count && (read = input.Read(buffer, total, count - total)) > 0)
+            {
+                total += read;
+            }
+
+            return total;
+        }
+
+        private void AddArgs(string[] args)
+        {
             for (var i = 0; i < args?.Length; i++)
             {
                 if (args[i] == "/d")
                 {
-                    batch.DestinationDirectory = args[++i];
+                    DestinationDirectory = args[++i];
                     continue;
                 }
 
-                batch.Files.Add(args[i]);
+                Files.Add(args[i]);
             }
-
-            return batch;
         }
 
         public IEnumerable<ResizeError> Process(Action<int, double> reportProgress, CancellationToken cancellationToken)
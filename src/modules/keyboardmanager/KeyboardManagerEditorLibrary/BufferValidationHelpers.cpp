@@ -14,8 +14,17 @@ namespace BufferValidationHelpers
 {
     // Function to validate and update an element of the key remap buffer when the selection has changed
     ShortcutErrorType ValidateAndUpdateKeyBufferElement(int rowIndex, int colIndex, int selectedKeyCode, RemapBuffer& remapBuffer)
+    {
+        RemapConflictIndex conflictIndex;
+        conflictIndex.Rebuild(remapBuffer);
+        return ValidateAndUpdateKeyBufferElement(rowIndex, colIndex, selectedKeyCode, remapBuffer, conflictIndex);
+    }
+
+    // Function to validate and update an element of the key remap buffer when the selection has changed. The conflict index of the buffer is kept in sync with the update
+    ShortcutErrorType ValidateAndUpdateKeyBufferElement(int rowIndex, int colIndex, int selectedKeyCode, RemapBuffer& remapBuffer, RemapConflictIndex& conflictIndex)
     {
         ShortcutErrorType errorType = ShortcutErrorType::NoError;
+        DWORD newKeyCode = 0;
 
         // Check if the element was not found or the index exceeds the known keys
         if (selectedKeyCode != -1)
@@ -34,46 +43,34 @@ namespace BufferValidationHelpers
             if (errorType == ShortcutErrorType::NoError && colIndex == 0)
             {
                 // Check if the key is already remapped to something else
-                for (int i = 0; i < remapBuffer.size(); i++)
-                {
-                    if (i != rowIndex)
-                    {
-                        if (remapBuffer[i].first[colIndex].index() == 0)
-                        {
-                            ShortcutErrorType result = EditorHelpers::DoKeysOverlap(std::get<DWORD>(remapBuffer[i].first[colIndex]), selectedKeyCode);
-                            if (result != ShortcutErrorType::NoError)
-                            {
-                                errorType = result;
-                                break;
-                            }
-                        }
-
-                        // If one column is shortcut and other is key no warning required
-                    }
-                }
+                errorType = conflictIndex.FindKeyConflict(selectedKeyCode, remapBuffer[rowIndex].second, remapBuffer[rowIndex]);
             }
 
             // If there is no error, set the buffer
             if (errorType == ShortcutErrorType::NoError)
             {
-                remapBuffer[rowIndex].first[colIndex] = (DWORD)selectedKeyCode;
-            }
-            else
-            {
-                remapBuffer[rowIndex].first[colIndex] = (DWORD)0;
+                newKeyCode = (DWORD)selectedKeyCode;
             }
         }
-        else
-        {
-            // Reset to null if the key is not found
-            remapBuffer[rowIndex].first[colIndex] = (DWORD)0;
-        }
+
+        // Set the buffer, or reset it to null if the key is not found or invalid
+        conflictIndex.RemoveRow(remapBuffer[rowIndex]);
+        remapBuffer[rowIndex].first[colIndex] = newKeyCode;
+        conflictIndex.AddRow(remapBuffer[rowIndex]);
 
         return errorType;
     }
 
     // Function to validate an element of the shortcut remap buffer when the selection has changed
     std::pair<ShortcutErrorType, DropDownAction> ValidateShortcutBufferElement(int rowIndex, int colIndex, uint32_t dropDownIndex, const std::vector<int32_t>& selectedCodes, std::wstring appName, bool isHybridControl, const RemapBuffer& remapBuffer, bool dropDownFound)
+    {
+        RemapConflictIndex conflictIndex;
+        conflictIndex.Rebuild(remapBuffer);
+        return ValidateShortcutBufferElement(rowIndex, colIndex, dropDownIndex, selectedCodes, appName, isHybridControl, remapBuffer, conflictIndex, dropDownFound);
+    }
+
+    // Function to validate an element of the shortcut remap buffer when the selection has changed, using the conflict index of the buffer to look for other rows with the same original keys
+    std::pair<ShortcutErrorType, DropDownAction> ValidateShortcutBufferElement(int rowIndex, int colIndex, uint32_t dropDownIndex, const std::vector<int32_t>& selectedCodes, std::wstring appName, bool isHybridControl, const RemapBuffer& remapBuffer, const RemapConflictIndex& conflictIndex, bool dropDownFound)
     {
         BufferValidationHelpers::DropDownAction dropDownAction = BufferValidationHelpers::DropDownAction::NoAction;
         ShortcutErrorType errorType = ShortcutErrorType::NoError;
@@ -263,43 +260,14 @@ namespace BufferValidationHelpers
             if (errorType == ShortcutErrorType::NoError && colIndex == 0)
             {
                 // Check if the key is already remapped to something else for the same target app
-                for (int i = 0; i < remapBuffer.size(); i++)
+                if (tempShortcut.index() == 1)
                 {
-                    std::wstring currAppName = remapBuffer[i].second;
-                    std::transform(currAppName.begin(), currAppName.end(), currAppName.begin(), towlower);
-
-                    if (i != rowIndex && currAppName == appName)
-                    {
-                        ShortcutErrorType result = ShortcutErrorType::NoError;
-                        if (!isHybridControl)
-                        {
-                            result = EditorHelpers::DoShortcutsOverlap(std::get<Shortcut>(remapBuffer[i].first[colIndex]), std::get<Shortcut>(tempShortcut));
-                        }
-                        else
-                        {
-                            if (tempShortcut.index() == 0 && remapBuffer[i].first[colIndex].index() == 0)
-                            {
-                                if (std::get<DWORD>(tempShortcut) != NULL && std::get<DWORD>(remapBuffer[i].first[colIndex]) != NULL)
-                                {
-                                    result = EditorHelpers::DoKeysOverlap(std::get<DWORD>(remapBuffer[i].first[colIndex]), std::get<DWORD>(tempShortcut));
-                                }
-                            }
-                            else if (tempShortcut.index() == 1 && remapBuffer[i].first[colIndex].index() == 1)
-                            {
-                                auto& shortcut = std::get<Shortcut>(remapBuffer[i].first[colIndex]);
-                                if (EditorHelpers::IsValidShortcut(std::get<Shortcut>(tempShortcut)) && EditorHelpers::IsValidShortcut(shortcut))
-                                {
-                                    result = EditorHelpers::DoShortcutsOverlap(std::get<Shortcut>(remapBuffer[i].first[colIndex]), std::get<Shortcut>(tempShortcut));
-                                }
-                            }
-                            // Other scenarios not possible since key to shortcut is with key to key, and shortcut to key is with shortcut to shortcut
-                        }
-                        if (result != ShortcutErrorType::NoError)
-                        {
-                            errorType = result;
-                            break;
-                        }
-                    }
+                    errorType = conflictIndex.FindShortcutConflict(std::get<Shortcut>(tempShortcut), appName, remapBuffer[rowIndex]);
+                }
+                else if (std::get<DWORD>(tempShortcut) != NULL)
+                {
+                    // Keys are only compared with keys, since key to shortcut is with key to key, and shortcut to key is with shortcut to shortcut
+                    errorType = conflictIndex.FindKeyConflict(std::get<DWORD>(tempShortcut), appName, remapBuffer[rowIndex]);
                 }
             }
 
@@ -2,6 +2,7 @@
 
 #include <keyboardmanager/common/Helpers.h>
 
+#include "RemapConflictIndex.h"
 #include "ShortcutErrorType.h"
 
 namespace BufferValidationHelpers
@@ -17,6 +18,12 @@ namespace BufferValidationHelpers
     // Function to validate and update an element of the key remap buffer when the selection has changed
     ShortcutErrorType ValidateAndUpdateKeyBufferElement(int rowIndex, int colIndex, int selectedKeyCode, RemapBuffer& remapBuffer);
 
+    // Function to validate and update an element of the key remap buffer when the selection has changed. The conflict index of the buffer is kept in sync with the update
+    ShortcutErrorType ValidateAndUpdateKeyBufferElement(int rowIndex, int colIndex, int selectedKeyCode, RemapBuffer& remapBuffer, RemapConflictIndex& conflictIndex);
+
     // Function to validate an element of the shortcut remap buffer when the selection has changed
     std::pair<ShortcutErrorType, DropDownAction> ValidateShortcutBufferElement(int rowIndex, int colIndex, uint32_t dropDownIndex, const std::vector<int32_t>& selectedCodes, std::wstring appName, bool isHybridControl, const RemapBuffer& remapBuffer, bool dropDownFound);
+
+    // Function to validate an element of the shortcut remap buffer when the selection has changed, using the conflict index of the buffer to look for other rows with the same original keys
+    std::pair<ShortcutErrorType, DropDownAction> ValidateShortcutBufferElement(int rowIndex, int colIndex, uint32_t dropDownIndex, const std::vector<int32_t>& selectedCodes, std::wstring appName, bool isHybridControl, const RemapBuffer& remapBuffer, const RemapConflictIndex& conflictIndex, bool dropDownFound);
 }
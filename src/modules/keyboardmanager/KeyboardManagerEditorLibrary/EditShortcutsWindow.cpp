@@ -215,6 +215,7 @@ inline void CreateEditShortcutsWindowImpl(HINSTANCE hInst, KBMEditor::KeyboardMa
     
     // Clear the shortcut remap buffer
     ShortcutControl::shortcutRemapBuffer.clear();
+    ShortcutControl::shortcutRemapConflictIndex.Clear();
     
     // Vector to store dynamically allocated control objects to avoid early destruction
     std::vector<std::vector<std::unique_ptr<ShortcutControl>>> keyboardRemapControlObjects;
@@ -8,6 +8,9 @@
 #include "KeyboardManagerState.h"
 #include "BufferValidationHelpers.h"
 #include "KeyboardManagerEditorStrings.h"
+#include "RemapConflictIndex.h"
+#include "ShortcutControl.h"
+#include "SingleKeyRemapControl.h"
 #include "UIHelpers.h"
 #include "EditorHelpers.h"
 #include "ShortcutErrorType.h"
@@ -111,6 +114,12 @@ void KeyDropDownControl::CheckAndUpdateKeyboardLayout(ComboBox currentDropDown,
     }
 }
 
+// Function to return the conflict index of the remap buffer edited in the window
+RemapConflictIndex& KeyDropDownControl::GetRemapConflictIndex(bool isSingleKeyWindow)
+{
+    return isSingleKeyWindow ? SingleKeyRemapControl::singleKeyRemapConflictIndex : ShortcutControl::shortcutRemapConflictIndex;
+}
+
 // Function to set selection handler for single key remap drop down. Needs to be called after the constructor since the singleKeyControl StackPanel is null if called in the constructor
 void KeyDropDownControl::SetSelectionHandler(StackPanel& table, StackPanel row, int colIndex, RemapBuffer& singleKeyRemapBuffer)
 {
@@ -126,7 +135,7 @@ void KeyDropDownControl::SetSelectionHandler(StackPanel& table, StackPanel row,
         int selectedKeyCode = GetSelectedValue(currentDropDown);
         
         // Validate current remap selection
-        ShortcutErrorType errorType = BufferValidationHelpers::ValidateAndUpdateKeyBufferElement(rowIndex, colIndex, selectedKeyCode, singleKeyRemapBuffer);
+        ShortcutErrorType errorType = BufferValidationHelpers::ValidateAndUpdateKeyBufferElement(rowIndex, colIndex, selectedKeyCode, singleKeyRemapBuffer, SingleKeyRemapControl::singleKeyRemapConflictIndex);
 
         // If there is an error set the warning flyout
         if (errorType != ShortcutErrorType::NoError)
@@ -170,7 +179,7 @@ std::pair<ShortcutErrorType, int> KeyDropDownControl::ValidateShortcutSelection(
         }
 
         // Validate shortcut element
-        validationResult = BufferValidationHelpers::ValidateShortcutBufferElement(rowIndex, colIndex, dropDownIndex, selectedCodes, appName, isHybridControl, shortcutRemapBuffer, dropDownFound);
+        validationResult = BufferValidationHelpers::ValidateShortcutBufferElement(rowIndex, colIndex, dropDownIndex, selectedCodes, appName, isHybridControl, shortcutRemapBuffer, GetRemapConflictIndex(isSingleKeyWindow), dropDownFound);
 
         // Add or clear unused drop downs
         if (validationResult.second == BufferValidationHelpers::DropDownAction::AddDropDown)
@@ -246,6 +255,10 @@ void KeyDropDownControl::SetSelectionHandler(StackPanel& table, StackPanel row,
 
             // Reset the buffer based on the new selected drop down items. Use static key code list since the KeyDropDownControl object might be deleted
             std::vector<int32_t> selectedKeyCodes = GetSelectedCodesFromStackPanel(parent);
+
+            // The row is indexed by its original keys and target app, so it is taken out of the conflict index while they are updated
+            RemapConflictIndex& conflictIndex = GetRemapConflictIndex(isSingleKeyWindow);
+            conflictIndex.RemoveRow(shortcutRemapBuffer[validationResult.second]);
             if (!isHybridControl)
             {
                 std::get<Shortcut>(shortcutRemapBuffer[validationResult.second].first[colIndex]).SetKeyCodes(selectedKeyCodes);
@@ -281,6 +294,8 @@ void KeyDropDownControl::SetSelectionHandler(StackPanel& table, StackPanel row,
                     shortcutRemapBuffer[validationResult.second].second = targetApp.Text().c_str();
                 }
             }
+
+            conflictIndex.AddRow(shortcutRemapBuffer[validationResult.second]);
         }
 
         // If the user searches for a key the selection handler gets invoked however if they click away it reverts back to the previous state. This can result in dangling references to added drop downs which were then reset.
@@ -8,6 +8,7 @@ namespace KBMEditor
 }
 
 class MappingConfiguration;
+class RemapConflictIndex;
 
 namespace winrt::Windows
 {
@@ -58,6 +59,9 @@ private:
     // Function to set accessible name for combobox
     static void SetAccessibleNameForComboBox(ComboBox dropDown, int index);
 
+    // Function to return the conflict index of the remap buffer edited in the window
+    static RemapConflictIndex& GetRemapConflictIndex(bool isSingleKeyWindow);
+
 public:
     // Pointer to the keyboard manager state
     static KBMEditor::KeyboardManagerState* keyboardManagerState;
@@ -1,13 +1,14 @@
 #include "pch.h"
 #include "LoadingAndSavingRemappingHelper.h"
 
-#include <set>
+#include <unordered_set>
 #include <common/interop/shared_constants.h>
 #include <keyboardmanager/common/MappingConfiguration.h>
 
 #include "KeyboardManagerState.h"
 #include "keyboardmanager/KeyboardManagerEditorLibrary/trace.h"
 #include "EditorHelpers.h"
+#include "RemapConflictIndex.h"
 #include "ShortcutErrorType.h"
 
 namespace LoadingAndSavingRemappingHelper
@@ -16,7 +17,7 @@ namespace LoadingAndSavingRemappingHelper
     ShortcutErrorType CheckIfRemappingsAreValid(const RemapBuffer& remappings)
     {
         ShortcutErrorType isSuccess = ShortcutErrorType::NoError;
-        std::map<std::wstring, std::set<KeyShortcutUnion>> ogKeys;
+        std::unordered_map<std::wstring, std::unordered_set<uint64_t>> ogKeys;
         for (int i = 0; i < remappings.size(); i++)
         {
             KeyShortcutUnion ogKey = remappings[i].first[0];
@@ -26,21 +27,8 @@ namespace LoadingAndSavingRemappingHelper
             bool ogKeyValidity = (ogKey.index() == 0 && std::get<DWORD>(ogKey) != NULL) || (ogKey.index() == 1 && EditorHelpers::IsValidShortcut(std::get<Shortcut>(ogKey)));
             bool newKeyValidity = (newKey.index() == 0 && std::get<DWORD>(newKey) != NULL) || (newKey.index() == 1 && EditorHelpers::IsValidShortcut(std::get<Shortcut>(newKey)));
 
-            // Add new set for a new target app name
-            if (ogKeys.find(appName) == ogKeys.end())
-            {
-                ogKeys[appName] = std::set<KeyShortcutUnion>();
-            }
-
-            if (ogKeyValidity && newKeyValidity && ogKeys[appName].find(ogKey) == ogKeys[appName].end())
-            {
-                ogKeys[appName].insert(ogKey);
-            }
-            else if (ogKeyValidity && newKeyValidity && ogKeys[appName].find(ogKey) != ogKeys[appName].end())
-            {
-                isSuccess = ShortcutErrorType::RemapUnsuccessful;
-            }
-            else
+            // Keys are hashed by their identifier, so that validating a large buffer stays linear. The set for a new target app name is added on first use
+            if (!ogKeyValidity || !newKeyValidity || !ogKeys[appName].insert(RemapConflictIndex::GetSourceId(ogKey)).second)
             {
                 isSuccess = ShortcutErrorType::RemapUnsuccessful;
             }
@@ -52,8 +40,8 @@ namespace LoadingAndSavingRemappingHelper
     // Function to return the set of keys that have been orphaned from the remap buffer
     std::vector<DWORD> GetOrphanedKeys(const RemapBuffer& remappings)
     {
-        std::set<DWORD> ogKeys;
-        std::set<DWORD> newKeys;
+        std::unordered_set<DWORD> ogKeys;
+        std::unordered_set<DWORD> newKeys;
 
         for (int i = 0; i < remappings.size(); i++)
         {
@@ -77,7 +65,10 @@ namespace LoadingAndSavingRemappingHelper
             ogKeys.erase(k);
         }
 
-        return std::vector(ogKeys.begin(), ogKeys.end());
+        // Sort the keys since the order of the set is unspecified
+        std::vector<DWORD> orphanedKeys(ogKeys.begin(), ogKeys.end());
+        std::sort(orphanedKeys.begin(), orphanedKeys.end());
+        return orphanedKeys;
     }
 
     // Function to combine remappings if the L and R version of the modifier is mapped to the same key
@@ -0,0 +1,288 @@
+#include "pch.h"
+#include "RemapConflictIndex.h"
+
+#include <array>
+#include <common/interop/shared_constants.h>
+#include <keyboardmanager/common/Helpers.h>
+
+#include "EditorHelpers.h"
+
+namespace
+{
+    // Target app names are compared case insensitively
+    std::wstring ToLower(std::wstring appName)
+    {
+        std::transform(appName.begin(), appName.end(), appName.begin(), towlower);
+        return appName;
+    }
+
+    // Function to return the identifier of the group of shortcuts with the same action key and the same types of modifiers as the shortcut
+    uint64_t GetShortcutGroupId(const Shortcut& shortcut)
+    {
+        uint64_t modifierTypes = (shortcut.winKey != ModifierKey::Disabled ? 1 : 0) | (shortcut.ctrlKey != ModifierKey::Disabled ? 2 : 0) | (shortcut.altKey != ModifierKey::Disabled ? 4 : 0) | (shortcut.shiftKey != ModifierKey::Disabled ? 8 : 0);
+        return (modifierTypes << 32) | shortcut.actionKey;
+    }
+
+    // Function to check if the shortcut has a modifier which doesn't specify the side
+    bool HasCommonModifier(const Shortcut& shortcut)
+    {
+        return shortcut.winKey == ModifierKey::Both || shortcut.ctrlKey == ModifierKey::Both || shortcut.altKey == ModifierKey::Both || shortcut.shiftKey == ModifierKey::Both;
+    }
+
+    // Function to return the common, left and right versions of a modifier key
+    std::array<DWORD, 3> GetModifierKeys(Helpers::KeyType keyType)
+    {
+        switch (keyType)
+        {
+        case Helpers::KeyType::Win:
+            return { CommonSharedConstants::VK_WIN_BOTH, VK_LWIN, VK_RWIN };
+        case Helpers::KeyType::Ctrl:
+            return { VK_CONTROL, VK_LCONTROL, VK_RCONTROL };
+        case Helpers::KeyType::Alt:
+            return { VK_MENU, VK_LMENU, VK_RMENU };
+        case Helpers::KeyType::Shift:
+            return { VK_SHIFT, VK_LSHIFT, VK_RSHIFT };
+        default:
+            return {};
+        }
+    }
+
+    // Function to decrement a count, removing the entry once it reaches zero. Returns false if there was no entry
+    template<typename Key>
+    bool DecrementCount(std::unordered_map<Key, size_t>& counts, const Key& key)
+    {
+        auto it = counts.find(key);
+        if (it == counts.end())
+        {
+            return false;
+        }
+
+        if (--it->second == 0)
+        {
+            counts.erase(it);
+        }
+
+        return true;
+    }
+
+    // Function to return the count for a key, or zero if it isn't in the map
+    template<typename Key>
+    size_t GetCount(const std::unordered_map<Key, size_t>& counts, const Key& key)
+    {
+        auto it = counts.find(key);
+        return it != counts.end() ? it->second : 0;
+    }
+}
+
+// Function to replace the content of the index with the rows of the buffer
+void RemapConflictIndex::Rebuild(const RemapBuffer& remapBuffer)
+{
+    Clear();
+    for (const auto& row : remapBuffer)
+    {
+        AddRow(row);
+    }
+}
+
+// Function to remove all the rows from the index
+void RemapConflictIndex::Clear()
+{
+    apps.clear();
+}
+
+// Function to add the original key or shortcut of a row to the index
+void RemapConflictIndex::AddRow(const RemapBufferRow& row)
+{
+    UpdateRow(row, true);
+}
+
+// Function to remove the original key or shortcut of a row from the index
+void RemapConflictIndex::RemoveRow(const RemapBufferRow& row)
+{
+    UpdateRow(row, false);
+}
+
+// Function to add or remove the original key or shortcut of a row
+void RemapConflictIndex::UpdateRow(const RemapBufferRow& row, bool isAdded)
+{
+    const KeyShortcutUnion& source = row.first[0];
+
+    // Invalid shortcuts don't conflict with anything, so they aren't indexed
+    if (source.index() == 1 && !EditorHelpers::IsValidShortcut(std::get<Shortcut>(source)))
+    {
+        return;
+    }
+
+    std::wstring appName = ToLower(row.second);
+    if (isAdded)
+    {
+        AppEntries& app = apps[appName];
+        if (source.index() == 0)
+        {
+            app.keyCounts[std::get<DWORD>(source)]++;
+        }
+        else
+        {
+            const Shortcut& shortcut = std::get<Shortcut>(source);
+            ShortcutGroup& group = app.shortcutGroups[GetShortcutGroupId(shortcut)];
+            group.count++;
+            group.commonModifierCount += HasCommonModifier(shortcut) ? 1 : 0;
+            group.shortcutCounts[GetSourceId(source)]++;
+        }
+
+        return;
+    }
+
+    auto appIt = apps.find(appName);
+    if (appIt == apps.end())
+    {
+        return;
+    }
+
+    AppEntries& app = appIt->second;
+    if (source.index() == 0)
+    {
+        DecrementCount(app.keyCounts, std::get<DWORD>(source));
+    }
+    else
+    {
+        const Shortcut& shortcut = std::get<Shortcut>(source);
+        auto groupIt = app.shortcutGroups.find(GetShortcutGroupId(shortcut));
+        if (groupIt != app.shortcutGroups.end() && DecrementCount(groupIt->second.shortcutCounts, GetSourceId(source)))
+        {
+            ShortcutGroup& group = groupIt->second;
+            group.count--;
+            group.commonModifierCount -= HasCommonModifier(shortcut) ? 1 : 0;
+            if (group.count == 0)
+            {
+                app.shortcutGroups.erase(groupIt);
+            }
+        }
+    }
+
+    if (app.keyCounts.empty() && app.shortcutGroups.empty())
+    {
+        apps.erase(appIt);
+    }
+}
+
+// Function to return the entries for the target app or null if no row has that target app
+const RemapConflictIndex::AppEntries* RemapConflictIndex::FindApp(const std::wstring& lowercaseAppName) const
+{
+    auto it = apps.find(lowercaseAppName);
+    return it != apps.end() ? &it->second : nullptr;
+}
+
+// Function to check if the key overlaps with the original key of another row with the same target app. The edited row is excluded from the check
+ShortcutErrorType RemapConflictIndex::FindKeyConflict(DWORD key, const std::wstring& appName, const RemapBufferRow& editedRow) const
+{
+    std::wstring lowercaseAppName = ToLower(appName);
+    const AppEntries* app = FindApp(lowercaseAppName);
+    if (app == nullptr)
+    {
+        return ShortcutErrorType::NoError;
+    }
+
+    const KeyShortcutUnion& editedSource = editedRow.first[0];
+    bool isEditedRowIndexed = editedSource.index() == 0 && ToLower(editedRow.second) == lowercaseAppName;
+
+    // Number of rows other than the edited row which have the key as their original key
+    auto countOtherRows = [&](DWORD otherKey) {
+        size_t count = GetCount(app->keyCounts, otherKey);
+        if (count > 0 && isEditedRowIndexed && std::get<DWORD>(editedSource) == otherKey)
+        {
+            count--;
+        }
+
+        return count;
+    };
+
+    if (countOtherRows(key) > 0)
+    {
+        return ShortcutErrorType::SameKeyPreviouslyMapped;
+    }
+
+    // Modifiers also overlap with the other versions of the same modifier, except for the left and right versions with each other
+    if (Helpers::IsModifierKey(key))
+    {
+        for (DWORD otherKey : GetModifierKeys(Helpers::GetKeyType(key)))
+        {
+            ShortcutErrorType result = EditorHelpers::DoKeysOverlap(otherKey, key);
+            if (otherKey != key && result != ShortcutErrorType::NoError && countOtherRows(otherKey) > 0)
+            {
+                return result;
+            }
+        }
+    }
+
+    return ShortcutErrorType::NoError;
+}
+
+// Function to check if the shortcut overlaps with the original shortcut of another row with the same target app. The edited row is excluded from the check
+ShortcutErrorType RemapConflictIndex::FindShortcutConflict(const Shortcut& shortcut, const std::wstring& appName, const RemapBufferRow& editedRow) const
+{
+    if (!EditorHelpers::IsValidShortcut(shortcut))
+    {
+        return ShortcutErrorType::NoError;
+    }
+
+    std::wstring lowercaseAppName = ToLower(appName);
+    const AppEntries* app = FindApp(lowercaseAppName);
+    if (app == nullptr)
+    {
+        return ShortcutErrorType::NoError;
+    }
+
+    uint64_t groupId = GetShortcutGroupId(shortcut);
+    auto groupIt = app->shortcutGroups.find(groupId);
+    if (groupIt == app->shortcutGroups.end())
+    {
+        return ShortcutErrorType::NoError;
+    }
+
+    const ShortcutGroup& group = groupIt->second;
+    uint64_t sourceId = GetSourceId(shortcut);
+    size_t count = group.count;
+    size_t commonModifierCount = group.commonModifierCount;
+    size_t sameShortcutCount = GetCount(group.shortcutCounts, sourceId);
+
+    // Leave out the edited row if it is in the same group
+    const KeyShortcutUnion& editedSource = editedRow.first[0];
+    if (editedSource.index() == 1 && ToLower(editedRow.second) == lowercaseAppName)
+    {
+        const Shortcut& editedShortcut = std::get<Shortcut>(editedSource);
+        if (EditorHelpers::IsValidShortcut(editedShortcut) && GetShortcutGroupId(editedShortcut) == groupId)
+        {
+            count--;
+            commonModifierCount -= HasCommonModifier(editedShortcut) ? 1 : 0;
+            sameShortcutCount -= GetSourceId(editedSource) == sourceId ? 1 : 0;
+        }
+    }
+
+    if (sameShortcutCount > 0)
+    {
+        return ShortcutErrorType::SameShortcutPreviouslyMapped;
+    }
+
+    // Every other shortcut of the group is different, so it overlaps if either of them has a common modifier
+    if (count > 0 && (HasCommonModifier(shortcut) || commonModifierCount > 0))
+    {
+        return ShortcutErrorType::ConflictingModifierShortcut;
+    }
+
+    return ShortcutErrorType::NoError;
+}
+
+// Function to return a value identifying a key or a shortcut, two of them are equal if and only if their identifiers are equal
+uint64_t RemapConflictIndex::GetSourceId(const KeyShortcutUnion& source)
+{
+    if (source.index() == 0)
+    {
+        return std::get<DWORD>(source);
+    }
+
+    // Shortcuts are told apart from keys by the highest bit, each modifier takes two bits above the action key
+    const Shortcut& shortcut = std::get<Shortcut>(source);
+    uint64_t modifiers = (uint64_t)shortcut.winKey | ((uint64_t)shortcut.ctrlKey << 2) | ((uint64_t)shortcut.altKey << 4) | ((uint64_t)shortcut.shiftKey << 6);
+    return (1ull << 63) | (modifiers << 32) | shortcut.actionKey;
+}
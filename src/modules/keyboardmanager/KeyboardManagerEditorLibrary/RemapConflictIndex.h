@@ -0,0 +1,57 @@
+#pragma once
+
+#include <unordered_map>
+
+#include <keyboardmanager/common/Shortcut.h>
+
+#include "ShortcutErrorType.h"
+
+// Index of the original keys and shortcuts of a remap buffer by target app. It is used to check an edited row for conflicts with the other rows without scanning the whole buffer.
+// The index has to be kept in sync with the buffer: a row is removed from the index before its original keys or target app are modified and added back afterwards
+class RemapConflictIndex
+{
+public:
+    // Function to replace the content of the index with the rows of the buffer
+    void Rebuild(const RemapBuffer& remapBuffer);
+
+    // Function to remove all the rows from the index
+    void Clear();
+
+    // Function to add the original key or shortcut of a row to the index
+    void AddRow(const RemapBufferRow& row);
+
+    // Function to remove the original key or shortcut of a row from the index
+    void RemoveRow(const RemapBufferRow& row);
+
+    // Function to check if the key overlaps with the original key of another row with the same target app. The edited row is excluded from the check
+    ShortcutErrorType FindKeyConflict(DWORD key, const std::wstring& appName, const RemapBufferRow& editedRow) const;
+
+    // Function to check if the shortcut overlaps with the original shortcut of another row with the same target app. The edited row is excluded from the check
+    ShortcutErrorType FindShortcutConflict(const Shortcut& shortcut, const std::wstring& appName, const RemapBufferRow& editedRow) const;
+
+    // Function to return a value identifying a key or a shortcut, two of them are equal if and only if their identifiers are equal
+    static uint64_t GetSourceId(const KeyShortcutUnion& source);
+
+private:
+    // Valid shortcuts with the same action key and the same types of modifiers. Two different shortcuts of a group overlap if one of them has a modifier which doesn't specify the side, i.e. Ctrl+A and LCtrl+A
+    struct ShortcutGroup
+    {
+        size_t count = 0;
+        size_t commonModifierCount = 0;
+        std::unordered_map<uint64_t, size_t> shortcutCounts;
+    };
+
+    struct AppEntries
+    {
+        std::unordered_map<DWORD, size_t> keyCounts;
+        std::unordered_map<uint64_t, ShortcutGroup> shortcutGroups;
+    };
+
+    // Function to add or remove the original key or shortcut of a row
+    void UpdateRow(const RemapBufferRow& row, bool isAdded);
+
+    // Function to return the entries for the target app or null if no row has that target app
+    const AppEntries* FindApp(const std::wstring& lowercaseAppName) const;
+
+    std::unordered_map<std::wstring, AppEntries> apps;
+};
@@ -15,6 +15,7 @@ HWND ShortcutControl::editShortcutsWindowHandle = nullptr;
 KBMEditor::KeyboardManagerState* ShortcutControl::keyboardManagerState = nullptr;
 // Initialized as new vector
 RemapBuffer ShortcutControl::shortcutRemapBuffer;
+RemapConflictIndex ShortcutControl::shortcutRemapConflictIndex;
 
 ShortcutControl::ShortcutControl(StackPanel table, StackPanel row, const int colIndex, TextBox targetApp)
 {
@@ -139,7 +140,8 @@ void ShortcutControl::AddNewShortcutControlRow(StackPanel& parent, std::vector<s
         KeyDropDownControl::ValidateShortcutFromDropDownList(parent, row, keyboardRemapControlObjects[rowIndex][0]->shortcutDropDownStackPanel.as<StackPanel>(), 0, ShortcutControl::shortcutRemapBuffer, keyboardRemapControlObjects[rowIndex][0]->keyDropDownControlObjects, targetAppTextBox, false, false);
         KeyDropDownControl::ValidateShortcutFromDropDownList(parent, row, keyboardRemapControlObjects[rowIndex][1]->shortcutDropDownStackPanel.as<StackPanel>(), 1, ShortcutControl::shortcutRemapBuffer, keyboardRemapControlObjects[rowIndex][1]->keyDropDownControlObjects, targetAppTextBox, true, false);
 
-        // Reset the buffer based on the selected drop down items
+        // Reset the buffer based on the selected drop down items. The row is taken out of the conflict index while it is updated
+        shortcutRemapConflictIndex.RemoveRow(shortcutRemapBuffer[rowIndex]);
         std::get<Shortcut>(shortcutRemapBuffer[rowIndex].first[0]).SetKeyCodes(KeyDropDownControl::GetSelectedCodesFromStackPanel(keyboardRemapControlObjects[rowIndex][0]->shortcutDropDownStackPanel.as<StackPanel>()));
         // second column is a hybrid column
 
@@ -169,6 +171,7 @@ void ShortcutControl::AddNewShortcutControlRow(StackPanel& parent, std::vector<s
         {
             shortcutRemapBuffer[rowIndex].second = targetAppTextBox.Text().c_str();
         }
+        shortcutRemapConflictIndex.AddRow(shortcutRemapBuffer[rowIndex]);
 
         // To set the accessibile name of the target app text box when focus is lost
         ShortcutControl::SetAccessibleNameForTextBox(targetAppTextBox, rowIndex + 1);
@@ -217,6 +220,7 @@ void ShortcutControl::AddNewShortcutControlRow(StackPanel& parent, std::vector<s
 
         children.RemoveAt(rowIndex);
         parent.UpdateLayout();
+        shortcutRemapConflictIndex.RemoveRow(shortcutRemapBuffer[rowIndex]);
         shortcutRemapBuffer.erase(shortcutRemapBuffer.begin() + rowIndex);
         // delete the SingleKeyRemapControl objects so that they get destructed
         keyboardRemapControlObjects.erase(keyboardRemapControlObjects.begin() + rowIndex);
@@ -245,6 +249,7 @@ void ShortcutControl::AddNewShortcutControlRow(StackPanel& parent, std::vector<s
     {
         // change to load app name
         shortcutRemapBuffer.push_back(std::make_pair<RemapBufferItem, std::wstring>(RemapBufferItem{ Shortcut(), Shortcut() }, std::wstring(targetAppName)));
+        shortcutRemapConflictIndex.AddRow(shortcutRemapBuffer.back());
         KeyDropDownControl::AddShortcutToControl(originalKeys, parent, keyboardRemapControlObjects[keyboardRemapControlObjects.size() - 1][0]->shortcutDropDownStackPanel.as<StackPanel>(), *keyboardManagerState, 0, keyboardRemapControlObjects[keyboardRemapControlObjects.size() - 1][0]->keyDropDownControlObjects, shortcutRemapBuffer, row, targetAppTextBox, false, false);
 
         if (newKeys.index() == 0)
@@ -260,6 +265,7 @@ void ShortcutControl::AddNewShortcutControlRow(StackPanel& parent, std::vector<s
     {
         // Initialize both shortcuts as empty shortcuts
         shortcutRemapBuffer.push_back(std::make_pair<RemapBufferItem, std::wstring>(RemapBufferItem{ Shortcut(), Shortcut() }, std::wstring(targetAppName)));
+        shortcutRemapConflictIndex.AddRow(shortcutRemapBuffer.back());
     }
 }
 
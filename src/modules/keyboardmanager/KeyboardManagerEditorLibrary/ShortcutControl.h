@@ -2,6 +2,8 @@
 
 #include <keyboardmanager/common/Shortcut.h>
 
+#include "RemapConflictIndex.h"
+
 namespace KBMEditor
 {
     class KeyboardManagerState;
@@ -47,6 +49,9 @@ public:
     // Stores the current list of remappings
     static RemapBuffer shortcutRemapBuffer;
 
+    // Index of the original shortcuts in the remap buffer, which has to be updated along with the buffer
+    static RemapConflictIndex shortcutRemapConflictIndex;
+
     // Vector to store dynamically allocated KeyDropDownControl objects to avoid early destruction
     std::vector<std::unique_ptr<KeyDropDownControl>> keyDropDownControlObjects;
 
@@ -12,6 +12,7 @@ HWND SingleKeyRemapControl::EditKeyboardWindowHandle = nullptr;
 KBMEditor::KeyboardManagerState* SingleKeyRemapControl::keyboardManagerState = nullptr;
 // Initialized as new vector
 RemapBuffer SingleKeyRemapControl::singleKeyRemapBuffer;
+RemapConflictIndex SingleKeyRemapControl::singleKeyRemapConflictIndex;
 
 SingleKeyRemapControl::SingleKeyRemapControl(StackPanel table, StackPanel row, const int colIndex)
 {
@@ -111,6 +112,7 @@ void SingleKeyRemapControl::AddNewControlKeyRemapRow(StackPanel& parent, std::ve
     if (originalKey != NULL && !(newKey.index() == 0 && std::get<DWORD>(newKey) == NULL) && !(newKey.index() == 1 && !EditorHelpers::IsValidShortcut(std::get<Shortcut>(newKey))))
     {
         singleKeyRemapBuffer.push_back(std::make_pair<RemapBufferItem, std::wstring>(RemapBufferItem{ originalKey, newKey }, L""));
+        singleKeyRemapConflictIndex.AddRow(singleKeyRemapBuffer.back());
         keyboardRemapControlObjects[keyboardRemapControlObjects.size() - 1][0]->keyDropDownControlObjects[0]->SetSelectedValue(std::to_wstring(originalKey));
         if (newKey.index() == 0)
         {
@@ -125,6 +127,7 @@ void SingleKeyRemapControl::AddNewControlKeyRemapRow(StackPanel& parent, std::ve
     {
         // Initialize both keys to NULL
         singleKeyRemapBuffer.push_back(std::make_pair<RemapBufferItem, std::wstring>(RemapBufferItem{ (DWORD)0, (DWORD)0 }, L""));
+        singleKeyRemapConflictIndex.AddRow(singleKeyRemapBuffer.back());
     }
 
     // Delete row button
@@ -160,6 +163,7 @@ void SingleKeyRemapControl::AddNewControlKeyRemapRow(StackPanel& parent, std::ve
 
         children.RemoveAt(rowIndex);
         parent.UpdateLayout();
+        singleKeyRemapConflictIndex.RemoveRow(singleKeyRemapBuffer[rowIndex]);
         singleKeyRemapBuffer.erase(singleKeyRemapBuffer.begin() + rowIndex);
     
         // delete the SingleKeyRemapControl objects so that they get destructed
@@ -3,6 +3,7 @@
 #include <keyboardmanager/common/Shortcut.h>
 
 #include <KeyDropDownControl.h>
+#include "RemapConflictIndex.h"
 
 namespace KBMEditor
 {
@@ -48,6 +49,9 @@ public:
     // Stores the current list of remappings
     static RemapBuffer singleKeyRemapBuffer;
 
+    // Index of the original keys in the remap buffer, which has to be updated along with the buffer
+    static RemapConflictIndex singleKeyRemapConflictIndex;
+
     // constructor
     SingleKeyRemapControl(StackPanel table, StackPanel row, const int colIndex);
 
@@ -0,0 +1,241 @@
+#include "pch.h"
+#include "CppUnitTest.h"
+#include <keyboardmanager/KeyboardManagerEditorLibrary/BufferValidationHelpers.h>
+#include <keyboardmanager/KeyboardManagerEditorLibrary/EditorHelpers.h>
+#include <keyboardmanager/KeyboardManagerEditorLibrary/LoadingAndSavingRemappingHelper.h>
+#include <keyboardmanager/KeyboardManagerEditorLibrary/RemapConflictIndex.h>
+#include <keyboardmanager/KeyboardManagerEditorLibrary/ShortcutErrorType.h>
+#include <common/interop/shared_constants.h>
+#include <chrono>
+#include <random>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace RemappingUITests
+{
+    // Tests for the RemapConflictIndex class
+    TEST_CLASS (RemapConflictIndexTests)
+    {
+        std::wstring testApp1 = L"testprocess1.exe";
+        std::wstring testApp2 = L"testprocess2.exe";
+
+        // Function to return a buffer of shortcut remaps with distinct original shortcuts which don't conflict with each other, spread over the given number of target apps
+        static RemapBuffer CreateShortcutRemapBuffer(size_t rowCount, size_t appCount)
+        {
+            // Shortcuts with one or two modifiers of a given side, the editor allows up to three keys
+            std::vector<std::vector<int32_t>> modifierSets;
+            const std::vector<std::vector<int32_t>> modifierSides = { { VK_LWIN, VK_RWIN }, { VK_LCONTROL, VK_RCONTROL }, { VK_LMENU, VK_RMENU }, { VK_LSHIFT, VK_RSHIFT } };
+            for (size_t i = 0; i < modifierSides.size(); i++)
+            {
+                for (int32_t first : modifierSides[i])
+                {
+                    modifierSets.push_back({ first });
+                    for (size_t j = i + 1; j < modifierSides.size(); j++)
+                    {
+                        for (int32_t second : modifierSides[j])
+                        {
+                            modifierSets.push_back({ first, second });
+                        }
+                    }
+                }
+            }
+
+            std::vector<Shortcut> shortcuts;
+            for (int32_t actionKey = 0x41; actionKey <= 0x5A; actionKey++)
+            {
+                for (const auto& modifiers : modifierSets)
+                {
+                    std::vector<int32_t> keys = modifiers;
+                    keys.push_back(actionKey);
+                    Shortcut shortcut(keys);
+                    if (EditorHelpers::IsShortcutIllegal(shortcut) == ShortcutErrorType::NoError)
+                    {
+                        shortcuts.push_back(shortcut);
+                    }
+                }
+            }
+
+            RemapBuffer remapBuffer;
+            for (size_t i = 0; i < rowCount; i++)
+            {
+                std::wstring appName = L"testprocess" + std::to_wstring(i % appCount) + L".exe";
+                remapBuffer.push_back(std::make_pair(RemapBufferItem{ shortcuts[(i / appCount) % shortcuts.size()], (DWORD)0x41 }, appName));
+            }
+
+            return remapBuffer;
+        }
+
+        // Function to validate and update an element of the key remap buffer by comparing the key with every other row
+        static ShortcutErrorType ValidateAndUpdateKeyBufferElementByScanning(int rowIndex, int colIndex, int selectedKeyCode, RemapBuffer& remapBuffer)
+        {
+            ShortcutErrorType errorType = ShortcutErrorType::NoError;
+            if (selectedKeyCode != -1)
+            {
+                const KeyShortcutUnion& otherColumn = remapBuffer[rowIndex].first[std::abs(colIndex - 1)];
+                if (otherColumn.index() == 0 && std::get<DWORD>(otherColumn) == (DWORD)selectedKeyCode)
+                {
+                    errorType = ShortcutErrorType::MapToSameKey;
+                }
+
+                for (int i = 0; errorType == ShortcutErrorType::NoError && colIndex == 0 && i < (int)remapBuffer.size(); i++)
+                {
+                    if (i != rowIndex && remapBuffer[i].first[0].index() == 0)
+                    {
+                        errorType = EditorHelpers::DoKeysOverlap(std::get<DWORD>(remapBuffer[i].first[0]), selectedKeyCode);
+                    }
+                }
+            }
+
+            remapBuffer[rowIndex].first[colIndex] = (DWORD)(selectedKeyCode != -1 && errorType == ShortcutErrorType::NoError ? selectedKeyCode : 0);
+            return errorType;
+        }
+
+        // Function to return the codes selected on the drop downs of a shortcut
+        static std::vector<int32_t> GetSelectedCodes(Shortcut shortcut)
+        {
+            std::vector<int32_t> selectedCodes;
+            for (DWORD key : shortcut.GetKeyCodes())
+            {
+                selectedCodes.push_back((int32_t)key);
+            }
+
+            return selectedCodes;
+        }
+
+    public:
+        TEST_METHOD_INITIALIZE(InitializeTestEnv)
+        {
+        }
+
+        // Test if the key of the edited row is not reported as a conflict with itself
+        TEST_METHOD (FindKeyConflict_ShouldReturnNoError_OnKeyOnlyMappedInTheEditedRow)
+        {
+            RemapBuffer remapBuffer;
+            remapBuffer.push_back(std::make_pair(RemapBufferItem({ (DWORD)0x41, (DWORD)0x42 }), std::wstring()));
+            remapBuffer.push_back(std::make_pair(RemapBufferItem({ (DWORD)0x43, (DWORD)0x44 }), std::wstring()));
+            RemapConflictIndex conflictIndex;
+            conflictIndex.Rebuild(remapBuffer);
+
+            Assert::AreEqual(true, conflictIndex.FindKeyConflict(0x41, std::wstring(), remapBuffer[0]) == ShortcutErrorType::NoError);
+            Assert::AreEqual(true, conflictIndex.FindKeyConflict(0x41, std::wstring(), remapBuffer[1]) == ShortcutErrorType::SameKeyPreviouslyMapped);
+        }
+
+        // Test if the common version of a modifier conflicts with the left and right versions, which don't conflict with each other
+        TEST_METHOD (FindKeyConflict_ShouldReturnConflictingModifierKey_OnCommonAndSidedVersionsOfAModifier)
+        {
+            RemapBuffer remapBuffer;
+            remapBuffer.push_back(std::make_pair(RemapBufferItem({ (DWORD)VK_LCONTROL, (DWORD)0x42 }), std::wstring()));
+            remapBuffer.push_back(std::make_pair(RemapBufferItem({ (DWORD)0, (DWORD)0x43 }), std::wstring()));
+            RemapConflictIndex conflictIndex;
+            conflictIndex.Rebuild(remapBuffer);
+
+            Assert::AreEqual(true, conflictIndex.FindKeyConflict(VK_CONTROL, std::wstring(), remapBuffer[1]) == ShortcutErrorType::ConflictingModifierKey);
+            Assert::AreEqual(true, conflictIndex.FindKeyConflict(VK_RCONTROL, std::wstring(), remapBuffer[1]) == ShortcutErrorType::NoError);
+            Assert::AreEqual(true, conflictIndex.FindKeyConflict(VK_LSHIFT, std::wstring(), remapBuffer[1]) == ShortcutErrorType::NoError);
+        }
+
+        // Test if shortcuts are only compared with the rows for the same target app, ignoring the case of the app name
+        TEST_METHOD (FindShortcutConflict_ShouldOnlyReturnConflicts_OnRowsWithTheSameTargetApp)
+        {
+            RemapBuffer remapBuffer;
+            remapBuffer.push_back(std::make_pair(RemapBufferItem({ Shortcut(std::vector<int32_t>{ VK_CONTROL, 0x41 }), (DWORD)0x42 }), L"TestProcess1.exe"));
+            remapBuffer.push_back(std::make_pair(RemapBufferItem({ Shortcut(), (DWORD)0x43 }), testApp1));
+            RemapConflictIndex conflictIndex;
+            conflictIndex.Rebuild(remapBuffer);
+
+            Assert::AreEqual(true, conflictIndex.FindShortcutConflict(Shortcut(std::vector<int32_t>{ VK_CONTROL, 0x41 }), testApp1, remapBuffer[1]) == ShortcutErrorType::SameShortcutPreviouslyMapped);
+            Assert::AreEqual(true, conflictIndex.FindShortcutConflict(Shortcut(std::vector<int32_t>{ VK_LCONTROL, 0x41 }), testApp1, remapBuffer[1]) == ShortcutErrorType::ConflictingModifierShortcut);
+            Assert::AreEqual(true, conflictIndex.FindShortcutConflict(Shortcut(std::vector<int32_t>{ VK_CONTROL, VK_SHIFT, 0x41 }), testApp1, remapBuffer[1]) == ShortcutErrorType::NoError);
+            Assert::AreEqual(true, conflictIndex.FindShortcutConflict(Shortcut(std::vector<int32_t>{ VK_CONTROL, 0x41 }), testApp2, remapBuffer[1]) == ShortcutErrorType::NoError);
+        }
+
+        // Test if a removed row no longer conflicts with the other rows
+        TEST_METHOD (RemoveRow_ShouldRemoveConflicts_OnRemovingTheConflictingRow)
+        {
+            RemapBuffer remapBuffer;
+            remapBuffer.push_back(std::make_pair(RemapBufferItem({ Shortcut(std::vector<int32_t>{ VK_LCONTROL, 0x41 }), (DWORD)0x42 }), std::wstring()));
+            remapBuffer.push_back(std::make_pair(RemapBufferItem({ Shortcut(std::vector<int32_t>{ VK_RCONTROL, 0x41 }), (DWORD)0x43 }), std::wstring()));
+            remapBuffer.push_back(std::make_pair(RemapBufferItem({ Shortcut(), (DWORD)0x44 }), std::wstring()));
+            RemapConflictIndex conflictIndex;
+            conflictIndex.Rebuild(remapBuffer);
+            Assert::AreEqual(true, conflictIndex.FindShortcutConflict(Shortcut(std::vector<int32_t>{ VK_CONTROL, 0x41 }), std::wstring(), remapBuffer[2]) == ShortcutErrorType::ConflictingModifierShortcut);
+
+            conflictIndex.RemoveRow(remapBuffer[0]);
+            remapBuffer.erase(remapBuffer.begin());
+            Assert::AreEqual(true, conflictIndex.FindShortcutConflict(Shortcut(std::vector<int32_t>{ VK_CONTROL, 0x41 }), std::wstring(), remapBuffer[1]) == ShortcutErrorType::ConflictingModifierShortcut);
+
+            conflictIndex.RemoveRow(remapBuffer[0]);
+            remapBuffer.erase(remapBuffer.begin());
+            Assert::AreEqual(true, conflictIndex.FindShortcutConflict(Shortcut(std::vector<int32_t>{ VK_CONTROL, 0x41 }), std::wstring(), remapBuffer[0]) == ShortcutErrorType::NoError);
+        }
+
+        // Test if an index updated along with a series of edits gives the same results as scanning the whole buffer
+        TEST_METHOD (ValidateAndUpdateKeyBufferElement_ShouldMatchAFullScan_OnASeriesOfEdits)
+        {
+            const std::vector<int> keys = { -1, 0, 0x41, 0x42, VK_CONTROL, VK_LCONTROL, VK_RCONTROL, VK_SHIFT, VK_LSHIFT, VK_LWIN, CommonSharedConstants::VK_WIN_BOTH };
+            std::mt19937 rng(46);
+            RemapBuffer remapBuffer;
+            for (int i = 0; i < 8; i++)
+            {
+                remapBuffer.push_back(std::make_pair(RemapBufferItem({ (DWORD)0, (DWORD)0 }), std::wstring()));
+            }
+
+            RemapConflictIndex conflictIndex;
+            conflictIndex.Rebuild(remapBuffer);
+            for (int i = 0; i < 2000; i++)
+            {
+                int rowIndex = (int)(rng() % remapBuffer.size());
+                int colIndex = (int)(rng() % 2);
+                int selectedKeyCode = keys[rng() % keys.size()];
+
+                RemapBuffer expectedBuffer = remapBuffer;
+                ShortcutErrorType expectedError = ValidateAndUpdateKeyBufferElementByScanning(rowIndex, colIndex, selectedKeyCode, expectedBuffer);
+                ShortcutErrorType error = BufferValidationHelpers::ValidateAndUpdateKeyBufferElement(rowIndex, colIndex, selectedKeyCode, remapBuffer, conflictIndex);
+
+                Assert::AreEqual(true, expectedError == error);
+                Assert::AreEqual(true, expectedBuffer == remapBuffer);
+            }
+        }
+
+        // Test if the CheckIfRemappingsAreValid method returns an error on a duplicate shortcut in a large buffer
+        TEST_METHOD (CheckIfRemappingsAreValid_ShouldReturnRemapUnsuccessful_OnDuplicateShortcutInALargeBuffer)
+        {
+            RemapBuffer remapBuffer = CreateShortcutRemapBuffer(5000, 10);
+            Assert::AreEqual(true, LoadingAndSavingRemappingHelper::CheckIfRemappingsAreValid(remapBuffer) == ShortcutErrorType::NoError);
+
+            remapBuffer.push_back(remapBuffer[2500]);
+            Assert::AreEqual(true, LoadingAndSavingRemappingHelper::CheckIfRemappingsAreValid(remapBuffer) == ShortcutErrorType::RemapUnsuccessful);
+        }
+
+        // Benchmark of the validation of every row of a large imported set of shortcut remaps
+        TEST_METHOD (ValidateShortcutBufferElement_Performance5000Rows)
+        {
+            constexpr size_t rowCount = 5000;
+            RemapBuffer remapBuffer = CreateShortcutRemapBuffer(rowCount, 10);
+
+            const auto start = std::chrono::steady_clock::now();
+            RemapConflictIndex conflictIndex;
+            conflictIndex.Rebuild(remapBuffer);
+
+            // Select the action key of each row again, as when the remaps are loaded in the editor
+            size_t errorCount = 0;
+            for (int rowIndex = 0; rowIndex < (int)rowCount; rowIndex++)
+            {
+                std::vector<int32_t> selectedCodes = GetSelectedCodes(std::get<Shortcut>(remapBuffer[rowIndex].first[0]));
+                auto result = BufferValidationHelpers::ValidateShortcutBufferElement(rowIndex, 0, (uint32_t)selectedCodes.size() - 1, selectedCodes, remapBuffer[rowIndex].second, false, remapBuffer, conflictIndex, true);
+                errorCount += result.first != ShortcutErrorType::NoError ? 1 : 0;
+            }
+
+            bool isValid = LoadingAndSavingRemappingHelper::CheckIfRemappingsAreValid(remapBuffer) == ShortcutErrorType::NoError;
+            const auto duration = std::chrono::steady_clock::now() - start;
+
+            Assert::AreEqual((size_t)0, errorCount);
+            Assert::AreEqual(true, isValid);
+
+            using ns = std::chrono::duration<double, std::nano>;
+            const double perRow = ns(duration).count() / rowCount;
+            const auto message = std::to_wstring(rowCount) + L" rows: " + std::to_wstring(perRow) + L" ns per row validation\n";
+            Logger::WriteMessage(message.c_str());
+        }
+    };
+}
@@ -29,4 +29,7 @@ namespace KeyboardEventHandlers
 
     // Function to ensure Ctrl/Shift/Alt modifier key state is not detected as pressed down by applications which detect keys at a lower level than hooks when it is remapped for scenarios where its required
     void ResetIfModifierKeyForLowerLevelKeyHandlers(KeyboardManagerInput::InputInterface& ii, DWORD key, DWORD target);
+
+    // Function to ensure Ctrl/Shift/Alt modifier key state is not detected as pressed down by applications which detect keys at a lower level than hooks, for each key of a shortcut
+    void ResetIfModifierKeysForLowerLevelKeyHandlers(KeyboardManagerInput::InputInterface& ii, const Shortcut& shortcut, DWORD target);
 };
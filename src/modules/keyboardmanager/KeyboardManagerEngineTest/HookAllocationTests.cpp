@@ -0,0 +1,241 @@
+#include "pch.h"
+#include "CppUnitTest.h"
+#include "MockedInput.h"
+#include <keyboardmanager/KeyboardManagerEngineLibrary/State.h>
+#include <keyboardmanager/KeyboardManagerEngineLibrary/KeyboardEventHandlers.h>
+#include "TestHelpers.h"
+#include <common/interop/shared_constants.h>
+#include <new>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace
+{
+    // Allocations are only counted on the thread running the test, while CountAllocations is running
+    thread_local bool countAllocations = false;
+    thread_local size_t allocationCount = 0;
+
+    // Function to return the number of heap allocations made while running the given action
+    template<typename Action>
+    size_t CountAllocations(Action&& action)
+    {
+        allocationCount = 0;
+        countAllocations = true;
+        action();
+        countAllocations = false;
+        return allocationCount;
+    }
+}
+
+// Counting replacement of the global allocation functions for this test module. The array and nothrow forms forward to these
+void* operator new(size_t size)
+{
+    if (countAllocations)
+    {
+        allocationCount++;
+    }
+
+    if (void* ptr = malloc(size == 0 ? 1 : size))
+    {
+        return ptr;
+    }
+
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept
+{
+    free(ptr);
+}
+
+namespace RemappingLogicTests
+{
+    // Tests that handling a key event in the low level hook doesn't allocate
+    TEST_CLASS (HookAllocationTests)
+    {
+    private:
+        KeyboardManagerInput::MockedInput mockedInputHandler;
+        State testState;
+
+        // Function to set the single key remap handler as the hook procedure
+        void SetSingleKeyRemapHook()
+        {
+            std::function<intptr_t(LowlevelKeyboardEvent*)> currentHookProc = std::bind(&KeyboardEventHandlers::HandleSingleKeyRemapEvent, std::ref(mockedInputHandler), std::placeholders::_1, std::ref(testState));
+            mockedInputHandler.SetHookProc(currentHookProc);
+        }
+
+        // Function to set the os-level shortcut remap handler as the hook procedure
+        void SetOSLevelShortcutRemapHook()
+        {
+            std::function<intptr_t(LowlevelKeyboardEvent*)> currentHookProc = std::bind(&KeyboardEventHandlers::HandleOSLevelShortcutRemapEvent, std::ref(mockedInputHandler), std::placeholders::_1, std::ref(testState));
+            mockedInputHandler.SetHookProc([currentHookProc](LowlevelKeyboardEvent* data) {
+                if (data->lParam->dwExtraInfo != KeyboardManagerConstants::KEYBOARDMANAGER_SUPPRESS_FLAG)
+                {
+                    return currentHookProc(data);
+                }
+                else
+                {
+                    return (intptr_t)1;
+                }
+            });
+        }
+
+        // Function to send a key event through the mocked hook and return the number of allocations it made
+        size_t SendKeyEvent(WORD keyCode, DWORD flags)
+        {
+            INPUT input[1] = {};
+            input[0].type = INPUT_KEYBOARD;
+            input[0].ki.wVk = keyCode;
+            input[0].ki.dwFlags = flags;
+            return CountAllocations([&] { mockedInputHandler.SendVirtualInput(1, input, sizeof(INPUT)); });
+        }
+
+    public:
+        TEST_METHOD_INITIALIZE(InitializeTestEnv)
+        {
+            // Reset test environment
+            TestHelpers::ResetTestEnv(mockedInputHandler, testState);
+        }
+
+        // Test if the counting allocator sees allocations, otherwise the other tests would pass trivially
+        TEST_METHOD (CountAllocations_ShouldCountHeapAllocations)
+        {
+            size_t allocations = CountAllocations([] {
+                auto value = std::make_unique<int>(1);
+                auto values = std::make_unique<int[]>(4);
+            });
+            Assert::AreEqual((size_t)2, allocations);
+        }
+
+        // Test if a single key remap to a key does not allocate
+        TEST_METHOD (RemappedKeyToKey_ShouldNotAllocate_OnKeyEvents)
+        {
+            SetSingleKeyRemapHook();
+
+            // Remap A to B
+            testState.AddSingleKeyRemap(0x41, (DWORD)0x42);
+
+            Assert::AreEqual((size_t)0, SendKeyEvent(0x41, 0));
+            Assert::AreEqual(true, mockedInputHandler.GetVirtualKeyState(0x42));
+            Assert::AreEqual((size_t)0, SendKeyEvent(0x41, KEYEVENTF_KEYUP));
+            Assert::AreEqual(false, mockedInputHandler.GetVirtualKeyState(0x42));
+        }
+
+        // Test if a single key remap to a shortcut does not allocate
+        TEST_METHOD (RemappedKeyToShortcut_ShouldNotAllocate_OnKeyEvents)
+        {
+            SetSingleKeyRemapHook();
+
+            // Remap A to Ctrl+Shift+V
+            Shortcut dest;
+            dest.SetKey(VK_CONTROL);
+            dest.SetKey(VK_SHIFT);
+            dest.SetKey(0x56);
+            testState.AddSingleKeyRemap(0x41, dest);
+
+            Assert::AreEqual((size_t)0, SendKeyEvent(0x41, 0));
+            Assert::AreEqual(true, mockedInputHandler.GetVirtualKeyState(VK_CONTROL));
+            Assert::AreEqual(true, mockedInputHandler.GetVirtualKeyState(VK_SHIFT));
+            Assert::AreEqual(true, mockedInputHandler.GetVirtualKeyState(0x56));
+            Assert::AreEqual((size_t)0, SendKeyEvent(0x41, KEYEVENTF_KEYUP));
+            Assert::AreEqual(false, mockedInputHandler.GetVirtualKeyState(VK_CONTROL));
+            Assert::AreEqual(false, mockedInputHandler.GetVirtualKeyState(VK_SHIFT));
+            Assert::AreEqual(false, mockedInputHandler.GetVirtualKeyState(0x56));
+        }
+
+        // Test if a shortcut remap to a shortcut does not allocate while it is pressed, repeated, interrupted by another key and released
+        TEST_METHOD (RemappedShortcutToShortcut_ShouldNotAllocate_OnKeyEvents)
+        {
+            SetOSLevelShortcutRemapHook();
+
+            // Remap Win+A to Ctrl+V
+            Shortcut src;
+            src.SetKey(VK_LWIN);
+            src.SetKey(0x41);
+            Shortcut dest;
+            dest.SetKey(VK_CONTROL);
+            dest.SetKey(0x56);
+            testState.AddOSLevelShortcut(src, dest);
+
+            Assert::AreEqual((size_t)0, SendKeyEvent(VK_LWIN, 0));
+            Assert::AreEqual((size_t)0, SendKeyEvent(0x41, 0));
+            Assert::AreEqual(true, mockedInputHandler.GetVirtualKeyState(VK_CONTROL));
+            Assert::AreEqual(true, mockedInputHandler.GetVirtualKeyState(0x56));
+
+            // Key repeat of the action key and release of the action key
+            Assert::AreEqual((size_t)0, SendKeyEvent(0x41, 0));
+            Assert::AreEqual((size_t)0, SendKeyEvent(0x41, KEYEVENTF_KEYUP));
+            Assert::AreEqual(false, mockedInputHandler.GetVirtualKeyState(0x56));
+
+            // Another key reverts the keyboard state to the physical keys
+            Assert::AreEqual((size_t)0, SendKeyEvent(0x41, 0));
+            Assert::AreEqual((size_t)0, SendKeyEvent(0x42, 0));
+            Assert::AreEqual(true, mockedInputHandler.GetVirtualKeyState(VK_LWIN));
+            Assert::AreEqual(false, mockedInputHandler.GetVirtualKeyState(VK_CONTROL));
+            Assert::AreEqual((size_t)0, SendKeyEvent(0x42, KEYEVENTF_KEYUP));
+            Assert::AreEqual((size_t)0, SendKeyEvent(0x41, KEYEVENTF_KEYUP));
+            Assert::AreEqual((size_t)0, SendKeyEvent(VK_LWIN, KEYEVENTF_KEYUP));
+        }
+
+        // Test if a shortcut remap to a key does not allocate when the modifier is released first
+        TEST_METHOD (RemappedShortcutToKey_ShouldNotAllocate_OnKeyEvents)
+        {
+            SetOSLevelShortcutRemapHook();
+
+            // Remap Ctrl+A to Caps Lock
+            Shortcut src;
+            src.SetKey(VK_CONTROL);
+            src.SetKey(0x41);
+            testState.AddOSLevelShortcut(src, (DWORD)VK_CAPITAL);
+
+            Assert::AreEqual((size_t)0, SendKeyEvent(VK_CONTROL, 0));
+            Assert::AreEqual((size_t)0, SendKeyEvent(0x41, 0));
+            Assert::AreEqual(true, mockedInputHandler.GetVirtualKeyState(VK_CAPITAL));
+            Assert::AreEqual(false, mockedInputHandler.GetVirtualKeyState(VK_CONTROL));
+            Assert::AreEqual((size_t)0, SendKeyEvent(VK_CONTROL, KEYEVENTF_KEYUP));
+            Assert::AreEqual(false, mockedInputHandler.GetVirtualKeyState(VK_CAPITAL));
+            Assert::AreEqual((size_t)0, SendKeyEvent(0x41, KEYEVENTF_KEYUP));
+        }
+
+        // Test if the key event list has space for a remap between two shortcuts using all the modifiers with no modifier in common
+        TEST_METHOD (KeyEventList_ShouldFitLargestShortcutRemap_OnKeyDown)
+        {
+            SetOSLevelShortcutRemapHook();
+
+            // Remap LWin+LCtrl+LAlt+LShift+A to RWin+RCtrl+RAlt+RShift+B
+            Shortcut src;
+            src.SetKey(VK_LWIN);
+            src.SetKey(VK_LCONTROL);
+            src.SetKey(VK_LMENU);
+            src.SetKey(VK_LSHIFT);
+            src.SetKey(0x41);
+            Shortcut dest;
+            dest.SetKey(VK_RWIN);
+            dest.SetKey(VK_RCONTROL);
+            dest.SetKey(VK_RMENU);
+            dest.SetKey(VK_RSHIFT);
+            dest.SetKey(0x42);
+            testState.AddOSLevelShortcut(src, dest);
+
+            // Count all the key events sent while the action key is pressed
+            Assert::AreEqual((size_t)0, SendKeyEvent(VK_LWIN, 0));
+            Assert::AreEqual((size_t)0, SendKeyEvent(VK_LCONTROL, 0));
+            Assert::AreEqual((size_t)0, SendKeyEvent(VK_LMENU, 0));
+            Assert::AreEqual((size_t)0, SendKeyEvent(VK_LSHIFT, 0));
+            mockedInputHandler.SetSendVirtualInputTestHandler([](LowlevelKeyboardEvent*) { return true; });
+            Assert::AreEqual((size_t)0, SendKeyEvent(0x41, 0));
+
+            // The pressed key, the dummy key events, four modifier key ups, four modifier key downs and the target action key
+            Assert::AreEqual(12, mockedInputHandler.GetSendVirtualInputCallCount());
+            Assert::AreEqual(true, mockedInputHandler.GetVirtualKeyState(VK_RWIN));
+            Assert::AreEqual(true, mockedInputHandler.GetVirtualKeyState(VK_RCONTROL));
+            Assert::AreEqual(true, mockedInputHandler.GetVirtualKeyState(VK_RMENU));
+            Assert::AreEqual(true, mockedInputHandler.GetVirtualKeyState(VK_RSHIFT));
+            Assert::AreEqual(true, mockedInputHandler.GetVirtualKeyState(0x42));
+            Assert::AreEqual(false, mockedInputHandler.GetVirtualKeyState(VK_LWIN));
+            Assert::AreEqual(false, mockedInputHandler.GetVirtualKeyState(VK_LCONTROL));
+            Assert::AreEqual(false, mockedInputHandler.GetVirtualKeyState(VK_LMENU));
+            Assert::AreEqual(false, mockedInputHandler.GetVirtualKeyState(VK_LSHIFT));
+        }
+    };
+}
@@ -0,0 +1,72 @@
+#pragma once
+#include <array>
+#include <cassert>
+
+#include "Helpers.h"
+#include "InputInterface.h"
+#include "KeyboardManagerConstants.h"
+
+namespace KeyboardManagerInput
+{
+    // Fixed size list of the key events sent in response to a key event. It is meant to live on the stack of the hook so that remapping a key doesn't allocate, and all the events are sent with a single SendVirtualInput call
+    class KeyEventList
+    {
+    private:
+        std::array<INPUT, KeyboardManagerConstants::MAX_KEY_EVENT_COUNT> keyEvents{};
+        int count = 0;
+
+        // Function to check if there is space for the given number of key events. The capacity covers the largest remap, so running out of space is a bug: debug builds assert, release builds drop the events instead of writing past the array
+        bool HasSpaceFor(size_t keyEventCount) const
+        {
+            const bool hasSpace = static_cast<size_t>(count) + keyEventCount <= keyEvents.size();
+            assert(hasSpace && "KeyEventList is full, KeyboardManagerConstants::MAX_KEY_EVENT_COUNT is too small for this remap");
+            return hasSpace;
+        }
+
+    public:
+        // Function to add a key event
+        void AddKeyEvent(WORD keyCode, DWORD flags, ULONG_PTR extraInfo)
+        {
+            if (HasSpaceFor(1))
+            {
+                Helpers::SetKeyEvent(keyEvents.data(), count, INPUT_KEYBOARD, keyCode, flags, extraInfo);
+                count++;
+            }
+        }
+
+        // Function to add the dummy key events used for remapping shortcuts
+        void AddDummyKeyEvent(ULONG_PTR extraInfo)
+        {
+            if (HasSpaceFor(KeyboardManagerConstants::DUMMY_KEY_EVENT_SIZE))
+            {
+                Helpers::SetDummyKeyEvent(keyEvents.data(), count, extraInfo);
+            }
+        }
+
+        // Function to add key events for the modifier keys of a shortcut, see Helpers::SetModifierKeyEvents
+        void AddModifierKeyEvents(const Shortcut& shortcutToBeSent, const ModifierKey& winKeyInvoked, bool isKeyDown, ULONG_PTR extraInfoFlag, const Shortcut& shortcutToCompare = Shortcut(), const DWORD& keyToBeReleased = NULL)
+        {
+            if (HasSpaceFor(KeyboardManagerConstants::MAX_SHORTCUT_KEY_COUNT - 1))
+            {
+                Helpers::SetModifierKeyEvents(shortcutToBeSent, winKeyInvoked, keyEvents.data(), count, isKeyDown, extraInfoFlag, shortcutToCompare, keyToBeReleased);
+            }
+        }
+
+        // Function to return the number of key events added so far
+        int Size() const
+        {
+            return count;
+        }
+
+        // Function to send all the key events at once. Nothing is sent if the list is empty
+        UINT Send(InputInterface& ii)
+        {
+            if (count == 0)
+            {
+                return 0;
+            }
+
+            return ii.SendVirtualInput((UINT)count, keyEvents.data(), sizeof(INPUT));
+        }
+    };
+}
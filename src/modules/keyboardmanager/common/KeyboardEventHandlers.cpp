@@ -1,7 +1,7 @@
 #include "pch.h"
 #include "KeyboardEventHandlers.h"
 #include <keyboardmanager/common/InputInterface.h>
-#include <keyboardmanager/common/Helpers.h>
+#include <keyboardmanager/common/KeyEventList.h>
 #include <keyboardmanager/common/KeyboardManagerConstants.h>
 
 namespace KeyboardEventHandlers
@@ -11,14 +11,11 @@ namespace KeyboardEventHandlers
     {
         // Num Lock's key state is applied before it is intercepted by low level keyboard hooks, so we have to manually set back the state when we suppress the key. This is done by sending an additional key up, key down set of messages.
         // We need 2 key events because after Num Lock is suppressed, key up to release num lock key and key down to revert the num lock state
-        int key_count = 2;
-        LPINPUT keyEventList = new INPUT[size_t(key_count)]();
-        memset(keyEventList, 0, sizeof(keyEventList));
+        KeyboardManagerInput::KeyEventList keyEventList;
 
         // Use the suppress flag to ensure these are not intercepted by any remapped keys or shortcuts
-        Helpers::SetKeyEvent(keyEventList, 0, INPUT_KEYBOARD, VK_NUMLOCK, KEYEVENTF_KEYUP, KeyboardManagerConstants::KEYBOARDMANAGER_SUPPRESS_FLAG);
-        Helpers::SetKeyEvent(keyEventList, 1, INPUT_KEYBOARD, VK_NUMLOCK, 0, KeyboardManagerConstants::KEYBOARDMANAGER_SUPPRESS_FLAG);
-        UINT res = ii.SendVirtualInput((UINT)key_count, keyEventList, sizeof(INPUT));
-        delete[] keyEventList;
+        keyEventList.AddKeyEvent(VK_NUMLOCK, KEYEVENTF_KEYUP, KeyboardManagerConstants::KEYBOARDMANAGER_SUPPRESS_FLAG);
+        keyEventList.AddKeyEvent(VK_NUMLOCK, 0, KeyboardManagerConstants::KEYBOARDMANAGER_SUPPRESS_FLAG);
+        keyEventList.Send(ii);
     }
 }
@@ -56,6 +56,12 @@ namespace KeyboardManagerConstants
     // Number of key messages required while sending a dummy key event
     inline const size_t DUMMY_KEY_EVENT_SIZE = 2;
 
+    // Maximum number of keys in a shortcut, one per modifier and the action key
+    inline const size_t MAX_SHORTCUT_KEY_COUNT = 5;
+
+    // Maximum number of key messages sent while handling a single key event: releasing a shortcut, pressing another one, a dummy key event and the action keys
+    inline const size_t MAX_KEY_EVENT_COUNT = 2 * MAX_SHORTCUT_KEY_COUNT + DUMMY_KEY_EVENT_SIZE + 2;
+
     // String constant to represent no activated application in app-specific shortcuts
     inline const std::wstring NoActivatedApp = L"";
 }
\ No newline at end of file
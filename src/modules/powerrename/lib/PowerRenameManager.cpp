@@ -6,6 +6,7 @@
 #include <cstring>
 #include "helpers.h"
 #include <filesystem>
+#include <unordered_set>
 #include "trace.h"
 #include <winrt/base.h>
 
@@ -16,6 +17,9 @@ extern HINSTANCE g_hInst;
 // The default FOF flags to use in the rename operations
 #define FOF_DEFAULTFLAGS (FOF_ALLOWUNDO | FOFX_ADDUNDORECORD | FOFX_SHOWELEVATIONPROMPT | FOF_RENAMEONCOLLISION)
 
+// How long the search/replace input has to be idle before the preview is recomputed
+#define REGEX_PREVIEW_DEBOUNCE_MS 50
+
 IFACEMETHODIMP_(ULONG)
 CPowerRenameManager::AddRef()
 {
@@ -397,6 +401,14 @@ IFACEMETHODIMP CPowerRenameManager::PutRenameItemFactory(_In_ IPowerRenameItemFa
     return S_OK;
 }
 
+IFACEMETHODIMP CPowerRenameManager::PutPreviewPriorityRange(_In_ UINT firstVisibleIndex, _In_ UINT visibleCount)
+{
+    CSRWExclusiveAutoLock lock(&m_lockItems);
+    m_priorityFirstVisible = firstVisibleIndex;
+    m_priorityVisibleCount = visibleCount;
+    return S_OK;
+}
+
 IFACEMETHODIMP CPowerRenameManager::OnSearchTermChanged(_In_ PCWSTR /*searchTerm*/)
 {
     _PerformRegExRename();
@@ -419,7 +431,12 @@ IFACEMETHODIMP CPowerRenameManager::OnFlagsChanged(_In_ DWORD flags)
 
 IFACEMETHODIMP CPowerRenameManager::OnFileTimeChanged(_In_ SYSTEMTIME /*fileTime*/)
 {
-    _PerformRegExRename();
+    // The preview worker itself sets the file time of each item it processes, that must not
+    // restart the pass it is running.
+    if (GetCurrentThreadId() != m_regExWorkerThreadId)
+    {
+        _PerformRegExRename();
+    }
     return S_OK;
 }
 
@@ -443,24 +460,27 @@ HRESULT CPowerRenameManager::s_CreateInstance(_Outptr_ IPowerRenameManager** pps
 CPowerRenameManager::CPowerRenameManager() :
     m_refCount(1)
 {
-    InitializeCriticalSection(&m_critsecReentrancy);
 }
 
 CPowerRenameManager::~CPowerRenameManager()
 {
-    DeleteCriticalSection(&m_critsecReentrancy);
+    // The preview worker does not hold a reference, make sure it is gone if Shutdown was never called
+    _StopRegExWorkerThread();
 }
 
 HRESULT CPowerRenameManager::_Init()
 {
     // Guaranteed to succeed
     m_startFileOpWorkerEvent = CreateEvent(nullptr, TRUE, FALSE, nullptr);
-    m_startRegExWorkerEvent = CreateEvent(nullptr, TRUE, FALSE, nullptr);
-    m_cancelRegExWorkerEvent = CreateEvent(nullptr, TRUE, FALSE, nullptr);
+    m_regExWorkRequestedEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+    m_regExFlushEvent = CreateEvent(nullptr, TRUE, FALSE, nullptr);
+    m_regExPassCompletedEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+    m_exitRegExWorkerEvent = CreateEvent(nullptr, TRUE, FALSE, nullptr);
 
     m_hwndMessage = CreateMsgWindow(g_hInst, s_msgWndProc, this);
 
-    return S_OK;
+    // One preview worker for the lifetime of the manager instead of a thread per keystroke
+    return _CreateRegExWorkerThread();
 }
 
 // Custom messages for worker threads
@@ -480,6 +500,7 @@ struct WorkerThreadData
     HANDLE cancelEvent = nullptr;
     HWND hwndParent = nullptr;
     CComPtr<IPowerRenameManager> spsrm;
+    CPowerRenameManager* pManager = nullptr;
 };
 
 // Msg-only worker window proc for communication from our worker threads
@@ -597,6 +618,9 @@ void CPowerRenameManager::_LogOperationTelemetry()
 
 HRESULT CPowerRenameManager::_PerformFileOperation()
 {
+    // Make sure pending (possibly still debounced) input is reflected in the new names
+    _WaitForRegExPreview();
+
     // Do we have items to rename?
     UINT renameItemCount = 0;
     if (FAILED(GetRenameItemCount(&renameItemCount)) || renameItemCount == 0)
@@ -606,9 +630,6 @@ HRESULT CPowerRenameManager::_PerformFileOperation()
 
     _LogOperationTelemetry();
 
-    // Wait for existing regex thread to finish
-    _WaitForRegExWorkerThread();
-
     // Create worker thread which will perform the actual rename
     HRESULT hr = _CreateFileOpWorkerThread();
     if (SUCCEEDED(hr))
@@ -656,7 +677,7 @@ HRESULT CPowerRenameManager::_CreateFileOpWorkerThread()
     if (pwtd)
     {
         pwtd->hwndManager = m_hwndMessage;
-        pwtd->startEvent = m_startRegExWorkerEvent;
+        pwtd->startEvent = m_startFileOpWorkerEvent;
         pwtd->cancelEvent = nullptr;
         pwtd->spsrm = this;
         m_fileOpWorkerThreadHandle = CreateThread(nullptr, 0, s_fileOpWorkerThread, pwtd, 0, nullptr);
@@ -772,31 +793,17 @@ DWORD WINAPI CPowerRenameManager::s_fileOpWorkerThread(_In_ void* pv)
 
 HRESULT CPowerRenameManager::_PerformRegExRename()
 {
-    HRESULT hr = E_FAIL;
-
-    if (!TryEnterCriticalSection(&m_critsecReentrancy))
+    if (!m_regExWorkerThreadHandle)
     {
-        // Ensure we do not re-enter since we pump messages here.
-        // TODO: If we do, post a message back to ourselves
+        return E_FAIL;
     }
-    else
-    {
-        // Ensure previous thread is canceled
-        _CancelRegExWorkerThread();
 
-        // Create worker thread which will message us progress and completion.
-        hr = _CreateRegExWorkerThread();
-        if (SUCCEEDED(hr))
-        {
-            ResetEvent(m_cancelRegExWorkerEvent);
-
-            // Signal the worker thread that they can start working. We needed to wait until we
-            // were ready to process thread messages.
-            SetEvent(m_startRegExWorkerEvent);
-        }
-    }
+    // Newer input supersedes whatever the worker is doing.  The worker notices the generation
+    // change between items, drops the current pass and starts over once typing settles.
+    InterlockedIncrement(&m_regExGeneration);
+    SetEvent(m_regExWorkRequestedEvent);
 
-    return hr;
+    return S_OK;
 }
 
 HRESULT CPowerRenameManager::_CreateRegExWorkerThread()
@@ -806,11 +813,11 @@ HRESULT CPowerRenameManager::_CreateRegExWorkerThread()
     if (pwtd)
     {
         pwtd->hwndManager = m_hwndMessage;
-        pwtd->startEvent = m_startRegExWorkerEvent;
-        pwtd->cancelEvent = m_cancelRegExWorkerEvent;
         pwtd->hwndParent = m_hwndParent;
-        pwtd->spsrm = this;
-        m_regExWorkerThreadHandle = CreateThread(nullptr, 0, s_regexWorkerThread, pwtd, 0, nullptr);
+        // The worker lives as long as the manager, so it must not keep it alive.  It is always
+        // stopped in _Cleanup or in the destructor before the manager goes away.
+        pwtd->pManager = this;
+        m_regExWorkerThreadHandle = CreateThread(nullptr, 0, s_regexWorkerThread, pwtd, 0, &m_regExWorkerThreadId);
         hr = E_FAIL;
         if (m_regExWorkerThreadHandle)
         {
@@ -827,238 +834,317 @@ HRESULT CPowerRenameManager::_CreateRegExWorkerThread()
 
 DWORD WINAPI CPowerRenameManager::s_regexWorkerThread(_In_ void* pv)
 {
-    try
+    WorkerThreadData* pwtd = reinterpret_cast<WorkerThreadData*>(pv);
+    if (pwtd && SUCCEEDED(CoInitializeEx(nullptr, COINIT_APARTMENTTHREADED | COINIT_DISABLE_OLE1DDE)))
     {
-        winrt::check_hresult(CoInitializeEx(nullptr, COINIT_APARTMENTTHREADED | COINIT_DISABLE_OLE1DDE));
-        WorkerThreadData* pwtd = reinterpret_cast<WorkerThreadData*>(pv);
-        if (pwtd)
+        CPowerRenameManager* pManager = pwtd->pManager;
+        HANDLE requestEvents[] = { pManager->m_exitRegExWorkerEvent, pManager->m_regExWorkRequestedEvent };
+        HANDLE debounceEvents[] = { pManager->m_exitRegExWorkerEvent, pManager->m_regExFlushEvent, pManager->m_regExWorkRequestedEvent };
+
+        while (WaitForMultipleObjects(ARRAYSIZE(requestEvents), requestEvents, FALSE, INFINITE) == WAIT_OBJECT_0 + 1)
         {
+            // Debounce: keep absorbing requests until the input has been quiet for a while, unless
+            // someone is waiting on the result.
+            while (WaitForMultipleObjects(ARRAYSIZE(debounceEvents), debounceEvents, FALSE, REGEX_PREVIEW_DEBOUNCE_MS) == WAIT_OBJECT_0 + 2)
+            {
+            }
+
+            if (WaitForSingleObject(pManager->m_exitRegExWorkerEvent, 0) == WAIT_OBJECT_0)
+            {
+                break;
+            }
+
+            LONG generation = InterlockedCompareExchange(&pManager->m_regExGeneration, 0, 0);
             PostMessage(pwtd->hwndManager, SRM_REGEX_STARTED, GetCurrentThreadId(), 0);
 
-            // Wait to be told we can begin
-            if (WaitForSingleObject(pwtd->startEvent, INFINITE) == WAIT_OBJECT_0)
+            bool completed = true;
+            try
             {
-                CComPtr<IPowerRenameRegEx> spRenameRegEx;
+                completed = pManager->_RunRegExPreviewPass(generation);
+            }
+            catch (...)
+            {
+                // TODO: an exception can happen while typing the expression and the syntax is not correct yet,
+                // we need to be more granular and raise an exception only when a real problem happened.
+                // Either way the worker keeps running and the next input starts a new pass.
+            }
 
-                winrt::check_hresult(pwtd->spsrm->GetRenameRegEx(&spRenameRegEx));
+            if (completed)
+            {
+                InterlockedExchange(&pManager->m_regExCompletedGeneration, generation);
+                PostMessage(pwtd->hwndManager, SRM_REGEX_COMPLETE, GetCurrentThreadId(), 0);
+            }
+            else
+            {
+                // A newer request is pending, its event is still signaled so we loop right back
+                PostMessage(pwtd->hwndManager, SRM_REGEX_CANCELED, GetCurrentThreadId(), 0);
+            }
+            SetEvent(pManager->m_regExPassCompletedEvent);
+        }
 
-                DWORD flags = 0;
-                winrt::check_hresult(spRenameRegEx->GetFlags(&flags));
+        CoUninitialize();
+    }
 
-                PWSTR replaceTerm = nullptr;
-                bool useFileTime = false;
+    delete pwtd;
+    return 0;
+}
 
-                winrt::check_hresult(spRenameRegEx->GetReplaceTerm(&replaceTerm));
+bool CPowerRenameManager::_IsRegExPassStale(_In_ LONG generation)
+{
+    return InterlockedCompareExchange(&m_regExGeneration, 0, 0) != generation ||
+           WaitForSingleObject(m_exitRegExWorkerEvent, 0) == WAIT_OBJECT_0;
+}
 
-                if (isFileTimeUsed(replaceTerm))
-                {
-                    useFileTime = true;
-                }
+// Recomputes the new name of every item.  Rows currently shown by the UI go first so the
+// preview the user is looking at updates before the rest of the list.  Returns false if the
+// pass was abandoned because a newer request arrived.
+bool CPowerRenameManager::_RunRegExPreviewPass(_In_ LONG generation)
+{
+    CComPtr<IPowerRenameRegEx> spRenameRegEx;
+    winrt::check_hresult(GetRenameRegEx(&spRenameRegEx));
 
-                UINT itemCount = 0;
-                unsigned long itemEnumIndex = 1;
-                winrt::check_hresult(pwtd->spsrm->GetItemCount(&itemCount));
-                for (UINT u = 0; u < itemCount; u++)
-                {
-                    // Check if cancel event is signaled
-                    if (WaitForSingleObject(pwtd->cancelEvent, 0) == WAIT_OBJECT_0)
-                    {
-                        // Canceled from manager
-                        // Send the manager thread the canceled message
-                        PostMessage(pwtd->hwndManager, SRM_REGEX_CANCELED, GetCurrentThreadId(), 0);
-                        break;
-                    }
+    DWORD flags = 0;
+    winrt::check_hresult(spRenameRegEx->GetFlags(&flags));
 
-                    CComPtr<IPowerRenameItem> spItem;
-                    winrt::check_hresult(pwtd->spsrm->GetItemByIndex(u, &spItem));
+    PWSTR replaceTerm = nullptr;
+    winrt::check_hresult(spRenameRegEx->GetReplaceTerm(&replaceTerm));
+    bool useFileTime = isFileTimeUsed(replaceTerm);
+    CoTaskMemFree(replaceTerm);
 
-                    int id = -1;
-                    winrt::check_hresult(spItem->GetId(&id));
+    unsigned long itemEnumIndex = 1;
+    std::unordered_set<int> processedIds;
 
-                    bool isFolder = false;
-                    bool isSubFolderContent = false;
-                    winrt::check_hresult(spItem->GetIsFolder(&isFolder));
-                    winrt::check_hresult(spItem->GetIsSubFolderContent(&isSubFolderContent));
-                    if ((isFolder && (flags & PowerRenameFlags::ExcludeFolders)) ||
-                        (!isFolder && (flags & PowerRenameFlags::ExcludeFiles)) ||
-                        (isSubFolderContent && (flags & PowerRenameFlags::ExcludeSubfolders)))
-                    {
-                        // Exclude this item from renaming.  Ensure new name is cleared.
-                        winrt::check_hresult(spItem->PutNewName(nullptr));
+    // Enumeration numbers depend on the item order, so only reorder when they are not in use
+    if (!(flags & EnumerateItems))
+    {
+        UINT firstVisible = 0;
+        UINT visibleCount = 0;
+        {
+            CSRWSharedAutoLock lock(&m_lockItems);
+            firstVisible = m_priorityFirstVisible;
+            visibleCount = m_priorityVisibleCount;
+        }
 
-                        // Send the manager thread the item processed message
-                        PostMessage(pwtd->hwndManager, SRM_REGEX_ITEM_UPDATED, GetCurrentThreadId(), id);
+        for (UINT u = firstVisible; u < firstVisible + visibleCount; u++)
+        {
+            if (_IsRegExPassStale(generation))
+            {
+                return false;
+            }
 
-                        continue;
-                    }
+            CComPtr<IPowerRenameItem> spItem;
+            if (FAILED(GetVisibleItemByIndex(u, &spItem)))
+            {
+                break;
+            }
 
-                    PWSTR originalName = nullptr;
-                    winrt::check_hresult(spItem->GetOriginalName(&originalName));
+            int id = -1;
+            winrt::check_hresult(spItem->GetId(&id));
+            winrt::check_hresult(_UpdateItemPreview(spRenameRegEx, spItem, flags, useFileTime, &itemEnumIndex));
+            processedIds.insert(id);
+        }
+    }
 
+    UINT itemCount = 0;
+    winrt::check_hresult(GetItemCount(&itemCount));
+    for (UINT u = 0; u < itemCount; u++)
+    {
+        if (_IsRegExPassStale(generation))
+        {
+            return false;
+        }
 
-                    PWSTR currentNewName = nullptr;
-                    winrt::check_hresult(spItem->GetNewName(&currentNewName));
+        CComPtr<IPowerRenameItem> spItem;
+        winrt::check_hresult(GetItemByIndex(u, &spItem));
 
-                    wchar_t sourceName[MAX_PATH] = { 0 };
-                    if (flags & NameOnly)
-                    {
-                        StringCchCopy(sourceName, ARRAYSIZE(sourceName), fs::path(originalName).stem().c_str());
-                    }
-                    else if (flags & ExtensionOnly)
-                    {
-                        std::wstring extension = fs::path(originalName).extension().wstring();
-                        if (!extension.empty() && extension.front() == '.')
-                        {
-                            extension = extension.erase(0, 1);
-                        }
-                        StringCchCopy(sourceName, ARRAYSIZE(sourceName), extension.c_str());
-                    }
-                    else
-                    {
-                        StringCchCopy(sourceName, ARRAYSIZE(sourceName), originalName);
-                    }
+        int id = -1;
+        winrt::check_hresult(spItem->GetId(&id));
+        if (processedIds.find(id) == processedIds.end())
+        {
+            winrt::check_hresult(_UpdateItemPreview(spRenameRegEx, spItem, flags, useFileTime, &itemEnumIndex));
+        }
+    }
 
-                    SYSTEMTIME fileTime = { 0 };
+    return true;
+}
 
-                    if (useFileTime)
-                    {
-                        winrt::check_hresult(spItem->GetTime(&fileTime));
-                        winrt::check_hresult(spRenameRegEx->PutFileTime(fileTime));
-                    }
+HRESULT CPowerRenameManager::_UpdateItemPreview(_In_ IPowerRenameRegEx* pRenameRegEx, _In_ IPowerRenameItem* pItem, _In_ DWORD flags, _In_ bool useFileTime, _Inout_ unsigned long* itemEnumIndex)
+{
+    int id = -1;
+    winrt::check_hresult(pItem->GetId(&id));
+
+    bool isFolder = false;
+    bool isSubFolderContent = false;
+    winrt::check_hresult(pItem->GetIsFolder(&isFolder));
+    winrt::check_hresult(pItem->GetIsSubFolderContent(&isSubFolderContent));
+    if ((isFolder && (flags & PowerRenameFlags::ExcludeFolders)) ||
+        (!isFolder && (flags & PowerRenameFlags::ExcludeFiles)) ||
+        (isSubFolderContent && (flags & PowerRenameFlags::ExcludeSubfolders)))
+    {
+        // Exclude this item from renaming.  Ensure new name is cleared.
+        winrt::check_hresult(pItem->PutNewName(nullptr));
 
-                    PWSTR newName = nullptr;
+        // Send the manager thread the item processed message
+        PostMessage(m_hwndMessage, SRM_REGEX_ITEM_UPDATED, GetCurrentThreadId(), id);
 
-                    // Failure here means we didn't match anything or had nothing to match
-                    // Call put_newName with null in that case to reset it
-                    winrt::check_hresult(spRenameRegEx->Replace(sourceName, &newName));
+        return S_OK;
+    }
 
-                    if (useFileTime)
-                    {
-                        winrt::check_hresult(spRenameRegEx->ResetFileTime());
-                    }
+    PWSTR originalName = nullptr;
+    winrt::check_hresult(pItem->GetOriginalName(&originalName));
 
-                    wchar_t resultName[MAX_PATH] = { 0 };
+    PWSTR currentNewName = nullptr;
+    winrt::check_hresult(pItem->GetNewName(&currentNewName));
 
-                    PWSTR newNameToUse = nullptr;
+    wchar_t sourceName[MAX_PATH] = { 0 };
+    if (flags & NameOnly)
+    {
+        StringCchCopy(sourceName, ARRAYSIZE(sourceName), fs::path(originalName).stem().c_str());
+    }
+    else if (flags & ExtensionOnly)
+    {
+        std::wstring extension = fs::path(originalName).extension().wstring();
+        if (!extension.empty() && extension.front() == '.')
+        {
+            extension = extension.erase(0, 1);
+        }
+        StringCchCopy(sourceName, ARRAYSIZE(sourceName), extension.c_str());
+    }
+    else
+    {
+        StringCchCopy(sourceName, ARRAYSIZE(sourceName), originalName);
+    }
 
-                    // newName == nullptr likely means we have an empty search string.  We should leave newNameToUse
-                    // as nullptr so we clear the renamed column
-                    // Except string transformation is selected.
+    SYSTEMTIME fileTime = { 0 };
 
-                    if (newName == nullptr && (flags & Uppercase || flags & Lowercase || flags & Titlecase || flags & Capitalized))
-                    {
-                        SHStrDup(sourceName, &newName);
-                    }
+    if (useFileTime)
+    {
+        winrt::check_hresult(pItem->GetTime(&fileTime));
+        winrt::check_hresult(pRenameRegEx->PutFileTime(fileTime));
+    }
 
-                    if (newName != nullptr)
-                    {
-                        newNameToUse = resultName;
-                        if (flags & NameOnly)
-                        {
-                            StringCchPrintf(resultName, ARRAYSIZE(resultName), L"%s%s", newName, fs::path(originalName).extension().c_str());
-                        }
-                        else if (flags & ExtensionOnly)
-                        {
-                            std::wstring extension = fs::path(originalName).extension().wstring();
-                            if (!extension.empty())
-                            {
-                                StringCchPrintf(resultName, ARRAYSIZE(resultName), L"%s.%s", fs::path(originalName).stem().c_str(), newName);
-                            }
-                            else
-                            {
-                                StringCchCopy(resultName, ARRAYSIZE(resultName), originalName);
-                            }
-                        }
-                        else
-                        {
-                            StringCchCopy(resultName, ARRAYSIZE(resultName), newName);
-                        }
-                    }
+    PWSTR newName = nullptr;
 
-                    wchar_t trimmedName[MAX_PATH] = { 0 };
-                    if (newNameToUse != nullptr)
-                    {
-                        winrt::check_hresult(GetTrimmedFileName(trimmedName, ARRAYSIZE(trimmedName), newNameToUse));
-                        newNameToUse = trimmedName;
-                    }
+    // Failure here means we didn't match anything or had nothing to match
+    // Call put_newName with null in that case to reset it
+    winrt::check_hresult(pRenameRegEx->Replace(sourceName, &newName));
 
-                    wchar_t transformedName[MAX_PATH] = { 0 };
-                    if (newNameToUse != nullptr && (flags & Uppercase || flags & Lowercase || flags & Titlecase || flags & Capitalized))
-                    {
-                        winrt::check_hresult(GetTransformedFileName(transformedName, ARRAYSIZE(transformedName), newNameToUse, flags));
-                        newNameToUse = transformedName;
-                    }
+    if (useFileTime)
+    {
+        winrt::check_hresult(pRenameRegEx->ResetFileTime());
+    }
 
-                    // No change from originalName so set newName to
-                    // null so we clear it from our UI as well.
-                    if (lstrcmp(originalName, newNameToUse) == 0)
-                    {
-                        newNameToUse = nullptr;
-                    }
+    wchar_t resultName[MAX_PATH] = { 0 };
 
-                    wchar_t uniqueName[MAX_PATH] = { 0 };
-                    if (newNameToUse != nullptr && (flags & EnumerateItems))
-                    {
-                        unsigned long countUsed = 0;
-                        if (GetEnumeratedFileName(uniqueName, ARRAYSIZE(uniqueName), newNameToUse, nullptr, itemEnumIndex, &countUsed))
-                        {
-                            newNameToUse = uniqueName;
-                        }
-                        itemEnumIndex++;
-                    }
+    PWSTR newNameToUse = nullptr;
 
-                    winrt::check_hresult(spItem->PutNewName(newNameToUse));
+    // newName == nullptr likely means we have an empty search string.  We should leave newNameToUse
+    // as nullptr so we clear the renamed column
+    // Except string transformation is selected.
 
-                    // Was there a change?
-                    if (lstrcmp(currentNewName, newNameToUse) != 0)
-                    {
-                        // Send the manager thread the item processed message
-                        PostMessage(pwtd->hwndManager, SRM_REGEX_ITEM_UPDATED, GetCurrentThreadId(), id);
-                    }
-                    CoTaskMemFree(newName);
-                    CoTaskMemFree(currentNewName);
-                    CoTaskMemFree(originalName);
-                }
-                CoTaskMemFree(replaceTerm);
+    if (newName == nullptr && (flags & Uppercase || flags & Lowercase || flags & Titlecase || flags & Capitalized))
+    {
+        SHStrDup(sourceName, &newName);
+    }
+
+    if (newName != nullptr)
+    {
+        newNameToUse = resultName;
+        if (flags & NameOnly)
+        {
+            StringCchPrintf(resultName, ARRAYSIZE(resultName), L"%s%s", newName, fs::path(originalName).extension().c_str());
+        }
+        else if (flags & ExtensionOnly)
+        {
+            std::wstring extension = fs::path(originalName).extension().wstring();
+            if (!extension.empty())
+            {
+                StringCchPrintf(resultName, ARRAYSIZE(resultName), L"%s.%s", fs::path(originalName).stem().c_str(), newName);
+            }
+            else
+            {
+                StringCchCopy(resultName, ARRAYSIZE(resultName), originalName);
             }
+        }
+        else
+        {
+            StringCchCopy(resultName, ARRAYSIZE(resultName), newName);
+        }
+    }
 
-            // Send the manager thread the completion message
-            PostMessage(pwtd->hwndManager, SRM_REGEX_COMPLETE, GetCurrentThreadId(), 0);
+    wchar_t trimmedName[MAX_PATH] = { 0 };
+    if (newNameToUse != nullptr)
+    {
+        winrt::check_hresult(GetTrimmedFileName(trimmedName, ARRAYSIZE(trimmedName), newNameToUse));
+        newNameToUse = trimmedName;
+    }
 
-            delete pwtd;
-            
+    wchar_t transformedName[MAX_PATH] = { 0 };
+    if (newNameToUse != nullptr && (flags & Uppercase || flags & Lowercase || flags & Titlecase || flags & Capitalized))
+    {
+        winrt::check_hresult(GetTransformedFileName(transformedName, ARRAYSIZE(transformedName), newNameToUse, flags));
+        newNameToUse = transformedName;
+    }
+
+    // No change from originalName so set newName to
+    // null so we clear it from our UI as well.
+    if (lstrcmp(originalName, newNameToUse) == 0)
+    {
+        newNameToUse = nullptr;
+    }
+
+    wchar_t uniqueName[MAX_PATH] = { 0 };
+    if (newNameToUse != nullptr && (flags & EnumerateItems))
+    {
+        unsigned long countUsed = 0;
+        if (GetEnumeratedFileName(uniqueName, ARRAYSIZE(uniqueName), newNameToUse, nullptr, *itemEnumIndex, &countUsed))
+        {
+            newNameToUse = uniqueName;
         }
-        CoUninitialize();
+        (*itemEnumIndex)++;
     }
-    catch (...)
+
+    winrt::check_hresult(pItem->PutNewName(newNameToUse));
+
+    // Was there a change?
+    if (lstrcmp(currentNewName, newNameToUse) != 0)
     {
-        // TODO: an exception can happen while typing the expression and the syntax is not correct yet,
-        // we need to be more granular and raise an exception only when a real problem happened.
-        // MessageBox(NULL, L"RegexWorkerThread failed to execute.\nPlease report the bug to https://aka.ms/powerToysReportBug", L"PowerRename Error", MB_OK);
+        // Send the manager thread the item processed message
+        PostMessage(m_hwndMessage, SRM_REGEX_ITEM_UPDATED, GetCurrentThreadId(), id);
     }
+    CoTaskMemFree(newName);
+    CoTaskMemFree(currentNewName);
+    CoTaskMemFree(originalName);
 
-    return 0;
+    return S_OK;
 }
 
-void CPowerRenameManager::_CancelRegExWorkerThread()
+// Blocks until the preview reflects the latest search/replace input, skipping the debounce delay
+void CPowerRenameManager::_WaitForRegExPreview()
 {
-    if (m_startRegExWorkerEvent)
+    if (!m_regExWorkerThreadHandle)
     {
-        SetEvent(m_startRegExWorkerEvent);
+        return;
     }
 
-    if (m_cancelRegExWorkerEvent)
+    SetEvent(m_regExFlushEvent);
+    HANDLE waitEvents[] = { m_regExPassCompletedEvent, m_regExWorkerThreadHandle };
+    while (InterlockedCompareExchange(&m_regExCompletedGeneration, 0, 0) != InterlockedCompareExchange(&m_regExGeneration, 0, 0))
     {
-        SetEvent(m_cancelRegExWorkerEvent);
+        // Stop waiting if the worker exited for any reason
+        if (WaitForMultipleObjects(ARRAYSIZE(waitEvents), waitEvents, FALSE, INFINITE) != WAIT_OBJECT_0)
+        {
+            break;
+        }
     }
-
-    _WaitForRegExWorkerThread();
+    ResetEvent(m_regExFlushEvent);
 }
 
-void CPowerRenameManager::_WaitForRegExWorkerThread()
+void CPowerRenameManager::_StopRegExWorkerThread()
 {
     if (m_regExWorkerThreadHandle)
     {
+        SetEvent(m_exitRegExWorkerEvent);
         WaitForSingleObject(m_regExWorkerThreadHandle, INFINITE);
         CloseHandle(m_regExWorkerThreadHandle);
         m_regExWorkerThreadHandle = nullptr;
@@ -1068,7 +1154,7 @@ void CPowerRenameManager::_WaitForRegExWorkerThread()
 void CPowerRenameManager::_Cancel()
 {
     SetEvent(m_startFileOpWorkerEvent);
-    _CancelRegExWorkerThread();
+    _StopRegExWorkerThread();
 }
 
 HRESULT CPowerRenameManager::_EnsureRegEx()
@@ -1262,11 +1348,19 @@ void CPowerRenameManager::_Cleanup()
     CloseHandle(m_startFileOpWorkerEvent);
     m_startFileOpWorkerEvent = nullptr;
 
-    CloseHandle(m_startRegExWorkerEvent);
-    m_startRegExWorkerEvent = nullptr;
+    _StopRegExWorkerThread();
+
+    CloseHandle(m_regExWorkRequestedEvent);
+    m_regExWorkRequestedEvent = nullptr;
+
+    CloseHandle(m_regExFlushEvent);
+    m_regExFlushEvent = nullptr;
+
+    CloseHandle(m_regExPassCompletedEvent);
+    m_regExPassCompletedEvent = nullptr;
 
-    CloseHandle(m_cancelRegExWorkerEvent);
-    m_cancelRegExWorkerEvent = nullptr;
+    CloseHandle(m_exitRegExWorkerEvent);
+    m_exitRegExWorkerEvent = nullptr;
 
     _ClearRegEx();
     _ClearEventHandlers();
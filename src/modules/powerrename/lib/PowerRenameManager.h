@@ -41,6 +41,7 @@ public:
     IFACEMETHODIMP PutRenameRegEx(_In_ IPowerRenameRegEx* pRegEx);
     IFACEMETHODIMP GetRenameItemFactory(_COM_Outptr_ IPowerRenameItemFactory** ppItemFactory);
     IFACEMETHODIMP PutRenameItemFactory(_In_ IPowerRenameItemFactory* pItemFactory);
+    IFACEMETHODIMP PutPreviewPriorityRange(_In_ UINT firstVisibleIndex, _In_ UINT visibleCount);
 
     // IPowerRenameRegExEvents
     IFACEMETHODIMP OnSearchTermChanged(_In_ PCWSTR searchTerm);
@@ -75,15 +76,18 @@ protected:
     HRESULT _PerformFileOperation();
 
     HRESULT _CreateRegExWorkerThread();
-    void _CancelRegExWorkerThread();
-    void _WaitForRegExWorkerThread();
+    void _StopRegExWorkerThread();
+    void _WaitForRegExPreview();
+    bool _IsRegExPassStale(_In_ LONG generation);
+    bool _RunRegExPreviewPass(_In_ LONG generation);
+    HRESULT _UpdateItemPreview(_In_ IPowerRenameRegEx* pRenameRegEx, _In_ IPowerRenameItem* pItem, _In_ DWORD flags, _In_ bool useFileTime, _Inout_ unsigned long* itemEnumIndex);
     HRESULT _CreateFileOpWorkerThread();
 
     HRESULT _EnsureRegEx();
     HRESULT _InitRegEx();
     void _ClearRegEx();
 
-    // Thread proc for performing the regex rename of each item
+    // Thread proc of the long-lived preview worker which performs the regex rename of each item
     static DWORD WINAPI s_regexWorkerThread(_In_ void* pv);
     // Thread proc for performing the actual file operation that does the file rename
     static DWORD WINAPI s_fileOpWorkerThread(_In_ void* pv);
@@ -94,8 +98,19 @@ protected:
     void _LogOperationTelemetry();
 
     HANDLE m_regExWorkerThreadHandle = nullptr;
-    HANDLE m_startRegExWorkerEvent = nullptr;
-    HANDLE m_cancelRegExWorkerEvent = nullptr;
+    DWORD m_regExWorkerThreadId = 0;
+    // Auto-reset, signaled whenever the preview needs to be recomputed
+    HANDLE m_regExWorkRequestedEvent = nullptr;
+    // Manual-reset, skips the debounce interval while someone waits for the preview
+    HANDLE m_regExFlushEvent = nullptr;
+    // Auto-reset, signaled each time the worker finishes a preview pass
+    HANDLE m_regExPassCompletedEvent = nullptr;
+    HANDLE m_exitRegExWorkerEvent = nullptr;
+
+    // Bumped on every search/replace/flags change. A pass started for an older generation
+    // is abandoned as soon as the worker notices.
+    volatile LONG m_regExGeneration = 0;
+    volatile LONG m_regExCompletedGeneration = 0;
 
     HANDLE m_fileOpWorkerThreadHandle = nullptr;
     HANDLE m_startFileOpWorkerEvent = nullptr;
@@ -122,13 +137,14 @@ protected:
     _Guarded_by_(m_lockEvents) std::vector<RENAME_MGR_EVENT> m_powerRenameManagerEvents;
     _Guarded_by_(m_lockItems) std::map<int, IPowerRenameItem*> m_renameItems;
     _Guarded_by_(m_lockItems) std::vector<bool> m_isVisible;
+    // Visible rows the UI is currently showing. The preview worker processes them first.
+    _Guarded_by_(m_lockItems) UINT m_priorityFirstVisible = 0;
+    _Guarded_by_(m_lockItems) UINT m_priorityVisibleCount = 0;
 
     // Parent HWND used by IFileOperation
     HWND m_hwndParent = nullptr;
 
     HWND m_hwndMessage = nullptr;
 
-    CRITICAL_SECTION m_critsecReentrancy;
-
     long m_refCount;
 };
\ No newline at end of file
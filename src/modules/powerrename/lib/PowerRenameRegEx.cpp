@@ -10,6 +10,27 @@
 using namespace std;
 using std::regex_error;
 
+// Flags that affect where the search term matches. Changing any other flag (or the replace
+// term) leaves the cached match positions valid.
+#define SEARCH_AFFECTING_FLAGS (CaseSensitive | MatchAllOccurences | UseRegularExpressions)
+
+struct CPowerRenameRegEx::CompiledSearch
+{
+    std::unique_ptr<std::wregex> stdPattern;
+    std::unique_ptr<boost::wregex> boostPattern;
+};
+
+struct CPowerRenameRegEx::CachedMatches
+{
+    // The match results below hold iterators into this string so it must never be moved.
+    // Entries are heap allocated and owned through unique_ptr for that reason.
+    std::wstring source;
+    std::vector<std::wsmatch> stdMatches;
+    std::vector<boost::wsmatch> boostMatches;
+    // Start offsets of the matches for simple (non regex) search and replace
+    std::vector<size_t> positions;
+};
+
 IFACEMETHODIMP_(ULONG) CPowerRenameRegEx::AddRef()
 {
     return InterlockedIncrement(&m_refCount);
@@ -97,6 +118,7 @@ IFACEMETHODIMP CPowerRenameRegEx::PutSearchTerm(_In_ PCWSTR searchTerm)
             changed = true;
             CoTaskMemFree(m_searchTerm);
             hr = SHStrDup(searchTerm, &m_searchTerm);
+            _ClearMatchCache();
         }
     }
 
@@ -153,6 +175,11 @@ IFACEMETHODIMP CPowerRenameRegEx::PutFlags(_In_ DWORD flags)
 {
     if (m_flags != flags)
     {
+        if ((m_flags ^ flags) & SEARCH_AFFECTING_FLAGS)
+        {
+            CSRWExclusiveAutoLock lock(&m_lock);
+            _ClearMatchCache();
+        }
         m_flags = flags;
         _OnFlagsChanged();
     }
@@ -231,10 +258,9 @@ HRESULT CPowerRenameRegEx::Replace(_In_ PCWSTR source, _Outptr_ PWSTR* result)
     {
         return hr;
     }
-    wstring res = source;
+    wstring res;
     try
     {
-        // TODO: creating the regex could be costly.  May want to cache this.
         wchar_t newReplaceTerm[MAX_PATH] = { 0 };
         bool fileTimeErrorOccurred = false;
         if (m_useFileTime)
@@ -243,8 +269,6 @@ HRESULT CPowerRenameRegEx::Replace(_In_ PCWSTR source, _Outptr_ PWSTR* result)
                 fileTimeErrorOccurred = true;
         }
 
-        std::wstring sourceToUse(source);
-        std::wstring searchTerm(m_searchTerm);
         std::wstring replaceTerm(L"");
         if (m_useFileTime && !fileTimeErrorOccurred)
         {
@@ -255,54 +279,47 @@ HRESULT CPowerRenameRegEx::Replace(_In_ PCWSTR source, _Outptr_ PWSTR* result)
             replaceTerm = wstring(m_replaceTerm);
         }
 
-        replaceTerm = regex_replace(replaceTerm, std::wregex(L"(([^\\$]|^)(\\$\\$)*)\\$[0]"), L"$1$$$0");
-        replaceTerm = regex_replace(replaceTerm, std::wregex(L"(([^\\$]|^)(\\$\\$)*)\\$([1-9])"), L"$1$0$4");
+        CSRWExclusiveAutoLock cacheLock(&m_lockMatchCache);
+        const CachedMatches& matches = _GetMatches(source);
+        const std::wstring& formatTerm = _GetFormatTerm(replaceTerm);
 
         if (m_flags & UseRegularExpressions)
         {
+            // Same output as regex_replace, which appends each match prefix followed by the
+            // formatted match and finally the remainder after the last match.
+            auto last = matches.source.cbegin();
             if (_useBoostLib)
             {
-                boost::wregex pattern(m_searchTerm, (!(m_flags & CaseSensitive)) ? boost::regex::icase | boost::regex::ECMAScript : boost::regex::ECMAScript);
-                if (m_flags & MatchAllOccurences)
-                {
-                    res = boost::regex_replace(wstring(source), pattern, replaceTerm);
-                }
-                else
+                for (const auto& match : matches.boostMatches)
                 {
-                    res = boost::regex_replace(wstring(source), pattern, replaceTerm, boost::regex_constants::format_first_only);
+                    res.append(match.prefix().first, match.prefix().second);
+                    res += match.format(formatTerm);
+                    last = match.suffix().first;
                 }
             }
             else
             {
-                std::wregex pattern(m_searchTerm, (!(m_flags & CaseSensitive)) ? regex_constants::icase | regex_constants::ECMAScript : regex_constants::ECMAScript);
-                if (m_flags & MatchAllOccurences)
+                for (const auto& match : matches.stdMatches)
                 {
-                    res = regex_replace(wstring(source), pattern, replaceTerm);
-                }
-                else
-                {
-                    res = regex_replace(wstring(source), pattern, replaceTerm, regex_constants::format_first_only);
+                    res.append(match.prefix().first, match.prefix().second);
+                    res += match.format(formatTerm);
+                    last = match.suffix().first;
                 }
             }
+            res.append(last, matches.source.cend());
         }
         else
         {
             // Simple search and replace
-            size_t pos = 0;
-            do
+            const size_t searchTermLength = wcslen(m_searchTerm);
+            size_t last = 0;
+            for (size_t pos : matches.positions)
             {
-                pos = _Find(sourceToUse, searchTerm, (!(m_flags & CaseSensitive)), pos);
-                if (pos != std::string::npos)
-                {
-                    res = sourceToUse.replace(pos, searchTerm.length(), replaceTerm);
-                    pos += replaceTerm.length();
-                }
-
-                if (!(m_flags & MatchAllOccurences))
-                {
-                    break;
-                }
-            } while (pos != std::string::npos);
+                res.append(matches.source, last, pos - last);
+                res += formatTerm;
+                last = pos + searchTermLength;
+            }
+            res.append(matches.source, last, std::wstring::npos);
         }
 
         hr = SHStrDup(res.c_str(), result);
@@ -311,9 +328,117 @@ HRESULT CPowerRenameRegEx::Replace(_In_ PCWSTR source, _Outptr_ PWSTR* result)
     {
         hr = E_FAIL;
     }
+    catch (boost::regex_error e)
+    {
+        hr = E_FAIL;
+    }
     return hr;
 }
 
+void CPowerRenameRegEx::_ClearMatchCache()
+{
+    CSRWExclusiveAutoLock lock(&m_lockMatchCache);
+    m_compiledSearch.reset();
+    m_matchCache.clear();
+}
+
+void CPowerRenameRegEx::_EnsureCompiledSearch()
+{
+    if (m_compiledSearch)
+    {
+        return;
+    }
+
+    auto compiledSearch = std::make_unique<CompiledSearch>();
+    if (m_flags & UseRegularExpressions)
+    {
+        if (_useBoostLib)
+        {
+            compiledSearch->boostPattern = std::make_unique<boost::wregex>(m_searchTerm, (!(m_flags & CaseSensitive)) ? boost::regex::icase | boost::regex::ECMAScript : boost::regex::ECMAScript);
+        }
+        else
+        {
+            compiledSearch->stdPattern = std::make_unique<std::wregex>(m_searchTerm, (!(m_flags & CaseSensitive)) ? regex_constants::icase | regex_constants::ECMAScript : regex_constants::ECMAScript);
+        }
+    }
+    m_compiledSearch = std::move(compiledSearch);
+}
+
+const CPowerRenameRegEx::CachedMatches& CPowerRenameRegEx::_GetMatches(const std::wstring& source)
+{
+    auto it = m_matchCache.find(source);
+    if (it != m_matchCache.end())
+    {
+        return *it->second;
+    }
+
+    _EnsureCompiledSearch();
+
+    auto entry = std::make_unique<CachedMatches>();
+    entry->source = source;
+    const std::wstring& text = entry->source;
+    const bool firstOnly = !(m_flags & MatchAllOccurences);
+
+    if (m_compiledSearch->boostPattern)
+    {
+        for (boost::wsregex_iterator match(text.cbegin(), text.cend(), *m_compiledSearch->boostPattern), end; match != end; ++match)
+        {
+            entry->boostMatches.push_back(*match);
+            if (firstOnly)
+            {
+                break;
+            }
+        }
+    }
+    else if (m_compiledSearch->stdPattern)
+    {
+        for (std::wsregex_iterator match(text.cbegin(), text.cend(), *m_compiledSearch->stdPattern), end; match != end; ++match)
+        {
+            entry->stdMatches.push_back(*match);
+            if (firstOnly)
+            {
+                break;
+            }
+        }
+    }
+    else
+    {
+        // Matches never overlap: searching resumes right after the previous match, which is
+        // where the old in-place replace loop resumed as well.
+        const std::wstring searchTerm(m_searchTerm);
+        size_t pos = 0;
+        while ((pos = _Find(text, searchTerm, (!(m_flags & CaseSensitive)), pos)) != std::wstring::npos)
+        {
+            entry->positions.push_back(pos);
+            pos += searchTerm.length();
+            if (firstOnly)
+            {
+                break;
+            }
+        }
+    }
+
+    return *m_matchCache.emplace(source, std::move(entry)).first->second;
+}
+
+const std::wstring& CPowerRenameRegEx::_GetFormatTerm(const std::wstring& replaceTerm)
+{
+    if (!m_formatTermValid || m_formatTermSource != replaceTerm)
+    {
+        // Escape $0 and shift $1-$9 so they refer to the capture groups of the search pattern
+        static const std::wregex escapeWholeMatch(L"(([^\\$]|^)(\\$\\$)*)\\$[0]");
+        static const std::wregex shiftGroups(L"(([^\\$]|^)(\\$\\$)*)\\$([1-9])");
+
+        std::wstring formatTerm = regex_replace(replaceTerm, escapeWholeMatch, L"$1$$$0");
+        formatTerm = regex_replace(formatTerm, shiftGroups, L"$1$0$4");
+
+        m_formatTermSource = replaceTerm;
+        m_formatTerm = std::move(formatTerm);
+        m_formatTermValid = true;
+    }
+    return m_formatTerm;
+}
+
 size_t CPowerRenameRegEx::_Find(std::wstring data, std::wstring toSearch, bool caseInsensitive, size_t pos)
 {
     if (caseInsensitive)
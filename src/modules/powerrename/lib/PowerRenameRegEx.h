@@ -2,6 +2,8 @@
 #include "pch.h"
 #include <vector>
 #include <string>
+#include <memory>
+#include <unordered_map>
 #include "srwlock.h"
 
 #include "PowerRenameInterfaces.h"
@@ -42,6 +44,17 @@ protected:
 
     size_t _Find(std::wstring data, std::wstring toSearch, bool caseInsensitive, size_t pos);
 
+    // Compiled search pattern and the match positions found for each source name. The preview
+    // re-runs Replace for every item on each keystroke; when only the replace term (or file
+    // time) changed we can reuse the matches and just redo the substitution.
+    struct CompiledSearch;
+    struct CachedMatches;
+
+    void _ClearMatchCache();
+    void _EnsureCompiledSearch();
+    const CachedMatches& _GetMatches(const std::wstring& source);
+    const std::wstring& _GetFormatTerm(const std::wstring& replaceTerm);
+
     bool _useBoostLib = false;
     DWORD m_flags = DEFAULT_FLAGS;
     PWSTR m_searchTerm = nullptr;
@@ -52,6 +65,13 @@ protected:
 
     CSRWLock m_lock;
     CSRWLock m_lockEvents;
+    CSRWLock m_lockMatchCache;
+
+    _Guarded_by_(m_lockMatchCache) std::unique_ptr<CompiledSearch> m_compiledSearch;
+    _Guarded_by_(m_lockMatchCache) std::unordered_map<std::wstring, std::unique_ptr<CachedMatches>> m_matchCache;
+    _Guarded_by_(m_lockMatchCache) std::wstring m_formatTermSource;
+    _Guarded_by_(m_lockMatchCache) std::wstring m_formatTerm;
+    _Guarded_by_(m_lockMatchCache) bool m_formatTermValid = false;
 
     DWORD m_cookie = 0;
 
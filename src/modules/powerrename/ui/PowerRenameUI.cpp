@@ -936,6 +936,12 @@ void CPowerRenameUI::_OnSearchReplaceChanged()
     CComPtr<IPowerRenameRegEx> spRegEx;
     if (m_spsrm && SUCCEEDED(m_spsrm->GetRenameRegEx(&spRegEx)))
     {
+        // Let the preview worker update the rows on screen first
+        UINT firstVisible = 0;
+        UINT visibleCount = 0;
+        m_listview.GetVisibleRange(&firstVisible, &visibleCount);
+        m_spsrm->PutPreviewPriorityRange(firstVisible, visibleCount);
+
         wchar_t buffer[CSettings::MAX_INPUT_STRING_LEN];
         buffer[0] = L'\0';
         GetDlgItemText(m_hwnd, IDC_EDIT_SEARCHFOR, buffer, ARRAYSIZE(buffer));
@@ -1333,6 +1339,13 @@ void CPowerRenameListView::RedrawItems(_In_ int first, _In_ int last)
     ListView_RedrawItems(m_hwndLV, first, last);
 }
 
+void CPowerRenameListView::GetVisibleRange(_Out_ UINT* first, _Out_ UINT* count)
+{
+    *first = static_cast<UINT>(ListView_GetTopIndex(m_hwndLV));
+    // One extra row for the partially visible item at the bottom
+    *count = static_cast<UINT>(ListView_GetCountPerPage(m_hwndLV)) + 1;
+}
+
 void CPowerRenameListView::SetItemCount(_In_ UINT itemCount)
 {
     if (m_itemCount != itemCount)
@@ -18,6 +18,7 @@ public:
     void UpdateItemCheckState(_In_ IPowerRenameManager* psrm, _In_ int iItem);
     void RedrawItems(_In_ int first, _In_ int last);
     void SetItemCount(_In_ UINT itemCount);
+    void GetVisibleRange(_Out_ UINT* first, _Out_ UINT* count);
     void OnKeyDown(_In_ IPowerRenameManager* psrm, _In_ LV_KEYDOWN* lvKeyDown);
     void OnClickList(_In_ IPowerRenameManager* psrm, NM_LISTVIEW* pnmListView);
     void OnColumnClick(_In_ IPowerRenameManager* psrm, _In_ int pnmListView);
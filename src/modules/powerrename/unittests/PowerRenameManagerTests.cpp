@@ -168,6 +168,37 @@ namespace PowerRenameManagerTests
             RenameHelper(renamePairs, ARRAYSIZE(renamePairs), L"foo", L"bar", SYSTEMTIME{ 2020, 7, 3, 22, 15, 6, 42, 453 }, DEFAULT_FLAGS);
         }
 
+        TEST_METHOD(VerifyRenameUsesLatestSearchTerm)
+        {
+            // Preview updates are debounced while typing, renaming must still use the final terms
+            CTestFileHelper testFileHelper;
+            Assert::IsTrue(testFileHelper.AddFile(L"foo.txt"));
+
+            CComPtr<IPowerRenameManager> mgr;
+            Assert::IsTrue(CPowerRenameManager::s_CreateInstance(&mgr) == S_OK);
+
+            CComPtr<IPowerRenameItem> item;
+            CMockPowerRenameItem::CreateInstance(testFileHelper.GetFullPath(L"foo.txt").c_str(), L"foo.txt", 0, false, SYSTEMTIME{ 0 }, &item);
+            mgr->AddItem(item);
+
+            CComPtr<IPowerRenameRegEx> renRegEx;
+            Assert::IsTrue(mgr->GetRenameRegEx(&renRegEx) == S_OK);
+            renRegEx->PutFlags(DEFAULT_FLAGS);
+            PCWSTR searchTerms[] = { L"f", L"fo", L"foo" };
+            PCWSTR replaceTerms[] = { L"b", L"ba", L"bar" };
+            for (int i = 0; i < ARRAYSIZE(searchTerms); i++)
+            {
+                renRegEx->PutSearchTerm(searchTerms[i]);
+                renRegEx->PutReplaceTerm(replaceTerms[i]);
+            }
+
+            Assert::IsTrue(mgr->Rename(0) == S_OK);
+            Assert::IsFalse(testFileHelper.PathExists(L"foo.txt"));
+            Assert::IsTrue(testFileHelper.PathExists(L"bar.txt"));
+
+            Assert::IsTrue(mgr->Shutdown() == S_OK);
+        }
+
         TEST_METHOD(VerifyMultiRename)
         {
             // Create a single item and verify rename works as expected
@@ -414,6 +414,55 @@ TEST_METHOD(VerifyLookbehind)
     }
 }
 
+TEST_METHOD(VerifyReplaceTermChangeAfterMatch)
+{
+    // Matches are cached per source name, changing only the replace term must redo the substitution
+    CComPtr<IPowerRenameRegEx> renameRegEx;
+    Assert::IsTrue(CPowerRenameRegEx::s_CreateInstance(&renameRegEx) == S_OK);
+    Assert::IsTrue(renameRegEx->PutFlags(MatchAllOccurences | UseRegularExpressions) == S_OK);
+    Assert::IsTrue(renameRegEx->PutSearchTerm(L"([a-z]+)_(\\d+)") == S_OK);
+
+    SearchReplaceExpected sreTable[] = {
+        //search, replace, test, result
+        { nullptr, L"$2", L"abc_123.txt", L"123.txt" },
+        { nullptr, L"$1", L"abc_123.txt", L"abc.txt" },
+        { nullptr, L"$2-$1", L"abc_123 def_45", L"123-abc 45-def" },
+        { nullptr, L"", L"abc_123 def_45", L" " },
+    };
+
+    for (int i = 0; i < ARRAYSIZE(sreTable); i++)
+    {
+        PWSTR result = nullptr;
+        Assert::IsTrue(renameRegEx->PutReplaceTerm(sreTable[i].replace) == S_OK);
+        Assert::IsTrue(renameRegEx->Replace(sreTable[i].test, &result) == S_OK);
+        Assert::AreEqual(sreTable[i].expected, result);
+        CoTaskMemFree(result);
+    }
+
+    // Changing the search term or a search affecting flag must not reuse stale matches
+    PWSTR result = nullptr;
+    Assert::IsTrue(renameRegEx->PutReplaceTerm(L"X") == S_OK);
+    Assert::IsTrue(renameRegEx->PutSearchTerm(L"ABC") == S_OK);
+    Assert::IsTrue(renameRegEx->Replace(L"abc_123.txt", &result) == S_OK);
+    Assert::AreEqual(L"X_123.txt", result);
+    CoTaskMemFree(result);
+
+    Assert::IsTrue(renameRegEx->PutFlags(MatchAllOccurences | UseRegularExpressions | CaseSensitive) == S_OK);
+    Assert::IsTrue(renameRegEx->Replace(L"abc_123.txt", &result) == S_OK);
+    Assert::AreEqual(L"abc_123.txt", result);
+    CoTaskMemFree(result);
+
+    Assert::IsTrue(renameRegEx->PutFlags(MatchAllOccurences) == S_OK);
+    Assert::IsTrue(renameRegEx->PutSearchTerm(L"b") == S_OK);
+    Assert::IsTrue(renameRegEx->Replace(L"abcb", &result) == S_OK);
+    Assert::AreEqual(L"aXcX", result);
+    CoTaskMemFree(result);
+    Assert::IsTrue(renameRegEx->PutReplaceTerm(L"YY") == S_OK);
+    Assert::IsTrue(renameRegEx->Replace(L"abcb", &result) == S_OK);
+    Assert::AreEqual(L"aYYcYY", result);
+    CoTaskMemFree(result);
+}
+
 TEST_METHOD(VerifyEventsFire)
 {
     CComPtr<IPowerRenameRegEx> renameRegEx;
@@ -0,0 +1,200 @@
+#include "pch.h"
+
+#include <chrono>
+
+#include "modules/shortcut_guide/tasklist_layout.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace ShortcutGuideTests
+{
+    namespace
+    {
+        // Hand written layouts in the shape UI Automation reports buttons in, for the taskbar configurations Windows supports
+        struct TaskbarLayout
+        {
+            const wchar_t* description;
+            std::vector<TasklistButton> raw_buttons;
+            // Key number of every raw button, 0 for the ones left out
+            std::vector<long> expected_keynums;
+        };
+
+        TasklistButton Button(const wchar_t* name, long x, long y, long width, long height)
+        {
+            return { name, x, y, width, height, 0 };
+        }
+
+        std::vector<TaskbarLayout> TaskbarLayouts()
+        {
+            const wchar_t* explorer = L"Microsoft.Windows.Explorer";
+            const wchar_t* edge = L"MSEdge";
+            const wchar_t* terminal = L"Microsoft.WindowsTerminal_8wekyb3d8bbwe!App";
+            const wchar_t* code = L"Microsoft.VisualStudioCode";
+            const wchar_t* outlook = L"Microsoft.Office.OUTLOOK.EXE.15";
+            const wchar_t* teams = L"MSTeams_8wekyb3d8bbwe!MSTeams";
+
+            std::vector<TaskbarLayout> layouts;
+
+            layouts.push_back({ L"Bottom taskbar at 100%",
+                                { Button(explorer, 56, 1040, 48, 40),
+                                  Button(edge, 104, 1040, 48, 40),
+                                  Button(terminal, 152, 1040, 48, 40),
+                                  Button(code, 200, 1040, 48, 40) },
+                                { 1, 2, 3, 4 } });
+
+            // Never combine, the windows of an app get one button each but a single key number
+            layouts.push_back({ L"Bottom taskbar at 150%, never combined",
+                                { Button(explorer, 84, 1380, 240, 60),
+                                  Button(explorer, 324, 1380, 240, 60),
+                                  Button(edge, 564, 1380, 240, 60),
+                                  Button(edge, 804, 1380, 240, 60),
+                                  Button(edge, 1044, 1380, 240, 60),
+                                  Button(outlook, 1284, 1380, 240, 60) },
+                                { 1, 0, 2, 0, 0, 3 } });
+
+            // Only the first row gets key numbers
+            layouts.push_back({ L"Two rows bottom taskbar",
+                                { Button(explorer, 56, 1000, 48, 40),
+                                  Button(edge, 104, 1000, 48, 40),
+                                  Button(terminal, 152, 1000, 48, 40),
+                                  Button(code, 56, 1040, 48, 40),
+                                  Button(teams, 104, 1040, 48, 40) },
+                                { 1, 2, 3, 0, 0 } });
+
+            layouts.push_back({ L"Left taskbar",
+                                { Button(explorer, 0, 48, 62, 40),
+                                  Button(edge, 0, 88, 62, 40),
+                                  Button(teams, 0, 128, 62, 40) },
+                                { 1, 2, 3 } });
+
+            // Second row of a vertical taskbar starts at the top again
+            layouts.push_back({ L"Two columns right taskbar",
+                                { Button(explorer, 1796, 48, 62, 40),
+                                  Button(edge, 1796, 88, 62, 40),
+                                  Button(teams, 1858, 48, 62, 40) },
+                                { 1, 2, 0 } });
+
+            layouts.push_back({ L"Top taskbar on a monitor left of the primary one",
+                                { Button(outlook, -1864, 0, 48, 40),
+                                  Button(terminal, -1816, 0, 48, 40) },
+                                { 1, 2 } });
+
+            TaskbarLayout crowded{ L"Bottom taskbar with more than 10 apps", {}, {} };
+            for (long i = 0; i < 14; ++i)
+            {
+                crowded.raw_buttons.push_back(Button(i % 2 ? edge : explorer, 56 + 48 * i, 1040, 48, 40));
+                crowded.expected_keynums.push_back(i < 10 ? i + 1 : 0);
+            }
+            layouts.push_back(crowded);
+
+            layouts.push_back({ L"No running apps", {}, {} });
+
+            return layouts;
+        }
+
+        std::vector<TasklistButton> DistinctButtons(size_t count)
+        {
+            std::vector<TasklistButton> buttons;
+            for (size_t i = 0; i < count; ++i)
+            {
+                buttons.push_back({ std::to_wstring(i), 100 + 50 * static_cast<long>(i), 1040, 44, 40, 0 });
+            }
+            return buttons;
+        }
+    }
+
+    TEST_CLASS(TasklistLayoutTests)
+    {
+    public:
+        TEST_METHOD(AssignKeynumsTaskbarLayouts)
+        {
+            for (const auto& example : TaskbarLayouts())
+            {
+                std::vector<long> expected;
+                for (size_t i = 0; i < example.raw_buttons.size(); ++i)
+                {
+                    if (example.expected_keynums[i] != 0)
+                    {
+                        expected.push_back(example.expected_keynums[i]);
+                    }
+                }
+
+                std::vector<long> actual;
+                for (const auto& button : TasklistLayout::assign_keynums(example.raw_buttons))
+                {
+                    actual.push_back(button.keynum);
+                }
+
+                Assert::IsTrue(expected == actual, example.description);
+            }
+        }
+
+        TEST_METHOD(GetButtonsUsesTheCachedLayout)
+        {
+            TasklistLayout layout;
+            std::vector<TasklistButton> buttons;
+            Assert::IsFalse(layout.get_buttons(buttons));
+
+            layout.update(DistinctButtons(3), layout.begin_refresh());
+            Assert::IsTrue(layout.get_buttons(buttons));
+            Assert::AreEqual(size_t{ 3 }, buttons.size());
+            Assert::AreEqual(3L, buttons.back().keynum);
+
+            layout.invalidate();
+            Assert::IsFalse(layout.get_buttons(buttons));
+        }
+
+        TEST_METHOD(GetButtonsIgnoresRefreshRacingWithAChange)
+        {
+            TasklistLayout layout;
+            const auto token = layout.begin_refresh();
+            layout.invalidate();
+            layout.update(DistinctButtons(3), token);
+
+            std::vector<TasklistButton> buttons;
+            Assert::IsFalse(layout.get_buttons(buttons));
+        }
+
+        TEST_METHOD(Benchmark)
+        {
+            using nanoseconds = std::chrono::duration<double, std::nano>;
+
+            std::vector<TasklistButton> raw_buttons;
+            for (const auto& example : TaskbarLayouts())
+            {
+                if (example.raw_buttons.size() > raw_buttons.size())
+                {
+                    raw_buttons = example.raw_buttons;
+                }
+            }
+
+            constexpr int iterations = 100000;
+            size_t keynums = 0;
+            auto start = std::chrono::steady_clock::now();
+            for (int i = 0; i < iterations; ++i)
+            {
+                keynums += TasklistLayout::assign_keynums(raw_buttons).size();
+            }
+            const nanoseconds assign_time = std::chrono::steady_clock::now() - start;
+
+            TasklistLayout layout;
+            layout.update(raw_buttons, layout.begin_refresh());
+            std::vector<TasklistButton> buttons;
+            size_t cached = 0;
+            start = std::chrono::steady_clock::now();
+            for (int i = 0; i < iterations; ++i)
+            {
+                cached += layout.get_buttons(buttons);
+            }
+            const nanoseconds get_buttons_time = std::chrono::steady_clock::now() - start;
+
+            Assert::AreEqual(buttons.size() * iterations, keynums);
+            Assert::AreEqual(size_t{ iterations }, cached);
+
+            const auto message = "assign_keynums: " + std::to_string(assign_time.count() / iterations) + "ns, get_buttons: " +
+                                 std::to_string(get_buttons_time.count() / iterations) + "ns per call over " +
+                                 std::to_string(raw_buttons.size()) + " buttons\n";
+            Logger::WriteMessage(message.c_str());
+        }
+    };
+}
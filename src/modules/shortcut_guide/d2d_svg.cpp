@@ -24,9 +24,55 @@ D2DSVG& D2DSVG::load(const std::wstring& filename, ID2D1DeviceContext5* d2d_dc)
     svg_width = (int)tmp;
     winrt::check_hresult(root->GetAttributeValue(L"height", &tmp));
     svg_height = (int)tmp;
+    index_elements();
     return *this;
 }
 
+void D2DSVG::index_elements()
+{
+    elements_by_id.clear();
+    filled_elements.clear();
+    std::vector<winrt::com_ptr<ID2D1SvgElement>> stack;
+    stack.emplace_back();
+    svg->GetRoot(stack.back().put());
+    std::wstring id;
+    while (!stack.empty())
+    {
+        auto element = std::move(stack.back());
+        stack.pop_back();
+        if (!element)
+            continue;
+        if (element->IsAttributeSpecified(L"fill"))
+        {
+            filled_elements.push_back(element);
+        }
+        UINT32 id_length = 0;
+        if (element->IsAttributeSpecified(L"id") &&
+            element->GetAttributeValueLength(L"id", D2D1_SVG_ATTRIBUTE_STRING_TYPE_ID, &id_length) == S_OK)
+        {
+            id.resize(id_length + 1);
+            if (element->GetAttributeValue(L"id", D2D1_SVG_ATTRIBUTE_STRING_TYPE_ID, id.data(), id_length + 1) == S_OK)
+            {
+                id.resize(id_length);
+                elements_by_id.emplace(id, element);
+            }
+        }
+        // Children are pushed in reverse so the walk is in document order, which makes the first
+        // element wins on duplicate ids, same as FindElementById
+        auto children_start = stack.size();
+        winrt::com_ptr<ID2D1SvgElement> sub;
+        element->GetFirstChild(sub.put());
+        while (sub)
+        {
+            winrt::com_ptr<ID2D1SvgElement> next;
+            element->GetNextChild(sub.get(), next.put());
+            stack.push_back(std::move(sub));
+            sub = next;
+        }
+        std::reverse(stack.begin() + children_start, stack.end());
+    }
+}
+
 D2DSVG& D2DSVG::resize(int x, int y, int width, int height, float fill, float max_scale)
 {
     // Center
@@ -48,33 +94,17 @@ D2DSVG& D2DSVG::recolor(uint32_t oldcolor, uint32_t newcolor)
 {
     auto new_color = D2D1::ColorF(newcolor & 0xFFFFFF, 1);
     auto old_color = D2D1::ColorF(oldcolor & 0xFFFFFF, 1);
-    std::function<void(ID2D1SvgElement * element)> recurse = [&](ID2D1SvgElement* element) {
-        if (!element)
-            return;
-        if (element->IsAttributeSpecified(L"fill"))
-        {
-            D2D1_COLOR_F elem_fill;
-            winrt::com_ptr<ID2D1SvgPaint> paint;
-            element->GetAttributeValue(L"fill", paint.put());
-            paint->GetColor(&elem_fill);
-            if (elem_fill.r == old_color.r && elem_fill.g == old_color.g && elem_fill.b == old_color.b)
-            {
-                winrt::check_hresult(element->SetAttributeValue(L"fill", new_color));
-            }
-        }
-        winrt::com_ptr<ID2D1SvgElement> sub;
-        element->GetFirstChild(sub.put());
-        while (sub)
+    for (auto& element : filled_elements)
+    {
+        D2D1_COLOR_F elem_fill;
+        winrt::com_ptr<ID2D1SvgPaint> paint;
+        element->GetAttributeValue(L"fill", paint.put());
+        paint->GetColor(&elem_fill);
+        if (elem_fill.r == old_color.r && elem_fill.g == old_color.g && elem_fill.b == old_color.b)
         {
-            recurse(sub.get());
-            winrt::com_ptr<ID2D1SvgElement> next;
-            element->GetNextChild(sub.get(), next.put());
-            sub = next;
+            winrt::check_hresult(element->SetAttributeValue(L"fill", new_color));
         }
-    };
-    winrt::com_ptr<ID2D1SvgElement> root;
-    svg->GetRoot(root.put());
-    recurse(root.get());
+    }
     return *this;
 }
 
@@ -90,9 +120,7 @@ D2DSVG& D2DSVG::render(ID2D1DeviceContext5* d2d_dc)
 
 D2DSVG& D2DSVG::toggle_element(const wchar_t* id, bool visible)
 {
-    winrt::com_ptr<ID2D1SvgElement> element;
-    if (svg->FindElementById(id, element.put()) != S_OK)
-        return *this;
+    auto element = find_element(id);
     if (!element)
         return *this;
     element->SetAttributeValue(L"display", visible ? D2D1_SVG_DISPLAY::D2D1_SVG_DISPLAY_INLINE : D2D1_SVG_DISPLAY::D2D1_SVG_DISPLAY_NONE);
@@ -101,9 +129,8 @@ D2DSVG& D2DSVG::toggle_element(const wchar_t* id, bool visible)
 
 winrt::com_ptr<ID2D1SvgElement> D2DSVG::find_element(const std::wstring& id)
 {
-    winrt::com_ptr<ID2D1SvgElement> element;
-    winrt::check_hresult(svg->FindElementById(id.c_str(), element.put()));
-    return element;
+    auto it = elements_by_id.find(id);
+    return it != elements_by_id.end() ? it->second : nullptr;
 }
 
 D2D1_RECT_F D2DSVG::rescale(D2D1_RECT_F rect)
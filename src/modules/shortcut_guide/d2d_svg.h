@@ -3,6 +3,8 @@
 #include <d2d1_3helper.h>
 #include <winrt/base.h>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 class D2DSVG
 {
@@ -19,8 +21,13 @@ public:
     D2D1_RECT_F rescale(D2D1_RECT_F rect);
 
 protected:
+    void index_elements();
+
     float used_scale = 1.0f;
     winrt::com_ptr<ID2D1SvgDocument> svg;
     int svg_width = -1, svg_height = -1;
     D2D1::Matrix3x2F transform;
+    // Built once at load so lookups and recoloring do not walk the document
+    std::unordered_map<std::wstring, winrt::com_ptr<ID2D1SvgElement>> elements_by_id;
+    std::vector<winrt::com_ptr<ID2D1SvgElement>> filled_elements;
 };
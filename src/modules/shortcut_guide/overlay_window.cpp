@@ -169,9 +169,7 @@ ScaleResult D2DOverlaySVG::get_thumbnail_rect_and_scale(int x_offset, int y_offs
 
 winrt::com_ptr<ID2D1SvgElement> D2DOverlaySVG::find_element(const std::wstring& id)
 {
-    winrt::com_ptr<ID2D1SvgElement> element;
-    winrt::check_hresult(svg->FindElementById(id.c_str(), element.put()));
-    return element;
+    return D2DSVG::find_element(id);
 }
 
 D2DOverlaySVG& D2DOverlaySVG::toggle_window_group(bool active)
@@ -367,6 +365,10 @@ void D2DOverlayWindow::show(HWND active_window, bool snappable)
     param.cbSize = sizeof(APPBARDATA);
     if ((UINT)SHAppBarMessage(ABM_GETSTATE, &param) != ABS_AUTOHIDE)
     {
+        // Show the arrows right away if the taskbar did not change since it was last read
+        lock.lock();
+        tasklist.get_cached_buttons(tasklist_buttons);
+        lock.unlock();
         tasklist_cv_mutex.lock();
         tasklist_update = true;
         tasklist_cv_mutex.unlock();
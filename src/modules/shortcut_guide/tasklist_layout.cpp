@@ -0,0 +1,61 @@
+#include "tasklist_layout.h"
+
+void TasklistLayout::invalidate()
+{
+    ++invalidations;
+}
+
+bool TasklistLayout::is_valid() const
+{
+    return valid_for.load() == invalidations.load();
+}
+
+uint64_t TasklistLayout::begin_refresh() const
+{
+    return invalidations.load();
+}
+
+std::vector<TasklistButton> TasklistLayout::update(const std::vector<TasklistButton>& raw_buttons, uint64_t refresh_token)
+{
+    auto numbered = assign_keynums(raw_buttons);
+    std::unique_lock lock(mutex);
+    buttons = numbered;
+    valid_for = refresh_token;
+    return numbered;
+}
+
+bool TasklistLayout::get_buttons(std::vector<TasklistButton>& result) const
+{
+    if (!is_valid())
+    {
+        return false;
+    }
+    std::unique_lock lock(mutex);
+    result = buttons;
+    return true;
+}
+
+std::vector<TasklistButton> TasklistLayout::assign_keynums(const std::vector<TasklistButton>& raw_buttons)
+{
+    std::vector<TasklistButton> result;
+    for (auto& button : raw_buttons)
+    {
+        if (result.empty())
+        {
+            result.push_back(button);
+            result.back().keynum = 1;
+        }
+        else
+        {
+            if (button.x < result.back().x || button.y < result.back().y) // skip 2nd row
+                break;
+            if (button.name == result.back().name)
+                continue; // skip buttons from the same app
+            result.push_back(button);
+            result.back().keynum = result[result.size() - 2].keynum + 1;
+            if (result.back().keynum == 10)
+                break; // no more than 10 buttons
+        }
+    }
+    return result;
+}
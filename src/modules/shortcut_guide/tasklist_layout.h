@@ -0,0 +1,44 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+struct TasklistButton
+{
+    std::wstring name;
+    long x, y, width, height, keynum;
+};
+
+// Cached geometry of the taskbar buttons. The raw button records are only re-read after the taskbar
+// reported a change, otherwise the last computed layout is handed out as is.
+// Only uses the standard library, the UI Automation side lives in tasklist_positions.
+class TasklistLayout
+{
+public:
+    // Marks the cached layout stale. Called from UI Automation event threads.
+    void invalidate();
+
+    bool is_valid() const;
+
+    // Returns a token to pass to update(). Invalidations that arrive between this call and update()
+    // keep the layout stale, so a refresh racing with a taskbar change is not cached.
+    uint64_t begin_refresh() const;
+
+    // Stores the buttons in the order UI Automation reports them, assigns their key numbers and
+    // returns the resulting layout
+    std::vector<TasklistButton> update(const std::vector<TasklistButton>& raw_buttons, uint64_t refresh_token);
+
+    // Copies the cached layout, returns false when it is stale
+    bool get_buttons(std::vector<TasklistButton>& buttons) const;
+
+    // Keeps the first row, one button per app and at most 10 buttons, numbered from 1
+    static std::vector<TasklistButton> assign_keynums(const std::vector<TasklistButton>& raw_buttons);
+
+private:
+    std::atomic<uint64_t> invalidations = 0;
+    std::atomic<uint64_t> valid_for = UINT64_MAX;
+    mutable std::mutex mutex;
+    std::vector<TasklistButton> buttons;
+};
@@ -1,6 +1,62 @@
 #include "pch.h"
 #include "tasklist_positions.h"
 
+// Invalidates the cached layout when taskbar buttons are added, removed, reordered or moved
+class TasklistChangeHandler : public IUIAutomationStructureChangedEventHandler, public IUIAutomationPropertyChangedEventHandler
+{
+public:
+    TasklistChangeHandler(std::shared_ptr<TasklistLayout> layout) :
+        layout(std::move(layout))
+    {
+    }
+
+    IFACEMETHODIMP QueryInterface(REFIID riid, void** ppv)
+    {
+        static const QITAB qit[] = {
+            QITABENT(TasklistChangeHandler, IUIAutomationStructureChangedEventHandler),
+            QITABENT(TasklistChangeHandler, IUIAutomationPropertyChangedEventHandler),
+            { 0 },
+        };
+        return QISearch(this, qit, riid, ppv);
+    }
+
+    IFACEMETHODIMP_(ULONG) AddRef()
+    {
+        return InterlockedIncrement(&ref_count);
+    }
+
+    IFACEMETHODIMP_(ULONG) Release()
+    {
+        long refs = InterlockedDecrement(&ref_count);
+        if (refs == 0)
+        {
+            delete this;
+        }
+        return refs;
+    }
+
+    IFACEMETHODIMP HandleStructureChangedEvent(IUIAutomationElement*, StructureChangeType, SAFEARRAY*)
+    {
+        layout->invalidate();
+        return S_OK;
+    }
+
+    IFACEMETHODIMP HandlePropertyChangedEvent(IUIAutomationElement*, PROPERTYID, VARIANT)
+    {
+        layout->invalidate();
+        return S_OK;
+    }
+
+private:
+    long ref_count = 1;
+    std::shared_ptr<TasklistLayout> layout;
+};
+
+Tasklist::~Tasklist()
+{
+    unsubscribe();
+}
+
 void Tasklist::update()
 {
     // Get HWND of the tasklist
@@ -16,6 +72,18 @@ void Tasklist::update()
     tasklist_hwnd = FindWindowExA(tasklist_hwnd, 0, "MSTaskListWClass", nullptr);
     if (!tasklist_hwnd)
         return;
+    RECT rect = {};
+    GetWindowRect(tasklist_hwnd, &rect);
+    if (element && tasklist_hwnd == this->tasklist_hwnd)
+    {
+        // Same taskbar, the events keep the layout up to date unless the taskbar itself moved
+        if (!EqualRect(&rect, &tasklist_rect))
+        {
+            tasklist_rect = rect;
+            layout->invalidate();
+        }
+        return;
+    }
     if (!automation)
     {
         winrt::check_hresult(CoCreateInstance(CLSID_CUIAutomation,
@@ -25,16 +93,38 @@ void Tasklist::update()
                                               automation.put_void()));
         winrt::check_hresult(automation->CreateTrueCondition(true_condition.put()));
     }
+    unsubscribe();
     element = nullptr;
+    this->tasklist_hwnd = tasklist_hwnd;
+    tasklist_rect = rect;
+    layout->invalidate();
     winrt::check_hresult(automation->ElementFromHandle(tasklist_hwnd, element.put()));
+    subscribe();
 }
 
-bool Tasklist::update_buttons(std::vector<TasklistButton>& buttons)
+void Tasklist::subscribe()
 {
-    if (!automation || !element)
+    if (!change_handler)
     {
-        return false;
+        change_handler.attach(new TasklistChangeHandler(layout));
+    }
+    PROPERTYID bounding_rectangle = UIA_BoundingRectanglePropertyId;
+    subscribed = automation->AddStructureChangedEventHandler(element.get(), TreeScope_Subtree, nullptr, change_handler.get()) >= 0;
+    subscribed = automation->AddPropertyChangedEventHandlerNativeArray(element.get(), TreeScope_Subtree, nullptr, change_handler.get(), &bounding_rectangle, 1) >= 0 && subscribed;
+}
+
+void Tasklist::unsubscribe()
+{
+    if (automation && element && change_handler)
+    {
+        automation->RemoveStructureChangedEventHandler(element.get(), change_handler.get());
+        automation->RemovePropertyChangedEventHandler(element.get(), change_handler.get());
     }
+    subscribed = false;
+}
+
+bool Tasklist::query_buttons(std::vector<TasklistButton>& found_buttons)
+{
     winrt::com_ptr<IUIAutomationElementArray> elements;
     if (element->FindAll(TreeScope_Children, true_condition.get(), elements.put()) < 0)
         return false;
@@ -44,14 +134,14 @@ bool Tasklist::update_buttons(std::vector<TasklistButton>& buttons)
     if (elements->get_Length(&count) < 0)
         return false;
     winrt::com_ptr<IUIAutomationElement> child;
-    std::vector<TasklistButton> found_buttons;
+    found_buttons.clear();
     found_buttons.reserve(count);
     for (int i = 0; i < count; ++i)
     {
         child = nullptr;
         if (elements->GetElement(i, child.put()) < 0)
             return false;
-        TasklistButton button;
+        TasklistButton button = {};
         if (VARIANT var_rect; child->GetCurrentPropertyValue(UIA_BoundingRectanglePropertyId, &var_rect) >= 0)
         {
             if (var_rect.vt == (VT_R8 | VT_ARRAY))
@@ -84,30 +174,37 @@ bool Tasklist::update_buttons(std::vector<TasklistButton>& buttons)
         }
         found_buttons.push_back(button);
     }
-    // assign keynums
-    buttons.clear();
-    for (auto& button : found_buttons)
+    return true;
+}
+
+bool Tasklist::update_buttons(std::vector<TasklistButton>& buttons)
+{
+    if (!automation || !element)
     {
-        if (buttons.empty())
-        {
-            button.keynum = 1;
-            buttons.push_back(std::move(button));
-        }
-        else
-        {
-            if (button.x < buttons.back().x || button.y < buttons.back().y) // skip 2nd row
-                break;
-            if (button.name == buttons.back().name)
-                continue; // skip buttons from the same app
-            button.keynum = buttons.back().keynum + 1;
-            buttons.push_back(std::move(button));
-            if (buttons.back().keynum == 10)
-                break; // no more than 10 buttons
-        }
+        return false;
+    }
+    if (!subscribed)
+    {
+        // Without change notifications the layout has to be read every time
+        layout->invalidate();
     }
+    if (layout->get_buttons(buttons))
+    {
+        return true;
+    }
+    auto refresh_token = layout->begin_refresh();
+    std::vector<TasklistButton> found_buttons;
+    if (!query_buttons(found_buttons))
+        return false;
+    buttons = layout->update(found_buttons, refresh_token);
     return true;
 }
 
+bool Tasklist::get_cached_buttons(std::vector<TasklistButton>& buttons) const
+{
+    return element && layout->get_buttons(buttons);
+}
+
 std::vector<TasklistButton> Tasklist::get_buttons()
 {
     std::vector<TasklistButton> buttons;
@@ -1,25 +1,37 @@
 #pragma once
+#include <memory>
 #include <vector>
 #include <unordered_set>
 #include <string>
 #include <Windows.h>
 #include <UIAutomationClient.h>
 
-struct TasklistButton
-{
-    std::wstring name;
-    long x, y, width, height, keynum;
-};
+#include "tasklist_layout.h"
+
+class TasklistChangeHandler;
 
 class Tasklist
 {
 public:
+    ~Tasklist();
     void update();
     std::vector<TasklistButton> get_buttons();
     bool update_buttons(std::vector<TasklistButton>& buttons);
+    // Returns false if the taskbar changed since the buttons were last read
+    bool get_cached_buttons(std::vector<TasklistButton>& buttons) const;
 
 private:
+    bool query_buttons(std::vector<TasklistButton>& buttons);
+    void subscribe();
+    void unsubscribe();
+
     winrt::com_ptr<IUIAutomation> automation;
     winrt::com_ptr<IUIAutomationElement> element;
     winrt::com_ptr<IUIAutomationCondition> true_condition;
+    winrt::com_ptr<TasklistChangeHandler> change_handler;
+    bool subscribed = false;
+    HWND tasklist_hwnd = nullptr;
+    RECT tasklist_rect = {};
+    // Shared with the event handler, which can outlive this object on UI Automation threads
+    std::shared_ptr<TasklistLayout> layout = std::make_shared<TasklistLayout>();
 };
@@ -76,9 +76,11 @@ void VideoConferenceModule::reverseVirtualCameraMuteState()
     }
 
     instance->_settingsUpdateChannel->access([&muted](auto settingsMemory) {
-        auto settings = reinterpret_cast<CameraSettingsUpdateChannel*>(settingsMemory._data);
-        settings->useOverlayImage = !settings->useOverlayImage;
-        muted = settings->useOverlayImage;
+        auto updatesChannel = reinterpret_cast<CameraSettingsUpdateChannel*>(settingsMemory._data);
+        updatesChannel->update([&muted](CameraSettings& channelSettings) {
+            channelSettings.useOverlayImage = !channelSettings.useOverlayImage;
+            muted = channelSettings.useOverlayImage;
+        });
     });
 
     if (muted)
@@ -90,16 +92,15 @@ void VideoConferenceModule::reverseVirtualCameraMuteState()
 
 bool VideoConferenceModule::getVirtualCameraMuteState()
 {
-    bool disabled = false;
     if (!instance->_settingsUpdateChannel.has_value())
     {
-        return disabled;
+        return false;
     }
-    instance->_settingsUpdateChannel->access([&disabled](auto settingsMemory) {
-        auto settings = reinterpret_cast<CameraSettingsUpdateChannel*>(settingsMemory._data);
-        disabled = settings->useOverlayImage;
-    });
-    return disabled;
+    auto updatesChannel = reinterpret_cast<CameraSettingsUpdateChannel*>(instance->_settingsUpdateChannel->memory()._data);
+    // Keeps what this thread read last if the settings were being written during every attempt
+    static thread_local CameraSettings channelSettings;
+    updatesChannel->read(channelSettings);
+    return channelSettings.useOverlayImage;
 }
 
 bool VideoConferenceModule::getVirtualCameraInUse()
@@ -108,12 +109,8 @@ bool VideoConferenceModule::getVirtualCameraInUse()
     {
         return false;
     }
-    bool inUse = false;
-    instance->_settingsUpdateChannel->access([&inUse](auto settingsMemory) {
-        auto settings = reinterpret_cast<CameraSettingsUpdateChannel*>(settingsMemory._data);
-        inUse = settings->cameraInUse;
-    });
-    return inUse;
+    auto updatesChannel = reinterpret_cast<CameraSettingsUpdateChannel*>(instance->_settingsUpdateChannel->memory()._data);
+    return updatesChannel->cameraInUse.load(std::memory_order_relaxed);
 }
 
 LRESULT CALLBACK VideoConferenceModule::LowLevelKeyboardProc(int nCode, WPARAM wParam, LPARAM lParam)
@@ -535,8 +532,10 @@ void VideoConferenceModule::sendSourceCameraNameUpdate()
     }
     _settingsUpdateChannel->access([](auto memory) {
         auto updatesChannel = reinterpret_cast<CameraSettingsUpdateChannel*>(memory._data);
-        updatesChannel->sourceCameraName.emplace();
-        std::copy(begin(settings.selectedCamera), end(settings.selectedCamera), begin(*updatesChannel->sourceCameraName));
+        updatesChannel->update([](CameraSettings& channelSettings) {
+            channelSettings.sourceCameraName.emplace();
+            std::copy(begin(settings.selectedCamera), end(settings.selectedCamera), begin(*channelSettings.sourceCameraName));
+        });
     });
 }
 
@@ -562,7 +561,9 @@ void VideoConferenceModule::sendOverlayImageUpdate()
     const auto imageSize = static_cast<uint32_t>(_imageOverlayChannel->size());
     _settingsUpdateChannel->access([imageSize](auto memory) {
         auto updatesChannel = reinterpret_cast<CameraSettingsUpdateChannel*>(memory._data);
-        updatesChannel->overlayImageSize.emplace(imageSize);
-        updatesChannel->newOverlayImagePosted = true;
+        updatesChannel->update([imageSize](CameraSettings& channelSettings) {
+            channelSettings.overlayImageSize.emplace(imageSize);
+            ++channelSettings.overlayImageVersion;
+        });
     });
 }
@@ -0,0 +1,178 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <type_traits>
+
+enum class FrameDropPolicy
+{
+    // Deliver the most recent frame, the ones queued before it are overwritten
+    NewestWins,
+    // Deliver frames in order, the incoming ones are dropped while the queue is full
+    OldestWins,
+};
+
+struct FrameQueueStats
+{
+    uint64_t received = 0;
+    uint64_t delivered = 0;
+    uint64_t dropped = 0;
+    uint64_t overwritten = 0;
+    std::chrono::nanoseconds averageLatency{};
+    std::chrono::nanoseconds maxLatency{};
+};
+
+// Bounded queue between the capture thread, which is the only producer, and the filter worker, which is the only consumer.
+// Neither side takes a lock, so a slow downstream pin never blocks the capture thread. Frames are owned by the queue
+// while they're in it, whatever it hands back to the caller has to be released by the caller.
+template<typename Frame, size_t Capacity>
+class FrameQueue
+{
+    static_assert(std::is_pointer_v<Frame>);
+    static_assert(Capacity >= 2);
+
+public:
+    using clock = std::chrono::steady_clock;
+
+    struct QueuedFrame
+    {
+        Frame frame = nullptr;
+        clock::time_point queuedAt;
+    };
+
+    explicit FrameQueue(const FrameDropPolicy policy) noexcept :
+        _policy{ policy }
+    {
+    }
+
+    FrameQueue(const FrameQueue&) = delete;
+    FrameQueue& operator=(const FrameQueue&) = delete;
+
+    // Producer side. Returns the frame which didn't make it into the queue: the pushed one or the one it overwrote.
+    Frame Push(Frame frame) noexcept
+    {
+        _received.fetch_add(1, std::memory_order_relaxed);
+        const int64_t now = clock::now().time_since_epoch().count();
+        const uint64_t head = _head.load(std::memory_order_relaxed);
+        if (head - _tail.load(std::memory_order_acquire) < Capacity)
+        {
+            Publish(head, frame, now);
+            return nullptr;
+        }
+
+        if (_policy == FrameDropPolicy::OldestWins)
+        {
+            _dropped.fetch_add(1, std::memory_order_relaxed);
+            return frame;
+        }
+
+        // Full, replace the newest frame unless the consumer has taken it in the meantime
+        auto& newest = _slots[(head - 1) % Capacity];
+        newest.queuedAt.store(now, std::memory_order_relaxed);
+        if (Frame overwritten = newest.frame.exchange(frame, std::memory_order_acq_rel))
+        {
+            _overwritten.fetch_add(1, std::memory_order_relaxed);
+            return overwritten;
+        }
+
+        // It has, so the queue is empty. The consumer won't come back to that slot before the next lap, take the frame back.
+        Publish(head, newest.frame.exchange(nullptr, std::memory_order_acq_rel), now);
+        return nullptr;
+    }
+
+    // Consumer side. Frames overwritten by a newer one are handed to release.
+    template<typename Release>
+    std::optional<QueuedFrame> Pop(Release&& release) noexcept
+    {
+        uint64_t tail = _tail.load(std::memory_order_relaxed);
+        const uint64_t head = _head.load(std::memory_order_acquire);
+
+        std::optional<QueuedFrame> result;
+        while (tail != head && (!result || _policy == FrameDropPolicy::NewestWins))
+        {
+            auto& slot = _slots[tail++ % Capacity];
+            Frame frame = slot.frame.exchange(nullptr, std::memory_order_acq_rel);
+            const int64_t queuedAt = slot.queuedAt.load(std::memory_order_relaxed);
+            if (!frame)
+            {
+                continue;
+            }
+
+            if (result)
+            {
+                _overwritten.fetch_add(1, std::memory_order_relaxed);
+                release(result->frame);
+            }
+            result = QueuedFrame{ frame, clock::time_point{ clock::duration{ queuedAt } } };
+        }
+
+        _tail.store(tail, std::memory_order_release);
+        return result;
+    }
+
+    // Consumer side, a popped frame was sent downstream
+    void Delivered(const clock::time_point queuedAt) noexcept
+    {
+        const auto latency = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - queuedAt).count());
+        _totalLatency.store(_totalLatency.load(std::memory_order_relaxed) + latency, std::memory_order_relaxed);
+        if (latency > _maxLatency.load(std::memory_order_relaxed))
+        {
+            _maxLatency.store(latency, std::memory_order_relaxed);
+        }
+        _delivered.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Consumer side, a popped frame couldn't be sent downstream
+    void Dropped() noexcept
+    {
+        _dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // The counters are read independently, so they may be a frame apart while frames are flowing
+    FrameQueueStats Stats() const noexcept
+    {
+        FrameQueueStats stats;
+        stats.received = _received.load(std::memory_order_relaxed);
+        stats.delivered = _delivered.load(std::memory_order_relaxed);
+        stats.dropped = _dropped.load(std::memory_order_relaxed);
+        stats.overwritten = _overwritten.load(std::memory_order_relaxed);
+        if (stats.delivered)
+        {
+            stats.averageLatency = std::chrono::nanoseconds{ _totalLatency.load(std::memory_order_relaxed) / stats.delivered };
+        }
+        stats.maxLatency = std::chrono::nanoseconds{ _maxLatency.load(std::memory_order_relaxed) };
+        return stats;
+    }
+
+private:
+    struct Slot
+    {
+        std::atomic<Frame> frame = nullptr;
+        std::atomic<int64_t> queuedAt = 0;
+    };
+
+    void Publish(const uint64_t head, Frame frame, const int64_t queuedAt) noexcept
+    {
+        auto& slot = _slots[head % Capacity];
+        slot.queuedAt.store(queuedAt, std::memory_order_relaxed);
+        slot.frame.store(frame, std::memory_order_relaxed);
+        _head.store(head + 1, std::memory_order_release);
+    }
+
+    const FrameDropPolicy _policy;
+    std::array<Slot, Capacity> _slots;
+
+    // Written by the producer and the consumer respectively
+    std::atomic<uint64_t> _head = 0;
+    std::atomic<uint64_t> _tail = 0;
+
+    std::atomic<uint64_t> _received = 0;
+    std::atomic<uint64_t> _dropped = 0;
+    std::atomic<uint64_t> _overwritten = 0;
+    std::atomic<uint64_t> _delivered = 0;
+    std::atomic<uint64_t> _totalLatency = 0;
+    std::atomic<uint64_t> _maxLatency = 0;
+};
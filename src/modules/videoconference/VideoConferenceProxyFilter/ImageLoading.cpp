@@ -10,6 +10,8 @@
 #pragma warning(pop)
 
 #include <memory>
+#include <optional>
+#include <vector>
 #include <mfapi.h>
 #include <shcore.h>
 #include <algorithm>
@@ -25,6 +27,7 @@
 #include <shlwapi.h>
 
 #include "Logging.h"
+#include "PixelConversion.h"
 
 IWICImagingFactory* _GetWIC() noexcept
 {
@@ -41,80 +44,6 @@ IWICImagingFactory* _GetWIC() noexcept
     return s_Factory;
 }
 
-bool ReencodeJPGImage(BYTE* imageBuf, const DWORD imageSize, DWORD& reencodedSize)
-{
-    auto pWIC = _GetWIC();
-    wil::com_ptr_nothrow<IStream> imageStream = SHCreateMemStream(imageBuf, imageSize);
-    if (!imageStream)
-    {
-        return false;
-    }
-
-    // Decode jpg into bitmap
-    wil::com_ptr_nothrow<IWICBitmapDecoder> bitmapDecoder;
-    OK_OR_BAIL(pWIC->CreateDecoderFromStream(imageStream.get(), nullptr, WICDecodeMetadataCacheOnLoad, &bitmapDecoder));
-    wil::com_ptr_nothrow<IWICBitmapFrameDecode> decodedFrame;
-    OK_OR_BAIL(bitmapDecoder->GetFrame(0, &decodedFrame));
-    wil::com_ptr_nothrow<IWICBitmapSource> bitmap;
-    bitmap.attach(decodedFrame.detach());
-    UINT width = 0, height = 0;
-    OK_OR_BAIL(bitmap->GetSize(&width, &height));
-
-    // Initialize jpg encoder
-    wil::com_ptr_nothrow<IWICBitmapEncoder> encoder;
-    OK_OR_BAIL(pWIC->CreateEncoder(GUID_ContainerFormatJpeg, nullptr, &encoder));
-
-    wil::com_ptr_nothrow<IStream> outputStream;
-    OK_OR_BAIL(CreateStreamOnHGlobal(nullptr, true, &outputStream));
-    OK_OR_BAIL(encoder->Initialize(outputStream.get(), WICBitmapEncoderNoCache));
-    wil::com_ptr_nothrow<IWICBitmapFrameEncode> encodedFrame;
-    wil::com_ptr_nothrow<IPropertyBag2> encoderOptions;
-    OK_OR_BAIL(encoder->CreateNewFrame(&encodedFrame, &encoderOptions));
-
-    ULONG nProperties = 0;
-    OK_OR_BAIL(encoderOptions->CountProperties(&nProperties));
-    for (ULONG propIdx = 0; propIdx < nProperties; ++propIdx)
-    {
-        PROPBAG2 propBag{};
-        ULONG _;
-        OK_OR_BAIL(encoderOptions->GetPropertyInfo(propIdx, 1, &propBag, &_));
-        if (propBag.pstrName == std::wstring_view{ L"ImageQuality" })
-        {
-            wil::unique_variant variant;
-            variant.vt = VT_R4;
-            variant.fltVal = 0.1f;
-            OK_OR_BAIL(encoderOptions->Write(1, &propBag, &variant));
-            LOG("Successfully set jpg compression quality");
-            // skip the rest of the properties
-            propIdx = nProperties;
-        }
-        CoTaskMemFree(propBag.pstrName);
-    }
-
-    OK_OR_BAIL(encodedFrame->Initialize(encoderOptions.get()));
-    WICPixelFormatGUID intermediateFormat = GUID_WICPixelFormat24bppRGB;
-
-    OK_OR_BAIL(encodedFrame->SetPixelFormat(&intermediateFormat));
-    OK_OR_BAIL(encodedFrame->SetSize(width, height));
-
-    // Commit the image encoding
-    OK_OR_BAIL(encodedFrame->WriteSource(bitmap.get(), nullptr));
-    OK_OR_BAIL(encodedFrame->Commit());
-    OK_OR_BAIL(encoder->Commit());
-
-    STATSTG intermediateStreamStat{};
-    OK_OR_BAIL(outputStream->Stat(&intermediateStreamStat, STATFLAG_NONAME));
-    const ULONGLONG jpgStreamSize = intermediateStreamStat.cbSize.QuadPart;
-    HGLOBAL streamMemoryHandle{};
-    OK_OR_BAIL(GetHGlobalFromStream(outputStream.get(), &streamMemoryHandle));
-
-    auto jpgStreamMemory = static_cast<uint8_t*>(GlobalLock(streamMemoryHandle));
-    std::copy(jpgStreamMemory, jpgStreamMemory + jpgStreamSize, imageBuf);
-    auto unlockJpgStreamMemory = wil::scope_exit([jpgStreamMemory] { GlobalUnlock(jpgStreamMemory); });
-    reencodedSize = (DWORD)jpgStreamSize;
-    return true;
-}
-
 wil::com_ptr_nothrow<IWICBitmapSource> LoadAsRGB24BitmapWithSize(IWICImagingFactory* pWIC,
                                                                  wil::com_ptr_nothrow<IStream> image,
                                                                  const UINT targetWidth,
@@ -275,6 +204,8 @@ IMFSample* ConvertIMFVideoSample(const MFT_REGISTER_TYPE_INFO& inputType,
     intermediateFrameMediaType->SetUINT32(MF_MT_ALL_SAMPLES_INDEPENDENT, TRUE);
     OK_OR_BAIL(MFSetAttributeSize(intermediateFrameMediaType.get(), MF_MT_FRAME_SIZE, width, height));
     OK_OR_BAIL(MFSetAttributeRatio(intermediateFrameMediaType.get(), MF_MT_PIXEL_ASPECT_RATIO, width, height));
+    // WIC copies the rows top-down, the same orientation PixelConversion::ConvertBGR24 expects
+    OK_OR_BAIL(intermediateFrameMediaType->SetUINT32(MF_MT_DEFAULT_STRIDE, 3 * width));
     OK_OR_BAIL(videoTransformer->SetInputType(0, intermediateFrameMediaType.get(), 0));
     OK_OR_BAIL(videoTransformer->SetOutputType(0, outputMediaType, 0));
 
@@ -322,6 +253,60 @@ IMFSample* ConvertIMFVideoSample(const MFT_REGISTER_TYPE_INFO& inputType,
     return outputSamples.pSample;
 }
 
+std::optional<PixelConversion::Format> MapSubtypeToPixelFormat(const GUID& subtype)
+{
+    if (subtype == MFVideoFormat_YUY2)
+    {
+        return PixelConversion::Format::YUY2;
+    }
+    else if (subtype == MFVideoFormat_NV12)
+    {
+        return PixelConversion::Format::NV12;
+    }
+    else if (subtype == MFVideoFormat_I420)
+    {
+        return PixelConversion::Format::I420;
+    }
+    return std::nullopt;
+}
+
+wil::com_ptr_nothrow<IMFSample> ConvertRGB24Sample(IMFMediaBuffer* rgbBuffer,
+                                                   const PixelConversion::Format format,
+                                                   const UINT width,
+                                                   const UINT height)
+{
+    if (!PixelConversion::SupportsSize(format, width, height))
+    {
+        return nullptr;
+    }
+
+    wil::com_ptr_nothrow<IMFSample> sample;
+    OK_OR_BAIL(MFCreateSample(&sample));
+    OK_OR_BAIL(sample->SetUINT32(MF_MT_VIDEO_ROTATION, MFVideoRotationFormat::MFVideoRotationFormat_0));
+    OK_OR_BAIL(sample->SetSampleDuration(333333));
+    OK_OR_BAIL(sample->SetSampleTime(1));
+
+    const DWORD frameSize = static_cast<DWORD>(PixelConversion::FrameSize(format, width, height));
+    wil::com_ptr_nothrow<IMFMediaBuffer> frameBuffer;
+    OK_OR_BAIL(MFCreateAlignedMemoryBuffer(frameSize, MF_64_BYTE_ALIGNMENT, &frameBuffer));
+
+    BYTE* rgbData = nullptr;
+    OK_OR_BAIL(rgbBuffer->Lock(&rgbData, nullptr, nullptr));
+    auto unlockRGB = wil::scope_exit([rgbBuffer] { rgbBuffer->Unlock(); });
+    BYTE* frameData = nullptr;
+    OK_OR_BAIL(frameBuffer->Lock(&frameData, nullptr, nullptr));
+    const bool converted = PixelConversion::ConvertBGR24(rgbData, 3 * static_cast<size_t>(width), width, height, format, frameData);
+    OK_OR_BAIL(frameBuffer->Unlock());
+    if (!converted)
+    {
+        return nullptr;
+    }
+
+    OK_OR_BAIL(frameBuffer->SetCurrentLength(frameSize));
+    OK_OR_BAIL(sample->AddBuffer(frameBuffer.get()));
+    return sample;
+}
+
 wil::com_ptr_nothrow<IMFSample> LoadImageAsSample(wil::com_ptr_nothrow<IStream> imageStream,
                                                   IMFMediaType* sampleMediaType,
                                                   const float quality) noexcept
@@ -415,10 +400,76 @@ wil::com_ptr_nothrow<IMFSample> LoadImageAsSample(wil::com_ptr_nothrow<IStream>
         return jpgSample;
     }
 
+    // Raw YUV formats don't need a transform, WIC already gave us the pixels at the frame size
+    if (const auto pixelFormat = MapSubtypeToPixelFormat(outputType.guidSubtype))
+    {
+        if (auto convertedSample = ConvertRGB24Sample(outputMediaBuffer, *pixelFormat, targetWidth, targetHeight))
+        {
+            return convertedSample;
+        }
+    }
+
     // Now we are ready to convert it to the requested media type
     MFT_REGISTER_TYPE_INFO intermediateType = { MFMediaType_Video, MFVideoFormat_RGB24 };
 
     // But if no conversion is needed, just return the input sample
 
     return ConvertIMFVideoSample(intermediateType, sampleMediaType, outputSample, targetWidth, targetHeight);
-}
\ No newline at end of file
+}
+
+std::vector<uint8_t> PrepareOverlayFrame(wil::com_ptr_nothrow<IStream> imageStream,
+                                         IMFMediaType* frameMediaType,
+                                         const size_t maxFrameSize) noexcept
+try
+{
+    if (!imageStream)
+    {
+        return {};
+    }
+
+    GUID subtype{};
+    OK_OR_BAIL(frameMediaType->GetGUID(MF_MT_SUBTYPE, &subtype));
+
+    // Only jpg frames change size with quality, lower it until the image fits into the frame buffer
+    constexpr std::array<float, 3> jpgQualityModes = { 0.5f, 0.25f, 0.1f };
+    for (const float quality : jpgQualityModes)
+    {
+        LARGE_INTEGER streamStart{};
+        OK_OR_BAIL(imageStream->Seek(streamStart, STREAM_SEEK_SET, nullptr));
+
+        auto sample = LoadImageAsSample(imageStream, frameMediaType, quality);
+        wil::com_ptr_nothrow<IMFMediaBuffer> sampleBuffer;
+        if (!sample || FAILED(sample->ConvertToContiguousBuffer(&sampleBuffer)))
+        {
+            LOG("PrepareOverlayFrame FAILED to load the image");
+            return {};
+        }
+
+        BYTE* sampleData = nullptr;
+        DWORD sampleSize = 0;
+        OK_OR_BAIL(sampleBuffer->Lock(&sampleData, nullptr, &sampleSize));
+        auto unlockSample = wil::scope_exit([&sampleBuffer] { sampleBuffer->Unlock(); });
+
+        if (!maxFrameSize || sampleSize <= maxFrameSize)
+        {
+            return std::vector<uint8_t>(sampleData, sampleData + sampleSize);
+        }
+
+        char buf[512]{};
+        sprintf_s(buf, "PrepareOverlayFrame: image size %lu is larger than frame size %zu with quality %f", sampleSize, maxFrameSize, quality);
+        LOG(buf);
+
+        if (subtype != MFVideoFormat_MJPG)
+        {
+            break;
+        }
+    }
+
+    LOG("Couldn't fit the overlay image into a frame with all available quality modes.");
+    return {};
+}
+catch (...)
+{
+    LOG("PrepareOverlayFrame FAILED with an exception");
+    return {};
+}
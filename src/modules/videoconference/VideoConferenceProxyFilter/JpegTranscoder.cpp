@@ -0,0 +1,230 @@
+#include "JpegTranscoder.h"
+
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <unknwn.h>
+#include <winrt/base.h>
+
+#pragma warning(push)
+#pragma warning(disable : 4005)
+#include <wincodec.h>
+#pragma warning(pop)
+
+#include <algorithm>
+#include <vector>
+
+#include <wil/com.h>
+
+#include "Logging.h"
+
+IWICImagingFactory* _GetWIC() noexcept;
+
+namespace
+{
+    // IStream over memory the transcoder doesn't own, so the codecs read and write frames without intermediate copies
+    struct SpanStream : winrt::implements<SpanStream, IStream>
+    {
+        void Reset(uint8_t* data, const size_t size, const size_t capacity) noexcept
+        {
+            _data = data;
+            _size = size;
+            _capacity = capacity;
+            _position = 0;
+        }
+
+        size_t Size() const noexcept
+        {
+            return _size;
+        }
+
+        HRESULT STDMETHODCALLTYPE Read(void* pv, ULONG cb, ULONG* pcbRead) override
+        {
+            const size_t count = _position < _size ? std::min<size_t>(cb, _size - _position) : 0;
+            std::copy_n(_data + _position, count, static_cast<uint8_t*>(pv));
+            _position += count;
+            if (pcbRead)
+            {
+                *pcbRead = static_cast<ULONG>(count);
+            }
+            return count == cb ? S_OK : S_FALSE;
+        }
+
+        HRESULT STDMETHODCALLTYPE Write(const void* pv, ULONG cb, ULONG* pcbWritten) override
+        {
+            if (_position > _capacity || cb > _capacity - _position)
+            {
+                return STG_E_MEDIUMFULL;
+            }
+
+            std::copy_n(static_cast<const uint8_t*>(pv), cb, _data + _position);
+            _position += cb;
+            _size = std::max(_size, _position);
+            if (pcbWritten)
+            {
+                *pcbWritten = cb;
+            }
+            return S_OK;
+        }
+
+        HRESULT STDMETHODCALLTYPE Seek(LARGE_INTEGER dlibMove, DWORD dwOrigin, ULARGE_INTEGER* plibNewPosition) override
+        {
+            int64_t origin = 0;
+            switch (dwOrigin)
+            {
+            case STREAM_SEEK_SET:
+                break;
+            case STREAM_SEEK_CUR:
+                origin = static_cast<int64_t>(_position);
+                break;
+            case STREAM_SEEK_END:
+                origin = static_cast<int64_t>(_size);
+                break;
+            default:
+                return STG_E_INVALIDFUNCTION;
+            }
+
+            const int64_t position = origin + dlibMove.QuadPart;
+            if (position < 0 || static_cast<uint64_t>(position) > std::max(_size, _capacity))
+            {
+                return STG_E_INVALIDFUNCTION;
+            }
+
+            _position = static_cast<size_t>(position);
+            if (plibNewPosition)
+            {
+                plibNewPosition->QuadPart = _position;
+            }
+            return S_OK;
+        }
+
+        HRESULT STDMETHODCALLTYPE SetSize(ULARGE_INTEGER libNewSize) override
+        {
+            if (libNewSize.QuadPart > _capacity)
+            {
+                return STG_E_MEDIUMFULL;
+            }
+
+            _size = static_cast<size_t>(libNewSize.QuadPart);
+            return S_OK;
+        }
+
+        HRESULT STDMETHODCALLTYPE Stat(STATSTG* pstatstg, DWORD) override
+        {
+            if (!pstatstg)
+            {
+                return STG_E_INVALIDPOINTER;
+            }
+
+            *pstatstg = {};
+            pstatstg->type = STGTY_STREAM;
+            pstatstg->cbSize.QuadPart = _size;
+            return S_OK;
+        }
+
+        HRESULT STDMETHODCALLTYPE Commit(DWORD) override { return S_OK; }
+        HRESULT STDMETHODCALLTYPE CopyTo(IStream*, ULARGE_INTEGER, ULARGE_INTEGER*, ULARGE_INTEGER*) override { return E_NOTIMPL; }
+        HRESULT STDMETHODCALLTYPE Revert() override { return E_NOTIMPL; }
+        HRESULT STDMETHODCALLTYPE LockRegion(ULARGE_INTEGER, ULARGE_INTEGER, DWORD) override { return STG_E_INVALIDFUNCTION; }
+        HRESULT STDMETHODCALLTYPE UnlockRegion(ULARGE_INTEGER, ULARGE_INTEGER, DWORD) override { return STG_E_INVALIDFUNCTION; }
+        HRESULT STDMETHODCALLTYPE Clone(IStream**) override { return E_NOTIMPL; }
+
+    private:
+        uint8_t* _data = nullptr;
+        size_t _size = 0;
+        size_t _capacity = 0;
+        size_t _position = 0;
+    };
+
+    class WICJpegTranscoder final : public JpegTranscoder
+    {
+    public:
+        WICJpegTranscoder(IWICImagingFactory* wic, const float quality) :
+            _wic{ wic }
+        {
+            _qualityOption.dwType = PROPBAG2_TYPE_DATA;
+            _qualityOption.vt = VT_R4;
+            _qualityOption.pstrName = const_cast<LPOLESTR>(L"ImageQuality");
+            _qualityValue.vt = VT_R4;
+            _qualityValue.fltVal = quality;
+        }
+
+        size_t Reencode(uint8_t* frame, const size_t size, const size_t capacity) noexcept override
+        {
+            // The image is decoded from a copy, since WIC decodes while the new one is being written over it
+            try
+            {
+                _jpg.assign(frame, frame + size);
+            }
+            catch (...)
+            {
+                return 0;
+            }
+
+            const size_t reencodedSize = Transcode(frame, capacity);
+            if (!reencodedSize)
+            {
+                std::copy(_jpg.begin(), _jpg.end(), frame);
+            }
+            return reencodedSize;
+        }
+
+    private:
+        size_t Transcode(uint8_t* frame, const size_t capacity) noexcept
+        {
+            _input->Reset(_jpg.data(), _jpg.size(), _jpg.size());
+            _output->Reset(frame, 0, capacity);
+
+            // WIC codecs can't be re-initialized, but creating the jpg ones directly skips the container detection
+            wil::com_ptr_nothrow<IWICBitmapDecoder> decoder;
+            OK_OR_BAIL(_wic->CreateDecoder(GUID_ContainerFormatJpeg, nullptr, &decoder));
+            OK_OR_BAIL(decoder->Initialize(_input.get(), WICDecodeMetadataCacheOnDemand));
+            wil::com_ptr_nothrow<IWICBitmapFrameDecode> decodedFrame;
+            OK_OR_BAIL(decoder->GetFrame(0, &decodedFrame));
+            UINT width = 0, height = 0;
+            OK_OR_BAIL(decodedFrame->GetSize(&width, &height));
+
+            wil::com_ptr_nothrow<IWICBitmapEncoder> encoder;
+            OK_OR_BAIL(_wic->CreateEncoder(GUID_ContainerFormatJpeg, nullptr, &encoder));
+            OK_OR_BAIL(encoder->Initialize(_output.get(), WICBitmapEncoderNoCache));
+            wil::com_ptr_nothrow<IWICBitmapFrameEncode> encodedFrame;
+            wil::com_ptr_nothrow<IPropertyBag2> encoderOptions;
+            OK_OR_BAIL(encoder->CreateNewFrame(&encodedFrame, &encoderOptions));
+            OK_OR_BAIL(encoderOptions->Write(1, &_qualityOption, &_qualityValue));
+            OK_OR_BAIL(encodedFrame->Initialize(encoderOptions.get()));
+
+            WICPixelFormatGUID pixelFormat = GUID_WICPixelFormat24bppBGR;
+            OK_OR_BAIL(encodedFrame->SetPixelFormat(&pixelFormat));
+            OK_OR_BAIL(encodedFrame->SetSize(width, height));
+            OK_OR_BAIL(encodedFrame->WriteSource(decodedFrame.get(), nullptr));
+            OK_OR_BAIL(encodedFrame->Commit());
+            OK_OR_BAIL(encoder->Commit());
+
+            return _output->Size();
+        }
+
+        IWICImagingFactory* _wic = nullptr;
+        winrt::com_ptr<SpanStream> _input = winrt::make_self<SpanStream>();
+        winrt::com_ptr<SpanStream> _output = winrt::make_self<SpanStream>();
+        std::vector<uint8_t> _jpg;
+        PROPBAG2 _qualityOption{};
+        VARIANT _qualityValue{};
+    };
+}
+
+std::unique_ptr<JpegTranscoder> CreateWICJpegTranscoder(const float quality) noexcept
+try
+{
+    auto wic = _GetWIC();
+    if (!wic)
+    {
+        LOG("CreateWICJpegTranscoder FAILED to create IWICImagingFactory");
+        return nullptr;
+    }
+
+    return std::make_unique<WICJpegTranscoder>(wic, quality);
+}
+catch (...)
+{
+    LOG("CreateWICJpegTranscoder FAILED with an exception");
+    return nullptr;
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// Re-encodes MJPG frames in place. Implementations keep their codec state and buffers between frames,
+// so a transcoder is meant to live as long as the stream, and to be used from a single thread.
+class JpegTranscoder
+{
+public:
+    virtual ~JpegTranscoder() = default;
+
+    // Re-encodes the jpg image in frame[0, size) back into frame, writing at most capacity bytes.
+    // Returns the size of the new image, or 0 when it couldn't be re-encoded, leaving the frame as it was.
+    virtual size_t Reencode(uint8_t* frame, size_t size, size_t capacity) noexcept = 0;
+};
+
+// Windows Imaging Component backend, quality is in the [0, 1] range WIC uses
+std::unique_ptr<JpegTranscoder> CreateWICJpegTranscoder(float quality) noexcept;
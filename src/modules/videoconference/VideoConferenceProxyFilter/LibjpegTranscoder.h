@@ -0,0 +1,174 @@
+#pragma once
+
+// Portable backend for the libjpeg API, as implemented by libjpeg-turbo. It isn't part of the filter,
+// VideoConferenceTests builds it to test and benchmark the transcoding path headless.
+#if __has_include(<jpeglib.h>)
+
+#include "JpegTranscoder.h"
+
+#include <algorithm>
+#include <csetjmp>
+#include <cstdio>
+#include <new>
+#include <vector>
+
+#include <jpeglib.h>
+
+class LibjpegTranscoder final : public JpegTranscoder
+{
+public:
+    explicit LibjpegTranscoder(const float quality) noexcept :
+        _quality{ std::clamp(static_cast<int>(quality * 100.f + 0.5f), 1, 100) }
+    {
+        _decoder.err = jpeg_std_error(&_errors.manager);
+        _encoder.err = &_errors.manager;
+        _errors.manager.error_exit = &ErrorExit;
+        _errors.manager.output_message = [](j_common_ptr) {};
+        jpeg_create_decompress(&_decoder);
+        jpeg_create_compress(&_encoder);
+
+        _destination.manager.init_destination = &InitDestination;
+        _destination.manager.empty_output_buffer = &EmptyOutputBuffer;
+        _destination.manager.term_destination = &TermDestination;
+        _encoder.dest = &_destination.manager;
+    }
+
+    ~LibjpegTranscoder()
+    {
+        jpeg_destroy_compress(&_encoder);
+        jpeg_destroy_decompress(&_decoder);
+    }
+
+    LibjpegTranscoder(const LibjpegTranscoder&) = delete;
+    LibjpegTranscoder& operator=(const LibjpegTranscoder&) = delete;
+
+    size_t Reencode(uint8_t* frame, const size_t size, const size_t capacity) noexcept override
+    {
+        // The image is decoded from a copy, since the new one is written over it while decoding
+        try
+        {
+            _jpg.assign(frame, frame + size);
+        }
+        catch (...)
+        {
+            return 0;
+        }
+
+        _destination.frame = frame;
+        _destination.capacity = capacity;
+        _destination.written = 0;
+        if (!Transcode())
+        {
+            jpeg_abort_compress(&_encoder);
+            jpeg_abort_decompress(&_decoder);
+            std::copy(_jpg.begin(), _jpg.end(), frame);
+            return 0;
+        }
+
+        return _destination.written;
+    }
+
+private:
+    struct ErrorManager
+    {
+        jpeg_error_mgr manager;
+        std::jmp_buf jump;
+    };
+
+    // Writes straight into the frame, running out of space is an error
+    struct Destination
+    {
+        jpeg_destination_mgr manager;
+        uint8_t* frame = nullptr;
+        size_t capacity = 0;
+        size_t written = 0;
+    };
+
+    static void ErrorExit(j_common_ptr info)
+    {
+        std::longjmp(reinterpret_cast<ErrorManager*>(info->err)->jump, 1);
+    }
+
+    static void InitDestination(j_compress_ptr info)
+    {
+        auto destination = reinterpret_cast<Destination*>(info->dest);
+        destination->manager.next_output_byte = destination->frame;
+        destination->manager.free_in_buffer = destination->capacity;
+    }
+
+    static boolean EmptyOutputBuffer(j_compress_ptr info)
+    {
+        (*info->err->error_exit)(reinterpret_cast<j_common_ptr>(info));
+        return FALSE;
+    }
+
+    static void TermDestination(j_compress_ptr info)
+    {
+        auto destination = reinterpret_cast<Destination*>(info->dest);
+        destination->written = destination->capacity - destination->manager.free_in_buffer;
+    }
+
+    bool ResizeRow(const size_t size) noexcept
+    {
+        try
+        {
+            _row.resize(size);
+            return true;
+        }
+        catch (...)
+        {
+            return false;
+        }
+    }
+
+    // Decodes and encodes one row at a time. Nothing here may need destruction, errors longjmp out of it.
+    bool Transcode() noexcept
+    {
+        if (setjmp(_errors.jump))
+        {
+            return false;
+        }
+
+        jpeg_mem_src(&_decoder, _jpg.data(), static_cast<unsigned long>(_jpg.size()));
+        jpeg_read_header(&_decoder, TRUE);
+        jpeg_start_decompress(&_decoder);
+        if (!ResizeRow(static_cast<size_t>(_decoder.output_width) * _decoder.output_components))
+        {
+            return false;
+        }
+
+        _encoder.image_width = _decoder.output_width;
+        _encoder.image_height = _decoder.output_height;
+        _encoder.input_components = _decoder.output_components;
+        _encoder.in_color_space = _decoder.out_color_space;
+        jpeg_set_defaults(&_encoder);
+        jpeg_set_quality(&_encoder, _quality, TRUE);
+        jpeg_start_compress(&_encoder, TRUE);
+
+        JSAMPROW row = _row.data();
+        while (_decoder.output_scanline < _decoder.output_height)
+        {
+            jpeg_read_scanlines(&_decoder, &row, 1);
+            jpeg_write_scanlines(&_encoder, &row, 1);
+        }
+
+        jpeg_finish_compress(&_encoder);
+        jpeg_finish_decompress(&_decoder);
+        return true;
+    }
+
+    const int _quality;
+    ErrorManager _errors{};
+    Destination _destination{};
+    jpeg_decompress_struct _decoder{};
+    jpeg_compress_struct _encoder{};
+    std::vector<uint8_t> _jpg;
+    std::vector<JSAMPLE> _row;
+};
+
+inline std::unique_ptr<JpegTranscoder> CreateLibjpegTranscoder(const float quality) noexcept
+{
+    return std::unique_ptr<JpegTranscoder>{ new (std::nothrow) LibjpegTranscoder(quality) };
+}
+
+#endif
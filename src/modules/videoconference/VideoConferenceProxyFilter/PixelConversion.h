@@ -0,0 +1,276 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <new>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define PIXEL_CONVERSION_X86
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define PIXEL_CONVERSION_TARGET_SSSE3
+#else
+#define PIXEL_CONVERSION_TARGET_SSSE3 __attribute__((target("ssse3")))
+#endif
+#endif
+
+// Converts the BGR24 rows WIC decodes into the raw YUV formats cameras deliver.
+// Doesn't depend on Windows, so the same code runs wherever the overlay frames are prepared.
+namespace PixelConversion
+{
+    enum class Format
+    {
+        YUY2,
+        NV12,
+        I420,
+    };
+
+    // Size of a tightly packed frame, the same as the default stride media buffers have
+    constexpr size_t FrameSize(const Format format, const uint32_t width, const uint32_t height) noexcept
+    {
+        const size_t pixels = static_cast<size_t>(width) * height;
+        return format == Format::YUY2 ? pixels * 2 : pixels + pixels / 2;
+    }
+
+    constexpr bool SupportsSize(const Format format, const uint32_t width, const uint32_t height) noexcept
+    {
+        // Chroma is shared by pixel pairs, and by rows pairs in the 4:2:0 formats
+        return width > 0 && height > 0 && width % 2 == 0 && (format == Format::YUY2 || height % 2 == 0);
+    }
+
+    // Converts a row of BGR24 pixels into luma and chroma averaged over horizontal pixel pairs
+    using RowConverter = void (*)(const uint8_t* bgr, uint32_t width, uint8_t* y, uint8_t* u, uint8_t* v) noexcept;
+
+    namespace Detail
+    {
+        // BT.601 studio range, the way the Media Foundation color converter maps RGB for webcam resolutions
+        constexpr int32_t LumaB = 25, LumaG = 129, LumaR = 66;
+        constexpr int32_t CbB = 112, CbG = -74, CbR = -38;
+        constexpr int32_t CrB = -18, CrG = -94, CrR = 112;
+
+        constexpr uint8_t Component(const int32_t b, const int32_t g, const int32_t r, const int32_t cb, const int32_t cg, const int32_t cr, const int32_t offset) noexcept
+        {
+            return static_cast<uint8_t>(((cb * b + cg * g + cr * r + 128) >> 8) + offset);
+        }
+
+        constexpr uint8_t Average(const uint32_t first, const uint32_t second) noexcept
+        {
+            return static_cast<uint8_t>((first + second + 1) >> 1);
+        }
+
+        inline void ConvertRowScalar(const uint8_t* bgr, const uint32_t begin, const uint32_t width, uint8_t* y, uint8_t* u, uint8_t* v) noexcept
+        {
+            for (uint32_t x = begin; x < width; x += 2)
+            {
+                const uint8_t* pair = bgr + x * 3;
+                y[x] = Component(pair[0], pair[1], pair[2], LumaB, LumaG, LumaR, 16);
+                y[x + 1] = Component(pair[3], pair[4], pair[5], LumaB, LumaG, LumaR, 16);
+                u[x / 2] = Average(Component(pair[0], pair[1], pair[2], CbB, CbG, CbR, 128),
+                                   Component(pair[3], pair[4], pair[5], CbB, CbG, CbR, 128));
+                v[x / 2] = Average(Component(pair[0], pair[1], pair[2], CrB, CrG, CrR, 128),
+                                   Component(pair[3], pair[4], pair[5], CrB, CrG, CrR, 128));
+            }
+        }
+
+        inline void AverageRows(const uint8_t* first, const uint8_t* second, const uint32_t size, uint8_t* result) noexcept
+        {
+            uint32_t i = 0;
+#if defined(PIXEL_CONVERSION_X86)
+            for (; i + 16 <= size; i += 16)
+            {
+                const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first + i));
+                const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(second + i));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(result + i), _mm_avg_epu8(a, b));
+            }
+#endif
+            for (; i < size; ++i)
+            {
+                result[i] = Average(first[i], second[i]);
+            }
+        }
+
+        // Writes Y0 U Y1 V for every pixel pair
+        inline void InterleaveYUY2(const uint8_t* y, const uint8_t* u, const uint8_t* v, const uint32_t width, uint8_t* yuy2) noexcept
+        {
+            uint32_t x = 0;
+#if defined(PIXEL_CONVERSION_X86)
+            for (; x + 16 <= width; x += 16)
+            {
+                const __m128i luma = _mm_loadu_si128(reinterpret_cast<const __m128i*>(y + x));
+                const __m128i chroma = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(u + x / 2)),
+                                                         _mm_loadl_epi64(reinterpret_cast<const __m128i*>(v + x / 2)));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(yuy2 + x * 2), _mm_unpacklo_epi8(luma, chroma));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(yuy2 + x * 2 + 16), _mm_unpackhi_epi8(luma, chroma));
+            }
+#endif
+            for (; x < width; x += 2)
+            {
+                yuy2[x * 2] = y[x];
+                yuy2[x * 2 + 1] = u[x / 2];
+                yuy2[x * 2 + 2] = y[x + 1];
+                yuy2[x * 2 + 3] = v[x / 2];
+            }
+        }
+
+        inline void InterleaveNV12(const uint8_t* u, const uint8_t* v, const uint32_t size, uint8_t* uv) noexcept
+        {
+            uint32_t i = 0;
+#if defined(PIXEL_CONVERSION_X86)
+            for (; i + 16 <= size; i += 16)
+            {
+                const __m128i cb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(u + i));
+                const __m128i cr = _mm_loadu_si128(reinterpret_cast<const __m128i*>(v + i));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(uv + i * 2), _mm_unpacklo_epi8(cb, cr));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(uv + i * 2 + 16), _mm_unpackhi_epi8(cb, cr));
+            }
+#endif
+            for (; i < size; ++i)
+            {
+                uv[i * 2] = u[i];
+                uv[i * 2 + 1] = v[i];
+            }
+        }
+
+#if defined(PIXEL_CONVERSION_X86)
+        // Weighted sums of 4 pixels, laid out as 16-bit (B, G) pairs and R values
+        PIXEL_CONVERSION_TARGET_SSSE3 inline __m128i WeightedSum(const __m128i bg, const __m128i r, const int32_t cb, const int32_t cg, const int32_t cr) noexcept
+        {
+            const __m128i bgWeights = _mm_set1_epi32(static_cast<int32_t>((static_cast<uint32_t>(cg) << 16) | static_cast<uint16_t>(cb)));
+            const __m128i sum = _mm_add_epi32(_mm_madd_epi16(bg, bgWeights), _mm_madd_epi16(r, _mm_set1_epi32(cr)));
+            return _mm_srai_epi32(_mm_add_epi32(sum, _mm_set1_epi32(128)), 8);
+        }
+
+        // 8 components as 16-bit values
+        PIXEL_CONVERSION_TARGET_SSSE3 inline __m128i Components(const __m128i bg0, const __m128i r0, const __m128i bg1, const __m128i r1, const int32_t cb, const int32_t cg, const int32_t cr, const int16_t offset) noexcept
+        {
+            const __m128i sums = _mm_packs_epi32(WeightedSum(bg0, r0, cb, cg, cr), WeightedSum(bg1, r1, cb, cg, cr));
+            return _mm_add_epi16(sums, _mm_set1_epi16(offset));
+        }
+
+        // Averages horizontal pairs of 8 components, giving 4 bytes
+        PIXEL_CONVERSION_TARGET_SSSE3 inline void StorePairAverages(const __m128i components, uint8_t* result) noexcept
+        {
+            const __m128i sums = _mm_madd_epi16(components, _mm_set1_epi16(1));
+            const __m128i averages = _mm_srli_epi32(_mm_add_epi32(sums, _mm_set1_epi32(1)), 1);
+            const int32_t packed = _mm_cvtsi128_si32(_mm_packus_epi16(_mm_packs_epi32(averages, averages), _mm_setzero_si128()));
+            std::memcpy(result, &packed, sizeof(packed));
+        }
+
+        PIXEL_CONVERSION_TARGET_SSSE3 inline void ConvertRowSSSE3(const uint8_t* bgr, const uint32_t width, uint8_t* y, uint8_t* u, uint8_t* v) noexcept
+        {
+            const __m128i bgShuffle = _mm_setr_epi8(0, -1, 1, -1, 3, -1, 4, -1, 6, -1, 7, -1, 9, -1, 10, -1);
+            const __m128i rShuffle = _mm_setr_epi8(2, -1, -1, -1, 5, -1, -1, -1, 8, -1, -1, -1, 11, -1, -1, -1);
+
+            uint32_t x = 0;
+            // The second load reads 4 bytes past the 8 pixels
+            for (; (x + 8) * 3 + 4 <= width * 3; x += 8)
+            {
+                const __m128i first = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bgr + x * 3));
+                const __m128i second = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bgr + x * 3 + 12));
+                const __m128i bg0 = _mm_shuffle_epi8(first, bgShuffle);
+                const __m128i r0 = _mm_shuffle_epi8(first, rShuffle);
+                const __m128i bg1 = _mm_shuffle_epi8(second, bgShuffle);
+                const __m128i r1 = _mm_shuffle_epi8(second, rShuffle);
+
+                const __m128i luma = Components(bg0, r0, bg1, r1, LumaB, LumaG, LumaR, 16);
+                _mm_storel_epi64(reinterpret_cast<__m128i*>(y + x), _mm_packus_epi16(luma, luma));
+                StorePairAverages(Components(bg0, r0, bg1, r1, CbB, CbG, CbR, 128), u + x / 2);
+                StorePairAverages(Components(bg0, r0, bg1, r1, CrB, CrG, CrR, 128), v + x / 2);
+            }
+
+            ConvertRowScalar(bgr, x, width, y, u, v);
+        }
+
+        inline bool HasSSSE3() noexcept
+        {
+#if defined(_MSC_VER)
+            int info[4]{};
+            __cpuid(info, 1);
+            return (info[2] & (1 << 9)) != 0;
+#else
+            return __builtin_cpu_supports("ssse3");
+#endif
+        }
+#endif
+    }
+
+    inline void ConvertRowScalar(const uint8_t* bgr, const uint32_t width, uint8_t* y, uint8_t* u, uint8_t* v) noexcept
+    {
+        Detail::ConvertRowScalar(bgr, 0, width, y, u, v);
+    }
+
+    inline RowConverter BestRowConverter() noexcept
+    {
+#if defined(PIXEL_CONVERSION_X86)
+        static const bool hasSSSE3 = Detail::HasSSSE3();
+        if (hasSSSE3)
+        {
+            return &Detail::ConvertRowSSSE3;
+        }
+#endif
+        return &ConvertRowScalar;
+    }
+
+    // Converts top-down BGR24 rows into a tightly packed frame of FrameSize bytes
+    inline bool ConvertBGR24(const uint8_t* bgr,
+                             const size_t stride,
+                             const uint32_t width,
+                             const uint32_t height,
+                             const Format format,
+                             uint8_t* frame,
+                             const RowConverter convertRow = BestRowConverter()) noexcept
+    {
+        if (!bgr || !frame || !SupportsSize(format, width, height))
+        {
+            return false;
+        }
+
+        // Luma and chroma of two rows, so the 4:2:0 formats can average them vertically
+        const size_t chromaWidth = width / 2;
+        std::unique_ptr<uint8_t[]> scratch{ new (std::nothrow) uint8_t[width * 2 + chromaWidth * 4] };
+        if (!scratch)
+        {
+            return false;
+        }
+
+        uint8_t* y[2] = { scratch.get(), scratch.get() + width };
+        uint8_t* u[2] = { y[1] + width, y[1] + width + chromaWidth };
+        uint8_t* v[2] = { u[1] + chromaWidth, u[1] + chromaWidth * 2 };
+
+        if (format == Format::YUY2)
+        {
+            for (uint32_t row = 0; row < height; ++row)
+            {
+                convertRow(bgr + row * stride, width, y[0], u[0], v[0]);
+                Detail::InterleaveYUY2(y[0], u[0], v[0], width, frame + static_cast<size_t>(row) * width * 2);
+            }
+            return true;
+        }
+
+        const size_t lumaSize = static_cast<size_t>(width) * height;
+        uint8_t* chromaPlane = frame + lumaSize;
+        for (uint32_t row = 0; row < height; row += 2)
+        {
+            uint8_t* lumaRow = frame + static_cast<size_t>(row) * width;
+            convertRow(bgr + row * stride, width, lumaRow, u[0], v[0]);
+            convertRow(bgr + (row + 1) * stride, width, lumaRow + width, u[1], v[1]);
+
+            const size_t chromaRow = row / 2;
+            if (format == Format::NV12)
+            {
+                Detail::AverageRows(u[0], u[1], static_cast<uint32_t>(chromaWidth), u[0]);
+                Detail::AverageRows(v[0], v[1], static_cast<uint32_t>(chromaWidth), v[0]);
+                Detail::InterleaveNV12(u[0], v[0], static_cast<uint32_t>(chromaWidth), chromaPlane + chromaRow * width);
+            }
+            else
+            {
+                Detail::AverageRows(u[0], u[1], static_cast<uint32_t>(chromaWidth), chromaPlane + chromaRow * chromaWidth);
+                Detail::AverageRows(v[0], v[1], static_cast<uint32_t>(chromaWidth), chromaPlane + lumaSize / 4 + chromaRow * chromaWidth);
+            }
+        }
+        return true;
+    }
+}
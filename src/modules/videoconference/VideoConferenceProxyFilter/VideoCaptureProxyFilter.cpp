@@ -1,10 +1,12 @@
 #include "VideoCaptureProxyFilter.h"
 
+#include "JpegTranscoder.h"
 #include "VideoCaptureDevice.h"
 #include <mfidl.h>
 #include <Shlwapi.h>
 #include <mfapi.h>
 #include <fstream>
+#include <future>
 
 constexpr static inline wchar_t FILTER_NAME[] = L"PowerToysVCMProxyFilter";
 constexpr static inline wchar_t PIN_NAME[] = L"PowerToysVCMProxyPIN";
@@ -12,7 +14,6 @@ constexpr static inline wchar_t VENDOR[] = L"Microsoft Corporation";
 
 namespace
 {
-    constexpr float initialJpgQuality = 0.5f;
     constexpr std::array<unsigned char, 3> overlayColor = { 0, 0, 0 };
     // clang-format off
     unsigned char bmpPixelData[58] = {
@@ -23,6 +24,32 @@ namespace
 	      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, overlayColor[0], overlayColor[1], overlayColor[2], 0x00
     };
     // clang-format on
+
+    void LogFrameQueueStats(const FrameQueueStats& stats)
+    {
+        using ms = std::chrono::duration<double, std::milli>;
+        char buf[512]{};
+        sprintf_s(buf,
+                  "Frames received %llu, delivered %llu, dropped %llu, overwritten %llu, latency average %.2f ms, max %.2f ms",
+                  stats.received,
+                  stats.delivered,
+                  stats.dropped,
+                  stats.overwritten,
+                  ms(stats.averageLatency).count(),
+                  ms(stats.maxLatency).count());
+        LOG(buf);
+    }
+
+    size_t GetFrameBufferSize(IMemAllocator* allocator)
+    {
+        ALLOCATOR_PROPERTIES properties{};
+        if (!allocator || FAILED(allocator->GetProperties(&properties)) || properties.cbBuffer <= 0)
+        {
+            return 0;
+        }
+
+        return static_cast<size_t>(properties.cbBuffer);
+    }
 }
 
 wil::com_ptr_nothrow<IMemAllocator> VideoCaptureProxyPin::FindAllocator()
@@ -36,10 +63,9 @@ wil::com_ptr_nothrow<IMemAllocator> VideoCaptureProxyPin::FindAllocator()
     return allocator;
 }
 
-wil::com_ptr_nothrow<IMFSample> LoadImageAsSample(wil::com_ptr_nothrow<IStream> imageStream,
-                                                  IMFMediaType* sampleMediaType,
-                                                  const float quality) noexcept;
-bool ReencodeJPGImage(BYTE* imageBuf, const DWORD imageSize, DWORD& reencodedSize);
+std::vector<uint8_t> PrepareOverlayFrame(wil::com_ptr_nothrow<IStream> imageStream,
+                                         IMFMediaType* frameMediaType,
+                                         const size_t maxFrameSize) noexcept;
 
 HRESULT VideoCaptureProxyPin::Connect(IPin* pReceivePin, const AM_MEDIA_TYPE*)
 {
@@ -388,7 +414,7 @@ long GetImageSize(wil::com_ptr_nothrow<IMFSample>& image)
     return imageSize;
 }
 
-void ReencodeFrame(IMediaSample* frame)
+void ReencodeFrame(IMediaSample* frame, JpegTranscoder& transcoder)
 {
     BYTE* frameData = nullptr;
     frame->GetPointer(&frameData);
@@ -397,19 +423,26 @@ void ReencodeFrame(IMediaSample* frame)
         LOG("VideoCaptureProxyPin::ReencodeFrame FAILED frameData");
         return;
     }
-    const DWORD frameSize = frame->GetSize();
-    DWORD reencodedSize = 0;
-    if (!ReencodeJPGImage(frameData, frameSize, reencodedSize))
+    const long imageSize = frame->GetActualDataLength();
+    const long frameSize = frame->GetSize();
+    if (imageSize <= 0 || frameSize < imageSize)
     {
-        LOG("VideoCaptureProxyPin::ReencodeJPGImage FAILED");
+        LOG("VideoCaptureProxyPin::ReencodeFrame FAILED frame size");
         return;
     }
-    frame->SetActualDataLength(reencodedSize);
+
+    const size_t reencodedSize = transcoder.Reencode(frameData, static_cast<size_t>(imageSize), static_cast<size_t>(frameSize));
+    if (!reencodedSize)
+    {
+        LOG("VideoCaptureProxyPin::ReencodeFrame FAILED to reencode the image");
+        return;
+    }
+    frame->SetActualDataLength(static_cast<long>(reencodedSize));
 }
 
-bool OverwriteFrame(IMediaSample* frame, wil::com_ptr_nothrow<IMFSample>& image)
+bool OverwriteFrame(IMediaSample* frame, const std::vector<uint8_t>& image)
 {
-    if (!image)
+    if (image.empty())
     {
         return false;
     }
@@ -422,37 +455,17 @@ bool OverwriteFrame(IMediaSample* frame, wil::com_ptr_nothrow<IMFSample>& image)
         return false;
     }
 
-    wil::com_ptr_nothrow<IMFMediaBuffer> imageBuf;
-    const DWORD frameSize = frame->GetSize();
-
-    image->GetBufferByIndex(0, &imageBuf);
-    if (!imageBuf)
-    {
-        LOG("VideoCaptureProxyPin::OverwriteFrame FAILED imageBuf");
-        return false;
-    }
-
-    BYTE* imageData = nullptr;
-    DWORD _ = 0, imageSize = 0;
-    imageBuf->Lock(&imageData, &_, &imageSize);
-    if (!imageData)
-    {
-        LOG("VideoCaptureProxyPin::OverwriteFrame FAILED imageData");
-        return false;
-    }
-
-    if (imageSize > frameSize && failed(frame->SetActualDataLength(imageSize)))
+    const long frameSize = frame->GetSize();
+    if (frameSize < 0 || image.size() > static_cast<size_t>(frameSize))
     {
         char buf[512]{};
-        sprintf_s(buf, "VideoCaptureProxyPin::OverwriteFrame FAILED overlay image size %lu is larger than frame size %lu", imageSize, frameSize);
+        sprintf_s(buf, "VideoCaptureProxyPin::OverwriteFrame FAILED overlay image size %zu is larger than frame size %ld", image.size(), frameSize);
         LOG(buf);
-        imageBuf->Unlock();
         return false;
     }
 
-    std::copy(imageData, imageData + imageSize, frameData);
-    imageBuf->Unlock();
-    frame->SetActualDataLength(imageSize);
+    std::copy(image.begin(), image.end(), frameData);
+    frame->SetActualDataLength(static_cast<long>(image.size()));
 
     return true;
 }
@@ -515,30 +528,29 @@ VideoCaptureProxyFilter::VideoCaptureProxyFilter() :
     _worker_thread{
         std::thread{
             [this]() {
-                using namespace std::chrono_literals;
-                const auto uninitializedSleepInterval = 15ms;
-                std::vector<float> lowerJpgQualityModes = { 0.1f, 0.25f };
+                const auto releaseFrame = [](IMediaSample* frame) { frame->Release(); };
+#if defined(DEBUG_REENCODE_JPG_DATA)
+                // Kept for the whole stream, so the codec state and buffers are reused between frames
+                std::unique_ptr<JpegTranscoder> jpegTranscoder;
+#endif
                 while (!_shutdown_request)
                 {
-                    std::unique_lock<std::mutex> lock{ _worker_mutex };
-                    _worker_cv.wait(lock, [this] { return _pending_frame != nullptr || _shutdown_request; });
-
-                    if (!_outPin || !_outPin->_connectedInputPin)
+                    const auto queuedFrame = _frameQueue.Pop(releaseFrame);
+                    if (!queuedFrame)
                     {
-                        lock.unlock();
-                        std::this_thread::sleep_for(uninitializedSleepInterval);
+                        _frameAvailable.wait();
                         continue;
                     }
 
-                    auto input = _outPin->_connectedInputPin.try_query<IMemInputPin>();
-                    if (!input)
-                    {
-                        continue;
-                    }
+                    IMediaSample* sample = queuedFrame->frame;
+                    std::unique_lock<std::mutex> lock{ _worker_mutex };
 
-                    IMediaSample* sample = _pending_frame;
-                    if (!sample)
+                    // Nothing to send the frame to yet, wait for the next one instead of holding on to it
+                    auto input = _outPin && _outPin->_connectedInputPin ? _outPin->_connectedInputPin.try_query<IMemInputPin>() : nullptr;
+                    if (!input)
                     {
+                        _frameQueue.Dropped();
+                        sample->Release();
                         continue;
                     }
 #if defined(DEBUG_FRAME_DATA)
@@ -550,43 +562,30 @@ VideoCaptureProxyFilter::VideoCaptureProxyFilter() :
                     }
 #endif
                     auto newSettings = SyncCurrentSettings();
+                    if (newSettings.overlayImage)
+                    {
+                        _queuedOverlayImage = std::move(newSettings.overlayImage);
+                    }
+                    UpdateOverlayFrame(static_cast<size_t>(sample->GetSize()));
+
                     if (newSettings.webcamDisabled)
                     {
 #if !defined(DEBUG_OVERWRITE_FRAME)
-                        bool overwritten = OverwriteFrame(_pending_frame, _overlayImage ? _overlayImage : _blankImage);
-                        while (!overwritten && _overlayImage)
-                        {
-                            _overlayImage.reset();
-                            newSettings = SyncCurrentSettings();
-                            if (!lowerJpgQualityModes.empty() && newSettings.overlayImage)
-                            {
-                                const float quality = lowerJpgQualityModes.back();
-                                lowerJpgQualityModes.pop_back();
-                                char buf[512]{};
-                                sprintf_s(buf, "Reload overlay image with quality %f", quality);
-                                LOG(buf);
-                                _overlayImage = LoadImageAsSample(newSettings.overlayImage, _targetMediaType.get(), quality);
-                                overwritten = OverwriteFrame(_pending_frame, _overlayImage);
-                            }
-                            else
-                            {
-                                LOG("Couldn't overwrite frame with image with all available quality modes.");
-                            }
-                        }
+                        const bool overlayWritten = OverwriteFrame(sample, _overlayFrame);
 #if defined(DEBUG_FRAME_DATA)
                         static bool overlayFrameSaved = false;
-                        if (!overlayFrameSaved && _overlayImage && overwritten)
+                        if (!overlayFrameSaved && overlayWritten)
                         {
                             DumpSample(sample, "PowerToysVCMOverlayImageFrame.binary");
                             overlayFrameSaved = true;
                         }
 #endif
-                        if (!overwritten && !_overlayImage)
+                        if (!overlayWritten)
                         {
-                            OverwriteFrame(_pending_frame, _blankImage);
+                            OverwriteFrame(sample, _blankFrame);
                         }
 #else
-                        DebugOverwriteFrame(_pending_frame, "R:\\frame.data");
+                        DebugOverwriteFrame(sample, "R:\\frame.data");
 #endif
                     }
 #if defined(DEBUG_REENCODE_JPG_DATA)
@@ -596,14 +595,21 @@ VideoCaptureProxyFilter::VideoCaptureProxyFilter() :
                         _targetMediaType->GetGUID(MF_MT_SUBTYPE, &subtype);
                         if (subtype == MFVideoFormat_MJPG)
                         {
-                            ReencodeFrame(_pending_frame);
+                            if (!jpegTranscoder)
+                            {
+                                jpegTranscoder = CreateWICJpegTranscoder(0.1f);
+                            }
+                            if (jpegTranscoder)
+                            {
+                                ReencodeFrame(sample, *jpegTranscoder);
+                            }
                         }
                     }
 #endif
 
-                    _pending_frame = nullptr;
                     input->Receive(sample);
                     sample->Release();
+                    _frameQueue.Delivered(queuedFrame->queuedAt);
                 }
             } }
     }
@@ -615,6 +621,7 @@ HRESULT VideoCaptureProxyFilter::Stop(void)
     if (_state != State_Stopped && _captureDevice)
     {
         _captureDevice->StopCapture();
+        LogFrameQueueStats(_frameQueue.Stats());
     }
 
     _state = State_Stopped;
@@ -716,6 +723,9 @@ HRESULT VideoCaptureProxyFilter::EnumPins(IEnumPins** ppEnum)
     if (!_outPin)
     {
         LOG("VideoCaptureProxyFilter::EnumPins started pin initialization");
+        // The overlay frames are prepared for the media type negotiated below, load the current image again
+        _overlayImageVersion = 0;
+        _queuedOverlayImage.reset();
         const auto newSettings = SyncCurrentSettings();
         std::vector<VideoCaptureDeviceInfo> webcams;
         webcams = VideoCaptureDevice::ListAll();
@@ -762,10 +772,12 @@ HRESULT VideoCaptureProxyFilter::EnumPins(IEnumPins** ppEnum)
         _outPin.attach(pin.detach());
 
         auto frameCallback = [this](IMediaSample* sample) {
-            std::unique_lock<std::mutex> lock{ _worker_mutex };
             sample->AddRef();
-            _pending_frame = sample;
-            _worker_cv.notify_one();
+            if (IMediaSample* notQueued = _frameQueue.Push(sample))
+            {
+                notQueued->Release();
+            }
+            _frameAvailable.SetEvent();
         };
 
         _targetMediaType.reset();
@@ -781,13 +793,11 @@ HRESULT VideoCaptureProxyFilter::EnumPins(IEnumPins** ppEnum)
         _captureDevice = VideoCaptureDevice::Create(std::move(webcam), std::move(frameCallback));
         if (_captureDevice)
         {
-            if (!_blankImage)
-            {
-                wil::com_ptr_nothrow<IStream> blackBMPImage = SHCreateMemStream(bmpPixelData, sizeof(bmpPixelData));
-                _blankImage = LoadImageAsSample(blackBMPImage, _targetMediaType.get(), initialJpgQuality);
-            }
-
-            _overlayImage = LoadImageAsSample(newSettings.overlayImage, _targetMediaType.get(), initialJpgQuality);
+            // The frames aren't flowing yet, so the overlay frames can be prepared right away
+            const size_t frameBufferSize = GetFrameBufferSize(_captureDevice->_allocator.get());
+            wil::com_ptr_nothrow<IStream> blackBMPImage = SHCreateMemStream(bmpPixelData, sizeof(bmpPixelData));
+            _blankFrame = PrepareOverlayFrame(blackBMPImage, _targetMediaType.get(), frameBufferSize);
+            _overlayFrame = PrepareOverlayFrame(newSettings.overlayImage, _targetMediaType.get(), frameBufferSize);
             LOG("VideoCaptureProxyFilter::EnumPins capture device created successfully");
         }
         else
@@ -856,8 +866,14 @@ VideoCaptureProxyFilter::~VideoCaptureProxyFilter()
     VERBOSE_LOG;
     _shutdown_request = true;
 
-    _worker_cv.notify_one();
+    _frameAvailable.SetEvent();
     _worker_thread.join();
+
+    const auto releaseFrame = [](IMediaSample* frame) { frame->Release(); };
+    while (const auto queuedFrame = _frameQueue.Pop(releaseFrame))
+    {
+        queuedFrame->frame->Release();
+    }
 }
 
 VideoCaptureProxyFilter::SyncedSettings VideoCaptureProxyFilter::SyncCurrentSettings()
@@ -873,47 +889,103 @@ VideoCaptureProxyFilter::SyncedSettings VideoCaptureProxyFilter::SyncCurrentSett
         return result;
     }
 
-    _settingsUpdateChannel->access([this, &result](auto settingsMemory) {
-        auto settings = reinterpret_cast<CameraSettingsUpdateChannel*>(settingsMemory._data);
-        bool cameraNameUpdated = false;
-        result.webcamDisabled = settings->useOverlayImage;
+    // Doesn't take the channel lock, the module might hold it or be descheduled while a frame is waiting
+    auto updatesChannel = reinterpret_cast<CameraSettingsUpdateChannel*>(_settingsUpdateChannel->memory()._data);
+    updatesChannel->cameraInUse.store(true, std::memory_order_relaxed);
+
+    // Keeps the settings of the previous frame if the module was writing during every attempt
+    updatesChannel->read(_settings);
+    const auto& settings = _settings;
 
-        settings->cameraInUse = true;
+    result.webcamDisabled = settings.useOverlayImage;
 
-        if (settings->sourceCameraName.has_value())
+    if (settings.sourceCameraName.has_value())
+    {
+        std::wstring_view newCameraNameView{ settings.sourceCameraName->data() };
+        if (!_currentSourceCameraName.has_value() || *_currentSourceCameraName != newCameraNameView)
         {
-            std::wstring_view newCameraNameView{ settings->sourceCameraName->data() };
-            if (!_currentSourceCameraName.has_value() || *_currentSourceCameraName != newCameraNameView)
+            result.newCameraName = newCameraNameView;
+        }
+    }
+
+    if (!settings.overlayImageSize.has_value())
+    {
+        return result;
+    }
+
+    if (settings.overlayImageVersion != _overlayImageVersion)
+    {
+        auto imageChannel =
+            SerializedSharedMemory::open(CameraOverlayImageChannel::endpoint(), *settings.overlayImageSize, true);
+        if (!imageChannel)
+        {
+            return result;
+        }
+
+        imageChannel->access([this, &settings, &result](auto imageMemory) {
+            result.overlayImage = SHCreateMemStream(imageMemory._data, static_cast<UINT>(imageMemory._size));
+            if (!result.overlayImage)
             {
-                cameraNameUpdated = true;
-                result.newCameraName = newCameraNameView;
+                return;
             }
-        }
 
-        if (!settings->overlayImageSize.has_value())
+            _overlayImageVersion = settings.overlayImageVersion;
+        });
+    }
+    return result;
+}
+
+void VideoCaptureProxyFilter::UpdateOverlayFrame(const size_t frameBufferSize)
+{
+    using namespace std::chrono_literals;
+    if (_preparedOverlayFrame.valid())
+    {
+        if (_preparedOverlayFrame.wait_for(0s) != std::future_status::ready)
         {
             return;
         }
-
-        if (settings->newOverlayImagePosted || !_overlayImage)
+        auto prepared = _preparedOverlayFrame.get();
+        if (prepared.mediaType != _targetMediaType)
         {
-            auto imageChannel =
-                SerializedSharedMemory::open(CameraOverlayImageChannel::endpoint(), *settings->overlayImageSize, true);
-            if (!imageChannel)
+            // The pin was initialized again in the meantime, which prepared the current image for the new media type
+            LOG("VideoCaptureProxyFilter::UpdateOverlayFrame dropped an overlay frame prepared for a previous media type");
+        }
+        else if (prepared.frameBufferSize != frameBufferSize)
+        {
+            LOG("VideoCaptureProxyFilter::UpdateOverlayFrame frame size changed, preparing the overlay frame again");
+            if (!_queuedOverlayImage)
             {
-                return;
+                _queuedOverlayImage = std::move(prepared.image);
             }
+        }
+        else
+        {
+            _overlayFrame = std::move(prepared.frame);
+        }
+    }
+
+    if (!_queuedOverlayImage)
+    {
+        return;
+    }
 
-            imageChannel->access([this, settings, &result](auto imageMemory) {
-                result.overlayImage = SHCreateMemStream(imageMemory._data, static_cast<UINT>(imageMemory._size));
-                if (!result.overlayImage)
+    // Decoding and encoding the image takes longer than a frame, keep sending the current overlay meanwhile
+    try
+    {
+        _preparedOverlayFrame = std::async(std::launch::async, [image = std::move(_queuedOverlayImage), mediaType = _targetMediaType, frameBufferSize] {
+            const bool comInitialized = SUCCEEDED(CoInitializeEx(nullptr, COINIT_MULTITHREADED));
+            auto uninitializeCOM = wil::scope_exit([comInitialized] {
+                if (comInitialized)
                 {
-                    return;
+                    CoUninitialize();
                 }
-
-                settings->newOverlayImagePosted = false;
             });
-        }
-    });
-    return result;
+            auto frame = PrepareOverlayFrame(image, mediaType.get(), frameBufferSize);
+            return PreparedOverlayFrame{ mediaType, frameBufferSize, image, std::move(frame) };
+        });
+    }
+    catch (...)
+    {
+        LOG("VideoCaptureProxyFilter::UpdateOverlayFrame FAILED to start overlay preparation");
+    }
 }
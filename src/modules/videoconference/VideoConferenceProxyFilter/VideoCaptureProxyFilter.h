@@ -13,10 +13,12 @@
 #include <CameraStateUpdateChannels.h>
 #include <SerializedSharedMemory.h>
 
+#include "FrameQueue.h"
 #include "VideoCaptureDevice.h"
 
 #include <mutex>
-#include <condition_variable>
+#include <future>
+#include <vector>
 
 struct VideoCaptureProxyPin;
 struct IMFSample;
@@ -28,17 +30,31 @@ struct VideoCaptureProxyFilter : winrt::implements<VideoCaptureProxyFilter, IBas
 {
     // BLOCK START: member accessed concurrently
     wil::com_ptr_nothrow<VideoCaptureProxyPin> _outPin;
-    IMediaSample* _pending_frame = nullptr;
+    FrameQueue<IMediaSample*, 4> _frameQueue{ FrameDropPolicy::NewestWins };
+    wil::unique_event_nothrow _frameAvailable{ CreateEventW(nullptr, FALSE, FALSE, nullptr) };
     std::atomic_bool _shutdown_request = false;
     std::optional<SerializedSharedMemory> _settingsUpdateChannel;
     std::optional<std::wstring> _currentSourceCameraName;
-    wil::com_ptr_nothrow<IMFSample> _blankImage;
-    wil::com_ptr_nothrow<IMFSample> _overlayImage;
+    // Prepared for _targetMediaType, so muting a frame is a single bounded copy
+    std::vector<uint8_t> _blankFrame;
+    std::vector<uint8_t> _overlayFrame;
+    wil::com_ptr_nothrow<IStream> _queuedOverlayImage;
+
+    // Prepared off the frame thread, only used if the media type and frame size are still the same when it's ready
+    struct PreparedOverlayFrame
+    {
+        wil::com_ptr_nothrow<IMFMediaType> mediaType;
+        size_t frameBufferSize = 0;
+        wil::com_ptr_nothrow<IStream> image;
+        std::vector<uint8_t> frame;
+    };
+    std::future<PreparedOverlayFrame> _preparedOverlayFrame;
+    uint32_t _overlayImageVersion = 0;
+    CameraSettings _settings;
     wil::com_ptr_nothrow<IMFMediaType> _targetMediaType;
     // BLOCK END: member accessed concurrently
 
     std::mutex _worker_mutex;
-    std::condition_variable _worker_cv;
 
     FILTER_STATE _state = State_Stopped;
     wil::com_ptr_nothrow<IReferenceClock> _clock;
@@ -58,6 +74,7 @@ struct VideoCaptureProxyFilter : winrt::implements<VideoCaptureProxyFilter, IBas
     };
 
     SyncedSettings SyncCurrentSettings();
+    void UpdateOverlayFrame(size_t frameBufferSize);
 
     HRESULT STDMETHODCALLTYPE Stop(void) override;
     HRESULT STDMETHODCALLTYPE Pause(void) override;
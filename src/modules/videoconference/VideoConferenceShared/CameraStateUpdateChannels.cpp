@@ -8,8 +8,44 @@ std::wstring_view CameraOverlayImageChannel::endpoint()
     return endpoint;
 }
 
+CameraSettingsUpdateChannel::CameraSettingsUpdateChannel() noexcept
+{
+    settings().write(CameraSettings{});
+}
+
+bool CameraSettingsUpdateChannel::read(CameraSettings& current) noexcept
+{
+    // The writer would have to start two writes during a copy to make it retry
+    constexpr int maxAttempts = 16;
+    CameraSettings copy;
+    for (int attempt = 0; attempt < maxAttempts; ++attempt)
+    {
+        if (settings().tryRead(copy))
+        {
+            current = copy;
+            return true;
+        }
+    }
+    return false;
+}
+
+void CameraSettingsUpdateChannel::update(const std::function<void(CameraSettings&)>& updateRoutine) noexcept
+{
+    // Writers are serialized, so reading the current settings can't race
+    CameraSettings next;
+    settings().tryRead(next);
+    updateRoutine(next);
+    settings().write(next);
+}
+
+DoubleBufferedSeqlock CameraSettingsUpdateChannel::settings() noexcept
+{
+    return DoubleBufferedSeqlock{ settingsBuffers, sizeof(CameraSettings) };
+}
+
 std::wstring_view CameraSettingsUpdateChannel::endpoint()
 {
-    static const std::wstring endpoint = ObtainStableGlobalNameForKernelObject(L"PowerToysVideoConferenceSettingsChannelSharedMemory", true);
+    // The name changes with the layout, filters of a previous version might still be loaded in apps
+    static const std::wstring endpoint = ObtainStableGlobalNameForKernelObject(L"PowerToysVideoConferenceSettingsChannelSharedMemory3", true);
     return endpoint;
 }
@@ -3,20 +3,50 @@
 #include <optional>
 #include <string_view>
 #include <array>
+#include <atomic>
+#include <functional>
 
-struct alignas(16) CameraSettingsUpdateChannel
+#include "DoubleBufferedSeqlock.h"
+
+struct CameraSettings
 {
     bool useOverlayImage = false;
-    bool cameraInUse = false;
 
     std::optional<uint32_t> overlayImageSize;
     std::optional<std::array<wchar_t, 256>> sourceCameraName;
 
-    bool newOverlayImagePosted = false;
+    // Incremented every time a new overlay image is posted
+    uint32_t overlayImageVersion = 0;
+};
+
+// Settings the module publishes to the proxy filters of all the apps using the camera. The module is the only writer and
+// publishes them through a DoubleBufferedSeqlock, so the filters read the settings on every frame without ever waiting
+// for the module.
+struct alignas(16) CameraSettingsUpdateChannel
+{
+    alignas(DoubleBufferedSeqlock::Word) std::array<std::byte, DoubleBufferedSeqlock::requiredSize(sizeof(CameraSettings))> settingsBuffers{};
+
+    // Set by the proxy filters
+    std::atomic_bool cameraInUse = false;
+
+    CameraSettingsUpdateChannel() noexcept;
+
+    // Copies the latest published settings into current. If every attempt raced with the writer, current keeps the
+    // settings the caller read last and false is returned.
+    bool read(CameraSettings& current) noexcept;
+
+    // Writers must be serialized, e.g. by SerializedSharedMemory::access
+    void update(const std::function<void(CameraSettings&)>& updateRoutine) noexcept;
 
     static std::wstring_view endpoint();
+
+private:
+    DoubleBufferedSeqlock settings() noexcept;
 };
 
+static_assert(std::is_trivially_copyable_v<CameraSettings>, "the settings are copied through shared memory");
+static_assert(std::atomic_uint32_t::is_always_lock_free && std::atomic_bool::is_always_lock_free, "the channel is shared between processes");
+
 namespace CameraOverlayImageChannel
 {
     std::wstring_view endpoint();
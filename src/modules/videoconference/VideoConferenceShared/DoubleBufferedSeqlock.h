@@ -0,0 +1,116 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <type_traits>
+
+// Seqlock laid out in a raw span of memory, e.g. memory shared between processes: a 32-bit version, the 32-bit version
+// of the last write started and two buffers for the value. The single writer fills the buffer the version doesn't point
+// at and publishes it with one increment of the version, so readers never wait. The buffer a reader copies is only
+// rewritten by the write after the next one, so a reader only fails if the writer started that write while it was
+// copying. The buffers are copied word by word with relaxed atomics, a copy racing with the writer is detected by the
+// version check instead of being undefined behavior.
+class DoubleBufferedSeqlock
+{
+public:
+    using Word = std::atomic_uint32_t;
+    static_assert(Word::is_always_lock_free && sizeof(Word) == sizeof(uint32_t), "the memory is shared between processes");
+
+    // Size in bytes of the memory needed for values of valueSize bytes
+    static constexpr size_t requiredSize(size_t valueSize) noexcept
+    {
+        return sizeof(Word) * (headerWords + 2 * wordCount(valueSize));
+    }
+
+    // The memory has to be aligned for Word, at least requiredSize(valueSize) long and either zero filled or already
+    // used by a seqlock with the same valueSize
+    DoubleBufferedSeqlock(std::span<std::byte> memory, size_t valueSize) noexcept :
+        _words(reinterpret_cast<Word*>(memory.data())), _valueSize(valueSize)
+    {
+    }
+
+    uint32_t version() const noexcept
+    {
+        return _words[0].load(std::memory_order_acquire);
+    }
+
+    // Copies the latest published value, false if the copy raced with the writer and has to be retried
+    bool tryRead(std::span<std::byte> value) const noexcept
+    {
+        const uint32_t readVersion = _words[0].load(std::memory_order_acquire);
+        copyFromBuffer(readVersion, value);
+        std::atomic_thread_fence(std::memory_order_acquire);
+
+        // Publishing readVersion + 1 doesn't touch the copied buffer, readVersion + 2 is the first write that does. A copy
+        // that saw any word of that write also sees it started, the fences order the start before its words.
+        return _words[1].load(std::memory_order_relaxed) - readVersion <= 1;
+    }
+
+    // Writers must be serialized
+    void write(std::span<const std::byte> value) noexcept
+    {
+        const uint32_t nextVersion = _words[0].load(std::memory_order_relaxed) + 1;
+
+        // Readers still copying the buffer about to be overwritten see the write started
+        _words[1].store(nextVersion, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        copyToBuffer(value, nextVersion);
+        _words[0].store(nextVersion, std::memory_order_release);
+    }
+
+    template<typename T>
+    bool tryRead(T& value) const noexcept
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+        return tryRead(std::as_writable_bytes(std::span{ &value, 1 }));
+    }
+
+    template<typename T>
+    void write(const T& value) noexcept
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+        write(std::as_bytes(std::span{ &value, 1 }));
+    }
+
+private:
+    // The published version and the version of the last write started
+    static constexpr size_t headerWords = 2;
+
+    static constexpr size_t wordCount(size_t valueSize) noexcept
+    {
+        return (valueSize + sizeof(Word) - 1) / sizeof(Word);
+    }
+
+    Word* buffer(uint32_t version) const noexcept
+    {
+        return _words + headerWords + (version % 2) * wordCount(_valueSize);
+    }
+
+    void copyFromBuffer(uint32_t version, std::span<std::byte> value) const noexcept
+    {
+        const Word* words = buffer(version);
+        for (size_t offset = 0; offset < _valueSize; offset += sizeof(Word))
+        {
+            const uint32_t word = words[offset / sizeof(Word)].load(std::memory_order_relaxed);
+            std::memcpy(value.data() + offset, &word, std::min(sizeof(Word), _valueSize - offset));
+        }
+    }
+
+    void copyToBuffer(std::span<const std::byte> value, uint32_t version) noexcept
+    {
+        Word* words = buffer(version);
+        for (size_t offset = 0; offset < _valueSize; offset += sizeof(Word))
+        {
+            uint32_t word = 0;
+            std::memcpy(&word, value.data() + offset, std::min(sizeof(Word), _valueSize - offset));
+            words[offset / sizeof(Word)].store(word, std::memory_order_relaxed);
+        }
+    }
+
+    Word* _words;
+    size_t _valueSize;
+};
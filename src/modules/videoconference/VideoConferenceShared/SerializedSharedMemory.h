@@ -34,6 +34,8 @@ public:
                                                       const bool read_only) noexcept;
 
     void access(std::function<void(memory_t)> access_routine) noexcept;
+    // Memory without the lock, for contents synchronizing their readers themselves
+    inline memory_t memory() const noexcept { return _memory; }
     inline size_t size() const noexcept { return _memory._size; }
 
     ~SerializedSharedMemory() noexcept;
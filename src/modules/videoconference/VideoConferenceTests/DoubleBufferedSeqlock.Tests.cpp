@@ -0,0 +1,261 @@
+#include "pch.h"
+
+#include <chrono>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "modules/videoconference/VideoConferenceShared/CameraStateUpdateChannels.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace VideoConferenceTests
+{
+    namespace
+    {
+        // Seqlock memory in a POSIX shared memory object, mapped again by every process that opens it
+        class SharedMemory
+        {
+        public:
+            SharedMemory(const std::string& name, size_t size, bool create) :
+                _name(name), _size(size), _owner(create)
+            {
+                const int fd = shm_open(name.c_str(), create ? O_CREAT | O_EXCL | O_RDWR : O_RDWR, 0600);
+                if (fd < 0)
+                {
+                    return;
+                }
+
+                if (!create || ftruncate(fd, static_cast<off_t>(size)) == 0)
+                {
+                    void* data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+                    _data = data != MAP_FAILED ? static_cast<std::byte*>(data) : nullptr;
+                }
+                close(fd);
+            }
+
+            ~SharedMemory()
+            {
+                if (_data)
+                {
+                    munmap(_data, _size);
+                }
+                if (_owner)
+                {
+                    shm_unlink(_name.c_str());
+                }
+            }
+
+            SharedMemory(const SharedMemory&) = delete;
+            SharedMemory& operator=(const SharedMemory&) = delete;
+
+            std::span<std::byte> span() const noexcept { return { _data, _size }; }
+            bool valid() const noexcept { return _data != nullptr; }
+
+        private:
+            std::string _name;
+            size_t _size;
+            bool _owner;
+            std::byte* _data = nullptr;
+        };
+
+        // Settings whose every member is derived from the sequence number, so a torn copy doesn't pass the check
+        CameraSettings SettingsFor(uint32_t sequence)
+        {
+            CameraSettings settings;
+            settings.useOverlayImage = sequence % 2;
+            settings.overlayImageSize = sequence * 3;
+            settings.overlayImageVersion = sequence;
+            auto& name = settings.sourceCameraName.emplace();
+            std::fill(name.begin(), name.end() - 1, static_cast<wchar_t>(L'a' + sequence % 26));
+            name.back() = L'\0';
+            return settings;
+        }
+
+        bool Consistent(const CameraSettings& settings)
+        {
+            const uint32_t sequence = settings.overlayImageVersion;
+            if (sequence == 0)
+            {
+                return !settings.useOverlayImage && !settings.overlayImageSize && !settings.sourceCameraName;
+            }
+
+            const auto expected = SettingsFor(sequence);
+            return settings.useOverlayImage == expected.useOverlayImage && settings.overlayImageSize == expected.overlayImageSize &&
+                   settings.sourceCameraName == expected.sourceCameraName;
+        }
+
+        constexpr uint32_t writerUpdates = 200000;
+        constexpr auto processTimeout = std::chrono::seconds(60);
+
+        int RunWriter(const std::string& name)
+        {
+            SharedMemory memory(name, DoubleBufferedSeqlock::requiredSize(sizeof(CameraSettings)), false);
+            if (!memory.valid())
+            {
+                return 2;
+            }
+
+            DoubleBufferedSeqlock seqlock(memory.span(), sizeof(CameraSettings));
+            for (uint32_t sequence = 1; sequence <= writerUpdates; ++sequence)
+            {
+                seqlock.write(SettingsFor(sequence));
+            }
+            return 0;
+        }
+
+        // Reads until it sees the last update, every read has to be consistent and no older than the previous one
+        int RunReader(const std::string& name)
+        {
+            SharedMemory memory(name, DoubleBufferedSeqlock::requiredSize(sizeof(CameraSettings)), false);
+            if (!memory.valid())
+            {
+                return 2;
+            }
+
+            DoubleBufferedSeqlock seqlock(memory.span(), sizeof(CameraSettings));
+            const auto deadline = std::chrono::steady_clock::now() + processTimeout;
+            uint32_t lastSequence = 0;
+            while (lastSequence != writerUpdates)
+            {
+                if (std::chrono::steady_clock::now() > deadline)
+                {
+                    return 3;
+                }
+
+                CameraSettings settings;
+                if (!seqlock.tryRead(settings))
+                {
+                    continue;
+                }
+                if (!Consistent(settings) || settings.overlayImageVersion < lastSequence)
+                {
+                    return 1;
+                }
+                lastSequence = settings.overlayImageVersion;
+            }
+            return 0;
+        }
+
+        pid_t Spawn(int (*run)(const std::string&), const std::string& name)
+        {
+            const pid_t pid = fork();
+            if (pid == 0)
+            {
+                _exit(run(name));
+            }
+            return pid;
+        }
+    }
+
+    TEST_CLASS(DoubleBufferedSeqlockTests)
+    {
+    public:
+        TEST_METHOD(ZeroFilledMemoryReadsZeroes)
+        {
+            std::vector<DoubleBufferedSeqlock::Word> memory(DoubleBufferedSeqlock::requiredSize(7) / sizeof(DoubleBufferedSeqlock::Word));
+            DoubleBufferedSeqlock seqlock(std::as_writable_bytes(std::span{ memory }), 7);
+
+            std::array<uint8_t, 7> value;
+            value.fill(0xFF);
+            Assert::IsTrue(seqlock.tryRead(value));
+            Assert::IsTrue(value == std::array<uint8_t, 7>{});
+            Assert::AreEqual(0u, seqlock.version());
+        }
+
+        TEST_METHOD(ReadsTheLatestWrite)
+        {
+            // Not a multiple of the word size, the last word is copied partially
+            using Value = std::array<uint8_t, 7>;
+            std::vector<DoubleBufferedSeqlock::Word> memory(DoubleBufferedSeqlock::requiredSize(sizeof(Value)) / sizeof(DoubleBufferedSeqlock::Word));
+            DoubleBufferedSeqlock seqlock(std::as_writable_bytes(std::span{ memory }), sizeof(Value));
+
+            for (uint8_t i = 1; i <= 5; ++i)
+            {
+                seqlock.write(Value{ i, 2, 3, 4, 5, 6, i });
+
+                Value value{};
+                Assert::IsTrue(seqlock.tryRead(value));
+                Assert::IsTrue(value == Value{ i, 2, 3, 4, 5, 6, i });
+                Assert::AreEqual(static_cast<uint32_t>(i), seqlock.version());
+            }
+        }
+
+        TEST_METHOD(ReadsWhileTheOtherBufferIsWritten)
+        {
+            // Header words: the published version, then the version of the last write started
+            std::vector<DoubleBufferedSeqlock::Word> memory(DoubleBufferedSeqlock::requiredSize(sizeof(uint32_t)) / sizeof(DoubleBufferedSeqlock::Word));
+            DoubleBufferedSeqlock seqlock(std::as_writable_bytes(std::span{ memory }), sizeof(uint32_t));
+            seqlock.write(uint32_t{ 1 });
+
+            // The writer started the next write, which fills the other buffer
+            memory[1].store(2);
+            memory[2].store(0xDEAD);
+            uint32_t value = 0;
+            Assert::IsTrue(seqlock.tryRead(value));
+            Assert::AreEqual(1u, value);
+
+            // The write after it rewrites the buffer of version 1
+            memory[1].store(3);
+            Assert::IsFalse(seqlock.tryRead(value));
+        }
+
+        TEST_METHOD(CameraSettingsRoundTrip)
+        {
+            alignas(DoubleBufferedSeqlock::Word) decltype(CameraSettingsUpdateChannel::settingsBuffers) buffers{};
+            DoubleBufferedSeqlock seqlock(buffers, sizeof(CameraSettings));
+
+            seqlock.write(SettingsFor(42));
+            CameraSettings settings;
+            Assert::IsTrue(seqlock.tryRead(settings));
+            Assert::IsTrue(Consistent(settings));
+            Assert::AreEqual(42u, settings.overlayImageVersion);
+        }
+
+        TEST_METHOD(MultiProcessStress)
+        {
+            const std::string name = "/PowerToysSeqlockTests." + std::to_string(getpid());
+            SharedMemory memory(name, DoubleBufferedSeqlock::requiredSize(sizeof(CameraSettings)), true);
+            Assert::IsTrue(memory.valid());
+
+            const auto start = std::chrono::steady_clock::now();
+            constexpr int readerCount = 3;
+            std::vector<pid_t> readers;
+            for (int i = 0; i < readerCount; ++i)
+            {
+                readers.push_back(Spawn(RunReader, name));
+            }
+            const pid_t writer = Spawn(RunWriter, name);
+
+            bool allSpawned = writer > 0;
+            for (pid_t pid : readers)
+            {
+                allSpawned = allSpawned && pid > 0;
+            }
+
+            std::vector<int> exitCodes;
+            for (pid_t pid : readers)
+            {
+                int status = 0;
+                exitCodes.push_back(pid > 0 && waitpid(pid, &status, 0) == pid && WIFEXITED(status) ? WEXITSTATUS(status) : -1);
+            }
+            int writerStatus = 0;
+            const bool writerSucceeded = writer > 0 && waitpid(writer, &writerStatus, 0) == writer && WIFEXITED(writerStatus) &&
+                                         WEXITSTATUS(writerStatus) == 0;
+            const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+            Assert::IsTrue(allSpawned);
+            Assert::IsTrue(writerSucceeded);
+            for (int exitCode : exitCodes)
+            {
+                Assert::AreEqual(0, exitCode);
+            }
+
+            const auto message = std::to_string(writerUpdates) + " updates read by " + std::to_string(readerCount) + " processes in " +
+                                 std::to_string(elapsed.count()) + "ms\n";
+            Logger::WriteMessage(message.c_str());
+        }
+    };
+}
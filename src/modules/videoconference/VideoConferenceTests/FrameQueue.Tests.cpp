@@ -0,0 +1,205 @@
+#include "pch.h"
+
+#include <atomic>
+#include <thread>
+
+#include "modules/videoconference/VideoConferenceProxyFilter/FrameQueue.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace VideoConferenceTests
+{
+    namespace
+    {
+        constexpr size_t capacity = 4;
+        using Queue = FrameQueue<int*, capacity>;
+
+        std::vector<int> Frames(const size_t count)
+        {
+            std::vector<int> frames(count);
+            for (size_t i = 0; i < count; ++i)
+            {
+                frames[i] = static_cast<int>(i);
+            }
+            return frames;
+        }
+
+        // Every frame has to come back to the caller exactly once: popped, refused by Push, or released by Pop
+        void StressTest(const FrameDropPolicy policy)
+        {
+            constexpr size_t frameCount = 1'000'000;
+            auto frames = Frames(frameCount);
+            std::vector<std::atomic_int> returned(frameCount);
+            Queue queue{ policy };
+
+            std::atomic_bool producerDone = false;
+            size_t refused = 0;
+            std::thread producer{ [&] {
+                for (auto& frame : frames)
+                {
+                    // Lets the consumer run between pushes now and then, so it also races with a full queue
+                    if (frame % 16 == 0)
+                    {
+                        std::this_thread::yield();
+                    }
+                    if (int* notQueued = queue.Push(&frame))
+                    {
+                        returned[*notQueued].fetch_add(1, std::memory_order_relaxed);
+                        ++refused;
+                    }
+                }
+                producerDone.store(true, std::memory_order_release);
+            } };
+
+            size_t popped = 0, released = 0;
+            int lastPopped = -1;
+            bool ordered = true;
+            while (true)
+            {
+                const bool done = producerDone.load(std::memory_order_acquire);
+                auto queued = queue.Pop([&](int* frame) {
+                    returned[*frame].fetch_add(1, std::memory_order_relaxed);
+                    ++released;
+                });
+                if (!queued)
+                {
+                    if (done)
+                    {
+                        break;
+                    }
+                    std::this_thread::yield();
+                    continue;
+                }
+
+                ordered = ordered && *queued->frame > lastPopped;
+                lastPopped = *queued->frame;
+                returned[*queued->frame].fetch_add(1, std::memory_order_relaxed);
+                ++popped;
+                queue.Delivered(queued->queuedAt);
+            }
+            producer.join();
+
+            Assert::IsTrue(ordered);
+            for (const auto& count : returned)
+            {
+                Assert::AreEqual(1, count.load());
+            }
+
+            const auto stats = queue.Stats();
+            Assert::AreEqual(static_cast<uint64_t>(frameCount), stats.received);
+            Assert::AreEqual(static_cast<uint64_t>(popped), stats.delivered);
+            Assert::AreEqual(static_cast<uint64_t>(frameCount), stats.delivered + stats.dropped + stats.overwritten);
+            if (policy == FrameDropPolicy::OldestWins)
+            {
+                Assert::AreEqual(static_cast<uint64_t>(refused), stats.dropped);
+                Assert::AreEqual(0ull, static_cast<unsigned long long>(stats.overwritten));
+                Assert::AreEqual(size_t{ 0 }, released);
+            }
+            else
+            {
+                // Nothing overwrites the last frame
+                Assert::AreEqual(static_cast<int>(frameCount) - 1, lastPopped);
+                Assert::AreEqual(0ull, static_cast<unsigned long long>(stats.dropped));
+                Assert::AreEqual(static_cast<uint64_t>(refused + released), stats.overwritten);
+            }
+
+            const auto message = std::string{ policy == FrameDropPolicy::OldestWins ? "OldestWins" : "NewestWins" } + ": " +
+                                 std::to_string(stats.delivered) + " delivered, " + std::to_string(stats.dropped) + " dropped, " +
+                                 std::to_string(stats.overwritten) + " overwritten out of " + std::to_string(stats.received) + "\n";
+            Logger::WriteMessage(message.c_str());
+        }
+    }
+
+    TEST_CLASS(FrameQueueTests)
+    {
+    public:
+        TEST_METHOD(OldestWinsDropsIncomingFramesWhenFull)
+        {
+            auto frames = Frames(capacity + 2);
+            Queue queue{ FrameDropPolicy::OldestWins };
+            for (size_t i = 0; i < capacity; ++i)
+            {
+                Assert::IsNull(queue.Push(&frames[i]));
+            }
+            Assert::IsTrue(queue.Push(&frames[capacity]) == &frames[capacity]);
+            Assert::IsTrue(queue.Push(&frames[capacity + 1]) == &frames[capacity + 1]);
+
+            const auto noRelease = [](int*) { Assert::Fail(L"OldestWins doesn't overwrite frames"); };
+            for (size_t i = 0; i < capacity; ++i)
+            {
+                const auto queued = queue.Pop(noRelease);
+                Assert::IsTrue(queued.has_value());
+                Assert::AreEqual(static_cast<int>(i), *queued->frame);
+            }
+            Assert::IsFalse(queue.Pop(noRelease).has_value());
+
+            // Room again once the consumer has caught up
+            Assert::IsNull(queue.Push(&frames[capacity + 1]));
+            Assert::AreEqual(static_cast<int>(capacity) + 1, *queue.Pop(noRelease)->frame);
+
+            const auto stats = queue.Stats();
+            Assert::AreEqual(uint64_t{ capacity + 3 }, stats.received);
+            Assert::AreEqual(uint64_t{ 2 }, stats.dropped);
+            Assert::AreEqual(uint64_t{ 0 }, stats.overwritten);
+        }
+
+        TEST_METHOD(NewestWinsOverwritesQueuedFrames)
+        {
+            auto frames = Frames(capacity + 2);
+            Queue queue{ FrameDropPolicy::NewestWins };
+            for (size_t i = 0; i < capacity; ++i)
+            {
+                Assert::IsNull(queue.Push(&frames[i]));
+            }
+
+            // Full, the newest queued frame is replaced and handed back
+            Assert::IsTrue(queue.Push(&frames[capacity]) == &frames[capacity - 1]);
+            Assert::IsTrue(queue.Push(&frames[capacity + 1]) == &frames[capacity]);
+
+            std::vector<int> released;
+            const auto queued = queue.Pop([&released](int* frame) { released.push_back(*frame); });
+            Assert::IsTrue(queued.has_value());
+            Assert::AreEqual(static_cast<int>(capacity) + 1, *queued->frame);
+            Assert::IsTrue(std::vector<int>{ 0, 1, 2 } == released);
+            Assert::IsFalse(queue.Pop([](int*) {}).has_value());
+
+            const auto stats = queue.Stats();
+            Assert::AreEqual(uint64_t{ capacity + 2 }, stats.received);
+            Assert::AreEqual(uint64_t{ 0 }, stats.dropped);
+            Assert::AreEqual(uint64_t{ capacity + 1 }, stats.overwritten);
+        }
+
+        TEST_METHOD(StatsTrackDeliveryAndLatency)
+        {
+            auto frames = Frames(2);
+            Queue queue{ FrameDropPolicy::NewestWins };
+            Assert::AreEqual(0ll, static_cast<long long>(queue.Stats().averageLatency.count()));
+
+            queue.Push(&frames[0]);
+            const auto queued = queue.Pop([](int*) {});
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+            queue.Delivered(queued->queuedAt);
+
+            queue.Push(&frames[1]);
+            queue.Pop([](int*) {});
+            queue.Dropped();
+
+            const auto stats = queue.Stats();
+            Assert::AreEqual(uint64_t{ 2 }, stats.received);
+            Assert::AreEqual(uint64_t{ 1 }, stats.delivered);
+            Assert::AreEqual(uint64_t{ 1 }, stats.dropped);
+            Assert::IsTrue(stats.maxLatency >= std::chrono::milliseconds(2));
+            Assert::IsTrue(stats.averageLatency == stats.maxLatency);
+        }
+
+        TEST_METHOD(NewestWinsStress)
+        {
+            StressTest(FrameDropPolicy::NewestWins);
+        }
+
+        TEST_METHOD(OldestWinsStress)
+        {
+            StressTest(FrameDropPolicy::OldestWins);
+        }
+    };
+}
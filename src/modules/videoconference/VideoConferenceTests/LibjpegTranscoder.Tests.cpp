@@ -0,0 +1,190 @@
+#include "pch.h"
+
+#include <chrono>
+#include <csetjmp>
+
+#include "modules/videoconference/VideoConferenceProxyFilter/LibjpegTranscoder.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace VideoConferenceTests
+{
+    namespace
+    {
+        struct JpegErrors
+        {
+            jpeg_error_mgr manager;
+            std::jmp_buf jump;
+        };
+
+        void JpegErrorExit(j_common_ptr info)
+        {
+            std::longjmp(reinterpret_cast<JpegErrors*>(info->err)->jump, 1);
+        }
+
+        // A camera-like MJPG frame: gradients with some texture, so the encoded size depends on the quality
+        std::vector<uint8_t> EncodeFrame(const uint32_t width, const uint32_t height, const int quality)
+        {
+            std::vector<uint8_t> rgb(static_cast<size_t>(width) * height * 3);
+            for (uint32_t y = 0; y < height; ++y)
+            {
+                for (uint32_t x = 0; x < width; ++x)
+                {
+                    uint8_t* pixel = rgb.data() + (static_cast<size_t>(y) * width + x) * 3;
+                    pixel[0] = static_cast<uint8_t>(x * 255 / width);
+                    pixel[1] = static_cast<uint8_t>(y * 255 / height);
+                    pixel[2] = static_cast<uint8_t>((x * 7 + y * 13) % 256);
+                }
+            }
+
+            jpeg_compress_struct encoder{};
+            jpeg_error_mgr errors{};
+            encoder.err = jpeg_std_error(&errors);
+            jpeg_create_compress(&encoder);
+            unsigned char* output = nullptr;
+            unsigned long outputSize = 0;
+            jpeg_mem_dest(&encoder, &output, &outputSize);
+            encoder.image_width = width;
+            encoder.image_height = height;
+            encoder.input_components = 3;
+            encoder.in_color_space = JCS_RGB;
+            jpeg_set_defaults(&encoder);
+            jpeg_set_quality(&encoder, quality, TRUE);
+            jpeg_start_compress(&encoder, TRUE);
+            while (encoder.next_scanline < encoder.image_height)
+            {
+                JSAMPROW row = rgb.data() + static_cast<size_t>(encoder.next_scanline) * width * 3;
+                jpeg_write_scanlines(&encoder, &row, 1);
+            }
+            jpeg_finish_compress(&encoder);
+            jpeg_destroy_compress(&encoder);
+
+            std::vector<uint8_t> jpg(output, output + outputSize);
+            free(output);
+            return jpg;
+        }
+
+        // Decodes the whole image, false if it isn't a valid jpg of the given size
+        bool Decodes(const uint8_t* jpg, const size_t size, const uint32_t width, const uint32_t height)
+        {
+            jpeg_decompress_struct decoder{};
+            JpegErrors errors{};
+            decoder.err = jpeg_std_error(&errors.manager);
+            errors.manager.error_exit = &JpegErrorExit;
+            errors.manager.output_message = [](j_common_ptr) {};
+            jpeg_create_decompress(&decoder);
+            std::vector<JSAMPLE> row;
+            if (setjmp(errors.jump))
+            {
+                jpeg_destroy_decompress(&decoder);
+                return false;
+            }
+
+            jpeg_mem_src(&decoder, jpg, static_cast<unsigned long>(size));
+            jpeg_read_header(&decoder, TRUE);
+            jpeg_start_decompress(&decoder);
+            const bool sameSize = decoder.output_width == width && decoder.output_height == height;
+            row.resize(static_cast<size_t>(decoder.output_width) * decoder.output_components);
+            JSAMPROW rowPointer = row.data();
+            while (decoder.output_scanline < decoder.output_height)
+            {
+                jpeg_read_scanlines(&decoder, &rowPointer, 1);
+            }
+            jpeg_finish_decompress(&decoder);
+            jpeg_destroy_decompress(&decoder);
+            return sameSize;
+        }
+    }
+
+    TEST_CLASS(LibjpegTranscoderTests)
+    {
+    public:
+        TEST_METHOD(ReencodesInPlaceAtLowerQuality)
+        {
+            auto frame = EncodeFrame(640, 480, 95);
+            const size_t originalSize = frame.size();
+
+            auto transcoder = CreateLibjpegTranscoder(0.1f);
+            Assert::IsNotNull(transcoder.get());
+            // Several frames through the same transcoder, the codec state is reused
+            for (int i = 0; i < 3; ++i)
+            {
+                auto reencoded = frame;
+                const size_t size = transcoder->Reencode(reencoded.data(), reencoded.size(), reencoded.size());
+                Assert::IsTrue(size > 0);
+                Assert::IsTrue(size < originalSize);
+                Assert::IsTrue(Decodes(reencoded.data(), size, 640, 480));
+            }
+        }
+
+        TEST_METHOD(LeavesTheFrameWhenTheImageDoesNotFit)
+        {
+            const auto original = EncodeFrame(320, 240, 50);
+            auto frame = original;
+            auto transcoder = CreateLibjpegTranscoder(0.5f);
+
+            Assert::AreEqual(size_t{ 0 }, transcoder->Reencode(frame.data(), frame.size(), 64));
+            Assert::IsTrue(original == frame);
+
+            // Still usable after the failure
+            frame.resize(original.size() * 2);
+            const size_t size = transcoder->Reencode(frame.data(), original.size(), frame.size());
+            Assert::IsTrue(size > 0);
+            Assert::IsTrue(Decodes(frame.data(), size, 320, 240));
+        }
+
+        TEST_METHOD(LeavesTheFrameWhenItIsNotAJpg)
+        {
+            std::vector<uint8_t> frame(4096);
+            for (size_t i = 0; i < frame.size(); ++i)
+            {
+                frame[i] = static_cast<uint8_t>(i * 31);
+            }
+            const auto original = frame;
+
+            auto transcoder = CreateLibjpegTranscoder(0.5f);
+            Assert::AreEqual(size_t{ 0 }, transcoder->Reencode(frame.data(), frame.size(), frame.size()));
+            Assert::IsTrue(original == frame);
+
+            // libjpeg decodes the missing part of a truncated image as gray, either way the frame stays a valid image
+            auto truncated = EncodeFrame(320, 240, 50);
+            const size_t truncatedSize = truncated.size() / 2;
+            const auto truncatedOriginal = truncated;
+            const size_t size = transcoder->Reencode(truncated.data(), truncatedSize, truncated.size());
+            Assert::IsTrue(size ? Decodes(truncated.data(), size, 320, 240) : truncatedOriginal == truncated);
+        }
+
+        TEST_METHOD(Benchmark)
+        {
+            using milliseconds = std::chrono::duration<double, std::milli>;
+            struct Resolution
+            {
+                const char* name;
+                uint32_t width, height;
+                int iterations;
+            };
+            const Resolution resolutions[] = { { "720p", 1280, 720, 20 }, { "1080p", 1920, 1080, 10 } };
+
+            std::string message;
+            for (const auto& resolution : resolutions)
+            {
+                const auto source = EncodeFrame(resolution.width, resolution.height, 90);
+                auto transcoder = CreateLibjpegTranscoder(0.5f);
+                std::vector<uint8_t> frame(source.size());
+                size_t size = 0;
+                milliseconds elapsed{};
+                for (int i = 0; i < resolution.iterations; ++i)
+                {
+                    std::copy(source.begin(), source.end(), frame.begin());
+                    const auto start = std::chrono::steady_clock::now();
+                    size = transcoder->Reencode(frame.data(), source.size(), frame.size());
+                    elapsed += std::chrono::steady_clock::now() - start;
+                }
+                Assert::IsTrue(size > 0);
+                message += std::string{ resolution.name } + ": " + std::to_string(elapsed.count() / resolution.iterations) + "ms per frame, " +
+                           std::to_string(source.size()) + " -> " + std::to_string(size) + " bytes\n";
+            }
+            Logger::WriteMessage(message.c_str());
+        }
+    };
+}
@@ -0,0 +1,307 @@
+#include "pch.h"
+
+#include <chrono>
+#include <cstring>
+#include <random>
+
+#include "modules/videoconference/VideoConferenceProxyFilter/PixelConversion.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using PixelConversion::Format;
+
+namespace VideoConferenceTests
+{
+    namespace
+    {
+        constexpr Format formats[] = { Format::YUY2, Format::NV12, Format::I420 };
+
+        const wchar_t* FormatName(const Format format)
+        {
+            switch (format)
+            {
+            case Format::YUY2:
+                return L"YUY2";
+            case Format::NV12:
+                return L"NV12";
+            default:
+                return L"I420";
+            }
+        }
+
+        struct Image
+        {
+            uint32_t width;
+            uint32_t height;
+            size_t stride;
+            std::vector<uint8_t> bgr;
+
+            const uint8_t* Pixel(const uint32_t x, const uint32_t y) const { return bgr.data() + y * stride + x * 3; }
+        };
+
+        // Rows are padded past the pixels like bitmaps often are, the padding must never be read into the frame
+        Image RandomImage(const uint32_t width, const uint32_t height, const size_t padding, std::mt19937& random)
+        {
+            Image image{ width, height, width * 3 + padding, {} };
+            image.bgr.resize(image.stride * height);
+            std::uniform_int_distribution<int> byte(0, 255);
+            for (auto& value : image.bgr)
+            {
+                value = static_cast<uint8_t>(byte(random));
+            }
+            return image;
+        }
+
+        // Straightforward per-pixel BT.601 studio range formulas, written independently of the converters
+        uint8_t Luma(const uint8_t* bgr)
+        {
+            return static_cast<uint8_t>(((66 * bgr[2] + 129 * bgr[1] + 25 * bgr[0] + 128) >> 8) + 16);
+        }
+
+        uint8_t Cb(const uint8_t* bgr)
+        {
+            return static_cast<uint8_t>(((-38 * bgr[2] - 74 * bgr[1] + 112 * bgr[0] + 128) >> 8) + 128);
+        }
+
+        uint8_t Cr(const uint8_t* bgr)
+        {
+            return static_cast<uint8_t>(((112 * bgr[2] - 94 * bgr[1] - 18 * bgr[0] + 128) >> 8) + 128);
+        }
+
+        uint8_t Average(const int first, const int second)
+        {
+            return static_cast<uint8_t>((first + second + 1) / 2);
+        }
+
+        // Chroma of a pixel pair, and for the 4:2:0 formats the average of the pairs of two rows
+        uint8_t Chroma(const Image& image, uint8_t (*component)(const uint8_t*), const uint32_t x, const uint32_t y, const bool vertical)
+        {
+            const uint8_t top = Average(component(image.Pixel(x, y)), component(image.Pixel(x + 1, y)));
+            if (!vertical)
+            {
+                return top;
+            }
+            return Average(top, Average(component(image.Pixel(x, y + 1)), component(image.Pixel(x + 1, y + 1))));
+        }
+
+        std::vector<uint8_t> ReferenceFrame(const Image& image, const Format format)
+        {
+            const uint32_t width = image.width, height = image.height;
+            std::vector<uint8_t> frame(PixelConversion::FrameSize(format, width, height));
+            if (format == Format::YUY2)
+            {
+                for (uint32_t y = 0; y < height; ++y)
+                {
+                    for (uint32_t x = 0; x < width; x += 2)
+                    {
+                        uint8_t* pair = frame.data() + (static_cast<size_t>(y) * width + x) * 2;
+                        pair[0] = Luma(image.Pixel(x, y));
+                        pair[1] = Chroma(image, Cb, x, y, false);
+                        pair[2] = Luma(image.Pixel(x + 1, y));
+                        pair[3] = Chroma(image, Cr, x, y, false);
+                    }
+                }
+                return frame;
+            }
+
+            const size_t lumaSize = static_cast<size_t>(width) * height;
+            for (uint32_t y = 0; y < height; ++y)
+            {
+                for (uint32_t x = 0; x < width; ++x)
+                {
+                    frame[static_cast<size_t>(y) * width + x] = Luma(image.Pixel(x, y));
+                }
+            }
+            for (uint32_t y = 0; y < height; y += 2)
+            {
+                for (uint32_t x = 0; x < width; x += 2)
+                {
+                    const size_t chromaIndex = static_cast<size_t>(y / 2) * (width / 2) + x / 2;
+                    const uint8_t cb = Chroma(image, Cb, x, y, true);
+                    const uint8_t cr = Chroma(image, Cr, x, y, true);
+                    if (format == Format::NV12)
+                    {
+                        frame[lumaSize + chromaIndex * 2] = cb;
+                        frame[lumaSize + chromaIndex * 2 + 1] = cr;
+                    }
+                    else
+                    {
+                        frame[lumaSize + chromaIndex] = cb;
+                        frame[lumaSize + lumaSize / 4 + chromaIndex] = cr;
+                    }
+                }
+            }
+            return frame;
+        }
+
+        std::vector<uint8_t> Convert(const Image& image, const Format format, const PixelConversion::RowConverter convertRow)
+        {
+            std::vector<uint8_t> frame(PixelConversion::FrameSize(format, image.width, image.height), 0xCD);
+            Assert::IsTrue(PixelConversion::ConvertBGR24(image.bgr.data(), image.stride, image.width, image.height, format, frame.data(), convertRow));
+            return frame;
+        }
+
+        std::vector<PixelConversion::RowConverter> RowConverters()
+        {
+            std::vector<PixelConversion::RowConverter> converters{ &PixelConversion::ConvertRowScalar };
+#if defined(PIXEL_CONVERSION_X86)
+            if (PixelConversion::Detail::HasSSSE3())
+            {
+                converters.push_back(&PixelConversion::Detail::ConvertRowSSSE3);
+            }
+#endif
+            return converters;
+        }
+    }
+
+    TEST_CLASS(PixelConversionTests)
+    {
+    public:
+        TEST_METHOD(ConvertersMatchTheReference)
+        {
+            std::mt19937 random(42);
+            // Widths around the 8 and 16 pixel blocks of the SIMD loops, so every tail length is covered
+            const std::pair<uint32_t, uint32_t> sizes[] = { { 2, 2 }, { 6, 4 }, { 8, 2 }, { 14, 6 }, { 16, 2 }, { 18, 4 }, { 30, 2 }, { 32, 8 }, { 34, 6 }, { 62, 10 }, { 640, 480 }, { 1282, 722 } };
+            for (const auto& [width, height] : sizes)
+            {
+                for (const size_t padding : { 0, 1, 3 })
+                {
+                    const auto image = RandomImage(width, height, padding, random);
+                    for (const Format format : formats)
+                    {
+                        const auto expected = ReferenceFrame(image, format);
+                        for (const auto convertRow : RowConverters())
+                        {
+                            const auto message = std::wstring{ FormatName(format) } + L" " + std::to_wstring(width) + L"x" + std::to_wstring(height) +
+                                                 L" padding " + std::to_wstring(padding) + (convertRow == &PixelConversion::ConvertRowScalar ? L" scalar" : L" SIMD");
+                            Assert::IsTrue(expected == Convert(image, format, convertRow), message.c_str());
+                        }
+                    }
+                }
+            }
+        }
+
+        TEST_METHOD(BestConverterIsUsedByDefault)
+        {
+            std::mt19937 random(7);
+            const auto image = RandomImage(66, 6, 0, random);
+            for (const Format format : formats)
+            {
+                std::vector<uint8_t> frame(PixelConversion::FrameSize(format, image.width, image.height));
+                Assert::IsTrue(PixelConversion::ConvertBGR24(image.bgr.data(), image.stride, image.width, image.height, format, frame.data()));
+                Assert::IsTrue(ReferenceFrame(image, format) == frame, FormatName(format));
+            }
+        }
+
+        TEST_METHOD(StudioRangeColors)
+        {
+            struct Color
+            {
+                uint8_t b, g, r;
+                uint8_t y, u, v;
+            };
+            const Color colors[] = {
+                { 0, 0, 0, 16, 128, 128 },
+                { 255, 255, 255, 235, 128, 128 },
+                { 0, 0, 255, 82, 90, 240 },
+                { 0, 255, 0, 144, 54, 34 },
+                { 255, 0, 0, 41, 240, 110 },
+            };
+
+            for (const auto& color : colors)
+            {
+                const std::vector<uint8_t> bgr{ color.b, color.g, color.r, color.b, color.g, color.r };
+                std::vector<uint8_t> frame(PixelConversion::FrameSize(Format::YUY2, 2, 1));
+                Assert::IsTrue(PixelConversion::ConvertBGR24(bgr.data(), bgr.size(), 2, 1, Format::YUY2, frame.data()));
+                Assert::IsTrue(std::vector<uint8_t>{ color.y, color.u, color.y, color.v } == frame);
+            }
+        }
+
+        // WIC copies the overlay rows top-down and the MFT path was fed the same RGB24 buffer with a positive stride,
+        // the raw YUV formats are top-down as well, so the first bitmap row has to end up as the first frame row
+        TEST_METHOD(RowsStayTopDown)
+        {
+            constexpr uint32_t width = 4, height = 4;
+            std::vector<uint8_t> bgr(width * 3 * height);
+            for (uint32_t x = 0; x < width; ++x)
+            {
+                // Red top half, blue bottom half
+                bgr[x * 3 + 2] = bgr[(width + x) * 3 + 2] = 255;
+                bgr[(2 * width + x) * 3] = bgr[(3 * width + x) * 3] = 255;
+            }
+
+            for (const Format format : formats)
+            {
+                std::vector<uint8_t> frame(PixelConversion::FrameSize(format, width, height));
+                Assert::IsTrue(PixelConversion::ConvertBGR24(bgr.data(), width * 3, width, height, format, frame.data()), FormatName(format));
+
+                const size_t lumaStride = format == Format::YUY2 ? width * 2 : width;
+                Assert::AreEqual(82, static_cast<int>(frame[0]), FormatName(format));
+                Assert::AreEqual(41, static_cast<int>(frame[lumaStride * (height - 1)]), FormatName(format));
+                if (format != Format::YUY2)
+                {
+                    // First chroma row comes from the red rows
+                    Assert::AreEqual(90, static_cast<int>(frame[width * height]), FormatName(format));
+                }
+            }
+        }
+
+        TEST_METHOD(RejectsUnsupportedSizes)
+        {
+            std::vector<uint8_t> bgr(3 * 3 * 3);
+            std::vector<uint8_t> frame(64);
+            Assert::IsFalse(PixelConversion::ConvertBGR24(bgr.data(), 9, 3, 2, Format::YUY2, frame.data()));
+            Assert::IsFalse(PixelConversion::ConvertBGR24(bgr.data(), 9, 2, 3, Format::NV12, frame.data()));
+            Assert::IsFalse(PixelConversion::ConvertBGR24(bgr.data(), 9, 0, 2, Format::I420, frame.data()));
+            Assert::IsFalse(PixelConversion::ConvertBGR24(nullptr, 9, 2, 2, Format::YUY2, frame.data()));
+            Assert::IsFalse(PixelConversion::ConvertBGR24(bgr.data(), 9, 2, 2, Format::YUY2, nullptr));
+            Assert::IsTrue(PixelConversion::ConvertBGR24(bgr.data(), 9, 2, 3, Format::YUY2, frame.data()));
+        }
+
+        // Times preparing an overlay frame against sending it, which is the copy every muted frame costs
+        TEST_METHOD(Benchmark)
+        {
+            using milliseconds = std::chrono::duration<double, std::milli>;
+            struct Resolution
+            {
+                const char* name;
+                uint32_t width, height;
+                int iterations;
+            };
+            const Resolution resolutions[] = { { "720p", 1280, 720, 20 }, { "1080p", 1920, 1080, 10 }, { "4K", 3840, 2160, 3 } };
+
+            std::mt19937 random(1);
+            std::string message;
+            for (const auto& resolution : resolutions)
+            {
+                const auto image = RandomImage(resolution.width, resolution.height, 0, random);
+                for (const Format format : formats)
+                {
+                    std::vector<uint8_t> frame(PixelConversion::FrameSize(format, image.width, image.height));
+                    const std::wstring formatName = FormatName(format);
+                    message += resolution.name + std::string{ " " } + std::string(formatName.begin(), formatName.end()) + ":";
+                    for (const auto convertRow : RowConverters())
+                    {
+                        const auto start = std::chrono::steady_clock::now();
+                        for (int i = 0; i < resolution.iterations; ++i)
+                        {
+                            PixelConversion::ConvertBGR24(image.bgr.data(), image.stride, image.width, image.height, format, frame.data(), convertRow);
+                        }
+                        const milliseconds elapsed = std::chrono::steady_clock::now() - start;
+                        message += (convertRow == &PixelConversion::ConvertRowScalar ? " scalar " : " SIMD ") + std::to_string(elapsed.count() / resolution.iterations) + "ms,";
+                    }
+
+                    std::vector<uint8_t> sample(frame.size());
+                    const auto start = std::chrono::steady_clock::now();
+                    for (int i = 0; i < resolution.iterations; ++i)
+                    {
+                        std::memcpy(sample.data(), frame.data(), frame.size());
+                    }
+                    const milliseconds elapsed = std::chrono::steady_clock::now() - start;
+                    Assert::IsTrue(sample == frame);
+                    message += " muted frame copy " + std::to_string(elapsed.count() / resolution.iterations) + "ms per frame\n";
+                }
+            }
+            Logger::WriteMessage(message.c_str());
+        }
+    };
+}
@@ -5,6 +5,7 @@
 
 #include <common/SettingsAPI/settings_helpers.h>
 #include "powertoy_module.h"
+#include "module_loader.h"
 #include <common/themes/windows_colors.h>
 
 #include "trace.h"
@@ -79,6 +80,11 @@ GeneralSettings get_general_settings()
         settings.isModulesEnabledMap[name] = powertoy->is_enabled();
     }
 
+    for (const auto& name : deferred_powertoy_keys())
+    {
+        settings.isModulesEnabledMap[name] = false;
+    }
+
     return settings;
 }
 
@@ -129,24 +135,26 @@ void apply_general_settings(const json::JsonObject& general_configs, bool save)
                 continue;
             }
             const std::wstring name{ enabled_element.Key().c_str() };
-            const bool found = modules().find(name) != modules().end();
-            if (!found)
+            const bool target_enabled = value.GetBoolean();
+
+            // Disabled modules may not be loaded yet, which is only needed to enable them
+            auto powertoy = target_enabled ? get_or_load_powertoy(name) : (modules().contains(name) ? &modules().at(name) : nullptr);
+            if (!powertoy)
             {
                 continue;
             }
-            const bool module_inst_enabled = modules().at(name)->is_enabled();
-            const bool target_enabled = value.GetBoolean();
+            const bool module_inst_enabled = (*powertoy)->is_enabled();
             if (module_inst_enabled == target_enabled)
             {
                 continue;
             }
             if (target_enabled)
             {
-                modules().at(name)->enable();
+                (*powertoy)->enable();
             }
             else
             {
-                modules().at(name)->disable();
+                (*powertoy)->disable();
             }
         }
     }
@@ -164,7 +172,7 @@ void apply_general_settings(const json::JsonObject& general_configs, bool save)
     }
 }
 
-void start_initial_powertoys()
+void start_initial_powertoys(const std::vector<KnownPowertoy>& known_powertoys)
 {
     std::unordered_set<std::wstring> powertoys_to_disable;
 
@@ -188,21 +196,5 @@ void start_initial_powertoys()
     {
     }
 
-    if (powertoys_to_disable.empty())
-    {
-        for (auto& [name, powertoy] : modules())
-        {
-            powertoy->enable();
-        }
-    }
-    else
-    {
-        for (auto& [name, powertoy] : modules())
-        {
-            if (powertoys_to_disable.find(name) == powertoys_to_disable.end())
-            {
-                powertoy->enable();
-            }
-        }
-    }
+    load_initial_powertoys(known_powertoys, powertoys_to_disable);
 }
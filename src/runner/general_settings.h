@@ -2,6 +2,8 @@
 
 #include <common/utils/json.h>
 
+struct KnownPowertoy;
+
 struct GeneralSettings
 {
     bool isStartupEnabled;
@@ -21,4 +23,4 @@ struct GeneralSettings
 json::JsonObject load_general_settings();
 GeneralSettings get_general_settings();
 void apply_general_settings(const json::JsonObject& general_configs, bool save = true);
-void start_initial_powertoys();
\ No newline at end of file
+void start_initial_powertoys(const std::vector<KnownPowertoy>& known_powertoys);
\ No newline at end of file
@@ -4,6 +4,7 @@
 #include <filesystem>
 #include "tray_icon.h"
 #include "powertoy_module.h"
+#include "module_loader.h"
 #include "trace.h"
 #include "general_settings.h"
 #include "restart_elevated.h"
@@ -49,7 +50,6 @@
 namespace
 {
     const wchar_t PT_URI_PROTOCOL_SCHEME[] = L"powertoys://";
-    const wchar_t POWER_TOYS_MODULE_LOAD_FAIL[] = L"Failed to load "; // Module name will be appended on this message and it is not localized.
 }
 
 void chdir_current_executable()
@@ -131,17 +131,18 @@ int runner(bool isProcessElevated, bool openSettings, bool openOobe)
 
         chdir_current_executable();
         // Load Powertoys DLLs
-
-        std::vector<std::wstring_view> knownModules = {
-            L"modules/FancyZones/FancyZonesModuleInterface.dll",
-            L"modules/FileExplorerPreview/powerpreview.dll",
-            L"modules/ImageResizer/ImageResizerExt.dll",
-            L"modules/KeyboardManager/KeyboardManager.dll",
-            L"modules/Launcher/Microsoft.Launcher.dll",
-            L"modules/PowerRename/PowerRenameExt.dll",
-            L"modules/ShortcutGuide/ShortcutGuideModuleInterface/ShortcutGuideModuleInterface.dll",
-            L"modules/ColorPicker/ColorPicker.dll",
-            L"modules/Awake/AwakeModuleInterface.dll"
+        // File Explorer syncs the registry with its settings when created, so it's loaded even when disabled.
+        // PowerToys Run relaunches itself non-elevated through the shell when enabled, which stays on the main thread
+        std::vector<KnownPowertoy> knownModules = {
+            { L"FancyZones", L"modules/FancyZones/FancyZonesModuleInterface.dll" },
+            { L"File Explorer", L"modules/FileExplorerPreview/powerpreview.dll", true },
+            { L"Image Resizer", L"modules/ImageResizer/ImageResizerExt.dll" },
+            { L"Keyboard Manager", L"modules/KeyboardManager/KeyboardManager.dll" },
+            { L"PowerToys Run", L"modules/Launcher/Microsoft.Launcher.dll", false, true },
+            { L"PowerRename", L"modules/PowerRename/PowerRenameExt.dll" },
+            { L"Shortcut Guide", L"modules/ShortcutGuide/ShortcutGuideModuleInterface/ShortcutGuideModuleInterface.dll" },
+            { L"ColorPicker", L"modules/ColorPicker/ColorPicker.dll" },
+            { L"Awake", L"modules/Awake/AwakeModuleInterface.dll" }
 
         };
         // TODO(yuyoyuppe): uncomment when VCM should be enabled
@@ -149,28 +150,11 @@ int runner(bool isProcessElevated, bool openSettings, bool openOobe)
         //if (const auto mf = LoadLibraryA("mf.dll"))
         //{
         //    FreeLibrary(mf);
-        //    knownModules.emplace_back(VCM_PATH);
+        //    knownModules.push_back({ L"Video Conference", VCM_PATH });
         //}
 
-        for (const auto& moduleSubdir : knownModules)
-        {
-            try
-            {
-                auto pt_module = load_powertoy(moduleSubdir);
-                modules().emplace(pt_module->get_key(), std::move(pt_module));
-            }
-            catch (...)
-            {
-                std::wstring errorMessage = POWER_TOYS_MODULE_LOAD_FAIL;
-                errorMessage += moduleSubdir;
-                MessageBoxW(NULL,
-                            errorMessage.c_str(),
-                            L"PowerToys",
-                            MB_OK | MB_ICONERROR);
-            }
-        }
-        // Start initial powertoys
-        start_initial_powertoys();
+        // Start initial powertoys, the disabled ones are loaded when they're needed
+        start_initial_powertoys(knownModules);
 
         Trace::EventLaunch(get_product_version(), isProcessElevated);
 
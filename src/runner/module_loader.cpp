@@ -0,0 +1,235 @@
+#include "pch.h"
+#include "module_loader.h"
+
+#include <atomic>
+#include <map>
+#include <optional>
+
+#include <common/logger/logger.h>
+
+namespace
+{
+    const wchar_t POWER_TOYS_MODULE_LOAD_FAIL[] = L"Failed to load "; // Module name will be appended on this message and it is not localized.
+
+    using milliseconds = std::chrono::duration<double, std::milli>;
+
+    // Disabled modules which weren't loaded yet, by key
+    std::map<std::wstring, KnownPowertoy> deferred_powertoys;
+    std::mutex deferred_powertoys_mutex;
+
+    struct CreatedPowertoy
+    {
+        const KnownPowertoy* known = nullptr;
+        bool enable = false;
+        HMODULE handle = nullptr;
+        PowertoyModuleIface* pt_module = nullptr;
+        std::chrono::steady_clock::duration loadTime{};
+        std::chrono::steady_clock::duration enableTime{};
+    };
+
+    void show_load_error(const std::wstring& path)
+    {
+        std::wstring errorMessage = POWER_TOYS_MODULE_LOAD_FAIL;
+        errorMessage += path;
+        MessageBoxW(NULL,
+                    errorMessage.c_str(),
+                    L"PowerToys",
+                    MB_OK | MB_ICONERROR);
+    }
+
+    // Loads the module and enables it if it can be done on any thread
+    void create_and_enable(CreatedPowertoy& created)
+    {
+        const auto loadStart = std::chrono::steady_clock::now();
+        try
+        {
+            std::tie(created.handle, created.pt_module) = create_powertoy(created.known->path);
+        }
+        catch (...)
+        {
+            return;
+        }
+        created.loadTime = std::chrono::steady_clock::now() - loadStart;
+
+        if (created.enable && !created.known->enableOnMainThread)
+        {
+            const auto enableStart = std::chrono::steady_clock::now();
+            try
+            {
+                created.pt_module->enable();
+            }
+            catch (...)
+            {
+                Logger::error(L"Failed to enable {} module", created.known->key);
+            }
+            created.enableTime = std::chrono::steady_clock::now() - enableStart;
+        }
+    }
+
+    // Adds the created module to modules() and enables it if it has to be done on the main thread
+    void add_created_powertoy(CreatedPowertoy& created)
+    {
+        if (!created.pt_module)
+        {
+            show_load_error(created.known->path);
+            return;
+        }
+
+        const auto registerStart = std::chrono::steady_clock::now();
+        std::map<std::wstring, PowertoyModule>::iterator it;
+        try
+        {
+            it = modules().emplace(created.pt_module->get_key(), PowertoyModule(created.pt_module, created.handle)).first;
+        }
+        catch (...)
+        {
+            Logger::error(L"Failed to add {} module", created.known->key);
+            show_load_error(created.known->path);
+            return;
+        }
+        const auto registerTime = std::chrono::steady_clock::now() - registerStart;
+
+        if (created.enable && created.known->enableOnMainThread)
+        {
+            const auto enableStart = std::chrono::steady_clock::now();
+            try
+            {
+                it->second->enable();
+            }
+            catch (...)
+            {
+                Logger::error(L"Failed to enable {} module", created.known->key);
+            }
+            created.enableTime = std::chrono::steady_clock::now() - enableStart;
+        }
+
+        Logger::info(L"{} module loaded in {:.1f}ms, hotkeys registered in {:.1f}ms, {} in {:.1f}ms",
+                     created.known->key,
+                     milliseconds(created.loadTime).count(),
+                     milliseconds(registerTime).count(),
+                     created.enable ? L"enabled" : L"left disabled",
+                     milliseconds(created.enableTime).count());
+    }
+}
+
+void load_initial_powertoys(const std::vector<KnownPowertoy>& known_powertoys, const std::unordered_set<std::wstring>& disabled_powertoys)
+{
+    const auto start = std::chrono::steady_clock::now();
+
+    std::vector<CreatedPowertoy> to_create;
+    for (const auto& known : known_powertoys)
+    {
+        const bool enable = !disabled_powertoys.contains(known.key);
+        if (enable || known.loadWhenDisabled)
+        {
+            to_create.push_back({ .known = &known, .enable = enable });
+        }
+        else
+        {
+            std::unique_lock lock{ deferred_powertoys_mutex };
+            deferred_powertoys.emplace(known.key, known);
+        }
+    }
+
+    // Modules are created and enabled on the pool, then handed over to this thread as soon as each of them is ready
+    std::mutex mutex;
+    std::condition_variable created_condition;
+    std::vector<size_t> created_indexes;
+    std::atomic_size_t next_index = 0;
+
+    const size_t pool_size = std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()), to_create.size());
+    std::vector<std::thread> pool;
+
+    // The threads finish on their own, they have to be joined even if handing a module over throws
+    auto join_pool = wil::scope_exit([&] {
+        for (auto& thread : pool)
+        {
+            thread.join();
+        }
+    });
+
+    for (size_t i = 0; i < pool_size; ++i)
+    {
+        pool.emplace_back([&] {
+            // Modules start their processes with ShellExecuteEx, which needs a single-threaded apartment
+            winrt::init_apartment(winrt::apartment_type::single_threaded);
+            for (size_t index = next_index++; index < to_create.size(); index = next_index++)
+            {
+                create_and_enable(to_create[index]);
+
+                std::unique_lock lock{ mutex };
+                created_indexes.push_back(index);
+                created_condition.notify_one();
+            }
+            winrt::uninit_apartment();
+        });
+    }
+
+    for (size_t added = 0; added < to_create.size(); ++added)
+    {
+        size_t index;
+        {
+            std::unique_lock lock{ mutex };
+            created_condition.wait(lock, [&] { return added < created_indexes.size(); });
+            index = created_indexes[added];
+        }
+
+        add_created_powertoy(to_create[index]);
+    }
+    join_pool.reset();
+
+    Logger::info(L"{} of {} modules loaded in {:.1f}ms, on {} threads",
+                 to_create.size(),
+                 known_powertoys.size(),
+                 milliseconds(std::chrono::steady_clock::now() - start).count(),
+                 pool_size);
+}
+
+PowertoyModule* get_or_load_powertoy(const std::wstring& key)
+{
+    auto it = modules().find(key);
+    if (it != modules().end())
+    {
+        return &it->second;
+    }
+
+    std::optional<KnownPowertoy> known;
+    {
+        std::unique_lock lock{ deferred_powertoys_mutex };
+        auto deferred = deferred_powertoys.find(key);
+        if (deferred == deferred_powertoys.end())
+        {
+            return nullptr;
+        }
+
+        known = std::move(deferred->second);
+        deferred_powertoys.erase(deferred);
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    try
+    {
+        auto pt_module = load_powertoy(known->path);
+        it = modules().emplace(pt_module->get_key(), std::move(pt_module)).first;
+    }
+    catch (...)
+    {
+        show_load_error(known->path);
+        return nullptr;
+    }
+
+    Logger::info(L"{} module loaded on demand in {:.1f}ms", key, milliseconds(std::chrono::steady_clock::now() - start).count());
+    return &it->second;
+}
+
+std::vector<std::wstring> deferred_powertoy_keys()
+{
+    std::unique_lock lock{ deferred_powertoys_mutex };
+    std::vector<std::wstring> keys;
+    for (const auto& [key, known] : deferred_powertoys)
+    {
+        keys.push_back(key);
+    }
+
+    return keys;
+}
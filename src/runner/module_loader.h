@@ -0,0 +1,26 @@
+#pragma once
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "powertoy_module.h"
+
+struct KnownPowertoy
+{
+    std::wstring key;
+    std::wstring path;
+    // Loaded at startup even when disabled, since creating the module brings the system in sync with its settings
+    bool loadWhenDisabled = false;
+    // enable() has to run on the main thread instead of the loader pool
+    bool enableOnMainThread = false;
+};
+
+// Loads and enables the modules which aren't disabled concurrently, the others are only loaded on demand.
+// Modules are added to modules() and their hotkeys registered on the calling thread, which has to be the main one
+void load_initial_powertoys(const std::vector<KnownPowertoy>& known_powertoys, const std::unordered_set<std::wstring>& disabled_powertoys);
+
+// Returns the module, loading it first if it was left for later. Main thread only
+PowertoyModule* get_or_load_powertoy(const std::wstring& key);
+
+// Keys of the modules which weren't loaded yet, since they are disabled
+std::vector<std::wstring> deferred_powertoy_keys();
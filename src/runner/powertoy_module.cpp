@@ -11,7 +11,7 @@ std::map<std::wstring, PowertoyModule>& modules()
     return modules;
 }
 
-PowertoyModule load_powertoy(const std::wstring_view filename)
+std::pair<HMODULE, PowertoyModuleIface*> create_powertoy(const std::wstring_view filename)
 {
     auto handle = winrt::check_pointer(LoadLibraryW(filename.data()));
     auto create = reinterpret_cast<powertoy_create_func>(GetProcAddress(handle, "powertoy_create"));
@@ -26,17 +26,23 @@ PowertoyModule load_powertoy(const std::wstring_view filename)
         FreeLibrary(handle);
         winrt::throw_hresult(winrt::hresult(E_POINTER));
     }
+    return { handle, pt_module };
+}
+
+PowertoyModule load_powertoy(const std::wstring_view filename)
+{
+    auto [handle, pt_module] = create_powertoy(filename);
     return PowertoyModule(pt_module, handle);
 }
 
-json::JsonObject PowertoyModule::json_config() const
+std::wstring PowertoyModule::serialized_config() const
 {
     int size = 0;
     pt_module->get_config(nullptr, &size);
     std::wstring result;
     result.resize(size - 1);
     pt_module->get_config(result.data(), &size);
-    return json::JsonObject::Parse(result);
+    return result;
 }
 
 PowertoyModule::PowertoyModule(PowertoyModuleIface* pt_module, HMODULE handle) :
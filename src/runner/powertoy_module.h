@@ -38,7 +38,7 @@ public:
         return pt_module.get();
     }
 
-    json::JsonObject json_config() const;
+    std::wstring serialized_config() const;
 
     void update_hotkeys();
 
@@ -49,5 +49,7 @@ private:
     std::unique_ptr<PowertoyModuleIface, PowertoyModuleDeleter> pt_module;
 };
 
+// Loads the DLL and creates the module, which can be done on any thread
+std::pair<HMODULE, PowertoyModuleIface*> create_powertoy(const std::wstring_view filename);
 PowertoyModule load_powertoy(const std::wstring_view filename);
 std::map<std::wstring, PowertoyModule>& modules();
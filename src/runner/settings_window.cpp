@@ -5,6 +5,7 @@
 #include <aclapi.h>
 
 #include "powertoy_module.h"
+#include "module_loader.h"
 #include <common/interop/two_way_pipe_message_ipc.h>
 #include "tray_icon.h"
 #include "general_settings.h"
@@ -14,6 +15,7 @@
 
 #include <common/utils/json.h>
 #include <common/SettingsAPI/settings_helpers.cpp>
+#include <common/SettingsAPI/settings_cache.h>
 #include <common/version/version.h>
 #include <common/version/helper.h>
 #include <common/logger/logger.h>
@@ -29,30 +31,53 @@
 TwoWayPipeMessageIPC* current_settings_ipc = NULL;
 std::atomic_bool g_isLaunchInProgress = false;
 
-json::JsonObject get_power_toys_settings()
+// Incremented for every Settings process, which gets all the settings in its first update
+std::atomic_uint32_t g_settings_ipc_generation = 0;
+uint32_t g_sent_settings_generation = 0;
+uint64_t g_sent_settings_version = 0;
+
+// Only used from the main thread
+PowerToysSettings::SettingsCache& settings_cache()
 {
-    json::JsonObject result;
+    static PowerToysSettings::SettingsCache cache{ []() -> std::optional<std::wstring> {
+        return std::wstring{ get_general_settings().to_json().Stringify().c_str() };
+    } };
+
     for (const auto& [name, powertoy] : modules())
     {
-        try
-        {
-            result.SetNamedValue(name, powertoy.json_config());
-        }
-        catch (...)
+        if (!cache.has_module(name))
         {
-            Logger::error(L"get_power_toys_settings(): got malformed json for {} module", name);
+            cache.add_module(name, [&powertoy = powertoy, name = name]() -> std::optional<std::wstring> {
+                try
+                {
+                    return powertoy.serialized_config();
+                }
+                catch (...)
+                {
+                    Logger::error(L"settings_cache(): couldn't get the config of {} module", name);
+                    return std::nullopt;
+                }
+            });
         }
     }
-    return result;
+
+    return cache;
 }
 
-json::JsonObject get_all_settings()
+// Sends the settings which changed since the last update of the current Settings process
+void send_settings_update(bool full)
 {
-    json::JsonObject result;
+    auto& cache = settings_cache();
+    const uint32_t generation = g_settings_ipc_generation;
+    if (generation != g_sent_settings_generation)
+    {
+        full = true;
+    }
 
-    result.SetNamedValue(L"general", get_general_settings().to_json());
-    result.SetNamedValue(L"powertoys", get_power_toys_settings());
-    return result;
+    const std::wstring settings_string = full ? cache.full_message() : cache.diff_message(g_sent_settings_version);
+    g_sent_settings_version = cache.version();
+    g_sent_settings_generation = generation;
+    current_settings_ipc->send(settings_string);
 }
 
 std::optional<std::wstring> dispatch_json_action_to_module(const json::JsonObject& powertoys_configs)
@@ -104,10 +129,10 @@ std::optional<std::wstring> dispatch_json_action_to_module(const json::JsonObjec
             {
             }
         }
-        else if (modules().find(name) != modules().end())
+        else if (auto powertoy = get_or_load_powertoy(name))
         {
             const auto element = powertoy_element.Value().Stringify();
-            modules().at(name)->call_custom_action(element.c_str());
+            (*powertoy)->call_custom_action(element.c_str());
         }
     }
 
@@ -116,12 +141,12 @@ std::optional<std::wstring> dispatch_json_action_to_module(const json::JsonObjec
 
 void send_json_config_to_module(const std::wstring& module_key, const std::wstring& settings)
 {
-    auto moduleIt = modules().find(module_key);
-    if (moduleIt != modules().end())
+    // Modules which weren't loaded since they are disabled still get their settings
+    if (auto powertoy = get_or_load_powertoy(module_key))
     {
-        moduleIt->second->set_config(settings.c_str());
-        moduleIt->second.update_hotkeys();
-        moduleIt->second.UpdateHotkeyEx();
+        (*powertoy)->set_config(settings.c_str());
+        powertoy->update_hotkeys();
+        powertoy->UpdateHotkeyEx();
     }
 }
 
@@ -129,8 +154,10 @@ void dispatch_json_config_to_modules(const json::JsonObject& powertoys_configs)
 {
     for (const auto& powertoy_element : powertoys_configs)
     {
+        const std::wstring name{ powertoy_element.Key().c_str() };
         const auto element = powertoy_element.Value().Stringify();
-        send_json_config_to_module(powertoy_element.Key().c_str(), element.c_str());
+        send_json_config_to_module(name, element.c_str());
+        settings_cache().invalidate_module(name);
     }
 };
 
@@ -156,20 +183,37 @@ void dispatch_received_json(const std::wstring& json_to_parse)
 
         if (name == L"general")
         {
+            std::map<std::wstring, bool> enabled_before;
+            for (auto& [module_name, powertoy] : modules())
+            {
+                enabled_before[module_name] = powertoy->is_enabled();
+            }
+
             apply_general_settings(value.GetObjectW());
-            const std::wstring settings_string{ get_all_settings().Stringify().c_str() };
-            current_settings_ipc->send(settings_string);
+
+            // Enabling or disabling a module may change its config too
+            auto& cache = settings_cache();
+            cache.invalidate_general();
+            for (auto& [module_name, powertoy] : modules())
+            {
+                if (enabled_before[module_name] != powertoy->is_enabled())
+                {
+                    cache.invalidate_module(module_name);
+                }
+            }
+
+            send_settings_update(false);
         }
         else if (name == L"powertoys")
         {
             dispatch_json_config_to_modules(value.GetObjectW());
-            const std::wstring settings_string{ get_all_settings().Stringify().c_str() };
-            current_settings_ipc->send(settings_string);
+            send_settings_update(false);
         }
         else if (name == L"refresh")
         {
-            const std::wstring settings_string{ get_all_settings().Stringify().c_str() };
-            current_settings_ipc->send(settings_string);
+            // Modules can change their settings on their own, so read all of them again
+            settings_cache().invalidate_all();
+            send_settings_update(true);
         }
         else if (name == L"action")
         {
@@ -388,6 +432,7 @@ void run_settings_window(bool showOobeWindow)
         goto LExit;
     }
 
+    ++g_settings_ipc_generation;
     current_settings_ipc = new TwoWayPipeMessageIPC(powertoys_pipe_name, settings_pipe_name, receive_json_send_to_main_thread);
     current_settings_ipc->start(hToken);
     g_settings_process_id = process_info.dwProcessId;
@@ -1,8 +1,13 @@
 #include "InstallationFolder.h"
 
+#include <algorithm>
+#include <execution>
 #include <fstream>
+#include <future>
 #include <set>
+#include <vector>
 #include <Windows.h>
+#include <bcrypt.h>
 #include <common/utils/winapi_error.h>
 
 using namespace std;
@@ -60,22 +65,118 @@ optional<path> GetRootPath()
 	return std::filesystem::canonical(rootPath);
 }
 
+namespace
+{
+	// Large reads keep the disk busy; the buffer is per thread since files are hashed in parallel
+	constexpr DWORD hashBufferSize = 1024 * 1024;
+
+	// Directories up to this depth are walked on their own thread
+	constexpr int parallelWalkDepth = 1;
+
+	struct Md5Provider
+	{
+		BCRYPT_ALG_HANDLE handle = nullptr;
+		NTSTATUS status = 0;
+
+		Md5Provider()
+		{
+			status = BCryptOpenAlgorithmProvider(&handle, BCRYPT_MD5_ALGORITHM, nullptr, 0);
+		}
+
+		~Md5Provider()
+		{
+			if (handle)
+			{
+				BCryptCloseAlgorithmProvider(handle, 0);
+			}
+		}
+	};
+
+	// The provider is thread safe and opening it is costly, share one across all hashing threads
+	const Md5Provider& GetMd5Provider()
+	{
+		static Md5Provider provider;
+		return provider;
+	}
+
+	struct Entry
+	{
+		path filePath;
+		wstring name;
+		int indentation = 0;
+		bool isDirectory = false;
+		// Version and checksum for files, error text for directories that failed to list
+		wstring details;
+	};
+
+	// Lists dirPath depth first in the same (sorted) order the report is written in
+	void CollectEntries(const path& dirPath, int indentation, vector<Entry>& entries)
+	{
+		set<pair<path, bool>> paths;
+		try
+		{
+			directory_iterator end_it;
+			for (directory_iterator it(dirPath); it != end_it; ++it)
+			{
+				paths.insert({ it->path(), it->is_directory() });
+			}
+		}
+		catch (filesystem::filesystem_error err)
+		{
+			Entry error;
+			error.indentation = -1;
+			string what = err.what();
+			error.details = wstring(what.begin(), what.end());
+			entries.push_back(std::move(error));
+		}
+
+		vector<pair<size_t, future<vector<Entry>>>> subtrees;
+		for (auto filePair : paths)
+		{
+			Entry entry;
+			entry.filePath = filePair.first;
+			entry.isDirectory = filePair.second;
+			entry.indentation = indentation;
+			entry.name = entry.filePath.wstring().substr(dirPath.wstring().size() + 1);
+			entries.push_back(std::move(entry));
+
+			if (filePair.second)
+			{
+				if (indentation / 2 < parallelWalkDepth)
+				{
+					auto subPath = filePair.first;
+					subtrees.emplace_back(entries.size(), async(launch::async, [subPath, indentation]() {
+						vector<Entry> subEntries;
+						CollectEntries(subPath, indentation + 2, subEntries);
+						return subEntries;
+					}));
+				}
+				else
+				{
+					CollectEntries(filePair.first, indentation + 2, entries);
+				}
+			}
+		}
+
+		// Splice the subtrees walked in parallel back in, last first so the insert positions stay valid
+		for (auto it = subtrees.rbegin(); it != subtrees.rend(); ++it)
+		{
+			auto subEntries = it->second.get();
+			entries.insert(entries.begin() + it->first, make_move_iterator(subEntries.begin()), make_move_iterator(subEntries.end()));
+		}
+	}
+}
+
 wstring GetChecksum(path filePath)
 {
-	DWORD dwStatus = 0;
-	BOOL bResult = FALSE;
-	HCRYPTPROV hProv = 0;
-	HCRYPTHASH hHash = 0;
-	HANDLE hFile = NULL;
-	constexpr int bufferSize = 1024;
-	BYTE rgbFile[bufferSize];
-	DWORD cbRead = 0;
 	constexpr int md5Length = 16;
 	BYTE rgbHash[md5Length];
-	DWORD cbHash = 0;
 	CHAR rgbDigits[] = "0123456789abcdef";
+	thread_local unique_ptr<BYTE[]> rgbFile = make_unique<BYTE[]>(hashBufferSize);
+	DWORD cbRead = 0;
+	BOOL bResult = FALSE;
 	LPCWSTR filename = filePath.c_str();
-	hFile = CreateFile(filename,
+	HANDLE hFile = CreateFile(filename,
 		GENERIC_READ,
 		FILE_SHARE_READ,
 		NULL,
@@ -88,53 +189,50 @@ wstring GetChecksum(path filePath)
 		return L"CreateFile() failed. " + get_last_error_or_default(GetLastError());
 	}
 
-	// Get handle to the crypto provider
-	if (!CryptAcquireContext(&hProv,
-		NULL,
-		NULL,
-		PROV_RSA_FULL,
-		CRYPT_VERIFYCONTEXT))
+	const auto& provider = GetMd5Provider();
+	if (!BCRYPT_SUCCESS(provider.status))
 	{
 		CloseHandle(hFile);
-		return L"CryptAcquireContext() failed. " + get_last_error_or_default(GetLastError());
+		return L"BCryptOpenAlgorithmProvider() failed. NTSTATUS " + to_wstring(provider.status);
 	}
 
-	if (!CryptCreateHash(hProv, CALG_MD5, 0, 0, &hHash))
+	BCRYPT_HASH_HANDLE hHash = nullptr;
+	NTSTATUS status = BCryptCreateHash(provider.handle, &hHash, nullptr, 0, nullptr, 0, 0);
+	if (!BCRYPT_SUCCESS(status))
 	{
 		CloseHandle(hFile);
-		CryptReleaseContext(hProv, 0);
-		return L"CryptCreateHash() failed. " + get_last_error_or_default(GetLastError());
+		return L"BCryptCreateHash() failed. NTSTATUS " + to_wstring(status);
 	}
 
-	while (bResult = ReadFile(hFile, rgbFile, bufferSize, &cbRead, NULL))
+	while (bResult = ReadFile(hFile, rgbFile.get(), hashBufferSize, &cbRead, NULL))
 	{
 		if (0 == cbRead)
 		{
 			break;
 		}
 
-		if (!CryptHashData(hHash, rgbFile, cbRead, 0))
+		status = BCryptHashData(hHash, rgbFile.get(), cbRead, 0);
+		if (!BCRYPT_SUCCESS(status))
 		{
-			CryptReleaseContext(hProv, 0);
-			CryptDestroyHash(hHash);
+			BCryptDestroyHash(hHash);
 			CloseHandle(hFile);
-			return L"CryptHashData() failed. " + get_last_error_or_default(GetLastError());;
+			return L"BCryptHashData() failed. NTSTATUS " + to_wstring(status);
 		}
 	}
 
 	if (!bResult)
 	{
-		CryptReleaseContext(hProv, 0);
-		CryptDestroyHash(hHash);
+		auto error = GetLastError();
+		BCryptDestroyHash(hHash);
 		CloseHandle(hFile);
-		return L"ReadFile() failed. " + get_last_error_or_default(GetLastError());;
+		return L"ReadFile() failed. " + get_last_error_or_default(error);
 	}
 
-	cbHash = md5Length;
 	std::wstring result = L"";
-	if (CryptGetHashParam(hHash, HP_HASHVAL, rgbHash, &cbHash, 0))
+	status = BCryptFinishHash(hHash, rgbHash, md5Length, 0);
+	if (BCRYPT_SUCCESS(status))
 	{
-		for (DWORD i = 0; i < cbHash; i++)
+		for (DWORD i = 0; i < md5Length; i++)
 		{
 			result += rgbDigits[rgbHash[i] >> 4];
 			result += rgbDigits[rgbHash[i] & 0xf];
@@ -142,11 +240,10 @@ wstring GetChecksum(path filePath)
 	}
 	else
 	{
-		std::wstring result = L"CryptGetHashParam() failed. " + get_last_error_or_default(GetLastError());;
+		result = L"BCryptFinishHash() failed. NTSTATUS " + to_wstring(status);
 	}
 
-	CryptDestroyHash(hHash);
-	CryptReleaseContext(hProv, 0);
+	BCryptDestroyHash(hHash);
 	CloseHandle(hFile);
 
 	return result;
@@ -156,52 +253,45 @@ class Reporter
 {
 private:
 	std::wofstream os;
-	std::wofstream GetOutputStream(const path& tmpDir)
+	std::wofstream GetOutputStream(const path& reportPath)
 	{
-		auto path = tmpDir;
-		path += "installationFolderStructure.txt";
-		std::wofstream os = std::wofstream(path);
+		std::wofstream os = std::wofstream(reportPath);
 		return os;
 	}
 public:
-	Reporter(const path& tmpDir)
+	Reporter(const path& reportPath)
 	{
-		os = GetOutputStream(tmpDir);
+		os = GetOutputStream(reportPath);
 	}
 
-	void Report(path dirPath, int indentation = 0)
+	void Report(path dirPath)
 	{
-		set<pair<path, bool>> paths;
-		try
-		{
-			directory_iterator end_it;
-			for (directory_iterator it(dirPath); it != end_it; ++it)
+		// Walk first, then hash every file in parallel, then write the lines in walk order
+		vector<Entry> entries;
+		CollectEntries(dirPath, 0, entries);
+
+		for_each(execution::par, entries.begin(), entries.end(), [](Entry& entry) {
+			if (entry.indentation >= 0 && !entry.isDirectory)
 			{
-				paths.insert({ it->path(), it->is_directory() });
+				entry.details = GetVersion(entry.filePath) + L" " + GetChecksum(entry.filePath);
 			}
-		}
-		catch (filesystem::filesystem_error err)
-		{
-			os << err.what() << endl;
-		}
+		});
 
-		for (auto filePair : paths)
+		for (const auto& entry : entries)
 		{
-			auto filePath = filePair.first;
-			auto isDirectory = filePair.second;
-
-			auto fileName = filePath.wstring().substr(dirPath.wstring().size() + 1);
-			os << wstring(indentation, ' ') << fileName << " ";
-			if (!isDirectory)
+			if (entry.indentation < 0)
 			{
-				os << GetVersion(filePath) << " " << GetChecksum(filePath);
+				os << entry.details << endl;
+				continue;
 			}
 
-			os << endl;
-			if (isDirectory)
+			os << wstring(entry.indentation, ' ') << entry.name << " ";
+			if (!entry.isDirectory)
 			{
-				Report(filePath, indentation + 2);
+				os << entry.details;
 			}
+
+			os << endl;
 		}
 	}
 };
@@ -211,6 +301,13 @@ void InstallationFolder::ReportStructure(const path& tmpDir)
 	auto rootPath = GetRootPath();
 	if (rootPath)
 	{
-		Reporter(tmpDir).Report(rootPath.value());
+		auto reportPath = tmpDir;
+		reportPath += "installationFolderStructure.txt";
+		ReportStructure(rootPath.value(), reportPath);
 	}
 }
+
+void InstallationFolder::ReportStructure(const path& rootPath, const path& reportPath)
+{
+	Reporter(reportPath).Report(rootPath);
+}
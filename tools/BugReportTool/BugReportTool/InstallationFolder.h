@@ -4,4 +4,7 @@
 namespace InstallationFolder
 {
 	void ReportStructure(const std::filesystem::path& tmpDir);
+
+	// Writes the structure, versions and checksums of every file under rootPath to reportPath
+	void ReportStructure(const std::filesystem::path& rootPath, const std::filesystem::path& reportPath);
 };
@@ -0,0 +1,474 @@
+#include "JsonRedactor.h"
+
+#include <cstdint>
+
+namespace
+{
+    // Deeper documents are rejected rather than risking the stack, settings files are a handful of levels deep
+    constexpr int maxDepth = 512;
+
+    struct ParseError
+    {
+    };
+
+    void AppendUtf8(std::string& out, uint32_t codePoint)
+    {
+        if (codePoint < 0x80)
+        {
+            out += static_cast<char>(codePoint);
+        }
+        else if (codePoint < 0x800)
+        {
+            out += static_cast<char>(0xC0 | (codePoint >> 6));
+            out += static_cast<char>(0x80 | (codePoint & 0x3F));
+        }
+        else if (codePoint < 0x10000)
+        {
+            out += static_cast<char>(0xE0 | (codePoint >> 12));
+            out += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (codePoint & 0x3F));
+        }
+        else
+        {
+            out += static_cast<char>(0xF0 | (codePoint >> 18));
+            out += static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F));
+            out += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (codePoint & 0x3F));
+        }
+    }
+}
+
+// Recursive descent over the input that echoes every character to the output, except while a redacted
+// value is being skipped.
+class JsonRedactor::Parser
+{
+public:
+    Parser(std::streambuf* input, std::streambuf* output) :
+        input(input), output(output)
+    {
+    }
+
+    void ReadDocument(const Node* root)
+    {
+        // Keep a UTF-8 byte order mark if there is one
+        if (Peek() == 0xEF)
+        {
+            Expect('\xEF');
+            Expect('\xBB');
+            Expect('\xBF');
+        }
+
+        SkipWhitespace();
+        ReadValue(root, 0);
+        SkipWhitespace();
+        if (Peek() != std::char_traits<char>::eof())
+        {
+            throw ParseError{};
+        }
+    }
+
+private:
+    int Peek()
+    {
+        return input->sgetc();
+    }
+
+    char Next()
+    {
+        const int ch = input->sbumpc();
+        if (ch == std::char_traits<char>::eof())
+        {
+            throw ParseError{};
+        }
+
+        if (!skipping)
+        {
+            Put(static_cast<char>(ch));
+        }
+
+        return static_cast<char>(ch);
+    }
+
+    void Expect(char expected)
+    {
+        if (Next() != expected)
+        {
+            throw ParseError{};
+        }
+    }
+
+    void Put(char ch)
+    {
+        if (output->sputc(ch) == std::char_traits<char>::eof())
+        {
+            throw ParseError{};
+        }
+    }
+
+    void SkipWhitespace()
+    {
+        for (int ch = Peek(); ch == ' ' || ch == '\t' || ch == '\n' || ch == '\r'; ch = Peek())
+        {
+            Next();
+        }
+    }
+
+    uint32_t ReadHex4()
+    {
+        uint32_t value = 0;
+        for (int i = 0; i < 4; ++i)
+        {
+            const char ch = Next();
+            value <<= 4;
+            if (ch >= '0' && ch <= '9')
+            {
+                value |= ch - '0';
+            }
+            else if (ch >= 'a' && ch <= 'f')
+            {
+                value |= ch - 'a' + 10;
+            }
+            else if (ch >= 'A' && ch <= 'F')
+            {
+                value |= ch - 'A' + 10;
+            }
+            else
+            {
+                throw ParseError{};
+            }
+        }
+
+        return value;
+    }
+
+    // When decoded is given it receives the unescaped UTF-8 text. That is only needed for keys which can
+    // still match an xpath, everything else is just copied.
+    void ReadString(std::string* decoded)
+    {
+        Expect('"');
+        for (;;)
+        {
+            const char ch = Next();
+            if (ch == '"')
+            {
+                return;
+            }
+
+            if (static_cast<unsigned char>(ch) < 0x20)
+            {
+                throw ParseError{};
+            }
+
+            if (ch != '\\')
+            {
+                if (decoded)
+                {
+                    *decoded += ch;
+                }
+
+                continue;
+            }
+
+            const char escaped = Next();
+            uint32_t codePoint = 0;
+            switch (escaped)
+            {
+            case '"':
+            case '\\':
+            case '/':
+                codePoint = escaped;
+                break;
+            case 'b':
+                codePoint = '\b';
+                break;
+            case 'f':
+                codePoint = '\f';
+                break;
+            case 'n':
+                codePoint = '\n';
+                break;
+            case 'r':
+                codePoint = '\r';
+                break;
+            case 't':
+                codePoint = '\t';
+                break;
+            case 'u':
+                codePoint = ReadHex4();
+                if (codePoint >= 0xD800 && codePoint <= 0xDBFF && Peek() == '\\')
+                {
+                    Expect('\\');
+                    Expect('u');
+                    const uint32_t low = ReadHex4();
+                    if (low < 0xDC00 || low > 0xDFFF)
+                    {
+                        throw ParseError{};
+                    }
+
+                    codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+                }
+                break;
+            default:
+                throw ParseError{};
+            }
+
+            if (decoded)
+            {
+                AppendUtf8(*decoded, codePoint);
+            }
+        }
+    }
+
+    // true, false and null
+    void ReadKeyword(const char* keyword)
+    {
+        for (; *keyword; ++keyword)
+        {
+            Expect(*keyword);
+        }
+    }
+
+    bool PeekDigit()
+    {
+        const int ch = Peek();
+        return ch >= '0' && ch <= '9';
+    }
+
+    // At least one digit
+    void ReadDigits()
+    {
+        if (!PeekDigit())
+        {
+            throw ParseError{};
+        }
+
+        while (PeekDigit())
+        {
+            Next();
+        }
+    }
+
+    // -?(0|[1-9][0-9]*)(.[0-9]+)?([eE][+-]?[0-9]+)?, a leading zero followed by more digits is caught by the caller
+    // as a missing separator
+    void ReadNumber()
+    {
+        if (Peek() == '-')
+        {
+            Next();
+        }
+
+        if (Peek() == '0')
+        {
+            Next();
+        }
+        else
+        {
+            ReadDigits();
+        }
+
+        if (Peek() == '.')
+        {
+            Next();
+            ReadDigits();
+        }
+
+        if (Peek() == 'e' || Peek() == 'E')
+        {
+            Next();
+            if (Peek() == '+' || Peek() == '-')
+            {
+                Next();
+            }
+
+            ReadDigits();
+        }
+    }
+
+    void ReadObject(const Node* node, int depth)
+    {
+        Expect('{');
+        SkipWhitespace();
+        if (Peek() == '}')
+        {
+            Next();
+            return;
+        }
+
+        std::string key;
+        for (;;)
+        {
+            SkipWhitespace();
+
+            const bool matching = node && !node->children.empty();
+            key.clear();
+            ReadString(matching ? &key : nullptr);
+
+            SkipWhitespace();
+            Expect(':');
+            SkipWhitespace();
+
+            const Node* child = nullptr;
+            if (matching)
+            {
+                auto it = node->children.find(key);
+                if (it != node->children.end())
+                {
+                    child = it->second.get();
+                }
+            }
+
+            if (child && child->redact)
+            {
+                skipping = true;
+                ReadValue(nullptr, depth + 1);
+                skipping = false;
+
+                Put('"');
+                for (const char* ch = PrivateDataValue; *ch; ++ch)
+                {
+                    Put(*ch);
+                }
+                Put('"');
+            }
+            else
+            {
+                ReadValue(child, depth + 1);
+            }
+
+            SkipWhitespace();
+            const char separator = Next();
+            if (separator == '}')
+            {
+                return;
+            }
+
+            if (separator != ',')
+            {
+                throw ParseError{};
+            }
+        }
+    }
+
+    void ReadArray(const Node* node, int depth)
+    {
+        Expect('[');
+        SkipWhitespace();
+        if (Peek() == ']')
+        {
+            Next();
+            return;
+        }
+
+        for (;;)
+        {
+            SkipWhitespace();
+
+            // Arrays do not consume a path element, each item is matched against the same node
+            ReadValue(node, depth + 1);
+
+            SkipWhitespace();
+            const char separator = Next();
+            if (separator == ']')
+            {
+                return;
+            }
+
+            if (separator != ',')
+            {
+                throw ParseError{};
+            }
+        }
+    }
+
+    void ReadValue(const Node* node, int depth)
+    {
+        if (depth > maxDepth)
+        {
+            throw ParseError{};
+        }
+
+        switch (Peek())
+        {
+        case '{':
+            ReadObject(node, depth);
+            break;
+        case '[':
+            ReadArray(node, depth);
+            break;
+        case '"':
+            ReadString(nullptr);
+            break;
+        case 't':
+            ReadKeyword("true");
+            break;
+        case 'f':
+            ReadKeyword("false");
+            break;
+        case 'n':
+            ReadKeyword("null");
+            break;
+        default:
+            ReadNumber();
+            break;
+        }
+    }
+
+    std::streambuf* input;
+    std::streambuf* output;
+    bool skipping = false;
+};
+
+JsonRedactor::JsonRedactor(const std::vector<std::string>& xpaths)
+{
+    for (const auto& xpath : xpaths)
+    {
+        Node* node = &root;
+        size_t begin = 0;
+        while (begin < xpath.size())
+        {
+            size_t end = xpath.find('/', begin);
+            if (end == std::string::npos)
+            {
+                end = xpath.size();
+            }
+
+            if (end > begin)
+            {
+                auto& child = node->children[xpath.substr(begin, end - begin)];
+                if (!child)
+                {
+                    child = std::make_unique<Node>();
+                }
+
+                node = child.get();
+            }
+
+            begin = end + 1;
+        }
+
+        if (node != &root)
+        {
+            node->redact = true;
+        }
+    }
+}
+
+bool JsonRedactor::Redact(std::istream& input, std::ostream& output) const
+{
+    if (!input.rdbuf() || !output.rdbuf())
+    {
+        return false;
+    }
+
+    try
+    {
+        Parser(input.rdbuf(), output.rdbuf()).ReadDocument(&root);
+    }
+    catch (ParseError)
+    {
+        return false;
+    }
+
+    output.flush();
+    return !output.fail();
+}
@@ -0,0 +1,34 @@
+#pragma once
+#include <istream>
+#include <map>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Replaces the values found at the given xpaths (e.g. "app-zone-history/app-path") with "<private_data>"
+// while copying the json from input to output in a single pass. No document is built, so memory use does
+// not depend on the size of the input. Arrays are traversed transparently, as if each element was at the
+// array's position in the path. Formatting of everything that is not redacted is preserved byte for byte.
+// Only depends on the standard library.
+class JsonRedactor
+{
+public:
+    explicit JsonRedactor(const std::vector<std::string>& xpaths);
+
+    // Returns false if the input is not valid json, the output is incomplete in that case
+    bool Redact(std::istream& input, std::ostream& output) const;
+
+    static constexpr const char* PrivateDataValue = "<private_data>";
+
+private:
+    class Parser;
+
+    struct Node
+    {
+        std::map<std::string, std::unique_ptr<Node>, std::less<>> children;
+        bool redact = false;
+    };
+
+    Node root;
+};
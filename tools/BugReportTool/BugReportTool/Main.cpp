@@ -18,14 +18,15 @@
 #include "RegistryUtils.h"
 #include "EventViewer.h"
 #include "InstallationFolder.h"
+#include "JsonRedactor.h"
 
 using namespace std;
 using namespace std::filesystem;
 using namespace winrt::Windows::Data::Json;
 
-map<wstring, vector<wstring>> escapeInfo = {
-    { L"FancyZones\\app-zone-history.json", { L"app-zone-history/app-path" } },
-    { L"FancyZones\\settings.json", { L"properties/fancyzones_excluded_apps" } }
+map<wstring, vector<string>> escapeInfo = {
+    { L"FancyZones\\app-zone-history.json", { "app-zone-history/app-path" } },
+    { L"FancyZones\\settings.json", { "properties/fancyzones_excluded_apps" } }
 };
 
 vector<wstring> filesToDelete = {
@@ -36,92 +37,34 @@ vector<wstring> filesToDelete = {
     L"PowerToys Run\\Settings\\QueryHistory.json"
 };
 
-vector<wstring> GetXpathArray(wstring xpath)
-{
-    vector<wstring> result;
-    wstring cur = L"";
-    for (auto ch : xpath)
-    {
-        if (ch == L'/')
-        {
-            result.push_back(cur);
-            cur = L"";
-            continue;
-        }
-
-        cur += ch;
-    }
-
-    if (!cur.empty())
-    {
-        result.push_back(cur);
-    }
-
-    return result;
-}
-
-void HideByXPath(IJsonValue& val, vector<wstring>& xpathArray, int p)
+void HideForFile(const path& dir, const wstring& relativePath)
 {
-    if (val.ValueType() == JsonValueType::Array)
-    {
-        for (auto it : val.GetArray())
-        {
-            HideByXPath(it, xpathArray, p);
-        }
-
-        return;
-    }
-
-    if (p == xpathArray.size() - 1)
-    {
-        if (val.ValueType() == JsonValueType::Object)
-        {
-            auto obj = val.GetObjectW();
-            if (obj.HasKey(xpathArray[p]))
-            {
-                auto privateDatavalue = JsonValue::CreateStringValue(L"<private_data>");
-                obj.SetNamedValue(xpathArray[p], privateDatavalue);
-            }
-        }
-
-        return;
-    }
+    path jsonPath = dir;
+    jsonPath.append(relativePath);
+    path redactedPath = jsonPath;
+    redactedPath += L".redacted";
 
-    if (val.ValueType() == JsonValueType::Object)
+    bool redacted = false;
     {
-        IJsonValue newVal;
-        try
-        {
-            newVal = val.GetObjectW().GetNamedValue(xpathArray[p]);
-        }
-        catch (...)
-        {
-            return;
-        }
-
-        HideByXPath(newVal, xpathArray, p + 1);
+        ifstream input(jsonPath, ios::binary);
+        ofstream output(redactedPath, ios::binary);
+        redacted = input && output && JsonRedactor(escapeInfo[relativePath]).Redact(input, output);
     }
-}
 
-void HideForFile(const path& dir, const wstring& relativePath)
-{
-    path jsonPath = dir;
-    jsonPath.append(relativePath);
-    auto jObject = json::from_file(jsonPath.wstring());
-    if (!jObject.has_value())
+    error_code err;
+    if (!redacted)
     {
         wprintf(L"Failed to parse file %s\n", jsonPath.c_str());
+        remove(redactedPath, err);
         return;
     }
 
-    JsonValue jValue = json::value(jObject.value());
-    for (auto xpath : escapeInfo[relativePath])
+    rename(redactedPath, jsonPath, err);
+    if (err.value() != 0)
     {
-        vector<wstring> xpathArray = GetXpathArray(xpath);
-        HideByXPath(jValue, xpathArray, 0);
+        wprintf(L"Failed to replace file %s. Error code: %d\n", jsonPath.c_str(), err.value());
+        remove(redactedPath, err);
     }
-
-    json::to_file(jsonPath.wstring(), jObject.value());
 }
 
 bool DeleteFolder(wstring path)
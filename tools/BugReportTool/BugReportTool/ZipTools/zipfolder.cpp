@@ -1,28 +1,154 @@
 #include "ZipFolder.h"
-#include "..\..\..\..\deps\cziplib\src\zip.h"
+
+#include <algorithm>
+#include <deque>
+#include <fstream>
+#include <future>
+#include <string>
+#include <thread>
+#include <vector>
+
+// zip.c compiles the miniz implementation, only the declarations are needed here
+#define MINIZ_HEADER_FILE_ONLY
+#include "..\..\..\..\deps\cziplib\src\miniz.h"
+
+namespace
+{
+    // Files above this size are compressed by miniz while streaming from disk instead of being loaded in memory
+    constexpr uintmax_t maxInMemoryEntrySize = 64 * 1024 * 1024;
+
+    struct ZipEntry
+    {
+        std::filesystem::path path;
+        std::string name;
+        uintmax_t size = 0;
+    };
+
+    struct CompressedEntry
+    {
+        bool valid = false;
+        void* data = nullptr;
+        size_t compressedSize = 0;
+        size_t uncompressedSize = 0;
+        mz_uint32 crc32 = 0;
+    };
+
+    std::vector<ZipEntry> CollectEntries(const std::filesystem::path& folderPath)
+    {
+        std::vector<ZipEntry> entries;
+        for (const auto& dirEntry : std::filesystem::recursive_directory_iterator(folderPath))
+        {
+            if (dirEntry.is_regular_file())
+            {
+                ZipEntry entry;
+                entry.path = dirEntry.path();
+                // miniz rejects names starting with a separator, so they must be relative without a leading '/'
+                entry.name = entry.path.lexically_relative(folderPath).generic_string();
+                entry.size = dirEntry.file_size();
+                entries.push_back(std::move(entry));
+            }
+        }
+        return entries;
+    }
+
+    // Reads and deflates a whole file. Runs on worker threads, the result is appended in order by the caller.
+    CompressedEntry Compress(const ZipEntry& entry)
+    {
+        CompressedEntry result;
+        std::ifstream file(entry.path, std::ios::binary);
+        if (!file)
+        {
+            return result;
+        }
+
+        std::vector<char> content(static_cast<size_t>(entry.size));
+        if (!content.empty() && !file.read(content.data(), content.size()))
+        {
+            return result;
+        }
+
+        result.uncompressedSize = content.size();
+        result.crc32 = static_cast<mz_uint32>(mz_crc32(MZ_CRC32_INIT, reinterpret_cast<const unsigned char*>(content.data()), content.size()));
+
+        // Raw deflate stream (negative window bits), which is what zip entries contain
+        const int flags = tdefl_create_comp_flags_from_zip_params(MZ_DEFAULT_LEVEL, -MZ_DEFAULT_WINDOW_BITS, MZ_DEFAULT_STRATEGY);
+        result.data = tdefl_compress_mem_to_heap(content.data(), content.size(), &result.compressedSize, flags);
+        result.valid = content.empty() || result.data != nullptr;
+        return result;
+    }
+}
 
 void ZipFolder(std::filesystem::path zipPath, std::filesystem::path folderPath)
 {
-    struct zip_t* zip = zip_open(zipPath.string().c_str(), ZIP_DEFAULT_COMPRESSION_LEVEL, 'w');
-    if (!zip)
+    mz_zip_archive zip{};
+    if (!mz_zip_writer_init_file(&zip, zipPath.string().c_str(), 0))
     {
         printf("Can not open zip.");
         throw -1;
     }
 
-    using recursive_directory_iterator = std::filesystem::recursive_directory_iterator;
-    const size_t rootSize = folderPath.wstring().size();
-    for (const auto& dirEntry : recursive_directory_iterator(folderPath))
+    const auto entries = CollectEntries(folderPath);
+
+    // Deflate several entries concurrently but append them in walk order so the archive is deterministic.
+    // The window bounds how many compressed files are held in memory at once.
+    const size_t window = std::max(2u, std::thread::hardware_concurrency());
+    std::deque<std::pair<const ZipEntry*, std::future<CompressedEntry>>> pending;
+    size_t next = 0;
+
+    auto schedule = [&]() {
+        while (next < entries.size() && pending.size() < window)
+        {
+            const ZipEntry& entry = entries[next++];
+            if (entry.size > maxInMemoryEntrySize)
+            {
+                pending.emplace_back(&entry, std::future<CompressedEntry>{});
+            }
+            else
+            {
+                pending.emplace_back(&entry, std::async(std::launch::async, Compress, std::cref(entry)));
+            }
+        }
+    };
+
+    schedule();
+    while (!pending.empty())
     {
-        if (dirEntry.is_regular_file())
+        auto [entry, future] = std::move(pending.front());
+        pending.pop_front();
+        schedule();
+
+        mz_bool added = MZ_FALSE;
+        if (!future.valid())
+        {
+            added = mz_zip_writer_add_file(&zip, entry->name.c_str(), entry->path.string().c_str(), nullptr, 0, MZ_DEFAULT_LEVEL);
+        }
+        else
         {
-            auto path = dirEntry.path().string();
-            auto relativePath = path.substr(rootSize, path.size());
-            zip_entry_open(zip, relativePath.c_str());
-            zip_entry_fwrite(zip, path.c_str());
-            zip_entry_close(zip);
+            auto compressed = future.get();
+            if (compressed.valid)
+            {
+                added = mz_zip_writer_add_mem_ex(&zip, entry->name.c_str(), compressed.data, compressed.compressedSize, nullptr, 0, MZ_DEFAULT_LEVEL | MZ_ZIP_FLAG_COMPRESSED_DATA, compressed.uncompressedSize, compressed.crc32);
+            }
+            else
+            {
+                // Could not read it up front (e.g. locked log file), let miniz try on its own
+                added = mz_zip_writer_add_file(&zip, entry->name.c_str(), entry->path.string().c_str(), nullptr, 0, MZ_DEFAULT_LEVEL);
+            }
+            mz_free(compressed.data);
+        }
+
+        // A missing entry only makes the report incomplete, the remaining files are still worth zipping
+        if (!added)
+        {
+            printf("Failed to add %s to the zip.\n", entry->name.c_str());
         }
     }
 
-    zip_close(zip);
+    const bool finalized = mz_zip_writer_finalize_archive(&zip);
+    mz_zip_writer_end(&zip);
+    if (!finalized)
+    {
+        printf("Can not finalize zip.");
+        throw -1;
+    }
 }
\ No newline at end of file
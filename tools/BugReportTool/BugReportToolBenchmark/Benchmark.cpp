@@ -0,0 +1,87 @@
+#include "Benchmark.h"
+
+#include <chrono>
+#include <fstream>
+#include <random>
+#include <string>
+
+#include "InstallationFolder.h"
+#include "ZipTools/ZipFolder.h"
+
+using namespace std;
+using namespace std::filesystem;
+
+namespace
+{
+    // Roughly the shape of an installation folder: a few module directories with many small files and some larger ones
+    constexpr int moduleCount = 24;
+    constexpr int filesPerModule = 120;
+    constexpr size_t smallFileSize = 16 * 1024;
+    constexpr size_t largeFileSize = 8 * 1024 * 1024;
+    constexpr int largeFileEvery = 40;
+
+    void GenerateTree(const path& root)
+    {
+        mt19937 rng(42);
+        string content;
+        for (int module = 0; module < moduleCount; ++module)
+        {
+            const auto moduleDir = root / ("module" + to_string(module)) / "lib";
+            create_directories(moduleDir);
+            for (int file = 0; file < filesPerModule; ++file)
+            {
+                const size_t size = file % largeFileEvery == 0 ? largeFileSize : smallFileSize;
+
+                // Half random, half repeated bytes so deflate has real work to do
+                content.resize(size);
+                for (size_t i = 0; i < size; ++i)
+                {
+                    content[i] = i % 2 ? static_cast<char>(rng()) : 'a';
+                }
+
+                ofstream out(moduleDir / ("file" + to_string(file) + ".dll"), ios::binary);
+                out.write(content.data(), content.size());
+            }
+        }
+    }
+
+    template<typename Callable>
+    double Measure(Callable&& callable)
+    {
+        const auto start = chrono::steady_clock::now();
+        callable();
+        return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    }
+}
+
+int RunBenchmark(const path& workDir)
+{
+    const auto root = workDir / "BugReportToolBenchmark";
+    const auto tree = root / "tree";
+    const auto report = root / "installationFolderStructure.txt";
+    const auto zip = root / "report.zip";
+
+    error_code err;
+    remove_all(root, err);
+
+    try
+    {
+        GenerateTree(tree);
+
+        const auto reportMs = Measure([&] { InstallationFolder::ReportStructure(tree, report); });
+        const auto zipMs = Measure([&] { ZipFolder(zip, tree); });
+
+        printf("Files: %d\n", moduleCount * filesPerModule);
+        printf("Installation folder report: %.1f ms\n", reportMs);
+        printf("Zip folder: %.1f ms (%llu bytes)\n", zipMs, static_cast<unsigned long long>(file_size(zip)));
+    }
+    catch (...)
+    {
+        printf("Benchmark failed\n");
+        remove_all(root, err);
+        return 1;
+    }
+
+    remove_all(root, err);
+    return 0;
+}
@@ -0,0 +1,5 @@
+#pragma once
+#include <filesystem>
+
+// Generates a synthetic report folder and times the installation folder report and zipping on it.
+int RunBenchmark(const std::filesystem::path& workDir);
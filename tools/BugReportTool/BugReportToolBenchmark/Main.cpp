@@ -0,0 +1,10 @@
+#include <filesystem>
+
+#include "Benchmark.h"
+
+// Measures report generation on a synthetic folder, kept out of BugReportTool so the shipped tool doesn't write
+// hundreds of megabytes to the temp folder
+int wmain(int, wchar_t*[], wchar_t*)
+{
+    return RunBenchmark(std::filesystem::temp_directory_path());
+}
@@ -0,0 +1,156 @@
+#include "pch.h"
+
+#include <fstream>
+#include <sstream>
+
+#include "BugReportTool/JsonRedactor.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace BugReportToolTests
+{
+    namespace
+    {
+        std::string ReadTestData(const std::string& fileName)
+        {
+            std::ifstream file(std::string{ JSON_REDACTOR_TEST_DATA } + "/" + fileName, std::ios::binary);
+            Assert::IsTrue(file.good(), L"Missing test data file");
+
+            std::ostringstream content;
+            content << file.rdbuf();
+            return content.str();
+        }
+
+        bool Redact(const std::vector<std::string>& xpaths, const std::string& json, std::string& redacted)
+        {
+            std::istringstream input(json);
+            std::ostringstream output;
+            const bool result = JsonRedactor(xpaths).Redact(input, output);
+            redacted = output.str();
+            return result;
+        }
+
+        // Redacts <name>.json and compares the result with <name>.expected.json byte for byte
+        void AssertGolden(const std::vector<std::string>& xpaths, const std::string& name)
+        {
+            std::string redacted;
+            Assert::IsTrue(Redact(xpaths, ReadTestData(name + ".json"), redacted));
+            Assert::AreEqual(ReadTestData(name + ".expected.json"), redacted);
+        }
+
+        void AssertMalformed(const std::string& json)
+        {
+            std::string redacted;
+            Assert::IsFalse(Redact({ "key" }, json, redacted));
+        }
+    }
+
+    TEST_CLASS(JsonRedactorTests)
+    {
+    public:
+        TEST_METHOD(EscapedKeysMatchDecodedXPaths)
+        {
+            AssertGolden({ "app-path", "na\"me", "\xF0\x9F\x98\x80", "unicode\xC3\xA9" }, "escapes");
+        }
+
+        TEST_METHOD(NestedObjectsAndArrays)
+        {
+            AssertGolden({ "app-zone-history/app-path", "app-zone-history/history/device-id", "devices/device-id" }, "nested");
+        }
+
+        TEST_METHOD(FormattingIsPreserved)
+        {
+            AssertGolden({ "name", "monitor/id" }, "formatting");
+        }
+
+        TEST_METHOD(ByteOrderMarkAndLineEndingsArePreserved)
+        {
+            std::string redacted;
+            Assert::IsTrue(Redact({ "path" }, "\xEF\xBB\xBF{\r\n  \"path\": \"C:\\\\a\",\r\n  \"x\": 1\r\n}\r\n", redacted));
+            Assert::AreEqual(std::string{ "\xEF\xBB\xBF{\r\n  \"path\": \"<private_data>\",\r\n  \"x\": 1\r\n}\r\n" }, redacted);
+        }
+
+        TEST_METHOD(NothingToRedact)
+        {
+            const std::string json = ReadTestData("nested.json");
+            std::string redacted;
+            Assert::IsTrue(Redact({}, json, redacted));
+            Assert::AreEqual(json, redacted);
+
+            Assert::IsTrue(Redact({ "missing/path" }, json, redacted));
+            Assert::AreEqual(json, redacted);
+        }
+
+        TEST_METHOD(RootValues)
+        {
+            std::string redacted;
+            Assert::IsTrue(Redact({ "key" }, "\"key\"", redacted));
+            Assert::AreEqual(std::string{ "\"key\"" }, redacted);
+
+            Assert::IsTrue(Redact({ "key" }, " 42 ", redacted));
+            Assert::AreEqual(std::string{ " 42 " }, redacted);
+        }
+
+        TEST_METHOD(Literals)
+        {
+            const std::string json = "[true, false, null, 0, -0, 7, -12, 3.25, 0.5e10, 1E+2, -1e-2]";
+            std::string redacted;
+            Assert::IsTrue(Redact({ "key" }, json, redacted));
+            Assert::AreEqual(json, redacted);
+
+            Assert::IsTrue(Redact({ "key" }, "{\"key\": -1.5E-3, \"other\": null}", redacted));
+            Assert::AreEqual(std::string{ "{\"key\": \"<private_data>\", \"other\": null}" }, redacted);
+        }
+
+        TEST_METHOD(MalformedLiterals)
+        {
+            for (const char* literal : { "tru", "truee", "nul1", "nulll", "False", "fals", "t", "n" })
+            {
+                AssertMalformed(std::string{ "[" } + literal + "]");
+            }
+
+            for (const char* number : { "-", "+1", "01", "-01", "1.", ".5", "1.e3", "1e", "1e+", "1e+-2", "1E-", "1.2.3", "0x10", "1-2", "--1", "Infinity", "NaN" })
+            {
+                AssertMalformed(std::string{ "{\"key\": " } + number + "}");
+                AssertMalformed(std::string{ "{\"other\": " } + number + "}");
+            }
+        }
+
+        TEST_METHOD(MalformedInput)
+        {
+            AssertMalformed("");
+            AssertMalformed("{");
+            AssertMalformed("{\"key\": \"value\"");
+            AssertMalformed("{\"key\": \"unterminated}");
+            AssertMalformed("{\"key\" \"value\"}");
+            AssertMalformed("{\"key\": \"value\",}");
+            AssertMalformed("{key: 1}");
+            AssertMalformed("[1 2]");
+            AssertMalformed("[1,]");
+            AssertMalformed("{\"key\": \"bad \\x escape\"}");
+            AssertMalformed("{\"key\": \"bad \\u12G4 escape\"}");
+            AssertMalformed("{\"key\": \"\\ud83d\\u0041\"}");
+            AssertMalformed("{\"key\": \"control \x01 character\"}");
+            AssertMalformed("{\"key\": 1} trailing");
+            AssertMalformed("{} {}");
+        }
+
+        TEST_METHOD(MalformedRedactedValue)
+        {
+            // The skipped value is still validated
+            AssertMalformed("{\"key\": {\"a\": }}");
+            AssertMalformed("{\"key\": [1,}");
+        }
+
+        TEST_METHOD(TooDeep)
+        {
+            const std::string deep = std::string(600, '[') + std::string(600, ']');
+            AssertMalformed(deep);
+
+            const std::string shallowEnough = std::string(500, '[') + std::string(500, ']');
+            std::string redacted;
+            Assert::IsTrue(Redact({ "key" }, shallowEnough, redacted));
+            Assert::AreEqual(shallowEnough, redacted);
+        }
+    };
+}
@@ -0,0 +1,62 @@
+#include <iostream>
+#include <string>
+
+#include <common/updating/delta_update.h>
+
+// Creates the patch between the installation folders of two versions, and applies it to an installation.
+// Only the standard library is used, so the patches can be produced and checked on any platform
+namespace
+{
+    int print_usage()
+    {
+        std::cerr << "Usage:\n"
+                  << "  DeltaUpdateTool create <old version folder> <new version folder> <patch file>\n"
+                  << "  DeltaUpdateTool apply <installation folder> <patch file>\n";
+        return 1;
+    }
+
+    const char* to_string(updating::delta_apply_result result)
+    {
+        switch (result)
+        {
+        case updating::delta_apply_result::success:
+            return "the installation was updated";
+        case updating::delta_apply_result::invalid_patch:
+            return "the patch is invalid";
+        case updating::delta_apply_result::base_mismatch:
+            return "the installation isn't the version the patch was created from";
+        case updating::delta_apply_result::verification_failed:
+            return "a rebuilt file doesn't match the new version";
+        default:
+            return "couldn't read or write the files";
+        }
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    const std::string command = argc > 1 ? argv[1] : "";
+    if (command == "create" && argc == 5)
+    {
+        const auto stats = updating::create_delta_patch(argv[2], argv[3], argv[4]);
+        if (!stats)
+        {
+            std::cerr << "Couldn't create the patch\n";
+            return 1;
+        }
+
+        std::cout << stats->patched_files << " patched, " << stats->added_files << " added, " << stats->removed_files << " removed and "
+                  << stats->unchanged_files << " unchanged files\n"
+                  << "Patch size: " << stats->patch_size << " bytes for " << stats->new_size << " bytes of files\n";
+        return 0;
+    }
+
+    if (command == "apply" && argc == 4)
+    {
+        const auto result = updating::apply_delta_patch(argv[2], argv[3]);
+        std::cout << "Result: " << to_string(result) << '\n';
+        return result == updating::delta_apply_result::success ? 0 : 1;
+    }
+
+    return print_usage();
+}